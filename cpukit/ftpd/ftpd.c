@@ -813,11 +813,8 @@ command_retrieve(FTPD_SessionInfo_t  *info, char const *filename)
 
     if(info->xfer_mode == TYPE_I)
     {
-      while ((n = read(fd, buf, FTPD_DATASIZE)) > 0)
-      {
-        if(send(s, buf, n, 0) != n)
-          break;
-      }
+      /* Let the network stack read the file directly into its buffers */
+      n = sendfile(fd, s, 0, 0, NULL, NULL, 0);
     }
     else if (info->xfer_mode == TYPE_A)
     {
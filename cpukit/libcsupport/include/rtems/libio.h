@@ -37,6 +37,7 @@
 #include <rtems.h>
 #include <rtems/fs.h>
 #include <rtems/chain.h>
+#include <rtems/score/atomic.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -44,6 +45,18 @@ extern "C" {
 
 struct knote;
 
+/*
+ * Commands to get and set the buffer size of a pipe with fcntl().  They are
+ * not defined by Newlib, the values match the ones of Linux.
+ */
+#ifndef F_SETPIPE_SZ
+#define F_SETPIPE_SZ 1031
+#endif
+
+#ifndef F_GETPIPE_SZ
+#define F_GETPIPE_SZ 1032
+#endif
+
 /**
  * @defgroup LibIOFSOps File System Operations
  *
@@ -465,6 +478,29 @@ typedef int (*rtems_filesystem_statvfs_t)(
   struct statvfs *buf
 );
 
+/**
+ * @brief Gets the path lookup cache key of a directory.
+ *
+ * File systems which provide this operation may use the path lookup cache
+ * (see rtems_filesystem_dentry_cache_lookup()) to avoid directory scans
+ * during path evaluation.  The key must identify the directory within its
+ * file system instance as long as the name space of the instance is not
+ * modified.
+ *
+ * This operation is optional.  Use NULL to disable the path lookup cache for
+ * a file system.
+ *
+ * @param[in] loc The location of a directory.
+ * @param[out] key The key of the directory.
+ *
+ * @retval true Successful operation.
+ * @retval false The directory cannot be cached.
+ */
+typedef bool (*rtems_filesystem_dentry_key_t)(
+  const rtems_filesystem_location_info_t *loc,
+  uint64_t *key
+);
+
 /**
  * @brief File system operations table.
  */
@@ -488,6 +524,7 @@ struct _rtems_filesystem_operations_table {
   rtems_filesystem_readlink_t readlink_h;
   rtems_filesystem_rename_t rename_h;
   rtems_filesystem_statvfs_t statvfs_h;
+  rtems_filesystem_dentry_key_t dentry_key_h;
 };
 
 /**
@@ -1282,6 +1319,7 @@ struct rtems_libio_tt {
   rtems_driver_name_t                    *driver;
   off_t                                   offset;    /* current offset into file */
   uint32_t                                flags;
+  Atomic_Uint                             references; /* see LIBIO_REFERENCE_OPEN */
   rtems_filesystem_location_info_t        pathinfo;
   uint32_t                                data0;     /* private to "driver" */
   void                                   *data1;     /* ... */
@@ -1333,10 +1371,26 @@ typedef struct {
 #define LIBIO_FLAGS_APPEND        0x0200U  /* all writes append */
 #define LIBIO_FLAGS_CREATE        0x0400U  /* create file */
 #define LIBIO_FLAGS_CLOSE_ON_EXEC 0x0800U  /* close on process exec() */
+#define LIBIO_FLAGS_KNOTE         0x1000U  /* kernel event notes attached */
 #define LIBIO_FLAGS_READ_WRITE    (LIBIO_FLAGS_READ | LIBIO_FLAGS_WRITE)
 
 /** @} */
 
+/**
+ * @name Reference Values
+ *
+ * The references member of an open file combines the open state with a
+ * count of the operations in progress.  The open file itself holds one
+ * reference which is dropped by close().  The descriptor returns to the free
+ * descriptors once the last reference is dropped.
+ */
+/**@{**/
+
+#define LIBIO_REFERENCE_OPEN      0x0001U  /* descriptor may be held */
+#define LIBIO_REFERENCE_ONE       0x0002U  /* one reference */
+
+/** @} */
+
 /**
  * @brief RTEMS LibIO Initialization
  *
@@ -1577,6 +1631,15 @@ struct rtems_filesystem_mount_table_entry_tt {
    * @see ClassicEventTransient.
    */
   rtems_id                               unmount_task;
+
+  /**
+   * The generation of the path lookup cache entries of this file system
+   * instance.  A change of the name space assigns a new generation and thus
+   * invalidates all cache entries of this instance.
+   *
+   * @see rtems_filesystem_dentry_cache_invalidate().
+   */
+  uint32_t                               dentry_cache_generation;
 };
 
 /**
@@ -66,7 +66,22 @@ extern rtems_id                          rtems_libio_semaphore;
 
 extern const uint32_t rtems_libio_number_iops;
 extern rtems_libio_t rtems_libio_iops[];
-extern rtems_libio_t *rtems_libio_iop_freelist;
+
+/*
+ *  Bit map of the free file descriptors.  Bit n of word n / 32 is set if
+ *  rtems_libio_iops[n] is free.
+ */
+
+#define RTEMS_LIBIO_FREE_MAP_BITS 32
+
+extern Atomic_Uint rtems_libio_iop_free_map[];
+
+/**
+ * @brief Removes the kernel event notes attached to a file descriptor.
+ *
+ * Set by kqueue().
+ */
+extern void (*rtems_libio_knote_fdclose)( int fd );
 
 extern const rtems_filesystem_file_handlers_r rtems_filesystem_null_handlers;
 
@@ -89,6 +104,23 @@ extern rtems_filesystem_mount_table_entry_t rtems_filesystem_null_mt_entry;
  */
 extern rtems_filesystem_global_location_t rtems_filesystem_global_location_null;
 
+/**
+ * This routine frees the resources associated with an IOP (file descriptor)
+ * and clears the slot in the IOP Table.
+ */
+void rtems_libio_free(
+  rtems_libio_t *iop
+);
+
+/**
+ * This routine closes the file of an IOP (file descriptor) on behalf of
+ * close() once the last reference to it is dropped and frees the IOP.  The
+ * errno of the caller is preserved.
+ */
+void rtems_libio_close_and_free(
+  rtems_libio_t *iop
+);
+
 /*
  *  rtems_libio_iop
  *
@@ -123,6 +155,131 @@ extern rtems_filesystem_global_location_t rtems_filesystem_global_location_null;
       }                                              \
   } while (0)
 
+/**
+ * @brief Obtains a reference to an open file.
+ *
+ * @retval true The file is open and the reference was obtained.
+ * @retval false The file is not open.
+ */
+static inline bool rtems_libio_iop_hold( rtems_libio_t *iop )
+{
+  unsigned int references;
+
+  references = _Atomic_Load_uint( &iop->references, ATOMIC_ORDER_RELAXED );
+
+  do {
+    if ( ( references & LIBIO_REFERENCE_OPEN ) == 0 ) {
+      return false;
+    }
+  } while (
+    !_Atomic_Compare_exchange_uint(
+      &iop->references,
+      &references,
+      references + LIBIO_REFERENCE_ONE,
+      ATOMIC_ORDER_ACQUIRE,
+      ATOMIC_ORDER_RELAXED
+    )
+  );
+
+  return true;
+}
+
+/**
+ * @brief Releases a reference to a file.
+ *
+ * @retval true This was the last reference of a closed file.  The caller
+ * must close the file and free the file descriptor.
+ * @retval false Otherwise.
+ */
+static inline bool rtems_libio_iop_release( rtems_libio_t *iop )
+{
+  unsigned int references;
+
+  references = _Atomic_Fetch_sub_uint(
+    &iop->references,
+    LIBIO_REFERENCE_ONE,
+    ATOMIC_ORDER_ACQ_REL
+  );
+
+  return references == LIBIO_REFERENCE_ONE;
+}
+
+/**
+ * @brief Drops a reference to a file.
+ *
+ * If this was the last reference of a file closed in the meantime, then the
+ * file is closed and the file descriptor is freed.
+ */
+static inline void rtems_libio_iop_drop( rtems_libio_t *iop )
+{
+  if ( rtems_libio_iop_release( iop ) ) {
+    rtems_libio_close_and_free( iop );
+  }
+}
+
+/**
+ * @brief Marks an open file as closed.
+ *
+ * No new references can be obtained afterwards.  The caller must drop the
+ * reference of the open file once it is done with the close.
+ *
+ * @retval true The file was open.
+ * @retval false The file is not open or another close is in progress.
+ */
+static inline bool rtems_libio_iop_mark_closed( rtems_libio_t *iop )
+{
+  unsigned int references;
+
+  references = _Atomic_Load_uint( &iop->references, ATOMIC_ORDER_RELAXED );
+
+  do {
+    if ( ( references & LIBIO_REFERENCE_OPEN ) == 0 ) {
+      return false;
+    }
+  } while (
+    !_Atomic_Compare_exchange_uint(
+      &iop->references,
+      &references,
+      references & ~LIBIO_REFERENCE_OPEN,
+      ATOMIC_ORDER_ACQ_REL,
+      ATOMIC_ORDER_RELAXED
+    )
+  );
+
+  return true;
+}
+
+/*
+ *  rtems_libio_check_hold
+ *
+ *  Macro to obtain a reference to an open file.  This keeps a concurrent
+ *  close() from freeing the file descriptor.  The reference must be dropped
+ *  with rtems_libio_iop_drop().
+ */
+
+#define rtems_libio_check_hold(_iop) \
+  do {                                               \
+      if (!rtems_libio_iop_hold(_iop)) {             \
+          errno = EBADF;                             \
+          return -1;                                 \
+      }                                              \
+  } while (0)
+
+/*
+ *  rtems_libio_check_knotes
+ *
+ *  Removes the kernel event notes of a file descriptor before it is closed.
+ */
+
+#define rtems_libio_check_knotes(_iop) \
+  do {                                                        \
+      if (((_iop)->flags & LIBIO_FLAGS_KNOTE) != 0) {         \
+          (_iop)->flags &= ~LIBIO_FLAGS_KNOTE;                \
+          (*rtems_libio_knote_fdclose)(                       \
+            rtems_libio_iop_to_descriptor(_iop));             \
+      }                                                       \
+  } while (0)
+
 /*
  *  rtems_libio_check_fd
  *
@@ -296,14 +453,6 @@ uint32_t rtems_libio_fcntl_flags( int fcntl_flags );
  */
 int rtems_libio_to_fcntl_flags( uint32_t flags );
 
-/**
- * This routine frees the resources associated with an IOP (file descriptor)
- * and clears the slot in the IOP Table.
- */
-void rtems_libio_free(
-  rtems_libio_t *iop
-);
-
 /*
  *  File System Routine Prototypes
  */
@@ -423,6 +572,121 @@ void rtems_filesystem_eval_path_generic(
   const rtems_filesystem_eval_path_generic_config *config
 );
 
+/**
+ * @brief Maximum name length in characters of a path lookup cache entry.
+ *
+ * Longer names are not cached.
+ */
+#define RTEMS_FILESYSTEM_DENTRY_CACHE_NAME_MAX 31
+
+/**
+ * @brief Maximum size in bytes of the file system specific value of a path
+ * lookup cache entry.
+ */
+#define RTEMS_FILESYSTEM_DENTRY_CACHE_VALUE_SIZE 16
+
+/**
+ * @brief Path lookup cache entry.
+ *
+ * An entry maps a directory and a name to a file system specific value, e.g.
+ * an inode number, or records that the name does not exist in the directory.
+ */
+typedef struct {
+  const rtems_filesystem_mount_table_entry_t *mt_entry;
+  uint64_t key;
+  uint32_t generation;
+  uint8_t namelen;
+  bool negative;
+  char name[RTEMS_FILESYSTEM_DENTRY_CACHE_NAME_MAX];
+  uint8_t value[RTEMS_FILESYSTEM_DENTRY_CACHE_VALUE_SIZE];
+} rtems_filesystem_dentry_cache_entry;
+
+typedef enum {
+  RTEMS_FILESYSTEM_DENTRY_CACHE_MISS,
+  RTEMS_FILESYSTEM_DENTRY_CACHE_HIT,
+  RTEMS_FILESYSTEM_DENTRY_CACHE_NEGATIVE
+} rtems_filesystem_dentry_cache_status;
+
+/**
+ * @brief The path lookup cache table.
+ *
+ * Provided by the application configuration.
+ */
+extern rtems_filesystem_dentry_cache_entry *const
+  rtems_filesystem_dentry_cache_table;
+
+/**
+ * @brief The entry count of the path lookup cache table.
+ *
+ * Provided by the application configuration.  A value of zero disables the
+ * path lookup cache.
+ */
+extern const uint32_t rtems_filesystem_dentry_cache_size;
+
+/**
+ * @brief Looks up a name in the path lookup cache.
+ *
+ * The file system instance of the directory must be locked.  The file system
+ * must check the search permission of the directory before it uses the
+ * result.
+ *
+ * @param[in] parentloc The location of the directory.
+ * @param[in] name The name.
+ * @param[in] namelen The length of the name in characters.
+ * @param[out] value The file system specific value of the entry.  It is only
+ *   set in case of a cache hit.
+ * @param[in] value_size The size of the value in bytes.
+ *
+ * @retval RTEMS_FILESYSTEM_DENTRY_CACHE_HIT The name exists and the value is
+ *   set.
+ * @retval RTEMS_FILESYSTEM_DENTRY_CACHE_NEGATIVE The name does not exist.
+ * @retval RTEMS_FILESYSTEM_DENTRY_CACHE_MISS The name is not cached or the
+ *   file system provides no dentry_key_h operation.
+ *
+ * @see rtems_filesystem_dentry_key_t.
+ */
+rtems_filesystem_dentry_cache_status rtems_filesystem_dentry_cache_lookup(
+  const rtems_filesystem_location_info_t *parentloc,
+  const char *name,
+  size_t namelen,
+  void *value,
+  size_t value_size
+);
+
+/**
+ * @brief Adds a name to the path lookup cache.
+ *
+ * The file system instance of the directory must be locked.  An existing
+ * entry which uses the same slot of the cache is replaced.
+ *
+ * @param[in] parentloc The location of the directory.
+ * @param[in] name The name.
+ * @param[in] namelen The length of the name in characters.
+ * @param[in] value The file system specific value of the entry.  Use NULL to
+ *   add a negative entry.
+ * @param[in] value_size The size of the value in bytes.
+ */
+void rtems_filesystem_dentry_cache_insert(
+  const rtems_filesystem_location_info_t *parentloc,
+  const char *name,
+  size_t namelen,
+  const void *value,
+  size_t value_size
+);
+
+/**
+ * @brief Invalidates all path lookup cache entries of a file system
+ * instance.
+ *
+ * This must be called after each change of the name space of the file system
+ * instance, e.g. the creation, removal or rename of a node.
+ *
+ * @param[in] mt_entry The file system instance.
+ */
+void rtems_filesystem_dentry_cache_invalidate(
+  rtems_filesystem_mount_table_entry_t *mt_entry
+);
+
 void rtems_filesystem_initialize(void);
 
 /**
@@ -866,8 +1130,6 @@ static inline ssize_t rtems_libio_iovec_eval(
   rtems_libio_check_is_open( iop );
   rtems_libio_check_permissions_with_error( iop, flags, EBADF );
 
-  *iopp = iop;
-
   /*
    *  Argument validation on IO vector
    */
@@ -900,6 +1162,13 @@ static inline ssize_t rtems_libio_iovec_eval(
     }
   }
 
+  /*
+   *  The caller drops the reference once the I/O vector is processed.
+   */
+  rtems_libio_check_hold( iop );
+
+  *iopp = iop;
+
   return total;
 }
 
@@ -22,6 +22,7 @@
 #include <rtems/chain.h>
 #include <stdint.h>
 #include <termios.h>
+#include <sys/event.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -330,6 +331,14 @@ typedef struct rtems_termios_tty {
   struct ttywakeup tty_rcv;
   int              tty_rcvwakeup;
 
+  /**
+   * @brief Kernel event notes for input and output readiness.
+   *
+   * The lists are protected by the device interrupt lock.
+   */
+  struct knlist    tty_rcv_note;
+  struct knlist    tty_snd_note;
+
   /**
    * @brief Corresponding device node.
    */
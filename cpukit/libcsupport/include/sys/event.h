@@ -146,7 +146,11 @@ struct knlist {
 };
 
 
-#ifdef _KERNEL
+/*
+ * On RTEMS the kernel interface is also used by the file system and device
+ * drivers to implement the kqfilter handler of the file handlers.
+ */
+#if defined(_KERNEL) || defined(__rtems__)
 
 #ifdef MALLOC_DECLARE
 MALLOC_DECLARE(M_KQUEUE);
@@ -264,7 +268,9 @@ extern int 	kqfd_register(int fd, struct kevent *kev, struct thread *p,
 extern int	kqueue_add_filteropts(int filt, struct filterops *filtops);
 extern int	kqueue_del_filteropts(int filt);
 
-#else 	/* !_KERNEL */
+#endif /* _KERNEL || __rtems__ */
+
+#if !defined(_KERNEL) || defined(__rtems__)
 
 #include <sys/cdefs.h>
 struct timespec;
@@ -276,6 +282,6 @@ int     kevent(int kq, const struct kevent *changelist, int nchanges,
 	    const struct timespec *timeout);
 __END_DECLS
 
-#endif /* !_KERNEL */
+#endif /* !_KERNEL || __rtems__ */
 
 #endif /* !_SYS_EVENT_H_ */
@@ -79,6 +79,9 @@ typedef uint32_t ioctl_command_t;
 #define       RTEMS_IO_RCVWAKEUP      4
 #define       RTEMS_IO_SNDWAKEUP      5
 #define       RTEMS_IO_TCFLUSH        6
+#define       RTEMS_IO_KQFILTER       7
+#define       RTEMS_IO_GET_PIPE_SIZE  8
+#define       RTEMS_IO_SET_PIPE_SIZE  9
 
 /* copied from libnetworking/sys/filio.h and commented out there */
 /* Generic file-descriptor ioctl's. */
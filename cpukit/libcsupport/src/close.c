@@ -29,12 +29,23 @@ int close(
 
   rtems_libio_check_fd(fd);
   iop = rtems_libio_iop(fd);
-  rtems_libio_check_is_open(iop);
+
+  if ( !rtems_libio_iop_mark_closed( iop ) )
+    rtems_set_errno_and_return_minus_one( EBADF );
+
+  rtems_libio_check_knotes( iop );
 
   iop->flags &= ~LIBIO_FLAGS_OPEN;
 
-  rc = (*iop->pathinfo.handlers->close_h)( iop );
+  /*
+   *  Operations still in progress on other tasks keep the file open.  The
+   *  last of them to drop its reference closes the file, see
+   *  rtems_libio_iop_drop().
+   */
+  if ( !rtems_libio_iop_release( iop ) )
+    return 0;
 
+  rc = (*iop->pathinfo.handlers->close_h)( iop );
   rtems_libio_free( iop );
 
   return rc;
@@ -42,6 +42,7 @@ int fchdir( int fd )
   rtems_libio_check_fd( fd );
   iop = rtems_libio_iop( fd );
   rtems_libio_check_is_open( iop );
+  rtems_libio_check_hold( iop );
 
   rtems_filesystem_instance_lock( &iop->pathinfo );
   rv = (*iop->pathinfo.handlers->fstat_h)( &iop->pathinfo, &st );
@@ -61,6 +62,7 @@ int fchdir( int fd )
     }
   }
   rtems_filesystem_instance_unlock( &iop->pathinfo );
+  rtems_libio_iop_drop( iop );
 
   if ( rv == 0 ) {
     rv = rtems_filesystem_chdir( &loc );
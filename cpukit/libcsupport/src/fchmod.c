@@ -69,12 +69,14 @@ int fchmod( int fd, mode_t mode )
   rtems_libio_check_fd( fd );
   iop = rtems_libio_iop( fd );
   rtems_libio_check_is_open(iop);
+  rtems_libio_check_hold(iop);
 
   rtems_filesystem_instance_lock( &iop->pathinfo );
 
   rv = rtems_filesystem_chmod( &iop->pathinfo, mode );
 
   rtems_filesystem_instance_unlock( &iop->pathinfo );
+  rtems_libio_iop_drop( iop );
 
   return rv;
 }
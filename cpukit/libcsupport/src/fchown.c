@@ -66,12 +66,14 @@ int fchown( int fd, uid_t owner, gid_t group )
   rtems_libio_check_fd( fd );
   iop = rtems_libio_iop( fd );
   rtems_libio_check_is_open(iop);
+  rtems_libio_check_hold(iop);
 
   rtems_filesystem_instance_lock( &iop->pathinfo );
 
   rv = rtems_filesystem_chown( &iop->pathinfo, owner, group );
 
   rtems_filesystem_instance_unlock( &iop->pathinfo );
+  rtems_libio_iop_drop( iop );
 
   return rv;
 }
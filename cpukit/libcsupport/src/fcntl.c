@@ -71,6 +71,7 @@ static int duplicate2_iop( rtems_libio_t *iop, int fd2 )
     int oflag;
 
     if ((iop2->flags & LIBIO_FLAGS_OPEN) != 0) {
+      rtems_libio_check_knotes( iop2 );
       rv = (*iop2->pathinfo.handlers->close_h)( iop2 );
     }
 
@@ -109,11 +110,13 @@ static int vfcntl(
   int            fd2;
   int            flags;
   int            mask;
+  int            size;
   int            ret = 0;
 
   rtems_libio_check_fd( fd );
   iop = rtems_libio_iop( fd );
   rtems_libio_check_is_open(iop);
+  rtems_libio_check_hold(iop);
 
   /*
    *  Now process the fcntl().
@@ -192,6 +195,27 @@ static int vfcntl(
       ret = -1;
       break;
 
+    case F_GETPIPE_SZ:   /*  for pipes and FIFOs. */
+      ret = (*iop->pathinfo.handlers->ioctl_h)(
+        iop,
+        RTEMS_IO_GET_PIPE_SIZE,
+        &size
+      );
+      if ( ret == 0 )
+        ret = size;
+      break;
+
+    case F_SETPIPE_SZ:   /*  for pipes and FIFOs. */
+      size = va_arg( ap, int );
+      ret = (*iop->pathinfo.handlers->ioctl_h)(
+        iop,
+        RTEMS_IO_SET_PIPE_SIZE,
+        &size
+      );
+      if ( ret == 0 )
+        ret = size;
+      break;
+
     default:
       errno = EINVAL;
       ret = -1;
@@ -210,6 +234,8 @@ static int vfcntl(
       ret = -1;
     }
   }
+
+  rtems_libio_iop_drop( iop );
   return ret;
 }
 
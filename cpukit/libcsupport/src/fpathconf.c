@@ -39,6 +39,7 @@ long fpathconf(
   rtems_libio_check_fd(fd);
   iop = rtems_libio_iop(fd);
   rtems_libio_check_is_open(iop);
+  rtems_libio_check_hold(iop);
 
   /*
    *  Now process the information request.
@@ -84,9 +85,12 @@ long fpathconf(
       return_value = the_limits->posix_sync_io;
       break;
     default:
-      rtems_set_errno_and_return_minus_one( EINVAL );
+      errno = EINVAL;
+      return_value = -1;
       break;
   }
 
+  rtems_libio_iop_drop( iop );
+
   return return_value;
 }
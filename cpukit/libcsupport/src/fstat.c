@@ -26,6 +26,7 @@ int fstat(
 )
 {
   rtems_libio_t *iop;
+  int            rv;
 
   /*
    *  Check to see if we were passed a valid pointer.
@@ -36,9 +37,10 @@ int fstat(
   /*
    *  Now process the stat() request.
    */
-  iop = rtems_libio_iop( fd );
   rtems_libio_check_fd( fd );
+  iop = rtems_libio_iop( fd );
   rtems_libio_check_is_open(iop);
+  rtems_libio_check_hold(iop);
 
   /*
    *  Zero out the stat structure so the various support
@@ -46,7 +48,9 @@ int fstat(
    */
   memset( sbuf, 0, sizeof(struct stat) );
 
-  return (*iop->pathinfo.handlers->fstat_h)( &iop->pathinfo, sbuf );
+  rv = (*iop->pathinfo.handlers->fstat_h)( &iop->pathinfo, sbuf );
+  rtems_libio_iop_drop( iop );
+  return rv;
 }
 
 /*
@@ -31,14 +31,18 @@ int fsync(
 )
 {
   rtems_libio_t *iop;
+  int            rv;
 
   rtems_libio_check_fd( fd );
   iop = rtems_libio_iop( fd );
   rtems_libio_check_is_open(iop);
+  rtems_libio_check_hold(iop);
 
   /*
    *  Now process the fsync().
    */
 
-  return (*iop->pathinfo.handlers->fsync_h)( iop );
+  rv = (*iop->pathinfo.handlers->fsync_h)( iop );
+  rtems_libio_iop_drop( iop );
+  return rv;
 }
@@ -33,8 +33,10 @@ int ftruncate( int fd, off_t length )
     iop = rtems_libio_iop( fd );
     rtems_libio_check_is_open( iop );
     rtems_libio_check_permissions( iop, LIBIO_FLAGS_WRITE );
+    rtems_libio_check_hold( iop );
 
     rv = (*iop->pathinfo.handlers->ftruncate_h)( iop, length );
+    rtems_libio_iop_drop( iop );
   } else {
     errno = EINVAL;
     rv = -1;
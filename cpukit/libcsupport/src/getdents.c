@@ -48,22 +48,30 @@ int getdents(
 {
   rtems_libio_t *iop;
   mode_t type;
+  int rv;
 
   /*
    *  Get the file control block structure associated with the file descriptor
    */
+  rtems_libio_check_fd( dd_fd );
   iop = rtems_libio_iop( dd_fd );
+  rtems_libio_check_is_open( iop );
+  rtems_libio_check_hold( iop );
 
   /*
    *  Make sure we are working on a directory
    */
   type = rtems_filesystem_location_type( &iop->pathinfo );
-  if ( !S_ISDIR( type ) )
+  if ( !S_ISDIR( type ) ) {
+    rtems_libio_iop_drop( iop );
     rtems_set_errno_and_return_minus_one( ENOTDIR );
+  }
 
   /*
    *  Return the number of bytes that were actually transfered as a result
    *  of the read attempt.
    */
-  return (*iop->pathinfo.handlers->read_h)( iop, dd_buf, dd_len  );
+  rv = (*iop->pathinfo.handlers->read_h)( iop, dd_buf, dd_len  );
+  rtems_libio_iop_drop( iop );
+  return rv;
 }
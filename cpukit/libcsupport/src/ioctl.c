@@ -42,6 +42,7 @@ int ioctl(
   rtems_libio_check_fd( fd );
   iop = rtems_libio_iop( fd );
   rtems_libio_check_is_open(iop);
+  rtems_libio_check_hold(iop);
 
   va_start(ap, command);
 
@@ -53,5 +54,6 @@ int ioctl(
   rc = (*iop->pathinfo.handlers->ioctl_h)( iop, command, buffer );
 
   va_end( ap );
+  rtems_libio_iop_drop( iop );
   return rc;
 }
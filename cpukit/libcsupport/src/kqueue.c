@@ -0,0 +1,835 @@
+/**
+ *  @file
+ *
+ *  @brief Kernel Event Queues
+ *  @ingroup LibIO
+ */
+
+/*
+ *  COPYRIGHT (c) 2015.
+ *  On-Line Applications Research Corporation (OAR).
+ *
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+
+/*
+ *  A kernel event queue is a file descriptor with a set of registered
+ *  kernel event notes (knotes).  Each knote is attached to the knote list of
+ *  a socket, pipe or Termios device via the kqfilter handler of the file
+ *  handlers.  The event sources call knote() if their state changes and
+ *  this moves the active knotes to the queue of their kernel event queue.
+ *  The kevent() system call returns the queued knotes, so the cost of an
+ *  event retrieval is proportional to the number of ready file descriptors
+ *  and not to the number of registered file descriptors.
+ *
+ *  The active queue is protected by an interrupt lock since Termios devices
+ *  activate knotes in interrupt context.  The registration and retrieval of
+ *  events is serialized by one mutex for all kernel event queues.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/queue.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#include <rtems.h>
+#include <rtems/libio_.h>
+#include <rtems/seterr.h>
+#include <rtems/timespec.h>
+
+#define KQ_HASH_SIZE 64
+
+#define KQ_HASH( ident ) ( ( ident ) % KQ_HASH_SIZE )
+
+struct kqueue {
+  LIST_ENTRY( kqueue )  kq_link;
+  rtems_interrupt_lock  kq_lock;
+  TAILQ_HEAD( , knote ) kq_head;
+  int                   kq_count;
+  uint32_t              kq_waiters;
+  uint32_t              kq_users;
+  bool                  kq_closed;
+  rtems_id              kq_semaphore;
+  struct klist          kq_knhash[ KQ_HASH_SIZE ];
+};
+
+static rtems_id kqueue_mutex = RTEMS_ID_NONE;
+
+static LIST_HEAD( , kqueue ) kqueue_list =
+  LIST_HEAD_INITIALIZER( kqueue_list );
+
+static const rtems_filesystem_file_handlers_r kqueue_handlers;
+
+static int kqueue_lock( void )
+{
+  rtems_status_code sc = RTEMS_SUCCESSFUL;
+
+  if ( kqueue_mutex == RTEMS_ID_NONE ) {
+    rtems_libio_lock();
+
+    if ( kqueue_mutex == RTEMS_ID_NONE ) {
+      sc = rtems_semaphore_create(
+        rtems_build_name( 'K', 'Q', 'U', 'E' ),
+        1,
+        RTEMS_BINARY_SEMAPHORE | RTEMS_INHERIT_PRIORITY | RTEMS_PRIORITY,
+        RTEMS_NO_PRIORITY,
+        &kqueue_mutex
+      );
+    }
+
+    rtems_libio_unlock();
+  }
+
+  if ( sc == RTEMS_SUCCESSFUL ) {
+    sc = rtems_semaphore_obtain( kqueue_mutex, RTEMS_WAIT, RTEMS_NO_TIMEOUT );
+  }
+
+  return sc == RTEMS_SUCCESSFUL ? 0 : ENOMEM;
+}
+
+static void kqueue_unlock( void )
+{
+  rtems_semaphore_release( kqueue_mutex );
+}
+
+static void knlist_nolock( void *arg )
+{
+  (void) arg;
+}
+
+/*
+ *  May be called in interrupt context.
+ */
+static void knote_enqueue( struct knote *kn )
+{
+  struct kqueue                *kq = kn->kn_kq;
+  rtems_interrupt_lock_context  lock_context;
+  bool                          wakeup = false;
+
+  rtems_interrupt_lock_acquire( &kq->kq_lock, &lock_context );
+
+  kn->kn_status |= KN_ACTIVE;
+
+  if ( ( kn->kn_status & ( KN_QUEUED | KN_DISABLED ) ) == 0 ) {
+    TAILQ_INSERT_TAIL( &kq->kq_head, kn, kn_tqe );
+    kn->kn_status |= KN_QUEUED;
+    ++kq->kq_count;
+    wakeup = kq->kq_waiters > 0;
+  }
+
+  rtems_interrupt_lock_release( &kq->kq_lock, &lock_context );
+
+  if ( wakeup ) {
+    rtems_semaphore_release( kq->kq_semaphore );
+  }
+}
+
+/*
+ *  Evaluates the filter of the knote.  Called with the kqueue mutex held.
+ */
+static int knote_event( struct knote *kn )
+{
+  struct knlist *knl = kn->kn_knlist;
+  int            ready;
+
+  if ( knl == NULL ) {
+    return ( kn->kn_status & KN_DETACHED ) != 0
+      && ( kn->kn_flags & EV_EOF ) != 0;
+  }
+
+  ( *knl->kl_lock )( knl->kl_lockarg );
+
+  if ( kn->kn_knlist == knl ) {
+    ready = ( *kn->kn_fop->f_event )( kn, 0 );
+  } else {
+    ready = ( kn->kn_flags & EV_EOF ) != 0;
+  }
+
+  ( *knl->kl_unlock )( knl->kl_lockarg );
+
+  return ready;
+}
+
+/*
+ *  Detaches and frees the knote.  Called with the kqueue mutex held.
+ */
+static void knote_drop( struct kqueue *kq, struct knote *kn )
+{
+  rtems_interrupt_lock_context lock_context;
+
+  if ( ( kn->kn_status & KN_DETACHED ) == 0 ) {
+    ( *kn->kn_fop->f_detach )( kn );
+  }
+
+  rtems_interrupt_lock_acquire( &kq->kq_lock, &lock_context );
+
+  if ( ( kn->kn_status & KN_QUEUED ) != 0 ) {
+    TAILQ_REMOVE( &kq->kq_head, kn, kn_tqe );
+    --kq->kq_count;
+  }
+
+  rtems_interrupt_lock_release( &kq->kq_lock, &lock_context );
+
+  SLIST_REMOVE( &kq->kq_knhash[ KQ_HASH( kn->kn_id ) ], kn, knote, kn_link );
+  free( kn );
+}
+
+void knote( struct knlist *list, long hint, int lockflags )
+{
+  struct knote *kn;
+
+  if ( list == NULL ) {
+    return;
+  }
+
+  if ( ( lockflags & KNF_LISTLOCKED ) == 0 ) {
+    ( *list->kl_lock )( list->kl_lockarg );
+  }
+
+  SLIST_FOREACH( kn, &list->kl_list, kn_selnext ) {
+    if ( ( *kn->kn_fop->f_event )( kn, hint ) ) {
+      knote_enqueue( kn );
+    }
+  }
+
+  if ( ( lockflags & KNF_LISTLOCKED ) == 0 ) {
+    ( *list->kl_unlock )( list->kl_lockarg );
+  }
+}
+
+void knlist_init(
+  struct knlist *knl,
+  void *lock,
+  void (*kl_lock)( void * ),
+  void (*kl_unlock)( void * ),
+  void (*kl_assert_locked)( void * ),
+  void (*kl_assert_unlocked)( void * )
+)
+{
+  knl->kl_lockarg = lock;
+  knl->kl_lock = kl_lock != NULL ? kl_lock : knlist_nolock;
+  knl->kl_unlock = kl_unlock != NULL ? kl_unlock : knlist_nolock;
+  knl->kl_assert_locked = kl_assert_locked != NULL ?
+    kl_assert_locked : knlist_nolock;
+  knl->kl_assert_unlocked = kl_assert_unlocked != NULL ?
+    kl_assert_unlocked : knlist_nolock;
+  SLIST_INIT( &knl->kl_list );
+}
+
+void knlist_destroy( struct knlist *knl )
+{
+  SLIST_INIT( &knl->kl_list );
+}
+
+int knlist_empty( struct knlist *knl )
+{
+  return SLIST_EMPTY( &knl->kl_list );
+}
+
+void knlist_add( struct knlist *knl, struct knote *kn, int islocked )
+{
+  if ( !islocked ) {
+    ( *knl->kl_lock )( knl->kl_lockarg );
+  }
+
+  SLIST_INSERT_HEAD( &knl->kl_list, kn, kn_selnext );
+  kn->kn_knlist = knl;
+  kn->kn_status &= ~KN_DETACHED;
+
+  if ( !islocked ) {
+    ( *knl->kl_unlock )( knl->kl_lockarg );
+  }
+}
+
+void knlist_remove( struct knlist *knl, struct knote *kn, int islocked )
+{
+  if ( !islocked ) {
+    ( *knl->kl_lock )( knl->kl_lockarg );
+  }
+
+  SLIST_REMOVE( &knl->kl_list, kn, knote, kn_selnext );
+  kn->kn_knlist = NULL;
+  kn->kn_status |= KN_DETACHED;
+
+  if ( !islocked ) {
+    ( *knl->kl_unlock )( knl->kl_lockarg );
+  }
+}
+
+/*
+ *  The knotes are owned by their kernel event queue, so they are only
+ *  detached here and reported once with EV_EOF.  The kernel event queue
+ *  frees them afterwards.
+ */
+void knlist_cleardel(
+  struct knlist *knl,
+  struct thread *td,
+  int islocked,
+  int killkn
+)
+{
+  struct knote *kn;
+
+  (void) td;
+  (void) killkn;
+
+  if ( !islocked ) {
+    ( *knl->kl_lock )( knl->kl_lockarg );
+  }
+
+  while ( ( kn = SLIST_FIRST( &knl->kl_list ) ) != NULL ) {
+    SLIST_REMOVE_HEAD( &knl->kl_list, kn_selnext );
+    kn->kn_knlist = NULL;
+    kn->kn_status |= KN_DETACHED;
+    kn->kn_flags |= EV_EOF | EV_ONESHOT;
+    knote_enqueue( kn );
+  }
+
+  if ( !islocked ) {
+    ( *knl->kl_unlock )( knl->kl_lockarg );
+  }
+}
+
+void knote_fdclose( struct thread *td, int fd )
+{
+  struct kqueue *kq;
+
+  (void) td;
+
+  if ( kqueue_lock() != 0 ) {
+    return;
+  }
+
+  LIST_FOREACH( kq, &kqueue_list, kq_link ) {
+    struct knote *kn = SLIST_FIRST( &kq->kq_knhash[ KQ_HASH( fd ) ] );
+
+    while ( kn != NULL ) {
+      struct knote *next = SLIST_NEXT( kn, kn_link );
+
+      if ( kn->kn_id == (uintptr_t) fd ) {
+        knote_drop( kq, kn );
+      }
+
+      kn = next;
+    }
+  }
+
+  kqueue_unlock();
+}
+
+static void kqueue_fdclose( int fd )
+{
+  knote_fdclose( NULL, fd );
+}
+
+static int kqueue_register( struct kqueue *kq, const struct kevent *kev )
+{
+  struct klist                 *bucket = &kq->kq_knhash[ KQ_HASH( kev->ident ) ];
+  struct knote                 *kn;
+  rtems_interrupt_lock_context  lock_context;
+
+  if ( kev->filter != EVFILT_READ && kev->filter != EVFILT_WRITE ) {
+    return EINVAL;
+  }
+
+  SLIST_FOREACH( kn, bucket, kn_link ) {
+    if ( kn->kn_id == kev->ident && kn->kn_filter == kev->filter ) {
+      break;
+    }
+  }
+
+  if ( kn == NULL ) {
+    rtems_libio_t *iop;
+    int            error;
+
+    if ( ( kev->flags & EV_ADD ) == 0 ) {
+      return ENOENT;
+    }
+
+    iop = rtems_libio_iop( kev->ident );
+    if ( iop == NULL || ( iop->flags & LIBIO_FLAGS_OPEN ) == 0 ) {
+      return EBADF;
+    }
+
+    kn = calloc( 1, sizeof( *kn ) );
+    if ( kn == NULL ) {
+      return ENOMEM;
+    }
+
+    kn->kn_kq = kq;
+    kn->kn_kevent = *kev;
+    kn->kn_flags &= ~( EV_ADD | EV_DELETE | EV_ENABLE | EV_DISABLE );
+    kn->kn_fflags = 0;
+    kn->kn_data = 0;
+    kn->kn_sfflags = kev->fflags;
+    kn->kn_sdata = kev->data;
+    kn->kn_status = KN_DETACHED;
+
+    error = ( *iop->pathinfo.handlers->kqfilter_h )( iop, kn );
+    if ( error == 0 && kn->kn_fop == NULL ) {
+      error = EINVAL;
+    }
+
+    if ( error != 0 ) {
+      free( kn );
+      return error;
+    }
+
+    SLIST_INSERT_HEAD( bucket, kn, kn_link );
+    iop->flags |= LIBIO_FLAGS_KNOTE;
+  } else {
+    if ( ( kev->flags & EV_DELETE ) != 0 ) {
+      knote_drop( kq, kn );
+      return 0;
+    }
+
+    kn->kn_sfflags = kev->fflags;
+    kn->kn_sdata = kev->data;
+    kn->kn_kevent.udata = kev->udata;
+  }
+
+  rtems_interrupt_lock_acquire( &kq->kq_lock, &lock_context );
+
+  if ( ( kev->flags & EV_DISABLE ) != 0 ) {
+    kn->kn_status |= KN_DISABLED;
+  } else if ( ( kev->flags & ( EV_ADD | EV_ENABLE ) ) != 0 ) {
+    kn->kn_status &= ~KN_DISABLED;
+  }
+
+  rtems_interrupt_lock_release( &kq->kq_lock, &lock_context );
+
+  if ( ( kn->kn_status & KN_DISABLED ) == 0 && knote_event( kn ) ) {
+    knote_enqueue( kn );
+  }
+
+  return 0;
+}
+
+/*
+ *  Returns the events of the active knotes.  Level triggered knotes which
+ *  are still ready are queued again at the end of the scan.  Called with the
+ *  kqueue mutex held.
+ */
+static int kqueue_scan(
+  struct kqueue  *kq,
+  struct kevent  *eventlist,
+  int             nevents
+)
+{
+  TAILQ_HEAD( , knote )         requeue;
+  rtems_interrupt_lock_context  lock_context;
+  struct knote                 *kn;
+  int                           n = 0;
+  int                           m = 0;
+  bool                          wakeup;
+
+  TAILQ_INIT( &requeue );
+
+  while ( n < nevents ) {
+    rtems_interrupt_lock_acquire( &kq->kq_lock, &lock_context );
+
+    kn = TAILQ_FIRST( &kq->kq_head );
+    if ( kn == NULL ) {
+      rtems_interrupt_lock_release( &kq->kq_lock, &lock_context );
+      break;
+    }
+
+    TAILQ_REMOVE( &kq->kq_head, kn, kn_tqe );
+    kn->kn_status &= ~KN_QUEUED;
+    --kq->kq_count;
+
+    if ( ( kn->kn_status & KN_DISABLED ) != 0 ) {
+      kn->kn_status &= ~KN_ACTIVE;
+      rtems_interrupt_lock_release( &kq->kq_lock, &lock_context );
+      continue;
+    }
+
+    rtems_interrupt_lock_release( &kq->kq_lock, &lock_context );
+
+    if ( !knote_event( kn ) ) {
+      rtems_interrupt_lock_acquire( &kq->kq_lock, &lock_context );
+      kn->kn_status &= ~KN_ACTIVE;
+      rtems_interrupt_lock_release( &kq->kq_lock, &lock_context );
+      continue;
+    }
+
+    eventlist[ n ] = kn->kn_kevent;
+    ++n;
+
+    if ( ( kn->kn_flags & EV_ONESHOT ) != 0 ) {
+      knote_drop( kq, kn );
+      continue;
+    }
+
+    rtems_interrupt_lock_acquire( &kq->kq_lock, &lock_context );
+
+    if ( ( kn->kn_flags & ( EV_CLEAR | EV_DISPATCH ) ) != 0 ) {
+      if ( ( kn->kn_flags & EV_CLEAR ) != 0 ) {
+        kn->kn_data = 0;
+        kn->kn_fflags = 0;
+      }
+
+      if ( ( kn->kn_flags & EV_DISPATCH ) != 0 ) {
+        kn->kn_status |= KN_DISABLED;
+      }
+
+      kn->kn_status &= ~KN_ACTIVE;
+    } else if ( ( kn->kn_status & KN_QUEUED ) == 0 ) {
+      /*
+       * Mark the knote as queued, so that an activation in the meantime does
+       * not insert it into the active queue a second time.
+       */
+      TAILQ_INSERT_TAIL( &requeue, kn, kn_tqe );
+      kn->kn_status |= KN_QUEUED;
+      ++m;
+    }
+
+    rtems_interrupt_lock_release( &kq->kq_lock, &lock_context );
+  }
+
+  rtems_interrupt_lock_acquire( &kq->kq_lock, &lock_context );
+
+  TAILQ_CONCAT( &kq->kq_head, &requeue, kn_tqe );
+  kq->kq_count += m;
+  wakeup = kq->kq_count > 0 && kq->kq_waiters > 0;
+
+  rtems_interrupt_lock_release( &kq->kq_lock, &lock_context );
+
+  if ( wakeup ) {
+    rtems_semaphore_release( kq->kq_semaphore );
+  }
+
+  return n;
+}
+
+/*
+ *  Returns true if the task has to wait for events.  Called with the kqueue
+ *  mutex held.
+ */
+static bool kqueue_prepare_wait( struct kqueue *kq )
+{
+  rtems_interrupt_lock_context lock_context;
+  bool                         wait;
+
+  rtems_interrupt_lock_acquire( &kq->kq_lock, &lock_context );
+
+  wait = kq->kq_count == 0;
+  if ( wait ) {
+    ++kq->kq_waiters;
+  }
+
+  rtems_interrupt_lock_release( &kq->kq_lock, &lock_context );
+
+  return wait;
+}
+
+static void kqueue_finish_wait( struct kqueue *kq )
+{
+  rtems_interrupt_lock_context lock_context;
+
+  rtems_interrupt_lock_acquire( &kq->kq_lock, &lock_context );
+  --kq->kq_waiters;
+  rtems_interrupt_lock_release( &kq->kq_lock, &lock_context );
+}
+
+/*
+ *  Wakes up one waiter.  A woken waiter which finds the kqueue closed passes
+ *  the wake-up on to the next one.
+ */
+static void kqueue_wake_up( struct kqueue *kq )
+{
+  rtems_interrupt_lock_context lock_context;
+  bool                         wakeup;
+
+  rtems_interrupt_lock_acquire( &kq->kq_lock, &lock_context );
+  wakeup = kq->kq_waiters > 0;
+  rtems_interrupt_lock_release( &kq->kq_lock, &lock_context );
+
+  if ( wakeup ) {
+    rtems_semaphore_release( kq->kq_semaphore );
+  }
+}
+
+static void kqueue_destroy( struct kqueue *kq )
+{
+  rtems_semaphore_delete( kq->kq_semaphore );
+  rtems_interrupt_lock_destroy( &kq->kq_lock );
+  free( kq );
+}
+
+int kqueue( void )
+{
+  struct kqueue     *kq;
+  rtems_libio_t     *iop;
+  rtems_status_code  sc;
+  int                error;
+
+  error = kqueue_lock();
+  if ( error != 0 ) {
+    rtems_set_errno_and_return_minus_one( error );
+  }
+
+  kqueue_unlock();
+
+  kq = calloc( 1, sizeof( *kq ) );
+  if ( kq == NULL ) {
+    rtems_set_errno_and_return_minus_one( ENOMEM );
+  }
+
+  sc = rtems_semaphore_create(
+    rtems_build_name( 'K', 'Q', 'W', 'T' ),
+    0,
+    RTEMS_SIMPLE_BINARY_SEMAPHORE | RTEMS_PRIORITY,
+    RTEMS_NO_PRIORITY,
+    &kq->kq_semaphore
+  );
+  if ( sc != RTEMS_SUCCESSFUL ) {
+    free( kq );
+    rtems_set_errno_and_return_minus_one( ENOMEM );
+  }
+
+  iop = rtems_libio_allocate();
+  if ( iop == NULL ) {
+    rtems_semaphore_delete( kq->kq_semaphore );
+    free( kq );
+    rtems_set_errno_and_return_minus_one( ENFILE );
+  }
+
+  rtems_interrupt_lock_initialize( &kq->kq_lock, "kqueue" );
+  TAILQ_INIT( &kq->kq_head );
+
+  iop->flags |= LIBIO_FLAGS_READ;
+  iop->data1 = kq;
+  iop->pathinfo.handlers = &kqueue_handlers;
+  iop->pathinfo.mt_entry = &rtems_filesystem_null_mt_entry;
+  rtems_filesystem_location_add_to_mt_entry( &iop->pathinfo );
+
+  kqueue_lock();
+  LIST_INSERT_HEAD( &kqueue_list, kq, kq_link );
+  rtems_libio_knote_fdclose = kqueue_fdclose;
+  kqueue_unlock();
+
+  return rtems_libio_iop_to_descriptor( iop );
+}
+
+int kevent(
+  int                    kq_fd,
+  const struct kevent   *changelist,
+  int                    nchanges,
+  struct kevent         *eventlist,
+  int                    nevents,
+  const struct timespec *timeout
+)
+{
+  rtems_libio_t  *iop;
+  struct kqueue  *kq;
+  rtems_interval  ticks = RTEMS_NO_TIMEOUT;
+  rtems_interval  then = 0;
+  bool            poll = false;
+  bool            destroy;
+  int             error;
+  int             n = 0;
+  int             i;
+
+  rtems_libio_check_fd( kq_fd );
+
+  if ( nchanges < 0 || nevents < 0 ) {
+    rtems_set_errno_and_return_minus_one( EINVAL );
+  }
+
+  if (
+    ( nchanges > 0 && changelist == NULL )
+      || ( nevents > 0 && eventlist == NULL )
+  ) {
+    rtems_set_errno_and_return_minus_one( EFAULT );
+  }
+
+  if ( timeout != NULL ) {
+    if ( !rtems_timespec_is_valid( timeout ) ) {
+      rtems_set_errno_and_return_minus_one( EINVAL );
+    }
+
+    if ( timeout->tv_sec == 0 && timeout->tv_nsec == 0 ) {
+      poll = true;
+    } else {
+      ticks = rtems_timespec_to_ticks( timeout );
+      if ( ticks == 0 ) {
+        ticks = 1;
+      }
+
+      then = rtems_clock_get_ticks_since_boot();
+    }
+  }
+
+  /*
+   *  The reference keeps the descriptor from being reused while we wait.  A
+   *  concurrent close() still runs kqueue_close(), so the kqueue itself is
+   *  only freed by its last user.
+   */
+  iop = rtems_libio_iop( kq_fd );
+  rtems_libio_check_hold( iop );
+
+  if ( iop->pathinfo.handlers != &kqueue_handlers ) {
+    rtems_libio_iop_drop( iop );
+    rtems_set_errno_and_return_minus_one( EBADF );
+  }
+
+  error = kqueue_lock();
+  if ( error != 0 ) {
+    rtems_libio_iop_drop( iop );
+    rtems_set_errno_and_return_minus_one( error );
+  }
+
+  kq = iop->data1;
+  if ( kq == NULL ) {
+    kqueue_unlock();
+    rtems_libio_iop_drop( iop );
+    rtems_set_errno_and_return_minus_one( EBADF );
+  }
+
+  ++kq->kq_users;
+
+  for ( i = 0; i < nchanges && error == 0; ++i ) {
+    const struct kevent *kev = &changelist[ i ];
+    int                  kev_error;
+
+    kev_error = kqueue_register( kq, kev );
+
+    if ( kev_error != 0 || ( kev->flags & EV_RECEIPT ) != 0 ) {
+      if ( n < nevents ) {
+        eventlist[ n ] = *kev;
+        eventlist[ n ].flags = EV_ERROR;
+        eventlist[ n ].data = kev_error;
+        ++n;
+      } else {
+        error = kev_error;
+      }
+    }
+  }
+
+  while ( error == 0 && n == 0 && nevents > 0 ) {
+    rtems_status_code sc;
+    rtems_interval    now;
+
+    n = kqueue_scan( kq, eventlist, nevents );
+    if ( n > 0 || poll ) {
+      break;
+    }
+
+    if ( !kqueue_prepare_wait( kq ) ) {
+      continue;
+    }
+
+    kqueue_unlock();
+    sc = rtems_semaphore_obtain( kq->kq_semaphore, RTEMS_WAIT, ticks );
+    kqueue_lock();
+    kqueue_finish_wait( kq );
+
+    if ( kq->kq_closed ) {
+      kqueue_wake_up( kq );
+      error = EBADF;
+    } else if ( sc == RTEMS_TIMEOUT ) {
+      n = kqueue_scan( kq, eventlist, nevents );
+      break;
+    } else if ( sc != RTEMS_SUCCESSFUL ) {
+      error = EBADF;
+    } else if ( ticks != RTEMS_NO_TIMEOUT ) {
+      now = rtems_clock_get_ticks_since_boot();
+      if ( now - then >= ticks ) {
+        poll = true;
+      } else {
+        ticks -= now - then;
+        then = now;
+      }
+    }
+  }
+
+  --kq->kq_users;
+  destroy = kq->kq_closed && kq->kq_users == 0;
+
+  kqueue_unlock();
+
+  if ( destroy ) {
+    kqueue_destroy( kq );
+  }
+
+  rtems_libio_iop_drop( iop );
+
+  if ( error != 0 ) {
+    rtems_set_errno_and_return_minus_one( error );
+  }
+
+  return n;
+}
+
+static int kqueue_close( rtems_libio_t *iop )
+{
+  struct kqueue *kq = iop->data1;
+  bool           destroy;
+  size_t         i;
+
+  kqueue_lock();
+
+  LIST_REMOVE( kq, kq_link );
+  iop->data1 = NULL;
+  kq->kq_closed = true;
+
+  for ( i = 0; i < KQ_HASH_SIZE; ++i ) {
+    struct knote *kn;
+
+    while ( ( kn = SLIST_FIRST( &kq->kq_knhash[ i ] ) ) != NULL ) {
+      knote_drop( kq, kn );
+    }
+  }
+
+  /* Tasks blocked in kevent() return with EBADF and the last one frees it */
+  destroy = kq->kq_users == 0;
+  if ( !destroy ) {
+    kqueue_wake_up( kq );
+  }
+
+  kqueue_unlock();
+
+  if ( destroy ) {
+    kqueue_destroy( kq );
+  }
+
+  return 0;
+}
+
+static int kqueue_fstat(
+  const rtems_filesystem_location_info_t *loc,
+  struct stat *buf
+)
+{
+  (void) loc;
+
+  buf->st_mode = S_IFIFO;
+
+  return 0;
+}
+
+static const rtems_filesystem_file_handlers_r kqueue_handlers = {
+  .open_h = rtems_filesystem_default_open,
+  .close_h = kqueue_close,
+  .read_h = rtems_filesystem_default_read,
+  .write_h = rtems_filesystem_default_write,
+  .ioctl_h = rtems_filesystem_default_ioctl,
+  .lseek_h = rtems_filesystem_default_lseek,
+  .fstat_h = kqueue_fstat,
+  .ftruncate_h = rtems_filesystem_default_ftruncate,
+  .fsync_h = rtems_filesystem_default_fsync_or_fdatasync,
+  .fdatasync_h = rtems_filesystem_default_fsync_or_fdatasync,
+  .fcntl_h = rtems_filesystem_default_fcntl,
+  .kqfilter_h = rtems_filesystem_default_kqfilter,
+  .poll_h = rtems_filesystem_default_poll,
+  .readv_h = rtems_filesystem_default_readv,
+  .writev_h = rtems_filesystem_default_writev
+};
@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 
 #include <rtems.h>
@@ -111,35 +112,86 @@ int rtems_libio_to_fcntl_flags( uint32_t flags )
   return fcntl_flags;
 }
 
+/*
+ *  The free file descriptors are kept in a bit map instead of a list
+ *  protected by the IO table semaphore.  Allocation clears the lowest set bit
+ *  with a compare and swap and free sets it again, so neither needs a lock
+ *  and the lowest free descriptor is returned as POSIX requires for open().
+ */
+
 rtems_libio_t *rtems_libio_allocate( void )
 {
-  rtems_libio_t *iop = NULL;
+  uint32_t words;
+  uint32_t i;
+
+  words = ( rtems_libio_number_iops + RTEMS_LIBIO_FREE_MAP_BITS - 1 )
+    / RTEMS_LIBIO_FREE_MAP_BITS;
+
+  for ( i = 0 ; i < words ; ++i ) {
+    Atomic_Uint  *word = &rtems_libio_iop_free_map[ i ];
+    unsigned int  bits;
+
+    bits = _Atomic_Load_uint( word, ATOMIC_ORDER_RELAXED );
+
+    while ( bits != 0 ) {
+      unsigned int bit = bits & ( ~bits + 1 );
+
+      if (
+        _Atomic_Compare_exchange_uint(
+          word,
+          &bits,
+          bits & ~bit,
+          ATOMIC_ORDER_ACQUIRE,
+          ATOMIC_ORDER_RELAXED
+        )
+      ) {
+        rtems_libio_t *iop;
+
+        iop = &rtems_libio_iops[
+          i * RTEMS_LIBIO_FREE_MAP_BITS + (uint32_t) ffs( (int) bit ) - 1
+        ];
+        memset( iop, 0, sizeof(*iop) );
+        iop->flags = LIBIO_FLAGS_OPEN;
+        _Atomic_Store_uint(
+          &iop->references,
+          LIBIO_REFERENCE_OPEN | LIBIO_REFERENCE_ONE,
+          ATOMIC_ORDER_RELEASE
+        );
+
+        return iop;
+      }
+    }
+  }
 
-  rtems_libio_lock();
+  return NULL;
+}
 
-  if (rtems_libio_iop_freelist) {
-    iop = rtems_libio_iop_freelist;
-    rtems_libio_iop_freelist = iop->data1;
-    memset( iop, 0, sizeof(*iop) );
-    iop->flags = LIBIO_FLAGS_OPEN;
-  }
+void rtems_libio_close_and_free(
+  rtems_libio_t *iop
+)
+{
+  int eno = errno;
 
-  rtems_libio_unlock();
+  (void) (*iop->pathinfo.handlers->close_h)( iop );
+  rtems_libio_free( iop );
 
-  return iop;
+  errno = eno;
 }
 
 void rtems_libio_free(
   rtems_libio_t *iop
 )
 {
-  rtems_filesystem_location_free( &iop->pathinfo );
+  uint32_t fd = (uint32_t) rtems_libio_iop_to_descriptor( iop );
 
-  rtems_libio_lock();
+  rtems_filesystem_location_free( &iop->pathinfo );
 
-    iop->flags = 0;
-    iop->data1 = rtems_libio_iop_freelist;
-    rtems_libio_iop_freelist = iop;
+  iop->flags = 0;
+  _Atomic_Store_uint( &iop->references, 0, ATOMIC_ORDER_RELAXED );
 
-  rtems_libio_unlock();
+  _Atomic_Fetch_or_uint(
+    &rtems_libio_iop_free_map[ fd / RTEMS_LIBIO_FREE_MAP_BITS ],
+    1U << ( fd % RTEMS_LIBIO_FREE_MAP_BITS ),
+    ATOMIC_ORDER_RELEASE
+  );
 }
@@ -38,22 +38,20 @@
  */
 
 rtems_id           rtems_libio_semaphore;
-rtems_libio_t     *rtems_libio_iop_freelist;
+void             (*rtems_libio_knote_fdclose)( int fd );
 
 void rtems_libio_init( void )
 {
     rtems_status_code rc;
     uint32_t i;
-    rtems_libio_t *iop;
     int eno;
 
-    if (rtems_libio_number_iops > 0)
-    {
-        iop = rtems_libio_iop_freelist = &rtems_libio_iops[0];
-        for (i = 0 ; (i + 1) < rtems_libio_number_iops ; i++, iop++)
-          iop->data1 = iop + 1;
-        iop->data1 = NULL;
-    }
+    for (i = 0 ; i < rtems_libio_number_iops ; i++)
+      _Atomic_Fetch_or_uint(
+        &rtems_libio_iop_free_map[i / RTEMS_LIBIO_FREE_MAP_BITS],
+        1U << (i % RTEMS_LIBIO_FREE_MAP_BITS),
+        ATOMIC_ORDER_RELAXED
+      );
 
   /*
    *  Create the posix key for user environment.
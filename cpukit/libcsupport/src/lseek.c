@@ -20,12 +20,16 @@
 off_t lseek( int fd, off_t offset, int whence )
 {
   rtems_libio_t *iop;
+  off_t          rv;
 
   rtems_libio_check_fd( fd );
   iop = rtems_libio_iop( fd );
   rtems_libio_check_is_open(iop);
+  rtems_libio_check_hold(iop);
 
-  return (*iop->pathinfo.handlers->lseek_h)( iop, offset, whence );
+  rv = (*iop->pathinfo.handlers->lseek_h)( iop, offset, whence );
+  rtems_libio_iop_drop( iop );
+  return rv;
 }
 
 /*
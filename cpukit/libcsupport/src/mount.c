@@ -81,6 +81,7 @@ static rtems_filesystem_mount_table_entry_t *alloc_mount_table_entry(
     mt_entry->mounted = true;
     mt_entry->mt_fs_root = mt_fs_root;
     mt_entry->pathconf_limits_and_options = &rtems_filesystem_default_pathconf;
+    rtems_filesystem_dentry_cache_invalidate( mt_entry );
 
     mt_fs_root->location.mt_entry = mt_entry;
     mt_fs_root->reference_count = 1;
@@ -118,6 +119,9 @@ static int register_subordinate_file_system(
     mt_point_node = rtems_filesystem_location_transform_to_global( &targetloc );
     mt_entry->mt_point_node = mt_point_node;
     rv = (*mt_point_node->location.mt_entry->ops->mount_h)( mt_entry );
+    rtems_filesystem_dentry_cache_invalidate(
+      mt_point_node->location.mt_entry
+    );
     if ( rv == 0 ) {
       rtems_filesystem_mt_lock();
       rtems_chain_append_unprotected(
@@ -31,6 +31,7 @@ ssize_t read(
 )
 {
   rtems_libio_t *iop;
+  ssize_t        n;
 
   rtems_libio_check_fd( fd );
   iop = rtems_libio_iop( fd );
@@ -38,11 +39,14 @@ ssize_t read(
   rtems_libio_check_buffer( buffer );
   rtems_libio_check_count( count );
   rtems_libio_check_permissions_with_error( iop, LIBIO_FLAGS_READ, EBADF );
+  rtems_libio_check_hold( iop );
 
   /*
    *  Now process the read().
    */
-  return (*iop->pathinfo.handlers->read_h)( iop, buffer, count );
+  n = (*iop->pathinfo.handlers->read_h)( iop, buffer, count );
+  rtems_libio_iop_drop( iop );
+  return n;
 }
 
 #if defined(RTEMS_NEWLIB) && !defined(HAVE__READ_R)
@@ -40,8 +40,12 @@ ssize_t readv(
 
   total = rtems_libio_iovec_eval( fd, iov, iovcnt, LIBIO_FLAGS_READ, &iop );
 
-  if ( total > 0 ) {
-    total = ( *iop->pathinfo.handlers->readv_h )( iop, iov, iovcnt, total );
+  if ( total >= 0 ) {
+    if ( total > 0 ) {
+      total = ( *iop->pathinfo.handlers->readv_h )( iop, iov, iovcnt, total );
+    }
+
+    rtems_libio_iop_drop( iop );
   }
 
   return total;
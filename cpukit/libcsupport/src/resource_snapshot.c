@@ -83,19 +83,19 @@ static const Objects_Information *const objects_info_table[] = {
 static int open_files(void)
 {
   int free_count = 0;
-  rtems_libio_t *iop;
+  uint32_t i;
 
-  rtems_libio_lock();
+  for (i = 0; i < rtems_libio_number_iops; ++i) {
+    unsigned int bits = _Atomic_Load_uint(
+      &rtems_libio_iop_free_map[i / RTEMS_LIBIO_FREE_MAP_BITS],
+      ATOMIC_ORDER_RELAXED
+    );
 
-  iop = rtems_libio_iop_freelist;
-  while (iop != NULL) {
-    ++free_count;
-
-    iop = iop->data1;
+    if ((bits & (1U << (i % RTEMS_LIBIO_FREE_MAP_BITS))) != 0) {
+      ++free_count;
+    }
   }
 
-  rtems_libio_unlock();
-
   return (int) rtems_libio_number_iops - free_count;
 }
 
@@ -0,0 +1,179 @@
+/**
+ *  @file
+ *
+ *  @brief RTEMS File System Path Lookup Cache
+ *  @ingroup LibIOInternal
+ */
+
+/*
+ *  COPYRIGHT (c) 2015.
+ *  On-Line Applications Research Corporation (OAR).
+ *
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+
+/*
+ *  The path lookup cache is a direct mapped hash table shared by all file
+ *  system instances.  An entry is identified by the file system instance,
+ *  the directory key provided by the dentry_key_h operation and the name.
+ *  Entries are never removed explicitly.  Instead each change of the name
+ *  space of a file system instance assigns a new generation to the instance,
+ *  so all its entries become stale at once.  The generation counter is
+ *  global, so an instance which reuses the memory of an unmounted one never
+ *  matches the entries of its predecessor.
+ *
+ *  The lookup and insertion is done with the file system instance locked.
+ *  The interrupt lock protects the table against the other instances.
+ */
+
+#if HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include <rtems/libio_.h>
+
+#include <string.h>
+
+RTEMS_INTERRUPT_LOCK_DEFINE(
+  static,
+  dentry_cache_lock,
+  "Filesystem Path Lookup Cache"
+)
+
+static uint32_t dentry_cache_generation;
+
+static bool get_key(
+  const rtems_filesystem_location_info_t *parentloc,
+  size_t namelen,
+  size_t value_size,
+  uint64_t *key
+)
+{
+  rtems_filesystem_dentry_key_t dentry_key_h =
+    parentloc->mt_entry->ops->dentry_key_h;
+
+  return dentry_key_h != NULL
+    && rtems_filesystem_dentry_cache_size > 0
+    && namelen > 0
+    && namelen <= RTEMS_FILESYSTEM_DENTRY_CACHE_NAME_MAX
+    && value_size <= RTEMS_FILESYSTEM_DENTRY_CACHE_VALUE_SIZE
+    && (*dentry_key_h)( parentloc, key );
+}
+
+static rtems_filesystem_dentry_cache_entry *get_entry(
+  const rtems_filesystem_mount_table_entry_t *mt_entry,
+  uint64_t key,
+  const char *name,
+  size_t namelen
+)
+{
+  uint32_t hash = 2166136261U;
+  size_t i;
+
+  /* FNV-1a */
+  for ( i = 0; i < namelen; ++i ) {
+    hash = ( hash ^ (uint8_t) name[ i ] ) * 16777619U;
+  }
+
+  hash ^= (uint32_t) key ^ (uint32_t) ( key >> 32 );
+  hash ^= (uint32_t) (uintptr_t) mt_entry;
+  hash ^= hash >> 16;
+  hash *= 0x45d9f3bU;
+  hash ^= hash >> 16;
+
+  return &rtems_filesystem_dentry_cache_table[
+    hash % rtems_filesystem_dentry_cache_size
+  ];
+}
+
+rtems_filesystem_dentry_cache_status rtems_filesystem_dentry_cache_lookup(
+  const rtems_filesystem_location_info_t *parentloc,
+  const char *name,
+  size_t namelen,
+  void *value,
+  size_t value_size
+)
+{
+  rtems_filesystem_dentry_cache_status status =
+    RTEMS_FILESYSTEM_DENTRY_CACHE_MISS;
+  uint64_t key;
+
+  if ( get_key( parentloc, namelen, value_size, &key ) ) {
+    const rtems_filesystem_mount_table_entry_t *mt_entry =
+      parentloc->mt_entry;
+    rtems_filesystem_dentry_cache_entry *entry =
+      get_entry( mt_entry, key, name, namelen );
+    rtems_interrupt_lock_context lock_context;
+
+    rtems_interrupt_lock_acquire( &dentry_cache_lock, &lock_context );
+
+    if (
+      entry->mt_entry == mt_entry
+        && entry->generation == mt_entry->dentry_cache_generation
+        && entry->key == key
+        && entry->namelen == namelen
+        && memcmp( entry->name, name, namelen ) == 0
+    ) {
+      if ( entry->negative ) {
+        status = RTEMS_FILESYSTEM_DENTRY_CACHE_NEGATIVE;
+      } else {
+        memcpy( value, entry->value, value_size );
+        status = RTEMS_FILESYSTEM_DENTRY_CACHE_HIT;
+      }
+    }
+
+    rtems_interrupt_lock_release( &dentry_cache_lock, &lock_context );
+  }
+
+  return status;
+}
+
+void rtems_filesystem_dentry_cache_insert(
+  const rtems_filesystem_location_info_t *parentloc,
+  const char *name,
+  size_t namelen,
+  const void *value,
+  size_t value_size
+)
+{
+  uint64_t key;
+
+  if ( get_key( parentloc, namelen, value_size, &key ) ) {
+    const rtems_filesystem_mount_table_entry_t *mt_entry =
+      parentloc->mt_entry;
+    rtems_filesystem_dentry_cache_entry *entry =
+      get_entry( mt_entry, key, name, namelen );
+    rtems_interrupt_lock_context lock_context;
+
+    rtems_interrupt_lock_acquire( &dentry_cache_lock, &lock_context );
+
+    entry->mt_entry = mt_entry;
+    entry->generation = mt_entry->dentry_cache_generation;
+    entry->key = key;
+    entry->namelen = (uint8_t) namelen;
+    memcpy( entry->name, name, namelen );
+
+    if ( value != NULL ) {
+      entry->negative = false;
+      memcpy( entry->value, value, value_size );
+    } else {
+      entry->negative = true;
+    }
+
+    rtems_interrupt_lock_release( &dentry_cache_lock, &lock_context );
+  }
+}
+
+void rtems_filesystem_dentry_cache_invalidate(
+  rtems_filesystem_mount_table_entry_t *mt_entry
+)
+{
+  rtems_interrupt_lock_context lock_context;
+
+  rtems_interrupt_lock_acquire( &dentry_cache_lock, &lock_context );
+  ++dentry_cache_generation;
+  mt_entry->dentry_cache_generation = dentry_cache_generation;
+  rtems_interrupt_lock_release( &dentry_cache_lock, &lock_context );
+}
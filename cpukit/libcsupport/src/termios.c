@@ -26,6 +26,7 @@
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <termios.h>
 #include <unistd.h>
 #include <sys/ttycom.h>
@@ -885,6 +886,112 @@ termios_set_flowctrl(struct rtems_termios_tty *tty)
   }
 }
 
+/*
+ * Kernel event filters.  The knote lists are protected by the device
+ * interrupt lock, since the receive and transmit interrupts activate the
+ * knotes.  The filters only read the buffer indices.
+ */
+static int
+rtems_termios_kqfilter_read_event (struct knote *kn, long hint)
+{
+  rtems_termios_tty *tty = kn->kn_hook;
+  unsigned int size = tty->rawInBuf.Size;
+
+  kn->kn_data = (tty->rawInBuf.Tail - tty->rawInBuf.Head + size) % size
+    + (tty->ccount - tty->cindex);
+  return kn->kn_data > 0;
+}
+
+static int
+rtems_termios_kqfilter_write_event (struct knote *kn, long hint)
+{
+  rtems_termios_tty *tty = kn->kn_hook;
+  unsigned int size = tty->rawOutBuf.Size;
+
+  kn->kn_data = size - 1
+    - (tty->rawOutBuf.Head - tty->rawOutBuf.Tail + size) % size;
+  return kn->kn_data > 0;
+}
+
+static void
+rtems_termios_kqfilter_detach (struct knote *kn)
+{
+  rtems_termios_tty *tty = kn->kn_hook;
+  rtems_termios_device_context *ctx = tty->device_context;
+  rtems_interrupt_lock_context lock_context;
+
+  rtems_termios_device_lock_acquire (ctx, &lock_context);
+  knlist_remove (kn->kn_knlist, kn, 1);
+  rtems_termios_device_lock_release (ctx, &lock_context);
+}
+
+static struct filterops rtems_termios_read_filtops = {
+  .f_isfd = 1,
+  .f_detach = rtems_termios_kqfilter_detach,
+  .f_event = rtems_termios_kqfilter_read_event
+};
+
+static struct filterops rtems_termios_write_filtops = {
+  .f_isfd = 1,
+  .f_detach = rtems_termios_kqfilter_detach,
+  .f_event = rtems_termios_kqfilter_write_event
+};
+
+static rtems_status_code
+rtems_termios_kqfilter (rtems_termios_tty *tty, struct knote *kn)
+{
+  rtems_termios_device_context *ctx = tty->device_context;
+  rtems_interrupt_lock_context lock_context;
+  struct knlist *knl;
+
+  switch (kn->kn_filter) {
+  case EVFILT_READ:
+    /*
+     * In polled mode the input is only fetched by a reader, so there is no
+     * event source.
+     */
+    if (tty->handler.mode == TERMIOS_POLLED
+        || rtems_termios_linesw[tty->t_line].l_rint != NULL)
+      return RTEMS_NOT_IMPLEMENTED;
+    kn->kn_fop = &rtems_termios_read_filtops;
+    knl = &tty->tty_rcv_note;
+    break;
+  case EVFILT_WRITE:
+    kn->kn_fop = &rtems_termios_write_filtops;
+    knl = &tty->tty_snd_note;
+    break;
+  default:
+    return RTEMS_INVALID_NUMBER;
+  }
+
+  kn->kn_hook = tty;
+
+  rtems_termios_device_lock_acquire (ctx, &lock_context);
+  if (knl->kl_lock == NULL)
+    knlist_init (knl, tty, NULL, NULL, NULL, NULL);
+  knlist_add (knl, kn, 1);
+  rtems_termios_device_lock_release (ctx, &lock_context);
+
+  return RTEMS_SUCCESSFUL;
+}
+
+/*
+ * Activates the kernel event notes of the list.  May be called in interrupt
+ * context.
+ */
+static void
+rtems_termios_knote (rtems_termios_tty *tty, struct knlist *knl)
+{
+  if (!KNLIST_EMPTY (knl)) {
+    rtems_termios_device_context *ctx = tty->device_context;
+    rtems_interrupt_lock_context lock_context;
+
+    rtems_termios_device_lock_acquire (ctx, &lock_context);
+    KNOTE_LOCKED (knl, 0);
+    rtems_termios_device_lock_release (ctx, &lock_context);
+  }
+}
+
 rtems_status_code
 rtems_termios_ioctl (void *arg)
 {
@@ -978,6 +1085,10 @@ rtems_termios_ioctl (void *arg)
     tty->tty_rcv = *wakeup;
     break;
 
+  case RTEMS_IO_KQFILTER:
+    sc = rtems_termios_kqfilter (tty, args->buffer);
+    break;
+
     /*
      * FIXME: add various ioctl code handlers
      */
@@ -1452,6 +1563,35 @@ fillBufferPoll (struct rtems_termios_tty *tty)
   return RTEMS_SUCCESSFUL;
 }
 
+/*
+ * Restart the remote transmitter if the raw input queue drained below the low
+ * water mark.  The new head of the queue is passed in.
+ */
+static void
+checkLowWater (struct rtems_termios_tty *tty, unsigned int newHead)
+{
+  if(((tty->rawInBuf.Tail-newHead+tty->rawInBuf.Size)
+      % tty->rawInBuf.Size)
+     < tty->lowwater) {
+    tty->flow_ctrl &= ~FL_IREQXOF;
+    /* if tx stopped and XON should be sent... */
+    if (((tty->flow_ctrl & (FL_MDXON | FL_ISNTXOF))
+         ==                (FL_MDXON | FL_ISNTXOF))
+        && ((tty->rawOutBufState == rob_idle)
+      || (tty->flow_ctrl & FL_OSTOP))) {
+      /* XON should be sent now... */
+      (*tty->handler.write)(
+        tty->device_context, (void *)&(tty->termios.c_cc[VSTART]), 1);
+    } else if (tty->flow_ctrl & FL_MDRTS) {
+      tty->flow_ctrl &= ~FL_IRTSOFF;
+      /* activate RTS line */
+      if (tty->flow.start_remote_tx != NULL) {
+        tty->flow.start_remote_tx(tty->device_context);
+      }
+    }
+  }
+}
+
 /*
  * Fill the input buffer from the raw input queue
  */
@@ -1474,26 +1614,7 @@ fillBufferQueue (struct rtems_termios_tty *tty)
       newHead = (tty->rawInBuf.Head + 1) % tty->rawInBuf.Size;
       c = tty->rawInBuf.theBuf[newHead];
       tty->rawInBuf.Head = newHead;
-      if(((tty->rawInBuf.Tail-newHead+tty->rawInBuf.Size)
-          % tty->rawInBuf.Size)
-         < tty->lowwater) {
-        tty->flow_ctrl &= ~FL_IREQXOF;
-        /* if tx stopped and XON should be sent... */
-        if (((tty->flow_ctrl & (FL_MDXON | FL_ISNTXOF))
-             ==                (FL_MDXON | FL_ISNTXOF))
-            && ((tty->rawOutBufState == rob_idle)
-          || (tty->flow_ctrl & FL_OSTOP))) {
-          /* XON should be sent now... */
-          (*tty->handler.write)(
-            tty->device_context, (void *)&(tty->termios.c_cc[VSTART]), 1);
-        } else if (tty->flow_ctrl & FL_MDRTS) {
-          tty->flow_ctrl &= ~FL_IRTSOFF;
-          /* activate RTS line */
-          if (tty->flow.start_remote_tx != NULL) {
-            tty->flow.start_remote_tx(tty->device_context);
-          }
-        }
-      }
+      checkLowWater (tty, newHead);
 
       /* continue processing new character */
       if (tty->termios.c_lflag & ICANON) {
@@ -1520,6 +1641,77 @@ fillBufferQueue (struct rtems_termios_tty *tty)
   return RTEMS_SUCCESSFUL;
 }
 
+/*
+ * Check if the input processing can be skipped.  This is the case in
+ * non-canonical mode without echo and without input character translation,
+ * e.g. after cfmakeraw().
+ */
+static bool
+isRawInput (const struct rtems_termios_tty *tty)
+{
+  return (tty->termios.c_lflag & (ICANON | ECHO)) == 0
+    && (tty->termios.c_iflag & (ISTRIP | IUCLC | IGNCR | ICRNL | INLCR)) == 0;
+}
+
+/*
+ * Read from the raw input queue directly into the user buffer.  The
+ * characters available are copied with at most two memcpy() calls since the
+ * queue may wrap around.  The VMIN and VTIME handling is the same as in
+ * fillBufferQueue().  Returns the count of characters read.
+ */
+static uint32_t
+readRawQueue (struct rtems_termios_tty *tty, char *buffer, uint32_t count)
+{
+  rtems_interval timeout = tty->rawInBufSemaphoreFirstTimeout;
+  uint32_t want = tty->termios.c_cc[VMIN];
+  uint32_t done = 0;
+  rtems_status_code sc;
+
+  if (want > count)
+    want = count;
+
+  while (count > 0) {
+    unsigned int head = tty->rawInBuf.Head;
+    unsigned int size = tty->rawInBuf.Size;
+    unsigned int n = (tty->rawInBuf.Tail - head + size) % size;
+
+    if (n > 0) {
+      unsigned int first = (head + 1) % size;
+      unsigned int chunk = size - first;
+
+      if (n > count)
+        n = count;
+      if (chunk > n)
+        chunk = n;
+
+      memcpy (buffer, &tty->rawInBuf.theBuf[first], chunk);
+      memcpy (buffer + chunk, &tty->rawInBuf.theBuf[0], n - chunk);
+
+      head = (head + n) % size;
+      tty->rawInBuf.Head = head;
+      checkLowWater (tty, head);
+
+      buffer += n;
+      count -= n;
+      done += n;
+      timeout = tty->rawInBufSemaphoreTimeout;
+    }
+
+    if (done > 0 && done >= want)
+      break;
+
+    /*
+     * Wait for characters
+     */
+    sc = rtems_semaphore_obtain(
+      tty->rawInBuf.Semaphore, tty->rawInBufSemaphoreOptions, timeout);
+    if (sc != RTEMS_SUCCESSFUL)
+      break;
+  }
+
+  return done;
+}
+
 rtems_status_code
 rtems_termios_read (void *arg)
 {
@@ -1545,7 +1737,12 @@ rtems_termios_read (void *arg)
     tty->read_start_column = tty->column;
     if (tty->handler.poll_read != NULL && tty->handler.mode == TERMIOS_POLLED)
       sc = fillBufferPoll (tty);
-    else
+    else if (isRawInput (tty)) {
+      args->bytes_moved = readRawQueue (tty, buffer, count);
+      tty->tty_rcvwakeup = 0;
+      rtems_semaphore_release (tty->isem);
+      return RTEMS_SUCCESSFUL;
+    } else
       sc = fillBufferQueue (tty);
 
     if (sc != RTEMS_SUCCESSFUL)
@@ -1574,6 +1771,47 @@ void rtems_termios_rxirq_occured(struct rtems_termios_tty *tty)
   rtems_event_send(tty->rxTaskId,TERMIOS_RX_PROC_EVENT);
 }
 
+/*
+ * Copy a block of received characters to the raw input queue with at most two
+ * memcpy() calls.  Returns the number of characters dropped because of
+ * overflow.
+ */
+static int
+enqueueBlock (struct rtems_termios_tty *tty, const char *buf, int len)
+{
+  unsigned int tail = tty->rawInBuf.Tail;
+  unsigned int size = tty->rawInBuf.Size;
+  unsigned int space = (tty->rawInBuf.Head - tail - 1 + size) % size;
+  unsigned int first = (tail + 1) % size;
+  unsigned int n = (unsigned int) len;
+  unsigned int chunk = size - first;
+  int dropped = 0;
+
+  if (n > space) {
+    dropped = (int) (n - space);
+    n = space;
+  }
+  if (chunk > n)
+    chunk = n;
+
+  memcpy (&tty->rawInBuf.theBuf[first], buf, chunk);
+  memcpy (&tty->rawInBuf.theBuf[0], buf + chunk, n - chunk);
+
+  /* the characters must be in place before the reader sees the new tail */
+  RTEMS_COMPILER_MEMORY_BARRIER();
+  tty->rawInBuf.Tail = (tail + n) % size;
+
+  /*
+   * check to see if rcv wakeup callback was set
+   */
+  if (n > 0 && ( !tty->tty_rcvwakeup ) && ( tty->tty_rcv.sw_pfn != NULL )) {
+    (*tty->tty_rcv.sw_pfn)(&tty->termios, tty->tty_rcv.sw_arg);
+    tty->tty_rcvwakeup = 1;
+  }
+
+  return dropped;
+}
+
 /*
  * Place characters on raw queue.
  * NOTE: This routine runs in the context of the
@@ -1607,6 +1845,19 @@ rtems_termios_enqueue_raw_characters (void *ttyp, const char *buf, int len)
     return 0;
   }
 
+  /*
+   * Without flow control the characters need no inspection.  Drivers which
+   * receive by DMA or from a FIFO hand over whole blocks which are copied at
+   * once.
+   */
+  if ((tty->flow_ctrl & (FL_MDXON | FL_MDXOF | FL_MDRTS)) == 0) {
+    dropped = enqueueBlock (tty, buf, len);
+    tty->rawInBufDropped += dropped;
+    rtems_termios_knote (tty, &tty->tty_rcv_note);
+    rtems_semaphore_release (tty->rawInBuf.Semaphore);
+    return dropped;
+  }
+
   while (len--) {
     c = *buf++;
     /* FIXME: implement IXANY: any character restarts output */
@@ -1697,6 +1948,7 @@ rtems_termios_enqueue_raw_characters (void *ttyp, const char *buf, int len)
   }
 
   tty->rawInBufDropped += dropped;
+  rtems_termios_knote (tty, &tty->tty_rcv_note);
   rtems_semaphore_release (tty->rawInBuf.Semaphore);
   return dropped;
 }
@@ -1797,6 +2049,8 @@ rtems_termios_refill_transmitter (struct rtems_termios_tty *tty)
     rtems_semaphore_release (tty->rawOutBuf.Semaphore);
   }
 
+  rtems_termios_knote (tty, &tty->tty_snd_note);
+
   return nToSend;
 }
 
@@ -55,6 +55,9 @@ int unmount( const char *path )
         mt_entry->mt_point_node->location.mt_entry->ops;
 
       rv = (*mt_point_ops->unmount_h)( mt_entry );
+      rtems_filesystem_dentry_cache_invalidate(
+        mt_entry->mt_point_node->location.mt_entry
+      );
       if ( rv == 0 ) {
         rtems_id self_task_id = rtems_task_self();
         rtems_filesystem_mt_entry_declare_lock_context( lock_context );
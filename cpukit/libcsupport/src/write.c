@@ -34,6 +34,7 @@ ssize_t write(
 )
 {
   rtems_libio_t     *iop;
+  ssize_t            n;
 
   rtems_libio_check_fd( fd );
   iop = rtems_libio_iop( fd );
@@ -41,9 +42,12 @@ ssize_t write(
   rtems_libio_check_buffer( buffer );
   rtems_libio_check_count( count );
   rtems_libio_check_permissions_with_error( iop, LIBIO_FLAGS_WRITE, EBADF );
+  rtems_libio_check_hold( iop );
 
   /*
    *  Now process the write() request.
    */
-  return (*iop->pathinfo.handlers->write_h)( iop, buffer, count );
+  n = (*iop->pathinfo.handlers->write_h)( iop, buffer, count );
+  rtems_libio_iop_drop( iop );
+  return n;
 }
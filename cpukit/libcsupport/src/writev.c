@@ -32,8 +32,12 @@ ssize_t writev(
 
   total = rtems_libio_iovec_eval( fd, iov, iovcnt, LIBIO_FLAGS_WRITE, &iop );
 
-  if ( total > 0 ) {
-    total = ( *iop->pathinfo.handlers->writev_h )( iop, iov, iovcnt, total );
+  if ( total >= 0 ) {
+    if ( total > 0 ) {
+      total = ( *iop->pathinfo.handlers->writev_h )( iop, iov, iovcnt, total );
+    }
+
+    rtems_libio_iop_drop( iop );
   }
 
   return total;
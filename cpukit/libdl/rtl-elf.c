@@ -547,7 +547,6 @@ rtems_rtl_elf_symbols (rtems_rtl_obj_t*      obj,
             ++lsym;
           }
 
-          rtems_chain_set_off_chain (&osym->node);
           memcpy (string, name, strlen (name) + 1);
           osym->name = string;
           osym->value = symbol.st_value + (uint8_t*) symsect->base;
@@ -565,8 +564,8 @@ rtems_rtl_elf_symbols (rtems_rtl_obj_t*      obj,
       }
   }
 
-  if (globals)
-    rtems_rtl_symbol_obj_add (obj);
+  if (globals && !rtems_rtl_symbol_obj_add (obj))
+    return false;
 
   return true;
 }
@@ -577,8 +576,25 @@ rtems_rtl_elf_loader (rtems_rtl_obj_t*      obj,
                       rtems_rtl_obj_sect_t* sect,
                       void*                 data)
 {
-  uint8_t* base_offset;
-  size_t   len;
+  const uint8_t* image;
+  size_t         image_size;
+  uint8_t*       base_offset;
+  size_t         len;
+
+  /*
+   * A file held in memory is copied in one block.
+   */
+  if (rtems_rtl_obj_cache_file_image (fd, &image, &image_size))
+  {
+    if ((obj->ooffset + sect->offset + sect->size) > image_size)
+    {
+      rtems_rtl_set_error (EINVAL, "section past end of file");
+      return false;
+    }
+
+    memcpy (sect->base, image + obj->ooffset + sect->offset, sect->size);
+    return true;
+  }
 
   if (lseek (fd, obj->ooffset + sect->offset, SEEK_SET) < 0)
   {
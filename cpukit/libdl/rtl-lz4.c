@@ -0,0 +1,121 @@
+/*
+ *  COPYRIGHT (c) 2015.
+ *  On-Line Applications Research Corporation (OAR).
+ *
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+/**
+ * @file
+ *
+ * @ingroup rtems_rtl
+ *
+ * @brief RTEMS Run-Time Linker LZ4 Block Decompressor.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "rtl-lz4.h"
+
+/**
+ * The minimum length of a match.
+ */
+#define RTEMS_RTL_LZ4_MIN_MATCH (4)
+
+/**
+ * Read the extension bytes of a length. Returns false if the input ends.
+ */
+static bool
+rtems_rtl_lz4_length (const uint8_t** ip, const uint8_t* iend, size_t* length)
+{
+  uint8_t b;
+  do
+  {
+    if (*ip >= iend)
+      return false;
+    b = *(*ip)++;
+    *length += b;
+  } while (b == 255);
+  return true;
+}
+
+int
+rtems_rtl_lz4_decompress (const void* input,
+                          int         length,
+                          void*       output,
+                          int         maxout)
+{
+  const uint8_t* ip = input;
+  const uint8_t* iend = ip + length;
+  uint8_t*       op = output;
+  uint8_t*       ostart = output;
+  uint8_t*       oend = op + maxout;
+
+  while (ip < iend)
+  {
+    const uint8_t* match;
+    unsigned int   token = *ip++;
+    size_t         literals = token >> 4;
+    size_t         matches = token & 0xf;
+    size_t         offset;
+
+    if ((literals == 15) && !rtems_rtl_lz4_length (&ip, iend, &literals))
+      return 0;
+
+    if ((literals > (size_t) (iend - ip)) || (literals > (size_t) (oend - op)))
+      return 0;
+
+    memcpy (op, ip, literals);
+    op += literals;
+    ip += literals;
+
+    /*
+     * The last sequence only has literals.
+     */
+    if (ip >= iend)
+      break;
+
+    if ((iend - ip) < 2)
+      return 0;
+
+    offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+
+    if ((offset == 0) || (offset > (size_t) (op - ostart)))
+      return 0;
+
+    if ((matches == 15) && !rtems_rtl_lz4_length (&ip, iend, &matches))
+      return 0;
+
+    matches += RTEMS_RTL_LZ4_MIN_MATCH;
+
+    if (matches > (size_t) (oend - op))
+      return 0;
+
+    match = op - offset;
+
+    /*
+     * A match can overlap the output when the offset is less than the length
+     * and repeats a pattern. Only then is a byte copy needed.
+     */
+    if (offset >= matches)
+    {
+      memcpy (op, match, matches);
+      op += matches;
+    }
+    else
+    {
+      while (matches--)
+        *op++ = *match++;
+    }
+  }
+
+  return op - ostart;
+}
@@ -0,0 +1,53 @@
+/*
+ *  COPYRIGHT (c) 2015.
+ *  On-Line Applications Research Corporation (OAR).
+ *
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+/**
+ * @file
+ *
+ * @ingroup rtems_rtl
+ *
+ * @brief RTEMS Run-Time Linker LZ4 Block Decompressor.
+ *
+ * The decompressor handles the LZ4 block format. A block is a series of
+ * sequences. A sequence is a token byte, the literal length extension bytes,
+ * the literals, a 16bit little endian match offset and the match length
+ * extension bytes. The upper 4 bits of the token are the literal length and
+ * the lower 4 bits are the match length less 4. A length of 15 is extended by
+ * the bytes that follow until a byte that is not 255. The last sequence of a
+ * block only has literals.
+ */
+
+#if !defined (_RTEMS_RTL_LZ4_H_)
+#define _RTEMS_RTL_LZ4_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Decompress a block of LZ4 compressed data. The interface matches the
+ * FastLZ decompressor.
+ *
+ * @param input The compressed block.
+ * @param length The length of the compressed block.
+ * @param output The buffer the decompressed data is written too.
+ * @param maxout The size of the output buffer. The decompressor never writes
+ *               past the end of the output buffer.
+ * @return int The size of the decompressed block or 0 if the block is
+ *             corrupted or does not fit the output buffer.
+ */
+int rtems_rtl_lz4_decompress (const void* input,
+                              int         length,
+                              void*       output,
+                              int         maxout);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif
@@ -22,6 +22,9 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <rtems/imfs.h>
+#include <rtems/libio_.h>
+
 #include <rtems/rtl/rtl-allocator.h>
 #include "rtl-obj-cache.h"
 #include "rtl-error.h"
@@ -34,6 +37,7 @@ rtems_rtl_obj_cache_open (rtems_rtl_obj_cache_t* cache, size_t size)
   cache->offset    = 0;
   cache->size      = size;
   cache->level     = 0;
+  cache->map       = NULL;
   cache->buffer    = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_OBJECT, size, false);
   if (!cache->buffer)
   {
@@ -50,6 +54,7 @@ rtems_rtl_obj_cache_close (rtems_rtl_obj_cache_t* cache)
   cache->fd        = -1;
   cache->file_size = 0;
   cache->level     = 0;
+  cache->map       = NULL;
 }
 
 void
@@ -58,6 +63,33 @@ rtems_rtl_obj_cache_flush (rtems_rtl_obj_cache_t* cache)
   cache->fd        = -1;
   cache->file_size = 0;
   cache->level     = 0;
+  cache->map       = NULL;
+}
+
+bool
+rtems_rtl_obj_cache_file_image (int             fd,
+                                const uint8_t** image,
+                                size_t*         size)
+{
+  rtems_libio_t*     iop = rtems_libio_iop (fd);
+  IMFS_linearfile_t* file;
+
+  if (!iop || ((iop->flags & LIBIO_FLAGS_OPEN) == 0))
+    return false;
+
+  /*
+   * Only the linear files are contiguous. A linear file opened for writing is
+   * converted to a memory file so the image cannot change under us.
+   */
+  if (iop->pathinfo.handlers != IMFS_node_control_linfile.handlers)
+    return false;
+
+  file = iop->pathinfo.node_access;
+
+  *image = file->direct;
+  *size = file->File.size;
+
+  return true;
 }
 
 bool
@@ -69,6 +101,40 @@ rtems_rtl_obj_cache_read (rtems_rtl_obj_cache_t* cache,
 {
   struct stat sb;
 
+  /*
+   * Map the file if it is held in memory. A mapped file is never read.
+   */
+  if (cache->fd != fd)
+  {
+    size_t file_size;
+
+    cache->map = NULL;
+
+    if (rtems_rtl_obj_cache_file_image (fd, &cache->map, &file_size))
+    {
+      cache->fd        = fd;
+      cache->file_size = file_size;
+      cache->offset    = 0;
+      cache->level     = 0;
+    }
+  }
+
+  if (cache->map != NULL)
+  {
+    if (offset > cache->file_size)
+    {
+      rtems_rtl_set_error (EINVAL, "offset past end of file: offset=%i size=%i",
+                           (int) offset, (int) cache->file_size);
+      return false;
+    }
+
+    if ((offset + *length) > cache->file_size)
+      *length = cache->file_size - offset;
+
+    *buffer = (void*) (cache->map + offset);
+    return true;
+  }
+
   if (*length > cache->size)
   {
     rtems_rtl_set_error (EINVAL, "read size larger than cache size");
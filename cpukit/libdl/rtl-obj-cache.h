@@ -33,6 +33,11 @@
  *
  * You can have more than one cache for a single file all looking at different
  * parts of the file.
+ *
+ * A file held in memory, for example an IMFS linear file created by the tar
+ * file loader, is mapped by the cache. Reads by reference return the location
+ * of the data in the file image and no data is copied. The size of the cache
+ * does not limit the length of a read of a mapped file.
  */
 
 #if !defined (_RTEMS_RTL_OBJ_CACHE_H_)
@@ -59,6 +64,7 @@ typedef struct rtems_rtl_obj_cache_s
   size_t   level;     /**< The amount of data in the cache. A file can be
                        * smaller than the cache file. */
   uint8_t* buffer;    /**< The buffer */
+  const uint8_t* map; /**< The file image if the file is mapped. */
 } rtems_rtl_obj_cache_t;
 
 /**
@@ -125,6 +131,21 @@ bool rtems_rtl_obj_cache_read_byval (rtems_rtl_obj_cache_t* cache,
                                      void*                  buffer,
                                      size_t                 length);
 
+/**
+ * Get the memory image of a file. Only files held in memory as a single
+ * contiguous block have an image. The image is valid while the file is open
+ * and read only.
+ *
+ * @param fd The file descriptor. Must be an open file.
+ * @param image The location to return the file image in.
+ * @param size The location to return the size of the file in.
+ * @retval true The file has an image.
+ * @retval false The file has no image and needs to be read.
+ */
+bool rtems_rtl_obj_cache_file_image (int             fd,
+                                     const uint8_t** image,
+                                     size_t*         size);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -27,6 +27,7 @@
 #include "rtl-error.h"
 
 #include "fastlz.h"
+#include "rtl-lz4.h"
 
 #include <stdio.h>
 
@@ -40,6 +41,7 @@ rtems_rtl_obj_comp_open (rtems_rtl_obj_comp_t*  comp,
   comp->offset = 0;
   comp->size   = size;
   comp->level  = 0;
+  comp->position = 0;
   comp->buffer = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_OBJECT, size, false);
   if (!comp->buffer)
   {
@@ -58,6 +60,7 @@ rtems_rtl_obj_comp_close (rtems_rtl_obj_comp_t* comp)
   comp->fd = -1;
   comp->compression = RTEMS_RTL_COMP_LZ77;
   comp->level = 0;
+  comp->position = 0;
   comp->size = 0;
   comp->offset = 0;
   comp->read = 0;
@@ -75,6 +78,7 @@ rtems_rtl_obj_comp_set (rtems_rtl_obj_comp_t*  comp,
   comp->compression = compression;
   comp->offset = offset;
   comp->level = 0;
+  comp->position = 0;
   comp->read = 0;
 }
 
@@ -94,6 +98,7 @@ rtems_rtl_obj_comp_read (rtems_rtl_obj_comp_t* comp,
   if (comp->fd != comp->cache->fd)
   {
     comp->level = 0;
+    comp->position = 0;
   }
 
   while (length)
@@ -104,24 +109,20 @@ rtems_rtl_obj_comp_read (rtems_rtl_obj_comp_t* comp,
 
     if (buffer_level)
     {
-      memcpy (bin, comp->buffer, buffer_level);
-
-      if ((comp->level - buffer_level) != 0)
-      {
-        memmove (comp->buffer,
-                 comp->buffer + buffer_level,
-                 comp->level - buffer_level);
-      }
+      memcpy (bin, comp->buffer + comp->position, buffer_level);
 
       bin += buffer_level;
       length -= buffer_level;
       comp->level -= buffer_level;
+      comp->position += buffer_level;
       comp->read += buffer_level;
     }
 
     if (length)
     {
       uint8_t* input = NULL;
+      uint8_t* output;
+      size_t   output_size;
       uint16_t block_size;
       size_t   in_length = sizeof (block_size);
       int      decompressed;
@@ -147,16 +148,46 @@ rtems_rtl_obj_comp_read (rtems_rtl_obj_comp_t* comp,
         return false;
       }
 
+      /*
+       * A block fits in the output buffer so if the caller wants at least
+       * that much decompress straight into the caller's buffer.
+       */
+      if (length >= comp->size)
+      {
+        output = bin;
+        output_size = length;
+      }
+      else
+      {
+        output = comp->buffer;
+        output_size = comp->size;
+      }
+
       switch (comp->compression)
       {
         case RTEMS_RTL_COMP_NONE:
-          memcpy (comp->buffer, input, in_length);
+          if (in_length > output_size)
+          {
+            rtems_rtl_set_error (EBADF, "uncompressed block too big");
+            return false;
+          }
+          memcpy (output, input, in_length);
           decompressed = in_length;
           break;
 
         case RTEMS_RTL_COMP_LZ77:
           decompressed = fastlz_decompress (input, in_length,
-                                            comp->buffer, comp->size);
+                                            output, output_size);
+          if (decompressed == 0)
+          {
+            rtems_rtl_set_error (EBADF, "decompression failed");
+            return false;
+          }
+          break;
+
+        case RTEMS_RTL_COMP_LZ4:
+          decompressed = rtems_rtl_lz4_decompress (input, in_length,
+                                                   output, output_size);
           if (decompressed == 0)
           {
             rtems_rtl_set_error (EBADF, "decompression failed");
@@ -171,7 +202,17 @@ rtems_rtl_obj_comp_read (rtems_rtl_obj_comp_t* comp,
 
       comp->offset += block_size;
 
-      comp->level = decompressed;
+      if (output == bin)
+      {
+        bin += decompressed;
+        length -= decompressed;
+        comp->read += decompressed;
+      }
+      else
+      {
+        comp->level = decompressed;
+        comp->position = 0;
+      }
     }
   }
 
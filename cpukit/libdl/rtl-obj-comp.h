@@ -18,6 +18,12 @@
  * data from a compressed file. The module exists to allocate the output
  * buffer when the loader starts and use the cache buffers will have been
  * allocated.
+ *
+ * The stream is a series of blocks. Each block is a 16bit big endian size
+ * followed by the compressed data. A block never decompresses to more than
+ * the size of the output buffer so a read of at least that size decompresses
+ * directly into the caller's buffer, for example a section's memory, and
+ * does not copy through the output buffer.
  */
 
 #if !defined (_RTEMS_RTL_OBJ_COMP_H_)
@@ -39,6 +45,7 @@ extern "C" {
  */
 #define RTEMS_RTL_COMP_NONE (0)
 #define RTEMS_RTL_COMP_LZ77 (1)
+#define RTEMS_RTL_COMP_LZ4  (2)
 
 /**
  * The compressed file.
@@ -52,6 +59,7 @@ typedef struct rtems_rtl_obj_cpmp_s
   off_t                  offset;      /**< The base offset of the buffer. */
   size_t                 size;        /**< The size of the output buffer. */
   size_t                 level;       /**< The amount of data in the buffer. */
+  size_t                 position;    /**< The read position in the buffer. */
   uint8_t*               buffer;      /**< The buffer */
   uint32_t               read;        /**< The amount of data read. */
 } rtems_rtl_obj_comp_t;
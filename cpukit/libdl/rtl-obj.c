@@ -1026,6 +1026,8 @@ bool
 rtems_rtl_obj_unload (rtems_rtl_obj_t* obj)
 {
   _rtld_linkmap_delete(obj);
+  if (obj->unresolved)
+    rtems_rtl_unresolved_erase_obj (obj);
   rtems_rtl_symbol_obj_erase (obj);
   return rtems_rtl_obj_free (obj);
 }
@@ -217,6 +217,77 @@ rtems_rtl_rap_loader (rtems_rtl_obj_t*      obj,
   return rtems_rtl_obj_comp_read (rap->decomp, sect->base, sect->size);
 }
 
+/**
+ * Apply the prelinked relocation records of a section. The host linker has
+ * resolved these relocations and left the value relative to the start of the
+ * referenced section in the target location. The record is a single word:
+ *
+ *  bits 31:28  The RAP section index of the referenced section.
+ *  bits 27:0   The offset of the target location in the target section.
+ *
+ * The records are read in blocks and the section base is added to each
+ * target location.
+ */
+static bool
+rtems_rtl_rap_relocate_prelinked (rtems_rtl_rap_t*      rap,
+                                  rtems_rtl_obj_t*      obj,
+                                  rtems_rtl_obj_sect_t* targetsect)
+{
+  #define PRELINK_BLOCK_SIZE (256)
+  uint8_t  block[PRELINK_BLOCK_SIZE * sizeof (uint32_t)];
+  Elf_Addr bases[RTEMS_RTL_RAP_SECS];
+  uint32_t relocs = 0;
+  int      section;
+
+  for (section = 0; section < RTEMS_RTL_RAP_SECS; ++section)
+  {
+    rtems_rtl_obj_sect_t* sect;
+
+    sect = rtems_rtl_obj_find_section_by_index (obj, section);
+    bases[section] = sect != NULL ? (Elf_Addr) sect->base : 0;
+  }
+
+  if (!rtems_rtl_rap_read_uint32 (rap->decomp, &relocs))
+    return false;
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_RELOC))
+    printf ("rtl: relocation: %s: prelinked: %lu\n",
+            targetsect->name, relocs);
+
+  while (relocs)
+  {
+    uint32_t count = relocs < PRELINK_BLOCK_SIZE ? relocs : PRELINK_BLOCK_SIZE;
+    uint32_t r;
+
+    if (!rtems_rtl_obj_comp_read (rap->decomp, block,
+                                  count * sizeof (uint32_t)))
+      return false;
+
+    for (r = 0; r < count; ++r)
+    {
+      uint32_t record = rtems_rtl_rap_get_uint32 (&block[r * sizeof (uint32_t)]);
+      uint32_t offset = record & 0xfffffff;
+      uint32_t symsect = record >> 28;
+      Elf_Addr value;
+
+      if ((symsect >= RTEMS_RTL_RAP_SECS) ||
+          ((offset + sizeof (value)) > targetsect->size))
+      {
+        rtems_rtl_set_error (EINVAL, "invalid prelinked reloc: %08lx", record);
+        return false;
+      }
+
+      memcpy (&value, (uint8_t*) targetsect->base + offset, sizeof (value));
+      value += bases[symsect];
+      memcpy ((uint8_t*) targetsect->base + offset, &value, sizeof (value));
+    }
+
+    relocs -= count;
+  }
+
+  return true;
+}
+
 static bool
 rtems_rtl_rap_relocate (rtems_rtl_rap_t* rap, rtems_rtl_obj_t* obj)
 {
@@ -259,11 +330,21 @@ rtems_rtl_rap_relocate (rtems_rtl_rap_t* rap, rtems_rtl_obj_t* obj)
 
     /*
      * Bit 31 of the header indicates if the relocations for this section
-     * have a valid addend field.
+     * have a valid addend field. Bit 30 indicates the section has prelinked
+     * relocation records. They are placed before the other records.
      */
 
     is_rela = (header & (1 << 31)) != 0 ? true : false;
-    relocs = header & ~(1 << 31);
+    relocs = header & ~(3 << 30);
+
+    if ((header & (1 << 30)) != 0)
+    {
+      if (!rtems_rtl_rap_relocate_prelinked (rap, obj, targetsect))
+      {
+        free (symname_buffer);
+        return false;
+      }
+    }
 
     if (relocs && rtems_rtl_trace (RTEMS_RTL_TRACE_RELOC))
       printf ("rtl: relocation: %s: header: %08lx relocs: %d %s\n",
@@ -636,7 +717,6 @@ rtems_rtl_rap_load_symbols (rtems_rtl_rap_t* rap, rtems_rtl_obj_t* obj)
       return false;
     }
 
-    rtems_chain_set_off_chain (&gsym->node);
     gsym->name = rap->strtab + name;
     gsym->value = (uint8_t*) (value + symsect->base);
     gsym->data = data & 0xffff;
@@ -699,7 +779,7 @@ rtems_rtl_rap_parse_header (uint8_t*  rhdr,
   sptr = eptr + 1;
 
   /*
-   * "NONE," and "LZ77," = 5 bytes, total 23
+   * "NONE," "LZ77," and "LZ4B," = 5 bytes, total 23
    */
 
   if ((sptr[0] == 'N') &&
@@ -718,6 +798,14 @@ rtems_rtl_rap_parse_header (uint8_t*  rhdr,
     *compression = RTEMS_RTL_COMP_LZ77;
     eptr = sptr + 4;
   }
+  else if ((sptr[0] == 'L') &&
+           (sptr[1] == 'Z') &&
+           (sptr[2] == '4') &&
+           (sptr[3] == 'B'))
+  {
+    *compression = RTEMS_RTL_COMP_LZ4;
+    eptr = sptr + 4;
+  }
   else
     return false;
 
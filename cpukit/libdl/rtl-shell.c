@@ -84,10 +84,9 @@ rtems_rtl_obj_summary_iterator (rtems_chain_node* node, void* data)
 static int
 rtems_rtl_count_symbols (rtems_rtl_data_t* rtl)
 {
-  int count;
-  int bucket;
-  for (count = 0, bucket = 0; bucket < rtl->globals.nbuckets; ++bucket)
-    count += rtems_rtl_chain_count (&rtl->globals.buckets[bucket]);
+  int count = rtl->globals.count;
+  if (rtl->globals.image)
+    count += rtl->globals.image->count;
   return count;
 }
 
@@ -253,7 +252,7 @@ rtems_rtl_unresolved_printer (rtems_rtl_unresolv_rec_t* rec,
 {
   rtems_rtl_obj_print_t* print = (rtems_rtl_obj_print_t*) data;
   if (rec->type == rtems_rtl_unresolved_name)
-    printf ("%-*c%s\n", print->indent + 2, ' ', rec->rec.name.name);
+    printf ("%-*c%s\n", print->indent + 2, ' ', rec->rec.name->name);
   return false;
 }
 
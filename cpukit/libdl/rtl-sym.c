@@ -21,6 +21,7 @@
 #include <inttypes.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <rtems/rtl/rtl.h>
 #include "rtl-error.h"
@@ -37,48 +38,221 @@ static rtems_rtl_obj_sym_t global_sym_add =
   .value = (void*) rtems_rtl_base_sym_global_add
 };
 
-static uint_fast32_t
+/**
+ * The slot marker of an erased symbol. A probe continues past it.
+ */
+static rtems_rtl_obj_sym_t erased_sym;
+
+uint32_t
 rtems_rtl_symbol_hash (const char *s)
 {
-  uint_fast32_t h = 5381;
+  uint32_t      h = 5381;
   unsigned char c;
   for (c = *s; c != '\0'; c = *++s)
     h = h * 33 + c;
-  return h & 0xffffffff;
+  return h;
+}
+
+static rtems_rtl_obj_sym_t*
+rtems_rtl_symbol_probe (const rtems_rtl_symbol_slot_t* slots,
+                        size_t                         nslots,
+                        const char*                    name,
+                        uint32_t                       hash)
+{
+  size_t mask = nslots - 1;
+  size_t i = hash & mask;
+
+  while (slots[i].symbol != NULL)
+  {
+    if ((slots[i].hash == hash) &&
+        (slots[i].symbol != &erased_sym) &&
+        (strcmp (name, slots[i].symbol->name) == 0))
+      return slots[i].symbol;
+    i = (i + 1) & mask;
+  }
+
+  return NULL;
+}
+
+static rtems_rtl_obj_sym_t*
+rtems_rtl_symbol_global_find_hashed (rtems_rtl_symbols_t* symbols,
+                                     const char*          name,
+                                     uint32_t             hash)
+{
+  rtems_rtl_obj_sym_t* sym = NULL;
+
+  /*
+   * The base image symbols are first so they cannot be overridden.
+   */
+  if (symbols->image)
+    sym = rtems_rtl_symbol_probe (symbols->image->slots,
+                                  symbols->image->nslots,
+                                  name, hash);
+
+  if (!sym)
+    sym = rtems_rtl_symbol_probe (symbols->slots, symbols->nslots, name, hash);
+
+  return sym;
 }
 
 static void
+rtems_rtl_symbol_slot_insert (rtems_rtl_symbol_slot_t* slots,
+                              size_t                   nslots,
+                              uint32_t                 hash,
+                              rtems_rtl_obj_sym_t*     symbol)
+{
+  size_t mask = nslots - 1;
+  size_t i = hash & mask;
+
+  while ((slots[i].symbol != NULL) && (slots[i].symbol != &erased_sym))
+    i = (i + 1) & mask;
+
+  slots[i].hash = hash;
+  slots[i].symbol = symbol;
+}
+
+/**
+ * Resize the table to hold the number of symbols without growing again. The
+ * slots of erased symbols are dropped. The stored hashes are used so no name
+ * is hashed.
+ */
+static bool
+rtems_rtl_symbol_table_resize (rtems_rtl_symbols_t* symbols, size_t count)
+{
+  rtems_rtl_symbol_slot_t* slots;
+  size_t                   nslots = symbols->nslots;
+  size_t                   s;
+
+  while ((count * 4) >= (nslots * 3))
+    nslots *= 2;
+
+  slots = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_SYMBOL,
+                               nslots * sizeof (rtems_rtl_symbol_slot_t),
+                               true);
+  if (!slots)
+  {
+    rtems_rtl_set_error (ENOMEM, "no memory to resize global symbol table");
+    return false;
+  }
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_GLOBAL_SYM))
+    printf ("rtl: global symbol table resize: %zi -> %zi\n",
+            symbols->nslots, nslots);
+
+  for (s = 0; s < symbols->nslots; ++s)
+  {
+    rtems_rtl_symbol_slot_t* slot = &symbols->slots[s];
+    if ((slot->symbol != NULL) && (slot->symbol != &erased_sym))
+      rtems_rtl_symbol_slot_insert (slots, nslots, slot->hash, slot->symbol);
+  }
+
+  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, symbols->slots);
+
+  symbols->slots = slots;
+  symbols->nslots = nslots;
+  symbols->used = symbols->count;
+
+  return true;
+}
+
+/**
+ * Make room for the number of symbols to be inserted.
+ */
+static bool
+rtems_rtl_symbol_table_reserve (rtems_rtl_symbols_t* symbols, size_t count)
+{
+  if (((symbols->used + count) * 4) < (symbols->nslots * 3))
+    return true;
+  return rtems_rtl_symbol_table_resize (symbols, symbols->count + count);
+}
+
+static bool
 rtems_rtl_symbol_global_insert (rtems_rtl_symbols_t* symbols,
+                                rtems_rtl_obj_sym_t* symbol,
+                                uint32_t             hash)
+{
+  if (!rtems_rtl_symbol_table_reserve (symbols, 1))
+    return false;
+  rtems_rtl_symbol_slot_insert (symbols->slots, symbols->nslots, hash, symbol);
+  ++symbols->count;
+  ++symbols->used;
+  return true;
+}
+
+static void
+rtems_rtl_symbol_global_remove (rtems_rtl_symbols_t* symbols,
                                 rtems_rtl_obj_sym_t* symbol)
 {
-  uint_fast32_t hash = rtems_rtl_symbol_hash (symbol->name);
-  rtems_chain_append (&symbols->buckets[hash % symbols->nbuckets],
-                      &symbol->node);
+  size_t mask = symbols->nslots - 1;
+  size_t i = rtems_rtl_symbol_hash (symbol->name) & mask;
+
+  while (symbols->slots[i].symbol != NULL)
+  {
+    if (symbols->slots[i].symbol == symbol)
+    {
+      symbols->slots[i].symbol = &erased_sym;
+      --symbols->count;
+      return;
+    }
+    i = (i + 1) & mask;
+  }
 }
 
 bool
 rtems_rtl_symbol_table_open (rtems_rtl_symbols_t* symbols,
-                             size_t               buckets)
+                             size_t               slots)
 {
-  symbols->buckets = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_SYMBOL,
-                                          buckets * sizeof (rtems_chain_control),
-                                          true);
-  if (!symbols->buckets)
+  size_t nslots = 1;
+
+  while (nslots < slots)
+    nslots *= 2;
+
+  symbols->slots = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_SYMBOL,
+                                        nslots * sizeof (rtems_rtl_symbol_slot_t),
+                                        true);
+  if (!symbols->slots)
   {
     rtems_rtl_set_error (ENOMEM, "no memory for global symbol table");
     return false;
   }
-  symbols->nbuckets = buckets;
-  for (buckets = 0; buckets < symbols->nbuckets; ++buckets)
-    rtems_chain_initialize_empty (&symbols->buckets[buckets]);
-  rtems_rtl_symbol_global_insert (symbols, &global_sym_add);
-  return true;
+  symbols->nslots = nslots;
+  symbols->count = 0;
+  symbols->used = 0;
+  symbols->image = NULL;
+  return rtems_rtl_symbol_global_insert (symbols, &global_sym_add,
+                                         rtems_rtl_symbol_hash (global_sym_add.name));
 }
 
 void
 rtems_rtl_symbol_table_close (rtems_rtl_symbols_t* symbols)
 {
-  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, symbols->buckets);
+  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, symbols->slots);
+  symbols->slots = NULL;
+  symbols->nslots = 0;
+  symbols->count = 0;
+  symbols->used = 0;
+  symbols->image = NULL;
+}
+
+bool
+rtems_rtl_symbol_table_image (rtems_rtl_symbols_t*            symbols,
+                              const rtems_rtl_symbol_image_t* image)
+{
+  if ((image->nslots == 0) ||
+      ((image->nslots & (image->nslots - 1)) != 0) ||
+      (image->count >= image->nslots))
+  {
+    rtems_rtl_set_error (EINVAL, "invalid prebuilt symbol table");
+    return false;
+  }
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_GLOBAL_SYM))
+    printf ("rtl: global symbol image: %zi symbols in %zi slots\n",
+            image->count, image->nslots);
+
+  symbols->image = image;
+
+  return true;
 }
 
 bool
@@ -138,6 +312,17 @@ rtems_rtl_symbol_global_add (rtems_rtl_obj_t*     obj,
 
   symbols = rtems_rtl_global_symbols ();
 
+  /*
+   * Grow the table once for all symbols.
+   */
+  if (!rtems_rtl_symbol_table_reserve (symbols, count))
+  {
+    rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, obj->global_table);
+    obj->global_table = NULL;
+    obj->global_size = 0;
+    return false;
+  }
+
   s = 0;
   sym = obj->global_table;
 
@@ -152,7 +337,8 @@ rtems_rtl_symbol_global_add (rtems_rtl_obj_t*     obj,
       uint8_t data[sizeof (void*)];
       void*   value;
     } copy_voidp;
-    int b;
+    uint32_t hash;
+    int      b;
 
     sym->name = (const char*) &esyms[s];
     s += strlen (sym->name) + 1;
@@ -161,8 +347,9 @@ rtems_rtl_symbol_global_add (rtems_rtl_obj_t*     obj,
     sym->value = copy_voidp.value;
     if (rtems_rtl_trace (RTEMS_RTL_TRACE_GLOBAL_SYM))
       printf ("rtl: esyms: %s -> %8p\n", sym->name, sym->value);
-    if (rtems_rtl_symbol_global_find (sym->name) == NULL)
-      rtems_rtl_symbol_global_insert (symbols, sym);
+    hash = rtems_rtl_symbol_hash (sym->name);
+    if (rtems_rtl_symbol_global_find_hashed (symbols, sym->name, hash) == NULL)
+      rtems_rtl_symbol_global_insert (symbols, sym, hash);
     ++sym;
   }
 
@@ -175,28 +362,11 @@ rtems_rtl_obj_sym_t*
 rtems_rtl_symbol_global_find (const char* name)
 {
   rtems_rtl_symbols_t* symbols;
-  uint_fast32_t        hash;
-  rtems_chain_control* bucket;
-  rtems_chain_node*    node;
 
   symbols = rtems_rtl_global_symbols ();
 
-  hash = rtems_rtl_symbol_hash (name);
-  bucket = &symbols->buckets[hash % symbols->nbuckets];
-  node = rtems_chain_first (bucket);
-
-  while (!rtems_chain_is_tail (bucket, node))
-  {
-    rtems_rtl_obj_sym_t* sym = (rtems_rtl_obj_sym_t*) node;
-    /*
-     * Use the hash. I could add this to the symbol but it uses more memory.
-     */
-    if (strcmp (name, sym->name) == 0)
-      return sym;
-    node = rtems_chain_next (node);
-  }
-
-  return NULL;
+  return rtems_rtl_symbol_global_find_hashed (symbols, name,
+                                              rtems_rtl_symbol_hash (name));
 }
 
 rtems_rtl_obj_sym_t*
@@ -223,7 +393,7 @@ rtems_rtl_symbol_obj_find (rtems_rtl_obj_t* obj, const char* name)
   return rtems_rtl_symbol_global_find (name);
 }
 
-void
+bool
 rtems_rtl_symbol_obj_add (rtems_rtl_obj_t* obj)
 {
   rtems_rtl_symbols_t* symbols;
@@ -232,8 +402,14 @@ rtems_rtl_symbol_obj_add (rtems_rtl_obj_t* obj)
 
   symbols = rtems_rtl_global_symbols ();
 
+  if (!rtems_rtl_symbol_table_reserve (symbols, obj->global_syms))
+    return false;
+
   for (s = 0, sym = obj->global_table; s < obj->global_syms; ++s, ++sym)
-    rtems_rtl_symbol_global_insert (symbols, sym);
+    rtems_rtl_symbol_global_insert (symbols, sym,
+                                    rtems_rtl_symbol_hash (sym->name));
+
+  return true;
 }
 
 void
@@ -254,11 +430,11 @@ rtems_rtl_symbol_obj_erase (rtems_rtl_obj_t* obj)
   rtems_rtl_symbol_obj_erase_local (obj);
   if (obj->global_table)
   {
+    rtems_rtl_symbols_t* symbols = rtems_rtl_global_symbols ();
     rtems_rtl_obj_sym_t* sym;
     size_t               s;
     for (s = 0, sym = obj->global_table; s < obj->global_syms; ++s, ++sym)
-        if (!rtems_chain_is_node_off_chain (&sym->node))
-          rtems_chain_extract (&sym->node);
+      rtems_rtl_symbol_global_remove (symbols, sym);
     rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, obj->global_table);
     obj->global_table = NULL;
     obj->global_size = 0;
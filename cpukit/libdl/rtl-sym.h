@@ -28,32 +28,74 @@ extern "C" {
  */
 typedef struct rtems_rtl_obj_sym_s
 {
-  rtems_chain_node node;    /**< The node's link in the chain. */
   const char*      name;    /**< The symbol's name. */
   void*            value;   /**< The value of the symbol. */
   uint32_t         data;    /**< Format specific data. */
 } rtems_rtl_obj_sym_t;
 
 /**
- * Table of symbols stored in a hash table.
+ * A slot of a symbol hash table. The hash of the name is held in the slot so
+ * a probe only compares the names of symbols with a matching hash and the
+ * table can be resized without hashing the names again.
+ */
+typedef struct rtems_rtl_symbol_slot_s
+{
+  uint32_t             hash;    /**< The hash of the symbol's name. */
+  rtems_rtl_obj_sym_t* symbol;  /**< The symbol, NULL if the slot is free. */
+} rtems_rtl_symbol_slot_t;
+
+/**
+ * A prebuilt symbol table, for example the base image's symbol table
+ * generated at link time. The table is an open addressing hash table with
+ * linear probing. A symbol is placed in the first free slot at or after the
+ * slot given by its hash modulo the number of slots, wrapping at the end of
+ * the table. The hash is calculated with rtems_rtl_symbol_hash. The number of
+ * slots is a power of 2 and at least one slot is free.
+ */
+typedef struct rtems_rtl_symbol_image_s
+{
+  const rtems_rtl_symbol_slot_t* slots;  /**< The table's slots. */
+  size_t                         nslots; /**< The number of slots. */
+  size_t                         count;  /**< The number of symbols. */
+} rtems_rtl_symbol_image_t;
+
+/**
+ * Table of symbols stored in an open addressing hash table. The table grows
+ * when it is three quarters full. A prebuilt image searched before the table
+ * can be attached.
  */
 typedef struct rtems_rtl_symbols_s
 {
-  rtems_chain_control* buckets;
-  size_t               nbuckets;
+  rtems_rtl_symbol_slot_t*        slots;  /**< The table's slots. */
+  size_t                          nslots; /**< The number of slots, a power
+                                           *   of 2. */
+  size_t                          count;  /**< The number of symbols. */
+  size_t                          used;   /**< The number of symbols and
+                                           *   erased symbol slots. */
+  const rtems_rtl_symbol_image_t* image;  /**< The prebuilt table. */
 } rtems_rtl_symbols_t;
 
 /**
- * Open a symbol table with the specified number of buckets.
+ * The hash of a symbol name. Tools generating a prebuilt symbol table need to
+ * use the same hash.
+ *
+ * @param name The name as an ASCIIZ string.
+ * @return uint32_t The hash of the name.
+ */
+uint32_t rtems_rtl_symbol_hash (const char* name);
+
+/**
+ * Open a symbol table with the specified initial number of slots.
  *
  * @param symbols The symbol table to open.
- * @param buckets The number of buckets in the hash table.
+ * @param slots The initial number of slots in the hash table. It is rounded
+ *              up to a power of 2.
  * @retval true The symbol is open.
  * @retval false The symbol table could not created. The RTL
  *               error has the error.
  */
 bool rtems_rtl_symbol_table_open (rtems_rtl_symbols_t* symbols,
-                                  size_t               buckets);
+                                  size_t               slots);
 
 /**
  * Close the table and erase the hash table.
@@ -62,6 +104,19 @@ bool rtems_rtl_symbol_table_open (rtems_rtl_symbols_t* symbols,
  */
 void rtems_rtl_symbol_table_close (rtems_rtl_symbols_t* symbols);
 
+/**
+ * Attach a prebuilt symbol table to the symbol table. The symbols in the
+ * prebuilt table are found before the symbols added to the table. The
+ * prebuilt table is referenced and not copied.
+ *
+ * @param symbols The symbol table.
+ * @param image The prebuilt symbol table.
+ * @retval true The prebuilt table is attached.
+ * @retval false The prebuilt table is not valid. The RTL error is set.
+ */
+bool rtems_rtl_symbol_table_image (rtems_rtl_symbols_t*            symbols,
+                                   const rtems_rtl_symbol_image_t* image);
+
 /**
  * Add a table of exported symbols to the symbol table.
  *
@@ -111,8 +166,10 @@ rtems_rtl_obj_sym_t* rtems_rtl_symbol_obj_find (rtems_rtl_obj_t* obj,
  * Add the object file's symbols to the global table.
  *
  * @param obj The object file the symbols are to be added.
+ * @retval true The symbols have been added.
+ * @retval false No memory to grow the table. The RTL error is set.
  */
-void rtems_rtl_symbol_obj_add (rtems_rtl_obj_t* obj);
+bool rtems_rtl_symbol_obj_add (rtems_rtl_obj_t* obj);
 
 /**
  * Erase the object file's local symbols.
@@ -21,298 +21,248 @@
 #include <inttypes.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <rtems/rtl/rtl.h>
 #include "rtl-error.h"
+#include "rtl-sym.h"
 #include "rtl-unresolved.h"
 #include "rtl-trace.h"
 
-static rtems_rtl_unresolv_block_t*
-rtems_rtl_unresolved_block_alloc (rtems_rtl_unresolved_t* unresolved)
-{
-  /*
-   * The block header contains a record.
-   */
-  size_t size =
-    (sizeof(rtems_rtl_unresolv_block_t) +
-     (sizeof(rtems_rtl_unresolv_rec_t) * (unresolved->block_recs - 1)));
-  rtems_rtl_unresolv_block_t* block =
-    rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_EXTERNAL, size, true);
-  if (block)
-    rtems_chain_append (&unresolved->blocks, &block->link);
-  else
-    rtems_rtl_set_error (ENOMEM, "no memory for unresolved block");
-  return block;
-}
-
-static size_t
-rtems_rtl_unresolved_name_recs (const char* name)
-{
-  size_t length = strlen (name);
-  return ((length + sizeof(rtems_rtl_unresolv_name_t) - 1) /
-          sizeof(rtems_rtl_unresolv_name_t));
-}
+/**
+ * The number of relocation records a name entry is first allocated. The array
+ * doubles in size when full.
+ */
+#define RTEMS_RTL_UNRESOLVED_NAME_RELOCS (4)
 
-static int
-rtems_rtl_unresolved_rec_index (rtems_rtl_unresolv_block_t* block,
-                                rtems_rtl_unresolv_rec_t* rec)
+static rtems_chain_control*
+rtems_rtl_unresolved_bucket (rtems_rtl_unresolved_t* unresolved,
+                             uint32_t                hash)
 {
-  return (rec - &block->rec) / sizeof (rtems_rtl_unresolv_rec_t);
+  return &unresolved->buckets[hash & (unresolved->nbuckets - 1)];
 }
 
-static rtems_rtl_unresolv_rec_t*
-rtems_rtl_unresolved_rec_first (rtems_rtl_unresolv_block_t* block)
+static rtems_rtl_unresolv_name_t*
+rtems_rtl_unresolved_find_name (rtems_rtl_unresolved_t* unresolved,
+                                const char*             name,
+                                uint32_t                hash)
 {
-  return &block->rec;
+  rtems_chain_control* bucket = rtems_rtl_unresolved_bucket (unresolved, hash);
+  rtems_chain_node*    node = rtems_chain_first (bucket);
+  while (!rtems_chain_is_tail (bucket, node))
+  {
+    rtems_rtl_unresolv_name_t* entry = (rtems_rtl_unresolv_name_t*) node;
+    if ((entry->hash == hash) && (strcmp (entry->name, name) == 0))
+      return entry;
+    node = rtems_chain_next (node);
+  }
+  return NULL;
 }
 
-static rtems_rtl_unresolv_rec_t*
-rtems_rtl_unresolved_rec_next (rtems_rtl_unresolv_rec_t* rec)
+/**
+ * Double the number of buckets and move the names using the stored hash. If
+ * there is no memory the table stays as it is. The chains are longer but the
+ * table still works.
+ */
+static void
+rtems_rtl_unresolved_grow (rtems_rtl_unresolved_t* unresolved)
 {
+  rtems_chain_control* buckets;
+  size_t               nbuckets = unresolved->nbuckets * 2;
+  size_t               b;
 
-  switch (rec->type)
-  {
-    case rtems_rtl_unresolved_empty:
-      /*
-       * Empty returns NULL. The end of the records in the block.
-       */
-      rec = NULL;
-      break;
-
-    case rtems_rtl_unresolved_name:
-      /*
-       * Determine how many records the name occupies. Round up.
-       */
-      rec += ((rec->rec.name.length + sizeof(rtems_rtl_unresolv_name_t) - 1) /
-              sizeof(rtems_rtl_unresolv_name_t));
-      break;
+  buckets = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_EXTERNAL,
+                                 nbuckets * sizeof (rtems_chain_control),
+                                 true);
+  if (!buckets)
+    return;
 
-    case rtems_rtl_unresolved_reloc:
-      ++rec;
-      break;
+  for (b = 0; b < nbuckets; ++b)
+    rtems_chain_initialize_empty (&buckets[b]);
 
-    default:
-      break;
+  for (b = 0; b < unresolved->nbuckets; ++b)
+  {
+    rtems_chain_control* bucket = &unresolved->buckets[b];
+    while (!rtems_chain_is_empty (bucket))
+    {
+      rtems_rtl_unresolv_name_t* entry;
+      entry = (rtems_rtl_unresolv_name_t*) rtems_chain_get_unprotected (bucket);
+      rtems_chain_append_unprotected (&buckets[entry->hash & (nbuckets - 1)],
+                                      &entry->node);
+    }
   }
 
-  return rec;
-}
+  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_EXTERNAL, unresolved->buckets);
 
-static bool
-rtems_rtl_unresolved_rec_is_last (rtems_rtl_unresolv_block_t* block,
-                                  rtems_rtl_unresolv_rec_t*   rec)
-{
-  int index = (rec - &block->rec) / sizeof (rec);
-  return !rec || (index >= block->recs) || (rec->type == rtems_rtl_unresolved_empty);
+  unresolved->buckets = buckets;
+  unresolved->nbuckets = nbuckets;
 }
 
-static rtems_rtl_unresolv_rec_t*
-rtems_rtl_unresolved_rec_first_free (rtems_rtl_unresolv_block_t* block)
+static rtems_rtl_unresolv_name_t*
+rtems_rtl_unresolved_add_name (rtems_rtl_unresolved_t* unresolved,
+                               const char*             name,
+                               uint32_t                hash)
 {
-  return &block->rec + block->recs;
-}
+  rtems_rtl_unresolv_name_t* entry;
+  rtems_chain_control*       bucket;
+  size_t                     length = strlen (name);
 
-static int
-rtems_rtl_unresolved_find_name (rtems_rtl_unresolved_t* unresolved,
-                                const char*             name,
-                                bool                    update_refcount)
-{
-  size_t length = strlen (name);
-  int    index = 1;
+  if (unresolved->names >= unresolved->nbuckets)
+    rtems_rtl_unresolved_grow (unresolved);
 
-  rtems_chain_node* node = rtems_chain_first (&unresolved->blocks);
-  while (!rtems_chain_is_tail (&unresolved->blocks, node))
+  /*
+   * The name is held after the entry and is copied because it may reference
+   * the object file's string cache.
+   */
+  entry = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_EXTERNAL,
+                               sizeof (rtems_rtl_unresolv_name_t) + length + 1,
+                               true);
+  if (!entry)
   {
-    rtems_rtl_unresolv_block_t* block = (rtems_rtl_unresolv_block_t*) node;
-    rtems_rtl_unresolv_rec_t* rec = rtems_rtl_unresolved_rec_first (block);
+    rtems_rtl_set_error (ENOMEM, "no memory for unresolved name");
+    return NULL;
+  }
 
-    while (!rtems_rtl_unresolved_rec_is_last (block, rec))
-    {
-      if (rec->type == rtems_rtl_unresolved_name)
-      {
-        if ((rec->rec.name.length == length)
-            && (strcmp (rec->rec.name.name, name)))
-        {
-          if (update_refcount)
-            ++rec->rec.name.refs;
-          return index;
-        }
-        ++index;
-      }
-      rec = rtems_rtl_unresolved_rec_next (rec);
-    }
+  memcpy ((char*) (entry + 1), name, length + 1);
+  entry->hash = hash;
+  entry->length = length;
+  entry->name = (const char*) (entry + 1);
 
-    node = rtems_chain_next (node);
-  }
+  bucket = rtems_rtl_unresolved_bucket (unresolved, hash);
+  rtems_chain_append_unprotected (bucket, &entry->node);
+  ++unresolved->names;
 
-  return 0 - index;
+  return entry;
 }
 
-/**
- * Struct to pass relocation data in the interator.
- */
-typedef struct rtems_rtl_unresolved_reloc_data_s
-{
-  uint16_t                  name;     /**< Name index. */
-  rtems_rtl_unresolv_rec_t* name_rec; /**< Name record. */
-  rtems_rtl_obj_sym_t*      sym;      /**< The symbol record. */
-} rtems_rtl_unresolved_reloc_data_t;
-
-static bool
-rtems_rtl_unresolved_resolve_reloc (rtems_rtl_unresolv_rec_t* rec,
-                                    void*                     data)
+static void
+rtems_rtl_unresolved_remove_name (rtems_rtl_unresolved_t*    unresolved,
+                                  rtems_rtl_unresolv_name_t* entry)
 {
-  if (rec->type == rtems_rtl_unresolved_reloc)
-  {
-    rtems_rtl_unresolved_reloc_data_t* rd;
-    rd = (rtems_rtl_unresolved_reloc_data_t*) data;
-
-    if (rec->rec.reloc.name == rd->name)
-    {
-      if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
-        printf ("rtl: unresolv: resolve reloc: %s\n", rd->name_rec->rec.name.name);
-
-      rtems_rtl_obj_relocate_unresolved (&rec->rec.reloc, rd->sym);
-
-      /*
-       * Set the object pointer to NULL to indicate the record is not used
-       * anymore. Update the reference count of the name. The sweep after
-       * relocating will remove the reloc records with obj set to NULL and
-       * names with a reference count of 0.
-       */
-      rec->rec.reloc.obj = NULL;
-      if (rd->name_rec && rd->name_rec->rec.name.refs)
-        --rd->name_rec->rec.name.refs;
-    }
-  }
-  return false;
+  rtems_chain_extract_unprotected (&entry->node);
+  unresolved->relocs -= entry->relocs;
+  --unresolved->names;
+  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_EXTERNAL, entry->reloc);
+  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_EXTERNAL, entry);
 }
 
-static bool
-rtems_rtl_unresolved_resolve_iterator (rtems_rtl_unresolv_rec_t* rec,
-                                       void*                     data)
+static rtems_rtl_unresolv_reloc_t*
+rtems_rtl_unresolved_add_reloc (rtems_rtl_unresolved_t*    unresolved,
+                                rtems_rtl_unresolv_name_t* entry)
 {
-  if (rec->type == rtems_rtl_unresolved_name)
+  if (entry->relocs >= entry->size)
   {
-    rtems_rtl_unresolved_reloc_data_t* rd;
-    rd = (rtems_rtl_unresolved_reloc_data_t*) data;
-
-    ++rd->name;
-
-    if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
-      printf ("rtl: unresolv: lookup: %d: %s\n", rd->name, rec->rec.name.name);
+    rtems_rtl_unresolv_reloc_t* reloc;
+    size_t                      size;
 
-    rd->sym = rtems_rtl_symbol_global_find (rec->rec.name.name);
+    size = entry->size ? entry->size * 2 : RTEMS_RTL_UNRESOLVED_NAME_RELOCS;
 
-    if (rd->sym)
+    reloc = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_EXTERNAL,
+                                 size * sizeof (rtems_rtl_unresolv_reloc_t),
+                                 false);
+    if (!reloc)
     {
-      if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
-        printf ("rtl: unresolv: found: %s\n", rec->rec.name.name);
-
-      rd->name_rec = rec;
-
-      rtems_rtl_unresolved_interate (rtems_rtl_unresolved_resolve_reloc, rd);
+      rtems_rtl_set_error (ENOMEM, "no memory for unresolved reloc");
+      return NULL;
+    }
 
-      rd->name_rec = NULL;
-      rd->sym = NULL;
+    if (entry->reloc)
+    {
+      memcpy (reloc, entry->reloc,
+              entry->relocs * sizeof (rtems_rtl_unresolv_reloc_t));
+      rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_EXTERNAL, entry->reloc);
     }
+
+    entry->reloc = reloc;
+    entry->size = size;
   }
 
-  return false;
+  ++unresolved->relocs;
+  return &entry->reloc[entry->relocs++];
 }
 
 static void
-rtems_rtl_unresolved_clean_block (rtems_rtl_unresolv_block_t* block,
-                                  rtems_rtl_unresolv_rec_t* rec,
-                                  size_t count,
-                                  size_t recs_per_block)
+rtems_rtl_unresolved_remove_reloc (rtems_rtl_unresolved_t*    unresolved,
+                                   rtems_rtl_unresolv_name_t* entry,
+                                   size_t                     r)
 {
-  size_t index = rtems_rtl_unresolved_rec_index (block, rec);
-  size_t bytes =
-    (block->recs - index - count) * sizeof (rtems_rtl_unresolv_rec_t);
-  if (bytes)
-    memmove (rec, rec + count, bytes);
-  --block->recs;
-  bytes = count * sizeof (rtems_rtl_unresolv_rec_t);
-  memset (&block->rec + block->recs, 0, bytes);
+  /*
+   * The order of the relocation records does not matter so the last record
+   * fills the hole.
+   */
+  --entry->relocs;
+  --unresolved->relocs;
+  if (r < entry->relocs)
+    entry->reloc[r] = entry->reloc[entry->relocs];
 }
 
+/**
+ * Apply the relocations waiting on the name with the symbol then remove the
+ * name from the table.
+ */
 static void
-rtems_rtl_unresolved_compact (void)
+rtems_rtl_unresolved_resolve_name (rtems_rtl_unresolved_t*    unresolved,
+                                   rtems_rtl_unresolv_name_t* entry,
+                                   rtems_rtl_obj_sym_t*       sym)
 {
-  rtems_rtl_unresolved_t* unresolved = rtems_rtl_unresolved ();
-  if (unresolved)
-  {
-    /*
-     * Iterate backwards over the blocks removing any used records. A block is
-     * compacted moving up the block.
-     */
-    rtems_chain_node* node = rtems_chain_last (&unresolved->blocks);
-    while (!rtems_chain_is_head (&unresolved->blocks, node))
-    {
-      rtems_chain_node* prev = rtems_chain_previous (node);
-      rtems_rtl_unresolv_block_t* block = (rtems_rtl_unresolv_block_t*) node;
-      rtems_rtl_unresolv_rec_t* rec = rtems_rtl_unresolved_rec_first (block);
+  size_t r;
 
-      while (!rtems_rtl_unresolved_rec_is_last (block, rec))
-      {
-        bool next = true;
-
-        if (rec->type == rtems_rtl_unresolved_name)
-        {
-          if (rec->rec.name.refs == 0)
-          {
-            size_t name_recs = rtems_rtl_unresolved_name_recs (rec->rec.name.name);
-            rtems_rtl_unresolved_clean_block (block, rec, name_recs,
-                                              unresolved->block_recs);
-            next = false;
-          }
-        }
-        else if (rec->type == rtems_rtl_unresolved_reloc)
-        {
-          if (!rec->rec.reloc.obj)
-          {
-            rtems_rtl_unresolved_clean_block (block, rec, 1,
-                                              unresolved->block_recs);
-            next = false;
-          }
-        }
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
+    printf ("rtl: unresolv: found: %s (%zu relocs)\n",
+            entry->name, entry->relocs);
 
-        if (next)
-          rec = rtems_rtl_unresolved_rec_next (rec);
-      }
+  for (r = 0; r < entry->relocs; ++r)
+  {
+    rtems_rtl_unresolv_reloc_t* reloc = &entry->reloc[r];
 
-      if (block->recs == 0)
-      {
-        rtems_chain_extract (node);
-        free (block);
-      }
+    if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
+      printf ("rtl: unresolv: resolve reloc: %s\n", entry->name);
 
-      node = prev;
-    }
+    rtems_rtl_obj_relocate_unresolved (reloc, sym);
   }
+
+  rtems_rtl_unresolved_remove_name (unresolved, entry);
 }
 
 bool
 rtems_rtl_unresolved_table_open (rtems_rtl_unresolved_t* unresolved,
-                                 size_t                  block_recs)
+                                 size_t                  buckets)
 {
+  size_t b;
   unresolved->marker = 0xdeadf00d;
-  unresolved->block_recs = block_recs;
-  rtems_chain_initialize_empty (&unresolved->blocks);
+  unresolved->buckets = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_EXTERNAL,
+                                             buckets * sizeof (rtems_chain_control),
+                                             true);
+  if (!unresolved->buckets)
+  {
+    rtems_rtl_set_error (ENOMEM, "no memory for unresolved table");
+    return false;
+  }
+  for (b = 0; b < buckets; ++b)
+    rtems_chain_initialize_empty (&unresolved->buckets[b]);
+  unresolved->nbuckets = buckets;
+  unresolved->names = 0;
+  unresolved->relocs = 0;
   return true;
 }
 
 void
 rtems_rtl_unresolved_table_close (rtems_rtl_unresolved_t* unresolved)
 {
-  rtems_chain_node* node = rtems_chain_first (&unresolved->blocks);
-  while (!rtems_chain_is_tail (&unresolved->blocks, node))
+  size_t b;
+  for (b = 0; b < unresolved->nbuckets; ++b)
   {
-    rtems_chain_node* next = rtems_chain_next (node);
-    free (node);
-    node = next;
+    rtems_chain_control* bucket = &unresolved->buckets[b];
+    while (!rtems_chain_is_empty (bucket))
+    {
+      rtems_rtl_unresolv_name_t* entry;
+      entry = (rtems_rtl_unresolv_name_t*) rtems_chain_first (bucket);
+      rtems_rtl_unresolved_remove_name (unresolved, entry);
+    }
   }
+  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_EXTERNAL, unresolved->buckets);
+  unresolved->buckets = NULL;
+  unresolved->nbuckets = 0;
 }
 
 bool
@@ -322,20 +272,32 @@ rtems_rtl_unresolved_interate (rtems_rtl_unresolved_iterator_t iterator,
   rtems_rtl_unresolved_t* unresolved = rtems_rtl_unresolved ();
   if (unresolved)
   {
-    rtems_chain_node* node = rtems_chain_first (&unresolved->blocks);
-    while (!rtems_chain_is_tail (&unresolved->blocks, node))
+    size_t b;
+    for (b = 0; b < unresolved->nbuckets; ++b)
     {
-      rtems_rtl_unresolv_block_t* block = (rtems_rtl_unresolv_block_t*) node;
-      rtems_rtl_unresolv_rec_t* rec = rtems_rtl_unresolved_rec_first (block);
-
-      while (!rtems_rtl_unresolved_rec_is_last (block, rec))
+      rtems_chain_control* bucket = &unresolved->buckets[b];
+      rtems_chain_node*    node = rtems_chain_first (bucket);
+      while (!rtems_chain_is_tail (bucket, node))
       {
-        if (iterator (rec, data))
+        rtems_rtl_unresolv_name_t* entry = (rtems_rtl_unresolv_name_t*) node;
+        rtems_rtl_unresolv_rec_t   rec;
+        size_t                     r;
+
+        rec.type = rtems_rtl_unresolved_name;
+        rec.rec.name = entry;
+        if (iterator (&rec, data))
           return true;
-        rec = rtems_rtl_unresolved_rec_next (rec);
-      }
 
-      node = rtems_chain_next (node);
+        for (r = 0; r < entry->relocs; ++r)
+        {
+          rec.type = rtems_rtl_unresolved_reloc;
+          rec.rec.reloc = &entry->reloc[r];
+          if (iterator (&rec, data))
+            return true;
+        }
+
+        node = rtems_chain_next (node);
+      }
     }
   }
   return false;
@@ -348,12 +310,10 @@ rtems_rtl_unresolved_add (rtems_rtl_obj_t*        obj,
                           const uint16_t          sect,
                           const rtems_rtl_word_t* rel)
 {
-  rtems_rtl_unresolved_t* unresolved;
-  rtems_chain_node* node;
-  rtems_rtl_unresolv_block_t* block;
-  rtems_rtl_unresolv_rec_t* rec;
-  int name_index;
-  size_t name_recs;
+  rtems_rtl_unresolved_t*     unresolved;
+  rtems_rtl_unresolv_name_t*  entry;
+  rtems_rtl_unresolv_reloc_t* reloc;
+  uint32_t                    hash;
 
   if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
     printf ("rtl: unresolv: add: %s(s:%d) -> %s\n",
@@ -363,97 +323,104 @@ rtems_rtl_unresolved_add (rtems_rtl_obj_t*        obj,
   if (!unresolved)
     return false;
 
-  /*
-   * Find the first block with a spare record.
-   */
-  node = rtems_chain_first (&unresolved->blocks);
-  block = NULL;
-  while (!rtems_chain_is_tail (&unresolved->blocks, node))
+  hash = rtems_rtl_symbol_hash (name);
+
+  entry = rtems_rtl_unresolved_find_name (unresolved, name, hash);
+  if (!entry)
   {
-    block = (rtems_rtl_unresolv_block_t*) node;
-    if (block->recs < unresolved->block_recs)
-      break;
-    block = NULL;
-    node = rtems_chain_next (node);
+    entry = rtems_rtl_unresolved_add_name (unresolved, name, hash);
+    if (!entry)
+      return false;
   }
 
-  /*
-   * No blocks with any spare records, allocate a new block.
-   */
-  if (!block)
+  reloc = rtems_rtl_unresolved_add_reloc (unresolved, entry);
+  if (!reloc)
   {
-    block = rtems_rtl_unresolved_block_alloc (unresolved);
-    if (!block)
-      return false;
+    if (entry->relocs == 0)
+      rtems_rtl_unresolved_remove_name (unresolved, entry);
+    return false;
   }
 
-  name_index = rtems_rtl_unresolved_find_name (unresolved, name, true);
-  name_recs = rtems_rtl_unresolved_name_recs (name);
+  reloc->obj = obj;
+  reloc->flags = flags;
+  reloc->sect = sect;
+  reloc->rel[0] = rel[0];
+  reloc->rel[1] = rel[1];
+  reloc->rel[2] = rel[2];
 
-  /*
-   * An index less than 0 means the name is present and "0 - index" is the next
-   * index to use.
-   */
-  if (name_index < 0)
-  {
-    rtems_rtl_unresolv_block_t* name_block = block;
+  return true;
+}
 
-    /*
-     * Is there enough room to fit the name ? It not add a new block.
-     */
-    if (name_recs > (unresolved->block_recs - block->recs))
-    {
-      name_block = rtems_rtl_unresolved_block_alloc (unresolved);
-      if (!name_block)
-        return false;
-    }
+void
+rtems_rtl_unresolved_resolve (void)
+{
+  rtems_rtl_unresolved_t* unresolved;
+  size_t                  b;
 
-    rec = rtems_rtl_unresolved_rec_first_free (name_block);
-    rec->type = rtems_rtl_unresolved_name;
-    rec->rec.name.refs = 1;
-    rec->rec.name.length = strlen (name) + 1;
-    memcpy ((void*) &rec->rec.name.name[0], name, rec->rec.name.length + 1);
-    block->recs += name_recs;
-    name_index = 0 - name_index;
-
-    /*
-     * If the name block is the reloc block and it is full allocate a new
-     * block for the relocation record.
-     */
-    if ((block == name_block) && (block->recs >= unresolved->block_recs))
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
+    printf ("rtl: unresolv: global resolve\n");
+
+  unresolved = rtems_rtl_unresolved ();
+  if (!unresolved)
+    return;
+
+  for (b = 0; b < unresolved->nbuckets; ++b)
+  {
+    rtems_chain_control* bucket = &unresolved->buckets[b];
+    rtems_chain_node*    node = rtems_chain_first (bucket);
+    while (!rtems_chain_is_tail (bucket, node))
     {
-      block = rtems_rtl_unresolved_block_alloc (unresolved);
-      if (!block)
-        return false;
-    }
-  }
+      rtems_rtl_unresolv_name_t* entry = (rtems_rtl_unresolv_name_t*) node;
+      rtems_rtl_obj_sym_t*       sym;
 
-  rec = rtems_rtl_unresolved_rec_first_free (block);
-  rec->type = rtems_rtl_unresolved_reloc;
-  rec->rec.reloc.obj = obj;
-  rec->rec.reloc.flags = flags;
-  rec->rec.reloc.name = name_index;
-  rec->rec.reloc.sect = sect;
-  rec->rec.reloc.rel[0] = rel[0];
-  rec->rec.reloc.rel[1] = rel[1];
-  rec->rec.reloc.rel[2] = rel[2];
+      node = rtems_chain_next (node);
 
-  ++block->recs;
+      if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
+        printf ("rtl: unresolv: lookup: %s\n", entry->name);
 
-  return true;
+      sym = rtems_rtl_symbol_global_find (entry->name);
+      if (sym)
+        rtems_rtl_unresolved_resolve_name (unresolved, entry, sym);
+    }
+  }
 }
 
 void
-rtems_rtl_unresolved_resolve (void)
+rtems_rtl_unresolved_resolve_obj (rtems_rtl_obj_t* obj)
 {
-  rtems_rtl_unresolved_reloc_data_t rd;
+  rtems_rtl_unresolved_t* unresolved;
+  rtems_rtl_obj_sym_t*    sym;
+  size_t                  s;
+
+  unresolved = rtems_rtl_unresolved ();
+  if (!unresolved)
+    return;
+
   if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
-    printf ("rtl: unresolv: global resolve\n");
-  rd.name = 0;
-  rd.name_rec = NULL;
-  rd.sym = NULL;
-  rtems_rtl_unresolved_interate (rtems_rtl_unresolved_resolve_iterator, &rd);
-  rtems_rtl_unresolved_compact ();
+    printf ("rtl: unresolv: resolve: %s: names:%zu relocs:%zu\n",
+            rtems_rtl_obj_oname (obj), unresolved->names, unresolved->relocs);
+
+  for (s = 0, sym = obj->global_table;
+       (s < obj->global_syms) && (unresolved->names != 0);
+       ++s, ++sym)
+  {
+    rtems_rtl_unresolv_name_t* entry;
+    rtems_rtl_obj_sym_t*       global;
+    entry = rtems_rtl_unresolved_find_name (unresolved,
+                                            sym->name,
+                                            rtems_rtl_symbol_hash (sym->name));
+    if (entry)
+    {
+      /*
+       * The object file only provides the name. Bind to the symbol in the
+       * global table so a base image or earlier strong symbol takes
+       * precedence, like a global resolve would do.
+       */
+      global = rtems_rtl_symbol_global_find (sym->name);
+      if (global)
+        rtems_rtl_unresolved_resolve_name (unresolved, entry, global);
+    }
+  }
 }
 
 bool
@@ -462,10 +429,68 @@ rtems_rtl_unresolved_remove (rtems_rtl_obj_t*        obj,
                              const uint16_t          sect,
                              const rtems_rtl_word_t* rel)
 {
-  rtems_rtl_unresolved_t* unresolved;
+  rtems_rtl_unresolved_t*    unresolved;
+  rtems_rtl_unresolv_name_t* entry;
+  size_t                     r;
+
   unresolved = rtems_rtl_unresolved ();
   if (!unresolved)
     return false;
+
+  entry = rtems_rtl_unresolved_find_name (unresolved,
+                                          name,
+                                          rtems_rtl_symbol_hash (name));
+  if (!entry)
+    return false;
+
+  for (r = 0; r < entry->relocs; ++r)
+  {
+    rtems_rtl_unresolv_reloc_t* reloc = &entry->reloc[r];
+    if ((reloc->obj == obj) && (reloc->sect == sect) &&
+        (reloc->rel[0] == rel[0]) && (reloc->rel[1] == rel[1]) &&
+        (reloc->rel[2] == rel[2]))
+    {
+      rtems_rtl_unresolved_remove_reloc (unresolved, entry, r);
+      if (entry->relocs == 0)
+        rtems_rtl_unresolved_remove_name (unresolved, entry);
+      return true;
+    }
+  }
+
   return false;
 }
 
+void
+rtems_rtl_unresolved_erase_obj (rtems_rtl_obj_t* obj)
+{
+  rtems_rtl_unresolved_t* unresolved;
+  size_t                  b;
+
+  unresolved = rtems_rtl_unresolved ();
+  if (!unresolved)
+    return;
+
+  for (b = 0; b < unresolved->nbuckets; ++b)
+  {
+    rtems_chain_control* bucket = &unresolved->buckets[b];
+    rtems_chain_node*    node = rtems_chain_first (bucket);
+    while (!rtems_chain_is_tail (bucket, node))
+    {
+      rtems_rtl_unresolv_name_t* entry = (rtems_rtl_unresolv_name_t*) node;
+      size_t                     r = 0;
+
+      node = rtems_chain_next (node);
+
+      while (r < entry->relocs)
+      {
+        if (entry->reloc[r].obj == obj)
+          rtems_rtl_unresolved_remove_reloc (unresolved, entry, r);
+        else
+          ++r;
+      }
+
+      if (entry->relocs == 0)
+        rtems_rtl_unresolved_remove_name (unresolved, entry);
+    }
+  }
+}
@@ -19,27 +19,23 @@
  * loaded. There is no load order that resolves this.
  *
  * The unresolved relocation table is a single table used by all object files
- * with unresolved symbols. It made of blocks linked together where blocks are
- * allocated as requiered. The table is always maintained compacted. That is as
- * relocations are resolved and removed the table is compacted. The only
- * pointer in the table is the object file poniter. This is used to identify
- * which object the relocation belongs to. There are no linking or back
- * pointers in the unresolved relocations table. The table is scanned for each
- * object file's relocations. This is not fast but the table should be small
- * and if it happens to grow large you have other more pressing issues to
- * resolve in your application.
+ * with unresolved symbols. It is indexed by the hash of the symbol name. Each
+ * unresolved symbol name has a single name entry in the table and the entry
+ * holds the relocations from all object files waiting on the symbol. When an
+ * object file is loaded its global symbols are looked up in the table and only
+ * the relocations waiting on those symbols are resolved. The cost of resolving
+ * is set by the number of symbols added and the relocations resolved and not
+ * by the number of unresolved relocations held in the table.
  *
  * The table holds two (2) types of records:
  *
- *  # Symbol name strings.
+ *  # Symbol names.
  *  # Relocations.
  *
- * The symbol name a relocation references is held in a specific symbol name
- * string record in the table the relocation record references. The record
- * counts the number of references and the string is removed from the table
- * when the reference count reaches 0. There can be many relocations
- * referencing the symbol. The strings are referenced by a single 16bit
- * unsigned integer which is the count of the string in the table.
+ * The name entry holds the symbol name, the hash of the name and an array of
+ * the relocation records that reference the symbol. The entry is removed from
+ * the table when the symbol is resolved or the last of its relocations are
+ * removed.
  *
  * The section the relocation is for in the object is the section number. The
  * relocation data is series of machine word sized fields:
@@ -66,7 +62,7 @@ extern "C" {
 typedef uint32_t rtems_rtl_word_t;
 
 /**
- * The types of records in the blocks.
+ * The types of records passed to the iterator.
  */
 typedef enum rtems_rtl_unresolved_rtype_e
 {
@@ -75,18 +71,6 @@ typedef enum rtems_rtl_unresolved_rtype_e
   rtems_rtl_unresolved_reloc = 2   /**< The record is a relocation record. */
 } rtems_rtl_unresolved_rtype_t;
 
-/**
- * Unresolved externals symbol names. The names are reference counted and
- * separate from the relocation records because a number of records could
- * reference the same symbol name.
- */
-typedef struct rtems_rtl_unresolv_name_s
-{
-  uint16_t refs;       /**< The number of references to this name. */
-  uint16_t length;     /**< The length of this name. */
-  const char name[12]; /**< The symbol name. */
-} rtems_rtl_unresolv_name_t;
-
 /**
  * Unresolved externals symbols require the relocation records to be held
  * and references.
@@ -95,42 +79,50 @@ typedef struct rtems_rtl_unresolv_reloc_s
 {
   rtems_rtl_obj_t* obj;     /**< The relocation's object file. */
   uint16_t         flags;   /**< Format specific flags. */
-  uint16_t         name;    /**< The symbol's name. */
   uint16_t         sect;    /**< The target section. */
   rtems_rtl_word_t rel[3];  /**< Relocation record. */
 } rtems_rtl_unresolv_reloc_t;
 
 /**
- * Unresolved externals records.
+ * Unresolved externals symbol names. The relocation records referencing the
+ * symbol are held with the name because a number of records could reference
+ * the same symbol name.
+ */
+typedef struct rtems_rtl_unresolv_name_s
+{
+  rtems_chain_node            node;   /**< The hash bucket chain node. */
+  uint32_t                    hash;   /**< The hash of the name. */
+  size_t                      length; /**< The length of this name. */
+  const char*                 name;   /**< The symbol name. */
+  size_t                      relocs; /**< The number of relocation records. */
+  size_t                      size;   /**< The size of the relocation array. */
+  rtems_rtl_unresolv_reloc_t* reloc;  /**< The relocation records. */
+} rtems_rtl_unresolv_name_t;
+
+/**
+ * Unresolved externals records passed to the iterator.
  */
 typedef struct rtems_rtl_unresolv_rec_s
 {
   rtems_rtl_unresolved_rtype_t type;
   union
   {
-    rtems_rtl_unresolv_name_t name;    /**< The name, or */
-    rtems_rtl_unresolv_reloc_t reloc;  /**< the relocation record. */
+    rtems_rtl_unresolv_name_t*  name;   /**< The name, or */
+    rtems_rtl_unresolv_reloc_t* reloc;  /**< the relocation record. */
   } rec;
 } rtems_rtl_unresolv_rec_t;
 
 /**
- * Unresolved blocks.
- */
-typedef struct rtems_rtl_unresolv_block_s
-{
-  rtems_chain_node         link; /**< Blocks are chained. */
-  uint32_t                 recs; /**< The number of records in the block. */
-  rtems_rtl_unresolv_rec_t rec;  /**< The records. More follow. */
-} rtems_rtl_unresolv_block_t;
-
-/**
- * Unresolved table holds the names and relocations.
+ * Unresolved table holds the names and relocations. The names are held in
+ * hash buckets and the number of buckets grows with the number of names.
  */
 typedef struct rtems_rtl_unresolved_s
 {
-  uint32_t marker;
-  size_t              block_recs; /**< The records per blocks allocated. */
-  rtems_chain_control blocks;     /**< List of blocks. */
+  uint32_t             marker;
+  rtems_chain_control* buckets;  /**< The name hash buckets. */
+  size_t               nbuckets; /**< The number of buckets, a power of 2. */
+  size_t               names;    /**< The number of names in the table. */
+  size_t               relocs;   /**< The number of relocations in the table. */
 } rtems_rtl_unresolved_t;
 
 /**
@@ -148,16 +140,16 @@ typedef bool rtems_rtl_unresolved_iterator_t (rtems_rtl_unresolv_rec_t* rec,
  * Open an unresolved relocation table.
  *
  * @param unresolv The unresolved table to open.
- * @param block_records The number of records per block allocated.
+ * @param buckets The initial number of hash buckets. Must be a power of 2.
  * @retval true The table is open.
  * @retval false The unresolved relocation table could not created. The RTL
  *               error has the error.
  */
 bool rtems_rtl_unresolved_table_open (rtems_rtl_unresolved_t* unresolved,
-                                      size_t                  block_records);
+                                      size_t                  buckets);
 
 /**
- * Close the table and erase the blocks.
+ * Close the table and erase the names and relocations.
  *
  * @param unreolved Close the unresolved table.
  */
@@ -188,23 +180,44 @@ bool rtems_rtl_unresolved_add (rtems_rtl_obj_t*        obj,
                                const rtems_rtl_word_t* rel);
 
 /**
- * Resolve the unresolved symbols.
+ * Resolve the unresolved symbols. Each name in the table is looked up in the
+ * global symbol table.
  */
 void rtems_rtl_unresolved_resolve (void);
 
+/**
+ * Resolve the relocations waiting on the global symbols of an object file.
+ * Only the names of the object file's global symbols are looked up in the
+ * table. The relocations are bound to the symbols found in the global symbol
+ * table.
+ *
+ * @param obj The object file that has added symbols to the global table.
+ */
+void rtems_rtl_unresolved_resolve_obj (rtems_rtl_obj_t* obj);
+
 /**
  * Remove a relocation from the list of unresolved relocations.
  *
- * @param unresolved The unresolved symbol table.
- * @param obj The object table the symbols are for.
- * @param esyms The exported symbol table.
- * @param size The size of the table in bytes.
+ * @param obj The object table the relocation is for.
+ * @param name The symbol name the relocation references.
+ * @param sect The target section number the relocation references.
+ * @param rel The format specific relocation data.
+ * @retval true The relocation has been removed.
+ * @retval false The relocation was not found.
  */
 bool rtems_rtl_unresolved_remove (rtems_rtl_obj_t*        obj,
                                   const char*             name,
                                   const uint16_t          sect,
                                   const rtems_rtl_word_t* rel);
 
+/**
+ * Remove all the unresolved relocations of an object file. This is called
+ * when an object file is unloaded.
+ *
+ * @param obj The object file to remove the relocations of.
+ */
+void rtems_rtl_unresolved_erase_obj (rtems_rtl_obj_t* obj);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -139,7 +139,7 @@ rtems_rtl_data_init (void)
       rtems_chain_initialize_empty (&rtl->objects);
 
       if (!rtems_rtl_symbol_table_open (&rtl->globals,
-                                        RTEMS_RTL_SYMS_GLOBAL_BUCKETS))
+                                        RTEMS_RTL_SYMS_GLOBAL_SLOTS))
       {
         rtems_semaphore_delete (lock);
         free (rtl);
@@ -147,7 +147,7 @@ rtems_rtl_data_init (void)
       }
 
       if (!rtems_rtl_unresolved_table_open (&rtl->unresolved,
-                                            RTEMS_RTL_UNRESOLVED_BLOCK_SIZE))
+                                            RTEMS_RTL_UNRESOLVED_BUCKETS))
       {
         rtems_rtl_symbol_table_close (&rtl->globals);
         rtems_semaphore_delete (lock);
@@ -445,11 +445,13 @@ rtems_rtl_load_object (const char* name, int mode)
 
     if (!rtems_rtl_obj_load (obj))
     {
+      if (obj->unresolved)
+        rtems_rtl_unresolved_erase_obj (obj);
       rtems_rtl_obj_free (obj);
       return NULL;
     }
 
-    rtems_rtl_unresolved_resolve ();
+    rtems_rtl_unresolved_resolve_obj (obj);
   }
 
   /*
@@ -630,6 +632,23 @@ rtems_rtl_base_sym_global_add (const unsigned char* esyms,
   rtems_rtl_unlock ();
 }
 
+void
+rtems_rtl_base_sym_global_image (const rtems_rtl_symbol_image_t* image)
+{
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_GLOBAL_SYM))
+    printf ("rtl: adding global symbol image, %zi symbols\n", image->count);
+
+  if (!rtems_rtl_lock ())
+  {
+    rtems_rtl_set_error (EINVAL, "global image cannot lock rtl");
+    return;
+  }
+
+  rtems_rtl_symbol_table_image (&rtl->globals, image);
+
+  rtems_rtl_unlock ();
+}
+
 rtems_rtl_obj_t*
 rtems_rtl_baseimage (void)
 {
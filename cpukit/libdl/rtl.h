@@ -61,14 +61,16 @@ extern "C" {
 #define RTL_GLUE(a,b) RTL_XGLUE(a,b)
 
 /**
- * The number of buckets in the global symbol table.
+ * The initial number of slots in the global symbol table. The table grows
+ * when needed.
  */
-#define RTEMS_RTL_SYMS_GLOBAL_BUCKETS (32)
+#define RTEMS_RTL_SYMS_GLOBAL_SLOTS (64)
 
 /**
- * The number of relocation record per block in the unresolved table.
+ * The initial number of name hash buckets in the unresolved table. The table
+ * grows when needed.
  */
-#define RTEMS_RTL_UNRESOLVED_BLOCK_SIZE (64)
+#define RTEMS_RTL_UNRESOLVED_BUCKETS (64)
 
 /**
  * The global debugger interface variable.
@@ -303,6 +305,15 @@ bool rtems_rtl_path_prepend (const char* path);
 void rtems_rtl_base_sym_global_add (const unsigned char* esyms,
                                     unsigned int         count);
 
+/**
+ * Attach a prebuilt symbol table to the global symbol table. The table is
+ * generated at link time for the base image and is used in place. No symbols
+ * are inserted so this is faster than adding an exported symbol table.
+ *
+ * @param image The prebuilt symbol table. It must stay valid.
+ */
+void rtems_rtl_base_sym_global_image (const rtems_rtl_symbol_image_t* image);
+
 /**
  * Return the object file descriptor for the base image. The object file
  * descriptor returned is created when the run time linker is initialised.
@@ -51,6 +51,20 @@ static int msdos_utime(
     return RC_OK;
 }
 
+static bool msdos_dentry_key(
+  const rtems_filesystem_location_info_t *loc,
+  uint64_t                               *key
+)
+{
+    fat_file_fd_t *fat_fd = loc->node_access;
+
+    if (fat_fd->fat_file_type != FAT_DIRECTORY)
+        return false;
+
+    *key = fat_fd->cln;
+    return true;
+}
+
 const rtems_filesystem_operations_table  msdos_ops = {
   .lock_h         =  msdos_lock,
   .unlock_h       =  msdos_unlock,
@@ -70,7 +84,8 @@ const rtems_filesystem_operations_table  msdos_ops = {
   .symlink_h      =  rtems_filesystem_default_symlink,
   .readlink_h     =  rtems_filesystem_default_readlink,
   .rename_h       =  msdos_rename,
-  .statvfs_h      =  msdos_statvfs
+  .statvfs_h      =  msdos_statvfs,
+  .dentry_key_h   =  msdos_dentry_key
 };
 
 void msdos_lock(const rtems_filesystem_mount_table_entry_t *mt_entry)
@@ -305,10 +305,47 @@ msdos_long_to_short(rtems_dosfs_convert_control     *converter,
     return type;
 }
 
+/* msdos_read_dir_entry --
+ *     Read the 32 bytes directory entry at the specified position.
+ *
+ * PARAMETERS:
+ *     fs_info   - file system info
+ *     dir_pos   - position of the directory entry
+ *     dir_entry - buffer for the directory entry
+ *
+ * RETURNS:
+ *     RC_OK on success, or -1 if error occured (errno set apropriately)
+ *
+ */
+static int
+msdos_read_dir_entry(
+    fat_fs_info_t       *fs_info,
+    const fat_dir_pos_t *dir_pos,
+    char                *dir_entry
+    )
+{
+    ssize_t          ret;
+    uint32_t         sec = 0;
+    uint32_t         byte = 0;
+
+    sec = fat_cluster_num_to_sector_num(fs_info, dir_pos->sname.cln);
+    sec += (dir_pos->sname.ofs >> fs_info->vol.sec_log2);
+    byte = dir_pos->sname.ofs & (fs_info->vol.bps - 1);
+
+    ret = _fat_block_read(fs_info, sec, byte,
+                          MSDOS_DIRECTORY_ENTRY_STRUCT_SIZE, dir_entry);
+    if (ret < 0)
+        return -1;
+
+    return RC_OK;
+}
+
 /* msdos_find_name --
  *     Find the node which correspondes to the name, open fat-file which
  *     correspondes to the found node and close fat-file which correspondes
- *     to the node we searched in.
+ *     to the node we searched in.  The position of the node is taken from
+ *     the path lookup cache if possible, so the directory is only scanned
+ *     once for a name until the name space of the file system changes.
  *
  * PARAMETERS:
  *     parent_loc - parent node description
@@ -334,29 +371,56 @@ msdos_find_name(
     unsigned short     time_val = 0;
     unsigned short     date = 0;
     char               node_entry[MSDOS_DIRECTORY_ENTRY_STRUCT_SIZE];
-
-    memset(node_entry, 0, MSDOS_DIRECTORY_ENTRY_STRUCT_SIZE);
-
-    name_type = msdos_long_to_short (
-        fs_info->converter,
-        name,
-        name_len,
-        MSDOS_DIR_NAME(node_entry),
-        MSDOS_NAME_MAX);
+    rtems_filesystem_dentry_cache_status cache_status =
+        RTEMS_FILESYSTEM_DENTRY_CACHE_MISS;
 
     /*
-     * find the node which corresponds to the name in the directory pointed by
-     * 'parent_loc'
+     * the position returned for ".." is not the one of the ".." slot, so
+     * it cannot be used to read the directory entry later
      */
-    rc = msdos_get_name_node(parent_loc, false, name, name_len, name_type,
-                             &dir_pos, node_entry);
-    if (rc != RC_OK)
-        return rc;
+    bool               cacheable =
+        !rtems_filesystem_is_parent_directory(name, name_len);
+
+    if (cacheable)
+        cache_status = rtems_filesystem_dentry_cache_lookup(
+            parent_loc, name, name_len, &dir_pos, sizeof(dir_pos));
 
-    if (((*MSDOS_DIR_ATTR(node_entry)) & MSDOS_ATTR_VOLUME_ID) ||
-        ((*MSDOS_DIR_ATTR(node_entry) & MSDOS_ATTR_LFN_MASK) == MSDOS_ATTR_LFN))
+    if (cache_status == RTEMS_FILESYSTEM_DENTRY_CACHE_NEGATIVE)
         return MSDOS_NAME_NOT_FOUND_ERR;
 
+    if (cache_status == RTEMS_FILESYSTEM_DENTRY_CACHE_MISS)
+    {
+        memset(node_entry, 0, MSDOS_DIRECTORY_ENTRY_STRUCT_SIZE);
+
+        name_type = msdos_long_to_short (
+            fs_info->converter,
+            name,
+            name_len,
+            MSDOS_DIR_NAME(node_entry),
+            MSDOS_NAME_MAX);
+
+        /*
+         * find the node which corresponds to the name in the directory
+         * pointed by 'parent_loc'
+         */
+        rc = msdos_get_name_node(parent_loc, false, name, name_len, name_type,
+                                 &dir_pos, node_entry);
+        if (rc == RC_OK &&
+            (((*MSDOS_DIR_ATTR(node_entry)) & MSDOS_ATTR_VOLUME_ID) ||
+             ((*MSDOS_DIR_ATTR(node_entry) & MSDOS_ATTR_LFN_MASK) == MSDOS_ATTR_LFN)))
+            rc = MSDOS_NAME_NOT_FOUND_ERR;
+
+        if (cacheable && rc == RC_OK)
+            rtems_filesystem_dentry_cache_insert(
+                parent_loc, name, name_len, &dir_pos, sizeof(dir_pos));
+        else if (cacheable && rc == MSDOS_NAME_NOT_FOUND_ERR)
+            rtems_filesystem_dentry_cache_insert(
+                parent_loc, name, name_len, NULL, 0);
+
+        if (rc != RC_OK)
+            return rc;
+    }
+
     /* open fat-file corresponded to the found node */
     rc = fat_file_open(&fs_info->fat, &dir_pos, &fat_fd);
     if (rc != RC_OK)
@@ -364,6 +428,21 @@ msdos_find_name(
 
     fat_fd->dir_pos = dir_pos;
 
+    /*
+     * the directory entry is only needed for a newly opened fat-file, so in
+     * case of a cache hit read it just now
+     */
+    if (fat_fd->links_num == 1 &&
+        cache_status == RTEMS_FILESYSTEM_DENTRY_CACHE_HIT)
+    {
+        rc = msdos_read_dir_entry(&fs_info->fat, &dir_pos, node_entry);
+        if (rc != RC_OK)
+        {
+            fat_file_close(&fs_info->fat, fat_fd);
+            return rc;
+        }
+    }
+
     /*
      * I don't like this if, but: we should do it, or should write new file
      * size and first cluster num to the disk after each write operation
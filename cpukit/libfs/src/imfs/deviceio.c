@@ -22,6 +22,10 @@
 
 #include <rtems/deviceio.h>
 
+#include <sys/event.h>
+#include <sys/ioccom.h>
+#include <errno.h>
+
 int device_open(
   rtems_libio_t *iop,
   const char    *pathname,
@@ -105,6 +109,36 @@ int device_ioctl(
   );
 }
 
+/*
+ * The kernel event note is passed to the driver via the RTEMS_IO_KQFILTER
+ * control command.  Drivers which do not know this command leave the knote
+ * untouched.
+ */
+int device_kqfilter(
+  rtems_libio_t *iop,
+  struct knote  *kn
+)
+{
+  const IMFS_device_t *device = IMFS_iop_to_device( iop );
+  int rv;
+
+  rv = rtems_deviceio_control(
+    iop,
+    RTEMS_IO_KQFILTER,
+    kn,
+    device->major,
+    device->minor
+  );
+
+  if ( rv == 0 && kn->kn_fop == NULL ) {
+    rv = EINVAL;
+  } else if ( rv < 0 ) {
+    rv = EINVAL;
+  }
+
+  return rv;
+}
+
 int device_ftruncate(
   rtems_libio_t *iop,
   off_t          length
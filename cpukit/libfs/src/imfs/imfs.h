@@ -774,6 +774,11 @@ extern int device_ftruncate(
   off_t          length             /* IN  */
 );
 
+extern int device_kqfilter(
+  rtems_libio_t *iop,
+  struct knote  *kn
+);
+
 /** @} */
 
 /**
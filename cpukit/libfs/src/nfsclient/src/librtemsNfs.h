@@ -81,6 +81,9 @@
 #include <ctype.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <sys/uio.h>
+#include <rpc/types.h>
+#include <rpc/xdr.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -226,6 +229,95 @@ nfsSetTimeout(uint32_t timeout_ms);
 uint32_t
 nfsGetTimeout(void);
 
+/**
+ * @brief The 'st_blksize' value reported by stat(2) (default: 8192).
+ *
+ * If zero, the block size reported by the server is passed through.
+ */
+extern int nfsStBlksize;
+
+/**
+ * @brief Lifetime of cached file attributes in seconds (default: 10).
+ *
+ * Zero refetches the attributes on each use, a negative value caches them
+ * forever.
+ */
+extern int nfsAttrLifetime;
+
+/**
+ * @brief Lifetime of cached directory lookups in seconds (default: 3).
+ *
+ * Zero disables the lookup cache.  The cache of a mounted NFS is only
+ * allocated if this value is positive at mount time.
+ */
+extern int nfsLookupLifetime;
+
+/**
+ * @brief Number of READ requests kept in flight by a sequential reader
+ * (default: 4, at most 8).
+ *
+ * One disables read-ahead.  Files opened while read-ahead and write-behind
+ * are both disabled are always accessed synchronously.  Otherwise each open
+ * regular file uses a semaphore to serialize the tasks sharing its file
+ * descriptor.  A file is accessed synchronously if it cannot be created.
+ */
+extern int nfsReadAheadDepth;
+
+/**
+ * @brief Lifetime of the data in the read-ahead window in seconds (default:
+ * 1).
+ *
+ * Zero or a negative value drops the window on each read(2).  The window does
+ * not age with the attributes, so it never lives forever.
+ */
+extern int nfsReadAheadLifetime;
+
+/**
+ * @brief Number of WRITE requests a writer may have in flight (default: 4,
+ * at most 8).
+ *
+ * Zero makes each write(2) wait for the reply of the server.  Otherwise the
+ * error of a WRITE completing after write(2) returned is reported by the next
+ * write(2), fsync(2) or close(2).  Writes to files opened with O_APPEND are
+ * always synchronous.
+ */
+extern int nfsWriteBehindDepth;
+
+/** XDR streams on mbuf chains */
+
+struct mbuf;
+
+/**
+ * @brief Initialize an XDR stream on an mbuf chain.
+ *
+ * A decoding stream reads the chain starting at @a m.  An encoding stream
+ * appends to the data of @a m and allocates mbuf clusters as needed.  Opaque
+ * data of 512 bytes or more is not copied by the encoder, an external mbuf
+ * referencing it is appended instead.  It must remain valid until the chain is
+ * freed.
+ *
+ * The stream never frees the chain and does not maintain the length of a
+ * packet header, use XDR_GETPOS() for that.
+ */
+void
+xdrmbuf_create(XDR *xdrs, struct mbuf *m, enum xdr_op op);
+
+/**
+ * @brief Decode the body of opaque data without copying it.
+ *
+ * The @a len bytes at the current position of a decoding stream are described
+ * by at most @a *iovcnt entries of @a iov pointing into the mbuf chain (into
+ * the buffer of other streams).  The XDR padding is skipped.
+ *
+ * @param[in, out] iovcnt Number of available, then used entries of @a iov.
+ *
+ * @retval TRUE Successful operation.
+ * @retval FALSE The data is truncated or spread over more than @a *iovcnt
+ * mbufs.  The stream position is unchanged in the latter case.
+ */
+bool_t
+xdrmbuf_getiov(XDR *xdrs, struct iovec *iov, int *iovcnt, u_int len);
+
 #ifdef __cplusplus
 }
 #endif
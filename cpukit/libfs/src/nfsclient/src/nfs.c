@@ -104,6 +104,49 @@
  */
 #define CONFIG_ATTR_LIFETIME			10/*secs*/
 
+/* lifetime of a cached directory lookup (name -> file handle);
+ * the time is in seconds, zero disables the cache.
+ * Can be overridden at run-time via 'nfsLookupLifetime'.
+ */
+#define CONFIG_LOOKUP_LIFETIME			3/*secs*/
+
+/* number of entries in the (direct mapped) lookup cache
+ * of each mounted NFS; must be a power of two
+ */
+#define CONFIG_LOOKUP_CACHE_SIZE		64
+
+/* names longer than this (including terminating 0) are not cached */
+#define CONFIG_LOOKUP_NAMELEN			32
+
+/* number of READ requests a sequential reader keeps
+ * in flight; 1 disables read-ahead.
+ * Can be overridden at run-time via 'nfsReadAheadDepth'.
+ */
+#define CONFIG_READ_AHEAD_DEPTH			4
+
+/* lifetime of the data in the read-ahead window;
+ * the time is in seconds and zero drops the window
+ * on each read.  Unlike the attribute lifetime this
+ * one is never infinite, a negative value acts like zero.
+ * Can be overridden at run-time via 'nfsReadAheadLifetime'.
+ */
+#define CONFIG_READ_AHEAD_LIFETIME		1/*secs*/
+
+/* number of WRITE requests a writer may have in flight
+ * before write() blocks; 0 makes all writes synchronous.
+ * Can be overridden at run-time via 'nfsWriteBehindDepth'.
+ */
+#define CONFIG_WRITE_BEHIND_DEPTH		4
+
+/* upper limit for the two depths above */
+#define CONFIG_MAX_PIPELINE				8
+
+/* the read-ahead window keeps the replies of the READs
+ * and describes their data by that many iovecs each;
+ * a reply spread over more mbufs is copied
+ */
+#define CONFIG_READ_IOV					32
+
 /*
  * The 'st_blksize' (stat(2)) value this nfs
  * client should report. If set to zero then the server's fattr data
@@ -515,6 +558,22 @@ nowSeconds(void)
 }
 
 
+/* Directory lookup cache entry; maps a
+ * (directory, name) pair to the file handle
+ * and attributes the server returned for it.
+ */
+typedef struct LookupCacheEntryRec_ {
+	nfs_fh		dir;
+	nfs_fh		file;
+	fattr		attributes;
+		/* when the LOOKUP was done */
+	TimeStamp	age;
+		/* when the attributes were fetched */
+	TimeStamp	attrAge;
+		/* empty string if this entry is unused */
+	char		name[CONFIG_LOOKUP_NAMELEN];
+} LookupCacheEntryRec, *LookupCacheEntry;
+
 /* Per mounted FS structure */
 typedef struct NfsRec_ {
 		/* the NFS server we're talking to.
@@ -549,6 +608,10 @@ typedef struct NfsRec_ {
 		/* Who we pretend we are
 		 */
 	u_long								 uid,gid;
+		/* CONFIG_LOOKUP_CACHE_SIZE entries
+		 * or NULL; protected by nfsGlob.lock
+		 */
+	LookupCacheEntry					 lookupCache;
 } NfsRec, *Nfs;
 
 typedef struct NfsNodeRec_ {
@@ -582,8 +645,61 @@ typedef struct NfsNodeRec_ {
 		/* A timestamp for the stats
 		 */
 	TimeStamp		age;
+		/* Read-ahead and write-behind state
+		 * of a node opened as a regular file;
+		 * NULL for all other nodes.
+		 */
+	struct FileInfoRec_	*fi;
 } NfsNodeRec, *NfsNode;
 
+/* An asynchronous READ or WRITE */
+typedef struct NfsPendingRec_ {
+	RpcUdpXact		xact;
+	union {
+		readargs	read;
+		writeargs	write;
+	}				args;
+	union {
+		readres		read;
+		attrstat	write;
+	}				res;
+		/* bytes requested */
+	uint32_t		count;
+		/* READ only: keep the reply and describe
+		 * the data by 'iov' instead of copying it
+		 */
+	int				keep;
+	int				iovcnt;
+	struct iovec	iov[CONFIG_READ_IOV];
+		/* the data if 'iov' was too short */
+	char			*spill;
+} NfsPendingRec, *NfsPending;
+
+typedef struct FileInfoRec_ {
+		/* serializes the tasks using the file
+		 * descriptor; close() runs after all
+		 * of them are done
+		 */
+	rtems_id		lock;
+		/* read-ahead window; the first 'raCount'
+		 * pending READs hold the kept replies
+		 */
+	int				raCount;
+	uint32_t		raOff;
+	uint32_t		raLen;
+	TimeStamp		raAge;
+		/* where a sequential read would continue */
+	uint32_t		nextOff;
+		/* ring of outstanding WRITEs */
+	int				wbHead;
+	int				wbCount;
+		/* first error of a WRITE which completed
+		 * after write() returned
+		 */
+	int				wbErrno;
+	NfsPendingRec	pending[CONFIG_MAX_PIPELINE];
+} FileInfoRec, *FileInfo;
+
 /*****************************************
 	Forward Declarations
  *****************************************/
@@ -596,6 +712,14 @@ static ssize_t nfs_readlink_with_node(
 
 static int updateAttr(NfsNode node, int force);
 
+static void nodeAttrUpdated(NfsNode node);
+
+static void fileInfoDestroy(FileInfo fi);
+
+static void nfsPendingRelease(NfsPending p);
+
+static bool_t xdr_readres_iov(XDR *xdrs, NfsPending p);
+
 /* Mask bits when setting attributes.
  * Only the 'arg' fields with their
  * corresponding bit set in the mask
@@ -712,6 +836,20 @@ static struct nfsstats {
 #endif
 int nfsStBlksize = DEFAULT_NFS_ST_BLKSIZE;
 
+/*
+ * Global variables to tune the caches (see the CONFIG_xxx
+ * symbols at the top for a description)
+ */
+#ifdef CONFIG_ATTR_LIFETIME
+int nfsAttrLifetime     = CONFIG_ATTR_LIFETIME;
+#else
+int nfsAttrLifetime     = -1;	/* infinite */
+#endif
+int nfsLookupLifetime   = CONFIG_LOOKUP_LIFETIME;
+int nfsReadAheadDepth   = CONFIG_READ_AHEAD_DEPTH;
+int nfsReadAheadLifetime = CONFIG_READ_AHEAD_LIFETIME;
+int nfsWriteBehindDepth = CONFIG_WRITE_BEHIND_DEPTH;
+
 
 /*****************************************
 	Implementation
@@ -827,6 +965,10 @@ Nfs rval = calloc(1,sizeof(*rval));
 
 	if (rval) {
 		rval->server     = server;
+		/* the lookup cache is optional */
+		if (nfsLookupLifetime > 0)
+			rval->lookupCache = calloc(CONFIG_LOOKUP_CACHE_SIZE,
+			                           sizeof(*rval->lookupCache));
 		LOCK(nfsGlob.llock);
 			rval->next 		   = nfsGlob.mounted_fs;
 			nfsGlob.mounted_fs = rval;
@@ -862,6 +1004,7 @@ register Nfs prev;
 
 	nfs->next = 0; /* paranoia */
 	rpcUdpServerDestroy(nfs->server);
+	free(nfs->lookupCache);
 	free(nfs);
 }
 
@@ -909,6 +1052,7 @@ rtems_interrupt_lock_context lock_context;
 		NFS_GLOBAL_RELEASE(&lock_context);
 		rval->nfs       = nfs;
 		rval->str		= 0;
+		rval->fi		= 0;
 	} else {
 		errno = ENOMEM;
 	}
@@ -943,6 +1087,10 @@ rtems_interrupt_lock_context lock_context;
 	if (node->str)
 		free(node->str);
 
+	/* paranoia; nfs_file_close() releases it */
+	if (node->fi)
+		fileInfoDestroy(node->fi);
+
 	free(node);
 }
 
@@ -969,6 +1117,9 @@ NfsNode rval = nfsNodeCreate(node->nfs, 0);
 	if (rval) {
 		*rval = *node;
 
+		/* the file state belongs to the open file */
+		rval->fi = 0;
+
 		/* must clone the string also */
 		if (node->str) {
 			rval->args.name = rval->str = strdup(node->str);
@@ -1154,6 +1305,30 @@ int			refuse;
 	return 0;
 }
 
+/* Translate the status of a failed RPC into errno
+ * and print a message to stderr.
+ */
+static void
+nfsCallErrno(int proc, enum clnt_stat stat)
+{
+	fprintf(stderr,
+			"NFS (proc %i) - %s\n",
+			proc,
+			clnt_sperrno(stat));
+
+	switch (stat) {
+		/* TODO: this is probably not complete and/or fully accurate */
+		case RPC_CANTENCODEARGS : errno = EINVAL;	break;
+		case RPC_AUTHERROR  	: errno = EPERM;	break;
+
+		case RPC_CANTSEND		:
+		case RPC_CANTRECV		: /* hope they have errno set */
+		case RPC_SYSTEMERROR	: break;
+
+		default             	: errno = EIO;		break;
+	}
+}
+
 /* NFS RPC wrapper.
  *
  * ARGS:	srvr	the NFS server we want to call
@@ -1201,6 +1376,12 @@ int				rval = -1;
 		return -1;
 	}
 
+	/* WRITE data is copied into the transaction;
+	 * the stack may still hold mbufs referencing
+	 * the arguments after the reply (retransmitted
+	 * copies, ARP hold queue, fragments).
+	 */
+
 	if ( RPC_SUCCESS != (stat=rpcUdpSend(
 								xact,
 								srvr,
@@ -1213,22 +1394,7 @@ int				rval = -1;
 								0)) ||
 	     RPC_SUCCESS != (stat=rpcUdpRcv(xact)) ) {
 
-		fprintf(stderr,
-				"NFS (proc %i) - %s\n",
-				proc,
-				clnt_sperrno(stat));
-
-		switch (stat) {
-			/* TODO: this is probably not complete and/or fully accurate */
-			case RPC_CANTENCODEARGS : errno = EINVAL;	break;
-			case RPC_AUTHERROR  	: errno = EPERM;	break;
-
-			case RPC_CANTSEND		:
-			case RPC_CANTRECV		: /* hope they have errno set */
-			case RPC_SYSTEMERROR	: break;
-
-			default             	: errno = EIO;		break;
-		}
+		nfsCallErrno(proc, stat);
 	} else {
 		rval = 0;
 	}
@@ -1242,6 +1408,266 @@ int				rval = -1;
 	return rval;
 }
 
+/* Start a READ or WRITE without waiting
+ * for the reply; up to CONFIG_MAX_PIPELINE
+ * of them may be outstanding per task.
+ *
+ * ARGS:	nfs		the NFS to talk to
+ * 			p		request; the arguments must
+ * 					be filled in (and for READ
+ * 					the data buffer of the result
+ * 					unless the reply is kept).
+ * 			proc	NFSPROC_READ or NFSPROC_WRITE
+ *
+ * RETURNS:	0 on success, -1 on error with errno set.
+ *
+ * NOTE:	every started request must be
+ * 			collected by nfsPendingWait(). The
+ * 			data of a WRITE is copied, i.e. the
+ * 			caller's buffer may be reused
+ * 			immediately.
+ */
+static int
+nfsPendingStart(Nfs nfs, NfsPending p, int proc)
+{
+enum clnt_stat	stat;
+int				isRead = (NFSPROC_READ == proc);
+xdrproc_t		xres   = (xdrproc_t)xdr_attrstat;
+caddr_t			pres   = (caddr_t)&p->res;
+
+	p->xact = rpcUdpXactPoolGet(isRead ? nfsGlob.smallPool : nfsGlob.bigPool,
+								XactGetCreate);
+
+	if ( !p->xact ) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	if ( isRead && p->keep ) {
+		rpcUdpXactKeepReply(p->xact, 1);
+		xres = (xdrproc_t)xdr_readres_iov;
+		pres = (caddr_t)p;
+	} else if ( isRead ) {
+		xres = (xdrproc_t)xdr_readres;
+	}
+
+	stat = rpcUdpSend(
+				p->xact,
+				nfs->server,
+				NFSCALL_TIMEOUT,
+				proc,
+				xres,
+				pres,
+				isRead ? (xdrproc_t)xdr_readargs : (xdrproc_t)xdr_writeargs,
+				(caddr_t)&p->args,
+				0);
+
+	if ( RPC_SUCCESS != stat ) {
+		nfsCallErrno(proc, stat);
+		rpcUdpXactPoolPut(p->xact);
+		p->xact = 0;
+		if (!errno)
+			errno = EIO;
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Wait for the reply to a request started
+ * by nfsPendingStart().
+ *
+ * RETURNS:	0 on success (the NFS status is
+ * 			in p->res), -1 on error with errno set.
+ *
+ * NOTE:	a kept reply must be released by
+ * 			nfsPendingRelease() after success.
+ */
+static int
+nfsPendingWait(NfsPending p, int proc)
+{
+enum clnt_stat	stat = rpcUdpRcv(p->xact);
+
+	if ( RPC_SUCCESS != stat || !p->keep ) {
+		nfsPendingRelease(p);
+	}
+
+	if ( RPC_SUCCESS != stat ) {
+		nfsCallErrno(proc, stat);
+		if (!errno)
+			errno = EIO;
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Put the transaction of a completed
+ * request back (along with a kept reply)
+ */
+static void
+nfsPendingRelease(NfsPending p)
+{
+	if ( p->xact ) {
+		rpcUdpXactPoolPut(p->xact);
+		p->xact = 0;
+	}
+	free(p->spill);
+	p->spill = 0;
+}
+
+/* Decode a READ reply into a pending request
+ * without copying the data; it is described by
+ * iovecs pointing into the reply which must be
+ * kept (only if it is too fragmented the data
+ * is copied into a 'spill' buffer).
+ */
+static bool_t
+xdr_readres_iov(XDR *xdrs, NfsPending p)
+{
+readokres	*ok = &p->res.read.readres_u.reply;
+
+	/* nothing was allocated but the spill
+	 * buffer, nfsPendingRelease() frees it
+	 */
+	if ( XDR_FREE == xdrs->x_op )
+		return TRUE;
+
+	if ( !xdr_nfsstat(xdrs, &p->res.read.status) )
+		return FALSE;
+
+	if ( NFS_OK != p->res.read.status )
+		return TRUE;
+
+	if (   !xdr_fattr(xdrs, &ok->attributes)
+		|| !xdr_u_int(xdrs, &ok->data.data_len)
+		|| ok->data.data_len > NFS_MAXDATA )
+		return FALSE;
+
+	p->iovcnt = CONFIG_READ_IOV;
+	if ( xdrmbuf_getiov(xdrs, p->iov, &p->iovcnt, ok->data.data_len) )
+		return TRUE;
+
+	if ( !(p->spill = malloc(ok->data.data_len)) )
+		return FALSE;
+
+	p->iovcnt          = 1;
+	p->iov[0].iov_base = p->spill;
+	p->iov[0].iov_len  = ok->data.data_len;
+	return xdr_opaque(xdrs, p->spill, ok->data.data_len);
+}
+
+/* Hash a (directory, name) pair into the lookup cache */
+static LookupCacheEntry
+lookupCacheSlot(Nfs nfs, const nfs_fh *dir, const char *name)
+{
+const unsigned char *p = (const unsigned char *) dir->data;
+uint32_t			h  = UINT32_C(2166136261);
+int					i;
+
+	for (i = 0; i < NFS_FHSIZE; i++)
+		h = (h ^ p[i]) * UINT32_C(16777619);
+
+	for (p = (const unsigned char *) name; *p; p++)
+		h = (h ^ *p) * UINT32_C(16777619);
+
+	return &nfs->lookupCache[h & (CONFIG_LOOKUP_CACHE_SIZE - 1)];
+}
+
+/* Look up 'name' in directory 'dir' in the cache and
+ * fill in the file handle and attributes of 'entry'.
+ *
+ * RETURNS:	1 on a hit, 0 on a miss
+ */
+static int
+lookupCacheGet(Nfs nfs, const nfs_fh *dir, const char *name, NfsNode entry)
+{
+LookupCacheEntry	e;
+int					hit = 0;
+
+	if (!nfs->lookupCache || nfsLookupLifetime <= 0)
+		return 0;
+
+	LOCK(nfsGlob.lock);
+		e = lookupCacheSlot(nfs, dir, name);
+		if (   e->name[0]
+			&& nowSeconds() - e->age <= (TimeStamp) nfsLookupLifetime
+			&& 0 == strcmp(e->name, name)
+			&& 0 == memcmp(&e->dir, dir, sizeof(*dir)) ) {
+			entry->serporid.status = NFS_OK;
+			SERP_FILE(entry)	   = e->file;
+			SERP_ATTR(entry)	   = e->attributes;
+			entry->age			   = e->attrAge;
+			hit = 1;
+		}
+	UNLOCK(nfsGlob.lock);
+
+	return hit;
+}
+
+/* Remember the result of a successful LOOKUP */
+static void
+lookupCachePut(Nfs nfs, const nfs_fh *dir, const char *name, NfsNode entry)
+{
+LookupCacheEntry	e;
+
+	if (!nfs->lookupCache || strlen(name) >= CONFIG_LOOKUP_NAMELEN)
+		return;
+
+	LOCK(nfsGlob.lock);
+		e = lookupCacheSlot(nfs, dir, name);
+		e->dir		  = *dir;
+		e->file		  = SERP_FILE(entry);
+		e->attributes = SERP_ATTR(entry);
+		e->age		  = e->attrAge = entry->age;
+		strcpy(e->name, name);
+	UNLOCK(nfsGlob.lock);
+}
+
+/* Forget a (directory, name) pair; must be called
+ * by all operations that change directory entries.
+ */
+static void
+lookupCacheRemove(Nfs nfs, const nfs_fh *dir, const char *name)
+{
+LookupCacheEntry	e;
+
+	if (!nfs->lookupCache || !name)
+		return;
+
+	LOCK(nfsGlob.lock);
+		e = lookupCacheSlot(nfs, dir, name);
+		if (0 == strcmp(e->name, name) && 0 == memcmp(&e->dir, dir, sizeof(*dir)))
+			e->name[0] = 0;
+	UNLOCK(nfsGlob.lock);
+}
+
+/* Timestamp the attributes of a node after they
+ * were received from the server and update the
+ * copies in the lookup cache.
+ */
+static void
+nodeAttrUpdated(NfsNode node)
+{
+Nfs					nfs = node->nfs;
+LookupCacheEntry	e;
+int					i;
+
+	node->age = nowSeconds();
+
+	if (!nfs->lookupCache)
+		return;
+
+	LOCK(nfsGlob.lock);
+		for (i = 0, e = nfs->lookupCache; i < CONFIG_LOOKUP_CACHE_SIZE; i++, e++) {
+			if (e->name[0] && 0 == memcmp(&e->file, &SERP_FILE(node), sizeof(e->file))) {
+				e->attributes = SERP_ATTR(node);
+				e->attrAge	  = node->age;
+			}
+		}
+	UNLOCK(nfsGlob.lock);
+}
+
 /* Check the 'age' of a node's stats
  * and read the attributes from the server
  * if necessary.
@@ -1260,9 +1686,8 @@ updateAttr(NfsNode node, int force)
 	int rv = 0;
 
 	if (force
-#ifdef CONFIG_ATTR_LIFETIME
-		|| (nowSeconds() - node->age > CONFIG_ATTR_LIFETIME)
-#endif
+		|| (nfsAttrLifetime >= 0
+			&& nowSeconds() - node->age >= (TimeStamp) nfsAttrLifetime)
 	) {
 		rv = nfscall(
 			node->nfs->server,
@@ -1275,7 +1700,7 @@ updateAttr(NfsNode node, int force)
 			rv = nfsEvaluateStatus(node->serporid.status);
 
 			if (rv == 0) {
-				node->age = nowSeconds();
+				nodeAttrUpdated(node);
 			}
 		}
 	}
@@ -1443,6 +1868,7 @@ static int nfs_search_in_directory(
 	int rv;
 
 	entry->nfs = nfs;
+	entry->fi  = 0;
 
 	/* lookup one element */
 	SERP_ATTR(entry) = SERP_ATTR(dir);
@@ -1452,6 +1878,10 @@ static int nfs_search_in_directory(
 	/* remember args / directory fh */
 	memcpy(&entry->args, &SERP_FILE(dir), sizeof(dir->args));
 
+	if (lookupCacheGet(nfs, &SERP_FILE(dir), part, entry)) {
+		return 0;
+	}
+
 #if DEBUG & DEBUG_EVALPATH
 	fprintf(stderr,"Looking up '%s'\n",part);
 #endif
@@ -1464,9 +1894,9 @@ static int nfs_search_in_directory(
 	);
 
 	if (rv == 0 && entry->serporid.status == NFS_OK) {
-		int force_update = 1;
-
-		rv = updateAttr(entry, force_update);
+		/* the diropres carries fresh attributes */
+		entry->age = nowSeconds();
+		lookupCachePut(nfs, &SERP_FILE(dir), part, entry);
 	} else {
 		rv = -1;
 	}
@@ -1669,6 +2099,8 @@ char *dupname;
 		(xdrproc_t)xdr_nfsstat, &status
 	);
 
+	lookupCacheRemove(tNode->nfs, &SERP_FILE(pNode), dupname);
+
 	if (rv == 0) {
 		rv = nfsEvaluateStatus(status);
 #if DEBUG & DEBUG_SYSCALLS
@@ -1717,6 +2149,8 @@ char			*name = NFSPROC_REMOVE == proc ?
 		(xdrproc_t)xdr_nfsstat, &status
 	);
 
+	lookupCacheRemove(nfs, &node->args.dir, node->args.name);
+
 	if (rv == 0) {
 		rv = nfsEvaluateStatus(status);
 #if DEBUG & DEBUG_SYSCALLS
@@ -2044,6 +2478,8 @@ char					*dupname;
 		(xdrproc_t)xdr_diropres, &res
 	);
 
+	lookupCacheRemove(nfs, &SERP_FILE(node), dupname);
+
 	if (rv == 0) {
 		rv = nfsEvaluateStatus(res.status);
 #if DEBUG & DEBUG_SYSCALLS
@@ -2140,6 +2576,8 @@ char					*dupname;
 		(xdrproc_t)xdr_nfsstat, &status
 	);
 
+	lookupCacheRemove(nfs, &SERP_FILE(node), dupname);
+
 	if (rv == 0) {
 		rv = nfsEvaluateStatus(status);
 #if DEBUG & DEBUG_SYSCALLS
@@ -2231,6 +2669,9 @@ static int nfs_rename(
 			&status
 		);
 
+		lookupCacheRemove(nfs, &SERP_FILE(oldParentNode), oldNode->str);
+		lookupCacheRemove(nfs, toDirSrc, dupname);
+
 		if (rv == 0) {
 			rv = nfsEvaluateStatus(status);
 		}
@@ -2329,7 +2770,33 @@ const struct _rtems_filesystem_operations_table nfs_fs_ops = {
 		  'nfs_xxx'.
  *****************************************/
 
-/* stateless NFS protocol makes this trivial */
+/* Drop the read-ahead window, i.e. release
+ * the replies it keeps.
+ */
+static void
+fileInfoDropWindow(FileInfo fi)
+{
+	while (fi->raCount > 0)
+		nfsPendingRelease(&fi->pending[--fi->raCount]);
+	fi->raLen = 0;
+}
+
+/* Release the read-ahead and write-behind state;
+ * outstanding WRITEs must have been collected.
+ */
+static void
+fileInfoDestroy(FileInfo fi)
+{
+	fileInfoDropWindow(fi);
+	rtems_semaphore_delete(fi->lock);
+	free(fi);
+}
+
+/* the NFS protocol is stateless; we only
+ * attach the state for read-ahead and
+ * write-behind to the node. If that fails
+ * the file is accessed synchronously.
+ */
 static int nfs_file_open(
 	rtems_libio_t *iop,
 	const char    *pathname,
@@ -2337,6 +2804,23 @@ static int nfs_file_open(
 	mode_t        mode
 )
 {
+NfsNode		node = iop->pathinfo.node_access;
+FileInfo	fi;
+
+	if (!node->fi && (nfsReadAheadDepth > 1 || nfsWriteBehindDepth > 0)) {
+		fi = calloc(1, sizeof(*fi));
+		if (fi && RTEMS_SUCCESSFUL != rtems_semaphore_create(
+					rtems_build_name('N','F','S','f'),
+					1,
+					MUTEX_ATTRIBUTES,
+					0,
+					&fi->lock)) {
+			free(fi);
+			fi = 0;
+		}
+		node->fi = fi;
+	}
+
 	return 0;
 }
 
@@ -2381,11 +2865,86 @@ DirInfo		di;
 	return 0;
 }
 
+/* Wait for the oldest outstanding WRITE of a file;
+ * the first error is kept in fi->wbErrno.
+ */
+static void
+nfsFileCompleteWrite(NfsNode node)
+{
+FileInfo	fi = node->fi;
+NfsPending	p  = &fi->pending[fi->wbHead];
+
+	fi->wbHead = (fi->wbHead + 1) % CONFIG_MAX_PIPELINE;
+	fi->wbCount--;
+
+	if (   0 == nfsPendingWait(p, NFSPROC_WRITE)
+		&& 0 == nfsEvaluateStatus(p->res.write.status) ) {
+		SERP_ATTR(node) = p->res.write.attrstat_u.attributes;
+		nodeAttrUpdated(node);
+	} else if (!fi->wbErrno) {
+		fi->wbErrno = errno;
+	}
+}
+
+/* Wait until all WRITEs of a file have completed */
+static void
+nfsFileDrain(NfsNode node)
+{
+	while (node->fi && node->fi->wbCount > 0)
+		nfsFileCompleteWrite(node);
+}
+
+/* Wait until all WRITEs of a file have completed
+ * and report the first error of any of them.
+ *
+ * RETURNS:	0 on success, -1 on failure with errno set
+ */
+static int
+nfsFileFlush(NfsNode node)
+{
+FileInfo	fi = node->fi;
+
+	nfsFileDrain(node);
+
+	if (fi && fi->wbErrno) {
+		errno = fi->wbErrno;
+		fi->wbErrno = 0;
+		return -1;
+	}
+
+	return 0;
+}
+
 static int nfs_file_close(
 	rtems_libio_t *iop
 )
 {
-	return 0;
+NfsNode		node = iop->pathinfo.node_access;
+int			rv   = nfsFileFlush(node);
+
+	if (node->fi) {
+		fileInfoDestroy(node->fi);
+		node->fi = 0;
+	}
+
+	return rv;
+}
+
+static int nfs_file_fsync(
+	rtems_libio_t *iop
+)
+{
+NfsNode		node = iop->pathinfo.node_access;
+int			rv;
+
+	if (!node->fi)
+		return 0;
+
+	LOCK(node->fi->lock);
+	rv = nfsFileFlush(node);
+	UNLOCK(node->fi->lock);
+
+	return rv;
 }
 
 static int nfs_dir_close(
@@ -2441,6 +3000,210 @@ Nfs		nfs  = node->nfs;
 	return rv;
 }
 
+/* Read 'count' bytes at 'offset' into 'buffer' with
+ * up to 'depth' READ requests in flight. Requests
+ * beyond the (cached) size of the file are not sent.
+ *
+ * Without a 'buffer' the replies are kept as the
+ * read-ahead window instead; 'count' must not
+ * exceed 'depth' requests then.
+ *
+ * RETURNS:	number of bytes read; less than 'count'
+ * 			at the end of the file.
+ * 			-1 on failure with errno set.
+ */
+static ssize_t nfs_file_read_pipelined(
+	NfsNode node,
+	uint32_t offset,
+	char *buffer,
+	size_t count,
+	int depth
+)
+{
+FileInfo	fi   = node->fi;
+uint32_t	size = SERP_ATTR(node).size;
+size_t		sent = 0;
+size_t		done = 0;
+int			head = 0;
+int			inflight = 0;
+int			err  = 0;
+int			eof  = 0;
+NfsPending	p;
+
+	do {
+		/* keep the pipeline full */
+		while (   inflight < depth && sent < count && !err && !eof
+			   && (0 == sent || offset + sent < size) ) {
+			size_t chunk = count - sent <= NFS_MAXDATA ? count - sent : NFS_MAXDATA;
+
+			p = &fi->pending[(head + inflight) % CONFIG_MAX_PIPELINE];
+			p->args.read.file		= SERP_FILE(node);
+			p->args.read.offset		= offset + sent;
+			p->args.read.count		= chunk;
+			p->args.read.totalcount	= UINT32_C(0xdeadbeef);
+			p->res.read.readres_u.reply.data.data_val = buffer ? buffer + sent : 0;
+			p->count				= chunk;
+			p->keep					= !buffer;
+
+			if (nfsPendingStart(node->nfs, p, NFSPROC_READ)) {
+				err = errno;
+				break;
+			}
+
+			sent += chunk;
+			inflight++;
+		}
+
+		if (0 == inflight)
+			break;
+
+		/* collect the oldest; the replies of all
+		 * sent requests must be received
+		 */
+		p = &fi->pending[head];
+		head = (head + 1) % CONFIG_MAX_PIPELINE;
+		inflight--;
+
+		if (   nfsPendingWait(p, NFSPROC_READ)
+			|| nfsEvaluateStatus(p->res.read.status) ) {
+			if (!err)
+				err = errno;
+		} else if (!err && !eof) {
+			done += p->res.read.readres_u.reply.data.data_len;
+			if (p->res.read.readres_u.reply.data.data_len < p->count)
+				eof = 1;
+			/* replies are collected in order */
+			if (p->keep && p->res.read.readres_u.reply.data.data_len > 0) {
+				fi->raCount++;
+				continue;
+			}
+		}
+		if (p->keep)
+			nfsPendingRelease(p);
+	} while (inflight > 0 || (sent < count && !err && !eof));
+
+	if (done > 0)
+		return done;
+
+	if (err) {
+		errno = err;
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Copy 'count' bytes at 'off' relative to the
+ * start of the read-ahead window to 'buffer'
+ */
+static void nfs_file_window_copy(
+	FileInfo fi,
+	uint32_t off,
+	char *buffer,
+	size_t count
+)
+{
+NfsPending	p;
+size_t		len;
+int			i, j;
+
+	for (i = 0; i < fi->raCount && count > 0; i++) {
+		p = &fi->pending[i];
+		for (j = 0; j < p->iovcnt && count > 0; j++) {
+			len = p->iov[j].iov_len;
+			if (off >= len) {
+				off -= len;
+				continue;
+			}
+			len -= off;
+			if (len > count)
+				len = count;
+			memcpy(buffer, (char*)p->iov[j].iov_base + off, len);
+			buffer += len;
+			count  -= len;
+			off     = 0;
+		}
+	}
+}
+
+/* Read through the read-ahead window of an open file.
+ * A sequential reader refills the window with
+ * a burst of pipelined READs whose replies are
+ * kept, i.e. their data is copied only once;
+ * requests at least as large as the window
+ * bypass it.
+ */
+static ssize_t nfs_file_read_ahead(
+	NfsNode node,
+	uint32_t offset,
+	char *buffer,
+	size_t count
+)
+{
+FileInfo	fi    = node->fi;
+int			depth = nfsReadAheadDepth;
+size_t		size;
+ssize_t		rv    = 0;
+ssize_t		done  = 0;
+size_t		want;
+int			eof   = 0;
+
+	if (depth > CONFIG_MAX_PIPELINE)
+		depth = CONFIG_MAX_PIPELINE;
+
+	size = (size_t) depth * NFS_MAXDATA;
+
+	/* the window has its own lifetime, so data changed
+	 * on the server shows up even if the attributes
+	 * are cached forever
+	 */
+	if (nfsReadAheadLifetime <= 0
+		|| nowSeconds() - fi->raAge >= (TimeStamp) nfsReadAheadLifetime)
+		fileInfoDropWindow(fi);
+
+	while (count > 0) {
+		if (offset >= fi->raOff && offset - fi->raOff < fi->raLen) {
+			done = fi->raOff + fi->raLen - offset;
+			if ((size_t) done > count)
+				done = count;
+			nfs_file_window_copy(fi, offset - fi->raOff, buffer, done);
+		} else if (count < size && offset == fi->nextOff) {
+			fileInfoDropWindow(fi);
+			want = size <= UINT32_MAX - offset ? size : UINT32_MAX - offset;
+			done = nfs_file_read_pipelined(node, offset, 0, want, depth);
+			if (done <= 0)
+				break;
+			fi->raOff = offset;
+			fi->raLen = done;
+			fi->raAge = nowSeconds();
+			continue;
+		} else {
+			/* random access or a big request; the
+			 * READs need the slots of the window
+			 */
+			fileInfoDropWindow(fi);
+			done = nfs_file_read_pipelined(node, offset, buffer, count, depth);
+			if (done <= 0)
+				break;
+			eof = (size_t) done < count;
+		}
+
+		offset += (uint32_t) done;
+		buffer += done;
+		count  -= (size_t) done;
+		rv     += done;
+		fi->nextOff = offset;
+
+		if (eof)
+			break;
+	}
+
+	if (rv == 0 && done < 0)
+		rv = -1;
+
+	return rv;
+}
+
 static ssize_t nfs_file_read(
 	rtems_libio_t *iop,
 	void *buffer,
@@ -2466,6 +3229,23 @@ static ssize_t nfs_file_read(
 		count = UINT32_MAX - offset;
 	}
 
+	if (node->fi && nfsReadAheadDepth > 1) {
+		LOCK(node->fi->lock);
+
+		/* read our own writes */
+		nfsFileDrain(node);
+
+		rv = nfs_file_read_ahead(node, offset, in, count);
+
+		if (rv > 0) {
+			iop->offset = offset + (uint32_t) rv;
+		}
+
+		UNLOCK(node->fi->lock);
+
+		return rv;
+	}
+
 	do {
 		size_t chunk = count <= NFS_MAXDATA ? count : NFS_MAXDATA;
 		ssize_t done = nfs_file_read_chunk(node, offset, in, chunk);
@@ -2551,6 +3331,72 @@ RpcUdpServer	server = ((Nfs)iop->pathinfo.mt_entry->fs_info)->server;
 	return rv;
 }
 
+/* Send a WRITE and return without waiting for the
+ * reply unless the write-behind window is full.
+ * Errors of such WRITEs are reported by the next
+ * write(), fsync() or close().
+ */
+static ssize_t nfs_file_write_behind(
+	rtems_libio_t *iop,
+	const void    *buffer,
+	size_t        count
+)
+{
+NfsNode 	node  = iop->pathinfo.node_access;
+FileInfo	fi    = node->fi;
+int			depth = nfsWriteBehindDepth;
+NfsPending	p;
+
+	if (depth > CONFIG_MAX_PIPELINE)
+		depth = CONFIG_MAX_PIPELINE;
+
+	if (iop->offset < 0) {
+		errno = EINVAL;
+		return -1;
+	}
+	if ((uintmax_t) iop->offset >= UINT32_MAX) {
+		errno = EFBIG;
+		return -1;
+	}
+	if (count > UINT32_MAX - iop->offset) {
+		count = UINT32_MAX - iop->offset;
+	}
+
+	/* make room in the window */
+	while (fi->wbCount >= depth)
+		nfsFileCompleteWrite(node);
+
+	if (fi->wbErrno) {
+		errno = fi->wbErrno;
+		fi->wbErrno = 0;
+		return -1;
+	}
+
+	/* the read-ahead data is outdated now
+	 * and its slots are needed
+	 */
+	fileInfoDropWindow(fi);
+
+	p = &fi->pending[(fi->wbHead + fi->wbCount) % CONFIG_MAX_PIPELINE];
+	p->args.write.file			  = SERP_FILE(node);
+	p->args.write.beginoffset	  = UINT32_C(0xdeadbeef);
+	p->args.write.offset		  = iop->offset;
+	p->args.write.totalcount	  = UINT32_C(0xdeadbeef);
+	p->args.write.data.data_len	  = count;
+	p->args.write.data.data_val	  = (void*)buffer;
+	p->count					  = count;
+	p->keep						  = 0;
+
+	if (nfsPendingStart(node->nfs, p, NFSPROC_WRITE)) {
+		return -1;
+	}
+
+	fi->wbCount++;
+	iop->offset += count;
+
+	return count;
+}
+
 static ssize_t nfs_file_write(
 	rtems_libio_t *iop,
 	const void    *buffer,
@@ -2564,6 +3410,28 @@ Nfs			nfs  = node->nfs;
 	if (count > NFS_MAXDATA)
 		count = NFS_MAXDATA;
 
+	if (node->fi) {
+		LOCK(node->fi->lock);
+
+		/* appending needs the current size */
+		if (nfsWriteBehindDepth > 0 && !(LIBIO_FLAGS_APPEND & iop->flags)) {
+			rv = nfs_file_write_behind(iop, buffer, count);
+			UNLOCK(node->fi->lock);
+			return rv;
+		}
+
+		rv = nfsFileFlush(node);
+		if (rv == 0) {
+			fileInfoDropWindow(node->fi);
+		}
+
+		UNLOCK(node->fi->lock);
+
+		if (rv) {
+			return -1;
+		}
+	}
+
 
 	SERP_ARGS(node).writearg.beginoffset = UINT32_C(0xdeadbeef);
 	if ( LIBIO_FLAGS_APPEND & iop->flags ) {
@@ -2610,7 +3478,7 @@ Nfs			nfs  = node->nfs;
 		rv = nfsEvaluateStatus(node->serporid.status);
 
 		if (rv == 0) {
-			node->age = nowSeconds();
+			nodeAttrUpdated(node);
 
 			iop->offset += count;
 			rv = count;
@@ -2700,6 +3568,15 @@ static int nfs_fstat(
 NfsNode	node = loc->node_access;
 fattr	*fa  = &SERP_ATTR(node);
 
+	/* the size must include our own writes;
+	 * errors are reported by fsync() or close()
+	 */
+	if (node->fi) {
+		LOCK(node->fi->lock);
+		nfsFileDrain(node);
+		UNLOCK(node->fi->lock);
+	}
+
 	if (updateAttr(node, 0 /* only if old */)) {
 		return -1;
 	}
@@ -2819,7 +3696,7 @@ u_int					mode;
 		rv = nfsEvaluateStatus(node->serporid.status);
 
 		if (rv == 0) {
-			node->age = nowSeconds();
+			nodeAttrUpdated(node);
 		} else {
 #if DEBUG & DEBUG_SYSCALLS
 			fprintf(stderr,"nfs_sattr: %s\n",strerror(errno));
@@ -2848,6 +3725,7 @@ static int nfs_file_ftruncate(
 )
 {
 sattr					arg;
+NfsNode					node = iop->pathinfo.node_access;
 
 	if (length < 0) {
 		errno = EINVAL;
@@ -2859,12 +3737,29 @@ sattr					arg;
 		return -1;
 	}
 
+	if (node->fi) {
+		int rv;
+
+		LOCK(node->fi->lock);
+
+		rv = nfsFileFlush(node);
+		if (rv == 0) {
+			fileInfoDropWindow(node->fi);
+		}
+
+		UNLOCK(node->fi->lock);
+
+		if (rv) {
+			return -1;
+		}
+	}
+
 	arg.size = length;
 	/* must not modify any other attribute; if we are not the owner
 	 * of the file or directory but only have write access changing
 	 * any attribute besides 'size' will fail...
 	 */
-	return nfs_sattr(iop->pathinfo.node_access,
+	return nfs_sattr(node,
 					 &arg,
 					 SATTR_SIZE);
 }
@@ -2880,8 +3775,8 @@ struct _rtems_filesystem_file_handlers_r nfs_file_file_handlers = {
 	.lseek_h     = rtems_filesystem_default_lseek_file,
 	.fstat_h     = nfs_fstat,
 	.ftruncate_h = nfs_file_ftruncate,
-	.fsync_h     = rtems_filesystem_default_fsync_or_fdatasync,
-	.fdatasync_h = rtems_filesystem_default_fsync_or_fdatasync,
+	.fsync_h     = nfs_file_fsync,
+	.fdatasync_h = nfs_file_fsync,
 	.fcntl_h     = rtems_filesystem_default_fcntl,
 	.kqfilter_h  = rtems_filesystem_default_kqfilter,
 	.poll_h      = rtems_filesystem_default_poll,
@@ -68,6 +68,7 @@
 #endif
 
 #include <inttypes.h>
+#include <stddef.h>
 
 #include <rtems.h>
 #include <rtems/error.h>
@@ -112,6 +113,14 @@
 						 *  interface is used.
 						 */
 
+#define RPCIO_MAX_REFS	4	/* MBUF_TX only: a transaction which permits it
+						 *  references up to that many opaque arguments
+						 *  of at least RPCIO_REF_MIN bytes instead of
+						 *  copying them into its buffer (see
+						 *  rpcUdpXactReference()).
+						 */
+#define RPCIO_REF_MIN	512
+
 #undef REJECT_SERVERIP_MISMATCH
 						/* If defined, RPC replies must come from the server
 						 * that was queried. Eric Norum has reported problems
@@ -308,13 +317,24 @@ typedef union  RpcBufU_ {
 typedef	struct mbuf *		RxBuf;	/* an MBUF chain */
 static  void   				bufFree(struct mbuf **m);
 #define XID(ibuf) 			(*(mtod((ibuf), u_long *)))
-extern void 				xdrmbuf_create(XDR *, struct mbuf *, enum xdr_op);
 #else
 typedef RpcBuf				RxBuf;
 #define	bufFree(b)			do { MY_FREE(*(b)); *(b)=0; } while(0)
 #define XID(ibuf) 			((ibuf)->xid)
 #endif
 
+#ifdef MBUF_TX
+/* An argument which is sent from the
+ * caller's memory; it goes after the
+ * first 'pos' bytes of the obuf
+ */
+typedef struct RpcRefRec_ {
+		u_int				pos;
+		const char			*base;
+		u_int				len;
+} RpcRefRec, *RpcRef;
+#endif
+
 /* A RPC 'transaction' consisting
  * of server and requestor information,
  * buffer space and an XDR object
@@ -329,6 +349,7 @@ typedef struct RpcUdpXactRec_ {
 		long				age;		/* age info; needed to manage retransmission    */
 		long				trip;		/* record round trip time in ticks              */
 		rtems_id			requestor;	/* the task waiting for this XACT to complete   */
+		volatile int		completed;	/* set by the daemon before waking the requestor */
 		RpcUdpXactPool		pool;		/* if this XACT belong to a pool, this is it    */
 		XDR					xdrs;		/* argument encoder stream                      */
 		int					xdrpos;     /* stream position after the (permanent) header */
@@ -339,7 +360,12 @@ typedef struct RpcUdpXactRec_ {
 #endif
 #ifdef  MBUF_TX
 		int					refcnt;		/* mbuf external storage reference count        */
+		struct xdr_ops		xops;		/* argument encoder ops (referencing putbytes)  */
+		int					refOK;		/* arguments may be referenced                  */
+		int					nrefs;		/* number of referenced arguments               */
+		RpcRefRec			refs[RPCIO_MAX_REFS];
 #endif
+		int					keepReply;	/* rpcUdpRcv() keeps the ibuf                   */
 		int					obufsize;	/* size of the obuf (bytes)                     */
 		RxBuf				ibuf;		/* pointer to input buffer assigned by daemon   */
 		RpcBufU				obuf;       /* output buffer (encoded args) APPENDED HERE   */
@@ -373,20 +399,17 @@ rpcio_daemon(rtems_task_argument);
 
 #ifdef MBUF_TX
 ssize_t
-sendto_nocpy (
+sendmsg_nocpy (
 		int s,
-		const void *buf, size_t buflen,
+		const struct msghdr *msg,
 		int flags,
-		const struct sockaddr *toaddr, int tolen,
 		void *closure,
 		void (*freeproc)(caddr_t, u_int),
 		void (*refproc)(caddr_t, u_int)
 );
 static void paranoia_free(caddr_t closure, u_int size);
 static void paranoia_ref (caddr_t closure, u_int size);
-#define SENDTO	sendto_nocpy
-#else
-#define SENDTO	sendto
+static bool_t (*xdrmem_putbytes)(XDR *, const char *, u_int);
 #endif
 
 static RpcUdpServer		rpcUdpServers = 0;	/* linked list of all servers; protected by llock */
@@ -666,6 +689,29 @@ RpcUdpServer s;
 	return 0;
 }
 
+#ifdef MBUF_TX
+/* Encode opaque data by reference if the
+ * transaction permits it. The data is not
+ * part of the obuf but sent from where it is.
+ */
+static bool_t
+xactPutbytes(XDR *xdrs, const char *addr, u_int len)
+{
+RpcUdpXact	xact = (RpcUdpXact)((char*)xdrs - offsetof(RpcUdpXactRec, xdrs));
+RpcRef		ref;
+
+	if ( xact->refOK && len >= RPCIO_REF_MIN && xact->nrefs < RPCIO_MAX_REFS ) {
+		ref       = &xact->refs[xact->nrefs++];
+		ref->pos  = XDR_GETPOS(xdrs);
+		ref->base = addr;
+		ref->len  = len;
+		return TRUE;
+	}
+
+	return xdrmem_putbytes(xdrs, addr, len);
+}
+#endif
+
 RpcUdpXact
 rpcUdpXactCreate(
 	u_long	program,
@@ -692,6 +738,12 @@ register int	i,j;
 		header.rm_call.cb_prog    = program;
 		header.rm_call.cb_vers    = version;
 		xdrmem_create(&(rval->xdrs), rval->obuf.buf, size, XDR_ENCODE);
+#ifdef MBUF_TX
+		xdrmem_putbytes           = rval->xdrs.x_ops->x_putbytes;
+		rval->xops                = *rval->xdrs.x_ops;
+		rval->xops.x_putbytes     = xactPutbytes;
+		rval->xdrs.x_ops          = &rval->xops;
+#endif
 
 		if (!xdr_callhdr(&(rval->xdrs), &header)) {
 			MY_FREE(rval);
@@ -805,10 +857,16 @@ va_list			ap;
 	xact->pres      = pres;
 	xact->server    = srvr;
 
+	/* a reply kept since the last send */
+	bufFree(&xact->ibuf);
+
 	xdrs            = &xact->xdrs;
 	xdrs->x_op      = XDR_ENCODE;
 	/* increment transaction ID */
 	xact->obuf.xid += XACT_HASHS;
+#ifdef MBUF_TX
+	xact->nrefs     = 0;
+#endif
 	XDR_SETPOS(xdrs, xact->xdrpos);
 	if ( !XDR_PUTLONG(xdrs,(long*)&proc) || !locked_marshal(srvr, xdrs) ||
 		 !xargs(xdrs, pargs) ) {
@@ -824,6 +882,7 @@ va_list			ap;
 	va_end(ap);
 
 	rtems_task_ident(RTEMS_SELF, RTEMS_WHO_AM_I, &xact->requestor);
+	xact->completed = 0;
 	if ( rtems_message_queue_send( msgQ, &xact, sizeof(xact)) ) {
 		return RPC_CANTSEND;
 	}
@@ -837,6 +896,13 @@ va_list			ap;
  * transaction.
  * The caller is woken by the RPC daemon either
  * upon reception of the reply or on timeout.
+ *
+ * A task may have several transactions outstanding
+ * and collect them in any order. All of them share
+ * the RTEMS_RPC_EVENT, hence the 'completed' flag
+ * decides whether the reply is there. A transaction
+ * sent by another task is polled for, since the
+ * daemon wakes up the task which sent it.
  */
 enum clnt_stat
 rpcUdpRcv(RpcUdpXact xact)
@@ -846,18 +912,23 @@ XDR			reply_xdrs;
 struct rpc_msg		reply_msg;
 rtems_status_code	status;
 rtems_event_set		gotEvents;
+rtems_id			self;
 
 	refresh = 0;
 
+	rtems_task_ident(RTEMS_SELF, RTEMS_WHO_AM_I, &self);
+
 	do {
 
 	/* block for the reply */
-	status = rtems_event_receive(
-		RTEMS_RPC_EVENT,
-		RTEMS_WAIT | RTEMS_EVENT_ANY,
-		RTEMS_NO_TIMEOUT,
-		&gotEvents);
-	ASSERT( status == RTEMS_SUCCESSFUL );
+	while ( !xact->completed ) {
+		status = rtems_event_receive(
+			RTEMS_RPC_EVENT,
+			RTEMS_WAIT | RTEMS_EVENT_ANY,
+			self == xact->requestor ? RTEMS_NO_TIMEOUT : 1,
+			&gotEvents);
+		ASSERT( status == RTEMS_SUCCESSFUL || status == RTEMS_TIMEOUT );
+	}
 
 	if (xact->status.re_status) {
 #ifdef MBUF_RX
@@ -905,14 +976,18 @@ rtems_event_set		gotEvents;
 	}
 	XDR_DESTROY(&reply_xdrs);
 
-	bufFree(&xact->ibuf);
+	/* the decoded results may point into the reply */
+	if ( !xact->keepReply || RPC_SUCCESS != xact->status.re_status ) {
+		bufFree(&xact->ibuf);
 
 #ifndef MBUF_RX
-	xact->ibufsize = 0;
+		xact->ibufsize = 0;
 #endif
+	}
 
 	if (refresh && locked_refresh(xact->server)) {
 		rtems_task_ident(RTEMS_SELF, RTEMS_WHO_AM_I, &xact->requestor);
+		xact->completed = 0;
 		if ( rtems_message_queue_send(msgQ, &xact, sizeof(xact)) ) {
 			return RPC_CANTSEND;
 		}
@@ -927,6 +1002,20 @@ rtems_event_set		gotEvents;
 }
 
 
+void
+rpcUdpXactReference(RpcUdpXact xact, int enable)
+{
+#ifdef MBUF_TX
+	xact->refOK = enable;
+#endif
+}
+
+void
+rpcUdpXactKeepReply(RpcUdpXact xact, int keep)
+{
+	xact->keepReply = keep;
+}
+
 /* On RTEMS, I'm told to avoid select(); this seems to
  * be more efficient
  */
@@ -1171,6 +1260,58 @@ nodeAppend(ListNode l, ListNode n)
 
 }
 
+/* (Re-)transmit a transaction; with MBUF_TX
+ * the datagram is assembled from the obuf and
+ * the referenced arguments without copying.
+ *
+ * RETURNS: 0 on success, -1 on error with errno set
+ */
+static int
+xactSend(RpcUdpXact xact, RpcUdpServer srv)
+{
+int				len = (int)XDR_GETPOS(&xact->xdrs);
+#ifdef MBUF_TX
+struct iovec	iov[2*RPCIO_MAX_REFS + 1];
+struct msghdr	msg;
+RpcRef			ref;
+int				pos = 0;
+int				total = 0;
+int				n = 0;
+int				i;
+
+	for ( i = 0; i < xact->nrefs; i++ ) {
+		ref = &xact->refs[i];
+		if ( ref->pos > pos ) {
+			iov[n].iov_base = xact->obuf.buf + pos;
+			iov[n].iov_len  = ref->pos - pos;
+			n++;
+		}
+		iov[n].iov_base = (void*)ref->base;
+		iov[n].iov_len  = ref->len;
+		n++;
+		total += ref->len;
+		pos    = ref->pos;
+	}
+	if ( len > pos ) {
+		iov[n].iov_base = xact->obuf.buf + pos;
+		iov[n].iov_len  = len - pos;
+		n++;
+	}
+	total += len;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_name    = &srv->addr.sa;
+	msg.msg_namelen = sizeof(srv->addr.sin);
+	msg.msg_iov     = iov;
+	msg.msg_iovlen  = n;
+
+	xact->refcnt = n;	/* one per segment */
+	return total == sendmsg_nocpy(ourSock, &msg, 0, xact, paranoia_free, paranoia_ref) ? 0 : -1;
+#else
+	return len == sendto(ourSock, xact->obuf.buf, len, 0, &srv->addr.sa, sizeof(srv->addr.sin)) ? 0 : -1;
+#endif
+}
+
 /* this code does the work */
 static void
 rpcio_daemon(rtems_task_argument arg)
@@ -1187,7 +1328,6 @@ rtems_id          q          =  0;
 ListNodeRec       listHead   = {0, 0};
 unsigned long     epoch      = RPCIOD_EPOCH_SECS * ticksPerSec;
 unsigned long			max_period = RPCIOD_RETX_CAP_S * ticksPerSec;
-rtems_status_code	status;
 
 
         then = rtems_clock_get_ticks_since_boot();
@@ -1292,6 +1432,7 @@ rtems_status_code	status;
 				}
 
 				/* wakeup requestor */
+				xact->completed = 1;
 				rtems_event_send(xact->requestor, RTEMS_RPC_EVENT);
 			}
 		}
@@ -1347,31 +1488,15 @@ rtems_status_code	status;
 #if (DEBUG) & DEBUG_TIMEOUT
 					fprintf(stderr,"RPCIO XACT timed out; waking up requestor\n");
 #endif
-					if ( rtems_event_send(xact->requestor, RTEMS_RPC_EVENT) ) {
-						rtems_panic("RPCIO PANIC: requestor id was 0x%08x",
-									xact->requestor);
-					}
+					/* The requestor may be gone if another task
+					 * collects the transaction (write-behind); it
+					 * polls the 'completed' flag.
+					 */
+					xact->completed = 1;
+					rtems_event_send(xact->requestor, RTEMS_RPC_EVENT);
 
 				} else {
-					int len;
-
-					len = (int)XDR_GETPOS(&xact->xdrs);
-
-#ifdef MBUF_TX
-					xact->refcnt = 1;	/* sendto itself */
-#endif
-					if ( len != SENDTO( ourSock,
-										xact->obuf.buf,
-										len,
-										0,
-										&srv->addr.sa,
-										sizeof(srv->addr.sin)
-#ifdef MBUF_TX
-										, xact,
-										paranoia_free,
-										paranoia_ref
-#endif
-										) ) {
+					if ( xactSend(xact, srv) ) {
 
 						xact->status.re_errno  = errno;
 						xact->status.re_status = RPC_CANTSEND;
@@ -1379,8 +1504,8 @@ rtems_status_code	status;
 
 						/* wakeup requestor */
 						fprintf(stderr,"RPCIO: SEND failure\n");
-						status = rtems_event_send(xact->requestor, RTEMS_RPC_EVENT);
-						assert( status == RTEMS_SUCCESSFUL );
+						xact->completed = 1;
+						rtems_event_send(xact->requestor, RTEMS_RPC_EVENT);
 
 					} else {
 						/* send successful; calculate retransmission time
@@ -1516,6 +1641,7 @@ rtems_status_code	status;
 
 	for (xact=((RpcUdpXact)listHead.next); xact; xact=((RpcUdpXact)xact->node.next)) {
 			xact->status.re_status = RPC_TIMEDOUT;
+			xact->completed = 1;
 			rtems_event_send(xact->requestor, RTEMS_RPC_EVENT);
 	}
 #endif
@@ -1611,6 +1737,15 @@ RpcUdpXactPool pool;
 	pool = xact->pool;
 	ASSERT( pool );
 
+	bufFree(&xact->ibuf);
+#ifndef MBUF_RX
+	xact->ibufsize  = 0;
+#endif
+	xact->keepReply = 0;
+#ifdef MBUF_TX
+	xact->refOK     = 0;
+#endif
+
 	if (RTEMS_SUCCESSFUL != rtems_message_queue_send(
 								pool->box,
 								&xact,
@@ -1644,14 +1779,16 @@ bufFree(struct mbuf **m)
 #endif
 
 #ifdef MBUF_TX
+/* the size is that of a segment
+ * (obuf part or referenced argument)
+ */
 static void
 paranoia_free(caddr_t closure, u_int size)
 {
 #if (DEBUG)
 RpcUdpXact xact = (RpcUdpXact)closure;
-int        len  = (int)XDR_GETPOS(&xact->xdrs);
 
-	ASSERT( --xact->refcnt >= 0 && size == len );
+	ASSERT( --xact->refcnt >= 0 && size > 0 );
 #endif
 }
 
@@ -1660,8 +1797,7 @@ paranoia_ref (caddr_t closure, u_int size)
 {
 #if (DEBUG)
 RpcUdpXact xact = (RpcUdpXact)closure;
-int        len  = (int)XDR_GETPOS(&xact->xdrs);
-	ASSERT( size == len );
+	ASSERT( size > 0 );
 	xact->refcnt++;
 #endif
 }
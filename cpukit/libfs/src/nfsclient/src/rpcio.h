@@ -163,6 +163,31 @@ rpcUdpSend(
 enum clnt_stat
 rpcUdpRcv(RpcUdpXact xact);
 
+/**
+ * @brief Let rpcUdpSend() reference big opaque arguments.
+ *
+ * Opaque data of 512 bytes or more (e.g. NFS WRITE data) is sent from where
+ * it is rather than copied into the buffer of the transaction.  The network
+ * stack may hold mbufs referencing the data after rpcUdpRcv() returned, for
+ * example retransmitted copies or fragments waiting for the interface.  So
+ * only data which lives as long as the transaction may be referenced, never
+ * a buffer of the caller of a file system operation.  Without MBUF_TX support
+ * this is a no-op.  Putting the transaction back into its pool resets it.
+ */
+void
+rpcUdpXactReference(RpcUdpXact xact, int enable);
+
+/**
+ * @brief Let rpcUdpRcv() keep the reply buffer.
+ *
+ * On success, the reply is kept after decoding so that the results may point
+ * into it (see xdrmbuf_getiov()).  It is released by the next rpcUdpSend(),
+ * rpcUdpXactPoolPut() or rpcUdpXactDestroy().  Putting the transaction back
+ * into its pool resets it.
+ */
+void
+rpcUdpXactKeepReply(RpcUdpXact xact, int keep);
+
 /* a yet simpler interface */
 enum clnt_stat
 rpcUdpCallRp(
@@ -213,6 +213,101 @@ sendto_nocpy (
 	return (ret);
 }
 
+/*
+ * gather variant of sendto_nocpy(); each segment
+ * of 'msg->msg_iov' becomes an external mbuf
+ * pointing to the caller's data, i.e. a packet
+ * may be assembled from a header buffer and
+ * (big) user buffers without copying either.
+ *
+ * The callbacks are invoked for every segment
+ * with the 'closure' pointer and the length of
+ * the segment. The data must remain valid until
+ * the stack has released all segments, i.e. until
+ * the packet has left the interface.
+ */
+ssize_t
+sendmsg_nocpy (
+		int s,
+		const struct msghdr *msg,
+		int flags,
+		void *closure,
+		void (*freeproc)(caddr_t, u_int),
+		void (*refproc)(caddr_t, u_int)
+)
+{
+	int           error;
+	struct socket *so;
+	struct mbuf   *to, *top, *m, **mp;
+	size_t        len = 0;
+	int           ret = -1;
+	int           i;
+
+	rtems_bsdnet_semaphore_obtain ();
+	if ((so = rtems_bsdnet_fdToSocket (s)) == NULL) {
+		rtems_bsdnet_semaphore_release ();
+		return -1;
+	}
+
+	error = sockaddrtombuf (&to, (const struct sockaddr *) msg->msg_name,
+			msg->msg_namelen);
+	if (error) {
+		errno = error;
+		rtems_bsdnet_semaphore_release ();
+		return -1;
+	}
+
+	top = NULL;
+	mp  = &top;
+	for ( i = 0; i < msg->msg_iovlen; i++ ) {
+		const struct iovec *iov = &msg->msg_iov[i];
+
+		if ( 0 == iov->iov_len )
+			continue;
+
+		if ( top ) {
+			MGET(m, M_WAIT, MT_DATA);
+		} else {
+			MGETHDR(m, M_WAIT, MT_DATA);
+			m->m_pkthdr.rcvif = (struct ifnet *) 0;
+		}
+
+		m->m_flags       |= M_EXT;
+		m->m_ext.ext_buf  = closure ? closure : iov->iov_base;
+		m->m_ext.ext_size = iov->iov_len;
+		m->m_ext.ext_free = freeproc ? freeproc : dummyproc;
+		m->m_ext.ext_ref  = refproc  ? refproc  : dummyproc;
+		m->m_len          = iov->iov_len;
+		m->m_data         = iov->iov_base;
+		len              += iov->iov_len;
+
+		*mp = m;
+		mp  = &m->m_next;
+	}
+
+	if ( !top ) {
+		m_freem(to);
+		rtems_bsdnet_semaphore_release ();
+		errno = EINVAL;
+		return -1;
+	}
+	top->m_pkthdr.len = len;
+
+	error = sosend (so, to, NULL, top, NULL, flags);
+	if (error) {
+		if (error == EINTR || error == EWOULDBLOCK)
+			error = 0;
+	}
+	if (error)
+		errno = error;
+	else
+		ret = len;
+	if (to)
+		m_freem(to);
+	rtems_bsdnet_semaphore_release ();
+	return (ret);
+}
+
 
 /*
  * receive data in an 'mbuf chain'.
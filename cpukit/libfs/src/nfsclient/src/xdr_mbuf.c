@@ -90,8 +90,14 @@ my_free(void *p)
 
 #define DEBUG			DEBUG_ASSERT
 
+/* when encoding, opaque data of at least this size is
+ * referenced by an external mbuf rather than copied
+ */
+#define XDRMBUF_REF_MIN	512
+
 #define _KERNEL
 #include <sys/mbuf.h>
+#include <sys/uio.h>
 
 #include <assert.h>
 
@@ -143,6 +149,10 @@ typedef struct MBPrivateRec_ {
 
 /* NOTE: the stream position helper 'pos'
  *       must be managed by the caller!
+ *
+ *       When encoding, the stream points to the
+ *       end of the data in 'm' and 'x_handy' is
+ *       its trailing space.
  */
 static inline void
 xdrmbuf_setup(XDR *xdrs, struct mbuf *m)
@@ -150,8 +160,13 @@ xdrmbuf_setup(XDR *xdrs, struct mbuf *m)
 MBPrivate	mbp = (MBPrivate)xdrs->x_base;
 
 		mbp->mcurrent    = m;
-		xdrs->x_private  = mtod(m,caddr_t);
-		xdrs->x_handy    = m->m_len;
+		if ( XDR_ENCODE == xdrs->x_op ) {
+			xdrs->x_private  = mtod(m,caddr_t) + m->m_len;
+			xdrs->x_handy    = M_TRAILINGSPACE(m) > 0 ? M_TRAILINGSPACE(m) : 0;
+		} else {
+			xdrs->x_private  = mtod(m,caddr_t);
+			xdrs->x_handy    = m->m_len;
+		}
 		xdrs->x_ops      = ((uintptr_t)xdrs->x_private & (sizeof(int32_t) - 1))
 								? &xdrmbuf_ops_unaligned : &xdrmbuf_ops_aligned;
 }
@@ -181,9 +196,93 @@ MBPrivate		mbp = (MBPrivate)xdrs->x_base;
 	return rval;
 }
 
+static void
+xdrmbuf_dummyproc(caddr_t ext_buf, u_int ext_size)
+{
+}
+
+/* Append 'm' to the chain being encoded
+ * and continue encoding there.
+ */
+static void
+xdrmbuf_append(XDR *xdrs, struct mbuf *m)
+{
+MBPrivate		mbp = (MBPrivate)xdrs->x_base;
+
+	mbp->pos               += mbp->mcurrent->m_len;
+	mbp->mcurrent->m_next   = m;
+	xdrmbuf_setup(xdrs, m);
+}
+
+/* Append an empty mbuf cluster when
+ * the current mbuf is full.
+ */
+static bool_t
+xdrmbuf_grow(XDR *xdrs)
+{
+struct mbuf		*m;
+
+	rtems_bsdnet_semaphore_obtain();
+	MGET(m, M_WAIT, MT_DATA);
+	if ( m ) {
+		MCLGET(m, M_WAIT);
+		if ( !(m->m_flags & M_EXT) ) {
+			m_free(m);
+			m = 0;
+		}
+	}
+	rtems_bsdnet_semaphore_release();
+
+	if ( !m )
+		return FALSE;
+
+	m->m_len = 0;
+	xdrmbuf_append(xdrs, m);
+	return TRUE;
+}
+
+/* Append an external mbuf which references
+ * the caller's data instead of copying it.
+ */
+static bool_t
+xdrmbuf_putref(XDR *xdrs, const char *addr, u_int len)
+{
+struct mbuf		*m;
+
+	rtems_bsdnet_semaphore_obtain();
+	MGET(m, M_WAIT, MT_DATA);
+	rtems_bsdnet_semaphore_release();
+
+	if ( !m )
+		return FALSE;
+
+	m->m_flags       |= M_EXT;
+	m->m_ext.ext_buf  = (caddr_t)addr;
+	m->m_ext.ext_size = len;
+	/* non-null procs; otherwise, the kernel
+	 * code assumes it's a mbuf cluster
+	 */
+	m->m_ext.ext_free = xdrmbuf_dummyproc;
+	m->m_ext.ext_ref  = xdrmbuf_dummyproc;
+	m->m_data         = (caddr_t)addr;
+	m->m_len          = len;
+
+	/* no trailing space; the next put grows the chain */
+	xdrmbuf_append(xdrs, m);
+	return TRUE;
+}
+
 /*
  * The procedure xdrmbuf_create initializes a stream descriptor for a
  * memory buffer.
+ *
+ * An encoding stream appends to the mbuf chain starting
+ * at the end of the data in 'mbuf'. Opaque data of at
+ * least XDRMBUF_REF_MIN bytes is referenced by external
+ * mbufs, i.e. it must remain valid until the chain is
+ * freed. The chain is never freed by the stream and
+ * the length of a packet header is left to the caller
+ * (XDR_GETPOS() after encoding).
  */
 void
 xdrmbuf_create(XDR *xdrs, struct mbuf *mbuf, enum xdr_op op)
@@ -265,15 +364,17 @@ xdrmbuf_putlong_aligned(
 	XDR *xdrs,
 	const long *lp)
 {
-fprintf(stderr,"TODO: xdrmbuf_putlong_aligned() is unimplemented\n");
-	return FALSE;
-#if 0
-	if ((xdrs->x_handy -= sizeof(int32_t)) < 0)
-		return (FALSE);
+	if (xdrs->x_handy < sizeof(int32_t)) {
+		/* a new mbuf cluster is aligned */
+		if (!xdrmbuf_grow(xdrs))
+			return FALSE;
+		return XDR_PUTLONG(xdrs, lp);
+	}
 	*(int32_t *)xdrs->x_private = htonl(*lp);
 	xdrs->x_private += sizeof(int32_t);
+	xdrs->x_handy   -= sizeof(int32_t);
+	((MBPrivate)xdrs->x_base)->mcurrent->m_len += sizeof(int32_t);
 	return (TRUE);
-#endif
 }
 
 static bool_t
@@ -372,21 +473,10 @@ xdrmbuf_putlong_unaligned(
 	XDR *xdrs,
 	const long *lp )
 {
+int32_t l = htonl(*lp);
 
-	fprintf(stderr,"TODO: xdrmbuf_putlong_unaligned() is unimplemented\n");
-	return FALSE;
-#if 0
-	{
-	int32_t l;
-
-	if ((xdrs->x_handy -= sizeof(int32_t)) < 0)
-		return (FALSE);
-	l = htonl(*lp);
-	memcpy(xdrs->x_private, &l, sizeof(int32_t));
-	xdrs->x_private += sizeof(int32_t);
-	return (TRUE);
-	}
-#endif
+	/* may cross mbufs */
+	return xdrmbuf_putbytes(xdrs, (const char *)&l, sizeof(l));
 }
 
 static bool_t
@@ -439,16 +529,23 @@ xdrmbuf_putbytes(
 	const char *addr,
 	u_int len )
 {
-
-	fprintf(stderr,"TODO: xdrmbuf_putbytes() is unimplemented\n");
-	return FALSE;
-#if 0
-	if ((xdrs->x_handy -= len) < 0)
-		return (FALSE);
-	memcpy(xdrs->x_private, addr, len);
-	xdrs->x_private += len;
+u_int	n;
+
+	if (len >= XDRMBUF_REF_MIN)
+		return xdrmbuf_putref(xdrs, addr, len);
+
+	while (len > 0) {
+		if (0 == xdrs->x_handy && !xdrmbuf_grow(xdrs))
+			return FALSE;
+		n = xdrs->x_handy < len ? xdrs->x_handy : len;
+		memcpy(xdrs->x_private, addr, n);
+		xdrs->x_private += n;
+		xdrs->x_handy   -= n;
+		((MBPrivate)xdrs->x_base)->mcurrent->m_len += n;
+		addr            += n;
+		len             -= n;
+	}
 	return (TRUE);
-#endif
 }
 
 static u_int
@@ -486,6 +583,10 @@ xdrmbuf_setpos(
 struct		mbuf *m;
 MBPrivate	mbp   = (MBPrivate)xdrs->x_base;
 
+	/* the encoder only appends */
+	if (XDR_ENCODE == xdrs->x_op)
+		return pos == xdrmbuf_getpos(xdrs) ? TRUE : FALSE;
+
 	if (pos >= mbp->pos) {
 		pos      -= mbp->pos;
 		m         = mbp->mcurrent;
@@ -503,6 +604,7 @@ MBPrivate	mbp   = (MBPrivate)xdrs->x_base;
 	if (m) {
 		xdrmbuf_setup(xdrs, m);
 		xdrs->x_private += pos;
+		xdrs->x_handy   -= pos;
 		return TRUE;
 	}
 
@@ -516,8 +618,14 @@ xdrmbuf_inline_aligned(
 {
 int32_t	*buf = 0;
 
-	if (xdrs->x_handy == 0 && !xdrmbuf_next(xdrs))
+	if (XDR_ENCODE == xdrs->x_op) {
+		/* the caller falls back to XDR_PUTLONG */
+		if (xdrs->x_handy < len)
+			return 0;
+		((MBPrivate)xdrs->x_base)->mcurrent->m_len += len;
+	} else if (xdrs->x_handy == 0 && !xdrmbuf_next(xdrs)) {
 		return 0;
+	}
 
 	if (xdrs->x_handy >= len) {
 		xdrs->x_handy -= len;
@@ -542,3 +650,72 @@ xdrmbuf_inline_unaligned(
 {
 	return (0);
 }
+
+/*
+ * Hand out the opaque data of 'len' bytes at the current
+ * position of a decoding stream as up to '*piovcnt' iovecs
+ * pointing into the mbuf chain; the XDR padding is skipped.
+ * '*piovcnt' is set to the number of iovecs used.
+ *
+ * Other streams must provide the data contiguously
+ * (XDR_INLINE()).
+ *
+ * RETURNS: TRUE on success; FALSE if the data is truncated
+ *          or spread over more than '*piovcnt' mbufs. The
+ *          stream is not advanced in the latter case.
+ */
+bool_t
+xdrmbuf_getiov(XDR *xdrs, struct iovec *iov, int *piovcnt, u_int len)
+{
+u_int	pad = RNDUP(len) - len;
+u_int	pos;
+u_int	n;
+int		cnt = 0;
+int32_t	*buf;
+
+	if (   xdrs->x_ops != &xdrmbuf_ops_aligned
+		&& xdrs->x_ops != &xdrmbuf_ops_unaligned ) {
+		if (*piovcnt < 1 || !(buf = XDR_INLINE(xdrs, RNDUP(len))))
+			return FALSE;
+		iov[0].iov_base = buf;
+		iov[0].iov_len  = len;
+		*piovcnt        = 1;
+		return TRUE;
+	}
+
+	pos = xdrmbuf_getpos(xdrs);
+
+	while (len > 0) {
+		if (0 == xdrs->x_handy) {
+			if (!xdrmbuf_next(xdrs))
+				return FALSE;
+			continue;
+		}
+		if (cnt >= *piovcnt) {
+			xdrmbuf_setpos(xdrs, pos);
+			return FALSE;
+		}
+		n = xdrs->x_handy < len ? xdrs->x_handy : len;
+		iov[cnt].iov_base = xdrs->x_private;
+		iov[cnt].iov_len  = n;
+		cnt++;
+		xdrs->x_private += n;
+		xdrs->x_handy   -= n;
+		len             -= n;
+	}
+
+	while (pad > 0) {
+		if (0 == xdrs->x_handy) {
+			if (!xdrmbuf_next(xdrs))
+				return FALSE;
+			continue;
+		}
+		n = xdrs->x_handy < pad ? xdrs->x_handy : pad;
+		xdrs->x_private += n;
+		xdrs->x_handy   -= n;
+		pad             -= n;
+	}
+
+	*piovcnt = cnt;
+	return TRUE;
+}
@@ -25,7 +25,6 @@
 
 #include <rtems.h>
 #include <rtems/libio_.h>
-#include <rtems/rtems/barrierimpl.h>
 #include <rtems/score/statesimpl.h>
 
 #include "pipe.h"
@@ -36,10 +35,14 @@
 static rtems_id pipe_semaphore = RTEMS_ID_NONE;
 
 
-#define PIPE_EMPTY(_pipe) (_pipe->Length == 0)
-#define PIPE_FULL(_pipe)  (_pipe->Length == _pipe->Size)
-#define PIPE_SPACE(_pipe) (_pipe->Size - _pipe->Length)
-#define PIPE_WSTART(_pipe) ((_pipe->Start + _pipe->Length) % _pipe->Size)
+/* The ring indices wrap around modulo 2^32 which the size must divide */
+RTEMS_STATIC_ASSERT((PIPE_BUF & (PIPE_BUF - 1)) == 0, PIPE_BUF);
+
+#define PIPE_MAX_SIZE (1024 * 1024)
+
+#define PIPE_EMPTY(_pipe) (pipe_length(_pipe) == 0)
+#define PIPE_FULL(_pipe)  (pipe_length(_pipe) == _pipe->Size)
+#define PIPE_SPACE(_pipe) (_pipe->Size - pipe_length(_pipe))
 
 #define PIPE_LOCK(_pipe)  \
   ( rtems_semaphore_obtain(_pipe->Semaphore, RTEMS_WAIT, RTEMS_NO_TIMEOUT)  \
@@ -47,19 +50,167 @@ static rtems_id pipe_semaphore = RTEMS_ID_NONE;
 
 #define PIPE_UNLOCK(_pipe)  rtems_semaphore_release(_pipe->Semaphore)
 
-#define PIPE_READWAIT(_pipe)  \
-  ( rtems_barrier_wait(_pipe->readBarrier, RTEMS_NO_TIMEOUT)  \
-   == RTEMS_SUCCESSFUL)
+#define PIPE_READLOCK(_pipe)  \
+  ( rtems_semaphore_obtain(_pipe->readSemaphore, RTEMS_WAIT, RTEMS_NO_TIMEOUT) \
+   == RTEMS_SUCCESSFUL )
+
+#define PIPE_READUNLOCK(_pipe)  rtems_semaphore_release(_pipe->readSemaphore)
+
+#define PIPE_WRITELOCK(_pipe)  \
+  ( rtems_semaphore_obtain(_pipe->writeSemaphore, RTEMS_WAIT, RTEMS_NO_TIMEOUT) \
+   == RTEMS_SUCCESSFUL )
+
+#define PIPE_WRITEUNLOCK(_pipe)  rtems_semaphore_release(_pipe->writeSemaphore)
+
+/* Called with the pipe lock held, returns with the pipe lock held on success */
+#define PIPE_READWAIT(_pipe)  pipe_wait(_pipe, &_pipe->readWaiters)
+
+#define PIPE_WRITEWAIT(_pipe)  pipe_wait(_pipe, &_pipe->writeWaiters)
+
+/* Called with the pipe lock held */
+#define PIPE_WAKEUPREADERS(_pipe) pipe_wakeup(&_pipe->readWaiters)
+
+#define PIPE_WAKEUPWRITERS(_pipe) pipe_wakeup(&_pipe->writeWaiters)
+
+/* Activate kernel event notes, called with the pipe lock held */
+#define PIPE_KNOTE(_notes) \
+  do { if (!KNLIST_EMPTY(_notes)) KNOTE_LOCKED(_notes, 0); } while(0)
+
+typedef struct {
+  rtems_chain_node Node;
+  rtems_id task;
+  bool woken;
+} pipe_waiter;
+
+/*
+ * Returns the count of bytes in the pipe.  Out is loaded first, so the
+ * difference is only too large if both sides made progress in between.
+ */
+static inline unsigned int pipe_length(pipe_control_t *pipe)
+{
+  unsigned int out = _Atomic_Load_uint(&pipe->Out, ATOMIC_ORDER_SEQ_CST);
+  unsigned int in = _Atomic_Load_uint(&pipe->In, ATOMIC_ORDER_SEQ_CST);
+
+  return MIN(in - out, pipe->Size);
+}
+
+/*
+ * Wait until woken up by pipe_wakeup().  The waiter is enqueued before the
+ * pipe lock is released and the transient event stays pending until it is
+ * received, so no wake up gets lost.  A transient event left over from an
+ * earlier wait must not end this one while the waiter is still on the chain,
+ * so the woken flag set by pipe_wakeup() under the pipe lock decides.
+ */
+static bool pipe_wait(
+  pipe_control_t      *pipe,
+  rtems_chain_control *waiters
+)
+{
+  pipe_waiter waiter;
+
+  waiter.task = rtems_task_self();
+  waiter.woken = false;
+  rtems_event_transient_clear();
+  rtems_chain_append_unprotected(waiters, &waiter.Node);
+
+  do {
+    PIPE_UNLOCK(pipe);
+
+    rtems_event_transient_receive(RTEMS_WAIT, RTEMS_NO_TIMEOUT);
+
+    if (!PIPE_LOCK(pipe))
+      return false;
+  } while (!waiter.woken);
+
+  return true;
+}
+
+static void pipe_wakeup(
+  rtems_chain_control *waiters
+)
+{
+  while (!rtems_chain_is_empty(waiters)) {
+    pipe_waiter *waiter =
+      (pipe_waiter *) rtems_chain_get_unprotected(waiters);
 
-#define PIPE_WRITEWAIT(_pipe)  \
-  ( rtems_barrier_wait(_pipe->writeBarrier, RTEMS_NO_TIMEOUT)  \
-   == RTEMS_SUCCESSFUL)
+    waiter->woken = true;
+    rtems_event_transient_send(waiter->task);
+  }
+}
 
-#define PIPE_WAKEUPREADERS(_pipe) \
-  do {uint32_t n; rtems_barrier_release(_pipe->readBarrier, &n); } while(0)
+/* Called with the read lock held */
+static size_t pipe_ring_read(
+  pipe_control_t *pipe,
+  char           *buffer,
+  size_t          count
+)
+{
+  unsigned int out = _Atomic_Load_uint(&pipe->Out, ATOMIC_ORDER_RELAXED);
+  unsigned int in = _Atomic_Load_uint(&pipe->In, ATOMIC_ORDER_ACQUIRE);
+  unsigned int start = out & (pipe->Size - 1);
+  size_t chunk, chunk1;
 
-#define PIPE_WAKEUPWRITERS(_pipe) \
-  do {uint32_t n; rtems_barrier_release(_pipe->writeBarrier, &n); } while(0)
+  chunk = MIN(count, in - out);
+  chunk1 = pipe->Size - start;
+  if (chunk > chunk1) {
+    memcpy(buffer, pipe->Buffer + start, chunk1);
+    memcpy(buffer + chunk1, pipe->Buffer, chunk - chunk1);
+  }
+  else
+    memcpy(buffer, pipe->Buffer + start, chunk);
+
+  _Atomic_Store_uint(&pipe->Out, out + chunk, ATOMIC_ORDER_SEQ_CST);
+
+  return chunk;
+}
+
+/* Called with the write lock held */
+static size_t pipe_ring_write(
+  pipe_control_t *pipe,
+  const char     *buffer,
+  size_t          count
+)
+{
+  unsigned int in = _Atomic_Load_uint(&pipe->In, ATOMIC_ORDER_RELAXED);
+  unsigned int out = _Atomic_Load_uint(&pipe->Out, ATOMIC_ORDER_ACQUIRE);
+  unsigned int start = in & (pipe->Size - 1);
+  size_t chunk, chunk1;
+
+  chunk = MIN(count, pipe->Size - (in - out));
+  chunk1 = pipe->Size - start;
+  if (chunk > chunk1) {
+    memcpy(pipe->Buffer + start, buffer, chunk1);
+    memcpy(pipe->Buffer, buffer + chunk1, chunk - chunk1);
+  }
+  else
+    memcpy(pipe->Buffer + start, buffer, chunk);
+
+  _Atomic_Store_uint(&pipe->In, in + chunk, ATOMIC_ORDER_SEQ_CST);
+
+  return chunk;
+}
+
+/*
+ * A side about to wait increments its waiting count before it checks the
+ * ring a last time under the pipe lock.  So the other side takes the pipe
+ * lock only if somebody waits or kernel event notes are attached.
+ */
+static void pipe_notify(
+  pipe_control_t      *pipe,
+  Atomic_Uint         *waiting,
+  rtems_chain_control *waiters,
+  struct knlist       *notes
+)
+{
+  if (_Atomic_Load_uint(waiting, ATOMIC_ORDER_SEQ_CST) != 0
+      || !KNLIST_EMPTY(notes)) {
+    if (PIPE_LOCK(pipe)) {
+      pipe_wakeup(waiters);
+      PIPE_KNOTE(notes);
+      PIPE_UNLOCK(pipe);
+    }
+  }
+}
 
 /*
  * Alloc pipe control structure, buffer, and resources.
@@ -83,18 +234,25 @@ static int pipe_alloc(
   if (! pipe->Buffer)
     goto err_buf;
 
+  _Atomic_Init_uint(&pipe->In, 0);
+  _Atomic_Init_uint(&pipe->Out, 0);
+  _Atomic_Init_uint(&pipe->waitingReaders, 0);
+  _Atomic_Init_uint(&pipe->waitingWriters, 0);
+  rtems_chain_initialize_empty(&pipe->readWaiters);
+  rtems_chain_initialize_empty(&pipe->writeWaiters);
+
   err = -ENOMEM;
 
-  if (rtems_barrier_create(
-        rtems_build_name ('P', 'I', 'r', c),
-        RTEMS_BARRIER_MANUAL_RELEASE, 0,
-        &pipe->readBarrier) != RTEMS_SUCCESSFUL)
-    goto err_rbar;
-  if (rtems_barrier_create(
-        rtems_build_name ('P', 'I', 'w', c),
-        RTEMS_BARRIER_MANUAL_RELEASE, 0,
-        &pipe->writeBarrier) != RTEMS_SUCCESSFUL)
-    goto err_wbar;
+  if (rtems_semaphore_create(
+        rtems_build_name ('P', 'I', 'r', c), 1,
+        RTEMS_BINARY_SEMAPHORE | RTEMS_INHERIT_PRIORITY | RTEMS_PRIORITY,
+        RTEMS_NO_PRIORITY, &pipe->readSemaphore) != RTEMS_SUCCESSFUL)
+    goto err_rsem;
+  if (rtems_semaphore_create(
+        rtems_build_name ('P', 'I', 'w', c), 1,
+        RTEMS_BINARY_SEMAPHORE | RTEMS_INHERIT_PRIORITY | RTEMS_PRIORITY,
+        RTEMS_NO_PRIORITY, &pipe->writeSemaphore) != RTEMS_SUCCESSFUL)
+    goto err_wsem;
   if (rtems_semaphore_create(
         rtems_build_name ('P', 'I', 's', c), 1,
         RTEMS_BINARY_SEMAPHORE | RTEMS_FIFO,
@@ -107,10 +265,10 @@ static int pipe_alloc(
   return 0;
 
 err_sem:
-  rtems_barrier_delete(pipe->writeBarrier);
-err_wbar:
-  rtems_barrier_delete(pipe->readBarrier);
-err_rbar:
+  rtems_semaphore_delete(pipe->writeSemaphore);
+err_wsem:
+  rtems_semaphore_delete(pipe->readSemaphore);
+err_rsem:
   free(pipe->Buffer);
 err_buf:
   free(pipe);
@@ -122,8 +280,8 @@ static inline void pipe_free(
   pipe_control_t *pipe
 )
 {
-  rtems_barrier_delete(pipe->readBarrier);
-  rtems_barrier_delete(pipe->writeBarrier);
+  rtems_semaphore_delete(pipe->readSemaphore);
+  rtems_semaphore_delete(pipe->writeSemaphore);
   rtems_semaphore_delete(pipe->Semaphore);
   free(pipe->Buffer);
   free(pipe);
@@ -222,15 +380,21 @@ void pipe_release(
   pipe_control_t *pipe = *pipep;
   uint32_t mode;
 
-  #if defined(RTEMS_DEBUG)
-    /* WARN pipe not freed and pipep not set to NULL! */
-    if (pipe_lock())
-      rtems_fatal_error_occurred(0xdeadbeef);
+  /*
+   * The close path and the fifo_open() error path hold neither lock.  The
+   * waiter chains and the reader and writer counts need the pipe lock, the
+   * release of the pipe needs the global pipe lock.
+   */
 
-    /* WARN pipe not released! */
-    if (!PIPE_LOCK(pipe))
-      rtems_fatal_error_occurred(0xdeadbeef);
-  #endif
+  /* WARN pipe not freed and pipep not set to NULL! */
+  if (pipe_lock())
+    return;
+
+  /* WARN pipe not released! */
+  if (!PIPE_LOCK(pipe)) {
+    pipe_unlock();
+    return;
+  }
 
   mode = LIBIO_ACCMODE(iop);
   if (mode & LIBIO_FLAGS_READ)
@@ -238,6 +402,12 @@ void pipe_release(
   if (mode & LIBIO_FLAGS_WRITE)
      pipe->Writers --;
 
+  /* Notify waiting partners that all their partners left */
+  if (pipe->Readers == 0 && mode != LIBIO_FLAGS_WRITE)
+    PIPE_WAKEUPWRITERS(pipe);
+  else if (pipe->Writers == 0 && mode != LIBIO_FLAGS_READ)
+    PIPE_WAKEUPREADERS(pipe);
+
   PIPE_UNLOCK(pipe);
 
   if (pipe->Readers == 0 && pipe->Writers == 0) {
@@ -249,11 +419,14 @@ void pipe_release(
     pipe_free(pipe);
     *pipep = NULL;
   }
-  else if (pipe->Readers == 0 && mode != LIBIO_FLAGS_WRITE)
-    /* Notify waiting Writers that all their partners left */
-    PIPE_WAKEUPWRITERS(pipe);
-  else if (pipe->Writers == 0 && mode != LIBIO_FLAGS_READ)
-    PIPE_WAKEUPREADERS(pipe);
+  else if (pipe->Readers == 0 && mode != LIBIO_FLAGS_WRITE) {
+    if (!KNLIST_EMPTY(&pipe->writeNotes))
+      KNOTE_UNLOCKED(&pipe->writeNotes, 0);
+  }
+  else if (pipe->Writers == 0 && mode != LIBIO_FLAGS_READ) {
+    if (!KNLIST_EMPTY(&pipe->readNotes))
+      KNOTE_UNLOCKED(&pipe->readNotes, 0);
+  }
 
   pipe_unlock();
 
@@ -300,11 +473,8 @@ int fifo_open(
         err = -EINTR;
         /* Wait until a writer opens the pipe */
         do {
-          PIPE_UNLOCK(pipe);
           if (! PIPE_READWAIT(pipe))
             goto out_error;
-          if (! PIPE_LOCK(pipe))
-            goto out_error;
         } while (prevCounter == pipe->writerCounter);
       }
       break;
@@ -325,11 +495,8 @@ int fifo_open(
         prevCounter = pipe->readerCounter;
         err = -EINTR;
         do {
-          PIPE_UNLOCK(pipe);
           if (! PIPE_WRITEWAIT(pipe))
             goto out_error;
-          if (! PIPE_LOCK(pipe))
-            goto out_error;
         } while (prevCounter == pipe->readerCounter);
       }
       break;
@@ -359,61 +526,55 @@ ssize_t pipe_read(
   rtems_libio_t  *iop
 )
 {
-  int chunk, chunk1, read = 0, ret = 0;
+  int read = 0, ret = 0;
 
-  if (! PIPE_LOCK(pipe))
-    return -EINTR;
+  if (count == 0)
+    return 0;
 
-  while (PIPE_EMPTY(pipe)) {
-    /* Not an error */
-    if (pipe->Writers == 0)
-      goto out_locked;
+  while (true) {
+    bool empty;
 
-    if (LIBIO_NODELAY(iop)) {
-      ret = -EAGAIN;
-      goto out_locked;
-    }
+    if (! PIPE_READLOCK(pipe))
+      return -EINTR;
 
-    /* Wait until pipe is no more empty or no writer exists */
-    pipe->waitingReaders ++;
-    PIPE_UNLOCK(pipe);
-    if (! PIPE_READWAIT(pipe))
-      ret = -EINTR;
-    if (! PIPE_LOCK(pipe)) {
-      /* WARN waitingReaders not restored! */
-      ret = -EINTR;
-      goto out_nolock;
+    read = pipe_ring_read(pipe, buffer, count);
+    PIPE_READUNLOCK(pipe);
+
+    if (read > 0) {
+      pipe_notify(pipe, &pipe->waitingWriters, &pipe->writeWaiters,
+        &pipe->writeNotes);
+      break;
     }
-    pipe->waitingReaders --;
-    if (ret != 0)
-      goto out_locked;
-  }
 
-  /* Read chunk bytes */
-  chunk = MIN(count - read,  pipe->Length);
-  chunk1 = pipe->Size - pipe->Start;
-  if (chunk > chunk1) {
-    memcpy(buffer + read, pipe->Buffer + pipe->Start, chunk1);
-    memcpy(buffer + read + chunk1, pipe->Buffer, chunk - chunk1);
-  }
-  else
-    memcpy(buffer + read, pipe->Buffer + pipe->Start, chunk);
+    if (! PIPE_LOCK(pipe))
+      return -EINTR;
 
-  pipe->Start += chunk;
-  pipe->Start %= pipe->Size;
-  pipe->Length -= chunk;
-  /* For buffering optimization */
-  if (PIPE_EMPTY(pipe))
-    pipe->Start = 0;
+    _Atomic_Fetch_add_uint(&pipe->waitingReaders, 1, ATOMIC_ORDER_SEQ_CST);
 
-  if (pipe->waitingWriters > 0)
-    PIPE_WAKEUPWRITERS(pipe);
-  read += chunk;
+    while ((empty = PIPE_EMPTY(pipe))) {
+      /* Not an error */
+      if (pipe->Writers == 0)
+        break;
 
-out_locked:
-  PIPE_UNLOCK(pipe);
+      if (LIBIO_NODELAY(iop)) {
+        ret = -EAGAIN;
+        break;
+      }
+
+      /* Wait until pipe is no more empty or no writer exists */
+      if (! PIPE_READWAIT(pipe)) {
+        /* WARN waitingReaders not restored! */
+        return -EINTR;
+      }
+    }
+
+    _Atomic_Fetch_sub_uint(&pipe->waitingReaders, 1, ATOMIC_ORDER_SEQ_CST);
+    PIPE_UNLOCK(pipe);
+
+    if (empty)
+      break;
+  }
 
-out_nolock:
   if (read > 0)
     return read;
   return ret;
@@ -426,70 +587,77 @@ ssize_t pipe_write(
   rtems_libio_t  *iop
 )
 {
-  int chunk, chunk1, written = 0, ret = 0;
+  size_t chunk, written = 0;
+  int ret = 0;
 
   /* Write nothing */
   if (count == 0)
     return 0;
 
-  if (! PIPE_LOCK(pipe))
-    return -EINTR;
+  /* Write of PIPE_BUF bytes or less shall not be interleaved */
+  chunk = count;
 
-  if (pipe->Readers == 0) {
-    ret = -EPIPE;
-    goto out_locked;
-  }
+  while (true) {
+    size_t progress = 0;
 
-  /* Write of PIPE_BUF bytes or less shall not be interleaved */
-  chunk = count <= pipe->Size ? count : 1;
+    if (! PIPE_WRITELOCK(pipe)) {
+      ret = -EINTR;
+      break;
+    }
 
-  while (written < count) {
-    while (PIPE_SPACE(pipe) < chunk) {
-      if (LIBIO_NODELAY(iop)) {
-        ret = -EAGAIN;
-        goto out_locked;
-      }
+    if (pipe->Readers == 0) {
+      PIPE_WRITEUNLOCK(pipe);
+      ret = -EPIPE;
+      break;
+    }
 
-      /* Wait until there is chunk bytes space or no reader exists */
-      pipe->waitingWriters ++;
-      PIPE_UNLOCK(pipe);
-      if (! PIPE_WRITEWAIT(pipe))
-        ret = -EINTR;
-      if (! PIPE_LOCK(pipe)) {
+    if (chunk > pipe->Size)
+      chunk = 1;
+
+    while (written < count && PIPE_SPACE(pipe) >= chunk) {
+      size_t n = pipe_ring_write(pipe, (const char *) buffer + written,
+        count - written);
+
+      written += n;
+      progress += n;
+      /* Write of more than PIPE_BUF bytes can be interleaved */
+      chunk = 1;
+    }
+
+    PIPE_WRITEUNLOCK(pipe);
+
+    if (progress > 0)
+      pipe_notify(pipe, &pipe->waitingReaders, &pipe->readWaiters,
+        &pipe->readNotes);
+
+    if (written == count)
+      break;
+
+    if (LIBIO_NODELAY(iop)) {
+      ret = -EAGAIN;
+      break;
+    }
+
+    if (! PIPE_LOCK(pipe)) {
+      ret = -EINTR;
+      break;
+    }
+
+    _Atomic_Fetch_add_uint(&pipe->waitingWriters, 1, ATOMIC_ORDER_SEQ_CST);
+
+    /* Wait until there is chunk bytes space or no reader exists */
+    while (PIPE_SPACE(pipe) < chunk && pipe->Readers > 0) {
+      if (! PIPE_WRITEWAIT(pipe)) {
         /* WARN waitingWriters not restored! */
         ret = -EINTR;
         goto out_nolock;
       }
-      pipe->waitingWriters --;
-      if (ret != 0)
-        goto out_locked;
-
-      if (pipe->Readers == 0) {
-        ret = -EPIPE;
-        goto out_locked;
-      }
     }
 
-    chunk = MIN(count - written, PIPE_SPACE(pipe));
-    chunk1 = pipe->Size - PIPE_WSTART(pipe);
-    if (chunk > chunk1) {
-      memcpy(pipe->Buffer + PIPE_WSTART(pipe), buffer + written, chunk1);
-      memcpy(pipe->Buffer, buffer + written + chunk1, chunk - chunk1);
-    }
-    else
-      memcpy(pipe->Buffer + PIPE_WSTART(pipe), buffer + written, chunk);
-
-    pipe->Length += chunk;
-    if (pipe->waitingReaders > 0)
-      PIPE_WAKEUPREADERS(pipe);
-    written += chunk;
-    /* Write of more than PIPE_BUF bytes can be interleaved */
-    chunk = 1;
+    _Atomic_Fetch_sub_uint(&pipe->waitingWriters, 1, ATOMIC_ORDER_SEQ_CST);
+    PIPE_UNLOCK(pipe);
   }
 
-out_locked:
-  PIPE_UNLOCK(pipe);
-
 out_nolock:
 #ifdef RTEMS_POSIX_API
   /* Signal SIGPIPE */
@@ -502,6 +670,75 @@ out_nolock:
   return ret;
 }
 
+/*
+ * Change the buffer size.  Both sides are locked, so the ring is quiescent.
+ */
+static int pipe_resize(
+  pipe_control_t *pipe,
+  int            *size
+)
+{
+  unsigned int length;
+  unsigned int new_size = PIPE_BUF;
+  char *new_buffer;
+  int ret = 0;
+
+  if (*size < 0)
+    return -EINVAL;
+
+  if (*size > PIPE_MAX_SIZE)
+    return -EPERM;
+
+  while (new_size < (unsigned int) *size)
+    new_size *= 2;
+
+  if (! PIPE_WRITELOCK(pipe))
+    return -EINTR;
+
+  if (! PIPE_READLOCK(pipe)) {
+    PIPE_WRITEUNLOCK(pipe);
+    return -EINTR;
+  }
+
+  if (! PIPE_LOCK(pipe)) {
+    ret = -EINTR;
+    goto out;
+  }
+
+  length = pipe_length(pipe);
+  if (length > new_size) {
+    ret = -EBUSY;
+    goto out_locked;
+  }
+
+  if (new_size != pipe->Size) {
+    new_buffer = malloc(new_size);
+    if (new_buffer == NULL) {
+      ret = -ENOMEM;
+      goto out_locked;
+    }
+
+    pipe_ring_read(pipe, new_buffer, length);
+    free(pipe->Buffer);
+    pipe->Buffer = new_buffer;
+    pipe->Size = new_size;
+    _Atomic_Store_uint(&pipe->Out, 0, ATOMIC_ORDER_RELAXED);
+    _Atomic_Store_uint(&pipe->In, length, ATOMIC_ORDER_RELAXED);
+
+    /* There may be space for waiting writers now */
+    PIPE_WAKEUPWRITERS(pipe);
+  }
+
+  *size = (int) new_size;
+
+out_locked:
+  PIPE_UNLOCK(pipe);
+out:
+  PIPE_READUNLOCK(pipe);
+  PIPE_WRITEUNLOCK(pipe);
+  return ret;
+}
+
 int pipe_ioctl(
   pipe_control_t  *pipe,
   ioctl_command_t  cmd,
@@ -513,14 +750,120 @@ int pipe_ioctl(
     if (buffer == NULL)
       return -EFAULT;
 
-    if (! PIPE_LOCK(pipe))
-      return -EINTR;
-
     /* Return length of pipe */
-    *(unsigned int *)buffer = pipe->Length;
-    PIPE_UNLOCK(pipe);
+    *(unsigned int *)buffer = pipe_length(pipe);
     return 0;
   }
 
+  if (cmd == RTEMS_IO_GET_PIPE_SIZE) {
+    if (buffer == NULL)
+      return -EFAULT;
+
+    *(int *)buffer = (int) pipe->Size;
+    return 0;
+  }
+
+  if (cmd == RTEMS_IO_SET_PIPE_SIZE) {
+    if (buffer == NULL)
+      return -EFAULT;
+
+    return pipe_resize(pipe, buffer);
+  }
+
   return -EINVAL;
 }
+
+static void pipe_knlist_lock(void *arg)
+{
+  pipe_control_t *pipe = arg;
+
+  rtems_semaphore_obtain(pipe->Semaphore, RTEMS_WAIT, RTEMS_NO_TIMEOUT);
+}
+
+static void pipe_knlist_unlock(void *arg)
+{
+  pipe_control_t *pipe = arg;
+
+  rtems_semaphore_release(pipe->Semaphore);
+}
+
+static void pipe_kqfilter_detach(struct knote *kn)
+{
+  knlist_remove(kn->kn_knlist, kn, 0);
+}
+
+static int pipe_kqfilter_read_event(struct knote *kn, long hint)
+{
+  pipe_control_t *pipe = kn->kn_hook;
+
+  kn->kn_data = pipe_length(pipe);
+  if (pipe->Writers == 0) {
+    kn->kn_flags |= EV_EOF;
+    return 1;
+  }
+
+  return !PIPE_EMPTY(pipe);
+}
+
+static int pipe_kqfilter_write_event(struct knote *kn, long hint)
+{
+  pipe_control_t *pipe = kn->kn_hook;
+
+  kn->kn_data = PIPE_SPACE(pipe);
+  if (pipe->Readers == 0) {
+    kn->kn_flags |= EV_EOF;
+    return 1;
+  }
+
+  return !PIPE_FULL(pipe);
+}
+
+static struct filterops pipe_read_filtops = {
+  .f_isfd = 1,
+  .f_detach = pipe_kqfilter_detach,
+  .f_event = pipe_kqfilter_read_event
+};
+
+static struct filterops pipe_write_filtops = {
+  .f_isfd = 1,
+  .f_detach = pipe_kqfilter_detach,
+  .f_event = pipe_kqfilter_write_event
+};
+
+int pipe_kqfilter(
+  pipe_control_t *pipe,
+  struct knote   *kn,
+  rtems_libio_t  *iop
+)
+{
+  struct knlist *notes;
+
+  switch (kn->kn_filter) {
+    case EVFILT_READ:
+      if ((LIBIO_ACCMODE(iop) & LIBIO_FLAGS_READ) == 0)
+        return EINVAL;
+      kn->kn_fop = &pipe_read_filtops;
+      notes = &pipe->readNotes;
+      break;
+    case EVFILT_WRITE:
+      if ((LIBIO_ACCMODE(iop) & LIBIO_FLAGS_WRITE) == 0)
+        return EINVAL;
+      kn->kn_fop = &pipe_write_filtops;
+      notes = &pipe->writeNotes;
+      break;
+    default:
+      return EINVAL;
+  }
+
+  if (! PIPE_LOCK(pipe))
+    return EINTR;
+
+  kn->kn_hook = pipe;
+  if (notes->kl_lock == NULL)
+    knlist_init(notes, pipe, pipe_knlist_lock, pipe_knlist_unlock, NULL, NULL);
+  knlist_add(notes, kn, 1);
+
+  PIPE_UNLOCK(pipe);
+
+  return 0;
+}
@@ -19,6 +19,7 @@
 #define _RTEMS_PIPE_H
 
 #include <rtems/libio.h>
+#include <sys/event.h>
 
 /**
  * @defgroup FIFO_PIPE FIFO/Pipe File System Support
@@ -33,21 +34,33 @@
 extern "C" {
 #endif
 
-/* Control block to manage each pipe */
+/*
+ * Control block to manage each pipe.
+ *
+ * The buffer is a ring shared by one reader and one writer at a time.  The
+ * reader only advances Out and the writer only advances In, so the data
+ * transfer needs no lock shared by both sides.  The readSemaphore and
+ * writeSemaphore serialize the readers and writers among themselves.  The
+ * Semaphore protects the remaining state and the wait queues.
+ */
 typedef struct pipe_control {
   char *Buffer;
-  unsigned int Size;
-  unsigned int Start;
-  unsigned int Length;
+  unsigned int Size;              /* a power of two */
+  Atomic_Uint In;                 /* bytes written so far, modulo 2^32 */
+  Atomic_Uint Out;                /* bytes read so far, modulo 2^32 */
   unsigned int Readers;
   unsigned int Writers;
-  unsigned int waitingReaders;
-  unsigned int waitingWriters;
+  Atomic_Uint waitingReaders;
+  Atomic_Uint waitingWriters;
   unsigned int readerCounter;     /* incremental counters */
   unsigned int writerCounter;     /* for differentiation of successive opens */
   rtems_id Semaphore;
-  rtems_id readBarrier;   /* wait queues */
-  rtems_id writeBarrier;
+  rtems_id readSemaphore;
+  rtems_id writeSemaphore;
+  rtems_chain_control readWaiters;   /* wait queues */
+  rtems_chain_control writeWaiters;
+  struct knlist readNotes;   /* kernel event notes */
+  struct knlist writeNotes;
 #if 0
   boolean Anonymous;      /* anonymous pipe or FIFO */
 #endif
@@ -115,7 +128,9 @@ extern ssize_t pipe_write(
 /**
  * @brief File system Input/Output control.
  *
- * Interface to file system ioctl.
+ * Interface to file system ioctl.  Besides FIONREAD this supports
+ * RTEMS_IO_GET_PIPE_SIZE and RTEMS_IO_SET_PIPE_SIZE to get and change the
+ * pipe buffer size.
  */
 extern int pipe_ioctl(
   pipe_control_t  *pipe,
@@ -124,6 +139,18 @@ extern int pipe_ioctl(
   rtems_libio_t   *iop
 );
 
+/**
+ * @brief Attaches a kernel event note to the pipe.
+ *
+ * @retval 0 Successful operation.
+ * @retval EINVAL Invalid filter.
+ */
+extern int pipe_kqfilter(
+  pipe_control_t *pipe,
+  struct knote   *kn,
+  rtems_libio_t  *iop
+);
+
 /** @} */
 
 #ifdef __cplusplus
@@ -107,6 +107,70 @@ static void rtems_rfs_rtems_follow_link(
   }
 }
 
+/**
+ * The file system specific value of a path lookup cache entry.
+ */
+typedef struct
+{
+  rtems_rfs_ino ino;
+  uint32_t      doff;
+} rtems_rfs_rtems_dentry;
+
+static bool
+rtems_rfs_rtems_dentry_key (const rtems_filesystem_location_info_t* loc,
+                            uint64_t*                               key)
+{
+  *key = rtems_rfs_rtems_get_pathloc_ino (loc);
+  return true;
+}
+
+/**
+ * Look up a name in the directory at the location. The path lookup cache is
+ * checked first so a directory is only scanned once for a name until the
+ * name space of the file system changes.
+ */
+static int
+rtems_rfs_rtems_dir_lookup (const rtems_filesystem_location_info_t* parentloc,
+                            rtems_rfs_inode_handle*                 inode,
+                            const char*                             name,
+                            size_t                                  length,
+                            rtems_rfs_ino*                          ino,
+                            uint32_t*                               doff)
+{
+  rtems_rfs_file_system*               fs;
+  rtems_filesystem_dentry_cache_status status;
+  rtems_rfs_rtems_dentry               dentry;
+  int                                  rc;
+
+  status = rtems_filesystem_dentry_cache_lookup (parentloc, name, length,
+                                                 &dentry, sizeof (dentry));
+  if (status == RTEMS_FILESYSTEM_DENTRY_CACHE_HIT)
+  {
+    *ino = dentry.ino;
+    *doff = dentry.doff;
+    return 0;
+  }
+
+  if (status == RTEMS_FILESYSTEM_DENTRY_CACHE_NEGATIVE)
+    return ENOENT;
+
+  fs = rtems_rfs_rtems_pathloc_dev (parentloc);
+  rc = rtems_rfs_dir_lookup_ino (fs, inode, name, length, ino, doff);
+  if (rc == 0)
+  {
+    dentry.ino = *ino;
+    dentry.doff = *doff;
+    rtems_filesystem_dentry_cache_insert (parentloc, name, length,
+                                          &dentry, sizeof (dentry));
+  }
+  else if (rc == ENOENT)
+  {
+    rtems_filesystem_dentry_cache_insert (parentloc, name, length, NULL, 0);
+  }
+
+  return rc;
+}
+
 static rtems_filesystem_eval_path_generic_status
 rtems_rfs_rtems_eval_token(
   rtems_filesystem_eval_path_context_t *ctx,
@@ -129,8 +193,8 @@ rtems_rfs_rtems_eval_token(
       rtems_rfs_file_system* fs = rtems_rfs_rtems_pathloc_dev (currentloc);
       rtems_rfs_ino entry_ino;
       uint32_t entry_doff;
-      int rc = rtems_rfs_dir_lookup_ino (
-        fs,
+      int rc = rtems_rfs_rtems_dir_lookup (
+        currentloc,
         inode,
         token,
         tokenlen,
@@ -760,7 +824,8 @@ const rtems_filesystem_operations_table rtems_rfs_ops =
   .symlink_h      = rtems_rfs_rtems_symlink,
   .readlink_h     = rtems_rfs_rtems_readlink,
   .rename_h       = rtems_rfs_rtems_rename,
-  .statvfs_h      = rtems_rfs_rtems_statvfs
+  .statvfs_h      = rtems_rfs_rtems_statvfs,
+  .dentry_key_h   = rtems_rfs_rtems_dentry_key
 };
 
 /**
@@ -36,6 +36,7 @@
 #include "config.h"
 #endif
 
+#include <sys/endian.h>
 #include <string.h>	/* memcpy */
 
 #include "md5.h"
@@ -54,6 +55,26 @@
 /* forward declaration */
 static void Transform (UINT4 *buf, UINT4 *in);
 
+/* Decode converts a 64 byte block into 16 little-endian words. On a little
+   endian target this is a plain copy which also copes with unaligned input.
+ */
+#if BYTE_ORDER == LITTLE_ENDIAN
+#define Decode(out, block) memcpy ((out), (block), 64)
+#else
+static void Decode (
+  UINT4 *out,
+  const unsigned char *block )
+{
+  unsigned int i;
+
+  for (i = 0; i < 16; i++, block += 4)
+    out[i] = (((UINT4)block[3]) << 24) |
+             (((UINT4)block[2]) << 16) |
+             (((UINT4)block[1]) << 8) |
+             ((UINT4)block[0]);
+}
+#endif
+
 static unsigned char PADDING[64] = {
   0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -129,14 +150,13 @@ void MD5Update (
   unsigned int inLen )
 {
   UINT4 in[16];
-  int mdi;
-  unsigned int i, ii;
+  unsigned int mdi, n;
   const unsigned char *inBuf;
 
   inBuf = inBufArg;
 
   /* compute number of bytes mod 64 */
-  mdi = (int)((mdContext->i[0] >> 3) & 0x3F);
+  mdi = (unsigned int)((mdContext->i[0] >> 3) & 0x3F);
 
   /* update number of bits */
   if ((mdContext->i[0] + ((UINT4)inLen << 3)) < mdContext->i[0])
@@ -144,21 +164,30 @@ void MD5Update (
   mdContext->i[0] += ((UINT4)inLen << 3);
   mdContext->i[1] += ((UINT4)inLen >> 29);
 
-  while (inLen--) {
-    /* add new character to buffer, increment mdi */
-    mdContext->in[mdi++] = *inBuf++;
-
-    /* transform if necessary */
-    if (mdi == 0x40) {
-      for (i = 0, ii = 0; i < 16; i++, ii += 4)
-        in[i] = (((UINT4)mdContext->in[ii+3]) << 24) |
-                (((UINT4)mdContext->in[ii+2]) << 16) |
-                (((UINT4)mdContext->in[ii+1]) << 8) |
-                ((UINT4)mdContext->in[ii]);
-      Transform (mdContext->buf, in);
-      mdi = 0;
+  /* complete a partial block held in the buffer */
+  if (mdi != 0) {
+    n = 0x40 - mdi;
+    if (inLen < n) {
+      memcpy (&mdContext->in[mdi], inBuf, inLen);
+      return;
     }
+    memcpy (&mdContext->in[mdi], inBuf, n);
+    Decode (in, mdContext->in);
+    Transform (mdContext->buf, in);
+    inBuf += n;
+    inLen -= n;
   }
+
+  /* transform complete blocks directly from the input */
+  while (inLen >= 0x40) {
+    Decode (in, inBuf);
+    Transform (mdContext->buf, in);
+    inBuf += 0x40;
+    inLen -= 0x40;
+  }
+
+  /* keep the remainder for the next call */
+  memcpy (mdContext->in, inBuf, inLen);
 }
 
 /* The routine MD5Final terminates the message-digest computation and
@@ -169,13 +198,14 @@ void MD5Final (
   MD5_CTX *mdContext )
 {
   UINT4 in[16];
+  UINT4 bits[2];
   int mdi;
   unsigned int i, ii;
   unsigned int padLen;
 
   /* save number of bits */
-  in[14] = mdContext->i[0];
-  in[15] = mdContext->i[1];
+  bits[0] = mdContext->i[0];
+  bits[1] = mdContext->i[1];
 
   /* compute number of bytes mod 64 */
   mdi = (int)((mdContext->i[0] >> 3) & 0x3F);
@@ -185,11 +215,9 @@ void MD5Final (
   MD5Update (mdContext, PADDING, padLen);
 
   /* append length in bits and transform */
-  for (i = 0, ii = 0; i < 14; i++, ii += 4)
-    in[i] = (((UINT4)mdContext->in[ii+3]) << 24) |
-            (((UINT4)mdContext->in[ii+2]) << 16) |
-            (((UINT4)mdContext->in[ii+1]) << 8) |
-            ((UINT4)mdContext->in[ii]);
+  Decode (in, mdContext->in);
+  in[14] = bits[0];
+  in[15] = bits[1];
   Transform (mdContext->buf, in);
 
   /* store buffer in digest */
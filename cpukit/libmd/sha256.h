@@ -40,6 +40,8 @@ typedef struct SHA256Context {
 __BEGIN_DECLS
 void	SHA256_Init(SHA256_CTX *);
 void	SHA256_Update(SHA256_CTX *, const void *, size_t);
+void	SHA256_UpdateMulti(SHA256_CTX * const [], const void * const [],
+	    size_t, size_t);
 void	SHA256_Final(unsigned char [32], SHA256_CTX *);
 char   *SHA256_End(SHA256_CTX *, char *);
 char   *SHA256_File(const char *, char *);
@@ -92,16 +92,63 @@ be32dec_vect(uint32_t *dst, const unsigned char *src, size_t len)
 	h  = t0 + t1;
 
 /* Adjusted round function for rotating state */
-#define RNDr(S, W, i, k)			\
+#define RNDr(S, W, i, ii)			\
 	RND(S[(64 - i) % 8], S[(65 - i) % 8],	\
 	    S[(66 - i) % 8], S[(67 - i) % 8],	\
 	    S[(68 - i) % 8], S[(69 - i) % 8],	\
 	    S[(70 - i) % 8], S[(71 - i) % 8],	\
-	    W[i] + k)
+	    W[i + ii] + K[i + ii])
+
+/* Message schedule computation */
+#define MSCH(W, ii, i)				\
+	W[i + ii + 16] = s1(W[i + ii + 14]) + W[i + ii + 9] +	\
+	    s0(W[i + ii + 1]) + W[i + ii]
+
+/* Sixteen rounds and sixteen message schedule words */
+#define RNDr16(S, W, i)				\
+	RNDr(S, W, 0, i); RNDr(S, W, 1, i);	\
+	RNDr(S, W, 2, i); RNDr(S, W, 3, i);	\
+	RNDr(S, W, 4, i); RNDr(S, W, 5, i);	\
+	RNDr(S, W, 6, i); RNDr(S, W, 7, i);	\
+	RNDr(S, W, 8, i); RNDr(S, W, 9, i);	\
+	RNDr(S, W, 10, i); RNDr(S, W, 11, i);	\
+	RNDr(S, W, 12, i); RNDr(S, W, 13, i);	\
+	RNDr(S, W, 14, i); RNDr(S, W, 15, i)
+
+#define MSCH16(W, i)				\
+	MSCH(W, 0, i); MSCH(W, 1, i);		\
+	MSCH(W, 2, i); MSCH(W, 3, i);		\
+	MSCH(W, 4, i); MSCH(W, 5, i);		\
+	MSCH(W, 6, i); MSCH(W, 7, i);		\
+	MSCH(W, 8, i); MSCH(W, 9, i);		\
+	MSCH(W, 10, i); MSCH(W, 11, i);		\
+	MSCH(W, 12, i); MSCH(W, 13, i);		\
+	MSCH(W, 14, i); MSCH(W, 15, i)
+
+static const uint32_t K[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+	0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+	0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+	0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+	0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+	0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
 
 /*
  * SHA256 block compression function.  The 256-bit state is transformed via
- * the 512-bit input block to produce a new state.
+ * the 512-bit input block to produce a new state.  The rounds are unrolled
+ * sixteen at a time and the message schedule is expanded between the groups
+ * of rounds.
  */
 static void
 SHA256_Transform(uint32_t * state, const unsigned char block[64])
@@ -111,112 +158,95 @@ SHA256_Transform(uint32_t * state, const unsigned char block[64])
 	uint32_t t0, t1;
 	int i;
 
-	/* 1. Prepare message schedule W. */
+	/* 1. Prepare the first part of the message schedule W. */
 	be32dec_vect(W, block, 64);
-	for (i = 16; i < 64; i++)
-		W[i] = s1(W[i - 2]) + W[i - 7] + s0(W[i - 15]) + W[i - 16];
 
 	/* 2. Initialize working variables. */
 	memcpy(S, state, 32);
 
 	/* 3. Mix. */
-	RNDr(S, W, 0, 0x428a2f98);
-	RNDr(S, W, 1, 0x71374491);
-	RNDr(S, W, 2, 0xb5c0fbcf);
-	RNDr(S, W, 3, 0xe9b5dba5);
-	RNDr(S, W, 4, 0x3956c25b);
-	RNDr(S, W, 5, 0x59f111f1);
-	RNDr(S, W, 6, 0x923f82a4);
-	RNDr(S, W, 7, 0xab1c5ed5);
-	RNDr(S, W, 8, 0xd807aa98);
-	RNDr(S, W, 9, 0x12835b01);
-	RNDr(S, W, 10, 0x243185be);
-	RNDr(S, W, 11, 0x550c7dc3);
-	RNDr(S, W, 12, 0x72be5d74);
-	RNDr(S, W, 13, 0x80deb1fe);
-	RNDr(S, W, 14, 0x9bdc06a7);
-	RNDr(S, W, 15, 0xc19bf174);
-	RNDr(S, W, 16, 0xe49b69c1);
-	RNDr(S, W, 17, 0xefbe4786);
-	RNDr(S, W, 18, 0x0fc19dc6);
-	RNDr(S, W, 19, 0x240ca1cc);
-	RNDr(S, W, 20, 0x2de92c6f);
-	RNDr(S, W, 21, 0x4a7484aa);
-	RNDr(S, W, 22, 0x5cb0a9dc);
-	RNDr(S, W, 23, 0x76f988da);
-	RNDr(S, W, 24, 0x983e5152);
-	RNDr(S, W, 25, 0xa831c66d);
-	RNDr(S, W, 26, 0xb00327c8);
-	RNDr(S, W, 27, 0xbf597fc7);
-	RNDr(S, W, 28, 0xc6e00bf3);
-	RNDr(S, W, 29, 0xd5a79147);
-	RNDr(S, W, 30, 0x06ca6351);
-	RNDr(S, W, 31, 0x14292967);
-	RNDr(S, W, 32, 0x27b70a85);
-	RNDr(S, W, 33, 0x2e1b2138);
-	RNDr(S, W, 34, 0x4d2c6dfc);
-	RNDr(S, W, 35, 0x53380d13);
-	RNDr(S, W, 36, 0x650a7354);
-	RNDr(S, W, 37, 0x766a0abb);
-	RNDr(S, W, 38, 0x81c2c92e);
-	RNDr(S, W, 39, 0x92722c85);
-	RNDr(S, W, 40, 0xa2bfe8a1);
-	RNDr(S, W, 41, 0xa81a664b);
-	RNDr(S, W, 42, 0xc24b8b70);
-	RNDr(S, W, 43, 0xc76c51a3);
-	RNDr(S, W, 44, 0xd192e819);
-	RNDr(S, W, 45, 0xd6990624);
-	RNDr(S, W, 46, 0xf40e3585);
-	RNDr(S, W, 47, 0x106aa070);
-	RNDr(S, W, 48, 0x19a4c116);
-	RNDr(S, W, 49, 0x1e376c08);
-	RNDr(S, W, 50, 0x2748774c);
-	RNDr(S, W, 51, 0x34b0bcb5);
-	RNDr(S, W, 52, 0x391c0cb3);
-	RNDr(S, W, 53, 0x4ed8aa4a);
-	RNDr(S, W, 54, 0x5b9cca4f);
-	RNDr(S, W, 55, 0x682e6ff3);
-	RNDr(S, W, 56, 0x748f82ee);
-	RNDr(S, W, 57, 0x78a5636f);
-	RNDr(S, W, 58, 0x84c87814);
-	RNDr(S, W, 59, 0x8cc70208);
-	RNDr(S, W, 60, 0x90befffa);
-	RNDr(S, W, 61, 0xa4506ceb);
-	RNDr(S, W, 62, 0xbef9a3f7);
-	RNDr(S, W, 63, 0xc67178f2);
+	for (i = 0; i < 64; i += 16) {
+		RNDr16(S, W, i);
+
+		if (i == 48)
+			break;
+		MSCH16(W, i);
+	}
 
 	/* 4. Mix local working variables into global state */
 	for (i = 0; i < 8; i++)
 		state[i] += S[i];
 }
 
-static const unsigned char PAD[64] = {
-	0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-};
+/*
+ * Compress a block of each of two independent messages.  The rounds of the
+ * two messages are interleaved so a processor able to issue more than one
+ * instruction per cycle can overlap them.
+ */
+static void
+SHA256_Transform2(uint32_t * state0, const unsigned char block0[64],
+    uint32_t * state1, const unsigned char block1[64])
+{
+	uint32_t W[64], V[64];
+	uint32_t S[8], R[8];
+	uint32_t t0, t1;
+	int i;
+
+	be32dec_vect(W, block0, 64);
+	be32dec_vect(V, block1, 64);
 
-/* Add padding and terminating bit-count. */
+	memcpy(S, state0, 32);
+	memcpy(R, state1, 32);
+
+	for (i = 0; i < 64; i += 16) {
+		RNDr16(S, W, i);
+		RNDr16(R, V, i);
+
+		if (i == 48)
+			break;
+		MSCH16(W, i);
+		MSCH16(V, i);
+	}
+
+	for (i = 0; i < 8; i++) {
+		state0[i] += S[i];
+		state1[i] += R[i];
+	}
+}
+
+/*
+ * Add padding and terminating bit-count.  The padding is written straight
+ * into the buffer rather than passed through SHA256_Update() since the short
+ * messages hashed by crypt(3) spend a good part of their time here.
+ */
 static void
 SHA256_Pad(SHA256_CTX * ctx)
 {
-	unsigned char len[8];
-	uint32_t r, plen;
-
-	/*
-	 * Convert length to a vector of bytes -- we do this now rather
-	 * than later because the length will change after we pad.
-	 */
-	be64enc(len, ctx->count);
+	size_t r;
 
-	/* Add 1--64 bytes so that the resulting length is 56 mod 64 */
+	/* Figure out how many bytes we have buffered. */
 	r = (ctx->count >> 3) & 0x3f;
-	plen = (r < 56) ? (56 - r) : (120 - r);
-	SHA256_Update(ctx, PAD, (size_t)plen);
 
-	/* Add the terminating bit-count */
-	SHA256_Update(ctx, len, 8);
+	/* Pad to 56 mod 64, transforming if we finish a block en route. */
+	if (r < 56) {
+		/* Pad to 56 mod 64. */
+		ctx->buf[r] = 0x80;
+		memset(&ctx->buf[r + 1], 0, 55 - r);
+	} else {
+		/* Finish the current block and mix. */
+		ctx->buf[r] = 0x80;
+		memset(&ctx->buf[r + 1], 0, 63 - r);
+		SHA256_Transform(ctx->state, ctx->buf);
+
+		/* The start of the final block is all zeroes. */
+		memset(ctx->buf, 0, 56);
+	}
+
+	/* Add the terminating bit-count. */
+	be64enc(&ctx->buf[56], ctx->count);
+
+	/* Mix in the final block. */
+	SHA256_Transform(ctx->state, ctx->buf);
 }
 
 /* SHA-256 initialization.  Begins a SHA-256 operation. */
@@ -278,6 +308,70 @@ SHA256_Update(SHA256_CTX * ctx, const void *in, size_t len)
 	memcpy(ctx->buf, src, len);
 }
 
+/*
+ * Add the same number of bytes into each of two hashes.  While the two
+ * buffers hold the same number of bytes, which they do for messages of
+ * equal length, the complete blocks are compressed together.
+ */
+static void
+SHA256_Update2(SHA256_CTX * ctx0, const unsigned char *src0,
+    SHA256_CTX * ctx1, const unsigned char *src1, size_t len)
+{
+	uint32_t r;
+
+	/* Number of bytes left in the buffers from previous updates */
+	r = (ctx0->count >> 3) & 0x3f;
+
+	/* Fall back to one at a time if the buffers are out of step */
+	if (r != ((ctx1->count >> 3) & 0x3f) || len < 64 - r) {
+		SHA256_Update(ctx0, src0, len);
+		SHA256_Update(ctx1, src1, len);
+		return;
+	}
+
+	/* Update number of bits */
+	ctx0->count += (uint64_t)len << 3;
+	ctx1->count += (uint64_t)len << 3;
+
+	/* Finish the current blocks */
+	memcpy(&ctx0->buf[r], src0, 64 - r);
+	memcpy(&ctx1->buf[r], src1, 64 - r);
+	SHA256_Transform2(ctx0->state, ctx0->buf, ctx1->state, ctx1->buf);
+	src0 += 64 - r;
+	src1 += 64 - r;
+	len -= 64 - r;
+
+	/* Perform complete blocks */
+	while (len >= 64) {
+		SHA256_Transform2(ctx0->state, src0, ctx1->state, src1);
+		src0 += 64;
+		src1 += 64;
+		len -= 64;
+	}
+
+	/* Copy left over data into buffers */
+	memcpy(ctx0->buf, src0, len);
+	memcpy(ctx1->buf, src1, len);
+}
+
+/*
+ * Add len bytes from each of in[0] to in[n - 1] into the hashes ctx[0] to
+ * ctx[n - 1].  The result is the same as n calls of SHA256_Update() but the
+ * messages are hashed in pairs with their rounds interleaved.
+ */
+void
+SHA256_UpdateMulti(SHA256_CTX * const ctx[], const void * const in[],
+    size_t n, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i + 1 < n; i += 2)
+		SHA256_Update2(ctx[i], in[i], ctx[i + 1], in[i + 1], len);
+
+	if (i < n)
+		SHA256_Update(ctx[i], in[i], len);
+}
+
 /*
  * SHA-256 finalization.  Pads the input data, exports the hash value,
  * and clears the context state.
@@ -40,6 +40,8 @@ typedef struct SHA512Context {
 __BEGIN_DECLS
 void	SHA512_Init(SHA512_CTX *);
 void	SHA512_Update(SHA512_CTX *, const void *, size_t);
+void	SHA512_UpdateMulti(SHA512_CTX * const [], const void * const [],
+	    size_t, size_t);
 void	SHA512_Final(unsigned char [64], SHA512_CTX *);
 char   *SHA512_End(SHA512_CTX *, char *);
 char   *SHA512_File(const char *, char *);
@@ -92,16 +92,87 @@ be64dec_vect(uint64_t *dst, const unsigned char *src, size_t len)
 	h  = t0 + t1;
 
 /* Adjusted round function for rotating state */
-#define RNDr(S, W, i, k)			\
+#define RNDr(S, W, i, ii)			\
 	RND(S[(80 - i) % 8], S[(81 - i) % 8],	\
 	    S[(82 - i) % 8], S[(83 - i) % 8],	\
 	    S[(84 - i) % 8], S[(85 - i) % 8],	\
 	    S[(86 - i) % 8], S[(87 - i) % 8],	\
-	    W[i] + k)
+	    W[i + ii] + K[i + ii])
+
+/* Message schedule computation */
+#define MSCH(W, ii, i)				\
+	W[i + ii + 16] = s1(W[i + ii + 14]) + W[i + ii + 9] +	\
+	    s0(W[i + ii + 1]) + W[i + ii]
+
+/* Sixteen rounds and sixteen message schedule words */
+#define RNDr16(S, W, i)				\
+	RNDr(S, W, 0, i); RNDr(S, W, 1, i);	\
+	RNDr(S, W, 2, i); RNDr(S, W, 3, i);	\
+	RNDr(S, W, 4, i); RNDr(S, W, 5, i);	\
+	RNDr(S, W, 6, i); RNDr(S, W, 7, i);	\
+	RNDr(S, W, 8, i); RNDr(S, W, 9, i);	\
+	RNDr(S, W, 10, i); RNDr(S, W, 11, i);	\
+	RNDr(S, W, 12, i); RNDr(S, W, 13, i);	\
+	RNDr(S, W, 14, i); RNDr(S, W, 15, i)
+
+#define MSCH16(W, i)				\
+	MSCH(W, 0, i); MSCH(W, 1, i);		\
+	MSCH(W, 2, i); MSCH(W, 3, i);		\
+	MSCH(W, 4, i); MSCH(W, 5, i);		\
+	MSCH(W, 6, i); MSCH(W, 7, i);		\
+	MSCH(W, 8, i); MSCH(W, 9, i);		\
+	MSCH(W, 10, i); MSCH(W, 11, i);		\
+	MSCH(W, 12, i); MSCH(W, 13, i);		\
+	MSCH(W, 14, i); MSCH(W, 15, i)
+
+static const uint64_t K[80] = {
+	0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL,
+	0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+	0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL,
+	0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+	0xd807aa98a3030242ULL, 0x12835b0145706fbeULL,
+	0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+	0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL,
+	0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+	0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL,
+	0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+	0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL,
+	0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+	0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL,
+	0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+	0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL,
+	0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+	0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL,
+	0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+	0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL,
+	0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+	0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL,
+	0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+	0xd192e819d6ef5218ULL, 0xd69906245565a910ULL,
+	0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+	0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL,
+	0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+	0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL,
+	0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+	0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL,
+	0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+	0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL,
+	0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+	0xca273eceea26619cULL, 0xd186b8c721c0c207ULL,
+	0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+	0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL,
+	0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+	0x28db77f523047d84ULL, 0x32caab7b40c72493ULL,
+	0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+	0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL,
+	0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
 
 /*
  * SHA512 block compression function.  The 512-bit state is transformed via
- * the 512-bit input block to produce a new state.
+ * the 1024-bit input block to produce a new state.  The rounds are unrolled
+ * sixteen at a time and the message schedule is expanded between the groups
+ * of rounds.
  */
 static void
 SHA512_Transform(uint64_t * state, const unsigned char block[128])
@@ -111,132 +182,95 @@ SHA512_Transform(uint64_t * state, const unsigned char block[128])
 	uint64_t t0, t1;
 	int i;
 
-	/* 1. Prepare message schedule W. */
+	/* 1. Prepare the first part of the message schedule W. */
 	be64dec_vect(W, block, 128);
-	for (i = 16; i < 80; i++)
-		W[i] = s1(W[i - 2]) + W[i - 7] + s0(W[i - 15]) + W[i - 16];
 
 	/* 2. Initialize working variables. */
 	memcpy(S, state, 64);
 
 	/* 3. Mix. */
-	RNDr(S, W, 0, 0x428a2f98d728ae22ULL);
-	RNDr(S, W, 1, 0x7137449123ef65cdULL);
-	RNDr(S, W, 2, 0xb5c0fbcfec4d3b2fULL);
-	RNDr(S, W, 3, 0xe9b5dba58189dbbcULL);
-	RNDr(S, W, 4, 0x3956c25bf348b538ULL);
-	RNDr(S, W, 5, 0x59f111f1b605d019ULL);
-	RNDr(S, W, 6, 0x923f82a4af194f9bULL);
-	RNDr(S, W, 7, 0xab1c5ed5da6d8118ULL);
-	RNDr(S, W, 8, 0xd807aa98a3030242ULL);
-	RNDr(S, W, 9, 0x12835b0145706fbeULL);
-	RNDr(S, W, 10, 0x243185be4ee4b28cULL);
-	RNDr(S, W, 11, 0x550c7dc3d5ffb4e2ULL);
-	RNDr(S, W, 12, 0x72be5d74f27b896fULL);
-	RNDr(S, W, 13, 0x80deb1fe3b1696b1ULL);
-	RNDr(S, W, 14, 0x9bdc06a725c71235ULL);
-	RNDr(S, W, 15, 0xc19bf174cf692694ULL);
-	RNDr(S, W, 16, 0xe49b69c19ef14ad2ULL);
-	RNDr(S, W, 17, 0xefbe4786384f25e3ULL);
-	RNDr(S, W, 18, 0x0fc19dc68b8cd5b5ULL);
-	RNDr(S, W, 19, 0x240ca1cc77ac9c65ULL);
-	RNDr(S, W, 20, 0x2de92c6f592b0275ULL);
-	RNDr(S, W, 21, 0x4a7484aa6ea6e483ULL);
-	RNDr(S, W, 22, 0x5cb0a9dcbd41fbd4ULL);
-	RNDr(S, W, 23, 0x76f988da831153b5ULL);
-	RNDr(S, W, 24, 0x983e5152ee66dfabULL);
-	RNDr(S, W, 25, 0xa831c66d2db43210ULL);
-	RNDr(S, W, 26, 0xb00327c898fb213fULL);
-	RNDr(S, W, 27, 0xbf597fc7beef0ee4ULL);
-	RNDr(S, W, 28, 0xc6e00bf33da88fc2ULL);
-	RNDr(S, W, 29, 0xd5a79147930aa725ULL);
-	RNDr(S, W, 30, 0x06ca6351e003826fULL);
-	RNDr(S, W, 31, 0x142929670a0e6e70ULL);
-	RNDr(S, W, 32, 0x27b70a8546d22ffcULL);
-	RNDr(S, W, 33, 0x2e1b21385c26c926ULL);
-	RNDr(S, W, 34, 0x4d2c6dfc5ac42aedULL);
-	RNDr(S, W, 35, 0x53380d139d95b3dfULL);
-	RNDr(S, W, 36, 0x650a73548baf63deULL);
-	RNDr(S, W, 37, 0x766a0abb3c77b2a8ULL);
-	RNDr(S, W, 38, 0x81c2c92e47edaee6ULL);
-	RNDr(S, W, 39, 0x92722c851482353bULL);
-	RNDr(S, W, 40, 0xa2bfe8a14cf10364ULL);
-	RNDr(S, W, 41, 0xa81a664bbc423001ULL);
-	RNDr(S, W, 42, 0xc24b8b70d0f89791ULL);
-	RNDr(S, W, 43, 0xc76c51a30654be30ULL);
-	RNDr(S, W, 44, 0xd192e819d6ef5218ULL);
-	RNDr(S, W, 45, 0xd69906245565a910ULL);
-	RNDr(S, W, 46, 0xf40e35855771202aULL);
-	RNDr(S, W, 47, 0x106aa07032bbd1b8ULL);
-	RNDr(S, W, 48, 0x19a4c116b8d2d0c8ULL);
-	RNDr(S, W, 49, 0x1e376c085141ab53ULL);
-	RNDr(S, W, 50, 0x2748774cdf8eeb99ULL);
-	RNDr(S, W, 51, 0x34b0bcb5e19b48a8ULL);
-	RNDr(S, W, 52, 0x391c0cb3c5c95a63ULL);
-	RNDr(S, W, 53, 0x4ed8aa4ae3418acbULL);
-	RNDr(S, W, 54, 0x5b9cca4f7763e373ULL);
-	RNDr(S, W, 55, 0x682e6ff3d6b2b8a3ULL);
-	RNDr(S, W, 56, 0x748f82ee5defb2fcULL);
-	RNDr(S, W, 57, 0x78a5636f43172f60ULL);
-	RNDr(S, W, 58, 0x84c87814a1f0ab72ULL);
-	RNDr(S, W, 59, 0x8cc702081a6439ecULL);
-	RNDr(S, W, 60, 0x90befffa23631e28ULL);
-	RNDr(S, W, 61, 0xa4506cebde82bde9ULL);
-	RNDr(S, W, 62, 0xbef9a3f7b2c67915ULL);
-	RNDr(S, W, 63, 0xc67178f2e372532bULL);
-	RNDr(S, W, 64, 0xca273eceea26619cULL);
-	RNDr(S, W, 65, 0xd186b8c721c0c207ULL);
-	RNDr(S, W, 66, 0xeada7dd6cde0eb1eULL);
-	RNDr(S, W, 67, 0xf57d4f7fee6ed178ULL);
-	RNDr(S, W, 68, 0x06f067aa72176fbaULL);
-	RNDr(S, W, 69, 0x0a637dc5a2c898a6ULL);
-	RNDr(S, W, 70, 0x113f9804bef90daeULL);
-	RNDr(S, W, 71, 0x1b710b35131c471bULL);
-	RNDr(S, W, 72, 0x28db77f523047d84ULL);
-	RNDr(S, W, 73, 0x32caab7b40c72493ULL);
-	RNDr(S, W, 74, 0x3c9ebe0a15c9bebcULL);
-	RNDr(S, W, 75, 0x431d67c49c100d4cULL);
-	RNDr(S, W, 76, 0x4cc5d4becb3e42b6ULL);
-	RNDr(S, W, 77, 0x597f299cfc657e2aULL);
-	RNDr(S, W, 78, 0x5fcb6fab3ad6faecULL);
-	RNDr(S, W, 79, 0x6c44198c4a475817ULL);
+	for (i = 0; i < 80; i += 16) {
+		RNDr16(S, W, i);
+
+		if (i == 64)
+			break;
+		MSCH16(W, i);
+	}
 
 	/* 4. Mix local working variables into global state */
 	for (i = 0; i < 8; i++)
 		state[i] += S[i];
 }
 
-static const unsigned char PAD[128] = {
-	0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-};
+/*
+ * Compress a block of each of two independent messages.  The rounds of the
+ * two messages are interleaved so a processor able to issue more than one
+ * instruction per cycle can overlap them.
+ */
+static void
+SHA512_Transform2(uint64_t * state0, const unsigned char block0[128],
+    uint64_t * state1, const unsigned char block1[128])
+{
+	uint64_t W[80], V[80];
+	uint64_t S[8], R[8];
+	uint64_t t0, t1;
+	int i;
 
-/* Add padding and terminating bit-count. */
+	be64dec_vect(W, block0, 128);
+	be64dec_vect(V, block1, 128);
+
+	memcpy(S, state0, 64);
+	memcpy(R, state1, 64);
+
+	for (i = 0; i < 80; i += 16) {
+		RNDr16(S, W, i);
+		RNDr16(R, V, i);
+
+		if (i == 64)
+			break;
+		MSCH16(W, i);
+		MSCH16(V, i);
+	}
+
+	for (i = 0; i < 8; i++) {
+		state0[i] += S[i];
+		state1[i] += R[i];
+	}
+}
+
+/*
+ * Add padding and terminating bit-count.  The padding is written straight
+ * into the buffer rather than passed through SHA512_Update() since the short
+ * messages hashed by crypt(3) spend a good part of their time here.
+ */
 static void
 SHA512_Pad(SHA512_CTX * ctx)
 {
-	unsigned char len[16];
-	uint64_t r, plen;
-
-	/*
-	 * Convert length to a vector of bytes -- we do this now rather
-	 * than later because the length will change after we pad.
-	 */
-	be64enc_vect(len, ctx->count, 16);
+	size_t r;
 
-	/* Add 1--128 bytes so that the resulting length is 112 mod 128 */
+	/* Figure out how many bytes we have buffered. */
 	r = (ctx->count[1] >> 3) & 0x7f;
-	plen = (r < 112) ? (112 - r) : (240 - r);
-	SHA512_Update(ctx, PAD, (size_t)plen);
 
-	/* Add the terminating bit-count */
-	SHA512_Update(ctx, len, 16);
+	/* Pad to 112 mod 128, transforming if we finish a block en route. */
+	if (r < 112) {
+		/* Pad to 112 mod 128. */
+		ctx->buf[r] = 0x80;
+		memset(&ctx->buf[r + 1], 0, 111 - r);
+	} else {
+		/* Finish the current block and mix. */
+		ctx->buf[r] = 0x80;
+		memset(&ctx->buf[r + 1], 0, 127 - r);
+		SHA512_Transform(ctx->state, ctx->buf);
+
+		/* The start of the final block is all zeroes. */
+		memset(ctx->buf, 0, 112);
+	}
+
+	/* Add the terminating bit-count. */
+	be64enc_vect(&ctx->buf[112], ctx->count, 16);
+
+	/* Mix in the final block. */
+	SHA512_Transform(ctx->state, ctx->buf);
 }
 
 /* SHA-512 initialization.  Begins a SHA-512 operation. */
@@ -258,16 +292,11 @@ SHA512_Init(SHA512_CTX * ctx)
 	ctx->state[7] = 0x5be0cd19137e2179ULL;
 }
 
-/* Add bytes into the hash */
-void
-SHA512_Update(SHA512_CTX * ctx, const void *in, size_t len)
+/* Add len bytes to the 128-bit count of bits processed */
+static void
+SHA512_Count(SHA512_CTX * ctx, size_t len)
 {
 	uint64_t bitlen[2];
-	uint64_t r;
-	const unsigned char *src = in;
-
-	/* Number of bytes left in the buffer from previous updates */
-	r = (ctx->count[1] >> 3) & 0x7f;
 
 	/* Convert the length into a number of bits */
 	bitlen[1] = ((uint64_t)len) << 3;
@@ -277,6 +306,20 @@ SHA512_Update(SHA512_CTX * ctx, const void *in, size_t len)
 	if ((ctx->count[1] += bitlen[1]) < bitlen[1])
 		ctx->count[0]++;
 	ctx->count[0] += bitlen[0];
+}
+
+/* Add bytes into the hash */
+void
+SHA512_Update(SHA512_CTX * ctx, const void *in, size_t len)
+{
+	uint64_t r;
+	const unsigned char *src = in;
+
+	/* Number of bytes left in the buffer from previous updates */
+	r = (ctx->count[1] >> 3) & 0x7f;
+
+	/* Update number of bits */
+	SHA512_Count(ctx, len);
 
 	/* Handle the case where we don't need to perform any transforms */
 	if (len < 128 - r) {
@@ -301,6 +344,70 @@ SHA512_Update(SHA512_CTX * ctx, const void *in, size_t len)
 	memcpy(ctx->buf, src, len);
 }
 
+/*
+ * Add the same number of bytes into each of two hashes.  While the two
+ * buffers hold the same number of bytes, which they do for messages of
+ * equal length, the complete blocks are compressed together.
+ */
+static void
+SHA512_Update2(SHA512_CTX * ctx0, const unsigned char *src0,
+    SHA512_CTX * ctx1, const unsigned char *src1, size_t len)
+{
+	uint64_t r;
+
+	/* Number of bytes left in the buffers from previous updates */
+	r = (ctx0->count[1] >> 3) & 0x7f;
+
+	/* Fall back to one at a time if the buffers are out of step */
+	if (r != ((ctx1->count[1] >> 3) & 0x7f) || len < 128 - r) {
+		SHA512_Update(ctx0, src0, len);
+		SHA512_Update(ctx1, src1, len);
+		return;
+	}
+
+	/* Update number of bits */
+	SHA512_Count(ctx0, len);
+	SHA512_Count(ctx1, len);
+
+	/* Finish the current blocks */
+	memcpy(&ctx0->buf[r], src0, 128 - r);
+	memcpy(&ctx1->buf[r], src1, 128 - r);
+	SHA512_Transform2(ctx0->state, ctx0->buf, ctx1->state, ctx1->buf);
+	src0 += 128 - r;
+	src1 += 128 - r;
+	len -= 128 - r;
+
+	/* Perform complete blocks */
+	while (len >= 128) {
+		SHA512_Transform2(ctx0->state, src0, ctx1->state, src1);
+		src0 += 128;
+		src1 += 128;
+		len -= 128;
+	}
+
+	/* Copy left over data into buffers */
+	memcpy(ctx0->buf, src0, len);
+	memcpy(ctx1->buf, src1, len);
+}
+
+/*
+ * Add len bytes from each of in[0] to in[n - 1] into the hashes ctx[0] to
+ * ctx[n - 1].  The result is the same as n calls of SHA512_Update() but the
+ * messages are hashed in pairs with their rounds interleaved.
+ */
+void
+SHA512_UpdateMulti(SHA512_CTX * const ctx[], const void * const in[],
+    size_t n, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i + 1 < n; i += 2)
+		SHA512_Update2(ctx[i], in[i], ctx[i + 1], in[i + 1], len);
+
+	if (i < n)
+		SHA512_Update(ctx[i], in[i], len);
+}
+
 /*
  * SHA-512 finalization.  Pads the input data, exports the hash value,
  * and clears the context state.
@@ -26,10 +26,15 @@
 #endif
 
 #include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <inttypes.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include <rtems.h>
 #include <rtems/capture-cli.h>
@@ -58,7 +63,7 @@ static rtems_capture_timestamp capture_timestamp;
  * capture buffer.
  */
 
-static const char* open_usage = "usage: copen [-i] size\n";
+static const char* open_usage = "usage: copen [-i] [-o] size\n";
 
 static void
 rtems_capture_cli_open (int                                argc,
@@ -68,6 +73,7 @@ rtems_capture_cli_open (int                                argc,
 {
   uint32_t          size = 0;
   bool              enable = false;
+  bool              overwrite = false;
   rtems_status_code sc;
   int               arg;
 
@@ -83,6 +89,8 @@ rtems_capture_cli_open (int                                argc,
     {
       if (argv[arg][1] == 'i')
         enable = true;
+      else if (argv[arg][1] == 'o')
+        overwrite = true;
       else
         fprintf (stdout, "warning: option -%c ignored\n", argv[arg][1]);
     }
@@ -108,6 +116,17 @@ rtems_capture_cli_open (int                                argc,
 
   fprintf (stdout, "capture engine opened.\n");
 
+  if (overwrite)
+  {
+    sc = rtems_capture_overwrite (true);
+
+    if (sc != RTEMS_SUCCESSFUL)
+    {
+      fprintf (stdout, "error: open overwrite failed: %s\n", rtems_status_text (sc));
+      return;
+    }
+  }
+
   if (!enable)
     return;
 
@@ -1036,11 +1055,94 @@ rtems_capture_cli_flush (int                                argc,
            prime ? "primed" : "not primed");
 }
 
+/*
+ * rtems_capture_cli_ctf_export
+ *
+ * This function is a monitor command that exports the trace records to a
+ * CTF trace directory. The records are released once written.
+ */
+
+static const char* ctf_export_usage = "usage: cctf path\n";
+
+static void
+rtems_capture_cli_ctf_export (int                                argc,
+                              char**                             argv,
+                              const rtems_monitor_command_arg_t* command_arg RC_UNUSED,
+                              bool                               verbose RC_UNUSED)
+{
+  rtems_status_code sc;
+  char              name[PATH_MAX];
+  uint32_t          cpu;
+  uint32_t          total = 0;
+  uint32_t          total_dropped = 0;
+  int               fd;
+
+  if (argc != 2)
+  {
+    fprintf (stdout, ctf_export_usage);
+    return;
+  }
+
+  if (mkdir (argv[1], S_IRWXU | S_IRWXG | S_IRWXO) != 0 && errno != EEXIST)
+  {
+    fprintf (stdout, "error: cannot create directory: %s\n", strerror (errno));
+    return;
+  }
+
+  snprintf (name, sizeof (name), "%s/metadata", argv[1]);
+  fd = open (name, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  if (fd < 0)
+  {
+    fprintf (stdout, "error: cannot open %s: %s\n", name, strerror (errno));
+    return;
+  }
+
+  sc = rtems_capture_ctf_write_metadata (fd);
+  close (fd);
+
+  if (sc != RTEMS_SUCCESSFUL)
+  {
+    fprintf (stdout, "error: metadata write failed: %s\n", rtems_status_text (sc));
+    return;
+  }
+
+  for (cpu = 0; cpu < rtems_get_processor_count (); cpu++)
+  {
+    uint32_t written;
+    uint32_t dropped;
+
+    snprintf (name, sizeof (name), "%s/stream_%" PRIu32, argv[1], cpu);
+    fd = open (name, O_WRONLY | O_CREAT | O_APPEND, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+      fprintf (stdout, "error: cannot open %s: %s\n", name, strerror (errno));
+      return;
+    }
+
+    sc = rtems_capture_ctf_write_packets (fd, cpu, &written, &dropped);
+    close (fd);
+
+    if (sc != RTEMS_SUCCESSFUL)
+    {
+      fprintf (stdout, "error: stream write failed: %s\n", rtems_status_text (sc));
+      return;
+    }
+
+    total += written;
+    total_dropped += dropped;
+  }
+
+  fprintf (stdout, "%" PRIu32 " records exported.\n", total);
+  if (total_dropped != 0)
+    fprintf (stdout, "%" PRIu32 " records too large for a CTF packet dropped.\n",
+             total_dropped);
+}
+
 static rtems_monitor_command_entry_t rtems_capture_cli_cmds[] =
 {
   {
     "copen",
-    "usage: copen [-i] size\n",
+    "usage: copen [-i] [-o] size\n",
     0,
     rtems_capture_cli_open,
     { 0 },
@@ -1165,6 +1267,14 @@ static rtems_monitor_command_entry_t rtems_capture_cli_cmds[] =
     rtems_capture_cli_flush,
     { 0 },
     0
+  },
+  {
+    "cctf",
+    "usage: cctf path\n",
+    0,
+    rtems_capture_cli_ctf_export,
+    { 0 },
+    0
   }
 };
 
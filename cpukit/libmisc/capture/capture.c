@@ -59,12 +59,17 @@
 #define RTEMS_CAPTURE_RECORD_EVENTS  (0)
 #endif
 
+/*
+ * The records are written by the owning processor with interrupts disabled
+ * and read by at most one reader at a time without a lock.  See
+ * capture_buffer.h.
+ */
 typedef struct {
   rtems_capture_buffer_t   records;
-  uint32_t                 count;
+  Atomic_Uint              count;
   rtems_id                 reader;
-  rtems_interrupt_lock     lock;
-  uint32_t                 flags;
+  Atomic_Uint              flags;
+  Atomic_Uint              dropped;
 } rtems_capture_per_cpu_data;
 
 typedef struct {
@@ -93,11 +98,8 @@ static rtems_capture_global_data capture_global = {
 #define capture_count_on_cpu( _cpu )   capture_per_cpu[ _cpu ].count
 #define capture_flags_on_cpu( _cpu )   capture_per_cpu[ _cpu ].flags
 #define capture_reader_on_cpu( _cpu )  capture_per_cpu[ _cpu ].reader
-#define capture_lock_on_cpu( _cpu )    capture_per_cpu[ _cpu ].lock
 
 #define capture_records          capture_records_on_cpu( _SMP_Get_current_processor() )
-#define capture_count            capture_count_on_cpu(  _SMP_Get_current_processor() )
-#define capture_flags_per_cpu    capture_flags_on_cpu( _SMP_Get_current_processor() )
 #define capture_flags_global     capture_global.flags
 #define capture_controls         capture_global.controls
 #define capture_extension_index  capture_global.extension_index
@@ -105,7 +107,6 @@ static rtems_capture_global_data capture_global = {
 #define capture_ceiling          capture_global.ceiling
 #define capture_floor            capture_global.floor
 #define capture_reader           capture_reader_on_cpu(  _SMP_Get_current_processor() )
-#define capture_lock_per_cpu     capture_lock_on_cpu( _SMP_Get_current_processor() )
 #define capture_lock_global      capture_global.lock
 
 /*
@@ -446,25 +447,172 @@ bool rtems_capture_filter( rtems_tcb*            tcb,
   return true;
 }
 
+static inline uint32_t rtems_capture_count_records( void* recs, size_t size )
+{
+  rtems_capture_record_t* rec;
+  uint8_t*                ptr = recs;
+  uint32_t                rec_count = 0;
+  size_t                  byte_count = 0;
+
+
+ while (byte_count < size) {
+    rec = (rtems_capture_record_t*) ptr;
+    rec_count++;
+    _Assert( rec->size >= sizeof(*rec) );
+    ptr += rec->size;
+    byte_count += rec->size;
+ };
+
+ return rec_count;
+}
+
+/*
+ * This function claims the reader role of the per-CPU records.  The role is
+ * held by rtems_capture_read() until rtems_capture_release() and for a short
+ * time by the owning processor in overwrite mode.
+ */
+static bool
+rtems_capture_claim_reader (rtems_capture_per_cpu_data* per_cpu,
+                            uint32_t                    role,
+                            uint32_t*                   flags)
+{
+  unsigned int expected;
+
+  expected = _Atomic_Load_uint (&per_cpu->flags, ATOMIC_ORDER_RELAXED);
+
+  do {
+    if ((expected & RTEMS_CAPTURE_READER_ACTIVE) != 0)
+    {
+      *flags = expected;
+      return false;
+    }
+  } while (!_Atomic_Compare_exchange_uint (&per_cpu->flags,
+                                           &expected,
+                                           expected | role,
+                                           ATOMIC_ORDER_ACQUIRE,
+                                           ATOMIC_ORDER_RELAXED));
+
+  *flags = expected | role;
+  return true;
+}
+
+static void
+rtems_capture_release_reader (rtems_capture_per_cpu_data* per_cpu)
+{
+  _Atomic_Fetch_and_uint (&per_cpu->flags,
+                          ~(RTEMS_CAPTURE_READER_ACTIVE | RTEMS_CAPTURE_RECLAIM),
+                          ATOMIC_ORDER_RELEASE);
+}
+
+/*
+ * This function claims the reader role for rtems_capture_read() and
+ * rtems_capture_flush().  It waits while the owning processor reclaims
+ * space in overwrite mode and fails if another reader holds the role.
+ */
+static bool
+rtems_capture_acquire_reader (rtems_capture_per_cpu_data* per_cpu)
+{
+  uint32_t flags;
+
+  while (!rtems_capture_claim_reader (per_cpu,
+                                      RTEMS_CAPTURE_READER_ACTIVE,
+                                      &flags))
+  {
+    if ((flags & RTEMS_CAPTURE_RECLAIM) == 0)
+      return false;
+  }
+
+  return true;
+}
+
+/*
+ * This function discards all records made visible by the owning processor.
+ * It acts as the reader, so a record which is currently added on another
+ * processor stays intact.
+ */
+static void
+rtems_capture_discard_records (rtems_capture_per_cpu_data* per_cpu)
+{
+  void*  recs;
+  size_t recs_size;
+
+  if (per_cpu->records.buffer == NULL)
+    return;
+
+  while ((recs = rtems_capture_buffer_peek (&per_cpu->records,
+                                            &recs_size)) != NULL)
+  {
+    _Atomic_Fetch_sub_uint (&per_cpu->count,
+                            rtems_capture_count_records (recs, recs_size),
+                            ATOMIC_ORDER_RELAXED);
+    rtems_capture_buffer_free (&per_cpu->records, recs_size);
+  }
+}
+
+/*
+ * This function discards the oldest records until the new record fits into
+ * the buffer.  It is only used in overwrite mode and gives up if a reader
+ * currently holds records.
+ */
+static void *
+rtems_capture_record_overwrite (rtems_capture_per_cpu_data* per_cpu,
+                                size_t                      size)
+{
+  rtems_capture_buffer_t* records = &per_cpu->records;
+  void*                   ptr = NULL;
+  uint32_t                flags;
+
+  if (!rtems_capture_claim_reader (per_cpu,
+                                   RTEMS_CAPTURE_READER_ACTIVE |
+                                     RTEMS_CAPTURE_RECLAIM,
+                                   &flags))
+    return NULL;
+
+  do {
+    rtems_capture_record_t* rec;
+    size_t                  rec_size;
+
+    rec = rtems_capture_buffer_peek (records, &rec_size);
+    if (rec == NULL)
+      break;
+
+    rtems_capture_buffer_free (records, rec->size);
+    _Atomic_Fetch_sub_uint (&per_cpu->count, 1, ATOMIC_ORDER_RELAXED);
+    _Atomic_Fetch_add_uint (&per_cpu->dropped, 1, ATOMIC_ORDER_RELAXED);
+
+    ptr = rtems_capture_buffer_allocate (records, size);
+  } while (ptr == NULL);
+
+  rtems_capture_release_reader (per_cpu);
+
+  return ptr;
+}
+
 /*
  * This function records a capture record into the capture buffer.
  */
 void *
-rtems_capture_record_open (rtems_tcb*                    tcb,
-                           uint32_t                      events,
-                           size_t                        size,
-                           rtems_interrupt_lock_context* lock_context)
+rtems_capture_record_open (rtems_tcb*             tcb,
+                           uint32_t               events,
+                           size_t                 size,
+                           rtems_interrupt_level* level)
 {
+  rtems_capture_per_cpu_data*  per_cpu;
   uint8_t*                     ptr;
   rtems_capture_record_t*      capture_in;
 
-  rtems_interrupt_lock_acquire (&capture_lock_per_cpu, lock_context);
+  rtems_interrupt_local_disable (*level);
+
+  per_cpu = capture_per_cpu_get (_SMP_Get_current_processor ());
+
+  ptr = rtems_capture_buffer_allocate (&per_cpu->records, size);
+  if (ptr == NULL && (capture_flags_global & RTEMS_CAPTURE_OVERWRITE) != 0)
+    ptr = rtems_capture_record_overwrite (per_cpu, size);
 
-  ptr = rtems_capture_buffer_allocate(&capture_records, size);
   capture_in = (rtems_capture_record_t *) ptr;
   if ( capture_in )
   {
-    capture_count++;
+    _Atomic_Fetch_add_uint (&per_cpu->count, 1, ATOMIC_ORDER_RELAXED);
     capture_in->size    = size;
     capture_in->task_id = tcb->Object.id;
     capture_in->events  = (events |
@@ -479,14 +627,19 @@ rtems_capture_record_open (rtems_tcb*                    tcb,
     ptr = ptr + sizeof(*capture_in);
   }
   else
-    capture_flags_per_cpu |= RTEMS_CAPTURE_OVERFLOW;
+  {
+    _Atomic_Fetch_or_uint (&per_cpu->flags, RTEMS_CAPTURE_OVERFLOW,
+                           ATOMIC_ORDER_RELAXED);
+    _Atomic_Fetch_add_uint (&per_cpu->dropped, 1, ATOMIC_ORDER_RELAXED);
+  }
 
   return ptr;
 }
 
-void rtems_capture_record_close( void *rec, rtems_interrupt_lock_context* lock_context)
+void rtems_capture_record_close( void *rec, rtems_interrupt_level* level)
 {
-  rtems_interrupt_lock_release (&capture_lock_per_cpu, lock_context);
+  rtems_capture_buffer_commit (&capture_records);
+  rtems_interrupt_local_enable (*level);
 }
 
 /*
@@ -591,10 +744,9 @@ rtems_capture_open (uint32_t   size, rtems_capture_timestamp timestamp __attribu
       break;
     }
 
-    rtems_interrupt_lock_initialize(
-      &capture_lock_on_cpu( i ),
-      "Capture Per-CPU"
-    );
+    _Atomic_Init_uint( &capture_count_on_cpu( i ), 0 );
+    _Atomic_Init_uint( &capture_flags_on_cpu( i ), 0 );
+    _Atomic_Init_uint( &capture_per_cpu_get( i )->dropped, 0 );
   }
 
   capture_flags_global   = 0;
@@ -641,7 +793,8 @@ rtems_capture_close (void)
   }
 
   capture_flags_global &=
-    ~(RTEMS_CAPTURE_ON | RTEMS_CAPTURE_ONLY_MONITOR | RTEMS_CAPTURE_INIT);
+    ~(RTEMS_CAPTURE_ON | RTEMS_CAPTURE_ONLY_MONITOR | RTEMS_CAPTURE_OVERWRITE |
+      RTEMS_CAPTURE_INIT);
 
   rtems_interrupt_lock_release (&capture_lock_global, &lock_context);
 
@@ -668,8 +821,6 @@ rtems_capture_close (void)
   for (cpu=0; cpu < rtems_get_processor_count(); cpu++) {
     if (capture_records_on_cpu(cpu).buffer)
       rtems_capture_buffer_destroy( &capture_records_on_cpu(cpu) );
-
-    rtems_interrupt_lock_destroy( &capture_lock_on_cpu( cpu ) );
   }
 
   free( capture_per_cpu );
@@ -729,6 +880,34 @@ rtems_capture_monitor (bool enable)
   return RTEMS_SUCCESSFUL;
 }
 
+/*
+ * This function enables the overwrite mode. When in the overwrite mode the
+ * oldest records are discarded to make room for new records if the buffer
+ * of a processor is full.
+ */
+rtems_status_code
+rtems_capture_overwrite (bool enable)
+{
+  rtems_interrupt_lock_context lock_context;
+
+  rtems_interrupt_lock_acquire (&capture_lock_global, &lock_context);
+
+  if ((capture_flags_global & RTEMS_CAPTURE_INIT) != RTEMS_CAPTURE_INIT)
+  {
+    rtems_interrupt_lock_release (&capture_lock_global, &lock_context);
+    return RTEMS_UNSATISFIED;
+  }
+
+  if (enable)
+    capture_flags_global |= RTEMS_CAPTURE_OVERWRITE;
+  else
+    capture_flags_global &= ~RTEMS_CAPTURE_OVERWRITE;
+
+  rtems_interrupt_lock_release (&capture_lock_global, &lock_context);
+
+  return RTEMS_SUCCESSFUL;
+}
+
 /*
  * This function clears the capture trace flag in the tcb.
  */
@@ -746,6 +925,7 @@ rtems_status_code
 rtems_capture_flush (bool prime)
 {
   rtems_interrupt_lock_context lock_context_global;
+  uint32_t                     cpu_count = rtems_get_processor_count ();
   uint32_t                     cpu;
 
   rtems_interrupt_lock_acquire (&capture_lock_global, &lock_context_global);
@@ -756,6 +936,21 @@ rtems_capture_flush (bool prime)
     return RTEMS_UNSATISFIED;
   }
 
+  /*
+   * Claim the reader role of all processors first, so a flush either
+   * discards the records of all processors or of none.
+   */
+  for (cpu = 0; cpu < cpu_count; cpu++) {
+    if (!rtems_capture_acquire_reader (capture_per_cpu_get (cpu)))
+    {
+      while (cpu-- > 0)
+        rtems_capture_release_reader (capture_per_cpu_get (cpu));
+
+      rtems_interrupt_lock_release (&capture_lock_global, &lock_context_global);
+      return RTEMS_RESOURCE_IN_USE;
+    }
+  }
+
   rtems_iterate_over_all_threads (rtems_capture_flush_tcb);
 
   if (prime)
@@ -763,15 +958,15 @@ rtems_capture_flush (bool prime)
   else
     capture_flags_global &= ~RTEMS_CAPTURE_OVERFLOW;
 
-  for (cpu=0; cpu < rtems_get_processor_count(); cpu++) {
-    RTEMS_INTERRUPT_LOCK_REFERENCE( lock, &(capture_lock_on_cpu( cpu )) )
-    rtems_interrupt_lock_context lock_context_per_cpu;
+  for (cpu = 0; cpu < cpu_count; cpu++) {
+    rtems_capture_per_cpu_data* per_cpu = capture_per_cpu_get( cpu );
 
-    rtems_interrupt_lock_acquire (lock, &lock_context_per_cpu);
-    capture_count_on_cpu(cpu) = 0;
-    if (capture_records_on_cpu(cpu).buffer)
-      rtems_capture_buffer_flush( &capture_records_on_cpu(cpu) );
-    rtems_interrupt_lock_release (lock, &lock_context_per_cpu);
+    rtems_capture_discard_records (per_cpu);
+    _Atomic_Store_uint (&per_cpu->dropped, 0, ATOMIC_ORDER_RELAXED);
+    _Atomic_Fetch_and_uint (&per_cpu->flags, ~RTEMS_CAPTURE_OVERFLOW,
+                            ATOMIC_ORDER_RELAXED);
+
+    rtems_capture_release_reader (per_cpu);
   }
 
   rtems_interrupt_lock_release (&capture_lock_global, &lock_context_global);
@@ -1170,25 +1365,6 @@ rtems_capture_clear_trigger (rtems_name                   from_name,
   return RTEMS_SUCCESSFUL;
 }
 
-static inline uint32_t rtems_capture_count_records( void* recs, size_t size )
-{
-  rtems_capture_record_t* rec;
-  uint8_t*                ptr = recs;
-  uint32_t                rec_count = 0;
-  size_t                  byte_count = 0;
-
-
- while (byte_count < size) {
-    rec = (rtems_capture_record_t*) ptr;
-    rec_count++;
-    _Assert( rec->size >= sizeof(*rec) );
-    ptr += rec->size;
-    byte_count += rec->size;
- };
-
- return rec_count;
-}
-
 /*
  * This function reads a number of records from the capture buffer.
  *
@@ -1208,78 +1384,63 @@ rtems_capture_read (uint32_t                 cpu,
                     uint32_t*                read,
                     rtems_capture_record_t** recs)
 {
-  rtems_interrupt_lock_context lock_context;
-  rtems_status_code            sc = RTEMS_SUCCESSFUL;
+  rtems_capture_per_cpu_data*  per_cpu = capture_per_cpu_get( cpu );
   size_t                       recs_size = 0;
-  RTEMS_INTERRUPT_LOCK_REFERENCE( lock, &(capture_lock_on_cpu( cpu )) )
-  rtems_capture_buffer_t*      records = &(capture_records_on_cpu( cpu ));
-  uint32_t*                    flags = &(capture_flags_on_cpu( cpu ));
 
   *read = 0;
   *recs = NULL;
 
-  rtems_interrupt_lock_acquire (lock, &lock_context);
-
   /*
-   * Only one reader is allowed.
+   * Only one reader is allowed. The owning processor may hold the reader
+   * role for a short time to discard old records in overwrite mode.
    */
 
-  if (*flags & RTEMS_CAPTURE_READER_ACTIVE)
-  {
-    rtems_interrupt_lock_release (lock, &lock_context);
+  if (!rtems_capture_acquire_reader (per_cpu))
     return RTEMS_RESOURCE_IN_USE;
-  }
-
-  if ( (capture_flags_global & RTEMS_CAPTURE_ON) != 0 )
-  {
-    rtems_interrupt_lock_release (lock, &lock_context);
-    return RTEMS_UNSATISFIED;
-  }
 
-  *flags |= RTEMS_CAPTURE_READER_ACTIVE;
-
-  *recs = rtems_capture_buffer_peek( records, &recs_size );
+  *recs = rtems_capture_buffer_peek( &per_cpu->records, &recs_size );
 
   *read = rtems_capture_count_records( *recs, recs_size );
 
-  rtems_interrupt_lock_release (lock, &lock_context);
-
-  return sc;
+  return RTEMS_SUCCESSFUL;
 }
 
 /*
  * This function releases the requested number of record slots back
- * to the capture engine. The count must match the number read.
+ * to the capture engine. The count must match the number read. It fails
+ * if the records were not read with rtems_capture_read() before.
  */
 rtems_status_code
 rtems_capture_release (uint32_t cpu, uint32_t count)
 {
-  rtems_interrupt_lock_context lock_context;
+  rtems_capture_per_cpu_data*  per_cpu = capture_per_cpu_get( cpu );
   uint8_t*                     ptr;
   rtems_capture_record_t*      rec;
   uint32_t                     counted;
+  uint32_t                     total;
   size_t                       ptr_size = 0;
   size_t                       rel_size = 0;
   rtems_status_code            ret_val = RTEMS_SUCCESSFUL;
-  RTEMS_INTERRUPT_LOCK_REFERENCE( lock, &(capture_lock_on_cpu( cpu )) )
-  rtems_capture_buffer_t*      records = &(capture_records_on_cpu( cpu ));
-  uint32_t*                    flags = &(capture_flags_on_cpu( cpu ));
-  uint32_t*                    total = &(capture_count_on_cpu( cpu ));
+  uint32_t                     flags;
 
-  rtems_interrupt_lock_acquire (lock, &lock_context);
+  /*
+   * The reader role must be held by a previous rtems_capture_read() and not
+   * by the owning processor reclaiming space in overwrite mode.
+   */
+  flags = _Atomic_Load_uint (&per_cpu->flags, ATOMIC_ORDER_ACQUIRE);
+  if ((flags & (RTEMS_CAPTURE_READER_ACTIVE | RTEMS_CAPTURE_RECLAIM)) !=
+      RTEMS_CAPTURE_READER_ACTIVE)
+    return RTEMS_UNSATISFIED;
 
-  if (count > *total) {
-    count = *total;
-  }
+  total = _Atomic_Load_uint (&per_cpu->count, ATOMIC_ORDER_RELAXED);
 
-  if ( (capture_flags_global & RTEMS_CAPTURE_ON) != 0 ) {
-    rtems_interrupt_lock_release (lock, &lock_context);
-    return RTEMS_UNSATISFIED;
+  if (count > total) {
+    count = total;
   }
 
   counted = count;
 
-  ptr = rtems_capture_buffer_peek( records, &ptr_size );
+  ptr = rtems_capture_buffer_peek( &per_cpu->records, &ptr_size );
   _Assert(ptr_size >= (count * sizeof(*rec) ));
 
   rel_size = 0;
@@ -1295,19 +1456,28 @@ rtems_capture_release (uint32_t cpu, uint32_t count)
     rel_size = ptr_size;
   }
 
-  *total -= count;
+  _Atomic_Fetch_sub_uint (&per_cpu->count, count, ATOMIC_ORDER_RELAXED);
 
   if (count) {
-    rtems_capture_buffer_free( records, rel_size );
+    rtems_capture_buffer_free( &per_cpu->records, rel_size );
   }
 
-  *flags &= ~RTEMS_CAPTURE_READER_ACTIVE;
-
-  rtems_interrupt_lock_release (lock, &lock_context);
+  rtems_capture_release_reader (per_cpu);
 
   return ret_val;
 }
 
+/*
+ * This function returns the number of records discarded on a processor
+ * since the last flush.
+ */
+uint32_t
+rtems_capture_dropped (uint32_t cpu)
+{
+  return _Atomic_Load_uint (&capture_per_cpu_get( cpu )->dropped,
+                            ATOMIC_ORDER_RELAXED);
+}
+
 /*
  * This function returns the current time. If a handler is provided
  * by the user get the time from that.
@@ -300,11 +300,30 @@ rtems_capture_control (bool enable);
 rtems_status_code
 rtems_capture_monitor (bool enable);
 
+/**
+ * @brief Capture overwrite enable/disable.
+ *
+ * This function enables the overwrite mode. When in the overwrite mode
+ * the oldest records of a processor are discarded to make room for new
+ * records once its buffer is full. Records held by a reader are never
+ * discarded. Otherwise new records are dropped if the buffer is full.
+ *
+ * @param[in]  enable The overwrite enable/disable flag.
+ *
+ * @retval This method returns RTEMS_SUCCESSFUL if there was not an
+ *         error. Otherwise, a status code is returned indicating the
+ *         source of the error.
+ */
+rtems_status_code
+rtems_capture_overwrite (bool enable);
+
 /*
  * @brief Capture flush trace buffer.
  *
  * This function flushes the trace buffer. The prime parameter allows the
- * capture engine to also be primed again.
+ * capture engine to also be primed again. The capture engine must be
+ * disabled. RTEMS_RESOURCE_IN_USE is returned and no records are discarded
+ * if a reader holds the records of a processor.
  *
  * @param[in]  prime The prime after flush flag.
  *
@@ -532,6 +551,9 @@ rtems_capture_clear_trigger (rtems_name                   from_name,
  * rtems_capture_release. Calls this function without a release will
  * result in at least the same number of records being released.
  *
+ * The records may be read while the capture engine is enabled. There is
+ * at most one reader per processor.
+ *
  * @param[in]  cpu The cpu number that the records were recorded on
  * @param[out] read will contain the number of records read
  * @param[out] recs The capture records that are read.
@@ -550,6 +572,8 @@ rtems_capture_read (uint32_t                 cpu,
  *
  * This function releases the requested number of record slots back
  * to the capture engine. The count must match the number read.
+ * RTEMS_UNSATISFIED is returned if the records of this processor were
+ * not read with rtems_capture_read() before.
  *
  * @param[in] count The number of record slots to release
  *
@@ -560,6 +584,61 @@ rtems_capture_read (uint32_t                 cpu,
 rtems_status_code
 rtems_capture_release (uint32_t cpu, uint32_t count);
 
+/**
+ * @brief Capture dropped records.
+ *
+ * This function returns the number of records dropped or overwritten on a
+ * processor since the last flush.
+ *
+ * @param[in] cpu The cpu number.
+ *
+ * @retval This method returns the number of records lost on the processor.
+ */
+uint32_t
+rtems_capture_dropped (uint32_t cpu);
+
+/**
+ * @brief Capture write CTF metadata.
+ *
+ * This function writes the Common Trace Format (CTF) metadata describing
+ * the packets written by rtems_capture_ctf_write_packets() to a file
+ * descriptor. Host tools such as babeltrace use it to decode the trace.
+ *
+ * @param[in] fd The file descriptor to write to.
+ *
+ * @retval This method returns RTEMS_SUCCESSFUL if there was not an
+ *         error. Otherwise, a status code is returned indicating the
+ *         source of the error.
+ */
+rtems_status_code
+rtems_capture_ctf_write_metadata (int fd);
+
+/**
+ * @brief Capture write CTF packets.
+ *
+ * This function reads the records available on a processor, writes them
+ * as CTF packets to a file descriptor and releases them. It may be called
+ * repeatedly while the capture engine is enabled to stream the trace to a
+ * file or a socket. Each packet context contains the processor number so
+ * that the packets of all processors may be sent over one connection and
+ * demultiplexed by the host. Records too large for a packet are dropped.
+ * If a write fails, the records not written yet stay in the buffer.
+ *
+ * @param[in]  fd The file descriptor to write to.
+ * @param[in]  cpu The cpu number to read the records from.
+ * @param[out] written The number of records written, may be NULL.
+ * @param[out] dropped The number of records dropped, may be NULL.
+ *
+ * @retval This method returns RTEMS_SUCCESSFUL if there was not an
+ *         error. Otherwise, a status code is returned indicating the
+ *         source of the error.
+ */
+rtems_status_code
+rtems_capture_ctf_write_packets (int       fd,
+                                 uint32_t  cpu,
+                                 uint32_t* written,
+                                 uint32_t* dropped);
+
 /*
  * @brief Capture nano-second time period.
  *
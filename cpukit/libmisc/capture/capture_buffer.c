@@ -28,90 +28,80 @@
 
 void * rtems_capture_buffer_allocate( rtems_capture_buffer_t* buffer, size_t size )
 {
-  static uint32_t   end;
-  static void       *ptr;
+  uint32_t head;
+  uint32_t tail;
 
-  if ( rtems_capture_buffer_is_full( buffer ) )
-    return NULL;
-
-  if ( (buffer->count + size) > buffer->end )
-    return NULL;
+  head = _Atomic_Load_uint( &buffer->head, ATOMIC_ORDER_RELAXED );
+  tail = _Atomic_Load_uint( &buffer->tail, ATOMIC_ORDER_ACQUIRE );
 
   /*
    *  Determine if the end of free space is marked with
-   *  the end of buffer space, or the head of allocated
+   *  the end of buffer space, or the tail of allocated
    *  space.
    *
    *  |...|head| freespace |tail| ...| end
    *
    *  tail|.....|head| freespace| end
    *
+   *  The head must never catch up with the tail from below, otherwise a full
+   *  buffer would look like an empty one.
    */
-  if (buffer->tail > buffer->head) {
-    end = buffer->tail;
-  } else {
-    end = buffer->end;
+  if (tail > head) {
+    if ((head + size) >= tail)
+      return NULL;
+
+    buffer->reserved = head + size;
+    return &buffer->buffer[ head ];
   }
 
   /*
    *  Can we allocate it easily?
    */
-  if ((buffer->head + size) <= end) {
-    ptr = &buffer->buffer[ buffer->head ];
-    buffer->head += size;
-    buffer->count = buffer->count + size;
-    return ptr;
+  if ((head + size) <= buffer->size) {
+    buffer->reserved = head + size;
+    return &buffer->buffer[ head ];
   }
 
-  /*
-   * We have to consider wrapping around to the front of the buffer
-   */
-
-  /* If there is not room at the end of the buffer         */
-  /* and we have we already wrapped then we can't allocate */
-  if ( end == buffer->tail )
-    return NULL;
-
   /* Is there no room at the front of the buffer */
-  if ( (buffer->tail  < size ))
+  if ( size >= tail )
     return NULL;
 
-  /* change the end pointer to the last used byte, so a read will wrap when out of data */
-  buffer->end = buffer->head;
-
-  /* now return the buffer */
-  ptr = buffer->buffer;
-  buffer->head = size;
-  buffer->count = buffer->count + size;
+  /*
+   * Change the end to the last used byte, so a read will wrap when out of
+   * data.  The commit of the head makes it visible to the consumer.
+   */
+  _Atomic_Store_uint( &buffer->end, head, ATOMIC_ORDER_RELAXED );
 
-  return ptr;
+  buffer->reserved = size;
+  return buffer->buffer;
 }
 
 void *rtems_capture_buffer_free( rtems_capture_buffer_t* buffer, size_t size )
 {
-    static void             *ptr;
-    static uint32_t         next;
+    void                    *ptr;
+    uint32_t                head;
+    uint32_t                tail;
+    uint32_t                next;
     size_t                  buff_size;
 
     if (size == 0)
       return NULL;
 
     ptr = rtems_capture_buffer_peek(buffer, &buff_size);
-    next = buffer->tail + size;
+    head = _Atomic_Load_uint( &buffer->head, ATOMIC_ORDER_RELAXED );
+    tail = _Atomic_Load_uint( &buffer->tail, ATOMIC_ORDER_RELAXED );
+    next = tail + size;
 
-   /* Check if we are freeing space past the end of the buffer */
-    _Assert( ! rtems_capture_buffer_is_empty( buffer ) );
-    _Assert( !((buffer->tail > buffer->head) && (next > buffer->end)) );
-    _Assert( !((buffer->tail < buffer->head) && (next > buffer->head)) );
+    /* Check if we are freeing space past the end of the buffer */
+    _Assert( ptr != NULL );
+    _Assert( size <= buff_size );
 
-    buffer->count = buffer->count - size;
-
-    if (next == buffer->end) {
-      buffer->end = buffer->size;
-      buffer->tail = 0;
-    } else {
-      buffer->tail = next;
+    if (tail > head &&
+        next == _Atomic_Load_uint( &buffer->end, ATOMIC_ORDER_RELAXED )) {
+      next = 0;
     }
 
+    _Atomic_Store_uint( &buffer->tail, next, ATOMIC_ORDER_RELEASE );
+
     return ptr;
 }
@@ -25,33 +25,54 @@
 
 #include <stdlib.h>
 
+#include <rtems/score/atomic.h>
 
 /**@{*/
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*
+ * The buffer is a single producer, single consumer ring of variable sized
+ * blocks.  The producer is the processor owning the buffer and it is the
+ * only one to change the head and the end.  The consumer is the reader and
+ * it is the only one to change the tail.  No lock is required as long as
+ * there is at most one producer and one consumer at a time.
+ *
+ * The end marks the last used byte once the head wrapped around to the
+ * front of the buffer.  It is only valid while the tail is greater than the
+ * head.  Space handed out by rtems_capture_buffer_allocate() is visible to
+ * the consumer after rtems_capture_buffer_commit().
+ */
 typedef struct {
   uint8_t           *buffer;
   size_t            size;
-  volatile uint32_t count;
-  volatile uint32_t head;
-  volatile uint32_t tail;
-  volatile uint32_t end;
+  Atomic_Uint       head;
+  Atomic_Uint       tail;
+  Atomic_Uint       end;
+  uint32_t          reserved;
 } rtems_capture_buffer_t;
 
+/*
+ * Resets the producer and the consumer state.  Must not be called while a
+ * producer may add a record.
+ */
 static inline void rtems_capture_buffer_flush(  rtems_capture_buffer_t* buffer )
 {
-  buffer->end = buffer->size;
-  buffer->head = buffer->tail =  0;
-  buffer->count = 0;
+  _Atomic_Store_uint( &buffer->end, buffer->size, ATOMIC_ORDER_RELAXED );
+  _Atomic_Store_uint( &buffer->tail, 0, ATOMIC_ORDER_RELAXED );
+  _Atomic_Store_uint( &buffer->head, 0, ATOMIC_ORDER_RELEASE );
+  buffer->reserved = 0;
 }
 
 static inline void rtems_capture_buffer_create( rtems_capture_buffer_t* buffer, size_t size )
 {
   buffer->buffer = malloc(size);
   buffer->size = size;
-  rtems_capture_buffer_flush( buffer );
+  _Atomic_Init_uint( &buffer->head, 0 );
+  _Atomic_Init_uint( &buffer->tail, 0 );
+  _Atomic_Init_uint( &buffer->end, size );
+  buffer->reserved = 0;
 }
 
 static inline void rtems_capture_buffer_destroy( rtems_capture_buffer_t*  buffer )
@@ -63,39 +84,62 @@ static inline void rtems_capture_buffer_destroy( rtems_capture_buffer_t*  buffer
 
 static inline bool rtems_capture_buffer_is_empty(  rtems_capture_buffer_t* buffer )
 {
-   return( buffer->count == 0 );
-}
-
-static inline bool rtems_capture_buffer_is_full( rtems_capture_buffer_t* buffer )
-{
-   return (buffer->count == buffer->size);
+  return _Atomic_Load_uint( &buffer->head, ATOMIC_ORDER_ACQUIRE ) ==
+    _Atomic_Load_uint( &buffer->tail, ATOMIC_ORDER_RELAXED );
 }
 
 static inline bool rtems_capture_buffer_has_wrapped( rtems_capture_buffer_t* buffer )
 {
-  if ( buffer->tail > buffer->head)
-    return true;
-
-  return false;
+  return _Atomic_Load_uint( &buffer->tail, ATOMIC_ORDER_RELAXED ) >
+    _Atomic_Load_uint( &buffer->head, ATOMIC_ORDER_ACQUIRE );
 }
 
+/*
+ * Returns the contiguous block of allocated space starting at the tail.  Must
+ * be called by the consumer only.
+ */
 static inline void *rtems_capture_buffer_peek(  rtems_capture_buffer_t* buffer, size_t *size )
 {
-  if (rtems_capture_buffer_is_empty(buffer)) {
-    *size = 0;
-    return NULL;
+  uint32_t head = _Atomic_Load_uint( &buffer->head, ATOMIC_ORDER_ACQUIRE );
+  uint32_t tail = _Atomic_Load_uint( &buffer->tail, ATOMIC_ORDER_RELAXED );
+
+  if ( tail > head ) {
+    uint32_t end = _Atomic_Load_uint( &buffer->end, ATOMIC_ORDER_RELAXED );
+
+    if ( tail == end ) {
+      tail = 0;
+      _Atomic_Store_uint( &buffer->tail, tail, ATOMIC_ORDER_RELEASE );
+      *size = head;
+    } else {
+      *size = end - tail;
+    }
+  } else {
+    *size = head - tail;
   }
 
-  if ( buffer->tail > buffer->head)
-    *size = buffer->end - buffer->tail;
-  else
-    *size = buffer->head - buffer->tail;
+  if ( *size == 0 )
+    return NULL;
 
-  return &buffer->buffer[ buffer->tail ];
+  return &buffer->buffer[ tail ];
 }
 
+/*
+ * Must be called by the producer only.
+ */
 void *rtems_capture_buffer_allocate( rtems_capture_buffer_t* buffer, size_t size );
 
+/*
+ * Makes the space handed out by the last allocation available to the
+ * consumer.  Must be called by the producer only.
+ */
+static inline void rtems_capture_buffer_commit( rtems_capture_buffer_t* buffer )
+{
+  _Atomic_Store_uint( &buffer->head, buffer->reserved, ATOMIC_ORDER_RELEASE );
+}
+
+/*
+ * Must be called by the consumer only.
+ */
 void *rtems_capture_buffer_free( rtems_capture_buffer_t* buffer, size_t size );
 
 #ifdef __cplusplus
@@ -0,0 +1,376 @@
+/*
+  ------------------------------------------------------------------------
+
+  COPYRIGHT (c) 2015.
+  On-Line Applications Research Corporation (OAR).
+
+  The license and distribution terms for this file may be
+  found in the file LICENSE in this distribution.
+
+  This software is provided ``as is'' and with NO WARRANTY.
+
+  ------------------------------------------------------------------------
+
+  RTEMS Performance Monitoring and Measurement Framework.
+
+  This is the Common Trace Format (CTF) export of the capture engine. The
+  records of each processor are written as packets of one CTF stream class
+  with the processor number in the packet context. The metadata describes
+  the packet layout so host tools can read the trace without knowledge of
+  the capture engine record layout.
+
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtems.h>
+#include <rtems/captureimpl.h>
+
+#define CTF_MAGIC                 UINT32_C (0xc1fc1fc1)
+#define CTF_PACKET_SIZE           4096
+#define CTF_EVENT_RECORD          0
+#define CTF_EVENT_TASK            1
+
+/*
+ * Offsets of the packet header and packet context fields.
+ */
+#define CTF_PACKET_MAGIC          0
+#define CTF_PACKET_STREAM_ID      4
+#define CTF_PACKET_TIME_BEGIN     8
+#define CTF_PACKET_TIME_END       16
+#define CTF_PACKET_CONTENT_SIZE   24
+#define CTF_PACKET_PACKET_SIZE    32
+#define CTF_PACKET_DISCARDED      40
+#define CTF_PACKET_CPU_ID         44
+#define CTF_PACKET_EVENTS         48
+
+/*
+ * The event header is the event identifier and the timestamp followed by the
+ * task identifier and the events of the capture record.
+ */
+#define CTF_EVENT_HEADER_SIZE     20
+
+typedef struct {
+  uint8_t*             buffer;
+  size_t               used;
+  uint32_t             cpu;
+  uint32_t             events;
+  rtems_capture_time_t begin;
+  rtems_capture_time_t end;
+} ctf_packet;
+
+static const char ctf_metadata[] =
+  "/* CTF 1.8 */\n"
+  "\n"
+  "typealias integer { size = 8; align = 8; signed = false; } := uint8_t;\n"
+  "typealias integer { size = 32; align = 8; signed = false; } := uint32_t;\n"
+  "typealias integer { size = 64; align = 8; signed = false; } := uint64_t;\n"
+  "\n"
+  "trace {\n"
+  "  major = 1;\n"
+  "  minor = 8;\n"
+#if CPU_BIG_ENDIAN == TRUE
+  "  byte_order = be;\n"
+#else
+  "  byte_order = le;\n"
+#endif
+  "  packet.header := struct {\n"
+  "    uint32_t magic;\n"
+  "    uint32_t stream_id;\n"
+  "  };\n"
+  "};\n"
+  "\n"
+  "env {\n"
+  "  domain = \"rtems\";\n"
+  "  tracer_name = \"rtems-capture\";\n"
+  "};\n"
+  "\n"
+  "clock {\n"
+  "  name = rtems_capture;\n"
+  "  description = \"Capture engine timestamp\";\n"
+  "  freq = 1000000000;\n"
+  "};\n"
+  "\n"
+  "typealias integer {\n"
+  "  size = 64; align = 8; signed = false;\n"
+  "  map = clock.rtems_capture.value;\n"
+  "} := uint64_clock_t;\n"
+  "\n"
+  "stream {\n"
+  "  id = 0;\n"
+  "  packet.context := struct {\n"
+  "    uint64_clock_t timestamp_begin;\n"
+  "    uint64_clock_t timestamp_end;\n"
+  "    uint64_t content_size;\n"
+  "    uint64_t packet_size;\n"
+  "    uint32_t events_discarded;\n"
+  "    uint32_t cpu_id;\n"
+  "  };\n"
+  "  event.header := struct {\n"
+  "    uint32_t id;\n"
+  "    uint64_clock_t timestamp;\n"
+  "  };\n"
+  "  event.context := struct {\n"
+  "    uint32_t task_id;\n"
+  "    uint32_t events;\n"
+  "  };\n"
+  "};\n"
+  "\n"
+  "event {\n"
+  "  name = \"rtems_capture_record\";\n"
+  "  id = 0;\n"
+  "  stream_id = 0;\n"
+  "  fields := struct {\n"
+  "    uint32_t data_size;\n"
+  "    uint8_t data[data_size];\n"
+  "  };\n"
+  "};\n"
+  "\n"
+  "event {\n"
+  "  name = \"rtems_capture_task\";\n"
+  "  id = 1;\n"
+  "  stream_id = 0;\n"
+  "  fields := struct {\n"
+  "    uint32_t name;\n"
+  "    uint32_t start_priority;\n"
+  "    uint32_t stack_size;\n"
+  "  };\n"
+  "};\n";
+
+static bool
+ctf_write (int fd, const void* data, size_t size)
+{
+  const uint8_t* ptr = data;
+
+  while (size > 0)
+  {
+    ssize_t n = write (fd, ptr, size);
+
+    if (n <= 0)
+      return false;
+
+    ptr += n;
+    size -= (size_t) n;
+  }
+
+  return true;
+}
+
+static void
+ctf_put (ctf_packet* packet, size_t offset, const void* data, size_t size)
+{
+  memcpy (&packet->buffer[offset], data, size);
+}
+
+static void
+ctf_put_uint32 (ctf_packet* packet, size_t offset, uint32_t value)
+{
+  ctf_put (packet, offset, &value, sizeof (value));
+}
+
+static void
+ctf_put_uint64 (ctf_packet* packet, size_t offset, uint64_t value)
+{
+  ctf_put (packet, offset, &value, sizeof (value));
+}
+
+static void
+ctf_packet_begin (ctf_packet* packet)
+{
+  packet->used = CTF_PACKET_EVENTS;
+  packet->events = 0;
+}
+
+static rtems_status_code
+ctf_packet_flush (int fd, ctf_packet* packet)
+{
+  uint64_t bits = (uint64_t) packet->used * 8;
+
+  if (packet->events == 0)
+    return RTEMS_SUCCESSFUL;
+
+  ctf_put_uint32 (packet, CTF_PACKET_MAGIC, CTF_MAGIC);
+  ctf_put_uint32 (packet, CTF_PACKET_STREAM_ID, 0);
+  ctf_put_uint64 (packet, CTF_PACKET_TIME_BEGIN, packet->begin);
+  ctf_put_uint64 (packet, CTF_PACKET_TIME_END, packet->end);
+  ctf_put_uint64 (packet, CTF_PACKET_CONTENT_SIZE, bits);
+  ctf_put_uint64 (packet, CTF_PACKET_PACKET_SIZE, bits);
+  ctf_put_uint32 (packet, CTF_PACKET_DISCARDED,
+                  rtems_capture_dropped (packet->cpu));
+  ctf_put_uint32 (packet, CTF_PACKET_CPU_ID, packet->cpu);
+
+  if (!ctf_write (fd, packet->buffer, packet->used))
+    return RTEMS_IO_ERROR;
+
+  ctf_packet_begin (packet);
+
+  return RTEMS_SUCCESSFUL;
+}
+
+/*
+ * Returns false if the packet has not enough space left for the record.
+ */
+static bool
+ctf_packet_add (ctf_packet* packet, const rtems_capture_record_t* rec)
+{
+  const uint8_t* data = (const uint8_t*) rec + sizeof (*rec);
+  uint32_t       data_size = rec->size - sizeof (*rec);
+  size_t         offset = packet->used;
+  uint32_t       id;
+  size_t         size;
+
+  if ((rec->events >> RTEMS_CAPTURE_EVENT_START) == 0 &&
+      data_size >= 3 * sizeof (uint32_t))
+  {
+    id = CTF_EVENT_TASK;
+    data_size = 3 * sizeof (uint32_t);
+    size = CTF_EVENT_HEADER_SIZE + data_size;
+  }
+  else
+  {
+    id = CTF_EVENT_RECORD;
+    size = CTF_EVENT_HEADER_SIZE + sizeof (uint32_t) + data_size;
+  }
+
+  if (offset + size > CTF_PACKET_SIZE)
+    return false;
+
+  ctf_put_uint32 (packet, offset, id);
+  ctf_put_uint64 (packet, offset + 4, rec->time);
+  ctf_put_uint32 (packet, offset + 12, rec->task_id);
+  ctf_put_uint32 (packet, offset + 16, rec->events);
+  offset += CTF_EVENT_HEADER_SIZE;
+
+  if (id == CTF_EVENT_RECORD)
+  {
+    ctf_put_uint32 (packet, offset, data_size);
+    offset += sizeof (uint32_t);
+  }
+
+  ctf_put (packet, offset, data, data_size);
+
+  if (packet->events == 0)
+    packet->begin = rec->time;
+
+  packet->end = rec->time;
+  packet->used += size;
+  ++packet->events;
+
+  return true;
+}
+
+rtems_status_code
+rtems_capture_ctf_write_metadata (int fd)
+{
+  if (!ctf_write (fd, ctf_metadata, sizeof (ctf_metadata) - 1))
+    return RTEMS_IO_ERROR;
+
+  return RTEMS_SUCCESSFUL;
+}
+
+rtems_status_code
+rtems_capture_ctf_write_packets (int       fd,
+                                 uint32_t  cpu,
+                                 uint32_t* written,
+                                 uint32_t* dropped)
+{
+  rtems_status_code sc = RTEMS_SUCCESSFUL;
+  ctf_packet        packet;
+  uint32_t          total = 0;
+  uint32_t          too_large = 0;
+  int               pass;
+
+  if (written != NULL)
+    *written = 0;
+
+  if (dropped != NULL)
+    *dropped = 0;
+
+  if (cpu >= rtems_get_processor_count ())
+    return RTEMS_INVALID_NUMBER;
+
+  packet.buffer = malloc (CTF_PACKET_SIZE);
+  if (packet.buffer == NULL)
+    return RTEMS_NO_MEMORY;
+
+  packet.cpu = cpu;
+  ctf_packet_begin (&packet);
+
+  /*
+   * A read returns the records up to the end of the buffer, so two passes
+   * are required to get the records which wrapped around to the front.
+   * Only the records of packets which were written successfully and the
+   * dropped records are released, so a write error keeps the others for
+   * the next call.
+   */
+  for (pass = 0; pass < 2 && sc == RTEMS_SUCCESSFUL; ++pass)
+  {
+    rtems_capture_record_t* rec;
+    uint32_t                read;
+    uint32_t                done = 0;
+    uint32_t                pending = 0;
+    uint32_t                i;
+
+    sc = rtems_capture_read (cpu, &read, &rec);
+    if (sc != RTEMS_SUCCESSFUL)
+      break;
+
+    for (i = 0; i < read; ++i)
+    {
+      if (!ctf_packet_add (&packet, rec))
+      {
+        sc = ctf_packet_flush (fd, &packet);
+        if (sc != RTEMS_SUCCESSFUL)
+          break;
+
+        total += pending;
+        done += pending;
+        pending = 0;
+
+        /*
+         * Records which do not fit into an empty packet are dropped.
+         */
+        if (!ctf_packet_add (&packet, rec))
+        {
+          ++too_large;
+          ++done;
+          rec = (rtems_capture_record_t*) ((uint8_t*) rec + rec->size);
+          continue;
+        }
+      }
+
+      ++pending;
+      rec = (rtems_capture_record_t*) ((uint8_t*) rec + rec->size);
+    }
+
+    if (sc == RTEMS_SUCCESSFUL)
+      sc = ctf_packet_flush (fd, &packet);
+
+    if (sc == RTEMS_SUCCESSFUL)
+    {
+      total += pending;
+      done += pending;
+    }
+
+    rtems_capture_release (cpu, done);
+
+    if (read == 0)
+      break;
+  }
+
+  free (packet.buffer);
+
+  if (written != NULL)
+    *written = total;
+
+  if (dropped != NULL)
+    *dropped = too_large;
+
+  return sc;
+}
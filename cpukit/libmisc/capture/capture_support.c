@@ -155,7 +155,15 @@ rtems_capture_print_trace_records ( int total, bool csv )
         sc = rtems_capture_read (i, &per_cpu[i].read, &per_cpu[i].rec);
         if (sc != RTEMS_SUCCESSFUL)
         {
+          uint32_t j;
+
           fprintf (stdout, "error: trace read failed: %s\n", rtems_status_text (sc));
+
+          /* The records held by this reader would block the flush */
+          for (j = 0; j < count; j++)
+            if (j != i && per_cpu[j].read != 0)
+              rtems_capture_release (j, per_cpu[j].read);
+
           rtems_capture_flush (0);
           free( per_cpu );
           return;
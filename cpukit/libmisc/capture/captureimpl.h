@@ -49,6 +49,7 @@ extern "C" {
 #define RTEMS_CAPTURE_TRIGGERED      (1U << 3)
 #define RTEMS_CAPTURE_GLOBAL_WATCH   (1U << 4)
 #define RTEMS_CAPTURE_ONLY_MONITOR   (1U << 5)
+#define RTEMS_CAPTURE_OVERWRITE      (1U << 6)
 
 /*
  * Per-CPU capture flags.
@@ -56,6 +57,7 @@ extern "C" {
 #define RTEMS_CAPTURE_OVERFLOW       (1U << 0)
 #define RTEMS_CAPTURE_READER_ACTIVE  (1U << 1)
 #define RTEMS_CAPTURE_READER_WAITING (1U << 2)
+#define RTEMS_CAPTURE_RECLAIM        (1U << 3)
 
 /**
  * @brief Capture set extension index.
@@ -185,8 +187,8 @@ bool rtems_capture_filter( rtems_tcb*            task,
  */
 #define rtems_capture_begin_add_record( _task, _events, _size, _rec) \
   do { \
-    rtems_interrupt_lock_context _lock_context; \
-    *_rec = rtems_capture_record_open( _task, _events, _size, &_lock_context );
+    rtems_interrupt_level _level; \
+    *_rec = rtems_capture_record_open( _task, _events, _size, &_level );
 
 /**
  * @brief Capture append to record.
@@ -216,7 +218,7 @@ static inline void *rtems_capture_append_to_record(void*  rec,
  * @param[in] _rec specifies the end of the capture record
  */
 #define rtems_capture_end_add_record( _rec ) \
-    rtems_capture_record_close( _rec, &_lock_context ); \
+    rtems_capture_record_close( _rec, &_level ); \
   } while (0)
 
 /**
@@ -235,35 +237,36 @@ void rtems_capture_get_time (rtems_capture_time_t* time);
 /**
  * @brief Capture record open.
  *
- * This function allocates a record and fills in the
- * header information.  It does a lock acquire
- * which will remain in effect until
+ * This function allocates a record in the buffer of the current
+ * processor and fills in the header information.  It disables
+ * interrupts on the current processor until
  * rtems_capture_record_close is called.  This method
  * should only be used by rtems_capture_begin_add_record.
  *
  * @param[in] task specifies the caputre task block
  * @param[in] events specifies the events
  * @param[in] size specifies capture record size
- * @param[out] lock_context specifies the lock context
+ * @param[out] level specifies the previous interrupt level
  *
  * @retval This method returns a pointer to the next location in
  * the capture record to store data.
  */
-void* rtems_capture_record_open (rtems_tcb*                    task,
-                                 uint32_t                      events,
-                                 size_t                        size,
-                                 rtems_interrupt_lock_context* lock_context);
+void* rtems_capture_record_open (rtems_tcb*             task,
+                                 uint32_t               events,
+                                 size_t                 size,
+                                 rtems_interrupt_level* level);
 /**
  * @brief Capture record close.
  *
- * This function closes writing to capure record and
- * releases the lock that was held on the record. This
- * method should only be used by rtems_capture_end_add_record.
+ * This function closes writing to capure record, makes
+ * it visible to the reader and restores the interrupt
+ * level. This method should only be used by
+ * rtems_capture_end_add_record.
  *
  * @param[in] rec specifies the record
- * @param[out] lock_context specifies the lock context
+ * @param[in] level specifies the previous interrupt level
  */
-void rtems_capture_record_close( void *rec, rtems_interrupt_lock_context* lock_context);
+void rtems_capture_record_close( void *rec, rtems_interrupt_level* level);
 
 
 /**
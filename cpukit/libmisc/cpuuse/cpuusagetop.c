@@ -35,6 +35,7 @@
 #include <rtems/malloc.h>
 #include <rtems/score/objectimpl.h>
 #include <rtems/score/protectedheap.h>
+#include <rtems/score/schedulerimpl.h>
 #include <rtems/score/threadimpl.h>
 #include <rtems/score/todimpl.h>
 #include <rtems/score/watchdogimpl.h>
@@ -49,6 +50,27 @@ typedef struct
   rtems_printk_plugin_t  print;
 } rtems_cpu_usage_plugin;
 
+/*
+ * The CPU usage of a thread at the last sample. The samples are indexed by
+ * the object index of the thread so that the usage in the current period is
+ * found in constant time.
+ */
+typedef struct
+{
+  Objects_Id             id;
+  Thread_CPU_usage_t     usage;
+} rtems_cpu_usage_sample;
+
+/*
+ * The CPU usage of the threads of a scheduler in the current period.
+ */
+typedef struct
+{
+  Timestamp_Control      current;           /* Current time run in this period. */
+  Timestamp_Control      idle;              /* Current time in idle this period. */
+  uint32_t               task_count;        /* Number of tasks. */
+} rtems_cpu_usage_scheduler;
+
 /*
  * Use a struct for all data to allow more than one top and to support the
  * thread iterator.
@@ -67,17 +89,20 @@ typedef struct
   Timestamp_Control      last_uptime;
   Timestamp_Control      period;
   int                    task_count;        /* Number of tasks. */
-  int                    last_task_count;   /* Number of tasks in the previous sample. */
-  int                    task_size;         /* The size of the arrays */
-  Thread_Control**       tasks;             /* List of tasks in this sample. */
-  Thread_Control**       last_tasks;        /* List of tasks in the last sample. */
-  Thread_CPU_usage_t*    usage;             /* Usage of task's in this sample. */
-  Thread_CPU_usage_t*    last_usage;        /* Usage of task's in the last sample. */
+  int                    top_count;         /* Number of tasks in the top arrays. */
+  int                    top_size;          /* The size of the top arrays */
+  Thread_Control**       tasks;             /* Top tasks in this sample. */
+  Thread_CPU_usage_t*    usage;             /* Usage of the top tasks in this sample. */
   Thread_CPU_usage_t*    current_usage;     /* Current usage for this sample. */
+  rtems_cpu_usage_sample* samples[OBJECTS_APIS_LAST + 1]; /* Last sample per API. */
+  uint32_t               sample_size[OBJECTS_APIS_LAST + 1];
   Timestamp_Control      total;             /* Total run run, should equal the uptime. */
   Timestamp_Control      idle;              /* Time spent in idle. */
   Timestamp_Control      current;           /* Current time run in this period. */
   Timestamp_Control      current_idle;      /* Current time in idle this period. */
+  uint32_t               cpu_count;         /* Number of processors. */
+  Timestamp_Control*     cpu_idle;          /* Current time in idle per processor. */
+  rtems_cpu_usage_scheduler* schedulers;    /* Usage per scheduler. */
   uint32_t               stack_size;        /* Size of stack allocated. */
 } rtems_cpu_usage_data;
 
@@ -202,35 +227,131 @@ print_time(rtems_cpu_usage_data*    data,
 }
 
 /*
- * Count the number of tasks.
+ * Make sure there is a sample for every possible thread. The tables only
+ * grow if the thread objects are unlimited. Returns the maximum number of
+ * threads.
  */
-static void
-task_counter(Thread_Control *thrad, void* arg)
+static int
+task_samples_prepare(rtems_cpu_usage_data* data)
 {
-  rtems_cpu_usage_data* data = (rtems_cpu_usage_data*) arg;
-  ++data->task_count;
+  uint32_t api_index;
+  int      maximum = 0;
+
+  for (api_index = 1; api_index <= OBJECTS_APIS_LAST; api_index++)
+  {
+    Objects_Information* information;
+    uint32_t             size;
+
+    #if !defined(RTEMS_POSIX_API) || defined(RTEMS_DEBUG)
+      if ( !_Objects_Information_table[ api_index ] )
+        continue;
+    #endif
+    information = _Objects_Information_table[ api_index ][ 1 ];
+    if (information == NULL)
+      continue;
+
+    size = information->maximum + 1;
+    maximum += information->maximum;
+
+    if (size > data->sample_size[api_index])
+    {
+      rtems_cpu_usage_sample* samples;
+
+      samples = realloc(data->samples[api_index], size * sizeof(*samples));
+      if (samples == NULL)
+        return -1;
+
+      memset(&samples[data->sample_size[api_index]], 0,
+             (size - data->sample_size[api_index]) * sizeof(*samples));
+      data->samples[api_index] = samples;
+      data->sample_size[api_index] = size;
+    }
+  }
+
+  return maximum;
+}
+
+/*
+ * Returns true if the thread sorts after the top task with index j in the
+ * current sort order.
+ */
+static bool
+task_usage_is_after(rtems_cpu_usage_data*     data,
+                    Thread_Control*           thread,
+                    const Thread_CPU_usage_t* usage,
+                    const Thread_CPU_usage_t* current,
+                    int                       j)
+{
+  switch (data->sort_order)
+  {
+    default:
+      data->sort_order = RTEMS_TOP_SORT_CURRENT;
+      /* drop through */
+    case RTEMS_TOP_SORT_CURRENT:
+      if (CPU_usage_Equal_to(current, &data->zero) ||
+          CPU_usage_Less_than(current, &data->current_usage[j]))
+        return true;
+    case RTEMS_TOP_SORT_TOTAL:
+      if (CPU_usage_Equal_to(usage, &data->zero) ||
+          CPU_usage_Less_than(usage, &data->usage[j]))
+        return true;
+    case RTEMS_TOP_SORT_REAL_PRI:
+      if (thread->real_priority > data->tasks[j]->real_priority)
+        return true;
+    case RTEMS_TOP_SORT_CURRENT_PRI:
+      if (thread->current_priority > data->tasks[j]->current_priority)
+        return true;
+    case RTEMS_TOP_SORT_ID:
+      if (thread->Object.id < data->tasks[j]->Object.id)
+        return true;
+  }
+
+  return false;
 }
 
 /*
- * Create the sorted table with the current and total usage.
+ * Account the usage of a thread and insert it into the sorted top tasks.
+ * Only as many tasks as can be displayed are kept, so a thread which does
+ * not make it into the top tasks costs a constant time.
  */
 static void
 task_usage(Thread_Control* thread, void* arg)
 {
-  rtems_cpu_usage_data* data = (rtems_cpu_usage_data*) arg;
-  Thread_CPU_usage_t    usage = thread->cpu_time_used;
-  Thread_CPU_usage_t    current = data->zero;
-  int                   j;
+  rtems_cpu_usage_data*      data = (rtems_cpu_usage_data*) arg;
+  Thread_CPU_usage_t         usage = thread->cpu_time_used;
+  Thread_CPU_usage_t         current = data->zero;
+  uint32_t                   api_index = _Objects_Get_API(thread->Object.id);
+  uint32_t                   index = _Objects_Get_index(thread->Object.id);
+  rtems_cpu_usage_sample*    sample = NULL;
+  rtems_cpu_usage_scheduler* scheduler;
+  int                        count;
+  int                        j;
+  int                        k;
 
+  ++data->task_count;
   data->stack_size += thread->Start.Initial_stack.size;
 
-  for (j = 0; j < data->last_task_count; j++)
+  /*
+   * With unlimited objects a thread may have been created after the samples
+   * were prepared. It has no last sample and is sampled the next period.
+   */
+  if (api_index <= OBJECTS_APIS_LAST && index < data->sample_size[api_index])
+    sample = &data->samples[api_index][index];
+
+  /*
+   * A reset of the CPU usage statistics may have cleared the usage since the
+   * last sample.
+   */
+  if (sample != NULL && sample->id == thread->Object.id &&
+      !CPU_usage_Less_than(&usage, &sample->usage))
+    _Timestamp_Subtract(&sample->usage, &usage, &current);
+  else
+    current = usage;
+
+  if (sample != NULL)
   {
-    if (thread == data->last_tasks[j])
-    {
-      _Timestamp_Subtract(&data->last_usage[j], &usage, &current);
-      break;
-    }
+    sample->id = thread->Object.id;
+    sample->usage = usage;
   }
 
   /*
@@ -241,59 +362,107 @@ task_usage(Thread_Control* thread, void* arg)
   _Timestamp_Add_to(&data->total, &usage);
   _Timestamp_Add_to(&data->current, &current);
 
-  if (thread->Object.id == 0x09010001)
+  scheduler = &data->schedulers[_Scheduler_Get_index(_Scheduler_Get(thread))];
+  ++scheduler->task_count;
+  _Timestamp_Add_to(&scheduler->current, &current);
+
+  if (thread->Start.entry_point ==
+      (Thread_Entry) rtems_configuration_get_idle_task())
   {
-    data->idle = usage;
-    data->current_idle = current;
+    uint32_t cpu_index = _Per_CPU_Get_index(_Thread_Get_CPU(thread));
+
+    _Timestamp_Add_to(&data->idle, &usage);
+    _Timestamp_Add_to(&data->current_idle, &current);
+    _Timestamp_Add_to(&scheduler->idle, &current);
+
+    if (cpu_index < data->cpu_count)
+      data->cpu_idle[cpu_index] = current;
   }
 
   /*
-   * Create the tasks to display soring as we create.
+   * Insert the task into the sorted top tasks. The common case of a task
+   * which does not make it into a full table is checked first.
    */
-  for (j = 0; j < data->task_count; j++)
+  count = data->top_count;
+
+  if (count == data->top_size &&
+      task_usage_is_after(data, thread, &usage, &current, count - 1))
+    return;
+
+  for (j = 0; j < count; j++)
   {
-    if (data->tasks[j])
-    {
-      int k;
+    if (!task_usage_is_after(data, thread, &usage, &current, j))
+      break;
+  }
 
-      /*
-       * Sort on the current load.
-       */
-      switch (data->sort_order)
-      {
-        default:
-          data->sort_order = RTEMS_TOP_SORT_CURRENT;
-          /* drop through */
-        case RTEMS_TOP_SORT_CURRENT:
-          if (CPU_usage_Equal_to(&current, &data->zero) ||
-              CPU_usage_Less_than(&current, &data->current_usage[j]))
-            continue;
-        case RTEMS_TOP_SORT_TOTAL:
-          if (CPU_usage_Equal_to(&usage, &data->zero) ||
-              CPU_usage_Less_than(&usage, &data->usage[j]))
-            continue;
-        case RTEMS_TOP_SORT_REAL_PRI:
-          if (thread->real_priority > data->tasks[j]->real_priority)
-            continue;
-        case RTEMS_TOP_SORT_CURRENT_PRI:
-          if (thread->current_priority > data->tasks[j]->current_priority)
-            continue;
-        case RTEMS_TOP_SORT_ID:
-          if (thread->Object.id < data->tasks[j]->Object.id)
-            continue;
-      }
+  if (count == data->top_size)
+    --count;
 
-      for (k = (data->task_count - 1); k >= j; k--)
-      {
-        data->tasks[k + 1] = data->tasks[k];
-        data->usage[k + 1]  = data->usage[k];
-        data->current_usage[k + 1]  = data->current_usage[k];
-      }
-    }
-    data->tasks[j] = thread;
-    data->usage[j] = usage;
-    data->current_usage[j] = current;
-    break;
+  for (k = count - 1; k >= j; k--)
+  {
+    data->tasks[k + 1] = data->tasks[k];
+    data->usage[k + 1]  = data->usage[k];
+    data->current_usage[k + 1]  = data->current_usage[k];
+  }
+
+  data->tasks[j] = thread;
+  data->usage[j] = usage;
+  data->current_usage[j] = current;
+  data->top_count = count + 1;
+}
+
+/*
+ * Print the load of each processor and scheduler in this period.
+ */
+static void
+print_cpu_and_scheduler_load(rtems_cpu_usage_data* data)
+{
+  uint32_t cpu_index;
+  uint32_t scheduler_index;
+  uint32_t ival, fval;
+
+  for (cpu_index = 0; cpu_index < data->cpu_count; cpu_index++)
+  {
+    Timestamp_Control load;
+
+    if ((cpu_index % 4) == 0)
+      (*data->plugin.print)(data->plugin.context, "\nCPU:");
+
+    _Timestamp_Subtract(&data->cpu_idle[cpu_index], &data->period, &load);
+    _Timestamp_Divide(&load, &data->period, &ival, &fval);
+    (*data->plugin.print)(data->plugin.context,
+                          " %3" PRIu32 ":%4" PRIu32 ".%03" PRIu32 "%%",
+                          cpu_index, ival, fval);
+  }
+
+  for (scheduler_index = 0; scheduler_index < _Scheduler_Count; scheduler_index++)
+  {
+    const Scheduler_Control*   scheduler = &_Scheduler_Table[scheduler_index];
+    rtems_cpu_usage_scheduler* usage = &data->schedulers[scheduler_index];
+    uint32_t                   processor_count;
+    Timestamp_Control          capacity;
+    Timestamp_Control          load;
+    char                       name[5];
+    uint32_t                   i;
+
+    processor_count = _Scheduler_Get_processor_count(scheduler);
+    if (processor_count == 0)
+      continue;
+
+    _Timestamp_Set_to_zero(&capacity);
+    for (i = 0; i < processor_count; i++)
+      _Timestamp_Add_to(&capacity, &data->period);
+
+    rtems_name_to_characters(scheduler->name,
+                             &name[0], &name[1], &name[2], &name[3]);
+    name[4] = '\0';
+
+    _Timestamp_Subtract(&usage->idle, &usage->current, &load);
+    _Timestamp_Divide(&load, &capacity, &ival, &fval);
+    (*data->plugin.print)(data->plugin.context,
+                          "\nScheduler: %-4s  CPUs: %3" PRIu32 "  Tasks: %4" PRIu32
+                          "  Load: %4" PRIu32 ".%03" PRIu32 "%%",
+                          name, processor_count, usage->task_count, ival, fval);
   }
 }
 
@@ -318,6 +487,15 @@ rtems_cpuusage_top_thread (rtems_task_argument arg)
 
   data->thread_active = true;
 
+  data->cpu_count = rtems_get_processor_count();
+  data->cpu_idle = calloc(data->cpu_count, sizeof(*data->cpu_idle));
+  data->schedulers = calloc(_Scheduler_Count, sizeof(*data->schedulers));
+  if ((data->cpu_idle == NULL) || (data->schedulers == NULL))
+  {
+    (*data->plugin.print)(data->plugin.context, "top worker: error: no memory\n");
+    data->thread_run = false;
+  }
+
   _TOD_Get_uptime(&data->last_uptime);
 
   CPU_usage_Set_to_zero(&data->zero);
@@ -328,14 +506,27 @@ rtems_cpuusage_top_thread (rtems_task_argument arg)
     size_t            tasks_size;
     size_t            usage_size;
     Timestamp_Control load;
+    int               top_size;
 
-    data->task_count = 0;
-    rtems_iterate_over_all_threads_2(task_counter, data);
+    /*
+     * Only the displayed tasks are kept. The maximum number of threads is
+     * derived from the object information and needs no thread iteration.
+     */
+    top_size = task_samples_prepare(data);
+    if (top_size < 0)
+    {
+      (*data->plugin.print)(data->plugin.context, "top worker: error: no memory\n");
+      data->thread_run = false;
+      break;
+    }
 
-    tasks_size = sizeof(Thread_Control*) * (data->task_count + 1);
-    usage_size = sizeof(Thread_CPU_usage_t) * (data->task_count + 1);
+    if (data->single_page && (data->show != 0) && (data->show < top_size))
+      top_size = data->show;
 
-    if (data->task_count > data->task_size)
+    tasks_size = sizeof(Thread_Control*) * (top_size + 1);
+    usage_size = sizeof(Thread_CPU_usage_t) * (top_size + 1);
+
+    if (top_size > data->top_size)
     {
       data->tasks = realloc(data->tasks, tasks_size);
       data->usage = realloc(data->usage, usage_size);
@@ -348,12 +539,17 @@ rtems_cpuusage_top_thread (rtems_task_argument arg)
       }
     }
 
-    memset(data->tasks, 0, tasks_size);
-    memset(data->usage, 0, usage_size);
-    memset(data->current_usage, 0, usage_size);
+    data->top_size = top_size;
+    data->top_count = 0;
+    data->task_count = 0;
+
+    memset(data->cpu_idle, 0, data->cpu_count * sizeof(*data->cpu_idle));
+    memset(data->schedulers, 0, _Scheduler_Count * sizeof(*data->schedulers));
 
     _Timestamp_Set_to_zero(&data->total);
+    _Timestamp_Set_to_zero(&data->idle);
     _Timestamp_Set_to_zero(&data->current);
+    _Timestamp_Set_to_zero(&data->current_idle);
     data->stack_size = 0;
 
     _TOD_Get_uptime(&data->uptime);
@@ -363,23 +559,6 @@ rtems_cpuusage_top_thread (rtems_task_argument arg)
 
     rtems_iterate_over_all_threads_2(task_usage, data);
 
-    if (data->task_count > data->task_size)
-    {
-      data->last_tasks = realloc(data->last_tasks, tasks_size);
-      data->last_usage = realloc(data->last_usage, usage_size);
-      if ((data->last_tasks == NULL) || (data->last_usage == NULL))
-      {
-        (*data->plugin.print)(data->plugin.context, "top worker: error: no memory\n");
-        data->thread_run = false;
-        break;
-      }
-      data->task_size = data->task_count;
-    }
-
-    memcpy(data->last_tasks, data->tasks, tasks_size);
-    memcpy(data->last_usage, data->usage, usage_size);
-    data->last_task_count = data->task_count;
-
     /*
      * We need to loop again to get suitable current usage values as we need a
      * last sample to work.
@@ -445,7 +624,10 @@ rtems_cpuusage_top_thread (rtems_task_argument arg)
       print_memsize(data, libc_heap.Used.total, "used");
     }
 
-    print_memsize(data, data->stack_size, "stack\n");
+    print_memsize(data, data->stack_size, "stack");
+
+    print_cpu_and_scheduler_load(data);
+    (*data->plugin.print)(data->plugin.context, "\n");
 
     (*data->plugin.print)(data->plugin.context,
        "\n"
@@ -460,7 +642,7 @@ rtems_cpuusage_top_thread (rtems_task_argument arg)
 
     task_count = 0;
 
-    for (i = 0; i < data->task_count; i++)
+    for (i = 0; i < data->top_count; i++)
     {
       Thread_Control*   thread = data->tasks[i];
       Timestamp_Control last;
@@ -550,9 +732,13 @@ rtems_cpuusage_top_thread (rtems_task_argument arg)
   }
 
   free(data->tasks);
-  free(data->last_tasks);
-  free(data->last_usage);
+  free(data->usage);
   free(data->current_usage);
+  free(data->cpu_idle);
+  free(data->schedulers);
+
+  for (i = 1; i <= OBJECTS_APIS_LAST; i++)
+    free(data->samples[i]);
 
   data->thread_active = false;
 
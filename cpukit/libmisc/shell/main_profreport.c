@@ -17,6 +17,7 @@
 #endif
 
 #include <stdio.h>
+#include <string.h>
 
 #include <rtems/profiling.h>
 #include <rtems/shell.h>
@@ -24,20 +25,39 @@
 
 static int rtems_shell_main_profreport(int argc, char **argv)
 {
-  rtems_profiling_report_xml(
-    "Shell",
-    (rtems_profiling_printf) fprintf,
-    stdout,
-    0,
-    "  "
-  );
+  bool report = true;
+  bool reset = false;
+
+  if (argc == 2 && strcmp(argv[1], "-r") == 0) {
+    reset = true;
+  } else if (argc == 2 && strcmp(argv[1], "-R") == 0) {
+    report = false;
+    reset = true;
+  } else if (argc != 1) {
+    fprintf(stdout, "usage: %s\n", rtems_shell_PROFREPORT_Command.usage);
+    return 1;
+  }
+
+  if (report) {
+    rtems_profiling_report_xml(
+      "Shell",
+      (rtems_profiling_printf) fprintf,
+      stdout,
+      0,
+      "  "
+    );
+  }
+
+  if (reset) {
+    rtems_profiling_reset();
+  }
 
   return 0;
 }
 
 rtems_shell_cmd_t rtems_shell_PROFREPORT_Command = {
   .name = "profreport",
-  .usage = "profreport",
+  .usage = "profreport [-r|-R]",
   .topic = "rtems",
   .command = rtems_shell_main_profreport
 };
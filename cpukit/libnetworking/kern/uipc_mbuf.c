@@ -119,6 +119,110 @@ m_reclaim(void)
 	mbstat.m_drain++;
 }
 
+/*
+ * Jumbo clusters.  They are rare compared to normal clusters, so they
+ * use a global free list of their own.  The reference
+ * counts are maintained through the external storage routines of the
+ * mbuf.
+ */
+union mjcluster {
+	union	mjcluster *mjcl_next;
+	char	mjcl_buf[MJUM9BYTES];
+};
+
+uint32_t nmbjumbo9;
+static caddr_t mjclbase;
+static u_char *mjclrefcnt;
+static union mjcluster *mjclfree;
+
+#define	mjtocl(x)	(((uintptr_t)(x) - (uintptr_t)mjclbase) / MJUM9BYTES)
+
+/*
+ * Set up the jumbo cluster pool.  The area must provide space for
+ * nmbjumbo9 clusters followed by nmbjumbo9 reference counts.
+ */
+void
+m_jclinit(caddr_t p, uint32_t n)
+{
+	uint32_t i;
+
+	mjclbase = p;
+	mjclrefcnt = (u_char *)(p + n * MJUM9BYTES);
+	bzero(mjclrefcnt, n);
+	for (i = 0; i < n; i++) {
+		((union mjcluster *)p)->mjcl_next = mjclfree;
+		mjclfree = (union mjcluster *)p;
+		p += MJUM9BYTES;
+	}
+	nmbjumbo9 = n;
+	mbstat.m_jclusters = n;
+	mbstat.m_jclfree = n;
+}
+
+static void
+m_jclref(caddr_t p, u_int size)
+{
+	++mjclrefcnt[mjtocl(p)];
+}
+
+static void
+m_jclfree(caddr_t p, u_int size)
+{
+	if (--mjclrefcnt[mjtocl(p)] == 0) {
+		((union mjcluster *)p)->mjcl_next = mjclfree;
+		mjclfree = (union mjcluster *)p;
+		mbstat.m_jclfree++;
+	}
+}
+
+/*
+ * Allocate an mbuf with a cluster of the specified size attached.  The
+ * size must be MCLBYTES or MJUM9BYTES.  Jumbo cluster allocations never
+ * wait since drivers replenish their receive rings with them.
+ */
+struct mbuf *
+m_getjcl(int how, int type, int flags, int size)
+{
+	struct mbuf *m;
+	union mjcluster *p;
+
+	if (flags & M_PKTHDR) {
+		MGETHDR(m, how, type);
+	} else {
+		MGET(m, how, type);
+	}
+	if (m == NULL)
+		return (NULL);
+
+	if (size == MCLBYTES) {
+		MCLGET(m, how);
+		if ((m->m_flags & M_EXT) == 0) {
+			(void) m_free(m);
+			return (NULL);
+		}
+		return (m);
+	}
+
+	if (size != MJUM9BYTES || (p = mjclfree) == NULL) {
+		if (size == MJUM9BYTES)
+			mbstat.m_drops++;
+		(void) m_free(m);
+		return (NULL);
+	}
+
+	mjclfree = p->mjcl_next;
+	++mjclrefcnt[mjtocl(p)];
+	mbstat.m_jclfree--;
+	MBSTAT_HIWAT(m_jclhiwat, mbstat.m_jclusters - mbstat.m_jclfree);
+	m->m_ext.ext_buf = (caddr_t)p;
+	m->m_ext.ext_free = m_jclfree;
+	m->m_ext.ext_ref = m_jclref;
+	m->m_ext.ext_size = MJUM9BYTES;
+	m->m_data = m->m_ext.ext_buf;
+	m->m_flags |= M_EXT;
+	return (m);
+}
+
 /*
  * Space allocation routines.
  * These are also available as macros
@@ -125,7 +125,8 @@ sofree(struct socket *so)
 {
 	struct socket *head = so->so_head;
 
-	if (so->so_pcb || (so->so_state & SS_NOFDREF) == 0)
+	if (so->so_count > 0 || so->so_pcb ||
+	    (so->so_state & SS_NOFDREF) == 0)
 		return;
 	if (head != NULL) {
 		if (so->so_state & SS_INCOMP) {
@@ -831,6 +832,7 @@ sorflush(struct socket *so)
 	sbunlock(sb);
 	asb = *sb;
 	bzero((caddr_t)sb, sizeof (*sb));
+	sb->sb_note = asb.sb_note;	/* knotes stay attached */
 	splx(s);
 	if (pr->pr_flags & PR_RIGHTS && pr->pr_domain->dom_dispose)
 		(*pr->pr_domain->dom_dispose)(asb.sb_mb);
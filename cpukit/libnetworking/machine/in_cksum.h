@@ -292,4 +292,20 @@ u_int in_cksum_hdr(const struct ip *);
 
 #endif
 
+/*
+ * Sum three 32-bit values in network byte order, e.g. the addresses and
+ * htons(length + protocol) of a TCP or UDP pseudo header.  The result is
+ * the folded 16-bit sum, not its complement.
+ */
+static __inline u_short
+in_pseudo(uint32_t a, uint32_t b, uint32_t c)
+{
+	uint64_t sum = (uint64_t) a + b + c;
+
+	sum = (sum & 0xffff) + ((sum >> 16) & 0xffff) + (sum >> 32);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	return ((u_short) sum);
+}
+
 #endif /* _MACHINE_IN_CKSUM_H_ */
@@ -510,6 +510,11 @@ ifioctl(struct socket *so, u_long cmd, caddr_t data, struct proc *p)
 		ifr->ifr_phys = ifp->if_physical;
 		break;
 
+	case SIOCGIFCAP:
+		ifr->ifr_reqcap = ifp->if_capabilities;
+		ifr->ifr_curcap = ifp->if_capenable;
+		break;
+
 	case SIOCSIFFLAGS:
 		error = suser(p->p_ucred, &p->p_acflag);
 		if (error)
@@ -550,6 +555,19 @@ ifioctl(struct socket *so, u_long cmd, caddr_t data, struct proc *p)
 			microtime(&ifp->if_lastchange);
 		return(error);
 
+	case SIOCSIFCAP:
+		error = suser(p->p_ucred, &p->p_acflag);
+		if (error)
+			return (error);
+		if (ifp->if_ioctl == NULL)
+			return (EOPNOTSUPP);
+		if (ifr->ifr_reqcap & ~ifp->if_capabilities)
+			return (EINVAL);
+		error = (*ifp->if_ioctl)(ifp, cmd, data);
+		if (error == 0)
+			microtime(&ifp->if_lastchange);
+		return (error);
+
 	case SIOCSIFMTU:
 		error = suser(p->p_ucred, &p->p_acflag);
 		if (error)
@@ -142,6 +142,19 @@ struct if_data {
 #define	IFF_NEEDSGIANT	0x100000	/* hold Giant over if_start calls */
 
 /* flags set internally only: */
+/*
+ * Capabilities that interfaces can advertise.
+ *
+ * if_capabilities tells what the interface is able to do, if_capenable what
+ * is enabled.  The driver keeps the CSUM_* work it takes over from the
+ * protocols in if_hwassist in line with if_capenable.
+ */
+#define	IFCAP_RXCSUM	0x0001	/* can verify checksums on RX */
+#define	IFCAP_TXCSUM	0x0002	/* can compute checksums on TX */
+#define	IFCAP_TSO4	0x0100	/* can segment TCP/IPv4 packets */
+
+#define	IFCAP_HWCSUM	(IFCAP_RXCSUM | IFCAP_TXCSUM)
+
 #define	IFF_CANTCHANGE \
 	(IFF_BROADCAST|IFF_POINTOPOINT|IFF_RUNNING|IFF_OACTIVE|\
 	    IFF_SIMPLEX|IFF_MULTICAST|IFF_ALLMULTI|IFF_SMART|IFF_PROMISC|\
@@ -213,6 +226,7 @@ struct	ifreq {
 		int32_t	ifru_mtu;
 		int	ifru_phys;
 		int	ifru_media;
+		int	ifru_cap[2];
 		caddr_t	ifru_data;
 		int	(*ifru_tap)(struct ifnet *, struct ether_header *, struct mbuf *);
 	} ifr_ifru;
@@ -225,6 +239,8 @@ struct	ifreq {
 #define	ifr_mtu		ifr_ifru.ifru_mtu	/* mtu */
 #define ifr_phys	ifr_ifru.ifru_phys	/* physical wire */
 #define ifr_media	ifr_ifru.ifru_media	/* physical media */
+#define	ifr_reqcap	ifr_ifru.ifru_cap[0]	/* requested capabilities */
+#define	ifr_curcap	ifr_ifru.ifru_cap[1]	/* current capabilities */
 #define	ifr_data	ifr_ifru.ifru_data	/* for use by interface */
 #define ifr_tap		ifr_ifru.ifru_tap	/* tap function */
 };
@@ -300,6 +300,18 @@ bad:
 	return (error);
 }
 
+/*
+ * Wake up the network daemon only for the first frame of a burst, it empties
+ * the whole input queue.  The frames received by a poll of the network daemon
+ * are processed after the poll.
+ */
+#define	ETHER_SCHEDNETISR(ifp, isr, inq) \
+	do { \
+		if (((ifp)->if_flags & IFF_POLLING) == 0 && \
+		    (inq)->ifq_len == 0) \
+			schednetisr(isr); \
+	} while (0)
+
 /*
  * Process a received Ethernet packet;
  * the packet is in the mbuf chain m without
@@ -342,13 +354,13 @@ ether_input(struct ifnet *ifp, struct ether_header *eh, struct mbuf *m)
 	switch (ether_type) {
 #ifdef INET
 	case ETHERTYPE_IP:
-		schednetisr(NETISR_IP);
 		inq = &ipintrq;
+		ETHER_SCHEDNETISR(ifp, NETISR_IP, inq);
 		break;
 
 	case ETHERTYPE_ARP:
-		schednetisr(NETISR_ARP);
 		inq = &arpintrq;
+		ETHER_SCHEDNETISR(ifp, NETISR_ARP, inq);
 		break;
 #endif
 #ifdef IPX
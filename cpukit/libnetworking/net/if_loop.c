@@ -97,8 +97,28 @@ static void lortrequest(int, struct rtentry *, struct sockaddr *);
 #define LOMTU	16384
 #endif
 
+/*
+ * The data never leaves memory, so the loopback interface can take over all
+ * checksums and TCP segmentation.  It is the reference for drivers with
+ * IFCAP_HWCSUM and IFCAP_TSO4.  With link0 set the TCP segmentation is left
+ * to the software fallback of ip_output().
+ */
+#define	LO_CSUM_FEATURES	(CSUM_IP | CSUM_TCP | CSUM_UDP)
+#define	LO_CAPABILITIES		(IFCAP_HWCSUM | IFCAP_TSO4)
+
 struct	ifnet loif[NLOOP];
 
+static void
+losetcap(struct ifnet *ifp, int capenable)
+{
+	ifp->if_capenable = capenable;
+	ifp->if_hwassist = 0;
+	if (capenable & IFCAP_TXCSUM)
+		ifp->if_hwassist |= LO_CSUM_FEATURES;
+	if ((capenable & IFCAP_TSO4) && (ifp->if_flags & IFF_LINK0) == 0)
+		ifp->if_hwassist |= CSUM_TSO;
+}
+
 void
 rtems_bsdnet_initialize_loop(void)
 {
@@ -111,6 +131,8 @@ rtems_bsdnet_initialize_loop(void)
 	    ifp->if_unit = i++;
 	    ifp->if_mtu = LOMTU;
 	    ifp->if_flags = IFF_LOOPBACK | IFF_MULTICAST;
+	    ifp->if_capabilities = LO_CAPABILITIES;
+	    losetcap(ifp, LO_CAPABILITIES);
 	    ifp->if_ioctl = loioctl;
 	    ifp->if_output = looutput;
 	    ifp->if_type = IFT_LOOP;
@@ -163,6 +185,20 @@ looutput(struct ifnet *ifp, struct mbuf *m, struct sockaddr *dst,
 #endif
 	m->m_pkthdr.rcvif = ifp;
 
+	/*
+	 * Turn the checksums left to the interface into verified ones.  This
+	 * also applies to the copies of ip_mloopback() for other interfaces.
+	 */
+	if ((m->m_pkthdr.csum_flags & CSUM_DELAY_DATA) ||
+	    (ifp->if_capenable & IFCAP_RXCSUM)) {
+		m->m_pkthdr.csum_data = 0xffff;
+		m->m_pkthdr.csum_flags = CSUM_DATA_VALID | CSUM_PSEUDO_HDR |
+		    CSUM_IP_CHECKED | CSUM_IP_VALID;
+	} else if (m->m_pkthdr.csum_flags & CSUM_DELAY_IP)
+		m->m_pkthdr.csum_flags = CSUM_IP_CHECKED | CSUM_IP_VALID;
+	else
+		m->m_pkthdr.csum_flags = 0;
+
 	if (rt && rt->rt_flags & (RTF_REJECT|RTF_BLACKHOLE)) {
 		m_freem(m);
 		return (rt->rt_flags & RTF_BLACKHOLE ? 0 :
@@ -274,7 +310,12 @@ loioctl(struct ifnet *ifp, ioctl_command_t cmd, caddr_t data)
 		ifp->if_mtu = ifr->ifr_mtu;
 		break;
 
+	case SIOCSIFCAP:
+		losetcap(ifp, ifr->ifr_reqcap);
+		break;
+
 	case SIOCSIFFLAGS:
+		losetcap(ifp, ifp->if_capenable);
 		break;
 
 	default:
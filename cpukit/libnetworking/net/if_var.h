@@ -106,6 +106,9 @@ struct ifnet {
 	short	if_unit;		/* sub-unit for lower level driver */
 	short	if_timer;		/* time 'til if_watchdog called */
 	int	if_flags;		/* up/down, broadcast, etc. */
+	int	if_capabilities;	/* interface capabilities (IFCAP_*) */
+	int	if_capenable;		/* enabled capabilities (IFCAP_*) */
+	int	if_hwassist;		/* offloaded work (CSUM_*) */
 	void	*if_linkmib;		/* link-type-specific MIB data */
 	size_t	if_linkmiblen;		/* length of above data */
 	struct	if_data if_data;
@@ -133,6 +136,7 @@ struct ifnet {
 		(struct ifnet *, struct ether_header *, struct mbuf *);
 	struct	ifqueue if_snd;		/* output queue */
 	struct	ifqueue *if_poll_slowq;	/* input queue for slow devices */
+	volatile int if_pollreq;	/* receive poll requested */
 };
 
 typedef void if_init_f_t(void *);
@@ -59,6 +59,7 @@
 #define	NETISR_IPX	23		/* same as AF_IPX */
 #define	NETISR_USB	25		/* USB soft interrupt */
 #define	NETISR_PPP	26		/* PPP soft interrupt */
+#define	NETISR_POLL	28		/* receive polling */
 
 #ifndef LOCORE
 #ifdef _KERNEL
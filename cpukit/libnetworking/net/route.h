@@ -114,6 +114,7 @@ struct rtentry {
 	caddr_t	rt_llinfo;		/* pointer to link level info cache */
 	struct	rtentry *rt_gwroute;	/* implied entry for gatewayed routes */
 	struct	rtentry *rt_parent; 	/* cloning parent of this route */
+	struct	rtentry *rt_hashnext;	/* host route hash chain of the FIB */
 };
 
 /*
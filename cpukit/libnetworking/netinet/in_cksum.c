@@ -74,111 +74,113 @@
  *
  * This routine is very heavily used in the network
  * code and should be modified for each CPU to be as fast as possible.
+ *
+ * The data is summed a 32-bit word at a time into a 64-bit accumulator which
+ * cannot overflow for any mbuf, the carries are folded back at the end.
+ * Since 2^16 and 2^32 are both 1 modulo 0xffff this gives the same result as
+ * summing 16-bit words.  Unaligned data is brought to a word boundary first.
  */
 
-#define ADDCARRY(x)  (x > 65535L ? x -= 65535L : x)
-#define REDUCE \
-  {l_util.l = sum; sum = l_util.s[0] + l_util.s[1];  ADDCARRY(sum);}
+union in_cksum_util {
+	u_char	c[2];
+	u_short	s;
+};
+
+static uint32_t
+in_cksum_fold(uint64_t sum)
+{
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	return (uint32_t) sum;
+}
+
+/*
+ * Returns the folded 16-bit sum of the buffer as if it began on an even
+ * offset of the packet.
+ */
+static uint32_t
+in_cksum_buf(const u_char *p, int len)
+{
+	uint64_t sum = 0;
+	const uint32_t *w;
+	union in_cksum_util u;
+	int odd = (int) ((uintptr_t) p & 1);
+	uint32_t s;
+
+	if (odd && len > 0) {
+		/*
+		 * Sum the bytes shifted by one and swap the result at the
+		 * end, the first byte is the second half of a word.
+		 */
+		u.c[0] = 0;
+		u.c[1] = *p++;
+		sum += u.s;
+		len--;
+	}
+	if (((uintptr_t) p & 2) && len >= 2) {
+		sum += *(const u_short *) p;
+		p += 2;
+		len -= 2;
+	}
+	w = (const uint32_t *) p;
+	while (len >= 32) {
+		sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
+		sum += w[4]; sum += w[5]; sum += w[6]; sum += w[7];
+		w += 8;
+		len -= 32;
+	}
+	while (len >= 4) {
+		sum += *w++;
+		len -= 4;
+	}
+	p = (const u_char *) w;
+	if (len >= 2) {
+		sum += *(const u_short *) p;
+		p += 2;
+		len -= 2;
+	}
+	if (len > 0) {
+		u.c[0] = *p;
+		u.c[1] = 0;
+		sum += u.s;
+	}
+	s = in_cksum_fold(sum);
+	if (odd)
+		s = ((s << 8) | (s >> 8)) & 0xffff;
+	return (s);
+}
 
 int
 in_cksum(
 	struct mbuf *m,
 	uint32_t len )
 {
-	register u_short *w;
-	register int32_t sum = 0;
-	register int32_t mlen = 0;
-	int byte_swapped = 0;
-
-	union {
-		char	c[2];
-		u_short	s;
-	} s_util;
-	union {
-		u_short s[2];
-		long	l;
-	} l_util;
+	uint64_t sum = 0;
+	uint32_t s;
+	int32_t mlen;
+	int odd = 0;
 
 	for (;m && len; m = m->m_next) {
 		if (m->m_len == 0)
 			continue;
-		w = mtod(m, u_short *);
-		if (mlen == -1) {
-			/*
-			 * The first byte of this mbuf is the continuation
-			 * of a word spanning between this mbuf and the
-			 * last mbuf.
-			 *
-			 * s_util.c[0] is already saved when scanning previous
-			 * mbuf.
-			 */
-			s_util.c[1] = *(char *)w;
-			sum += s_util.s;
-			w = (u_short *)((char *)w + 1);
-			mlen = m->m_len - 1;
-			len--;
-		} else
-			mlen = m->m_len;
+		mlen = m->m_len;
 		if (len < mlen)
 			mlen = len;
 		len -= mlen;
+		s = in_cksum_buf(mtod(m, const u_char *), mlen);
 		/*
-		 * Force to even boundary.
-		 */
-		if ((1 & (intptr_t) w) && (mlen > 0)) {
-			REDUCE;
-			sum <<= 8;
-			s_util.c[0] = *(u_char *)w;
-			w = (u_short *)((char *)w + 1);
-			mlen--;
-			byte_swapped = 1;
-		}
-		/*
-		 * Unroll the loop to make overhead from
-		 * branches &c small.
+		 * A buffer starting on an odd offset of the packet has its
+		 * bytes in the other halves of the words.
 		 */
-		while ((mlen -= 32) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			sum += w[4]; sum += w[5]; sum += w[6]; sum += w[7];
-			sum += w[8]; sum += w[9]; sum += w[10]; sum += w[11];
-			sum += w[12]; sum += w[13]; sum += w[14]; sum += w[15];
-			w += 16;
-		}
-		mlen += 32;
-		while ((mlen -= 8) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			w += 4;
-		}
-		mlen += 8;
-		if (mlen == 0 && byte_swapped == 0)
-			continue;
-		REDUCE;
-		while ((mlen -= 2) >= 0) {
-			sum += *w++;
-		}
-		if (byte_swapped) {
-			REDUCE;
-			sum <<= 8;
-			byte_swapped = 0;
-			if (mlen == -1) {
-				s_util.c[1] = *(char *)w;
-				sum += s_util.s;
-				mlen = 0;
-			} else
-				mlen = -1;
-		} else if (mlen == -1)
-			s_util.c[0] = *(char *)w;
+		if (odd)
+			s = ((s << 8) | (s >> 8)) & 0xffff;
+		sum += s;
+		odd ^= mlen & 1;
 	}
 	if (len)
 		puts("cksum: out of data");
-	if (mlen == -1) {
-		/* The last mbuf has odd # of bytes. Follow the
-		   standard (the odd byte may be shifted left by 8 bits
-		   or not as determined by endian-ness of the machine) */
-		s_util.c[1] = 0;
-		sum += s_util.s;
-	}
-	REDUCE;
-	return (~sum & 0xffff);
+	return (~in_cksum_fold(sum) & 0xffff);
 }
 #endif
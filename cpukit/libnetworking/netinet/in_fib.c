@@ -0,0 +1,451 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+/*
+ * IPv4 forwarding information base.
+ *
+ * The radix tree stays the authoritative routing table.  It is mirrored into
+ * two structures which answer longest prefix matches with a few memory
+ * accesses:
+ *
+ *  1) The host routes (no netmask or a /32 netmask) are kept in a hash table.
+ *     These are mostly the ARP entries and the cloned routes and change
+ *     often.  The hash table is updated immediately.
+ *
+ *  2) The network routes are flattened into a sorted table of disjoint
+ *     address ranges.  Each range refers to the most specific route which
+ *     covers it.  A direct index on the most significant address bits selects
+ *     the few ranges which need a binary search.  Changes of network routes
+ *     mark the table as dirty and rebuild it one tick later from the radix
+ *     tree, so that the bulk load of a routing daemon via the routing socket
+ *     triggers only one rebuild.
+ *
+ * A published range table is never modified, the rebuild replaces it.  While
+ * it is dirty and while routes with non-contiguous netmasks exist, lookups
+ * use the radix tree.  Like the rest of the stack everything here runs under
+ * the network semaphore.
+ *
+ * The IP forwarding cache is invalidated as a whole through in_fib_gen only
+ * if a network route changes.  A host route affects the lookup of its own
+ * destination only, so just that cache entry is invalidated.  This keeps the
+ * cache intact while ARP adds and expires its entries.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/param.h>
+#include <sys/systm.h>
+#include <sys/kernel.h>
+#include <sys/malloc.h>
+#include <sys/sysctl.h>
+#include <sys/socket.h>
+
+#include <net/if.h>
+#include <net/route.h>
+#include <netinet/in.h>
+#include <netinet/in_systm.h>
+#include <netinet/in_var.h>
+#include <netinet/ip.h>
+#include <netinet/ip_var.h>
+
+#define	satosin(sa)	((struct sockaddr_in *)(sa))
+
+/* Smallest and largest number of bits of the direct index */
+#define	IN_FIB_MINBITS	8
+#define	IN_FIB_MAXBITS	16
+
+#define	IN_FIB_MINHOSTHASH	64
+
+#define	IN_FIB_HOSTHASH(a, mask) \
+	(((a) ^ ((a) >> 8) ^ ((a) >> 16) ^ ((a) >> 24)) & (mask))
+
+struct in_fib_range {
+	uint32_t	 fr_start;	/* first address, host byte order */
+	struct rtentry	*fr_rt;		/* most specific route or NULL */
+};
+
+struct in_fib_table {
+	int		 ft_shift;	/* 32 minus the bits of the index */
+	u_int		 ft_nranges;
+	uint32_t	*ft_dir;	/* range containing the chunk start */
+	struct in_fib_range *ft_ranges;
+};
+
+struct in_fib_prefix {
+	uint32_t	 fp_start;
+	uint32_t	 fp_end;
+	int		 fp_len;
+	struct rtentry	*fp_rt;
+};
+
+struct in_fib_walkarg {
+	struct in_fib_prefix *fw_prefixes;
+	u_int		 fw_count;
+	u_int		 fw_max;
+};
+
+struct	in_fibstat in_fibstat;
+u_long	in_fib_gen;
+
+static int in_fib_enable = 1;
+SYSCTL_INT(_net_inet_ip, OID_AUTO, fib, CTLFLAG_RW,
+	&in_fib_enable, 0, "Use the IPv4 forwarding information base");
+
+static struct in_fib_table *in_fib_table;
+static int in_fib_dirty = 1;
+static int in_fib_scheduled;
+static u_int in_fib_netcount;	/* network routes in the radix tree */
+static u_int in_fib_missing;	/* routes the FIB cannot represent */
+
+static struct rtentry **in_fib_hosthash;
+static u_int in_fib_hostmask;
+static u_int in_fib_hostcount;
+
+static void in_fib_rebuild(void *);
+
+/*
+ * Return the prefix length of a netmask or -1 if it is not contiguous.  The
+ * radix tree shortens netmasks to their significant bytes.
+ */
+static int
+in_fib_masklen(struct sockaddr *sa)
+{
+	u_char *p;
+	uint32_t m = 0;
+	int i, len;
+
+	if (sa == NULL)
+		return (32);
+	p = (u_char *)&satosin(sa)->sin_addr;
+	for (i = 0; i < 4; i++) {
+		m <<= 8;
+		if (p + i < (u_char *)sa + sa->sa_len)
+			m |= p[i];
+	}
+	if ((~m & (~m + 1)) != 0)
+		return (-1);
+	for (len = 0; m != 0; m <<= 1)
+		len++;
+	return (len);
+}
+
+static void
+in_fib_schedule(void)
+{
+	in_fib_dirty = 1;
+	if (!in_fib_scheduled) {
+		in_fib_scheduled = 1;
+		timeout(in_fib_rebuild, NULL, 1);
+	}
+}
+
+static void
+in_fib_hostresize(u_int size)
+{
+	struct rtentry **hash;
+	u_int i;
+
+	hash = malloc(size * sizeof(*hash), M_RTABLE, M_NOWAIT);
+	if (hash == NULL)
+		return;
+	bzero(hash, size * sizeof(*hash));
+	for (i = 0; in_fib_hosthash != NULL && i <= in_fib_hostmask; i++) {
+		struct rtentry *rt = in_fib_hosthash[i];
+
+		while (rt != NULL) {
+			struct rtentry *next = rt->rt_hashnext;
+			uint32_t a = satosin(rt_key(rt))->sin_addr.s_addr;
+			u_int h = IN_FIB_HOSTHASH(a, size - 1);
+
+			rt->rt_hashnext = hash[h];
+			hash[h] = rt;
+			rt = next;
+		}
+	}
+	if (in_fib_hosthash != NULL)
+		free(in_fib_hosthash, M_RTABLE);
+	in_fib_hosthash = hash;
+	in_fib_hostmask = size - 1;
+}
+
+/*
+ * A route was added to the radix tree.
+ */
+void
+in_fib_add(struct rtentry *rt)
+{
+	int len = in_fib_masklen(rt_mask(rt));
+
+	if (len < 0) {
+		in_fib_gen++;
+		in_fib_missing++;
+	} else if (len == 32) {
+		uint32_t a = satosin(rt_key(rt))->sin_addr.s_addr;
+		u_int h;
+
+		ip_forward_invalidate(satosin(rt_key(rt))->sin_addr);
+		if (in_fib_hosthash == NULL ||
+		    in_fib_hostcount > 2 * (in_fib_hostmask + 1))
+			in_fib_hostresize(in_fib_hosthash == NULL ?
+			    IN_FIB_MINHOSTHASH : 2 * (in_fib_hostmask + 1));
+		if (in_fib_hosthash == NULL) {
+			in_fib_missing++;
+			return;
+		}
+		h = IN_FIB_HOSTHASH(a, in_fib_hostmask);
+		rt->rt_hashnext = in_fib_hosthash[h];
+		in_fib_hosthash[h] = rt;
+		in_fib_hostcount++;
+	} else {
+		in_fib_gen++;
+		in_fib_netcount++;
+		in_fib_schedule();
+	}
+}
+
+/*
+ * A route was removed from the radix tree.
+ */
+void
+in_fib_delete(struct rtentry *rt)
+{
+	int len = in_fib_masklen(rt_mask(rt));
+
+	if (len < 0) {
+		in_fib_gen++;
+		in_fib_missing--;
+	} else if (len == 32) {
+		uint32_t a = satosin(rt_key(rt))->sin_addr.s_addr;
+		struct rtentry **p;
+
+		ip_forward_invalidate(satosin(rt_key(rt))->sin_addr);
+		if (in_fib_hosthash != NULL) {
+			p = &in_fib_hosthash[IN_FIB_HOSTHASH(a,
+			    in_fib_hostmask)];
+			for (; *p != NULL; p = &(*p)->rt_hashnext) {
+				if (*p == rt) {
+					*p = rt->rt_hashnext;
+					rt->rt_hashnext = NULL;
+					in_fib_hostcount--;
+					return;
+				}
+			}
+		}
+		in_fib_missing--;
+	} else {
+		in_fib_gen++;
+		in_fib_netcount--;
+		in_fib_schedule();
+	}
+}
+
+static int
+in_fib_collect(struct radix_node *rn, void *arg)
+{
+	struct in_fib_walkarg *w = arg;
+	struct rtentry *rt = (struct rtentry *)rn;
+	struct in_fib_prefix *fp;
+	int len = in_fib_masklen(rt_mask(rt));
+
+	if (len < 0 || len == 32)
+		return (0);
+	if (w->fw_count >= w->fw_max)
+		return (ENOBUFS);
+	fp = &w->fw_prefixes[w->fw_count++];
+	fp->fp_len = len;
+	fp->fp_start = ntohl(satosin(rt_key(rt))->sin_addr.s_addr);
+	if (len > 0)
+		fp->fp_start &= ~(uint32_t)0 << (32 - len);
+	else
+		fp->fp_start = 0;
+	fp->fp_end = fp->fp_start | (len > 0 ?
+	    ~(~(uint32_t)0 << (32 - len)) : ~(uint32_t)0);
+	fp->fp_rt = rt;
+	return (0);
+}
+
+/*
+ * Order by start address, covering prefixes first.
+ */
+static int
+in_fib_prefixcmp(const void *a, const void *b)
+{
+	const struct in_fib_prefix *pa = a;
+	const struct in_fib_prefix *pb = b;
+
+	if (pa->fp_start != pb->fp_start)
+		return (pa->fp_start < pb->fp_start ? -1 : 1);
+	return (pa->fp_len - pb->fp_len);
+}
+
+/*
+ * Let the range table continue at address a with route rt.  Adjacent ranges
+ * of the same route are merged.
+ */
+static void
+in_fib_emit(struct in_fib_range *r, u_int *n, uint32_t a, struct rtentry *rt)
+{
+	struct in_fib_range *last = &r[*n - 1];
+
+	if (last->fr_start == a) {
+		last->fr_rt = rt;
+		if (*n > 1 && last[-1].fr_rt == rt)
+			--*n;
+	} else if (last->fr_rt != rt) {
+		r[*n].fr_start = a;
+		r[*n].fr_rt = rt;
+		++*n;
+	}
+}
+
+/*
+ * Flatten the sorted prefixes into disjoint ranges.  The prefixes nest, so
+ * the covering prefixes of the current position form a stack.
+ */
+static u_int
+in_fib_flatten(struct in_fib_prefix *fp, u_int count,
+    struct in_fib_prefix **stack, struct in_fib_range *r)
+{
+	u_int i, n = 1, top = 0;
+
+	r[0].fr_start = 0;
+	r[0].fr_rt = NULL;
+	for (i = 0; i <= count; i++) {
+		while (top > 0 &&
+		    (i == count || stack[top - 1]->fp_end < fp[i].fp_start)) {
+			struct in_fib_prefix *done = stack[--top];
+
+			if (done->fp_end != ~(uint32_t)0)
+				in_fib_emit(r, &n, done->fp_end + 1, top > 0 ?
+				    stack[top - 1]->fp_rt : NULL);
+		}
+		if (i < count) {
+			in_fib_emit(r, &n, fp[i].fp_start, fp[i].fp_rt);
+			stack[top++] = &fp[i];
+		}
+	}
+	return (n);
+}
+
+static void
+in_fib_rebuild(void *arg)
+{
+	struct radix_node_head *rnh = rt_tables[AF_INET];
+	struct in_fib_walkarg w;
+	struct in_fib_prefix **stack;
+	struct in_fib_range *r;
+	struct in_fib_table *t;
+	u_int n, i, chunk, nchunks;
+	int bits;
+
+	in_fib_scheduled = 0;
+	if (!in_fib_dirty || rnh == NULL)
+		return;
+
+	w.fw_max = in_fib_netcount;
+	w.fw_count = 0;
+	w.fw_prefixes = malloc((w.fw_max + 1) * (sizeof(*w.fw_prefixes) +
+	    sizeof(*stack) + 2 * sizeof(*r)), M_TEMP, M_NOWAIT);
+	if (w.fw_prefixes == NULL) {
+		in_fib_schedule();
+		return;
+	}
+	stack = (struct in_fib_prefix **)&w.fw_prefixes[w.fw_max + 1];
+	r = (struct in_fib_range *)&stack[w.fw_max + 1];
+	if (rnh->rnh_walktree(rnh, in_fib_collect, &w) != 0) {
+		free(w.fw_prefixes, M_TEMP);
+		in_fib_schedule();
+		return;
+	}
+	qsort(w.fw_prefixes, w.fw_count, sizeof(*w.fw_prefixes),
+	    in_fib_prefixcmp);
+	n = in_fib_flatten(w.fw_prefixes, w.fw_count, stack, r);
+
+	/* Aim at about one range per chunk of the direct index */
+	for (bits = IN_FIB_MINBITS; bits < IN_FIB_MAXBITS &&
+	    (1U << bits) < n; bits++)
+		;
+	nchunks = 1U << bits;
+	t = malloc(sizeof(*t) + (nchunks + 2) * sizeof(*t->ft_dir) +
+	    n * sizeof(*t->ft_ranges), M_RTABLE, M_NOWAIT);
+	if (t == NULL) {
+		free(w.fw_prefixes, M_TEMP);
+		in_fib_schedule();
+		return;
+	}
+	t->ft_shift = 32 - bits;
+	t->ft_nranges = n;
+	t->ft_dir = (uint32_t *)(t + 1);
+	/* Keep the ranges aligned for 64-bit pointers */
+	t->ft_ranges = (struct in_fib_range *)&t->ft_dir[nchunks + 2];
+	bcopy(r, t->ft_ranges, n * sizeof(*r));
+	for (chunk = 0, i = 0; chunk < nchunks; chunk++) {
+		uint32_t a = chunk << t->ft_shift;
+
+		while (i + 1 < n && r[i + 1].fr_start <= a)
+			i++;
+		t->ft_dir[chunk] = i;
+	}
+	t->ft_dir[nchunks] = n - 1;
+	free(w.fw_prefixes, M_TEMP);
+
+	if (in_fib_table != NULL)
+		free(in_fib_table, M_RTABLE);
+	in_fib_table = t;
+	in_fib_dirty = 0;
+	in_fibstat.fs_rebuilds++;
+	in_fibstat.fs_prefixes = w.fw_count;
+	in_fibstat.fs_ranges = n;
+}
+
+/*
+ * The rnh_matchaddr() of the IPv4 routing table.
+ */
+struct radix_node *
+in_fib_match(void *v_arg, struct radix_node_head *head)
+{
+	uint32_t a = satosin(v_arg)->sin_addr.s_addr;
+	struct in_fib_table *t = in_fib_table;
+	struct rtentry *rt;
+	u_int lo, hi;
+
+	if (!in_fib_enable || in_fib_missing != 0) {
+		in_fibstat.fs_fallbacks++;
+		return (rn_match(v_arg, head));
+	}
+	if (in_fib_hosthash != NULL) {
+		rt = in_fib_hosthash[IN_FIB_HOSTHASH(a, in_fib_hostmask)];
+		for (; rt != NULL; rt = rt->rt_hashnext) {
+			if (satosin(rt_key(rt))->sin_addr.s_addr == a) {
+				in_fibstat.fs_hosthits++;
+				return (rt->rt_nodes);
+			}
+		}
+	}
+	if (in_fib_dirty) {
+		in_fibstat.fs_fallbacks++;
+		return (rn_match(v_arg, head));
+	}
+	a = ntohl(a);
+	lo = t->ft_dir[a >> t->ft_shift];
+	hi = t->ft_dir[(a >> t->ft_shift) + 1];
+	while (lo < hi) {
+		u_int mid = (lo + hi + 1) / 2;
+
+		if (t->ft_ranges[mid].fr_start <= a)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	rt = t->ft_ranges[lo].fr_rt;
+	in_fibstat.fs_lookups++;
+	return (rt != NULL ? rt->rt_nodes : NULL);
+}
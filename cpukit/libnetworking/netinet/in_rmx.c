@@ -167,9 +167,24 @@ in_addroute(void *v_arg, void *n_arg, struct radix_node_head *head,
 			RTFREE(rt2);
 		}
 	}
+	if (ret != NULL)
+		in_fib_add(rt);
 	return ret;
 }
 
+/*
+ * Keep the forwarding information base in sync with the radix tree.
+ */
+static struct radix_node *
+in_delroute(void *v_arg, void *netmask_arg, struct radix_node_head *head)
+{
+	struct radix_node *rn = rn_delete(v_arg, netmask_arg, head);
+
+	if (rn != NULL)
+		in_fib_delete((struct rtentry *)rn);
+	return rn;
+}
+
 /*
  * This code is the inverse of in_clsroute: on first reference, if we
  * were managing the route, stop doing so and set the expiration timer
@@ -178,7 +193,7 @@ in_addroute(void *v_arg, void *n_arg, struct radix_node_head *head,
 static struct radix_node *
 in_matroute(void *v_arg, struct radix_node_head *head)
 {
-	struct radix_node *rn = rn_match(v_arg, head);
+	struct radix_node *rn = in_fib_match(v_arg, head);
 	struct rtentry *rt = (struct rtentry *)rn;
 
 	if(rt && rt->rt_refcnt == 0) { /* this is first reference */
@@ -378,6 +393,7 @@ in_inithead(void **head, int off)
 
 	rnh = *head;
 	rnh->rnh_addaddr = in_addroute;
+	rnh->rnh_deladdr = in_delroute;
 	rnh->rnh_matchaddr = in_matroute;
 	rnh->rnh_close = in_clsroute;
 	in_rtqtimo(rnh);	/* kick off timeout first time */
@@ -83,9 +83,22 @@ struct	in_aliasreq {
 #define IN_LNAOF(in, ifa) \
 	((ntohl((in).s_addr) & ~((struct in_ifaddr *)(ifa)->ia_subnetmask))
 
+/*
+ * Statistics of the IPv4 forwarding information base.
+ */
+struct	in_fibstat {
+	u_long	fs_lookups;		/* answered by the range table */
+	u_long	fs_hosthits;		/* answered by the host route hash */
+	u_long	fs_fallbacks;		/* answered by the radix tree */
+	u_long	fs_rebuilds;		/* range table rebuilds */
+	u_long	fs_prefixes;		/* network routes in the range table */
+	u_long	fs_ranges;		/* size of the range table */
+};
 
 #ifdef	_KERNEL
 extern	struct	in_ifaddr *in_ifaddr;
+extern	struct	in_fibstat in_fibstat;
+extern	u_long	in_fib_gen;		/* incremented by network route changes */
 extern	struct	ifqueue	ipintrq;		/* ip packet input queue */
 extern	struct	in_addr zeroin_addr;
 extern	u_char	inetctlerrmap[];
@@ -233,6 +246,12 @@ struct	in_multi *in_addmulti(struct in_addr *, struct ifnet *);
 void	in_delmulti(struct in_multi *);
 int	in_control(struct socket *, u_long, caddr_t, struct ifnet *);
 void	in_rtqdrain(void);
+struct	rtentry;
+struct	radix_node;
+struct	radix_node_head;
+void	in_fib_add(struct rtentry *);
+void	in_fib_delete(struct rtentry *);
+struct	radix_node *in_fib_match(void *, struct radix_node_head *);
 void	ip_input(struct mbuf *);
 
 #endif /* _KERNEL */
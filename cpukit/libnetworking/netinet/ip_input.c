@@ -228,7 +228,25 @@ ip_init(void)
 }
 
 static struct	sockaddr_in ipaddr = { sizeof(ipaddr), AF_INET, 0, {0}, {0} };
-static struct	route ipforward_rt;
+
+/*
+ * Direct mapped cache of the routes to recently forwarded destinations.  An
+ * entry is valid until the next network route is added or deleted or until
+ * a host route to its destination changes, see ip_forward_invalidate().
+ * Each entry holds a reference to its route, so ip_slowtimo() releases stale
+ * and idle entries; otherwise cloned routes would never expire.
+ */
+#define	IPFORWARD_CACHE	64
+#define	IPFORWARD_IDLE	(10 * PR_SLOWHZ)	/* slow timeouts */
+static struct ipforward_ent {
+	struct	route ife_ro;
+	u_long	ife_gen;		/* in_fib_gen of the lookup */
+	u_short	ife_idle;		/* slow timeouts since the last use */
+} ipforward_cache[IPFORWARD_CACHE];
+
+#define	IPFORWARD_ENT(dst) \
+	(&ipforward_cache[(ntohl((dst).s_addr) ^ \
+	    (ntohl((dst).s_addr) >> 16)) & (IPFORWARD_CACHE - 1)])
 
 /*
  * Ip input routine.  Checksum and byte swap header.  If fragmented
@@ -295,7 +313,9 @@ ip_input(struct mbuf *m)
 		}
 		ip = mtod(m, struct ip *);
 	}
-	if (hlen == sizeof(struct ip)) {
+	if (m->m_pkthdr.csum_flags & CSUM_IP_CHECKED) {
+		sum = !(m->m_pkthdr.csum_flags & CSUM_IP_VALID);
+	} else if (hlen == sizeof(struct ip)) {
 		sum = in_cksum_hdr(ip);
 	} else {
 		sum = in_cksum(m, hlen);
@@ -480,6 +500,11 @@ ours:
 	 * but it's not worth the time; just let them time out.)
 	 */
 	if (ip->ip_off &~ (IP_DF | IP_RF)) {
+		/*
+		 * A data sum reported by the interface covers this
+		 * fragment only.
+		 */
+		m->m_pkthdr.csum_flags &= ~(CSUM_DATA_VALID | CSUM_PSEUDO_HDR);
 		if (m->m_flags & M_EXT) {		/* XXX */
 			if ((m = m_pullup(m, sizeof (struct ip))) == 0) {
 				ipstat.ips_toosmall++;
@@ -596,6 +621,10 @@ bad:
 
 /*
  * IP software interrupt routine - to go away sometime soon
+ *
+ * Take the whole input queue at once and process it as a batch.  Packets
+ * queued in the meantime, e.g. by the loopback interface, are processed by
+ * the next batch.
  */
 void
 ipintr(void)
@@ -605,11 +634,19 @@ ipintr(void)
 
 	while(1) {
 		s = splimp();
-		IF_DEQUEUE(&ipintrq, m);
+		m = ipintrq.ifq_head;
+		ipintrq.ifq_head = ipintrq.ifq_tail = 0;
+		ipintrq.ifq_len = 0;
 		splx(s);
 		if (m == 0)
 			return;
-		ip_input(m);
+		while (m != 0) {
+			struct mbuf *next = m->m_nextpkt;
+
+			m->m_nextpkt = 0;
+			ip_input(m);
+			m = next;
+		}
 	}
 }
 
@@ -864,6 +901,21 @@ ip_slowtimo(void)
 			}
 		}
 	}
+
+	/*
+	 * Release the routes of stale and idle forwarding cache entries.
+	 */
+	for (i = 0; i < IPFORWARD_CACHE; i++) {
+		struct ipforward_ent *ife = &ipforward_cache[i];
+
+		if (ife->ife_ro.ro_rt == 0)
+			continue;
+		if (ife->ife_gen != in_fib_gen ||
+		    ++ife->ife_idle >= IPFORWARD_IDLE) {
+			RTFREE(ife->ife_ro.ro_rt);
+			ife->ife_ro.ro_rt = 0;
+		}
+	}
 	splx(s);
 }
 
@@ -1106,30 +1158,59 @@ bad:
 }
 
 /*
- * Given address of next destination (final or next hop),
- * return internet address info of interface to be used to get there.
+ * Return the cached route to a destination.
  */
-static struct in_ifaddr *
-ip_rtaddr(struct in_addr dst)
+static struct route *
+ip_forward_route(struct in_addr dst)
 {
-	struct sockaddr_in *sin;
-
-	sin = (struct sockaddr_in *) &ipforward_rt.ro_dst;
-
-	if (ipforward_rt.ro_rt == 0 || dst.s_addr != sin->sin_addr.s_addr) {
-		if (ipforward_rt.ro_rt) {
-			RTFREE(ipforward_rt.ro_rt);
-			ipforward_rt.ro_rt = 0;
+	struct ipforward_ent *ife = IPFORWARD_ENT(dst);
+	struct sockaddr_in *sin = (struct sockaddr_in *)&ife->ife_ro.ro_dst;
+
+	if (ife->ife_ro.ro_rt == 0 || dst.s_addr != sin->sin_addr.s_addr ||
+	    ife->ife_gen != in_fib_gen) {
+		if (ife->ife_ro.ro_rt) {
+			RTFREE(ife->ife_ro.ro_rt);
+			ife->ife_ro.ro_rt = 0;
 		}
 		sin->sin_family = AF_INET;
 		sin->sin_len = sizeof(*sin);
 		sin->sin_addr = dst;
 
-		rtalloc_ign(&ipforward_rt, RTF_PRCLONING);
+		rtalloc_ign(&ife->ife_ro, RTF_PRCLONING);
+		ife->ife_gen = in_fib_gen;
+	}
+	ife->ife_idle = 0;
+	return (&ife->ife_ro);
+}
+
+/*
+ * A host route to the destination was added or deleted.  Only the cache
+ * entry of this destination may refer to a different route now.
+ */
+void
+ip_forward_invalidate(struct in_addr dst)
+{
+	struct ipforward_ent *ife = IPFORWARD_ENT(dst);
+	struct sockaddr_in *sin = (struct sockaddr_in *)&ife->ife_ro.ro_dst;
+
+	if (ife->ife_ro.ro_rt && dst.s_addr == sin->sin_addr.s_addr) {
+		RTFREE(ife->ife_ro.ro_rt);
+		ife->ife_ro.ro_rt = 0;
 	}
-	if (ipforward_rt.ro_rt == 0)
+}
+
+/*
+ * Given address of next destination (final or next hop),
+ * return internet address info of interface to be used to get there.
+ */
+static struct in_ifaddr *
+ip_rtaddr(struct in_addr dst)
+{
+	struct route *ro = ip_forward_route(dst);
+
+	if (ro->ro_rt == 0)
 		return ((struct in_ifaddr *)0);
-	return ((struct in_ifaddr *) ipforward_rt.ro_rt->rt_ifa);
+	return ((struct in_ifaddr *) ro->ro_rt->rt_ifa);
 }
 
 /*
@@ -1283,7 +1364,7 @@ static void
 ip_forward(struct mbuf *m, int srcrt)
 {
 	struct ip *ip = mtod(m, struct ip *);
-	register struct sockaddr_in *sin;
+	struct route *ro;
 	register struct rtentry *rt;
 	int error, type = 0, code = 0;
 	struct mbuf *mcopy;
@@ -1310,23 +1391,10 @@ ip_forward(struct mbuf *m, int srcrt)
 	}
 	ip->ip_ttl -= IPTTLDEC;
 
-	sin = (struct sockaddr_in *)&ipforward_rt.ro_dst;
-	if ((rt = ipforward_rt.ro_rt) == 0 ||
-	    ip->ip_dst.s_addr != sin->sin_addr.s_addr) {
-		if (ipforward_rt.ro_rt) {
-			RTFREE(ipforward_rt.ro_rt);
-			ipforward_rt.ro_rt = 0;
-		}
-		sin->sin_family = AF_INET;
-		sin->sin_len = sizeof(*sin);
-		sin->sin_addr = ip->ip_dst;
-
-		rtalloc_ign(&ipforward_rt, RTF_PRCLONING);
-		if (ipforward_rt.ro_rt == 0) {
-			icmp_error(m, ICMP_UNREACH, ICMP_UNREACH_HOST, dest, 0);
-			return;
-		}
-		rt = ipforward_rt.ro_rt;
+	ro = ip_forward_route(ip->ip_dst);
+	if ((rt = ro->ro_rt) == 0) {
+		icmp_error(m, ICMP_UNREACH, ICMP_UNREACH_HOST, dest, 0);
+		return;
 	}
 
 	/*
@@ -1363,7 +1431,7 @@ ip_forward(struct mbuf *m, int srcrt)
 		}
 	}
 
-	error = ip_output(m, (struct mbuf *)0, &ipforward_rt, 
+	error = ip_output(m, (struct mbuf *)0, ro, 
 			  IP_FORWARDING, 0);
 	if (error)
 		ipstat.ips_cantforward++;
@@ -1399,8 +1467,8 @@ ip_forward(struct mbuf *m, int srcrt)
 	case EMSGSIZE:
 		type = ICMP_UNREACH;
 		code = ICMP_UNREACH_NEEDFRAG;
-		if (ipforward_rt.ro_rt)
-			destifp = ipforward_rt.ro_rt->rt_ifp;
+		if (ro->ro_rt)
+			destifp = ro->ro_rt->rt_ifp;
 		ipstat.ips_cantfrag++;
 		break;
 
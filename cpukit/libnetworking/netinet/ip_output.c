@@ -37,6 +37,8 @@
 
 #define _IP_VHL
 
+#include <stddef.h>
+
 #include <sys/param.h>
 #include <sys/queue.h>
 #include <sys/systm.h>
@@ -56,6 +58,7 @@
 #include <netinet/in_pcb.h>
 #include <netinet/in_var.h>
 #include <netinet/ip_var.h>
+#include <netinet/tcp.h>
 
 #include <machine/in_cksum.h>
 
@@ -97,7 +100,7 @@ ip_output(struct mbuf *m0, struct mbuf *opt, struct route *ro, int flags,
 	int len = 0, off, error = 0;
 	struct sockaddr_in *dst;
 	struct in_ifaddr *ia;
-	int isbroadcast;
+	int isbroadcast, sw_csum;
 
 #ifdef	DIAGNOSTIC
 	if ((m->m_flags & M_PKTHDR) == 0)
@@ -383,22 +386,57 @@ sendit:
 	}
 #endif /* COMPAT_IPFW */
 
+	/*
+	 * Do the checksums and the TCP segmentation in software which the
+	 * interface does not take over.
+	 */
+	m->m_pkthdr.csum_flags |= CSUM_IP;
+	sw_csum = m->m_pkthdr.csum_flags & ~ifp->if_hwassist;
+	if (sw_csum & CSUM_TSO) {
+		ip->ip_len = htons(ip->ip_len);
+		ip->ip_off = htons(ip->ip_off);
+		m = ip_gso(m, ifp->if_hwassist);
+		if (m == NULL) {
+			error = ENOBUFS;
+			ipstat.ips_odropped++;
+			goto done;
+		}
+		for (; m; m = m0) {
+			m0 = m->m_nextpkt;
+			m->m_nextpkt = 0;
+			if (error == 0)
+				error = (*ifp->if_output)(ifp, m,
+				    (struct sockaddr *)dst, ro->ro_rt);
+			else
+				m_freem(m);
+		}
+		goto done;
+	}
+	if (sw_csum & CSUM_DELAY_DATA) {
+		in_delayed_cksum(m);
+		sw_csum &= ~CSUM_DELAY_DATA;
+	}
+	m->m_pkthdr.csum_flags &= ifp->if_hwassist;
+
 	/*
 	 * If small enough for interface, or the interface will take
 	 * care of the fragmentation for us, we can just send directly.
 	 */
-	if ((u_short)ip->ip_len <= ifp->if_mtu) {
+	if ((u_short)ip->ip_len <= ifp->if_mtu ||
+	    (m->m_pkthdr.csum_flags & CSUM_TSO)) {
 		ip->ip_len = htons(ip->ip_len);
 		ip->ip_off = htons(ip->ip_off);
 		ip->ip_sum = 0;
+		if (sw_csum & CSUM_DELAY_IP) {
 #ifdef _IP_VHL
-		if (ip->ip_vhl == IP_VHL_BORING) {
+			if (ip->ip_vhl == IP_VHL_BORING) {
 #else
-		if ((ip->ip_hl == 5) && (ip->ip_v = IPVERSION)) {
+			if ((ip->ip_hl == 5) && (ip->ip_v = IPVERSION)) {
 #endif
-			ip->ip_sum = in_cksum_hdr(ip);
-		} else {
-			ip->ip_sum = in_cksum(m, hlen);
+				ip->ip_sum = in_cksum_hdr(ip);
+			} else {
+				ip->ip_sum = in_cksum(m, hlen);
+			}
 		}
 		error = (*ifp->if_output)(ifp, m,
 				(struct sockaddr *)dst, ro->ro_rt);
@@ -431,6 +469,13 @@ sendit:
 		goto bad;
 	}
 
+	/*
+	 * The fragments are checksummed in software.
+	 */
+	if (m->m_pkthdr.csum_flags & CSUM_DELAY_DATA)
+		in_delayed_cksum(m);
+	m->m_pkthdr.csum_flags = 0;
+
     {
 	int mhlen, firstlen = len;
 	struct mbuf **mnext = &m->m_nextpkt;
@@ -535,6 +580,149 @@ bad:
 	goto done;
 }
 
+/*
+ * Compute the TCP or UDP checksum left to the interface.  The IP header must
+ * be in the first mbuf with the length still in host byte order.  The
+ * checksum field at csum_data in the transport header holds the pseudo
+ * header sum.
+ */
+void
+in_delayed_cksum(struct mbuf *m)
+{
+	struct ip *ip = mtod(m, struct ip *);
+	int hlen = IP_VHL_HL(ip->ip_vhl) << 2;
+	int offset = hlen + m->m_pkthdr.csum_data;
+	u_short csum;
+
+	m->m_data += hlen;
+	m->m_len -= hlen;
+	csum = in_cksum(m, ip->ip_len - hlen);
+	m->m_data -= hlen;
+	m->m_len += hlen;
+	if (csum == 0 && (m->m_pkthdr.csum_flags & CSUM_UDP))
+		csum = 0xffff;
+
+	if (offset + sizeof(csum) > m->m_len)
+		m_copyback(m, offset, sizeof(csum), (caddr_t)&csum);
+	else
+		*(u_short *)(mtod(m, caddr_t) + offset) = csum;
+}
+
+/*
+ * Split a TCP packet marked with CSUM_TSO into segments of tso_segsz bytes
+ * of payload, like an interface with IFCAP_TSO4 does.  This is the software
+ * fallback of ip_output() and may be used by drivers which segment
+ * themselves.  The IP header is in network byte order.  The IP and TCP
+ * checksums are computed unless hwassist contains CSUM_IP or CSUM_TCP, the
+ * segments are marked for the interface then.
+ *
+ * Returns the segments linked by m_nextpkt, or NULL if the mbufs ran out,
+ * the packet is freed in this case.
+ */
+struct mbuf *
+ip_gso(struct mbuf *m0, int hwassist)
+{
+	struct ip *ip;
+	struct tcphdr *th;
+	struct mbuf *m, **mnext;
+	int hlen, hdrlen, segsz, len, off, seglen;
+	tcp_seq seq;
+	u_char flags;
+
+	ip = mtod(m0, struct ip *);
+	hlen = IP_VHL_HL(ip->ip_vhl) << 2;
+	if (m0->m_len < hlen + sizeof(struct tcphdr)) {
+		m0 = m_pullup(m0, hlen + sizeof(struct tcphdr));
+		if (m0 == NULL)
+			return (NULL);
+		ip = mtod(m0, struct ip *);
+	}
+	th = (struct tcphdr *)((caddr_t)ip + hlen);
+	hdrlen = hlen + (th->th_off << 2);
+	if (m0->m_len < hdrlen) {
+		m0 = m_pullup(m0, hdrlen);
+		if (m0 == NULL)
+			return (NULL);
+		ip = mtod(m0, struct ip *);
+		th = (struct tcphdr *)((caddr_t)ip + hlen);
+	}
+	segsz = m0->m_pkthdr.tso_segsz;
+	len = ntohs(ip->ip_len);
+	seq = ntohl(th->th_seq);
+	flags = th->th_flags;
+
+	/*
+	 * Copy the headers and the payload of each segment after the
+	 * first one, then trim the first one.
+	 */
+	mnext = &m0->m_nextpkt;
+	for (off = hdrlen + segsz; off < len; off += segsz) {
+		struct ip *mip;
+		struct tcphdr *mth;
+
+		seglen = imin(segsz, len - off);
+		MGETHDR(m, M_DONTWAIT, MT_HEADER);
+		if (m == NULL)
+			goto bad;
+		*mnext = m;
+		mnext = &m->m_nextpkt;
+		m->m_data += max_linkhdr;
+		m->m_len = hdrlen;
+		m->m_pkthdr.len = hdrlen + seglen;
+		m->m_pkthdr.rcvif = NULL;
+		bcopy(ip, mtod(m, caddr_t), hdrlen);
+		m->m_next = m_copy(m0, off, seglen);
+		if (m->m_next == NULL)
+			goto bad;
+		mip = mtod(m, struct ip *);
+		mip->ip_len = htons((u_short)(hdrlen + seglen));
+		mip->ip_id = htons(ip_id++);
+		mth = (struct tcphdr *)((caddr_t)mip + hlen);
+		mth->th_seq = htonl(seq + off - hdrlen);
+		if (off + seglen < len)
+			mth->th_flags = flags & ~(TH_FIN | TH_PUSH);
+	}
+	if (len > hdrlen + segsz) {
+		m_adj(m0, hdrlen + segsz - len);
+		ip->ip_len = htons((u_short)(hdrlen + segsz));
+		th->th_flags = flags & ~(TH_FIN | TH_PUSH);
+	}
+
+	for (m = m0; m; m = m->m_nextpkt) {
+		ip = mtod(m, struct ip *);
+		th = (struct tcphdr *)((caddr_t)ip + hlen);
+		len = ntohs(ip->ip_len) - hlen;
+		th->th_sum = in_pseudo(ip->ip_src.s_addr, ip->ip_dst.s_addr,
+		    htons((u_short)len + IPPROTO_TCP));
+		m->m_pkthdr.csum_flags = 0;
+		if (hwassist & CSUM_TCP) {
+			m->m_pkthdr.csum_flags |= CSUM_TCP;
+			m->m_pkthdr.csum_data = offsetof(struct tcphdr, th_sum);
+		} else {
+			m->m_data += hlen;
+			m->m_len -= hlen;
+			th->th_sum = in_cksum(m, len);
+			m->m_data -= hlen;
+			m->m_len += hlen;
+		}
+		ip->ip_sum = 0;
+		if (hwassist & CSUM_IP)
+			m->m_pkthdr.csum_flags |= CSUM_IP;
+		else if (hlen == sizeof(struct ip))
+			ip->ip_sum = in_cksum_hdr(ip);
+		else
+			ip->ip_sum = in_cksum(m, hlen);
+	}
+	return (m0);
+
+bad:
+	for (m = m0; m; m = m0) {
+		m0 = m->m_nextpkt;
+		m_freem(m);
+	}
+	return (NULL);
+}
+
 /*
  * Insert IP options into preformed packet.
  * Adjust IP destination as required for IP source routing,
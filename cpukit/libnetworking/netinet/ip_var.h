@@ -173,9 +173,13 @@ extern int	(*legal_vif_num)(int);
 extern u_long	(*ip_mcast_src)(int);
 extern int rsvp_on;
 
+void	 in_delayed_cksum(struct mbuf *);
 int	 ip_ctloutput(int, struct socket *, int, int, struct mbuf **);
 void	 ip_drain(void);
+void	 ip_forward_invalidate(struct in_addr);
 void	 ip_freemoptions(struct ip_moptions *);
+struct mbuf *
+	 ip_gso(struct mbuf *, int);
 void	 ip_init(void);
 extern int	 (*ip_mforward)(struct ip *, struct ifnet *, struct mbuf *,
 			  struct ip_moptions *);
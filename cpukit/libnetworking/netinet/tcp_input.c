@@ -65,6 +65,7 @@
 #include <netinet/tcp_timer.h>
 #include <netinet/tcp_var.h>
 #include <netinet/tcpip.h>
+#include <machine/in_cksum.h>
 #ifdef TCPDEBUG
 #include <netinet/tcp_debug.h>
 static struct	tcpiphdr tcp_saveti;
@@ -319,7 +320,16 @@ tcp_input(struct mbuf *m, int iphlen)
 	ti->ti_x1 = 0;
 	ti->ti_len = (u_short)tlen;
 	HTONS(ti->ti_len);
-	ti->ti_sum = in_cksum(m, len);
+	if (m->m_pkthdr.csum_flags & CSUM_DATA_VALID) {
+		if (m->m_pkthdr.csum_flags & CSUM_PSEUDO_HDR)
+			ti->ti_sum = m->m_pkthdr.csum_data;
+		else
+			ti->ti_sum = in_pseudo(ti->ti_src.s_addr,
+			    ti->ti_dst.s_addr, htonl(m->m_pkthdr.csum_data +
+			    tlen + IPPROTO_TCP));
+		ti->ti_sum ^= 0xffff;
+	} else
+		ti->ti_sum = in_cksum(m, len);
 	if (ti->ti_sum) {
 		tcpstat.tcps_rcvbadsum++;
 		goto drop;
@@ -35,9 +35,13 @@
 
 #include "opt_tcpdebug.h"
 
+#include <stddef.h>
+
 #include <sys/param.h>
 #include <sys/queue.h>
 #include <sys/systm.h>
+#include <sys/kernel.h>
+#include <sys/sysctl.h>
 #include <sys/malloc.h>
 #include <sys/mbuf.h>
 #include <sys/protosw.h>
@@ -45,6 +49,7 @@
 #include <sys/socketvar.h>
 #include <errno.h>
 
+#include <net/if.h>
 #include <net/route.h>
 
 #include <netinet/in.h>
@@ -63,10 +68,32 @@
 #include <netinet/tcp_debug.h>
 #endif
 
+#include <machine/in_cksum.h>
+
 #ifdef notyet
 extern struct mbuf *m_copypack();
 #endif
 
+static int tcp_do_tso = 1;
+SYSCTL_INT(_net_inet_tcp, OID_AUTO, tso, CTLFLAG_RW,
+	&tcp_do_tso, 0, "Send TSO packets to interfaces with IFCAP_TSO4");
+
+/*
+ * Returns true if the segments of this connection may be passed as a single
+ * TSO packet to the outgoing interface.
+ */
+static int
+tcp_tso_ok(struct tcpcb *tp)
+{
+	struct inpcb *inp = tp->t_inpcb;
+	struct rtentry *rt = inp->inp_route.ro_rt;
+
+	return (tcp_do_tso && rt != NULL && (rt->rt_flags & RTF_UP) &&
+	    (rt->rt_ifp->if_capenable & IFCAP_TSO4) &&
+	    inp->inp_options == NULL && tp->t_force == 0 &&
+	    SEQ_LEQ(tp->snd_up, tp->snd_una));
+}
+
 
 /*
  * Tcp output routine: figure out what should be sent and send it.
@@ -82,7 +109,8 @@ tcp_output(
 	register struct tcpiphdr *ti;
 	u_char opt[TCP_MAXOLEN];
 	unsigned optlen, hdrlen;
-	int idle, sendalot;
+	int idle, sendalot, tso;
+	long segsz = 0;
 	struct rmxp_tao *taop;
 	struct rmxp_tao tao_noncached;
 
@@ -201,9 +229,14 @@ again:
 				tcp_setpersist(tp);
 		}
 	}
+	tso = 0;
 	if (len > tp->t_maxseg) {
-		len = tp->t_maxseg;
-		sendalot = 1;
+		if ((flags & TH_SYN) == 0 && tcp_tso_ok(tp))
+			tso = 1;
+		else {
+			len = tp->t_maxseg;
+			sendalot = 1;
+		}
 	}
 	if (SEQ_LT(tp->snd_nxt + len, tp->snd_una + so->so_snd.sb_cc))
 		flags &= ~TH_FIN;
@@ -221,7 +254,7 @@ again:
 	 * to send into a small window), then must resend.
 	 */
 	if (len) {
-		if (len == tp->t_maxseg)
+		if (len >= tp->t_maxseg)
 			goto send;
 		if ((idle || tp->t_flags & TF_NODELAY) &&
 		    (tp->t_flags & TF_NOPUSH) == 0 &&
@@ -441,7 +474,26 @@ send:
 	 * Clear the FIN bit because we cut off the tail of
 	 * the segment.
 	 */
-	 if (len + optlen > tp->t_maxopd) {
+	if (tso) {
+		/*
+		 * Send at most a maximum IP packet of whole segments, unless
+		 * this empties the send buffer.  The interface or ip_gso()
+		 * cuts it into segments of segsz bytes.
+		 */
+		segsz = min(tp->t_maxseg, tp->t_maxopd - optlen);
+		if (len > IP_MAXPACKET - hdrlen) {
+			len = IP_MAXPACKET - hdrlen;
+			sendalot = 1;
+		}
+		if (len % segsz != 0 && off + len < so->so_snd.sb_cc) {
+			len -= len % segsz;
+			sendalot = 1;
+		}
+		if (sendalot)
+			flags &= ~TH_FIN;
+		if (len <= segsz)
+			tso = 0;
+	} else if (len + optlen > tp->t_maxopd) {
 		/*
 		 * If there is still more to send, don't close the connection.
 		 */
@@ -589,13 +641,25 @@ send:
 		tp->snd_up = tp->snd_una;		/* drag it along */
 
 	/*
-	 * Put TCP length in extended header, and then
-	 * checksum extended header and data.
+	 * Put TCP length in extended header, and then leave
+	 * the checksum of extended header and data to ip_output()
+	 * or the interface.  The pseudo header sum of a TSO packet
+	 * excludes the length, it differs for each segment.
 	 */
 	if (len + optlen)
 		ti->ti_len = htons((u_short)(sizeof (struct tcphdr) +
 		    optlen + len));
-	ti->ti_sum = in_cksum(m, (int)(hdrlen + len));
+	m->m_pkthdr.csum_flags = CSUM_TCP;
+	m->m_pkthdr.csum_data = offsetof(struct tcphdr, th_sum);
+	if (tso) {
+		m->m_pkthdr.csum_flags |= CSUM_TSO;
+		m->m_pkthdr.tso_segsz = segsz;
+		ti->ti_sum = in_pseudo(ti->ti_src.s_addr, ti->ti_dst.s_addr,
+		    htons(IPPROTO_TCP));
+	} else
+		ti->ti_sum = in_pseudo(ti->ti_src.s_addr, ti->ti_dst.s_addr,
+		    htons((u_short)(sizeof (struct tcphdr) + optlen + len) +
+		    IPPROTO_TCP));
 
 	/*
 	 * In transmit state, time the transmission and arrange for
@@ -34,6 +34,8 @@
 #include "config.h"
 #endif
 
+#include <stddef.h>
+
 #include <sys/param.h>
 #include <sys/queue.h>
 #include <sys/systm.h>
@@ -61,6 +63,8 @@
 #include <netinet/udp.h>
 #include <netinet/udp_var.h>
 
+#include <machine/in_cksum.h>
+
 /*
  * UDP protocol implementation.
  * Per RFC 768, August, 1980.
@@ -162,11 +166,22 @@ udp_input(struct mbuf *m, int iphlen)
 	 * Checksum extended UDP header and data.
 	 */
 	if (uh->uh_sum) {
-		((struct ipovly *)ip)->ih_next = 0;
-		((struct ipovly *)ip)->ih_prev = 0;
-		((struct ipovly *)ip)->ih_x1 = 0;
-		((struct ipovly *)ip)->ih_len = uh->uh_ulen;
-		uh->uh_sum = in_cksum(m, len + sizeof (struct ip));
+		if (m->m_pkthdr.csum_flags & CSUM_DATA_VALID) {
+			if (m->m_pkthdr.csum_flags & CSUM_PSEUDO_HDR)
+				uh->uh_sum = m->m_pkthdr.csum_data;
+			else
+				uh->uh_sum = in_pseudo(ip->ip_src.s_addr,
+				    ip->ip_dst.s_addr,
+				    htonl((u_short)len +
+				    m->m_pkthdr.csum_data + IPPROTO_UDP));
+			uh->uh_sum ^= 0xffff;
+		} else {
+			((struct ipovly *)ip)->ih_next = 0;
+			((struct ipovly *)ip)->ih_prev = 0;
+			((struct ipovly *)ip)->ih_x1 = 0;
+			((struct ipovly *)ip)->ih_len = uh->uh_ulen;
+			uh->uh_sum = in_cksum(m, len + sizeof (struct ip));
+		}
 		if (uh->uh_sum) {
 			udpstat.udps_badsum++;
 			m_freem(m);
@@ -423,12 +438,15 @@ udp_output(struct inpcb *inp, struct mbuf *m, struct mbuf *addr,
 	ui->ui_ulen = ui->ui_len;
 
 	/*
-	 * Stuff checksum and output datagram.
+	 * Stuff the pseudo header sum and leave the checksum
+	 * to ip_output() or the interface, then output datagram.
 	 */
 	ui->ui_sum = 0;
 	if (udpcksum) {
-	    if ((ui->ui_sum = in_cksum(m, sizeof (struct udpiphdr) + len)) == 0)
-		ui->ui_sum = 0xffff;
+		ui->ui_sum = in_pseudo(ui->ui_src.s_addr, ui->ui_dst.s_addr,
+		    htons((u_short)len + sizeof (struct udphdr) + IPPROTO_UDP));
+		m->m_pkthdr.csum_flags = CSUM_UDP;
+		m->m_pkthdr.csum_data = offsetof(struct udphdr, uh_sum);
 	}
 	((struct ip *)ui)->ip_len = sizeof (struct udpiphdr) + len;
 	((struct ip *)ui)->ip_ttl = inp->inp_ip_ttl;	/* XXX */
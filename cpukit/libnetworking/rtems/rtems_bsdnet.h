@@ -190,6 +190,12 @@ struct rtems_bsdnet_config {
 	const cpu_set_t		*network_task_cpuset;
 	size_t			network_task_cpuset_size;
 #endif
+
+	/*
+	 * Memory for 9k jumbo clusters used by drivers of links
+	 * with a large MTU.  The default is no jumbo clusters.
+	 */
+	unsigned long		mbuf_jumbo_cluster_bytecount;
 };
 
 /*
@@ -221,6 +227,20 @@ void rtems_bsdnet_detach (struct rtems_bsdnet_ifconfig *ifconfig);
  */
 int rtems_bsdnet_ifconfig (const char *ifname, uint32_t   cmd, void *param);
 
+/*
+ * Request a receive poll of an interface by the network daemon.  This may be
+ * called from interrupt context after the driver disabled its receive
+ * interrupt.  The network daemon calls the if_poll_recv() handler of the
+ * interface with a quota of if_recvquota frames (default 32).  The handler
+ * passes at most this number of frames to ether_input(), decrements the
+ * quota accordingly and returns a non-zero value if frames are left.  The
+ * frames of a poll are processed as a batch after the handler returns.  Once
+ * no frames are left the network daemon calls the if_poll_intren() handler
+ * to enable the receive interrupt again.
+ */
+struct ifnet;
+void rtems_bsdnet_schedpoll (struct ifnet *ifp);
+
 void rtems_bsdnet_do_bootp (void);
 void rtems_bsdnet_do_bootp_and_rootfs (void);
 
@@ -315,6 +335,7 @@ void* rtems_bsdnet_malloc_mbuf(size_t size, int type);
 #define MBUF_MALLOC_NMBCLUSTERS (0)
 #define MBUF_MALLOC_MCLREFCNT   (1)
 #define MBUF_MALLOC_MBUF        (2)
+#define MBUF_MALLOC_JUMBO       (3)
 
 #ifdef __cplusplus
 }
@@ -216,7 +216,8 @@ int ioctl (int, ioctl_command_t, ...);
 #define SOSLEEP_EVENT  RTEMS_EVENT_SYSTEM_NETWORK_SOSLEEP
 #define NETISR_IP_EVENT        (1L << NETISR_IP)
 #define NETISR_ARP_EVENT       (1L << NETISR_ARP)
-#define NETISR_EVENTS  (NETISR_IP_EVENT|NETISR_ARP_EVENT)
+#define NETISR_POLL_EVENT      (1L << NETISR_POLL)
+#define NETISR_EVENTS  (NETISR_IP_EVENT|NETISR_ARP_EVENT|NETISR_POLL_EVENT)
 #if (SBWAIT_EVENT & SOSLEEP_EVENT & NETISR_EVENTS & RTEMS_EVENT_SYSTEM_NETWORK_CLOSE)
 # error "Network event conflict"
 #endif
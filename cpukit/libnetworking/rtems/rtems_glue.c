@@ -46,6 +46,7 @@ void sysctl_register_all(void *arg);
  */
 static uint32_t nmbuf       = (64L * 1024L) / MSIZE;
        uint32_t nmbclusters = (128L * 1024L) / MCLBYTES;
+static uint32_t nmbjumbo;
 
 /*
  * Network task synchronization
@@ -240,6 +241,18 @@ bsd_init (void)
 	mbstat.m_mbufs = nmbuf;
 	mbstat.m_mtypes[MT_FREE] = nmbuf;
 
+	/*
+	 * Set up jumbo clusters
+	 */
+	if (nmbjumbo > 0) {
+		p = rtems_bsdnet_malloc_mbuf(nmbjumbo * (MJUM9BYTES + 1), MBUF_MALLOC_JUMBO);
+		if (p == NULL) {
+			printf ("Can't get network jumbo cluster memory.\n");
+			return -1;
+		}
+		m_jclinit(p, nmbjumbo);
+	}
+
 	/*
 	 * Set up domains
 	 */
@@ -302,6 +315,7 @@ rtems_bsdnet_initialize (void)
 		nmbuf = rtems_bsdnet_config.mbuf_bytecount / MSIZE;
 	if (rtems_bsdnet_config.mbuf_cluster_bytecount)
 		nmbclusters = rtems_bsdnet_config.mbuf_cluster_bytecount / MCLBYTES;
+	nmbjumbo = rtems_bsdnet_config.mbuf_jumbo_cluster_bytecount / MJUM9BYTES;
 
         rtems_set_udp_buffer_sizes(
           rtems_bsdnet_config.udp_tx_buf_size,
@@ -371,6 +385,11 @@ rtems_bsdnet_initialize (void)
 
 /*
  * Obtain network mutex
+ *
+ * The network mutex serializes the whole stack, this includes the sockets,
+ * the protocols, the routing table, the protocol control blocks and the
+ * mbufs.  It must not be released while a socket buffer is locked via
+ * sblock(), since a concurrent close() would free the socket.
  */
 void
 rtems_bsdnet_semaphore_obtain (void)
@@ -513,6 +532,9 @@ sowakeup(
 	if (sb->sb_wakeup) {
 		(*sb->sb_wakeup) (so, sb->sb_wakeuparg);
 	}
+	if (!KNLIST_EMPTY(&sb->sb_note)) {
+		KNOTE_LOCKED(&sb->sb_note, 0);
+	}
 }
 
 /*
@@ -572,6 +594,61 @@ rtems_bsdnet_schednetisr (int n)
 	rtems_event_system_send (networkDaemonTid, 1 << n);
 }
 
+/*
+ * Default receive quota of a poll, this should not exceed the length of the
+ * protocol input queues (IFQ_MAXLEN).
+ */
+#define RTEMS_BSDNET_POLL_QUOTA 32
+
+/*
+ * Request a receive poll, see rtems_bsdnet_schedpoll() documentation.
+ */
+void
+rtems_bsdnet_schedpoll (struct ifnet *ifp)
+{
+	ifp->if_pollreq = 1;
+	rtems_bsdnet_schednetisr (NETISR_POLL);
+}
+
+/*
+ * Poll the receivers of the interfaces which requested it.  An interface
+ * which has frames left after its quota is polled again in the next round
+ * of the network daemon, so that the timers and the other interfaces get
+ * their turn.
+ */
+static void
+pollReceivers (void)
+{
+	struct ifnet *ifp;
+
+	for (ifp = ifnet; ifp != NULL; ifp = ifp->if_next) {
+		int quota;
+		int more;
+
+		if (!ifp->if_pollreq)
+			continue;
+		ifp->if_pollreq = 0;
+
+		quota = ifp->if_recvquota;
+		if (quota == 0)
+			quota = RTEMS_BSDNET_POLL_QUOTA;
+
+		ifp->if_flags |= IFF_POLLING;
+		more = (*ifp->if_poll_recv) (ifp, &quota);
+		ipintr ();
+		arpintr ();
+
+		if (more) {
+			ifp->if_pollreq = 1;
+			rtems_bsdnet_schednetisr (NETISR_POLL);
+		} else {
+			ifp->if_flags &= ~IFF_POLLING;
+			if (ifp->if_poll_intren != NULL)
+				(*ifp->if_poll_intren) (ifp);
+		}
+	}
+}
+
 /*
  * The network daemon
  * This provides a context to run BSD software interrupts
@@ -598,6 +675,8 @@ networkDaemon (void *task_argument)
 						timeout,
 						&events);
 		if ( sc == RTEMS_SUCCESSFUL ) {
+			if (events & NETISR_POLL_EVENT)
+				pollReceivers ();
 			if (events & NETISR_IP_EVENT)
 				ipintr ();
 			if (events & NETISR_ARP_EVENT)
@@ -835,14 +914,21 @@ rtems_bsdnet_log (int priority, const char *fmt, ...)
 u_int
 in_cksum_hdr (const void *ip)
 {
-	uint32_t   sum;
-	const uint16_t   *sp;
+	uint64_t   sum;
 	int i;
 
 	sum = 0;
-	sp = (uint16_t   *)ip;
-	for (i = 0 ; i < 10 ; i++)
-		sum += *sp++;
+	if (((uintptr_t) ip & 3) == 0) {
+		const uint32_t   *wp = ip;
+
+		for (i = 0 ; i < 5 ; i++)
+			sum += *wp++;
+	} else {
+		const uint16_t   *sp = ip;
+
+		for (i = 0 ; i < 10 ; i++)
+			sum += *sp++;
+	}
 	while (sum > 0xFFFF)
 		sum = (sum & 0xffff) + (sum >> 16);
 	return ~sum & 0xFFFF;
@@ -1189,6 +1275,17 @@ int rtems_bsdnet_ifconfig(const char *ifname, uint32_t cmd, void *param)
 			r = ioctl (s, cmd, &ifreq);
 			break;
 
+		case SIOCSIFCAP:
+			ifreq.ifr_reqcap = *((int*) param);
+			r = ioctl (s, cmd, &ifreq);
+			break;
+
+		case SIOCGIFCAP:
+			if ((r = ioctl (s, cmd, &ifreq)) < 0)
+				break;
+			*((int*) param) = ifreq.ifr_curcap;
+			break;
+
 		case SIOCGIFMEDIA:
 			/* 'param' passes the phy index they want to
 			 * look at...
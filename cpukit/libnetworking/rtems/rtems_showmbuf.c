@@ -27,6 +27,12 @@ rtems_bsdnet_show_mbuf_stats (void)
 			mbstat.m_mbufs, mbstat.m_clusters, mbstat.m_clfree);
 	printf ("drops:%4lu       waits:%4lu  drains:%4lu\n",
 			mbstat.m_drops, mbstat.m_wait, mbstat.m_drain);
+	printf ("mbuf high-water:%4lu    cluster high-water:%4lu\n",
+			mbstat.m_mbhiwat, mbstat.m_clhiwat);
+	if (mbstat.m_jclusters != 0)
+		printf ("jumbo clusters:%4lu  free:%4lu  high-water:%4lu\n",
+				mbstat.m_jclusters, mbstat.m_jclfree,
+				mbstat.m_jclhiwat);
 	for (i = 0 ; i < 20 ; i++) {
 		switch (i) {
 		case MT_FREE:		cp = "free";		break;
@@ -428,6 +428,231 @@ sendto (int s, const void *buf, size_t buflen, int flags, const struct sockaddr
 	return sendmsg (s, &msg, flags);
 }
 
+/*
+ * Send the header or trailer vector of sendfile().  Returns 1 if a
+ * non-blocking socket took only a part of the vector.
+ */
+static int
+sendfile_iov (int s, struct iovec *iov, int iovcnt, off_t *sbytes)
+{
+	struct msghdr msg;
+	ssize_t len = 0;
+	ssize_t n;
+	int i;
+
+	if (iov == NULL || iovcnt <= 0)
+		return 0;
+	for (i = 0; i < iovcnt; i++)
+		len += iov[i].iov_len;
+	memset (&msg, 0, sizeof (msg));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = iovcnt;
+	n = sendmsg (s, &msg, 0);
+	if (n < 0)
+		return -1;
+	*sbytes += n;
+	return n < len ? 1 : 0;
+}
+
+/*
+ * Wait until the socket is able to take at least the low-water mark of
+ * send data.  Returns the available space or a negative error number.
+ */
+static long
+sendfile_wait (struct socket *so)
+{
+	struct sockbuf *sb = &so->so_snd;
+	long space;
+	int error;
+
+	for (;;) {
+		if (so->so_state & SS_NOFDREF)
+			return -EBADF;
+		if (so->so_state & SS_CANTSENDMORE)
+			return -EPIPE;
+		if (so->so_error) {
+			error = so->so_error;
+			so->so_error = 0;
+			return -error;
+		}
+		if ((so->so_state & SS_ISCONNECTED) == 0)
+			return -ENOTCONN;
+		space = sbspace (sb);
+		if (space > 0 && space >= sb->sb_lowat)
+			return space;
+		if (so->so_state & SS_NBIO)
+			return -EWOULDBLOCK;
+		error = sbwait (sb);
+		if (error)
+			return -error;
+	}
+}
+
+/*
+ * Send a file to a stream socket.
+ *
+ * The file data is read directly into mbuf clusters, so it is copied once
+ * instead of through an application buffer and then into the mbufs.  The
+ * network semaphore is released while the file system reads the data.
+ * A reference in so_count keeps the socket alive meanwhile, even if
+ * another task closes the descriptor.  On a non-blocking socket a call
+ * which sent some data returns 0 and reports the count in sbytes.  If no
+ * data could be sent, it fails with EAGAIN.  The flags are reserved and
+ * ignored.
+ */
+int
+sendfile (int fd, int s, off_t offset, size_t nbytes, struct sf_hdtr *hdtr,
+    off_t *sbytes, int flags)
+{
+	struct socket *so;
+	off_t sent = 0;
+	off_t fsent = 0;
+	int error = 0;
+	int rv;
+
+	if (hdtr != NULL &&
+	    (rv = sendfile_iov (s, hdtr->headers, hdtr->hdr_cnt, &sent)) != 0) {
+		if (sbytes != NULL)
+			*sbytes = sent;
+		return rv < 0 ? -1 : 0;
+	}
+
+	rtems_bsdnet_semaphore_obtain ();
+	if ((so = rtems_bsdnet_fdToSocket (s)) == NULL) {
+		rtems_bsdnet_semaphore_release ();
+		if (sbytes != NULL)
+			*sbytes = sent;
+		return -1;
+	}
+	if (so->so_type != SOCK_STREAM) {
+		rtems_bsdnet_semaphore_release ();
+		if (sbytes != NULL)
+			*sbytes = sent;
+		errno = EINVAL;
+		return -1;
+	}
+	so->so_count++;
+
+	for (;;) {
+		struct mbuf *top = NULL;
+		struct mbuf **mp = &top;
+		struct mbuf *m;
+		long space;
+		long len;
+		long done;
+		int rerror = 0;
+		uint32_t nest_count;
+
+		if (nbytes != 0 && fsent >= (off_t) nbytes)
+			break;
+
+		space = sendfile_wait (so);
+		if (space < 0) {
+			error = (int) -space;
+			break;
+		}
+		len = space;
+		if (nbytes != 0 && (off_t) len > (off_t) nbytes - fsent)
+			len = (long) ((off_t) nbytes - fsent);
+
+		/*
+		 * Get the cluster chain for the data of this round
+		 */
+		for (done = 0; done < len; done += m->m_len) {
+			if (top == NULL) {
+				MGETHDR(m, M_WAIT, MT_DATA);
+				m->m_pkthdr.len = 0;
+				m->m_pkthdr.rcvif = NULL;
+			} else {
+				MGET(m, M_WAIT, MT_DATA);
+			}
+			MCLGET(m, M_WAIT);
+			if ((m->m_flags & M_EXT) == 0) {
+				m_free (m);
+				break;
+			}
+			m->m_len = len - done > MCLBYTES ? MCLBYTES : len - done;
+			*mp = m;
+			mp = &m->m_next;
+		}
+		if (top == NULL) {
+			error = ENOBUFS;
+			break;
+		}
+
+		/*
+		 * Read the file data without the network semaphore
+		 */
+		done = 0;
+		nest_count = rtems_bsdnet_semaphore_release_recursive ();
+		for (m = top; m != NULL; m = m->m_next) {
+			ssize_t n;
+
+			n = pread (fd, mtod (m, void *), (size_t) m->m_len,
+			    offset + fsent + done);
+			if (n < 0) {
+				rerror = errno;
+				n = 0;
+			}
+			done += n;
+			if (n < m->m_len) {
+				m->m_len = n;
+				break;
+			}
+		}
+		rtems_bsdnet_semaphore_obtain_recursive (nest_count);
+
+		if (so->so_state & SS_NOFDREF) {
+			error = EBADF;
+			m_freem (top);
+			break;
+		}
+		if (done == 0) {
+			error = rerror;
+			m_freem (top);
+			break;
+		}
+		if (m != NULL && m->m_next != NULL) {
+			m_freem (m->m_next);
+			m->m_next = NULL;
+		}
+		top->m_pkthdr.len = (int) done;
+
+		error = sosend (so, NULL, NULL, top, NULL, 0);
+		if (error)
+			break;
+		sent += done;
+		fsent += done;
+
+		/* End of file or read error */
+		if (m != NULL) {
+			error = rerror;
+			break;
+		}
+	}
+
+	/* The socket is freed here if it was closed meanwhile */
+	so->so_count--;
+	sofree (so);
+	rtems_bsdnet_semaphore_release ();
+
+	if (error == 0 && hdtr != NULL &&
+	    sendfile_iov (s, hdtr->trailers, hdtr->trl_cnt, &sent) < 0 &&
+	    errno != EWOULDBLOCK)
+		error = errno;
+	if (sbytes != NULL)
+		*sbytes = sent;
+
+	/* A would block condition is an error only if nothing is sent */
+	if (error == EWOULDBLOCK && sent > 0)
+		error = 0;
+	if (error) {
+		errno = error == EWOULDBLOCK ? EAGAIN : error;
+		return -1;
+	}
+	return 0;
+}
+
 /*
  * All `receive' operations end up calling this routine.
  */
@@ -813,6 +1038,116 @@ rtems_bsdnet_fstat (const rtems_filesystem_location_info_t *loc, struct stat *sp
 	return 0;
 }
 
+/*
+ * Kernel event filters.  The knote lists of the socket buffers are
+ * protected by the network semaphore.
+ */
+static void
+socket_knlist_lock (void *arg)
+{
+	rtems_bsdnet_semaphore_obtain ();
+}
+
+static void
+socket_knlist_unlock (void *arg)
+{
+	rtems_bsdnet_semaphore_release ();
+}
+
+static void
+filt_sodetach (struct knote *kn)
+{
+	knlist_remove (kn->kn_knlist, kn, 0);
+}
+
+static int
+filt_soread (struct knote *kn, long hint)
+{
+	struct socket *so = kn->kn_hook;
+
+	if (so->so_options & SO_ACCEPTCONN) {
+		kn->kn_data = so->so_qlen;
+		return (so->so_comp.tqh_first != NULL);
+	}
+	kn->kn_data = so->so_rcv.sb_cc;
+	if (so->so_state & SS_CANTRCVMORE) {
+		kn->kn_flags |= EV_EOF;
+		kn->kn_fflags = so->so_error;
+		return (1);
+	}
+	if (so->so_error)
+		return (1);
+	if (kn->kn_sfflags & NOTE_LOWAT)
+		return (kn->kn_data >= kn->kn_sdata);
+	return (kn->kn_data >= so->so_rcv.sb_lowat);
+}
+
+static int
+filt_sowrite (struct knote *kn, long hint)
+{
+	struct socket *so = kn->kn_hook;
+
+	kn->kn_data = sbspace (&so->so_snd);
+	if (so->so_state & SS_CANTSENDMORE) {
+		kn->kn_flags |= EV_EOF;
+		kn->kn_fflags = so->so_error;
+		return (1);
+	}
+	if (so->so_error)
+		return (1);
+	if (((so->so_state & SS_ISCONNECTED) == 0) &&
+	    (so->so_proto->pr_flags & PR_CONNREQUIRED))
+		return (0);
+	if (kn->kn_sfflags & NOTE_LOWAT)
+		return (kn->kn_data >= kn->kn_sdata);
+	return (kn->kn_data >= so->so_snd.sb_lowat);
+}
+
+static struct filterops soread_filtops = {
+	.f_isfd = 1,
+	.f_detach = filt_sodetach,
+	.f_event = filt_soread
+};
+
+static struct filterops sowrite_filtops = {
+	.f_isfd = 1,
+	.f_detach = filt_sodetach,
+	.f_event = filt_sowrite
+};
+
+static int
+rtems_bsdnet_kqfilter (rtems_libio_t *iop, struct knote *kn)
+{
+	struct socket *so;
+	struct sockbuf *sb;
+
+	rtems_bsdnet_semaphore_obtain ();
+	if ((so = iop->data1) == NULL) {
+		rtems_bsdnet_semaphore_release ();
+		return EBADF;
+	}
+	switch (kn->kn_filter) {
+	case EVFILT_READ:
+		kn->kn_fop = &soread_filtops;
+		sb = &so->so_rcv;
+		break;
+	case EVFILT_WRITE:
+		kn->kn_fop = &sowrite_filtops;
+		sb = &so->so_snd;
+		break;
+	default:
+		rtems_bsdnet_semaphore_release ();
+		return EINVAL;
+	}
+	kn->kn_hook = so;
+	if (sb->sb_note.kl_lock == NULL)
+		knlist_init (&sb->sb_note, NULL, socket_knlist_lock,
+		    socket_knlist_unlock, NULL, NULL);
+	knlist_add (&sb->sb_note, kn, 1);
+	rtems_bsdnet_semaphore_release ();
+	return 0;
+}
+
 static const rtems_filesystem_file_handlers_r socket_handlers = {
 	.open_h = rtems_filesystem_default_open,
 	.close_h = rtems_bsdnet_close,
@@ -825,7 +1160,7 @@ static const rtems_filesystem_file_handlers_r socket_handlers = {
 	.fsync_h = rtems_filesystem_default_fsync_or_fdatasync,
 	.fdatasync_h = rtems_filesystem_default_fsync_or_fdatasync,
 	.fcntl_h = rtems_bsdnet_fcntl,
-	.kqfilter_h = rtems_filesystem_default_kqfilter,
+	.kqfilter_h = rtems_bsdnet_kqfilter,
 	.poll_h = rtems_filesystem_default_poll,
 	.readv_h = rtems_filesystem_default_readv,
 	.writev_h = rtems_filesystem_default_writev
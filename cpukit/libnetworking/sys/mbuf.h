@@ -51,6 +51,12 @@
 #define	MINCLSIZE	(MHLEN + MLEN)	/* smallest amount to put in cluster */
 #define	M_MAXCOMPRESS	(MHLEN / 2)	/* max amount to copy for compression */
 
+/*
+ * Jumbo clusters for links with a large MTU.  They are taken from a
+ * separate pool which is empty unless configured.
+ */
+#define	MJUM9BYTES	(9 * 1024)	/* jumbo cluster 9k */
+
 /*-
  * Macros for type conversion:
  * mtod(m, t) 	-- Convert mbuf pointer to data pointer of correct type.
@@ -81,6 +87,9 @@ struct m_hdr {
 struct	pkthdr {
 	struct	ifnet *rcvif;		/* rcv interface */
 	int32_t	len;			/* total packet length */
+	u_short	csum_flags;		/* checksum and TSO offload, see below */
+	u_short	csum_data;		/* checksum offset or received sum */
+	u_short	tso_segsz;		/* TCP payload per segment if CSUM_TSO */
 };
 
 /*
@@ -143,6 +152,26 @@ struct mbuf {
  */
 #define	M_COPYFLAGS	(M_PKTHDR|M_EOR|M_PROTO1|M_BCAST|M_MCAST)
 
+/*
+ * Flags in m_pkthdr.csum_flags.  On output they request work from the
+ * interface, see if_hwassist; csum_data is the offset of the checksum field
+ * in the transport header which holds the pseudo header sum.  On input the
+ * driver reports the checksums it verified; csum_data is the sum of the
+ * transport data, including the pseudo header if CSUM_PSEUDO_HDR is set.
+ */
+#define	CSUM_IP		0x0001	/* will csum IP header */
+#define	CSUM_TCP	0x0002	/* will csum TCP */
+#define	CSUM_UDP	0x0004	/* will csum UDP */
+#define	CSUM_TSO	0x0020	/* will segment TCP at tso_segsz */
+
+#define	CSUM_IP_CHECKED	0x0100	/* did csum IP header */
+#define	CSUM_IP_VALID	0x0200	/*   ... and it is valid */
+#define	CSUM_DATA_VALID	0x0400	/* csum_data holds the data sum */
+#define	CSUM_PSEUDO_HDR	0x0800	/*   ... including the pseudo header */
+
+#define	CSUM_DELAY_DATA	(CSUM_TCP | CSUM_UDP)
+#define	CSUM_DELAY_IP	(CSUM_IP)
+
 /*
  * mbuf types.
  */
@@ -174,6 +203,11 @@ struct mbstat {
 	u_long	m_wait;		/* times waited for space */
 	u_long	m_drain;	/* times drained protocols for space */
 	u_short	m_mtypes[256];	/* type specific mbuf allocations */
+	u_long	m_mbhiwat;	/* high-water mark of mbufs in use */
+	u_long	m_clhiwat;	/* high-water mark of clusters in use */
+	u_long	m_jclusters;	/* jumbo clusters obtained from page pool */
+	u_long	m_jclfree;	/* free jumbo clusters */
+	u_long	m_jclhiwat;	/* high-water mark of jumbo clusters in use */
 };
 
 
@@ -205,6 +239,14 @@ union mcluster {
 	  splx(ms); \
 	}
 
+/*
+ * Update a high-water mark of the mbuf statistics.
+ */
+#define	MBSTAT_HIWAT(field, inuse) do { \
+	  if ((u_long)(inuse) > mbstat.field) \
+		mbstat.field = (inuse); \
+	} while (0)
+
 /*
  * mbuf allocation/deallocation macros:
  *
@@ -222,6 +264,7 @@ union mcluster {
 	  if (((m) = mmbfree) != 0) { \
 		mmbfree = (m)->m_next; \
 		mbstat.m_mtypes[MT_FREE]--; \
+		MBSTAT_HIWAT(m_mbhiwat, mbstat.m_mbufs - mbstat.m_mtypes[MT_FREE]); \
 		(m)->m_type = (type); \
 		mbstat.m_mtypes[type]++; \
 		(m)->m_next = (struct mbuf *)NULL; \
@@ -242,12 +285,14 @@ union mcluster {
 	  if (((m) = mmbfree) != 0) { \
 		mmbfree = (m)->m_next; \
 		mbstat.m_mtypes[MT_FREE]--; \
+		MBSTAT_HIWAT(m_mbhiwat, mbstat.m_mbufs - mbstat.m_mtypes[MT_FREE]); \
 		(m)->m_type = (type); \
 		mbstat.m_mtypes[type]++; \
 		(m)->m_next = (struct mbuf *)NULL; \
 		(m)->m_nextpkt = (struct mbuf *)NULL; \
 		(m)->m_data = (m)->m_pktdat; \
 		(m)->m_flags = M_PKTHDR; \
+		(m)->m_pkthdr.csum_flags = 0; \
 		splx(_ms); \
 	} else { \
 		splx(_ms); \
@@ -270,6 +315,7 @@ union mcluster {
 	  if (((p) = (caddr_t)mclfree) != 0) { \
 		++mclrefcnt[mtocl(p)]; \
 		mbstat.m_clfree--; \
+		MBSTAT_HIWAT(m_clhiwat, mbstat.m_clusters - mbstat.m_clfree); \
 		mclfree = ((union mcluster *)(p))->mcl_next; \
 	  } \
 	)
@@ -405,6 +451,7 @@ extern uint32_t	nmbclusters;
 extern uint32_t	nmbufs;
 extern struct mbuf *mmbfree;
 extern union mcluster *mclfree;
+extern uint32_t	nmbjumbo9;
 extern int	max_linkhdr;		/* largest link-level header */
 extern int	max_protohdr;		/* largest protocol header */
 extern int	max_hdr;		/* largest link+protocol header */
@@ -418,6 +465,7 @@ struct	mbuf *m_free(struct mbuf *);
 struct	mbuf *m_get(int, int);
 struct	mbuf *m_getclr(int, int);
 struct	mbuf *m_gethdr(int, int);
+struct	mbuf *m_getjcl(int, int, int, int);
 struct	mbuf *m_prepend(struct mbuf *,int,int);
 struct	mbuf *m_pullup(struct mbuf *, int);
 struct	mbuf *m_retry(int, int);
@@ -427,6 +475,7 @@ void	m_adj(struct mbuf *, int);
 void	m_cat(struct mbuf *,struct mbuf *);
 int	m_mballoc(int, int);
 int	m_clalloc(int, int);
+void	m_jclinit(caddr_t, uint32_t);
 int	m_copyback(struct mbuf *, int, int, caddr_t);
 int	m_copydata(const struct mbuf *, int, int, caddr_t);
 void	m_freem(struct mbuf *);
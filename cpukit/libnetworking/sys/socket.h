@@ -370,6 +370,18 @@ struct omsghdr {
 	int	msg_accrightslen;
 };
 
+#if __BSD_VISIBLE
+/*
+ * sendfile(2) header/trailer struct
+ */
+struct sf_hdtr {
+	struct iovec *headers;	/* pointer to an array of header struct iovec's */
+	int hdr_cnt;		/* number of header iovec's */
+	struct iovec *trailers;	/* pointer to an array of trailer struct iovec's */
+	int trl_cnt;		/* number of trailer iovec's */
+};
+#endif
+
 /*
  * howto arguments for shutdown(2), specified by Posix.1g.
  */
@@ -394,6 +406,9 @@ ssize_t	send(int, const void *, size_t, int);
 ssize_t	sendto(int, const void *,
 	    size_t, int, const struct sockaddr *, socklen_t);
 ssize_t	sendmsg(int, const struct msghdr *, int);
+#if __BSD_VISIBLE
+int	sendfile(int, int, off_t, size_t, struct sf_hdtr *, off_t *, int);
+#endif
 int	setsockopt(int, int, int, const void *, socklen_t);
 int	shutdown(int, int);
 int	socket(int, int, int);
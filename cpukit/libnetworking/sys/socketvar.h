@@ -35,6 +35,7 @@
 
 #include <sys/queue.h>			/* for TAILQ macros */
 #include <sys/select.h>			/* for struct selinfo */
+#include <sys/event.h>			/* for struct knlist */
 
 
 /*
@@ -50,6 +51,7 @@ struct socket {
 	short	so_options;		/* from socket call, see socket.h */
 	short	so_linger;		/* time to linger while closing */
 	short	so_state;		/* internal state flags SS_*, below */
+	short	so_count;		/* references held by system calls */
 	void 	*so_pcb;		/* protocol control block */
 	struct	protosw *so_proto;	/* protocol handle */
 /*
@@ -90,6 +92,7 @@ struct socket {
 		int	sb_timeo;	/* timeout for read/write */
 		void	(*sb_wakeup)(struct socket *, void *);
 		void 	*sb_wakeuparg;	/* arg for above */
+		struct	knlist sb_note;	/* kernel event notes */
 	} so_rcv, so_snd;
 #define	SB_MAX		(256L*1024L)	/* default for max chars in sockbuf */
 #define	SB_LOCK		0x01		/* lock on data queue */
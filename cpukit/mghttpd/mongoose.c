@@ -210,6 +210,9 @@ typedef struct DIR {
 #ifdef HAVE_POLL
 #include <sys/poll.h>
 #endif
+#ifdef USE_KQUEUE
+#include <sys/event.h>
+#endif
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/time.h>
@@ -321,6 +324,11 @@ typedef int socklen_t;
 #define MGSQLEN 20
 #endif
 
+// Largest file kept in the static file cache
+#if !defined(MGFCMAXFILE)
+#define MGFCMAXFILE 16384
+#endif
+
 static const char *http_500_error = "Internal Server Error";
 
 #if defined(NO_SSL_DL)
@@ -444,8 +452,21 @@ struct file {
   // set to 1 if the content is gzipped
   // in which case we need a content-encoding: gzip header
   int gzipped;
+  struct file_cache_entry *cache_entry; // Non-NULL if membuf is cached
+};
+#define STRUCT_FILE_INITIALIZER {0, 0, 0, NULL, NULL, 0, NULL}
+
+// Contents of a small static file held in RAM. Entries are reference
+// counted, so that the cache may drop an entry while it is being sent.
+struct file_cache_entry {
+  struct file_cache_entry *next;  // Next entry, in most recently used order
+  struct mg_context *ctx;         // Cache owning this entry
+  int refs;                       // References, protected by file_cache_mutex
+  time_t modification_time;       // Validates the entry against mg_stat()
+  int64_t size;
+  char *path;                     // Stored after the file data
+  char data[1];
 };
-#define STRUCT_FILE_INITIALIZER {0, 0, 0, NULL, NULL, 0}
 
 // Describes listening socket, or socket which was accept()-ed by the master
 // thread and queued for future handling by the worker thread.
@@ -457,6 +478,15 @@ struct socket {
   unsigned ssl_redir:1; // Is port supposed to redirect everything to SSL port
 };
 
+#if defined(USE_KQUEUE)
+// Idle keep-alive connection watched by the master thread
+struct idle_socket {
+  struct socket client;
+  time_t idle_time;     // Time when the connection was parked
+  int in_use;
+};
+#endif
+
 // NOTE(lsm): this enum shoulds be in sync with the config_options below.
 enum {
   CGI_EXTENSIONS, CGI_ENVIRONMENT, PUT_DELETE_PASSWORDS_FILE, CGI_INTERPRETER,
@@ -466,6 +496,7 @@ enum {
   EXTRA_MIME_TYPES, LISTENING_PORTS, DOCUMENT_ROOT, SSL_CERTIFICATE,
   NUM_THREADS, RUN_AS_USER, REWRITE, HIDE_FILES, REQUEST_TIMEOUT,
   THREAD_STACK_SIZE, THREAD_PRIORITY, THREAD_POLICY,
+  KEEP_ALIVE_CONNECTIONS, STATIC_FILE_CACHE_SIZE,
   NUM_OPTIONS
 };
 
@@ -498,6 +529,8 @@ static const char *config_options[] = {
   "thread_stack_size", NULL,
   "thread_priority", NULL,
   "thread_policy", NULL,
+  "keep_alive_connections", "0",
+  "static_file_cache_size", "0",
   NULL
 };
 
@@ -520,6 +553,17 @@ struct mg_context {
   volatile int sq_tail;      // Tail of the socket queue
   pthread_cond_t sq_full;    // Signaled when socket is produced
   pthread_cond_t sq_empty;   // Signaled when socket is consumed
+
+#if defined(USE_KQUEUE)
+  int kq;                    // Master kqueue, -1 if not used
+  struct idle_socket *idle;  // Parked keep-alive connections
+  int num_idle_max;          // Size of the idle array
+#endif
+
+  pthread_mutex_t file_cache_mutex;      // Protects the static file cache
+  struct file_cache_entry *file_cache;   // Most recently used entry first
+  int64_t file_cache_used;               // Bytes of file data in the cache
+  int64_t file_cache_size;               // Cache limit, 0 disables the cache
 };
 
 struct mg_connection {
@@ -587,10 +631,134 @@ static int mg_fopen(struct mg_connection *conn, const char *path,
   return is_file_opened(filep);
 }
 
+static void file_cache_release(struct file_cache_entry *e) {
+  struct mg_context *ctx = e->ctx;
+  int refs;
+
+  (void) pthread_mutex_lock(&ctx->file_cache_mutex);
+  refs = --e->refs;
+  (void) pthread_mutex_unlock(&ctx->file_cache_mutex);
+
+  if (refs == 0) {
+    free(e);
+  }
+}
+
 static void mg_fclose(struct file *filep) {
   if (filep != NULL && filep->fp != NULL) {
     fclose(filep->fp);
   }
+  if (filep != NULL && filep->cache_entry != NULL) {
+    file_cache_release(filep->cache_entry);
+    filep->cache_entry = NULL;
+    filep->membuf = NULL;
+  }
+}
+
+// Remove the entry *link from the cache. Must be called with
+// file_cache_mutex held.
+static void file_cache_unlink(struct mg_context *ctx,
+                              struct file_cache_entry **link) {
+  struct file_cache_entry *e = *link;
+
+  *link = e->next;
+  ctx->file_cache_used -= e->size;
+  if (--e->refs == 0) {
+    free(e);
+  }
+}
+
+// Open a static file for a GET or HEAD request. Small files are served
+// from the static file cache, so that repeated requests neither touch the
+// file system nor allocate a FILE. The entry is validated against the
+// size and modification time which the caller obtained via mg_stat().
+static int file_cache_open(struct mg_connection *conn, const char *path,
+                           struct file *filep) {
+  struct mg_context *ctx = conn->ctx;
+  struct file_cache_entry *e, **link;
+  size_t path_len;
+
+  if (ctx->file_cache_size <= 0 || ctx->callbacks.open_file != NULL ||
+      filep->size > MGFCMAXFILE || filep->size > ctx->file_cache_size) {
+    return mg_fopen(conn, path, "rb", filep);
+  }
+
+  (void) pthread_mutex_lock(&ctx->file_cache_mutex);
+  for (link = &ctx->file_cache; (e = *link) != NULL; link = &e->next) {
+    if (strcmp(e->path, path) == 0) {
+      if (e->modification_time == filep->modification_time &&
+          e->size == filep->size) {
+        // Hit, move the entry to the front
+        *link = e->next;
+        e->next = ctx->file_cache;
+        ctx->file_cache = e;
+        e->refs++;
+        (void) pthread_mutex_unlock(&ctx->file_cache_mutex);
+
+        filep->cache_entry = e;
+        filep->membuf = e->data;
+        return 1;
+      }
+
+      // Stale, the file was modified
+      file_cache_unlink(ctx, link);
+      break;
+    }
+  }
+  (void) pthread_mutex_unlock(&ctx->file_cache_mutex);
+
+  if (!mg_fopen(conn, path, "rb", filep)) {
+    return 0;
+  }
+
+  path_len = strlen(path);
+  e = (struct file_cache_entry *) malloc(sizeof(*e) + (size_t) filep->size +
+                                         path_len + 1);
+  if (e == NULL) {
+    return 1;
+  }
+  if (fread(e->data, 1, (size_t) filep->size, filep->fp) !=
+      (size_t) filep->size) {
+    // Serve this request from the file, send_file_data() seeks anyway
+    free(e);
+    return 1;
+  }
+  e->ctx = ctx;
+  e->refs = 2;  // One for the cache and one for the caller
+  e->modification_time = filep->modification_time;
+  e->size = filep->size;
+  e->path = e->data + filep->size;
+  memcpy(e->path, path, path_len + 1);
+
+  (void) pthread_mutex_lock(&ctx->file_cache_mutex);
+
+  // Another worker may have cached the same file in the meantime
+  for (link = &ctx->file_cache; *link != NULL; link = &(*link)->next) {
+    if (strcmp((*link)->path, path) == 0) {
+      file_cache_unlink(ctx, link);
+      break;
+    }
+  }
+
+  // Evict the least recently used entries
+  while (ctx->file_cache != NULL &&
+         ctx->file_cache_used + e->size > ctx->file_cache_size) {
+    for (link = &ctx->file_cache; (*link)->next != NULL;
+         link = &(*link)->next) {
+    }
+    file_cache_unlink(ctx, link);
+  }
+
+  e->next = ctx->file_cache;
+  ctx->file_cache = e;
+  ctx->file_cache_used += e->size;
+  (void) pthread_mutex_unlock(&ctx->file_cache_mutex);
+
+  fclose(filep->fp);
+  filep->fp = NULL;
+  filep->cache_entry = e;
+  filep->membuf = e->data;
+  return 1;
 }
 
 static int get_option_index(const char *name) {
@@ -2956,6 +3124,26 @@ static void send_file_data(struct mg_connection *conn, struct file *filep,
     }
     mg_write(conn, filep->membuf + offset, (size_t) len);
   } else if (len > 0 && filep->fp != NULL) {
+#if defined(__rtems__)
+    // Let the network stack read regular files directly into its buffers
+    if (conn->ssl == NULL && conn->throttle <= 0 && filep->size > 0) {
+      int64_t want = len < filep->size - offset ? len : filep->size - offset;
+      off_t sent = 0;
+      int rv = sendfile(fileno(filep->fp), conn->client.sock, offset,
+                        len < filep->size - offset ? (size_t) len : 0,
+                        NULL, &sent, 0);
+
+      conn->num_bytes_sent += sent;
+      if (rv == 0 && sent == want) {
+        return;
+      }
+
+      // A failure or a send timeout may stop sendfile() at any point,
+      // continue with the loop below after the data it has sent
+      offset += sent;
+      len -= sent;
+    }
+#endif // __rtems__
     fseeko(filep->fp, offset, SEEK_SET);
     while (len > 0) {
       // Calculate how much to read from the file in the buffer
@@ -2964,13 +3152,16 @@ static void send_file_data(struct mg_connection *conn, struct file *filep,
         to_read = (int) len;
       }
 
-      // Read from file, exit the loop on error
+      // Read from file, exit the loop on error.  The body is incomplete
+      // then, so the connection must not be reused.
       if ((num_read = fread(buf, 1, (size_t) to_read, filep->fp)) <= 0) {
+        conn->must_close = 1;
         break;
       }
 
       // Send read bytes to the client, exit the loop on error
       if ((num_written = mg_write(conn, buf, (size_t) num_read)) != num_read) {
+        conn->must_close = 1;
         break;
       }
 
@@ -3028,7 +3219,7 @@ static void handle_file_request(struct mg_connection *conn, const char *path,
     encoding = "Content-Encoding: gzip\r\n";
   }
 
-  if (!mg_fopen(conn, path, "rb", filep)) {
+  if (!file_cache_open(conn, path, filep)) {
     send_http_error(conn, 500, http_500_error,
                     "fopen(%s): %s", path, strerror(ERRNO));
     return;
@@ -3045,6 +3236,7 @@ static void handle_file_request(struct mg_connection *conn, const char *path,
     // file (since the range is specified in the uncmpressed space)
     if (filep->gzipped) {
       send_http_error(conn, 501, "Not Implemented", "range requests in gzipped files are not supported");
+      mg_fclose(filep);
       return;
     }
     conn->status_code = 206;
@@ -5120,6 +5312,48 @@ struct mg_connection *mg_download(const char *host, int port, int use_ssl,
   return conn;
 }
 
+// Hand an idle keep-alive connection over to the master thread, which
+// watches it with its kqueue. This frees the worker for other connections
+// while the client thinks about its next request. Returns 1 if the
+// connection was parked.
+static int park_connection(struct mg_connection *conn) {
+#if defined(USE_KQUEUE)
+  struct mg_context *ctx = conn->ctx;
+  struct kevent change;
+  int i, parked = 0;
+
+  if (ctx->kq < 0 || conn->ssl != NULL) {
+    return 0;
+  }
+
+  (void) pthread_mutex_lock(&ctx->mutex);
+  for (i = 0; i < ctx->num_idle_max; i++) {
+    if (!ctx->idle[i].in_use) {
+      EV_SET(&change, conn->client.sock, EVFILT_READ, EV_ADD | EV_ONESHOT,
+             0, 0, (void *) (intptr_t) i);
+      if (kevent(ctx->kq, &change, 1, NULL, 0, NULL) == 0) {
+        ctx->idle[i].client = conn->client;
+        ctx->idle[i].idle_time = time(NULL);
+        ctx->idle[i].in_use = 1;
+        parked = 1;
+      }
+      break;
+    }
+  }
+  (void) pthread_mutex_unlock(&ctx->mutex);
+
+  if (parked) {
+    DEBUG_TRACE(("parked socket %d", conn->client.sock));
+    conn->client.sock = INVALID_SOCKET;
+  }
+
+  return parked;
+#else
+  (void) conn;
+  return 0;
+#endif
+}
+
 static void process_new_connection(struct mg_connection *conn) {
   struct mg_request_info *ri = &conn->request_info;
   int keep_alive_enabled, keep_alive, discard_len;
@@ -5174,7 +5408,11 @@ static void process_new_connection(struct mg_connection *conn) {
     conn->data_len -= discard_len;
     assert(conn->data_len >= 0);
     assert(conn->data_len <= conn->buf_size);
-  } while (keep_alive);
+
+    // Pipelined requests are served right away. Otherwise, the worker
+    // does not wait for the next request of an idle connection if the
+    // master thread can watch it.
+  } while (keep_alive && (conn->data_len > 0 || !park_connection(conn)));
 }
 
 // Worker threads take accepted socket from the queue
@@ -5323,6 +5561,103 @@ static void accept_new_connection(const struct socket *listener,
   }
 }
 
+#if defined(USE_KQUEUE)
+// Give a parked connection back to the workers once the client sent its
+// next request. Connections closed by the client are closed right here.
+static void resume_connection(struct mg_context *ctx, int i, SOCKET sock) {
+  struct socket so;
+  char c;
+  int n;
+
+  (void) pthread_mutex_lock(&ctx->mutex);
+  if (!ctx->idle[i].in_use || ctx->idle[i].client.sock != sock) {
+    (void) pthread_mutex_unlock(&ctx->mutex);
+    return;
+  }
+  so = ctx->idle[i].client;
+  ctx->idle[i].in_use = 0;
+  (void) pthread_mutex_unlock(&ctx->mutex);
+
+  n = recv(so.sock, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (n > 0 || (n < 0 && ERRNO == EWOULDBLOCK)) {
+    DEBUG_TRACE(("resumed socket %d", so.sock));
+    produce_socket(ctx, &so);
+  } else {
+    closesocket(so.sock);
+  }
+}
+
+// Close parked connections which were idle for longer than the request
+// timeout, or all of them if the server stops.
+static void expire_idle_connections(struct mg_context *ctx, int all) {
+  time_t now = time(NULL);
+  int timeout = atoi(ctx->config[REQUEST_TIMEOUT]) / 1000;
+  SOCKET sock;
+  int i;
+
+  for (i = 0; i < ctx->num_idle_max; i++) {
+    sock = INVALID_SOCKET;
+    (void) pthread_mutex_lock(&ctx->mutex);
+    if (ctx->idle[i].in_use &&
+        (all || now - ctx->idle[i].idle_time > timeout)) {
+      sock = ctx->idle[i].client.sock;
+      ctx->idle[i].in_use = 0;
+    }
+    (void) pthread_mutex_unlock(&ctx->mutex);
+
+    if (sock != INVALID_SOCKET) {
+      closesocket(sock);
+    }
+  }
+}
+
+// Wait for new connections and for the next request on parked keep-alive
+// connections with one kqueue. The listening sockets are identified by
+// a negative user data value, parked connections by their idle index.
+static void master_kqueue_loop(struct mg_context *ctx) {
+  struct kevent events[16];
+  struct timespec timeout;
+  time_t last_expire = time(NULL);
+  intptr_t index;
+  int i, n;
+
+  timeout.tv_sec = 0;
+  timeout.tv_nsec = 200 * 1000 * 1000;
+
+  while (ctx->stop_flag == 0) {
+    n = kevent(ctx->kq, NULL, 0, events, (int) ARRAY_SIZE(events), &timeout);
+    for (i = 0; i < n && ctx->stop_flag == 0; i++) {
+      index = (intptr_t) events[i].udata;
+      if (index < 0) {
+        accept_new_connection(&ctx->listening_sockets[-index - 1], ctx);
+      } else {
+        resume_connection(ctx, (int) index, (SOCKET) events[i].ident);
+      }
+    }
+
+    if (time(NULL) != last_expire) {
+      last_expire = time(NULL);
+      expire_idle_connections(ctx, 0);
+    }
+  }
+}
+
+static int kqueue_add_listening_sockets(struct mg_context *ctx) {
+  struct kevent change;
+  int i;
+
+  for (i = 0; i < ctx->num_listening_sockets; i++) {
+    EV_SET(&change, ctx->listening_sockets[i].sock, EVFILT_READ, EV_ADD,
+           0, 0, (void *) (intptr_t) -(i + 1));
+    if (kevent(ctx->kq, &change, 1, NULL, 0, NULL) != 0) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+#endif // USE_KQUEUE
+
 static void *master_thread(void *thread_func_param) {
   struct mg_context *ctx = (struct mg_context *) thread_func_param;
   struct pollfd *pfd;
@@ -5339,6 +5674,12 @@ static void *master_thread(void *thread_func_param) {
   pthread_setschedparam(pthread_self(), SCHED_RR, &sched_param);
 #endif
 
+#if defined(USE_KQUEUE)
+  if (ctx->kq >= 0) {
+    master_kqueue_loop(ctx);
+  }
+#endif
+
   pfd = (struct pollfd *) calloc(ctx->num_listening_sockets, sizeof(pfd[0]));
   while (pfd != NULL && ctx->stop_flag == 0) {
     for (i = 0; i < ctx->num_listening_sockets; i++) {
@@ -5374,8 +5715,17 @@ static void *master_thread(void *thread_func_param) {
   }
   (void) pthread_mutex_unlock(&ctx->mutex);
 
+#if defined(USE_KQUEUE)
+  // Workers may park connections until they exit
+  if (ctx->kq >= 0) {
+    expire_idle_connections(ctx, 1);
+    closesocket(ctx->kq);
+  }
+#endif
+
   // All threads exited, no sync is needed. Destroy mutex and condvars
   (void) pthread_mutex_destroy(&ctx->mutex);
+  (void) pthread_mutex_destroy(&ctx->file_cache_mutex);
   (void) pthread_cond_destroy(&ctx->cond);
   (void) pthread_cond_destroy(&ctx->sq_empty);
   (void) pthread_cond_destroy(&ctx->sq_full);
@@ -5401,6 +5751,17 @@ static void free_context(struct mg_context *ctx) {
       free(ctx->config[i]);
   }
 
+  // Deallocate the static file cache, all workers are gone
+  while (ctx->file_cache != NULL) {
+    struct file_cache_entry *e = ctx->file_cache;
+    ctx->file_cache = e->next;
+    free(e);
+  }
+
+#if defined(USE_KQUEUE)
+  free(ctx->idle);
+#endif
+
 #ifndef NO_SSL
   // Deallocate SSL context
   if (ctx->ssl_ctx != NULL) {
@@ -5500,7 +5861,34 @@ struct mg_context *mg_start(const struct mg_callbacks *callbacks,
   (void) signal(SIGCHLD, SIG_IGN);
 #endif // !_WIN32
 
+#if defined(USE_KQUEUE)
+  // Let the master thread watch idle keep-alive connections
+  ctx->kq = -1;
+  ctx->num_idle_max = atoi(ctx->config[KEEP_ALIVE_CONNECTIONS]);
+  if (ctx->num_idle_max > 0 &&
+      !strcmp(ctx->config[ENABLE_KEEP_ALIVE], "yes")) {
+    ctx->idle = (struct idle_socket *) calloc(ctx->num_idle_max,
+                                              sizeof(ctx->idle[0]));
+    if (ctx->idle == NULL || (ctx->kq = kqueue()) < 0 ||
+        !kqueue_add_listening_sockets(ctx)) {
+      cry(fc(ctx), "Cannot create keep-alive connection pool: %s",
+          strerror(ERRNO));
+      if (ctx->kq >= 0) {
+        closesocket(ctx->kq);
+      }
+      ctx->kq = -1;
+    }
+  }
+  if (ctx->kq < 0) {
+    ctx->num_idle_max = 0;
+  }
+#endif
+
+  ctx->file_cache_size = strtoll(ctx->config[STATIC_FILE_CACHE_SIZE],
+                                 NULL, 10);
+
   (void) pthread_mutex_init(&ctx->mutex, NULL);
+  (void) pthread_mutex_init(&ctx->file_cache_mutex, NULL);
   (void) pthread_cond_init(&ctx->cond, NULL);
   (void) pthread_cond_init(&ctx->sq_empty, NULL);
   (void) pthread_cond_init(&ctx->sq_full, NULL);
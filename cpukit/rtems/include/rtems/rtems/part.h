@@ -34,6 +34,7 @@
 #include <rtems/rtems/attr.h>
 #include <rtems/rtems/status.h>
 #include <rtems/rtems/types.h>
+#include <rtems/score/isrlock.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -55,6 +56,8 @@ extern "C" {
 typedef struct {
   /** This field is the object management portion of a Partition instance. */
   Objects_Control     Object;
+  /** This field is the lock protecting the buffer chain and usage count. */
+  ISR_LOCK_MEMBER( Lock )
   /** This field is the physical starting address of the Partition. */
   void               *starting_address;
   /** This field is the size of the Partition in bytes. */
@@ -149,6 +152,35 @@ rtems_status_code rtems_partition_get_buffer(
   void     **buffer
 );
 
+/**
+ * @brief RTEMS Get Partition Buffers
+ *
+ * This routine implements the rtems_partition_get_buffers directive.  It
+ * attempts to allocate up to count buffers from the partition associated
+ * with ID within one critical section.  The addresses of the allocated
+ * buffers are returned in the buffers array and the number of allocated
+ * buffers is returned in obtained.  The obtained count is zero if an error
+ * occurs.
+ *
+ * @param[in] id is the partition id
+ * @param[out] buffers is the array receiving the buffer addresses
+ * @param[in] count is the maximum number of buffers to allocate
+ * @param[out] obtained is the number of buffers actually allocated
+ *
+ * @retval RTEMS_SUCCESSFUL At least one buffer was allocated.
+ * @retval RTEMS_UNSATISFIED No buffer is available.
+ * @retval RTEMS_INVALID_ADDRESS The buffers or obtained pointer is NULL.
+ * @retval RTEMS_INVALID_NUMBER The count is zero.
+ * @retval RTEMS_INVALID_ID Invalid partition id.
+ * @retval RTEMS_ILLEGAL_ON_REMOTE_OBJECT The partition is remote.
+ */
+rtems_status_code rtems_partition_get_buffers(
+  rtems_id   id,
+  void     **buffers,
+  uint32_t   count,
+  uint32_t  *obtained
+);
+
 /**
  *  @brief rtems_partition_return_buffer
  *
@@ -189,6 +189,66 @@ RTEMS_INLINE_ROUTINE Partition_Control *_Partition_Get (
     _Objects_Get( &_Partition_Information, id, location );
 }
 
+/**
+ *  @brief Maps partition IDs to partition control blocks with interrupts
+ *  disabled.
+ *
+ *  In contrast to _Partition_Get() thread dispatching is not disabled for
+ *  local partitions.  The caller must use _Partition_Acquire_critical() and
+ *  _Partition_Release() to protect the buffer chain.
+ */
+RTEMS_INLINE_ROUTINE Partition_Control *_Partition_Get_interrupt_disable(
+  Objects_Id         id,
+  Objects_Locations *location,
+  ISR_lock_Context  *lock_context
+)
+{
+  return (Partition_Control *) _Objects_Get_isr_disable(
+    &_Partition_Information,
+    id,
+    location,
+    lock_context
+  );
+}
+
+RTEMS_INLINE_ROUTINE void _Partition_Initialize_lock(
+  Partition_Control *the_partition
+)
+{
+  _ISR_lock_Initialize( &the_partition->Lock, "Partition" );
+}
+
+RTEMS_INLINE_ROUTINE void _Partition_Destroy_lock(
+  Partition_Control *the_partition
+)
+{
+  _ISR_lock_Destroy( &the_partition->Lock );
+}
+
+RTEMS_INLINE_ROUTINE void _Partition_Acquire(
+  Partition_Control *the_partition,
+  ISR_lock_Context  *lock_context
+)
+{
+  _ISR_lock_ISR_disable_and_acquire( &the_partition->Lock, lock_context );
+}
+
+RTEMS_INLINE_ROUTINE void _Partition_Acquire_critical(
+  Partition_Control *the_partition,
+  ISR_lock_Context  *lock_context
+)
+{
+  _ISR_lock_Acquire( &the_partition->Lock, lock_context );
+}
+
+RTEMS_INLINE_ROUTINE void _Partition_Release(
+  Partition_Control *the_partition,
+  ISR_lock_Context  *lock_context
+)
+{
+  _ISR_lock_Release_and_ISR_enable( &the_partition->Lock, lock_context );
+}
+
 /**@}*/
 
 #ifdef __cplusplus
@@ -100,6 +100,8 @@ rtems_status_code rtems_partition_create(
   the_partition->attribute_set         = attribute_set;
   the_partition->number_of_used_blocks = 0;
 
+  _Partition_Initialize_lock( the_partition );
+
   _Chain_Initialize( &the_partition->Memory, starting_address,
                         length / buffer_size, buffer_size );
 
@@ -26,16 +26,20 @@ rtems_status_code rtems_partition_delete(
   rtems_id id
 )
 {
-   Partition_Control           *the_partition;
+  Partition_Control          *the_partition;
   Objects_Locations           location;
+  ISR_lock_Context            lock_context;
 
   _Objects_Allocator_lock();
   the_partition = _Partition_Get( id, &location );
   switch ( location ) {
 
     case OBJECTS_LOCAL:
+      _Partition_Acquire( the_partition, &lock_context );
+
       if ( the_partition->number_of_used_blocks == 0 ) {
         _Objects_Close( &_Partition_Information, &the_partition->Object );
+        _Partition_Release( the_partition, &lock_context );
 #if defined(RTEMS_MULTIPROCESSING)
         if ( _Attributes_Is_global( the_partition->attribute_set ) ) {
 
@@ -54,10 +58,12 @@ rtems_status_code rtems_partition_delete(
 #endif
 
         _Objects_Put( &the_partition->Object );
+        _Partition_Destroy_lock( the_partition );
         _Partition_Free( the_partition );
         _Objects_Allocator_unlock();
         return RTEMS_SUCCESSFUL;
       }
+      _Partition_Release( the_partition, &lock_context );
       _Objects_Put( &the_partition->Object );
       _Objects_Allocator_unlock();
       return RTEMS_RESOURCE_IN_USE;
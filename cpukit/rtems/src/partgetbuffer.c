@@ -30,25 +30,31 @@ rtems_status_code rtems_partition_get_buffer(
   void     **buffer
 )
 {
-   Partition_Control           *the_partition;
+  Partition_Control          *the_partition;
   Objects_Locations           location;
+  ISR_lock_Context            lock_context;
   void                       *the_buffer;
 
   if ( !buffer )
     return RTEMS_INVALID_ADDRESS;
 
-  the_partition = _Partition_Get( id, &location );
+  the_partition = _Partition_Get_interrupt_disable(
+    id,
+    &location,
+    &lock_context
+  );
   switch ( location ) {
 
     case OBJECTS_LOCAL:
+      _Partition_Acquire_critical( the_partition, &lock_context );
       the_buffer = _Partition_Allocate_buffer( the_partition );
       if ( the_buffer ) {
         the_partition->number_of_used_blocks += 1;
-        _Objects_Put( &the_partition->Object );
+        _Partition_Release( the_partition, &lock_context );
         *buffer = the_buffer;
         return RTEMS_SUCCESSFUL;
       }
-      _Objects_Put( &the_partition->Object );
+      _Partition_Release( the_partition, &lock_context );
       return RTEMS_UNSATISFIED;
 
 #if defined(RTEMS_MULTIPROCESSING)
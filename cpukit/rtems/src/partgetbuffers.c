@@ -0,0 +1,87 @@
+/**
+ *  @file
+ *
+ *  @brief RTEMS Get Partition Buffers
+ *  @ingroup ClassicPart
+ */
+
+/*
+ *  COPYRIGHT (c) 1989-2014.
+ *  On-Line Applications Research Corporation (OAR).
+ *
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <rtems/system.h>
+#include <rtems/rtems/status.h>
+#include <rtems/rtems/support.h>
+#include <rtems/score/address.h>
+#include <rtems/rtems/partimpl.h>
+#include <rtems/score/threaddispatch.h>
+
+rtems_status_code rtems_partition_get_buffers(
+  rtems_id   id,
+  void     **buffers,
+  uint32_t   count,
+  uint32_t  *obtained
+)
+{
+  Partition_Control          *the_partition;
+  Objects_Locations           location;
+  ISR_lock_Context            lock_context;
+  uint32_t                    n;
+
+  if ( !obtained )
+    return RTEMS_INVALID_ADDRESS;
+
+  *obtained = 0;
+
+  if ( !buffers )
+    return RTEMS_INVALID_ADDRESS;
+
+  if ( count == 0 )
+    return RTEMS_INVALID_NUMBER;
+
+  the_partition = _Partition_Get_interrupt_disable(
+    id,
+    &location,
+    &lock_context
+  );
+  switch ( location ) {
+
+    case OBJECTS_LOCAL:
+      _Partition_Acquire_critical( the_partition, &lock_context );
+
+      for ( n = 0 ; n < count ; ++n ) {
+        void *the_buffer = _Partition_Allocate_buffer( the_partition );
+
+        if ( the_buffer == NULL )
+          break;
+
+        buffers[ n ] = the_buffer;
+      }
+
+      the_partition->number_of_used_blocks += n;
+      _Partition_Release( the_partition, &lock_context );
+
+      *obtained = n;
+      return n > 0 ? RTEMS_SUCCESSFUL : RTEMS_UNSATISFIED;
+
+#if defined(RTEMS_MULTIPROCESSING)
+    case OBJECTS_REMOTE:
+      _Thread_Dispatch();
+      return RTEMS_ILLEGAL_ON_REMOTE_OBJECT;
+#endif
+
+    case OBJECTS_ERROR:
+      break;
+  }
+
+  return RTEMS_INVALID_ID;
+}
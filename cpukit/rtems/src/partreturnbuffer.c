@@ -41,20 +41,26 @@ rtems_status_code rtems_partition_return_buffer(
   void     *buffer
 )
 {
-   Partition_Control           *the_partition;
+  Partition_Control          *the_partition;
   Objects_Locations           location;
+  ISR_lock_Context            lock_context;
 
-  the_partition = _Partition_Get( id, &location );
+  the_partition = _Partition_Get_interrupt_disable(
+    id,
+    &location,
+    &lock_context
+  );
   switch ( location ) {
 
     case OBJECTS_LOCAL:
       if ( _Partition_Is_buffer_valid( buffer, the_partition ) ) {
+        _Partition_Acquire_critical( the_partition, &lock_context );
         _Partition_Free_buffer( the_partition, buffer );
         the_partition->number_of_used_blocks -= 1;
-        _Objects_Put( &the_partition->Object );
+        _Partition_Release( the_partition, &lock_context );
         return RTEMS_SUCCESSFUL;
       }
-      _Objects_Put( &the_partition->Object );
+      _ISR_lock_ISR_enable( &lock_context );
       return RTEMS_INVALID_ADDRESS;
 
 #if defined(RTEMS_MULTIPROCESSING)
@@ -174,6 +174,14 @@ const rtems_libio_helper rtems_fs_init_helper =
 #ifdef CONFIGURE_INIT
   rtems_libio_t rtems_libio_iops[CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS];
 
+  /**
+   * This is the bit map of the free file descriptors.  It has one bit per
+   * file descriptor.
+   */
+  Atomic_Uint rtems_libio_iop_free_map[
+    (CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS + 31) / 32
+  ];
+
   /**
    * When instantiating the configuration tables, this variable is
    * initialized to specify the maximum number of file descriptors.
@@ -256,28 +264,16 @@ const rtems_libio_helper rtems_fs_init_helper =
   #define CONFIGURE_MAXIMUM_PIPES 0
 #endif
 
-/**
- * This specifies the number of barriers required for the configured
- * number of FIFOs and named pipes.
- *
- * This is an internal parameter.
- */
-#if CONFIGURE_MAXIMUM_FIFOS > 0 || CONFIGURE_MAXIMUM_PIPES > 0
-  #define CONFIGURE_BARRIERS_FOR_FIFOS \
-    (2 * (CONFIGURE_MAXIMUM_FIFOS + CONFIGURE_MAXIMUM_PIPES))
-#else
-  #define CONFIGURE_BARRIERS_FOR_FIFOS   0
-#endif
-
 /**
  * This specifies the number of semaphores required for the configured
- * number of FIFOs and named pipes.
+ * number of FIFOs and named pipes.  Each pipe has a lock for its state and
+ * one for each of the reader and writer sides.
  *
  * This is an internal parameter.
  */
 #if CONFIGURE_MAXIMUM_FIFOS > 0 || CONFIGURE_MAXIMUM_PIPES > 0
   #define CONFIGURE_SEMAPHORES_FOR_FIFOS \
-    (1 + (CONFIGURE_MAXIMUM_FIFOS + CONFIGURE_MAXIMUM_PIPES))
+    (1 + 3 * (CONFIGURE_MAXIMUM_FIFOS + CONFIGURE_MAXIMUM_PIPES))
 #else
   #define CONFIGURE_SEMAPHORES_FOR_FIFOS 0
 #endif
@@ -723,6 +719,35 @@ const rtems_libio_helper rtems_fs_init_helper =
 
 #endif
 #endif
+
+/**
+ * This macro defines the number of entries of the path lookup cache.  The
+ * DOSFS and RFS use this cache to avoid directory scans during the path
+ * evaluation.  A value of zero disables the cache.
+ */
+#ifndef CONFIGURE_FILESYSTEM_DENTRY_CACHE_ENTRIES
+  #if defined(CONFIGURE_FILESYSTEM_DOSFS) || defined(CONFIGURE_FILESYSTEM_RFS)
+    #define CONFIGURE_FILESYSTEM_DENTRY_CACHE_ENTRIES 64
+  #else
+    #define CONFIGURE_FILESYSTEM_DENTRY_CACHE_ENTRIES 0
+  #endif
+#endif
+
+#ifdef CONFIGURE_INIT
+  #if CONFIGURE_FILESYSTEM_DENTRY_CACHE_ENTRIES > 0
+    static rtems_filesystem_dentry_cache_entry
+      _Configure_Dentry_cache[CONFIGURE_FILESYSTEM_DENTRY_CACHE_ENTRIES];
+
+    rtems_filesystem_dentry_cache_entry *const
+      rtems_filesystem_dentry_cache_table = &_Configure_Dentry_cache[0];
+  #else
+    rtems_filesystem_dentry_cache_entry *const
+      rtems_filesystem_dentry_cache_table = NULL;
+  #endif
+
+  const uint32_t rtems_filesystem_dentry_cache_size =
+    CONFIGURE_FILESYSTEM_DENTRY_CACHE_ENTRIES;
+#endif
 /**@}*/ /* end of file system group */
 
 /*
@@ -2321,8 +2346,7 @@ const rtems_libio_helper rtems_fs_init_helper =
    *
    * This is an internal parameter.
    */
-  #define CONFIGURE_BARRIERS \
-     (CONFIGURE_MAXIMUM_BARRIERS + CONFIGURE_BARRIERS_FOR_FIFOS)
+  #define CONFIGURE_BARRIERS CONFIGURE_MAXIMUM_BARRIERS
 
   /**
    * This macro is calculated to specify the memory required for
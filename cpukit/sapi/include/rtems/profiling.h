@@ -50,13 +50,25 @@ extern "C" {
  * system are available.
  *
  * Profiling information can be retrieved via rtems_profiling_iterate() and
- * reported as an XML dump via rtems_profiling_report_xml().  These functions
- * are always available, but actual profiling data is only available if enabled
- * at build configuration time.
+ * reported as an XML dump via rtems_profiling_report_xml().  The profiling
+ * statistics can be reset via rtems_profiling_reset(), so a report followed
+ * by a reset yields the statistics of the interval since the previous reset.
+ * These functions are always available, but actual profiling data is only
+ * available if enabled at build configuration time.
  *
  * @{
  */
 
+/**
+ * @brief Count of histogram buckets in profiling data.
+ *
+ * The histogram bucket with index N counts the events with a time in CPU
+ * counter ticks in the range of [2^N, 2^(N + 1)).  The first bucket also
+ * counts times of zero ticks.  Use rtems_profiling_histogram_upper_bound() to
+ * get the bucket bounds in nanoseconds.
+ */
+#define RTEMS_PROFILING_HISTOGRAM_COUNT 32
+
 /**
  * @brief Type of profiling data.
  */
@@ -174,6 +186,24 @@ typedef struct {
    * This value may overflow.
    */
   uint64_t total_interrupt_time;
+
+  /**
+   * @brief Histogram of the interrupt processing times.
+   *
+   * The values may overflow.
+   *
+   * @see RTEMS_PROFILING_HISTOGRAM_COUNT and max_interrupt_time.
+   */
+  uint32_t interrupt_time_histogram[RTEMS_PROFILING_HISTOGRAM_COUNT];
+
+  /**
+   * @brief Histogram of the interrupt delays if supported by the hardware.
+   *
+   * The values may overflow.
+   *
+   * @see RTEMS_PROFILING_HISTOGRAM_COUNT and max_interrupt_delay.
+   */
+  uint32_t interrupt_delay_histogram[RTEMS_PROFILING_HISTOGRAM_COUNT];
 } rtems_profiling_per_cpu;
 
 /**
@@ -181,6 +211,30 @@ typedef struct {
  */
 #define RTEMS_PROFILING_SMP_LOCK_CONTENTION_COUNTS 4
 
+/**
+ * @brief Count of contending call sites for SMP lock profiling.
+ */
+#define RTEMS_PROFILING_SMP_LOCK_CONTENDER_COUNT 4
+
+/**
+ * @brief A call site which acquired an SMP lock under contention.
+ */
+typedef struct {
+  /**
+   * @brief The return address of the lock acquire call or NULL if this entry
+   * is unused.
+   */
+  const void *caller;
+
+  /**
+   * @brief The approximate count of contended lock acquire operations of this
+   * call site.
+   *
+   * The count is an upper bound of the actual count.
+   */
+  uint64_t count;
+} rtems_profiling_smp_lock_contender;
+
 /**
  * @brief SMP lock profiling data.
  *
@@ -259,6 +313,21 @@ typedef struct {
    * The values may overflow.
    */
   uint64_t contention_counts[RTEMS_PROFILING_SMP_LOCK_CONTENTION_COUNTS];
+
+  /**
+   * @brief Histogram of the lock acquire times.
+   *
+   * The values may overflow.
+   *
+   * @see RTEMS_PROFILING_HISTOGRAM_COUNT.
+   */
+  uint32_t acquire_time_histogram[RTEMS_PROFILING_HISTOGRAM_COUNT];
+
+  /**
+   * @brief The call sites with the most contended lock acquire operations.
+   */
+  rtems_profiling_smp_lock_contender
+    contenders[RTEMS_PROFILING_SMP_LOCK_CONTENDER_COUNT];
 } rtems_profiling_smp_lock;
 
 /**
@@ -337,6 +406,43 @@ int rtems_profiling_report_xml(
   const char *indentation
 );
 
+/**
+ * @brief Resets the profiling statistics.
+ *
+ * The per-CPU statistics and the statistics of all SMP locks are set to zero.
+ * Updates carried out concurrently on other processors may get lost.
+ */
+void rtems_profiling_reset(void);
+
+/**
+ * @brief Returns the upper bound of a histogram bucket in nanoseconds.
+ *
+ * @param[in] index The histogram bucket index.
+ *
+ * @returns The upper bound of the histogram bucket in nanoseconds.
+ *
+ * @see RTEMS_PROFILING_HISTOGRAM_COUNT.
+ */
+uint64_t rtems_profiling_histogram_upper_bound(uint32_t index);
+
+/**
+ * @brief Returns an approximate percentile of a histogram in nanoseconds.
+ *
+ * The result is the upper bound of the histogram bucket which contains the
+ * percentile.
+ *
+ * @param[in] histogram The histogram with RTEMS_PROFILING_HISTOGRAM_COUNT
+ * buckets.
+ * @param[in] permille The percentile in permille, e.g. 990 for the 99th
+ * percentile.
+ *
+ * @returns The percentile in nanoseconds or zero if the histogram is empty.
+ */
+uint64_t rtems_profiling_histogram_percentile(
+  const uint32_t *histogram,
+  uint32_t permille
+);
+
 /** @} */
 
 #ifdef __cplusplus
@@ -0,0 +1,64 @@
+/**
+ * @file
+ *
+ * @ingroup Profiling
+ *
+ * @brief Profiling Histogram Evaluation
+ */
+
+/*
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include <rtems/profiling.h>
+#include <rtems/counter.h>
+
+uint64_t rtems_profiling_histogram_upper_bound(uint32_t index)
+{
+  rtems_counter_ticks ticks;
+
+  if (index >= RTEMS_PROFILING_HISTOGRAM_COUNT - 1) {
+    ticks = (rtems_counter_ticks) -1;
+  } else {
+    ticks = (rtems_counter_ticks) 1 << (index + 1);
+  }
+
+  return rtems_counter_ticks_to_nanoseconds(ticks);
+}
+
+uint64_t rtems_profiling_histogram_percentile(
+  const uint32_t *histogram,
+  uint32_t permille
+)
+{
+  uint64_t total = 0;
+  uint64_t sum = 0;
+  uint64_t threshold;
+  uint32_t i;
+
+  for (i = 0; i < RTEMS_PROFILING_HISTOGRAM_COUNT; ++i) {
+    total += histogram[i];
+  }
+
+  if (total == 0) {
+    return 0;
+  }
+
+  threshold = (total * permille + 999) / 1000;
+
+  for (i = 0; i < RTEMS_PROFILING_HISTOGRAM_COUNT - 1; ++i) {
+    sum += histogram[i];
+
+    if (sum >= threshold) {
+      break;
+    }
+  }
+
+  return rtems_profiling_histogram_upper_bound(i);
+}
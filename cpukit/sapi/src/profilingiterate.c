@@ -24,6 +24,13 @@
 
 #include <string.h>
 
+#if defined(RTEMS_PROFILING)
+RTEMS_STATIC_ASSERT(
+  RTEMS_PROFILING_HISTOGRAM_COUNT == PER_CPU_STATS_HISTOGRAM_COUNT,
+  per_cpu_histogram_count
+);
+#endif
+
 static void per_cpu_stats_iterate(
   rtems_profiling_visitor visitor,
   void *visitor_arg,
@@ -69,6 +76,18 @@ static void per_cpu_stats_iterate(
         stats->total_interrupt_time
       );
 
+    memcpy(
+      &per_cpu_data->interrupt_time_histogram[0],
+      &stats->interrupt_time_histogram[0],
+      sizeof(per_cpu_data->interrupt_time_histogram)
+    );
+
+    memcpy(
+      &per_cpu_data->interrupt_delay_histogram[0],
+      &stats->interrupt_delay_histogram[0],
+      sizeof(per_cpu_data->interrupt_delay_histogram)
+    );
+
     (*visitor)(visitor_arg, data);
   }
 #else
@@ -84,6 +103,16 @@ RTEMS_STATIC_ASSERT(
     == SMP_LOCK_STATS_CONTENTION_COUNTS,
   smp_lock_contention_counts
 );
+
+RTEMS_STATIC_ASSERT(
+  RTEMS_PROFILING_HISTOGRAM_COUNT == SMP_LOCK_STATS_HISTOGRAM_COUNT,
+  smp_lock_histogram_count
+);
+
+RTEMS_STATIC_ASSERT(
+  RTEMS_PROFILING_SMP_LOCK_CONTENDER_COUNT == SMP_LOCK_STATS_CONTENDER_COUNT,
+  smp_lock_contender_count
+);
 #endif
 
 static void smp_lock_stats_iterate(
@@ -96,6 +125,7 @@ static void smp_lock_stats_iterate(
   SMP_lock_Stats_iteration_context iteration_context;
   SMP_lock_Stats snapshot;
   char name[64];
+  size_t i;
 
   memset(data, 0, sizeof(*data));
   data->header.type = RTEMS_PROFILING_SMP_LOCK;
@@ -128,6 +158,17 @@ static void smp_lock_stats_iterate(
       sizeof(smp_lock_data->contention_counts)
     );
 
+    memcpy(
+      &smp_lock_data->acquire_time_histogram[0],
+      &snapshot.acquire_time_histogram[0],
+      sizeof(smp_lock_data->acquire_time_histogram)
+    );
+
+    for (i = 0; i < RTEMS_PROFILING_SMP_LOCK_CONTENDER_COUNT; ++i) {
+      smp_lock_data->contenders[i].caller = snapshot.contenders[i].caller;
+      smp_lock_data->contenders[i].count = snapshot.contenders[i].count;
+    }
+
     (*visitor)(visitor_arg, data);
   }
   _SMP_lock_Stats_iteration_stop(&iteration_context);
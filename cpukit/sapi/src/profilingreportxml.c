@@ -22,6 +22,8 @@
 
 #include <inttypes.h>
 
+#include <rtems/score/basedefs.h>
+
 typedef struct {
   rtems_profiling_printf printf_func;
   void *printf_arg;
@@ -54,6 +56,34 @@ static uint64_t arithmetic_mean(uint64_t total, uint64_t count)
   return count != 0 ? total / count : 0;
 }
 
+static const uint32_t percentiles[] = { 500, 900, 990, 999 };
+
+static void report_percentiles(
+  context *ctx,
+  const char *element,
+  const uint32_t *histogram
+)
+{
+  rtems_profiling_printf printf_func = ctx->printf_func;
+  void *printf_arg = ctx->printf_arg;
+  size_t i;
+
+  for (i = 0; i < RTEMS_ARRAY_SIZE(percentiles); ++i) {
+    int rv;
+
+    indent(ctx, 2);
+    rv = (*printf_func)(
+      printf_arg,
+      "<%s permille=\"%" PRIu32 "\" unit=\"ns\">%" PRIu64 "</%s>\n",
+      element,
+      percentiles[i],
+      rtems_profiling_histogram_percentile(histogram, percentiles[i]),
+      element
+    );
+    update_retval(ctx, rv);
+  }
+}
+
 static void report_per_cpu(context *ctx, const rtems_profiling_per_cpu *per_cpu)
 {
   rtems_profiling_printf printf_func = ctx->printf_func;
@@ -151,6 +181,18 @@ static void report_per_cpu(context *ctx, const rtems_profiling_per_cpu *per_cpu)
   );
   update_retval(ctx, rv);
 
+  report_percentiles(
+    ctx,
+    "InterruptTimePercentile",
+    &per_cpu->interrupt_time_histogram[0]
+  );
+
+  report_percentiles(
+    ctx,
+    "InterruptDelayPercentile",
+    &per_cpu->interrupt_delay_histogram[0]
+  );
+
   indent(ctx, 1);
   rv = (*printf_func)(
     printf_arg,
@@ -250,6 +292,28 @@ static void report_smp_lock(context *ctx, const rtems_profiling_smp_lock *smp_lo
     update_retval(ctx, rv);
   }
 
+  report_percentiles(
+    ctx,
+    "AcquireTimePercentile",
+    &smp_lock->acquire_time_histogram[0]
+  );
+
+  for (i = 0; i < RTEMS_PROFILING_SMP_LOCK_CONTENDER_COUNT; ++i) {
+    const rtems_profiling_smp_lock_contender *contender =
+      &smp_lock->contenders[i];
+
+    if (contender->caller != NULL) {
+      indent(ctx, 2);
+      rv = (*printf_func)(
+        printf_arg,
+        "<Contender caller=\"0x%08" PRIxPTR "\">%" PRIu64 "</Contender>\n",
+        (uintptr_t) contender->caller,
+        contender->count
+      );
+      update_retval(ctx, rv);
+    }
+  }
+
   indent(ctx, 1);
   rv = (*printf_func)(
     printf_arg,
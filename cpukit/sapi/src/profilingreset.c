@@ -0,0 +1,64 @@
+/**
+ * @file
+ *
+ * @ingroup Profiling
+ *
+ * @brief Profiling Statistics Reset
+ */
+
+/*
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include <rtems/profiling.h>
+#include <rtems/counter.h>
+#include <rtems/score/percpu.h>
+#include <rtems/score/smplock.h>
+#include <rtems.h>
+
+#include <string.h>
+
+static void per_cpu_stats_reset(void)
+{
+#ifdef RTEMS_PROFILING
+  uint32_t n = rtems_get_processor_count();
+  uint32_t i;
+
+  for (i = 0; i < n; ++i) {
+    Per_CPU_Control *per_cpu = _Per_CPU_Get_by_index(i);
+    Per_CPU_Stats *stats = &per_cpu->Stats;
+    CPU_Counter_ticks thread_dispatch_disabled_instant;
+    ISR_Level level;
+
+    /*
+     * The statistics of other processors are not protected, so concurrent
+     * updates may get lost.  The thread dispatch disabled instant is still in
+     * use in case thread dispatching is currently disabled.
+     */
+    _ISR_Disable_without_giant(level);
+    thread_dispatch_disabled_instant = stats->thread_dispatch_disabled_instant;
+    memset(stats, 0, sizeof(*stats));
+    stats->thread_dispatch_disabled_instant = thread_dispatch_disabled_instant;
+    _ISR_Enable_without_giant(level);
+  }
+#endif
+}
+
+static void smp_lock_stats_reset(void)
+{
+#if defined(RTEMS_PROFILING) && defined(RTEMS_SMP)
+  _SMP_lock_Stats_reset_all();
+#endif
+}
+
+void rtems_profiling_reset(void)
+{
+  per_cpu_stats_reset();
+  smp_lock_stats_reset();
+}
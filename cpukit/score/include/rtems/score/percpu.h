@@ -41,7 +41,7 @@ extern "C" {
    * processor.
    */
   #if defined( RTEMS_PROFILING )
-    #define PER_CPU_CONTROL_SIZE_LOG2 8
+    #define PER_CPU_CONTROL_SIZE_LOG2 10
   #else
     #define PER_CPU_CONTROL_SIZE_LOG2 7
   #endif
@@ -153,6 +153,17 @@ typedef enum {
 
 #endif /* defined( RTEMS_SMP ) */
 
+#if defined( RTEMS_PROFILING )
+/**
+ * @brief Count of histogram buckets for per-CPU statistics.
+ *
+ * The histogram bucket with index N counts the events with a time in CPU
+ * counter ticks in the range of [2^N, 2^(N + 1)).  The first bucket also
+ * counts times of zero ticks.
+ */
+#define PER_CPU_STATS_HISTOGRAM_COUNT 32
+#endif
+
 /**
  * @brief Per-CPU statistics.
  */
@@ -222,6 +233,24 @@ typedef struct {
    * This value may overflow.
    */
   uint64_t total_interrupt_time;
+
+  /**
+   * @brief Histogram of the interrupt processing times.
+   *
+   * The values may overflow.
+   *
+   * @see PER_CPU_STATS_HISTOGRAM_COUNT and max_interrupt_time.
+   */
+  uint32_t interrupt_time_histogram[ PER_CPU_STATS_HISTOGRAM_COUNT ];
+
+  /**
+   * @brief Histogram of the interrupt delays if supported by the hardware.
+   *
+   * The values may overflow.
+   *
+   * @see PER_CPU_STATS_HISTOGRAM_COUNT and max_interrupt_delay.
+   */
+  uint32_t interrupt_delay_histogram[ PER_CPU_STATS_HISTOGRAM_COUNT ];
 #endif /* defined( RTEMS_PROFILING ) */
 } Per_CPU_Stats;
 
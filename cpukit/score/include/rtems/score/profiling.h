@@ -38,6 +38,34 @@ extern "C" {
  * @{
  */
 
+#if defined( RTEMS_PROFILING )
+/**
+ * @brief Returns the per-CPU statistics histogram bucket index for a time in
+ * CPU counter ticks.
+ *
+ * @see PER_CPU_STATS_HISTOGRAM_COUNT.
+ */
+static inline unsigned int _Profiling_Histogram_index(
+  CPU_Counter_ticks delta
+)
+{
+  unsigned int index;
+
+  if ( delta == 0 ) {
+    return 0;
+  }
+
+  index = sizeof( unsigned long ) * 8 - 1
+    - (unsigned int) __builtin_clzl( (unsigned long) delta );
+
+  if ( index >= PER_CPU_STATS_HISTOGRAM_COUNT ) {
+    index = PER_CPU_STATS_HISTOGRAM_COUNT - 1;
+  }
+
+  return index;
+}
+#endif
+
 static inline void _Profiling_Thread_dispatch_disable(
   Per_CPU_Control *cpu,
   uint32_t previous_thread_dispatch_disable_level
@@ -113,6 +141,10 @@ static inline void _Profiling_Update_max_interrupt_delay(
   if ( stats->max_interrupt_delay < interrupt_delay ) {
     stats->max_interrupt_delay = interrupt_delay;
   }
+
+  ++stats->interrupt_delay_histogram[
+    _Profiling_Histogram_index( interrupt_delay )
+  ];
 #else
   (void) cpu;
   (void) interrupt_delay;
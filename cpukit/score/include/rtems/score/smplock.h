@@ -48,12 +48,16 @@ extern "C" {
  * @brief The SMP lock provides mutual exclusion for SMP systems at the lowest
  * level.
  *
- * The SMP lock is implemented as a ticket lock.  This provides fairness in
- * case of concurrent lock attempts.
+ * The SMP lock is implemented as a ticket lock by default.  This provides
+ * fairness in case of concurrent lock attempts.  In case RTEMS_SMP_LOCK_MCS is
+ * defined (configure option --enable-smp-mcs-lock), then the SMP lock is
+ * implemented as a Mellor-Crummey and Scott (MCS) queue lock.  This provides
+ * fairness as well, but each waiting processor spins on a flag in its own
+ * local lock context, so the lock scales better under high contention.
  *
- * This SMP lock API uses a local context for acquire and release pairs.  Such
- * a context may be used to implement for example the Mellor-Crummey and Scott
- * (MCS) locks in the future.
+ * This SMP lock API uses a local context for acquire and release pairs.  The
+ * same context object must be used for the acquire and the corresponding
+ * release and it must not move in memory in between.
  *
  * @{
  */
@@ -65,6 +69,38 @@ extern "C" {
  */
 #define SMP_LOCK_STATS_CONTENTION_COUNTS 4
 
+/**
+ * @brief Count of lock acquire time histogram buckets for lock statistics.
+ *
+ * The histogram bucket with index N counts the lock acquire operations with
+ * an acquire time in CPU counter ticks in the range of [2^N, 2^(N + 1)).  The
+ * first bucket also counts acquire times of zero ticks.
+ */
+#define SMP_LOCK_STATS_HISTOGRAM_COUNT 32
+
+/**
+ * @brief Count of contending call sites tracked by the lock statistics.
+ */
+#define SMP_LOCK_STATS_CONTENDER_COUNT 4
+
+/**
+ * @brief A call site which acquired a lock under contention.
+ */
+typedef struct {
+  /**
+   * @brief The return address of the lock acquire call.
+   */
+  const void *caller;
+
+  /**
+   * @brief The approximate count of contended lock acquire operations of this
+   * call site.
+   *
+   * This value may overflow.
+   */
+  uint64_t count;
+} SMP_lock_Stats_contender;
+
 /**
  * @brief SMP lock statistics.
  *
@@ -139,6 +175,25 @@ typedef struct {
    */
   uint64_t total_section_time;
 
+  /**
+   * @brief Histogram of the lock acquire times.
+   *
+   * The values may overflow.
+   *
+   * @see SMP_LOCK_STATS_HISTOGRAM_COUNT.
+   */
+  uint32_t acquire_time_histogram[SMP_LOCK_STATS_HISTOGRAM_COUNT];
+
+  /**
+   * @brief The call sites with the most contended lock acquire operations.
+   *
+   * This table is maintained with the space-saving algorithm, so the counts
+   * are upper bounds of the actual counts.  The table is only maintained for
+   * lock acquire operations via _SMP_lock_Acquire() and
+   * _SMP_lock_ISR_disable_and_acquire().
+   */
+  SMP_lock_Stats_contender contenders[SMP_LOCK_STATS_CONTENDER_COUNT];
+
   /**
    * @brief The lock name.
    */
@@ -160,13 +215,19 @@ typedef struct {
    * @brief The lock stats used for the last lock acquire.
    */
   SMP_lock_Stats *stats;
+
+  /**
+   * @brief The initial queue length of the last lock acquire.
+   */
+  unsigned int initial_queue_length;
 } SMP_lock_Stats_context;
 
 /**
  * @brief SMP lock statistics initializer for static initialization.
  */
 #define SMP_LOCK_STATS_INITIALIZER( name ) \
-  { { NULL, NULL }, 0, 0, 0, 0, { 0, 0, 0, 0 }, 0, name }
+  { { NULL, NULL }, 0, 0, 0, 0, { 0, 0, 0, 0 }, 0, { 0 }, { { NULL, 0 } }, \
+    name }
 
 /**
  * @brief Initializes an SMP lock statistics block.
@@ -192,6 +253,142 @@ static inline void _SMP_lock_Stats_initialize(
  */
 static inline void _SMP_lock_Stats_destroy( SMP_lock_Stats *stats );
 
+/**
+ * @brief Returns the histogram bucket index for a time in CPU counter ticks.
+ *
+ * @param[in] delta The time in CPU counter ticks.
+ *
+ * @return The histogram bucket index.
+ *
+ * @see SMP_LOCK_STATS_HISTOGRAM_COUNT.
+ */
+static inline unsigned int _SMP_lock_Stats_histogram_index(
+  CPU_Counter_ticks delta
+)
+{
+  unsigned int index;
+
+  if ( delta == 0 ) {
+    return 0;
+  }
+
+  index = sizeof( unsigned long ) * 8 - 1
+    - (unsigned int) __builtin_clzl( (unsigned long) delta );
+
+  if ( index >= SMP_LOCK_STATS_HISTOGRAM_COUNT ) {
+    index = SMP_LOCK_STATS_HISTOGRAM_COUNT - 1;
+  }
+
+  return index;
+}
+
+/**
+ * @brief Updates an SMP lock statistics block after a lock acquire.
+ *
+ * @param[in] stats The SMP lock statistics block.
+ * @param[out] stats_context The SMP lock statistics context.
+ * @param[in] first The lock acquire attempt instant.
+ * @param[in] second The lock acquire instant.
+ * @param[in] initial_queue_length The initial queue length of the lock
+ * acquire attempt.
+ */
+static inline void _SMP_lock_Stats_acquire_update(
+  SMP_lock_Stats *stats,
+  SMP_lock_Stats_context *stats_context,
+  CPU_Counter_ticks first,
+  CPU_Counter_ticks second,
+  unsigned int initial_queue_length
+)
+{
+  CPU_Counter_ticks delta = _CPU_Counter_difference( second, first );
+
+  stats_context->acquire_instant = second;
+  stats_context->initial_queue_length = initial_queue_length;
+
+  ++stats->usage_count;
+
+  stats->total_acquire_time += delta;
+
+  if ( stats->max_acquire_time < delta ) {
+    stats->max_acquire_time = delta;
+  }
+
+  ++stats->acquire_time_histogram[ _SMP_lock_Stats_histogram_index( delta ) ];
+
+  if ( initial_queue_length >= SMP_LOCK_STATS_CONTENTION_COUNTS ) {
+    initial_queue_length = SMP_LOCK_STATS_CONTENTION_COUNTS - 1;
+  }
+  ++stats->contention_counts[initial_queue_length];
+
+  stats_context->stats = stats;
+}
+
+/**
+ * @brief Updates the contending call sites of an SMP lock statistics block.
+ *
+ * The caller must own the lock.  Only contended lock acquire operations are
+ * accounted.
+ *
+ * @param[in] stats The SMP lock statistics block.
+ * @param[in] stats_context The SMP lock statistics context of the lock
+ * acquire.
+ * @param[in] caller The return address of the lock acquire call.
+ */
+static inline void _SMP_lock_Stats_contender_update(
+  SMP_lock_Stats *stats,
+  const SMP_lock_Stats_context *stats_context,
+  const void *caller
+)
+{
+  SMP_lock_Stats_contender *min;
+  size_t i;
+
+  if ( stats_context->initial_queue_length == 0 ) {
+    return;
+  }
+
+  min = &stats->contenders[ 0 ];
+
+  for ( i = 0; i < SMP_LOCK_STATS_CONTENDER_COUNT; ++i ) {
+    SMP_lock_Stats_contender *contender = &stats->contenders[ i ];
+
+    if ( contender->caller == caller ) {
+      ++contender->count;
+      return;
+    }
+
+    if ( contender->count < min->count ) {
+      min = contender;
+    }
+  }
+
+  /* The new call site inherits the count of the evicted call site */
+  min->caller = caller;
+  ++min->count;
+}
+
+/**
+ * @brief Resets the values of an SMP lock statistics block.
+ *
+ * The chain node and the name are not affected.
+ *
+ * @param[in] stats The SMP lock statistics block.
+ */
+static inline void _SMP_lock_Stats_reset( SMP_lock_Stats *stats )
+{
+  Chain_Node node = stats->Node;
+  const char *name = stats->name;
+
+  memset( stats, 0, sizeof( *stats ) );
+  stats->Node = node;
+  stats->name = name;
+}
+
+/**
+ * @brief Resets all SMP lock statistics blocks registered in the system.
+ */
+void _SMP_lock_Stats_reset_all( void );
+
 /**
  * @brief Updates an SMP lock statistics block during a lock release.
  *
@@ -269,8 +466,6 @@ static inline void _SMP_ticket_lock_Do_acquire(
 
 #if defined( RTEMS_PROFILING )
   CPU_Counter_ticks first;
-  CPU_Counter_ticks second;
-  CPU_Counter_ticks delta;
   unsigned int initial_queue_length;
 
   first = _CPU_Counter_read();
@@ -295,24 +490,13 @@ static inline void _SMP_ticket_lock_Do_acquire(
 #if defined( RTEMS_PROFILING )
   }
 
-  second = _CPU_Counter_read();
-  stats_context->acquire_instant = second;
-  delta = _CPU_Counter_difference( second, first );
-
-  ++stats->usage_count;
-
-  stats->total_acquire_time += delta;
-
-  if ( stats->max_acquire_time < delta ) {
-    stats->max_acquire_time = delta;
-  }
-
-  if ( initial_queue_length >= SMP_LOCK_STATS_CONTENTION_COUNTS ) {
-    initial_queue_length = SMP_LOCK_STATS_CONTENTION_COUNTS - 1;
-  }
-  ++stats->contention_counts[initial_queue_length];
-
-  stats_context->stats = stats;
+  _SMP_lock_Stats_acquire_update(
+    stats,
+    stats_context,
+    first,
+    _CPU_Counter_read(),
+    initial_queue_length
+  );
 #endif
 }
 
@@ -368,11 +552,210 @@ static inline void _SMP_ticket_lock_Do_release(
     _SMP_ticket_lock_Do_release( lock )
 #endif
 
+/**
+ * @brief SMP MCS lock context.
+ *
+ * Each processor trying to acquire an SMP MCS lock enqueues its context and
+ * spins on the locked indicator of this context.
+ */
+typedef struct SMP_MCS_lock_Context {
+  /**
+   * @brief The next context in the lock queue.
+   *
+   * The value is a pointer to an SMP_MCS_lock_Context.
+   */
+  Atomic_Pointer next;
+
+  /**
+   * @brief Indicates if the owner of this context must still wait for the
+   * lock.
+   */
+  Atomic_Uint locked;
+} SMP_MCS_lock_Context;
+
+/**
+ * @brief SMP MCS lock control.
+ */
+typedef struct {
+  /**
+   * @brief The tail of the lock queue.
+   *
+   * The value is a pointer to the SMP_MCS_lock_Context of the last processor
+   * in the queue or NULL in case the lock is not owned.
+   */
+  Atomic_Pointer queue;
+} SMP_MCS_lock_Control;
+
+/**
+ * @brief SMP MCS lock control initializer for static initialization.
+ */
+#define SMP_MCS_LOCK_INITIALIZER { ATOMIC_INITIALIZER_PTR( NULL ) }
+
+/**
+ * @brief Initializes an SMP MCS lock.
+ *
+ * Concurrent initialization leads to unpredictable results.
+ *
+ * @param[in] lock The SMP MCS lock control.
+ */
+static inline void _SMP_MCS_lock_Initialize( SMP_MCS_lock_Control *lock )
+{
+  _Atomic_Init_ptr( &lock->queue, NULL );
+}
+
+/**
+ * @brief Destroys an SMP MCS lock.
+ *
+ * Concurrent destruction leads to unpredictable results.
+ *
+ * @param[in] lock The SMP MCS lock control.
+ */
+static inline void _SMP_MCS_lock_Destroy( SMP_MCS_lock_Control *lock )
+{
+  (void) lock;
+}
+
+static inline void _SMP_MCS_lock_Do_acquire(
+  SMP_MCS_lock_Control *lock,
+  SMP_MCS_lock_Context *context
+#if defined( RTEMS_PROFILING )
+  ,
+  SMP_lock_Stats *stats,
+  SMP_lock_Stats_context *stats_context
+#endif
+)
+{
+  SMP_MCS_lock_Context *previous;
+
+#if defined( RTEMS_PROFILING )
+  CPU_Counter_ticks first;
+
+  first = _CPU_Counter_read();
+#endif
+
+  _Atomic_Store_ptr( &context->next, NULL, ATOMIC_ORDER_RELAXED );
+  _Atomic_Store_uint( &context->locked, 1U, ATOMIC_ORDER_RELAXED );
+
+  previous = (SMP_MCS_lock_Context *) _Atomic_Exchange_ptr(
+    &lock->queue,
+    context,
+    ATOMIC_ORDER_ACQ_REL
+  );
+
+  if ( previous != NULL ) {
+    unsigned int locked;
+
+    _Atomic_Store_ptr( &previous->next, context, ATOMIC_ORDER_RELEASE );
+
+    do {
+      locked = _Atomic_Load_uint( &context->locked, ATOMIC_ORDER_ACQUIRE );
+    } while ( locked != 0 );
+  }
+
+#if defined( RTEMS_PROFILING )
+  /*
+   * The queue length is not known to a new MCS lock waiter, so only a
+   * distinction between uncontended and contended acquire attempts is made.
+   */
+  _SMP_lock_Stats_acquire_update(
+    stats,
+    stats_context,
+    first,
+    _CPU_Counter_read(),
+    previous != NULL ? 1 : 0
+  );
+#endif
+}
+
+/**
+ * @brief Acquires an SMP MCS lock.
+ *
+ * This function will not disable interrupts.  The caller must ensure that the
+ * current thread of execution is not interrupted indefinite once it obtained
+ * the SMP MCS lock.
+ *
+ * @param[in] lock The SMP MCS lock control.
+ * @param[in] context The SMP MCS lock context.  It must be used for the
+ * corresponding release.
+ * @param[in] stats The SMP lock statistics.
+ * @param[out] stats_context The SMP lock statistics context.
+ */
+#if defined( RTEMS_PROFILING )
+  #define _SMP_MCS_lock_Acquire( lock, context, stats, stats_context ) \
+    _SMP_MCS_lock_Do_acquire( lock, context, stats, stats_context )
+#else
+  #define _SMP_MCS_lock_Acquire( lock, context, stats, stats_context ) \
+    _SMP_MCS_lock_Do_acquire( lock, context )
+#endif
+
+static inline void _SMP_MCS_lock_Do_release(
+  SMP_MCS_lock_Control *lock,
+  SMP_MCS_lock_Context *context
+#if defined( RTEMS_PROFILING )
+  ,
+  const SMP_lock_Stats_context *stats_context
+#endif
+)
+{
+  SMP_MCS_lock_Context *next;
+
+#if defined( RTEMS_PROFILING )
+  _SMP_lock_Stats_release_update( stats_context );
+#endif
+
+  next = (SMP_MCS_lock_Context *)
+    _Atomic_Load_ptr( &context->next, ATOMIC_ORDER_ACQUIRE );
+
+  if ( next == NULL ) {
+    void *expected = context;
+    bool success;
+
+    success = _Atomic_Compare_exchange_ptr(
+      &lock->queue,
+      &expected,
+      NULL,
+      ATOMIC_ORDER_RELEASE,
+      ATOMIC_ORDER_RELAXED
+    );
+
+    if ( success ) {
+      return;
+    }
+
+    /* A new waiter enqueued itself, wait until it published its context */
+    do {
+      next = (SMP_MCS_lock_Context *)
+        _Atomic_Load_ptr( &context->next, ATOMIC_ORDER_ACQUIRE );
+    } while ( next == NULL );
+  }
+
+  _Atomic_Store_uint( &next->locked, 0U, ATOMIC_ORDER_RELEASE );
+}
+
+/**
+ * @brief Releases an SMP MCS lock.
+ *
+ * @param[in] lock The SMP MCS lock control.
+ * @param[in] context The SMP MCS lock context used for the acquire.
+ * @param[in] stats_context The SMP lock statistics context.
+ */
+#if defined( RTEMS_PROFILING )
+  #define _SMP_MCS_lock_Release( lock, context, stats_context ) \
+    _SMP_MCS_lock_Do_release( lock, context, stats_context )
+#else
+  #define _SMP_MCS_lock_Release( lock, context, stats_context ) \
+    _SMP_MCS_lock_Do_release( lock, context )
+#endif
+
 /**
  * @brief SMP lock control.
  */
 typedef struct {
+#if defined( RTEMS_SMP_LOCK_MCS )
+  SMP_MCS_lock_Control MCS_lock;
+#else
   SMP_ticket_lock_Control Ticket_lock;
+#endif
 #if defined( RTEMS_PROFILING )
   SMP_lock_Stats Stats;
 #endif
@@ -383,19 +766,31 @@ typedef struct {
  */
 typedef struct {
   ISR_Level isr_level;
+#if defined( RTEMS_SMP_LOCK_MCS )
+  SMP_MCS_lock_Context MCS_context;
+#endif
 #if defined( RTEMS_PROFILING )
   SMP_lock_Stats_context Stats_context;
 #endif
 } SMP_lock_Context;
 
+/**
+ * @brief SMP lock implementation initializer for static initialization.
+ */
+#if defined( RTEMS_SMP_LOCK_MCS )
+  #define SMP_LOCK_IMPL_INITIALIZER SMP_MCS_LOCK_INITIALIZER
+#else
+  #define SMP_LOCK_IMPL_INITIALIZER SMP_TICKET_LOCK_INITIALIZER
+#endif
+
 /**
  * @brief SMP lock control initializer for static initialization.
  */
 #if defined( RTEMS_PROFILING )
   #define SMP_LOCK_INITIALIZER( name ) \
-    { SMP_TICKET_LOCK_INITIALIZER, SMP_LOCK_STATS_INITIALIZER( name ) }
+    { SMP_LOCK_IMPL_INITIALIZER, SMP_LOCK_STATS_INITIALIZER( name ) }
 #else
-  #define SMP_LOCK_INITIALIZER( name ) { SMP_TICKET_LOCK_INITIALIZER }
+  #define SMP_LOCK_INITIALIZER( name ) { SMP_LOCK_IMPL_INITIALIZER }
 #endif
 
 /**
@@ -421,7 +816,11 @@ static inline void _SMP_lock_Initialize(
   const char *name
 )
 {
+#if defined( RTEMS_SMP_LOCK_MCS )
+  _SMP_MCS_lock_Initialize( &lock->MCS_lock );
+#else
   _SMP_ticket_lock_Initialize( &lock->Ticket_lock );
+#endif
 #if defined( RTEMS_PROFILING )
   _SMP_lock_Stats_initialize( &lock->Stats, name );
 #else
@@ -444,7 +843,11 @@ static inline void _SMP_lock_Destroy_body( SMP_lock_Control *lock )
 static inline void _SMP_lock_Destroy( SMP_lock_Control *lock )
 #endif
 {
+#if defined( RTEMS_SMP_LOCK_MCS )
+  _SMP_MCS_lock_Destroy( &lock->MCS_lock );
+#else
   _SMP_ticket_lock_Destroy( &lock->Ticket_lock );
+#endif
   _SMP_lock_Stats_destroy( &lock->Stats );
 }
 
@@ -474,11 +877,20 @@ static inline void _SMP_lock_Acquire(
 )
 {
   (void) context;
+#if defined( RTEMS_SMP_LOCK_MCS )
+  _SMP_MCS_lock_Acquire(
+    &lock->MCS_lock,
+    &context->MCS_context,
+    &lock->Stats,
+    &context->Stats_context
+  );
+#else
   _SMP_ticket_lock_Acquire(
     &lock->Ticket_lock,
     &lock->Stats,
     &context->Stats_context
   );
+#endif
 }
 
 /**
@@ -503,10 +915,18 @@ static inline void _SMP_lock_Release(
 )
 {
   (void) context;
+#if defined( RTEMS_SMP_LOCK_MCS )
+  _SMP_MCS_lock_Release(
+    &lock->MCS_lock,
+    &context->MCS_context,
+    &context->Stats_context
+  );
+#else
   _SMP_ticket_lock_Release(
     &lock->Ticket_lock,
     &context->Stats_context
   );
+#endif
 }
 
 /**
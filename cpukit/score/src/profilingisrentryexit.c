@@ -37,6 +37,8 @@ void _Profiling_Outer_most_interrupt_entry_and_exit(
   if ( stats->max_interrupt_time < delta ) {
     stats->max_interrupt_time = delta;
   }
+
+  ++stats->interrupt_time_histogram[ _Profiling_Histogram_index( delta ) ];
 #else
   (void) cpu;
   (void) interrupt_entry_instant;
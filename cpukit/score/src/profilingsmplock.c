@@ -21,10 +21,11 @@
 #if defined( RTEMS_PROFILING )
 SMP_lock_Stats_control _SMP_lock_Stats_control = {
   .Lock = {
-    .Ticket_lock = {
-      .next_ticket = ATOMIC_INITIALIZER_UINT( 0U ),
-      .now_serving = ATOMIC_INITIALIZER_UINT( 0U )
-    },
+#if defined( RTEMS_SMP_LOCK_MCS )
+    .MCS_lock = SMP_MCS_LOCK_INITIALIZER,
+#else
+    .Ticket_lock = SMP_TICKET_LOCK_INITIALIZER,
+#endif
     .Stats = {
       .Node = CHAIN_NODE_INITIALIZER_ONE_NODE_CHAIN(
         &_SMP_lock_Stats_control.Stats_chain
@@ -39,4 +40,28 @@ SMP_lock_Stats_control _SMP_lock_Stats_control = {
     _SMP_lock_Stats_control.Iterator_chain
   )
 };
+
+void _SMP_lock_Stats_reset_all( void )
+{
+  SMP_lock_Stats_control *control = &_SMP_lock_Stats_control;
+  SMP_lock_Context lock_context;
+  Chain_Node *node;
+  const Chain_Node *tail;
+
+  _SMP_lock_ISR_disable_and_acquire( &control->Lock, &lock_context );
+
+  node = _Chain_First( &control->Stats_chain );
+  tail = _Chain_Immutable_tail( &control->Stats_chain );
+
+  /*
+   * The statistics blocks are not protected by their own locks here, so
+   * concurrent updates may get lost.  This is acceptable for statistics.
+   */
+  while ( node != tail ) {
+    _SMP_lock_Stats_reset( (SMP_lock_Stats *) node );
+    node = _Chain_Next( node );
+  }
+
+  _SMP_lock_Release_and_ISR_enable( &control->Lock, &lock_context );
+}
 #endif /* defined( RTEMS_PROFILING ) */
@@ -39,6 +39,11 @@ void _SMP_lock_Acquire(
 )
 {
   _SMP_lock_Acquire_body( lock, context );
+  _SMP_lock_Stats_contender_update(
+    &lock->Stats,
+    &context->Stats_context,
+    __builtin_return_address( 0 )
+  );
 }
 
 void _SMP_lock_Release(
@@ -54,7 +59,18 @@ void _SMP_lock_ISR_disable_and_acquire(
   SMP_lock_Context *context
 )
 {
-  _SMP_lock_ISR_disable_and_acquire_body( lock, context );
+  /*
+   * Do not use _SMP_lock_ISR_disable_and_acquire_body() here, since it calls
+   * _SMP_lock_Acquire() which would account this function as the contending
+   * call site.
+   */
+  _ISR_Disable_without_giant( context->isr_level );
+  _SMP_lock_Acquire_body( lock, context );
+  _SMP_lock_Stats_contender_update(
+    &lock->Stats,
+    &context->Stats_context,
+    __builtin_return_address( 0 )
+  );
 }
 
 void _SMP_lock_Release_and_ISR_enable(
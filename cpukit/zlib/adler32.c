@@ -17,7 +17,22 @@ local uLong adler32_combine_(uLong adler1, uLong adler2, z_off64_t len2);
 #define DO2(buf,i)  DO1(buf,i); DO1(buf,i+1);
 #define DO4(buf,i)  DO2(buf,i); DO2(buf,i+2);
 #define DO8(buf,i)  DO4(buf,i); DO4(buf,i+4);
-#define DO16(buf)   DO8(buf,0); DO8(buf,8);
+
+/* Four bytes at a time with one add on each sum's dependency chain: sum2
+   gains four times adler plus the bytes weighted by 4, 3, 2 and 1 and adler
+   gains the sum of the bytes.  The running sums of the bytes do not depend on
+   adler or sum2 so they overlap with the previous step.  The sums are the
+   same as a byte at a time so NMAX still holds. */
+#define DOQUAD(buf,i) \
+    { \
+        unsigned long q1 = (buf)[i]; \
+        unsigned long q2 = q1 + (buf)[i+1]; \
+        unsigned long q3 = q2 + (buf)[i+2]; \
+        unsigned long q4 = q3 + (buf)[i+3]; \
+        sum2 += (adler << 2) + q1 + q2 + q3 + q4; \
+        adler += q4; \
+    }
+#define DO16(buf)   DOQUAD(buf,0); DOQUAD(buf,4); DOQUAD(buf,8); DOQUAD(buf,12);
 
 /* use NO_DIVIDE if your processor does not do division in hardware */
 #ifdef NO_DIVIDE
@@ -436,6 +436,440 @@ local const unsigned long FAR crc_table[TBLS][256] =
     0x95e6b8b1UL, 0x7b490da3UL, 0x1e2eb11bUL, 0x483ed243UL, 0x2d596efbUL,
     0xc3f6dbe9UL, 0xa6916751UL, 0x1fa9b0ccUL, 0x7ace0c74UL, 0x9461b966UL,
     0xf10605deUL
+#ifdef BYEIGHT
+  },
+  {
+    0x00000000UL, 0x3d6029b0UL, 0x7ac05360UL, 0x47a07ad0UL, 0xf580a6c0UL,
+    0xc8e08f70UL, 0x8f40f5a0UL, 0xb220dc10UL, 0x30704bc1UL, 0x0d106271UL,
+    0x4ab018a1UL, 0x77d03111UL, 0xc5f0ed01UL, 0xf890c4b1UL, 0xbf30be61UL,
+    0x825097d1UL, 0x60e09782UL, 0x5d80be32UL, 0x1a20c4e2UL, 0x2740ed52UL,
+    0x95603142UL, 0xa80018f2UL, 0xefa06222UL, 0xd2c04b92UL, 0x5090dc43UL,
+    0x6df0f5f3UL, 0x2a508f23UL, 0x1730a693UL, 0xa5107a83UL, 0x98705333UL,
+    0xdfd029e3UL, 0xe2b00053UL, 0xc1c12f04UL, 0xfca106b4UL, 0xbb017c64UL,
+    0x866155d4UL, 0x344189c4UL, 0x0921a074UL, 0x4e81daa4UL, 0x73e1f314UL,
+    0xf1b164c5UL, 0xccd14d75UL, 0x8b7137a5UL, 0xb6111e15UL, 0x0431c205UL,
+    0x3951ebb5UL, 0x7ef19165UL, 0x4391b8d5UL, 0xa121b886UL, 0x9c419136UL,
+    0xdbe1ebe6UL, 0xe681c256UL, 0x54a11e46UL, 0x69c137f6UL, 0x2e614d26UL,
+    0x13016496UL, 0x9151f347UL, 0xac31daf7UL, 0xeb91a027UL, 0xd6f18997UL,
+    0x64d15587UL, 0x59b17c37UL, 0x1e1106e7UL, 0x23712f57UL, 0x58f35849UL,
+    0x659371f9UL, 0x22330b29UL, 0x1f532299UL, 0xad73fe89UL, 0x9013d739UL,
+    0xd7b3ade9UL, 0xead38459UL, 0x68831388UL, 0x55e33a38UL, 0x124340e8UL,
+    0x2f236958UL, 0x9d03b548UL, 0xa0639cf8UL, 0xe7c3e628UL, 0xdaa3cf98UL,
+    0x3813cfcbUL, 0x0573e67bUL, 0x42d39cabUL, 0x7fb3b51bUL, 0xcd93690bUL,
+    0xf0f340bbUL, 0xb7533a6bUL, 0x8a3313dbUL, 0x0863840aUL, 0x3503adbaUL,
+    0x72a3d76aUL, 0x4fc3fedaUL, 0xfde322caUL, 0xc0830b7aUL, 0x872371aaUL,
+    0xba43581aUL, 0x9932774dUL, 0xa4525efdUL, 0xe3f2242dUL, 0xde920d9dUL,
+    0x6cb2d18dUL, 0x51d2f83dUL, 0x167282edUL, 0x2b12ab5dUL, 0xa9423c8cUL,
+    0x9422153cUL, 0xd3826fecUL, 0xeee2465cUL, 0x5cc29a4cUL, 0x61a2b3fcUL,
+    0x2602c92cUL, 0x1b62e09cUL, 0xf9d2e0cfUL, 0xc4b2c97fUL, 0x8312b3afUL,
+    0xbe729a1fUL, 0x0c52460fUL, 0x31326fbfUL, 0x7692156fUL, 0x4bf23cdfUL,
+    0xc9a2ab0eUL, 0xf4c282beUL, 0xb362f86eUL, 0x8e02d1deUL, 0x3c220dceUL,
+    0x0142247eUL, 0x46e25eaeUL, 0x7b82771eUL, 0xb1e6b092UL, 0x8c869922UL,
+    0xcb26e3f2UL, 0xf646ca42UL, 0x44661652UL, 0x79063fe2UL, 0x3ea64532UL,
+    0x03c66c82UL, 0x8196fb53UL, 0xbcf6d2e3UL, 0xfb56a833UL, 0xc6368183UL,
+    0x74165d93UL, 0x49767423UL, 0x0ed60ef3UL, 0x33b62743UL, 0xd1062710UL,
+    0xec660ea0UL, 0xabc67470UL, 0x96a65dc0UL, 0x248681d0UL, 0x19e6a860UL,
+    0x5e46d2b0UL, 0x6326fb00UL, 0xe1766cd1UL, 0xdc164561UL, 0x9bb63fb1UL,
+    0xa6d61601UL, 0x14f6ca11UL, 0x2996e3a1UL, 0x6e369971UL, 0x5356b0c1UL,
+    0x70279f96UL, 0x4d47b626UL, 0x0ae7ccf6UL, 0x3787e546UL, 0x85a73956UL,
+    0xb8c710e6UL, 0xff676a36UL, 0xc2074386UL, 0x4057d457UL, 0x7d37fde7UL,
+    0x3a978737UL, 0x07f7ae87UL, 0xb5d77297UL, 0x88b75b27UL, 0xcf1721f7UL,
+    0xf2770847UL, 0x10c70814UL, 0x2da721a4UL, 0x6a075b74UL, 0x576772c4UL,
+    0xe547aed4UL, 0xd8278764UL, 0x9f87fdb4UL, 0xa2e7d404UL, 0x20b743d5UL,
+    0x1dd76a65UL, 0x5a7710b5UL, 0x67173905UL, 0xd537e515UL, 0xe857cca5UL,
+    0xaff7b675UL, 0x92979fc5UL, 0xe915e8dbUL, 0xd475c16bUL, 0x93d5bbbbUL,
+    0xaeb5920bUL, 0x1c954e1bUL, 0x21f567abUL, 0x66551d7bUL, 0x5b3534cbUL,
+    0xd965a31aUL, 0xe4058aaaUL, 0xa3a5f07aUL, 0x9ec5d9caUL, 0x2ce505daUL,
+    0x11852c6aUL, 0x562556baUL, 0x6b457f0aUL, 0x89f57f59UL, 0xb49556e9UL,
+    0xf3352c39UL, 0xce550589UL, 0x7c75d999UL, 0x4115f029UL, 0x06b58af9UL,
+    0x3bd5a349UL, 0xb9853498UL, 0x84e51d28UL, 0xc34567f8UL, 0xfe254e48UL,
+    0x4c059258UL, 0x7165bbe8UL, 0x36c5c138UL, 0x0ba5e888UL, 0x28d4c7dfUL,
+    0x15b4ee6fUL, 0x521494bfUL, 0x6f74bd0fUL, 0xdd54611fUL, 0xe03448afUL,
+    0xa794327fUL, 0x9af41bcfUL, 0x18a48c1eUL, 0x25c4a5aeUL, 0x6264df7eUL,
+    0x5f04f6ceUL, 0xed242adeUL, 0xd044036eUL, 0x97e479beUL, 0xaa84500eUL,
+    0x4834505dUL, 0x755479edUL, 0x32f4033dUL, 0x0f942a8dUL, 0xbdb4f69dUL,
+    0x80d4df2dUL, 0xc774a5fdUL, 0xfa148c4dUL, 0x78441b9cUL, 0x4524322cUL,
+    0x028448fcUL, 0x3fe4614cUL, 0x8dc4bd5cUL, 0xb0a494ecUL, 0xf704ee3cUL,
+    0xca64c78cUL
+  },
+  {
+    0x00000000UL, 0xcb5cd3a5UL, 0x4dc8a10bUL, 0x869472aeUL, 0x9b914216UL,
+    0x50cd91b3UL, 0xd659e31dUL, 0x1d0530b8UL, 0xec53826dUL, 0x270f51c8UL,
+    0xa19b2366UL, 0x6ac7f0c3UL, 0x77c2c07bUL, 0xbc9e13deUL, 0x3a0a6170UL,
+    0xf156b2d5UL, 0x03d6029bUL, 0xc88ad13eUL, 0x4e1ea390UL, 0x85427035UL,
+    0x9847408dUL, 0x531b9328UL, 0xd58fe186UL, 0x1ed33223UL, 0xef8580f6UL,
+    0x24d95353UL, 0xa24d21fdUL, 0x6911f258UL, 0x7414c2e0UL, 0xbf481145UL,
+    0x39dc63ebUL, 0xf280b04eUL, 0x07ac0536UL, 0xccf0d693UL, 0x4a64a43dUL,
+    0x81387798UL, 0x9c3d4720UL, 0x57619485UL, 0xd1f5e62bUL, 0x1aa9358eUL,
+    0xebff875bUL, 0x20a354feUL, 0xa6372650UL, 0x6d6bf5f5UL, 0x706ec54dUL,
+    0xbb3216e8UL, 0x3da66446UL, 0xf6fab7e3UL, 0x047a07adUL, 0xcf26d408UL,
+    0x49b2a6a6UL, 0x82ee7503UL, 0x9feb45bbUL, 0x54b7961eUL, 0xd223e4b0UL,
+    0x197f3715UL, 0xe82985c0UL, 0x23755665UL, 0xa5e124cbUL, 0x6ebdf76eUL,
+    0x73b8c7d6UL, 0xb8e41473UL, 0x3e7066ddUL, 0xf52cb578UL, 0x0f580a6cUL,
+    0xc404d9c9UL, 0x4290ab67UL, 0x89cc78c2UL, 0x94c9487aUL, 0x5f959bdfUL,
+    0xd901e971UL, 0x125d3ad4UL, 0xe30b8801UL, 0x28575ba4UL, 0xaec3290aUL,
+    0x659ffaafUL, 0x789aca17UL, 0xb3c619b2UL, 0x35526b1cUL, 0xfe0eb8b9UL,
+    0x0c8e08f7UL, 0xc7d2db52UL, 0x4146a9fcUL, 0x8a1a7a59UL, 0x971f4ae1UL,
+    0x5c439944UL, 0xdad7ebeaUL, 0x118b384fUL, 0xe0dd8a9aUL, 0x2b81593fUL,
+    0xad152b91UL, 0x6649f834UL, 0x7b4cc88cUL, 0xb0101b29UL, 0x36846987UL,
+    0xfdd8ba22UL, 0x08f40f5aUL, 0xc3a8dcffUL, 0x453cae51UL, 0x8e607df4UL,
+    0x93654d4cUL, 0x58399ee9UL, 0xdeadec47UL, 0x15f13fe2UL, 0xe4a78d37UL,
+    0x2ffb5e92UL, 0xa96f2c3cUL, 0x6233ff99UL, 0x7f36cf21UL, 0xb46a1c84UL,
+    0x32fe6e2aUL, 0xf9a2bd8fUL, 0x0b220dc1UL, 0xc07ede64UL, 0x46eaaccaUL,
+    0x8db67f6fUL, 0x90b34fd7UL, 0x5bef9c72UL, 0xdd7beedcUL, 0x16273d79UL,
+    0xe7718facUL, 0x2c2d5c09UL, 0xaab92ea7UL, 0x61e5fd02UL, 0x7ce0cdbaUL,
+    0xb7bc1e1fUL, 0x31286cb1UL, 0xfa74bf14UL, 0x1eb014d8UL, 0xd5ecc77dUL,
+    0x5378b5d3UL, 0x98246676UL, 0x852156ceUL, 0x4e7d856bUL, 0xc8e9f7c5UL,
+    0x03b52460UL, 0xf2e396b5UL, 0x39bf4510UL, 0xbf2b37beUL, 0x7477e41bUL,
+    0x6972d4a3UL, 0xa22e0706UL, 0x24ba75a8UL, 0xefe6a60dUL, 0x1d661643UL,
+    0xd63ac5e6UL, 0x50aeb748UL, 0x9bf264edUL, 0x86f75455UL, 0x4dab87f0UL,
+    0xcb3ff55eUL, 0x006326fbUL, 0xf135942eUL, 0x3a69478bUL, 0xbcfd3525UL,
+    0x77a1e680UL, 0x6aa4d638UL, 0xa1f8059dUL, 0x276c7733UL, 0xec30a496UL,
+    0x191c11eeUL, 0xd240c24bUL, 0x54d4b0e5UL, 0x9f886340UL, 0x828d53f8UL,
+    0x49d1805dUL, 0xcf45f2f3UL, 0x04192156UL, 0xf54f9383UL, 0x3e134026UL,
+    0xb8873288UL, 0x73dbe12dUL, 0x6eded195UL, 0xa5820230UL, 0x2316709eUL,
+    0xe84aa33bUL, 0x1aca1375UL, 0xd196c0d0UL, 0x5702b27eUL, 0x9c5e61dbUL,
+    0x815b5163UL, 0x4a0782c6UL, 0xcc93f068UL, 0x07cf23cdUL, 0xf6999118UL,
+    0x3dc542bdUL, 0xbb513013UL, 0x700de3b6UL, 0x6d08d30eUL, 0xa65400abUL,
+    0x20c07205UL, 0xeb9ca1a0UL, 0x11e81eb4UL, 0xdab4cd11UL, 0x5c20bfbfUL,
+    0x977c6c1aUL, 0x8a795ca2UL, 0x41258f07UL, 0xc7b1fda9UL, 0x0ced2e0cUL,
+    0xfdbb9cd9UL, 0x36e74f7cUL, 0xb0733dd2UL, 0x7b2fee77UL, 0x662adecfUL,
+    0xad760d6aUL, 0x2be27fc4UL, 0xe0beac61UL, 0x123e1c2fUL, 0xd962cf8aUL,
+    0x5ff6bd24UL, 0x94aa6e81UL, 0x89af5e39UL, 0x42f38d9cUL, 0xc467ff32UL,
+    0x0f3b2c97UL, 0xfe6d9e42UL, 0x35314de7UL, 0xb3a53f49UL, 0x78f9ececUL,
+    0x65fcdc54UL, 0xaea00ff1UL, 0x28347d5fUL, 0xe368aefaUL, 0x16441b82UL,
+    0xdd18c827UL, 0x5b8cba89UL, 0x90d0692cUL, 0x8dd55994UL, 0x46898a31UL,
+    0xc01df89fUL, 0x0b412b3aUL, 0xfa1799efUL, 0x314b4a4aUL, 0xb7df38e4UL,
+    0x7c83eb41UL, 0x6186dbf9UL, 0xaada085cUL, 0x2c4e7af2UL, 0xe712a957UL,
+    0x15921919UL, 0xdececabcUL, 0x585ab812UL, 0x93066bb7UL, 0x8e035b0fUL,
+    0x455f88aaUL, 0xc3cbfa04UL, 0x089729a1UL, 0xf9c19b74UL, 0x329d48d1UL,
+    0xb4093a7fUL, 0x7f55e9daUL, 0x6250d962UL, 0xa90c0ac7UL, 0x2f987869UL,
+    0xe4c4abccUL
+  },
+  {
+    0x00000000UL, 0xa6770bb4UL, 0x979f1129UL, 0x31e81a9dUL, 0xf44f2413UL,
+    0x52382fa7UL, 0x63d0353aUL, 0xc5a73e8eUL, 0x33ef4e67UL, 0x959845d3UL,
+    0xa4705f4eUL, 0x020754faUL, 0xc7a06a74UL, 0x61d761c0UL, 0x503f7b5dUL,
+    0xf64870e9UL, 0x67de9cceUL, 0xc1a9977aUL, 0xf0418de7UL, 0x56368653UL,
+    0x9391b8ddUL, 0x35e6b369UL, 0x040ea9f4UL, 0xa279a240UL, 0x5431d2a9UL,
+    0xf246d91dUL, 0xc3aec380UL, 0x65d9c834UL, 0xa07ef6baUL, 0x0609fd0eUL,
+    0x37e1e793UL, 0x9196ec27UL, 0xcfbd399cUL, 0x69ca3228UL, 0x582228b5UL,
+    0xfe552301UL, 0x3bf21d8fUL, 0x9d85163bUL, 0xac6d0ca6UL, 0x0a1a0712UL,
+    0xfc5277fbUL, 0x5a257c4fUL, 0x6bcd66d2UL, 0xcdba6d66UL, 0x081d53e8UL,
+    0xae6a585cUL, 0x9f8242c1UL, 0x39f54975UL, 0xa863a552UL, 0x0e14aee6UL,
+    0x3ffcb47bUL, 0x998bbfcfUL, 0x5c2c8141UL, 0xfa5b8af5UL, 0xcbb39068UL,
+    0x6dc49bdcUL, 0x9b8ceb35UL, 0x3dfbe081UL, 0x0c13fa1cUL, 0xaa64f1a8UL,
+    0x6fc3cf26UL, 0xc9b4c492UL, 0xf85cde0fUL, 0x5e2bd5bbUL, 0x440b7579UL,
+    0xe27c7ecdUL, 0xd3946450UL, 0x75e36fe4UL, 0xb044516aUL, 0x16335adeUL,
+    0x27db4043UL, 0x81ac4bf7UL, 0x77e43b1eUL, 0xd19330aaUL, 0xe07b2a37UL,
+    0x460c2183UL, 0x83ab1f0dUL, 0x25dc14b9UL, 0x14340e24UL, 0xb2430590UL,
+    0x23d5e9b7UL, 0x85a2e203UL, 0xb44af89eUL, 0x123df32aUL, 0xd79acda4UL,
+    0x71edc610UL, 0x4005dc8dUL, 0xe672d739UL, 0x103aa7d0UL, 0xb64dac64UL,
+    0x87a5b6f9UL, 0x21d2bd4dUL, 0xe47583c3UL, 0x42028877UL, 0x73ea92eaUL,
+    0xd59d995eUL, 0x8bb64ce5UL, 0x2dc14751UL, 0x1c295dccUL, 0xba5e5678UL,
+    0x7ff968f6UL, 0xd98e6342UL, 0xe86679dfUL, 0x4e11726bUL, 0xb8590282UL,
+    0x1e2e0936UL, 0x2fc613abUL, 0x89b1181fUL, 0x4c162691UL, 0xea612d25UL,
+    0xdb8937b8UL, 0x7dfe3c0cUL, 0xec68d02bUL, 0x4a1fdb9fUL, 0x7bf7c102UL,
+    0xdd80cab6UL, 0x1827f438UL, 0xbe50ff8cUL, 0x8fb8e511UL, 0x29cfeea5UL,
+    0xdf879e4cUL, 0x79f095f8UL, 0x48188f65UL, 0xee6f84d1UL, 0x2bc8ba5fUL,
+    0x8dbfb1ebUL, 0xbc57ab76UL, 0x1a20a0c2UL, 0x8816eaf2UL, 0x2e61e146UL,
+    0x1f89fbdbUL, 0xb9fef06fUL, 0x7c59cee1UL, 0xda2ec555UL, 0xebc6dfc8UL,
+    0x4db1d47cUL, 0xbbf9a495UL, 0x1d8eaf21UL, 0x2c66b5bcUL, 0x8a11be08UL,
+    0x4fb68086UL, 0xe9c18b32UL, 0xd82991afUL, 0x7e5e9a1bUL, 0xefc8763cUL,
+    0x49bf7d88UL, 0x78576715UL, 0xde206ca1UL, 0x1b87522fUL, 0xbdf0599bUL,
+    0x8c184306UL, 0x2a6f48b2UL, 0xdc27385bUL, 0x7a5033efUL, 0x4bb82972UL,
+    0xedcf22c6UL, 0x28681c48UL, 0x8e1f17fcUL, 0xbff70d61UL, 0x198006d5UL,
+    0x47abd36eUL, 0xe1dcd8daUL, 0xd034c247UL, 0x7643c9f3UL, 0xb3e4f77dUL,
+    0x1593fcc9UL, 0x247be654UL, 0x820cede0UL, 0x74449d09UL, 0xd23396bdUL,
+    0xe3db8c20UL, 0x45ac8794UL, 0x800bb91aUL, 0x267cb2aeUL, 0x1794a833UL,
+    0xb1e3a387UL, 0x20754fa0UL, 0x86024414UL, 0xb7ea5e89UL, 0x119d553dUL,
+    0xd43a6bb3UL, 0x724d6007UL, 0x43a57a9aUL, 0xe5d2712eUL, 0x139a01c7UL,
+    0xb5ed0a73UL, 0x840510eeUL, 0x22721b5aUL, 0xe7d525d4UL, 0x41a22e60UL,
+    0x704a34fdUL, 0xd63d3f49UL, 0xcc1d9f8bUL, 0x6a6a943fUL, 0x5b828ea2UL,
+    0xfdf58516UL, 0x3852bb98UL, 0x9e25b02cUL, 0xafcdaab1UL, 0x09baa105UL,
+    0xfff2d1ecUL, 0x5985da58UL, 0x686dc0c5UL, 0xce1acb71UL, 0x0bbdf5ffUL,
+    0xadcafe4bUL, 0x9c22e4d6UL, 0x3a55ef62UL, 0xabc30345UL, 0x0db408f1UL,
+    0x3c5c126cUL, 0x9a2b19d8UL, 0x5f8c2756UL, 0xf9fb2ce2UL, 0xc813367fUL,
+    0x6e643dcbUL, 0x982c4d22UL, 0x3e5b4696UL, 0x0fb35c0bUL, 0xa9c457bfUL,
+    0x6c636931UL, 0xca146285UL, 0xfbfc7818UL, 0x5d8b73acUL, 0x03a0a617UL,
+    0xa5d7ada3UL, 0x943fb73eUL, 0x3248bc8aUL, 0xf7ef8204UL, 0x519889b0UL,
+    0x6070932dUL, 0xc6079899UL, 0x304fe870UL, 0x9638e3c4UL, 0xa7d0f959UL,
+    0x01a7f2edUL, 0xc400cc63UL, 0x6277c7d7UL, 0x539fdd4aUL, 0xf5e8d6feUL,
+    0x647e3ad9UL, 0xc209316dUL, 0xf3e12bf0UL, 0x55962044UL, 0x90311ecaUL,
+    0x3646157eUL, 0x07ae0fe3UL, 0xa1d90457UL, 0x579174beUL, 0xf1e67f0aUL,
+    0xc00e6597UL, 0x66796e23UL, 0xa3de50adUL, 0x05a95b19UL, 0x34414184UL,
+    0x92364a30UL
+  },
+  {
+    0x00000000UL, 0xccaa009eUL, 0x4225077dUL, 0x8e8f07e3UL, 0x844a0efaUL,
+    0x48e00e64UL, 0xc66f0987UL, 0x0ac50919UL, 0xd3e51bb5UL, 0x1f4f1b2bUL,
+    0x91c01cc8UL, 0x5d6a1c56UL, 0x57af154fUL, 0x9b0515d1UL, 0x158a1232UL,
+    0xd92012acUL, 0x7cbb312bUL, 0xb01131b5UL, 0x3e9e3656UL, 0xf23436c8UL,
+    0xf8f13fd1UL, 0x345b3f4fUL, 0xbad438acUL, 0x767e3832UL, 0xaf5e2a9eUL,
+    0x63f42a00UL, 0xed7b2de3UL, 0x21d12d7dUL, 0x2b142464UL, 0xe7be24faUL,
+    0x69312319UL, 0xa59b2387UL, 0xf9766256UL, 0x35dc62c8UL, 0xbb53652bUL,
+    0x77f965b5UL, 0x7d3c6cacUL, 0xb1966c32UL, 0x3f196bd1UL, 0xf3b36b4fUL,
+    0x2a9379e3UL, 0xe639797dUL, 0x68b67e9eUL, 0xa41c7e00UL, 0xaed97719UL,
+    0x62737787UL, 0xecfc7064UL, 0x205670faUL, 0x85cd537dUL, 0x496753e3UL,
+    0xc7e85400UL, 0x0b42549eUL, 0x01875d87UL, 0xcd2d5d19UL, 0x43a25afaUL,
+    0x8f085a64UL, 0x562848c8UL, 0x9a824856UL, 0x140d4fb5UL, 0xd8a74f2bUL,
+    0xd2624632UL, 0x1ec846acUL, 0x9047414fUL, 0x5ced41d1UL, 0x299dc2edUL,
+    0xe537c273UL, 0x6bb8c590UL, 0xa712c50eUL, 0xadd7cc17UL, 0x617dcc89UL,
+    0xeff2cb6aUL, 0x2358cbf4UL, 0xfa78d958UL, 0x36d2d9c6UL, 0xb85dde25UL,
+    0x74f7debbUL, 0x7e32d7a2UL, 0xb298d73cUL, 0x3c17d0dfUL, 0xf0bdd041UL,
+    0x5526f3c6UL, 0x998cf358UL, 0x1703f4bbUL, 0xdba9f425UL, 0xd16cfd3cUL,
+    0x1dc6fda2UL, 0x9349fa41UL, 0x5fe3fadfUL, 0x86c3e873UL, 0x4a69e8edUL,
+    0xc4e6ef0eUL, 0x084cef90UL, 0x0289e689UL, 0xce23e617UL, 0x40ace1f4UL,
+    0x8c06e16aUL, 0xd0eba0bbUL, 0x1c41a025UL, 0x92cea7c6UL, 0x5e64a758UL,
+    0x54a1ae41UL, 0x980baedfUL, 0x1684a93cUL, 0xda2ea9a2UL, 0x030ebb0eUL,
+    0xcfa4bb90UL, 0x412bbc73UL, 0x8d81bcedUL, 0x8744b5f4UL, 0x4beeb56aUL,
+    0xc561b289UL, 0x09cbb217UL, 0xac509190UL, 0x60fa910eUL, 0xee7596edUL,
+    0x22df9673UL, 0x281a9f6aUL, 0xe4b09ff4UL, 0x6a3f9817UL, 0xa6959889UL,
+    0x7fb58a25UL, 0xb31f8abbUL, 0x3d908d58UL, 0xf13a8dc6UL, 0xfbff84dfUL,
+    0x37558441UL, 0xb9da83a2UL, 0x7570833cUL, 0x533b85daUL, 0x9f918544UL,
+    0x111e82a7UL, 0xddb48239UL, 0xd7718b20UL, 0x1bdb8bbeUL, 0x95548c5dUL,
+    0x59fe8cc3UL, 0x80de9e6fUL, 0x4c749ef1UL, 0xc2fb9912UL, 0x0e51998cUL,
+    0x04949095UL, 0xc83e900bUL, 0x46b197e8UL, 0x8a1b9776UL, 0x2f80b4f1UL,
+    0xe32ab46fUL, 0x6da5b38cUL, 0xa10fb312UL, 0xabcaba0bUL, 0x6760ba95UL,
+    0xe9efbd76UL, 0x2545bde8UL, 0xfc65af44UL, 0x30cfafdaUL, 0xbe40a839UL,
+    0x72eaa8a7UL, 0x782fa1beUL, 0xb485a120UL, 0x3a0aa6c3UL, 0xf6a0a65dUL,
+    0xaa4de78cUL, 0x66e7e712UL, 0xe868e0f1UL, 0x24c2e06fUL, 0x2e07e976UL,
+    0xe2ade9e8UL, 0x6c22ee0bUL, 0xa088ee95UL, 0x79a8fc39UL, 0xb502fca7UL,
+    0x3b8dfb44UL, 0xf727fbdaUL, 0xfde2f2c3UL, 0x3148f25dUL, 0xbfc7f5beUL,
+    0x736df520UL, 0xd6f6d6a7UL, 0x1a5cd639UL, 0x94d3d1daUL, 0x5879d144UL,
+    0x52bcd85dUL, 0x9e16d8c3UL, 0x1099df20UL, 0xdc33dfbeUL, 0x0513cd12UL,
+    0xc9b9cd8cUL, 0x4736ca6fUL, 0x8b9ccaf1UL, 0x8159c3e8UL, 0x4df3c376UL,
+    0xc37cc495UL, 0x0fd6c40bUL, 0x7aa64737UL, 0xb60c47a9UL, 0x3883404aUL,
+    0xf42940d4UL, 0xfeec49cdUL, 0x32464953UL, 0xbcc94eb0UL, 0x70634e2eUL,
+    0xa9435c82UL, 0x65e95c1cUL, 0xeb665bffUL, 0x27cc5b61UL, 0x2d095278UL,
+    0xe1a352e6UL, 0x6f2c5505UL, 0xa386559bUL, 0x061d761cUL, 0xcab77682UL,
+    0x44387161UL, 0x889271ffUL, 0x825778e6UL, 0x4efd7878UL, 0xc0727f9bUL,
+    0x0cd87f05UL, 0xd5f86da9UL, 0x19526d37UL, 0x97dd6ad4UL, 0x5b776a4aUL,
+    0x51b26353UL, 0x9d1863cdUL, 0x1397642eUL, 0xdf3d64b0UL, 0x83d02561UL,
+    0x4f7a25ffUL, 0xc1f5221cUL, 0x0d5f2282UL, 0x079a2b9bUL, 0xcb302b05UL,
+    0x45bf2ce6UL, 0x89152c78UL, 0x50353ed4UL, 0x9c9f3e4aUL, 0x121039a9UL,
+    0xdeba3937UL, 0xd47f302eUL, 0x18d530b0UL, 0x965a3753UL, 0x5af037cdUL,
+    0xff6b144aUL, 0x33c114d4UL, 0xbd4e1337UL, 0x71e413a9UL, 0x7b211ab0UL,
+    0xb78b1a2eUL, 0x39041dcdUL, 0xf5ae1d53UL, 0x2c8e0fffUL, 0xe0240f61UL,
+    0x6eab0882UL, 0xa201081cUL, 0xa8c40105UL, 0x646e019bUL, 0xeae10678UL,
+    0x264b06e6UL
+  },
+  {
+    0x00000000UL, 0xb029603dUL, 0x6053c07aUL, 0xd07aa047UL, 0xc0a680f5UL,
+    0x708fe0c8UL, 0xa0f5408fUL, 0x10dc20b2UL, 0xc14b7030UL, 0x7162100dUL,
+    0xa118b04aUL, 0x1131d077UL, 0x01edf0c5UL, 0xb1c490f8UL, 0x61be30bfUL,
+    0xd1975082UL, 0x8297e060UL, 0x32be805dUL, 0xe2c4201aUL, 0x52ed4027UL,
+    0x42316095UL, 0xf21800a8UL, 0x2262a0efUL, 0x924bc0d2UL, 0x43dc9050UL,
+    0xf3f5f06dUL, 0x238f502aUL, 0x93a63017UL, 0x837a10a5UL, 0x33537098UL,
+    0xe329d0dfUL, 0x5300b0e2UL, 0x042fc1c1UL, 0xb406a1fcUL, 0x647c01bbUL,
+    0xd4556186UL, 0xc4894134UL, 0x74a02109UL, 0xa4da814eUL, 0x14f3e173UL,
+    0xc564b1f1UL, 0x754dd1ccUL, 0xa537718bUL, 0x151e11b6UL, 0x05c23104UL,
+    0xb5eb5139UL, 0x6591f17eUL, 0xd5b89143UL, 0x86b821a1UL, 0x3691419cUL,
+    0xe6ebe1dbUL, 0x56c281e6UL, 0x461ea154UL, 0xf637c169UL, 0x264d612eUL,
+    0x96640113UL, 0x47f35191UL, 0xf7da31acUL, 0x27a091ebUL, 0x9789f1d6UL,
+    0x8755d164UL, 0x377cb159UL, 0xe706111eUL, 0x572f7123UL, 0x4958f358UL,
+    0xf9719365UL, 0x290b3322UL, 0x9922531fUL, 0x89fe73adUL, 0x39d71390UL,
+    0xe9adb3d7UL, 0x5984d3eaUL, 0x88138368UL, 0x383ae355UL, 0xe8404312UL,
+    0x5869232fUL, 0x48b5039dUL, 0xf89c63a0UL, 0x28e6c3e7UL, 0x98cfa3daUL,
+    0xcbcf1338UL, 0x7be67305UL, 0xab9cd342UL, 0x1bb5b37fUL, 0x0b6993cdUL,
+    0xbb40f3f0UL, 0x6b3a53b7UL, 0xdb13338aUL, 0x0a846308UL, 0xbaad0335UL,
+    0x6ad7a372UL, 0xdafec34fUL, 0xca22e3fdUL, 0x7a0b83c0UL, 0xaa712387UL,
+    0x1a5843baUL, 0x4d773299UL, 0xfd5e52a4UL, 0x2d24f2e3UL, 0x9d0d92deUL,
+    0x8dd1b26cUL, 0x3df8d251UL, 0xed827216UL, 0x5dab122bUL, 0x8c3c42a9UL,
+    0x3c152294UL, 0xec6f82d3UL, 0x5c46e2eeUL, 0x4c9ac25cUL, 0xfcb3a261UL,
+    0x2cc90226UL, 0x9ce0621bUL, 0xcfe0d2f9UL, 0x7fc9b2c4UL, 0xafb31283UL,
+    0x1f9a72beUL, 0x0f46520cUL, 0xbf6f3231UL, 0x6f159276UL, 0xdf3cf24bUL,
+    0x0eaba2c9UL, 0xbe82c2f4UL, 0x6ef862b3UL, 0xded1028eUL, 0xce0d223cUL,
+    0x7e244201UL, 0xae5ee246UL, 0x1e77827bUL, 0x92b0e6b1UL, 0x2299868cUL,
+    0xf2e326cbUL, 0x42ca46f6UL, 0x52166644UL, 0xe23f0679UL, 0x3245a63eUL,
+    0x826cc603UL, 0x53fb9681UL, 0xe3d2f6bcUL, 0x33a856fbUL, 0x838136c6UL,
+    0x935d1674UL, 0x23747649UL, 0xf30ed60eUL, 0x4327b633UL, 0x102706d1UL,
+    0xa00e66ecUL, 0x7074c6abUL, 0xc05da696UL, 0xd0818624UL, 0x60a8e619UL,
+    0xb0d2465eUL, 0x00fb2663UL, 0xd16c76e1UL, 0x614516dcUL, 0xb13fb69bUL,
+    0x0116d6a6UL, 0x11caf614UL, 0xa1e39629UL, 0x7199366eUL, 0xc1b05653UL,
+    0x969f2770UL, 0x26b6474dUL, 0xf6cce70aUL, 0x46e58737UL, 0x5639a785UL,
+    0xe610c7b8UL, 0x366a67ffUL, 0x864307c2UL, 0x57d45740UL, 0xe7fd377dUL,
+    0x3787973aUL, 0x87aef707UL, 0x9772d7b5UL, 0x275bb788UL, 0xf72117cfUL,
+    0x470877f2UL, 0x1408c710UL, 0xa421a72dUL, 0x745b076aUL, 0xc4726757UL,
+    0xd4ae47e5UL, 0x648727d8UL, 0xb4fd879fUL, 0x04d4e7a2UL, 0xd543b720UL,
+    0x656ad71dUL, 0xb510775aUL, 0x05391767UL, 0x15e537d5UL, 0xa5cc57e8UL,
+    0x75b6f7afUL, 0xc59f9792UL, 0xdbe815e9UL, 0x6bc175d4UL, 0xbbbbd593UL,
+    0x0b92b5aeUL, 0x1b4e951cUL, 0xab67f521UL, 0x7b1d5566UL, 0xcb34355bUL,
+    0x1aa365d9UL, 0xaa8a05e4UL, 0x7af0a5a3UL, 0xcad9c59eUL, 0xda05e52cUL,
+    0x6a2c8511UL, 0xba562556UL, 0x0a7f456bUL, 0x597ff589UL, 0xe95695b4UL,
+    0x392c35f3UL, 0x890555ceUL, 0x99d9757cUL, 0x29f01541UL, 0xf98ab506UL,
+    0x49a3d53bUL, 0x983485b9UL, 0x281de584UL, 0xf86745c3UL, 0x484e25feUL,
+    0x5892054cUL, 0xe8bb6571UL, 0x38c1c536UL, 0x88e8a50bUL, 0xdfc7d428UL,
+    0x6feeb415UL, 0xbf941452UL, 0x0fbd746fUL, 0x1f6154ddUL, 0xaf4834e0UL,
+    0x7f3294a7UL, 0xcf1bf49aUL, 0x1e8ca418UL, 0xaea5c425UL, 0x7edf6462UL,
+    0xcef6045fUL, 0xde2a24edUL, 0x6e0344d0UL, 0xbe79e497UL, 0x0e5084aaUL,
+    0x5d503448UL, 0xed795475UL, 0x3d03f432UL, 0x8d2a940fUL, 0x9df6b4bdUL,
+    0x2ddfd480UL, 0xfda574c7UL, 0x4d8c14faUL, 0x9c1b4478UL, 0x2c322445UL,
+    0xfc488402UL, 0x4c61e43fUL, 0x5cbdc48dUL, 0xec94a4b0UL, 0x3cee04f7UL,
+    0x8cc764caUL
+  },
+  {
+    0x00000000UL, 0xa5d35ccbUL, 0x0ba1c84dUL, 0xae729486UL, 0x1642919bUL,
+    0xb391cd50UL, 0x1de359d6UL, 0xb830051dUL, 0x6d8253ecUL, 0xc8510f27UL,
+    0x66239ba1UL, 0xc3f0c76aUL, 0x7bc0c277UL, 0xde139ebcUL, 0x70610a3aUL,
+    0xd5b256f1UL, 0x9b02d603UL, 0x3ed18ac8UL, 0x90a31e4eUL, 0x35704285UL,
+    0x8d404798UL, 0x28931b53UL, 0x86e18fd5UL, 0x2332d31eUL, 0xf68085efUL,
+    0x5353d924UL, 0xfd214da2UL, 0x58f21169UL, 0xe0c21474UL, 0x451148bfUL,
+    0xeb63dc39UL, 0x4eb080f2UL, 0x3605ac07UL, 0x93d6f0ccUL, 0x3da4644aUL,
+    0x98773881UL, 0x20473d9cUL, 0x85946157UL, 0x2be6f5d1UL, 0x8e35a91aUL,
+    0x5b87ffebUL, 0xfe54a320UL, 0x502637a6UL, 0xf5f56b6dUL, 0x4dc56e70UL,
+    0xe81632bbUL, 0x4664a63dUL, 0xe3b7faf6UL, 0xad077a04UL, 0x08d426cfUL,
+    0xa6a6b249UL, 0x0375ee82UL, 0xbb45eb9fUL, 0x1e96b754UL, 0xb0e423d2UL,
+    0x15377f19UL, 0xc08529e8UL, 0x65567523UL, 0xcb24e1a5UL, 0x6ef7bd6eUL,
+    0xd6c7b873UL, 0x7314e4b8UL, 0xdd66703eUL, 0x78b52cf5UL, 0x6c0a580fUL,
+    0xc9d904c4UL, 0x67ab9042UL, 0xc278cc89UL, 0x7a48c994UL, 0xdf9b955fUL,
+    0x71e901d9UL, 0xd43a5d12UL, 0x01880be3UL, 0xa45b5728UL, 0x0a29c3aeUL,
+    0xaffa9f65UL, 0x17ca9a78UL, 0xb219c6b3UL, 0x1c6b5235UL, 0xb9b80efeUL,
+    0xf7088e0cUL, 0x52dbd2c7UL, 0xfca94641UL, 0x597a1a8aUL, 0xe14a1f97UL,
+    0x4499435cUL, 0xeaebd7daUL, 0x4f388b11UL, 0x9a8adde0UL, 0x3f59812bUL,
+    0x912b15adUL, 0x34f84966UL, 0x8cc84c7bUL, 0x291b10b0UL, 0x87698436UL,
+    0x22bad8fdUL, 0x5a0ff408UL, 0xffdca8c3UL, 0x51ae3c45UL, 0xf47d608eUL,
+    0x4c4d6593UL, 0xe99e3958UL, 0x47ecaddeUL, 0xe23ff115UL, 0x378da7e4UL,
+    0x925efb2fUL, 0x3c2c6fa9UL, 0x99ff3362UL, 0x21cf367fUL, 0x841c6ab4UL,
+    0x2a6efe32UL, 0x8fbda2f9UL, 0xc10d220bUL, 0x64de7ec0UL, 0xcaacea46UL,
+    0x6f7fb68dUL, 0xd74fb390UL, 0x729cef5bUL, 0xdcee7bddUL, 0x793d2716UL,
+    0xac8f71e7UL, 0x095c2d2cUL, 0xa72eb9aaUL, 0x02fde561UL, 0xbacde07cUL,
+    0x1f1ebcb7UL, 0xb16c2831UL, 0x14bf74faUL, 0xd814b01eUL, 0x7dc7ecd5UL,
+    0xd3b57853UL, 0x76662498UL, 0xce562185UL, 0x6b857d4eUL, 0xc5f7e9c8UL,
+    0x6024b503UL, 0xb596e3f2UL, 0x1045bf39UL, 0xbe372bbfUL, 0x1be47774UL,
+    0xa3d47269UL, 0x06072ea2UL, 0xa875ba24UL, 0x0da6e6efUL, 0x4316661dUL,
+    0xe6c53ad6UL, 0x48b7ae50UL, 0xed64f29bUL, 0x5554f786UL, 0xf087ab4dUL,
+    0x5ef53fcbUL, 0xfb266300UL, 0x2e9435f1UL, 0x8b47693aUL, 0x2535fdbcUL,
+    0x80e6a177UL, 0x38d6a46aUL, 0x9d05f8a1UL, 0x33776c27UL, 0x96a430ecUL,
+    0xee111c19UL, 0x4bc240d2UL, 0xe5b0d454UL, 0x4063889fUL, 0xf8538d82UL,
+    0x5d80d149UL, 0xf3f245cfUL, 0x56211904UL, 0x83934ff5UL, 0x2640133eUL,
+    0x883287b8UL, 0x2de1db73UL, 0x95d1de6eUL, 0x300282a5UL, 0x9e701623UL,
+    0x3ba34ae8UL, 0x7513ca1aUL, 0xd0c096d1UL, 0x7eb20257UL, 0xdb615e9cUL,
+    0x63515b81UL, 0xc682074aUL, 0x68f093ccUL, 0xcd23cf07UL, 0x189199f6UL,
+    0xbd42c53dUL, 0x133051bbUL, 0xb6e30d70UL, 0x0ed3086dUL, 0xab0054a6UL,
+    0x0572c020UL, 0xa0a19cebUL, 0xb41ee811UL, 0x11cdb4daUL, 0xbfbf205cUL,
+    0x1a6c7c97UL, 0xa25c798aUL, 0x078f2541UL, 0xa9fdb1c7UL, 0x0c2eed0cUL,
+    0xd99cbbfdUL, 0x7c4fe736UL, 0xd23d73b0UL, 0x77ee2f7bUL, 0xcfde2a66UL,
+    0x6a0d76adUL, 0xc47fe22bUL, 0x61acbee0UL, 0x2f1c3e12UL, 0x8acf62d9UL,
+    0x24bdf65fUL, 0x816eaa94UL, 0x395eaf89UL, 0x9c8df342UL, 0x32ff67c4UL,
+    0x972c3b0fUL, 0x429e6dfeUL, 0xe74d3135UL, 0x493fa5b3UL, 0xececf978UL,
+    0x54dcfc65UL, 0xf10fa0aeUL, 0x5f7d3428UL, 0xfaae68e3UL, 0x821b4416UL,
+    0x27c818ddUL, 0x89ba8c5bUL, 0x2c69d090UL, 0x9459d58dUL, 0x318a8946UL,
+    0x9ff81dc0UL, 0x3a2b410bUL, 0xef9917faUL, 0x4a4a4b31UL, 0xe438dfb7UL,
+    0x41eb837cUL, 0xf9db8661UL, 0x5c08daaaUL, 0xf27a4e2cUL, 0x57a912e7UL,
+    0x19199215UL, 0xbccacedeUL, 0x12b85a58UL, 0xb76b0693UL, 0x0f5b038eUL,
+    0xaa885f45UL, 0x04facbc3UL, 0xa1299708UL, 0x749bc1f9UL, 0xd1489d32UL,
+    0x7f3a09b4UL, 0xdae9557fUL, 0x62d95062UL, 0xc70a0ca9UL, 0x6978982fUL,
+    0xccabc4e4UL
+  },
+  {
+    0x00000000UL, 0xb40b77a6UL, 0x29119f97UL, 0x9d1ae831UL, 0x13244ff4UL,
+    0xa72f3852UL, 0x3a35d063UL, 0x8e3ea7c5UL, 0x674eef33UL, 0xd3459895UL,
+    0x4e5f70a4UL, 0xfa540702UL, 0x746aa0c7UL, 0xc061d761UL, 0x5d7b3f50UL,
+    0xe97048f6UL, 0xce9cde67UL, 0x7a97a9c1UL, 0xe78d41f0UL, 0x53863656UL,
+    0xddb89193UL, 0x69b3e635UL, 0xf4a90e04UL, 0x40a279a2UL, 0xa9d23154UL,
+    0x1dd946f2UL, 0x80c3aec3UL, 0x34c8d965UL, 0xbaf67ea0UL, 0x0efd0906UL,
+    0x93e7e137UL, 0x27ec9691UL, 0x9c39bdcfUL, 0x2832ca69UL, 0xb5282258UL,
+    0x012355feUL, 0x8f1df23bUL, 0x3b16859dUL, 0xa60c6dacUL, 0x12071a0aUL,
+    0xfb7752fcUL, 0x4f7c255aUL, 0xd266cd6bUL, 0x666dbacdUL, 0xe8531d08UL,
+    0x5c586aaeUL, 0xc142829fUL, 0x7549f539UL, 0x52a563a8UL, 0xe6ae140eUL,
+    0x7bb4fc3fUL, 0xcfbf8b99UL, 0x41812c5cUL, 0xf58a5bfaUL, 0x6890b3cbUL,
+    0xdc9bc46dUL, 0x35eb8c9bUL, 0x81e0fb3dUL, 0x1cfa130cUL, 0xa8f164aaUL,
+    0x26cfc36fUL, 0x92c4b4c9UL, 0x0fde5cf8UL, 0xbbd52b5eUL, 0x79750b44UL,
+    0xcd7e7ce2UL, 0x506494d3UL, 0xe46fe375UL, 0x6a5144b0UL, 0xde5a3316UL,
+    0x4340db27UL, 0xf74bac81UL, 0x1e3be477UL, 0xaa3093d1UL, 0x372a7be0UL,
+    0x83210c46UL, 0x0d1fab83UL, 0xb914dc25UL, 0x240e3414UL, 0x900543b2UL,
+    0xb7e9d523UL, 0x03e2a285UL, 0x9ef84ab4UL, 0x2af33d12UL, 0xa4cd9ad7UL,
+    0x10c6ed71UL, 0x8ddc0540UL, 0x39d772e6UL, 0xd0a73a10UL, 0x64ac4db6UL,
+    0xf9b6a587UL, 0x4dbdd221UL, 0xc38375e4UL, 0x77880242UL, 0xea92ea73UL,
+    0x5e999dd5UL, 0xe54cb68bUL, 0x5147c12dUL, 0xcc5d291cUL, 0x78565ebaUL,
+    0xf668f97fUL, 0x42638ed9UL, 0xdf7966e8UL, 0x6b72114eUL, 0x820259b8UL,
+    0x36092e1eUL, 0xab13c62fUL, 0x1f18b189UL, 0x9126164cUL, 0x252d61eaUL,
+    0xb83789dbUL, 0x0c3cfe7dUL, 0x2bd068ecUL, 0x9fdb1f4aUL, 0x02c1f77bUL,
+    0xb6ca80ddUL, 0x38f42718UL, 0x8cff50beUL, 0x11e5b88fUL, 0xa5eecf29UL,
+    0x4c9e87dfUL, 0xf895f079UL, 0x658f1848UL, 0xd1846feeUL, 0x5fbac82bUL,
+    0xebb1bf8dUL, 0x76ab57bcUL, 0xc2a0201aUL, 0xf2ea1688UL, 0x46e1612eUL,
+    0xdbfb891fUL, 0x6ff0feb9UL, 0xe1ce597cUL, 0x55c52edaUL, 0xc8dfc6ebUL,
+    0x7cd4b14dUL, 0x95a4f9bbUL, 0x21af8e1dUL, 0xbcb5662cUL, 0x08be118aUL,
+    0x8680b64fUL, 0x328bc1e9UL, 0xaf9129d8UL, 0x1b9a5e7eUL, 0x3c76c8efUL,
+    0x887dbf49UL, 0x15675778UL, 0xa16c20deUL, 0x2f52871bUL, 0x9b59f0bdUL,
+    0x0643188cUL, 0xb2486f2aUL, 0x5b3827dcUL, 0xef33507aUL, 0x7229b84bUL,
+    0xc622cfedUL, 0x481c6828UL, 0xfc171f8eUL, 0x610df7bfUL, 0xd5068019UL,
+    0x6ed3ab47UL, 0xdad8dce1UL, 0x47c234d0UL, 0xf3c94376UL, 0x7df7e4b3UL,
+    0xc9fc9315UL, 0x54e67b24UL, 0xe0ed0c82UL, 0x099d4474UL, 0xbd9633d2UL,
+    0x208cdbe3UL, 0x9487ac45UL, 0x1ab90b80UL, 0xaeb27c26UL, 0x33a89417UL,
+    0x87a3e3b1UL, 0xa04f7520UL, 0x14440286UL, 0x895eeab7UL, 0x3d559d11UL,
+    0xb36b3ad4UL, 0x07604d72UL, 0x9a7aa543UL, 0x2e71d2e5UL, 0xc7019a13UL,
+    0x730aedb5UL, 0xee100584UL, 0x5a1b7222UL, 0xd425d5e7UL, 0x602ea241UL,
+    0xfd344a70UL, 0x493f3dd6UL, 0x8b9f1dccUL, 0x3f946a6aUL, 0xa28e825bUL,
+    0x1685f5fdUL, 0x98bb5238UL, 0x2cb0259eUL, 0xb1aacdafUL, 0x05a1ba09UL,
+    0xecd1f2ffUL, 0x58da8559UL, 0xc5c06d68UL, 0x71cb1aceUL, 0xfff5bd0bUL,
+    0x4bfecaadUL, 0xd6e4229cUL, 0x62ef553aUL, 0x4503c3abUL, 0xf108b40dUL,
+    0x6c125c3cUL, 0xd8192b9aUL, 0x56278c5fUL, 0xe22cfbf9UL, 0x7f3613c8UL,
+    0xcb3d646eUL, 0x224d2c98UL, 0x96465b3eUL, 0x0b5cb30fUL, 0xbf57c4a9UL,
+    0x3169636cUL, 0x856214caUL, 0x1878fcfbUL, 0xac738b5dUL, 0x17a6a003UL,
+    0xa3add7a5UL, 0x3eb73f94UL, 0x8abc4832UL, 0x0482eff7UL, 0xb0899851UL,
+    0x2d937060UL, 0x999807c6UL, 0x70e84f30UL, 0xc4e33896UL, 0x59f9d0a7UL,
+    0xedf2a701UL, 0x63cc00c4UL, 0xd7c77762UL, 0x4add9f53UL, 0xfed6e8f5UL,
+    0xd93a7e64UL, 0x6d3109c2UL, 0xf02be1f3UL, 0x44209655UL, 0xca1e3190UL,
+    0x7e154636UL, 0xe30fae07UL, 0x5704d9a1UL, 0xbe749157UL, 0x0a7fe6f1UL,
+    0x97650ec0UL, 0x236e7966UL, 0xad50dea3UL, 0x195ba905UL, 0x84414134UL,
+    0x304a3692UL
+  },
+  {
+    0x00000000UL, 0x9e00aaccUL, 0x7d072542UL, 0xe3078f8eUL, 0xfa0e4a84UL,
+    0x640ee048UL, 0x87096fc6UL, 0x1909c50aUL, 0xb51be5d3UL, 0x2b1b4f1fUL,
+    0xc81cc091UL, 0x561c6a5dUL, 0x4f15af57UL, 0xd115059bUL, 0x32128a15UL,
+    0xac1220d9UL, 0x2b31bb7cUL, 0xb53111b0UL, 0x56369e3eUL, 0xc83634f2UL,
+    0xd13ff1f8UL, 0x4f3f5b34UL, 0xac38d4baUL, 0x32387e76UL, 0x9e2a5eafUL,
+    0x002af463UL, 0xe32d7bedUL, 0x7d2dd121UL, 0x6424142bUL, 0xfa24bee7UL,
+    0x19233169UL, 0x87239ba5UL, 0x566276f9UL, 0xc862dc35UL, 0x2b6553bbUL,
+    0xb565f977UL, 0xac6c3c7dUL, 0x326c96b1UL, 0xd16b193fUL, 0x4f6bb3f3UL,
+    0xe379932aUL, 0x7d7939e6UL, 0x9e7eb668UL, 0x007e1ca4UL, 0x1977d9aeUL,
+    0x87777362UL, 0x6470fcecUL, 0xfa705620UL, 0x7d53cd85UL, 0xe3536749UL,
+    0x0054e8c7UL, 0x9e54420bUL, 0x875d8701UL, 0x195d2dcdUL, 0xfa5aa243UL,
+    0x645a088fUL, 0xc8482856UL, 0x5648829aUL, 0xb54f0d14UL, 0x2b4fa7d8UL,
+    0x324662d2UL, 0xac46c81eUL, 0x4f414790UL, 0xd141ed5cUL, 0xedc29d29UL,
+    0x73c237e5UL, 0x90c5b86bUL, 0x0ec512a7UL, 0x17ccd7adUL, 0x89cc7d61UL,
+    0x6acbf2efUL, 0xf4cb5823UL, 0x58d978faUL, 0xc6d9d236UL, 0x25de5db8UL,
+    0xbbdef774UL, 0xa2d7327eUL, 0x3cd798b2UL, 0xdfd0173cUL, 0x41d0bdf0UL,
+    0xc6f32655UL, 0x58f38c99UL, 0xbbf40317UL, 0x25f4a9dbUL, 0x3cfd6cd1UL,
+    0xa2fdc61dUL, 0x41fa4993UL, 0xdffae35fUL, 0x73e8c386UL, 0xede8694aUL,
+    0x0eefe6c4UL, 0x90ef4c08UL, 0x89e68902UL, 0x17e623ceUL, 0xf4e1ac40UL,
+    0x6ae1068cUL, 0xbba0ebd0UL, 0x25a0411cUL, 0xc6a7ce92UL, 0x58a7645eUL,
+    0x41aea154UL, 0xdfae0b98UL, 0x3ca98416UL, 0xa2a92edaUL, 0x0ebb0e03UL,
+    0x90bba4cfUL, 0x73bc2b41UL, 0xedbc818dUL, 0xf4b54487UL, 0x6ab5ee4bUL,
+    0x89b261c5UL, 0x17b2cb09UL, 0x909150acUL, 0x0e91fa60UL, 0xed9675eeUL,
+    0x7396df22UL, 0x6a9f1a28UL, 0xf49fb0e4UL, 0x17983f6aUL, 0x899895a6UL,
+    0x258ab57fUL, 0xbb8a1fb3UL, 0x588d903dUL, 0xc68d3af1UL, 0xdf84fffbUL,
+    0x41845537UL, 0xa283dab9UL, 0x3c837075UL, 0xda853b53UL, 0x4485919fUL,
+    0xa7821e11UL, 0x3982b4ddUL, 0x208b71d7UL, 0xbe8bdb1bUL, 0x5d8c5495UL,
+    0xc38cfe59UL, 0x6f9ede80UL, 0xf19e744cUL, 0x1299fbc2UL, 0x8c99510eUL,
+    0x95909404UL, 0x0b903ec8UL, 0xe897b146UL, 0x76971b8aUL, 0xf1b4802fUL,
+    0x6fb42ae3UL, 0x8cb3a56dUL, 0x12b30fa1UL, 0x0bbacaabUL, 0x95ba6067UL,
+    0x76bdefe9UL, 0xe8bd4525UL, 0x44af65fcUL, 0xdaafcf30UL, 0x39a840beUL,
+    0xa7a8ea72UL, 0xbea12f78UL, 0x20a185b4UL, 0xc3a60a3aUL, 0x5da6a0f6UL,
+    0x8ce74daaUL, 0x12e7e766UL, 0xf1e068e8UL, 0x6fe0c224UL, 0x76e9072eUL,
+    0xe8e9ade2UL, 0x0bee226cUL, 0x95ee88a0UL, 0x39fca879UL, 0xa7fc02b5UL,
+    0x44fb8d3bUL, 0xdafb27f7UL, 0xc3f2e2fdUL, 0x5df24831UL, 0xbef5c7bfUL,
+    0x20f56d73UL, 0xa7d6f6d6UL, 0x39d65c1aUL, 0xdad1d394UL, 0x44d17958UL,
+    0x5dd8bc52UL, 0xc3d8169eUL, 0x20df9910UL, 0xbedf33dcUL, 0x12cd1305UL,
+    0x8ccdb9c9UL, 0x6fca3647UL, 0xf1ca9c8bUL, 0xe8c35981UL, 0x76c3f34dUL,
+    0x95c47cc3UL, 0x0bc4d60fUL, 0x3747a67aUL, 0xa9470cb6UL, 0x4a408338UL,
+    0xd44029f4UL, 0xcd49ecfeUL, 0x53494632UL, 0xb04ec9bcUL, 0x2e4e6370UL,
+    0x825c43a9UL, 0x1c5ce965UL, 0xff5b66ebUL, 0x615bcc27UL, 0x7852092dUL,
+    0xe652a3e1UL, 0x05552c6fUL, 0x9b5586a3UL, 0x1c761d06UL, 0x8276b7caUL,
+    0x61713844UL, 0xff719288UL, 0xe6785782UL, 0x7878fd4eUL, 0x9b7f72c0UL,
+    0x057fd80cUL, 0xa96df8d5UL, 0x376d5219UL, 0xd46add97UL, 0x4a6a775bUL,
+    0x5363b251UL, 0xcd63189dUL, 0x2e649713UL, 0xb0643ddfUL, 0x6125d083UL,
+    0xff257a4fUL, 0x1c22f5c1UL, 0x82225f0dUL, 0x9b2b9a07UL, 0x052b30cbUL,
+    0xe62cbf45UL, 0x782c1589UL, 0xd43e3550UL, 0x4a3e9f9cUL, 0xa9391012UL,
+    0x3739badeUL, 0x2e307fd4UL, 0xb030d518UL, 0x53375a96UL, 0xcd37f05aUL,
+    0x4a146bffUL, 0xd414c133UL, 0x37134ebdUL, 0xa913e471UL, 0xb01a217bUL,
+    0x2e1a8bb7UL, 0xcd1d0439UL, 0x531daef5UL, 0xff0f8e2cUL, 0x610f24e0UL,
+    0x8208ab6eUL, 0x1c0801a2UL, 0x0501c4a8UL, 0x9b016e64UL, 0x7806e1eaUL,
+    0xe6064b26UL
+#endif
 #endif
   }
 };
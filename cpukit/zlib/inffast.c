@@ -29,6 +29,21 @@
 #  define PUP(a) *++(a)
 #endif
 
+/* Allow a wider bit buffer and block match copies at build time.  Define
+   INFLATE_FAST_WIDE to hold up to 64 bits of input, refill the buffer four
+   bytes at a time once per code instead of two bytes at a time as needed, and
+   copy matches of eight or more bytes with memcpy().  An overlapping match
+   copies the pattern once and then doubles the copy from the start of the
+   pattern, which never overlaps.  The most input used by a length/distance
+   pair is still six bytes.  The 64-bit shifts can cost more than they save on
+   32-bit processors so measure before enabling it.
+ */
+#ifdef INFLATE_FAST_WIDE
+   typedef unsigned long long hold_t;
+#else
+   typedef unsigned long hold_t;
+#endif
+
 /*
    Decode literal, length, and distance codes and write out the resulting
    literal and match bytes until either not enough input or output is
@@ -81,7 +96,7 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
     unsigned whave;             /* valid bytes in the window */
     unsigned wnext;             /* window write index */
     unsigned char FAR *window;  /* allocated sliding window, if wsize != 0 */
-    unsigned long hold;         /* local strm->hold */
+    hold_t hold;                /* local strm->hold */
     unsigned bits;              /* local strm->bits */
     code const FAR *lcode;      /* local strm->lencode */
     code const FAR *dcode;      /* local strm->distcode */
@@ -118,12 +133,25 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
     /* decode literals and length/distances until end-of-block or not enough
        input data or output space */
     do {
+#ifdef INFLATE_FAST_WIDE
+        if (bits < 32) {
+            hold += (hold_t)(PUP(in)) << bits;
+            bits += 8;
+            hold += (hold_t)(PUP(in)) << bits;
+            bits += 8;
+            hold += (hold_t)(PUP(in)) << bits;
+            bits += 8;
+            hold += (hold_t)(PUP(in)) << bits;
+            bits += 8;
+        }
+#else
         if (bits < 15) {
-            hold += (unsigned long)(PUP(in)) << bits;
+            hold += (hold_t)(PUP(in)) << bits;
             bits += 8;
-            hold += (unsigned long)(PUP(in)) << bits;
+            hold += (hold_t)(PUP(in)) << bits;
             bits += 8;
         }
+#endif
         here = lcode[hold & lmask];
       dolen:
         op = (unsigned)(here.bits);
@@ -141,7 +169,7 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
             op &= 15;                           /* number of extra bits */
             if (op) {
                 if (bits < op) {
-                    hold += (unsigned long)(PUP(in)) << bits;
+                    hold += (hold_t)(PUP(in)) << bits;
                     bits += 8;
                 }
                 len += (unsigned)hold & ((1U << op) - 1);
@@ -150,9 +178,9 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
             }
             Tracevv((stderr, "inflate:         length %u\n", len));
             if (bits < 15) {
-                hold += (unsigned long)(PUP(in)) << bits;
+                hold += (hold_t)(PUP(in)) << bits;
                 bits += 8;
-                hold += (unsigned long)(PUP(in)) << bits;
+                hold += (hold_t)(PUP(in)) << bits;
                 bits += 8;
             }
             here = dcode[hold & dmask];
@@ -165,10 +193,10 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
                 dist = (unsigned)(here.val);
                 op &= 15;                       /* number of extra bits */
                 if (bits < op) {
-                    hold += (unsigned long)(PUP(in)) << bits;
+                    hold += (hold_t)(PUP(in)) << bits;
                     bits += 8;
                     if (bits < op) {
-                        hold += (unsigned long)(PUP(in)) << bits;
+                        hold += (hold_t)(PUP(in)) << bits;
                         bits += 8;
                     }
                 }
@@ -267,6 +295,22 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
                 }
                 else {
                     from = out - dist;          /* copy direct from output */
+#ifdef INFLATE_FAST_WIDE
+                    if (len >= 8) {
+                        unsigned char FAR *to = out + OFF;
+                        out += len;
+                        from += OFF;
+                        op = dist;
+                        while (len > op) {      /* overlapped, double it */
+                            zmemcpy(to, from, op);
+                            to += op;
+                            len -= op;
+                            op += op;
+                        }
+                        zmemcpy(to, from, len);
+                        continue;
+                    }
+#endif
                     do {                        /* minimum length is three */
                         PUP(out) = PUP(from);
                         PUP(out) = PUP(from);
@@ -306,7 +350,8 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
         }
     } while (in < last && out < end);
 
-    /* return unused bytes (on entry, bits < 8, so in won't go too far back) */
+    /* return unused bytes (on entry, bits < 8, so in won't go too far back,
+       all other bits in hold were read by this call) */
     len = bits >> 3;
     in -= len;
     bits -= len << 3;
@@ -391,16 +391,26 @@ extern rtems_shell_cmd_t rtems_shell_PERIODUSE_Command;
 @subheading SYNOPSYS:
 
 @example
-profreport
+profreport [-r|-R]
 @end example
 
 @subheading DESCRIPTION:
 
-This command may be used to print a profiling report.
+This command may be used to print a profiling report.  With the @code{-r}
+option the profiling statistics are reset after the report, so that the next
+report covers only the time interval since this report.  With the @code{-R}
+option the profiling statistics are reset without a report.
+
+In addition to the totals and maxima, the report contains approximate
+percentiles of the interrupt processing times and interrupt delays per
+processor and of the acquire times per SMP lock.  These are derived from
+histograms with logarithmic buckets, so a percentile value is the upper bound
+of the bucket containing it.  For each SMP lock the call sites with the most
+contended lock acquire operations are listed by their return address.
 
 @subheading EXIT STATUS:
 
-This command returns 0.
+This command returns 0 on success and 1 in case of an invalid option.
 
 @subheading NOTES:
 
@@ -3087,6 +3087,41 @@ This is not defined by default.
 In case this configuration option is defined, then the support to remove nodes
 is disabled in the root IMFS.
 
+@c
+@c === CONFIGURE_FILESYSTEM_DENTRY_CACHE_ENTRIES ===
+@c
+@subsection Path Lookup Cache Size
+
+@findex CONFIGURE_FILESYSTEM_DENTRY_CACHE_ENTRIES
+
+@table @b
+@item CONSTANT:
+@code{CONFIGURE_FILESYSTEM_DENTRY_CACHE_ENTRIES}
+
+@item DATA TYPE:
+Unsigned integer (@code{uint32_t}).
+
+@item RANGE:
+Zero or positive.
+
+@item DEFAULT VALUE:
+The default value is 64 in case @code{CONFIGURE_FILESYSTEM_DOSFS} or
+@code{CONFIGURE_FILESYSTEM_RFS} is defined, otherwise 0.
+
+@end table
+
+@subheading DESCRIPTION:
+This configuration parameter defines the number of entries of the path lookup
+cache.  The cache maps a directory and a name to the corresponding node or
+records that the name does not exist.  File systems which support the cache
+use it to avoid directory scans during the path evaluation, e.g. in
+@code{open()} or @code{stat()}.  A value of zero disables the cache.
+
+@subheading NOTES:
+The DOSFS and RFS support the path lookup cache.  All cache entries of a file
+system instance are invalidated by each change of its name space, e.g. the
+creation, removal or rename of a node.
+
 @c
 @c === Block Device Cache Configuration ===
 @c
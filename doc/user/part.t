@@ -18,6 +18,7 @@ provided by the partition manager are:
 @item @code{@value{DIRPREFIX}partition_ident} - Get ID of a partition
 @item @code{@value{DIRPREFIX}partition_delete} - Delete a partition
 @item @code{@value{DIRPREFIX}partition_get_buffer} - Get buffer from a partition
+@item @code{@value{DIRPREFIX}partition_get_buffers} - Get several buffers from a partition
 @item @code{@value{DIRPREFIX}partition_return_buffer} - Return buffer to a partition
 @end itemize
 
@@ -103,7 +104,9 @@ If a buffer is available, then
 it is returned immediately with a successful return code.
 Otherwise, an unsuccessful return code is returned immediately
 to the caller.  Tasks cannot block to wait for a buffer to
-become available.
+become available.  The
+@code{@value{DIRPREFIX}partition_get_buffers} directive obtains
+several buffers at once within one critical section.
 
 @subsection Releasing a Buffer
 
@@ -405,6 +408,55 @@ Getting a buffer from a global partition which does
 not reside on the local node will generate a request telling the
 remote node to allocate a buffer from the specified partition.
 
+@c
+@c
+@c
+@page
+@subsection PARTITION_GET_BUFFERS - Get several buffers from a partition
+
+@cindex get buffers from partition
+@cindex obtain buffers from partition
+
+@subheading CALLING SEQUENCE:
+
+@ifset is-C
+@findex rtems_partition_get_buffers
+@example
+rtems_status_code rtems_partition_get_buffers(
+  rtems_id   id,
+  void     **buffers,
+  uint32_t   count,
+  uint32_t  *obtained
+);
+@end example
+@end ifset
+
+@subheading DIRECTIVE STATUS CODES:
+@code{@value{RPREFIX}SUCCESSFUL} - at least one buffer obtained successfully@*
+@code{@value{RPREFIX}INVALID_ADDRESS} - @code{buffers} or @code{obtained} is NULL@*
+@code{@value{RPREFIX}INVALID_NUMBER} - @code{count} is zero@*
+@code{@value{RPREFIX}INVALID_ID} - invalid partition id@*
+@code{@value{RPREFIX}ILLEGAL_ON_REMOTE_OBJECT} - partition resides on a remote node@*
+@code{@value{RPREFIX}UNSATISFIED} - all buffers are allocated
+
+@subheading DESCRIPTION:
+
+This directive obtains up to count buffers from the partition specified in
+id.  The addresses of the allocated buffers are stored in the first elements
+of the buffers array and the number of allocated buffers is returned in
+obtained.  All buffers are allocated within one critical section, so this
+directive is cheaper than count calls of
+@code{@value{DIRPREFIX}partition_get_buffer}.
+
+@subheading NOTES:
+
+This directive will not cause the running task to be
+preempted.
+
+This directive may be called from within an interrupt service routine.
+
+A task cannot wait on buffers to become available.
+
 @c
 @c
 @c
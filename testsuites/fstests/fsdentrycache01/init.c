@@ -0,0 +1,379 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "tmacros.h"
+
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtems/libio_.h>
+#include <rtems/blkdev.h>
+#include <rtems/dosfs.h>
+#include <rtems/ramdisk.h>
+#include <rtems/rtems-rfs-format.h>
+
+const char rtems_test_name[] = "FSDENTRYCACHE 1";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+#define DEPTH 8
+
+#define ITERATIONS 1000
+
+#define PATH_SIZE 256
+
+typedef struct {
+  const char *name;
+  const char *mnt;
+  rtems_filesystem_mount_table_entry_t *mt_entry;
+  char dir[PATH_SIZE];
+  char file[PATH_SIZE];
+  char missing[PATH_SIZE];
+  char renamed[PATH_SIZE];
+} test_context;
+
+static test_context test_instance;
+
+static void init_paths(test_context *ctx)
+{
+  size_t i;
+
+  strcpy(ctx->dir, ctx->mnt);
+
+  for (i = 0; i < DEPTH; ++i) {
+    int rv;
+
+    sprintf(ctx->dir + strlen(ctx->dir), "/directory-%zu", i);
+    rv = mkdir(ctx->dir, S_IRWXU | S_IRWXG | S_IRWXO);
+    rtems_test_assert(rv == 0);
+  }
+
+  sprintf(ctx->file, "%s/file", ctx->dir);
+  sprintf(ctx->missing, "%s/missing", ctx->dir);
+  sprintf(ctx->renamed, "%s/directory-renamed", ctx->mnt);
+}
+
+static void get_mt_entry(test_context *ctx)
+{
+  int fd;
+  int rv;
+
+  fd = open(ctx->mnt, O_RDONLY);
+  rtems_test_assert(fd >= 0);
+
+  ctx->mt_entry = rtems_libio_iop(fd)->pathinfo.mt_entry;
+
+  rv = close(fd);
+  rtems_test_assert(rv == 0);
+}
+
+static void create_file(const char *file)
+{
+  int fd;
+  int rv;
+
+  fd = creat(file, S_IRWXU | S_IRWXG | S_IRWXO);
+  rtems_test_assert(fd >= 0);
+
+  rv = close(fd);
+  rtems_test_assert(rv == 0);
+}
+
+static void check_exists(const char *path)
+{
+  struct stat st;
+  int rv;
+
+  rv = stat(path, &st);
+  rtems_test_assert(rv == 0);
+}
+
+static void check_no_entry(const char *path)
+{
+  struct stat st;
+  int rv;
+
+  errno = 0;
+  rv = stat(path, &st);
+  rtems_test_assert(rv == -1);
+  rtems_test_assert(errno == ENOENT);
+}
+
+static const rtems_filesystem_dentry_cache_entry *find_entry(
+  const test_context *ctx,
+  const char *name
+)
+{
+  size_t namelen = strlen(name);
+  uint32_t i;
+
+  for (i = 0; i < rtems_filesystem_dentry_cache_size; ++i) {
+    const rtems_filesystem_dentry_cache_entry *entry =
+      &rtems_filesystem_dentry_cache_table[i];
+
+    if (
+      entry->mt_entry == ctx->mt_entry
+        && entry->generation == ctx->mt_entry->dentry_cache_generation
+        && entry->namelen == namelen
+        && memcmp(entry->name, name, namelen) == 0
+    ) {
+      return entry;
+    }
+  }
+
+  return NULL;
+}
+
+static void check_cache(test_context *ctx)
+{
+  const rtems_filesystem_dentry_cache_entry *entry;
+  char old[PATH_SIZE];
+  char new[PATH_SIZE];
+  int rv;
+
+  printf("check path lookup cache of %s\n", ctx->name);
+
+  create_file(ctx->file);
+
+  /* Positive entries */
+  check_exists(ctx->file);
+  entry = find_entry(ctx, "file");
+  rtems_test_assert(entry != NULL);
+  rtems_test_assert(!entry->negative);
+  check_exists(ctx->file);
+
+  /* Negative entries */
+  check_no_entry(ctx->missing);
+  entry = find_entry(ctx, "missing");
+  rtems_test_assert(entry != NULL);
+  rtems_test_assert(entry->negative);
+  check_no_entry(ctx->missing);
+
+  /* The creation of a node invalidates the negative entry */
+  create_file(ctx->missing);
+  rtems_test_assert(find_entry(ctx, "missing") == NULL);
+  check_exists(ctx->missing);
+
+  /* The removal of a node invalidates the positive entry */
+  rv = unlink(ctx->missing);
+  rtems_test_assert(rv == 0);
+  check_no_entry(ctx->missing);
+
+  /* A rename of a directory in the middle of the path */
+  check_exists(ctx->file);
+  sprintf(old, "%s/directory-0", ctx->mnt);
+  rv = rename(old, ctx->renamed);
+  rtems_test_assert(rv == 0);
+  check_no_entry(ctx->file);
+
+  strcpy(new, ctx->renamed);
+  strcat(new, ctx->file + strlen(old));
+  check_exists(new);
+
+  rv = rename(ctx->renamed, old);
+  rtems_test_assert(rv == 0);
+  check_no_entry(new);
+  check_exists(ctx->file);
+
+  /* A symbolic link to a cached node */
+  if (strcmp(ctx->name, "rfs") == 0) {
+    sprintf(new, "%s/link", ctx->mnt);
+    rv = symlink(ctx->dir, new);
+    rtems_test_assert(rv == 0);
+    strcat(new, "/file");
+    check_exists(new);
+    check_exists(new);
+    new[strlen(new) - strlen("/file")] = '\0';
+    rv = unlink(new);
+    rtems_test_assert(rv == 0);
+    strcat(new, "/file");
+    check_no_entry(new);
+  }
+}
+
+static void measure(
+  test_context *ctx,
+  const char *label,
+  const char *path,
+  bool exists,
+  bool cache
+)
+{
+  uint64_t t0;
+  uint64_t t1;
+  size_t i;
+
+  /* Populate the cache */
+  if (exists) {
+    check_exists(path);
+  } else {
+    check_no_entry(path);
+  }
+
+  t0 = rtems_clock_get_uptime_nanoseconds();
+
+  for (i = 0; i < ITERATIONS; ++i) {
+    struct stat st;
+
+    if (!cache) {
+      rtems_filesystem_dentry_cache_invalidate(ctx->mt_entry);
+    }
+
+    (void) stat(path, &st);
+  }
+
+  t1 = rtems_clock_get_uptime_nanoseconds();
+
+  if (t1 == t0) {
+    t1 = t0 + 1;
+  }
+
+  printf(
+    "  <%s fs=\"%s\" cache=\"%s\" unit=\"1/s\">%" PRIu64 "</%s>\n",
+    label,
+    ctx->name,
+    cache ? "on" : "off",
+    ((uint64_t) ITERATIONS * 1000000000) / (t1 - t0),
+    label
+  );
+}
+
+static void measure_all(test_context *ctx)
+{
+  measure(ctx, "Stat", ctx->file, true, true);
+  measure(ctx, "Stat", ctx->file, true, false);
+  measure(ctx, "StatNoEntry", ctx->missing, false, true);
+  measure(ctx, "StatNoEntry", ctx->missing, false, false);
+}
+
+static void mount_dosfs(test_context *ctx, const char *disk)
+{
+  static const msdos_format_request_param_t rqdata = {
+    .quick_format = true
+  };
+  int rv;
+
+  rv = msdos_format(disk, &rqdata);
+  rtems_test_assert(rv == 0);
+
+  rv = mount_and_make_target_path(
+    disk,
+    ctx->mnt,
+    RTEMS_FILESYSTEM_TYPE_DOSFS,
+    RTEMS_FILESYSTEM_READ_WRITE,
+    NULL
+  );
+  rtems_test_assert(rv == 0);
+}
+
+static void mount_rfs(test_context *ctx, const char *disk)
+{
+  static const rtems_rfs_format_config config = {
+    .block_size = 512
+  };
+  int rv;
+
+  rv = rtems_rfs_format(disk, &config);
+  rtems_test_assert(rv == 0);
+
+  rv = mount_and_make_target_path(
+    disk,
+    ctx->mnt,
+    RTEMS_FILESYSTEM_TYPE_RFS,
+    RTEMS_FILESYSTEM_READ_WRITE,
+    NULL
+  );
+  rtems_test_assert(rv == 0);
+}
+
+static void test(void)
+{
+  test_context *ctx = &test_instance;
+  rtems_status_code sc;
+  int rv;
+
+  sc = rtems_disk_io_initialize();
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  printf("<DentryCache depth=\"%d\">\n", DEPTH);
+
+  ctx->name = "dosfs";
+  ctx->mnt = "/dosfs";
+  mount_dosfs(ctx, "/dev/rda");
+  get_mt_entry(ctx);
+  init_paths(ctx);
+  check_cache(ctx);
+  measure_all(ctx);
+  rv = unmount(ctx->mnt);
+  rtems_test_assert(rv == 0);
+
+  ctx->name = "rfs";
+  ctx->mnt = "/rfs";
+  mount_rfs(ctx, "/dev/rdb");
+  get_mt_entry(ctx);
+  init_paths(ctx);
+  check_cache(ctx);
+  measure_all(ctx);
+  rv = unmount(ctx->mnt);
+  rtems_test_assert(rv == 0);
+
+  printf("</DentryCache>\n");
+}
+
+static void Init(rtems_task_argument arg)
+{
+  TEST_BEGIN();
+
+  test();
+
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+rtems_ramdisk_config rtems_ramdisk_configuration [] = {
+  { .block_size = 512, .block_num = 1024 },
+  { .block_size = 512, .block_num = 1024 }
+};
+
+size_t rtems_ramdisk_configuration_size = 2;
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+#define CONFIGURE_APPLICATION_EXTRA_DRIVERS RAMDISK_DRIVER_TABLE_ENTRY
+#define CONFIGURE_APPLICATION_NEEDS_LIBBLOCK
+
+#define CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS 6
+
+#define CONFIGURE_FILESYSTEM_DOSFS
+#define CONFIGURE_FILESYSTEM_RFS
+
+#define CONFIGURE_MAXIMUM_TASKS 2
+
+#define CONFIGURE_EXTRA_TASK_STACKS (8 * 1024)
+
+#define CONFIGURE_INIT_TASK_STACK_SIZE (16 * 1024)
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#define CONFIGURE_INIT
+
+#include <rtems/confdefs.h>
@@ -0,0 +1,169 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <dlfcn.h>
+
+#include <rtems.h>
+#include <rtems/rtl/rtl-obj-cache.h>
+
+#include "dl-load.h"
+
+/*
+ * The object file as extracted from the tar image is an IMFS linear file and
+ * is mapped by the loader. The copy is a memory file which has to be read.
+ */
+#define MAPPED_FILE "/dl-o1.o"
+#define READ_FILE   "/dl-o1-copy.o"
+
+#define LOADS 30
+
+static int copy_file(const char* from, const char* to)
+{
+  char    buf[512];
+  int     in;
+  int     out;
+  ssize_t n;
+
+  in = open(from, O_RDONLY);
+  if (in < 0)
+    return 1;
+
+  out = open(to, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (out < 0)
+  {
+    close(in);
+    return 1;
+  }
+
+  while ((n = read(in, buf, sizeof(buf))) > 0)
+  {
+    if (write(out, buf, n) != n)
+    {
+      n = -1;
+      break;
+    }
+  }
+
+  close(in);
+  close(out);
+
+  return n < 0 ? 1 : 0;
+}
+
+static int check_image(const char* name, bool mapped)
+{
+  const uint8_t* image;
+  size_t         size;
+  bool           has_image;
+  int            fd;
+
+  fd = open(name, O_RDONLY);
+  if (fd < 0)
+  {
+    printf("open failed: %s\n", name);
+    return 1;
+  }
+
+  has_image = rtems_rtl_obj_cache_file_image(fd, &image, &size);
+  close(fd);
+
+  if (has_image != mapped)
+  {
+    printf("%s: unexpected file image state\n", name);
+    return 1;
+  }
+
+  return 0;
+}
+
+static int load(const char* name)
+{
+  void* handle;
+
+  handle = dlopen(name, RTLD_NOW | RTLD_GLOBAL);
+  if (!handle)
+  {
+    printf("dlopen failed: %s\n", dlerror());
+    return 1;
+  }
+
+  if (dlsym(handle, "rtems_main") == NULL)
+  {
+    printf("dlsym failed: symbol not found\n");
+    return 1;
+  }
+
+  if (dlclose(handle) < 0)
+  {
+    printf("dlclose failed: %s\n", dlerror());
+    return 1;
+  }
+
+  return 0;
+}
+
+static int measure(const char* label, const char* name)
+{
+  uint64_t t0;
+  uint64_t t1;
+  int      i;
+
+  /*
+   * The first load creates the linker and its caches.
+   */
+  if (load(name))
+    return 1;
+
+  t0 = rtems_clock_get_uptime_nanoseconds();
+
+  for (i = 0; i < LOADS; ++i)
+  {
+    if (load(name))
+      return 1;
+  }
+
+  t1 = rtems_clock_get_uptime_nanoseconds();
+
+  printf("  <%s unit=\"us/load\">%" PRIu64 "</%s>\n",
+         label, (t1 - t0) / (LOADS * 1000), label);
+
+  return 0;
+}
+
+int dl_load_test(void)
+{
+  printf("copy: " MAPPED_FILE " -> " READ_FILE "\n");
+
+  if (copy_file(MAPPED_FILE, READ_FILE))
+  {
+    printf("copy failed\n");
+    return 1;
+  }
+
+  printf("check file images\n");
+
+  if (check_image(MAPPED_FILE, true) || check_image(READ_FILE, false))
+    return 1;
+
+  printf("<DlLoad loads=\"%d\">\n", LOADS);
+
+  if (measure("Read", READ_FILE) || measure("Mapped", MAPPED_FILE))
+    return 1;
+
+  printf("</DlLoad>\n");
+
+  return 0;
+}
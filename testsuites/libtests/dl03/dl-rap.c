@@ -0,0 +1,261 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <dlfcn.h>
+
+/*
+ * The RAP loader checks the machine and data type with the 32-bit names.
+ */
+#define ELFSIZE 32
+#include <sys/exec_elf.h>
+
+#include "dl-rap.h"
+
+#define RAP_FILE "/dl-rap.rap"
+
+/*
+ * The fixed RAP section indexes.
+ */
+#define RAP_TEXT  0
+#define RAP_CONST 1
+#define RAP_CTOR  2
+#define RAP_DTOR  3
+#define RAP_DATA  4
+#define RAP_BSS   5
+#define RAP_SECS  6
+
+#define RAP_PRELINKED (UINT32_C(1) << 30)
+
+#define PRELINK(sect, offset) (((uint32_t) (sect) << 28) | (offset))
+
+#define CONST_0 UINT32_C(0x11111111)
+#define CONST_1 UINT32_C(0x22222222)
+#define UNRELOCATED UINT32_C(0x123)
+
+static const char strtab[] = "dl_rap_const\0dl_rap_data\0dl_rap_bss";
+
+#define NAME_CONST 0
+#define NAME_DATA  13
+#define NAME_BSS   25
+
+typedef struct {
+  uint8_t buf[512];
+  size_t  pos;
+} rap_image;
+
+static void put_u32(rap_image* img, uint32_t value)
+{
+  img->buf[img->pos++] = (uint8_t) (value >> 24);
+  img->buf[img->pos++] = (uint8_t) (value >> 16);
+  img->buf[img->pos++] = (uint8_t) (value >> 8);
+  img->buf[img->pos++] = (uint8_t) value;
+}
+
+/*
+ * Section contents are in the byte order of the target.
+ */
+static void put_native(rap_image* img, uint32_t value)
+{
+  memcpy(&img->buf[img->pos], &value, sizeof(value));
+  img->pos += sizeof(value);
+}
+
+static void put_symbol(rap_image* img, int sect, uint32_t name)
+{
+  put_u32(img, ((uint32_t) sect << 16) | ELF_ST_INFO(STB_GLOBAL, STT_OBJECT));
+  put_u32(img, name);
+  put_u32(img, 0);
+}
+
+/*
+ * Build an uncompressed RAP image. The data section holds three words with
+ * prelinked relocations: the second word of the const section, the first
+ * word of the const section and the word itself. The last data word has no
+ * relocation. The last record is the one passed by the caller.
+ */
+static size_t build_image(uint8_t* file, size_t size, uint32_t last_record)
+{
+  rap_image img = { .pos = 0 };
+  size_t    header;
+  int       s;
+
+  put_u32(&img, ELFDEFNNAME(MACHDEP_ID));
+  put_u32(&img, ELFDEFNNAME(MACHDEP_ENDIANNESS));
+  put_u32(&img, ARCH_ELFSIZE == 64 ? ELFCLASS64 : ELFCLASS32);
+  put_u32(&img, 0);                            /* init */
+  put_u32(&img, 0);                            /* fini */
+  put_u32(&img, 3 * 3 * sizeof(uint32_t));     /* symtab_size */
+  put_u32(&img, sizeof(strtab));               /* strtab_size */
+  put_u32(&img, 0);                            /* relocs_size */
+  put_u32(&img, 0);                            /* obj_num */
+
+  put_u32(&img, 4);  put_u32(&img, 4);         /* text */
+  put_u32(&img, 8);  put_u32(&img, 4);         /* const */
+  put_u32(&img, 0);  put_u32(&img, 4);         /* ctor */
+  put_u32(&img, 0);  put_u32(&img, 4);         /* dtor */
+  put_u32(&img, 16); put_u32(&img, 4);         /* data */
+  put_u32(&img, 8);  put_u32(&img, 4);         /* bss */
+
+  put_native(&img, 0);
+  put_native(&img, CONST_0);
+  put_native(&img, CONST_1);
+  put_native(&img, 4);
+  put_native(&img, 0);
+  put_native(&img, 8);
+  put_native(&img, UNRELOCATED);
+
+  memcpy(&img.buf[img.pos], strtab, sizeof(strtab));
+  img.pos += sizeof(strtab);
+
+  put_symbol(&img, RAP_CONST, NAME_CONST);
+  put_symbol(&img, RAP_DATA, NAME_DATA);
+  put_symbol(&img, RAP_BSS, NAME_BSS);
+
+  for (s = 0; s < RAP_SECS; ++s)
+  {
+    if (s == RAP_DATA)
+    {
+      put_u32(&img, RAP_PRELINKED);
+      put_u32(&img, 3);
+      put_u32(&img, PRELINK(RAP_CONST, 0));
+      put_u32(&img, PRELINK(RAP_CONST, 4));
+      put_u32(&img, last_record);
+    }
+    else
+    {
+      put_u32(&img, 0);
+    }
+  }
+
+  header = snprintf((char*) file, size, "RAP,%08zu,0001,NONE,00000000\n",
+                    img.pos);
+
+  /*
+   * One uncompressed block.
+   */
+  file[header] = (uint8_t) (img.pos >> 8);
+  file[header + 1] = (uint8_t) img.pos;
+  memcpy(&file[header + 2], img.buf, img.pos);
+
+  return header + 2 + img.pos;
+}
+
+static int write_image(uint32_t last_record)
+{
+  uint8_t file[600];
+  size_t  size;
+  int     fd;
+  ssize_t n;
+
+  size = build_image(file, sizeof(file), last_record);
+
+  fd = open(RAP_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return 1;
+
+  n = write(fd, file, size);
+  close(fd);
+
+  return n == (ssize_t) size ? 0 : 1;
+}
+
+static int check_prelinked(void)
+{
+  void*           handle;
+  const uint32_t* c;
+  const uint32_t* d;
+  const uint32_t* b;
+
+  printf("rap: prelinked relocations\n");
+
+  if (write_image(PRELINK(RAP_DATA, 8)))
+  {
+    printf("write failed: " RAP_FILE "\n");
+    return 1;
+  }
+
+  handle = dlopen(RAP_FILE, RTLD_NOW | RTLD_GLOBAL);
+  if (!handle)
+  {
+    printf("dlopen failed: %s\n", dlerror());
+    return 1;
+  }
+
+  c = dlsym(handle, "dl_rap_const");
+  d = dlsym(handle, "dl_rap_data");
+  b = dlsym(handle, "dl_rap_bss");
+
+  if (c == NULL || d == NULL || b == NULL)
+  {
+    printf("dlsym failed: symbol not found\n");
+    return 1;
+  }
+
+  if (c[0] != CONST_0 || c[1] != CONST_1 || b[0] != 0 || b[1] != 0)
+  {
+    printf("rap: bad section contents\n");
+    return 1;
+  }
+
+  if (d[0] != (uint32_t) (uintptr_t) &c[1] ||
+      d[1] != (uint32_t) (uintptr_t) &c[0] ||
+      d[2] != (uint32_t) (uintptr_t) &d[2] ||
+      d[3] != UNRELOCATED)
+  {
+    printf("rap: bad prelinked relocation\n");
+    return 1;
+  }
+
+  if (dlclose(handle) < 0)
+  {
+    printf("dlclose failed: %s\n", dlerror());
+    return 1;
+  }
+
+  return 0;
+}
+
+static int check_invalid_record(void)
+{
+  void* handle;
+
+  printf("rap: prelinked relocation out of the section\n");
+
+  if (write_image(PRELINK(RAP_DATA, 16)))
+  {
+    printf("write failed: " RAP_FILE "\n");
+    return 1;
+  }
+
+  handle = dlopen(RAP_FILE, RTLD_NOW | RTLD_GLOBAL);
+  if (handle)
+  {
+    printf("dlopen of an invalid image succeeded\n");
+    dlclose(handle);
+    return 1;
+  }
+
+  return 0;
+}
+
+int dl_rap_test(void)
+{
+  if (check_prelinked() || check_invalid_record())
+    return 1;
+
+  unlink(RAP_FILE);
+
+  return 0;
+}
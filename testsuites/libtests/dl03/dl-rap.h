@@ -0,0 +1,15 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#if !defined(_DL_RAP_H_)
+#define _DL_RAP_H_
+
+int dl_rap_test(void);
+
+#endif
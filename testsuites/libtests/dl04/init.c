@@ -0,0 +1,266 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "tmacros.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rtems/rtl/rtl.h>
+
+const char rtems_test_name[] = "libdl (RTL) 4";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+/*
+ * The size of a typical base image symbol table.
+ */
+#define SYMBOLS 15000
+
+#define NAME_SIZE 16
+
+typedef struct {
+  char                     esym_names[SYMBOLS][NAME_SIZE];
+  char                     image_names[SYMBOLS][NAME_SIZE];
+  rtems_rtl_obj_sym_t      image_syms[SYMBOLS];
+  rtems_rtl_symbol_slot_t* image_slots;
+  rtems_rtl_symbol_image_t image;
+  unsigned char*           esyms;
+  size_t                   esyms_size;
+} test_context;
+
+static test_context test_instance;
+
+static void *sym_value(int i)
+{
+  return (void *) (uintptr_t) (0x1000 + i);
+}
+
+/*
+ * Build an exported symbol table as generated for the base image.
+ */
+static void build_esyms(test_context *ctx)
+{
+  unsigned char *p;
+  int i;
+
+  ctx->esyms_size = SYMBOLS * (NAME_SIZE + sizeof(void *)) + 5;
+  ctx->esyms = malloc(ctx->esyms_size);
+  rtems_test_assert(ctx->esyms != NULL);
+
+  p = ctx->esyms;
+
+  for (i = 0; i < SYMBOLS; ++i) {
+    void *value = sym_value(i);
+    size_t n;
+
+    snprintf(ctx->esym_names[i], NAME_SIZE, "esym_%05d", i);
+    n = strlen(ctx->esym_names[i]) + 1;
+    memcpy(p, ctx->esym_names[i], n);
+    p += n;
+    memcpy(p, &value, sizeof(value));
+    p += sizeof(value);
+  }
+
+  *p++ = '\0';
+  *p++ = 0xde;
+  *p++ = 0xad;
+  *p++ = 0xbe;
+  *p++ = 0xef;
+
+  ctx->esyms_size = (size_t) (p - ctx->esyms);
+}
+
+/*
+ * Build a prebuilt symbol table as a host tool generates it at link time.
+ */
+static void build_image(test_context *ctx)
+{
+  size_t nslots = 1;
+  size_t mask;
+  int i;
+
+  while (nslots < (SYMBOLS * 4) / 3 + 1) {
+    nslots *= 2;
+  }
+
+  ctx->image_slots = calloc(nslots, sizeof(*ctx->image_slots));
+  rtems_test_assert(ctx->image_slots != NULL);
+
+  mask = nslots - 1;
+
+  for (i = 0; i < SYMBOLS; ++i) {
+    rtems_rtl_obj_sym_t *sym = &ctx->image_syms[i];
+    uint32_t hash;
+    size_t s;
+
+    snprintf(ctx->image_names[i], NAME_SIZE, "isym_%05d", i);
+    sym->name = ctx->image_names[i];
+    sym->value = sym_value(i);
+
+    hash = rtems_rtl_symbol_hash(sym->name);
+    s = hash & mask;
+
+    while (ctx->image_slots[s].symbol != NULL) {
+      s = (s + 1) & mask;
+    }
+
+    ctx->image_slots[s].hash = hash;
+    ctx->image_slots[s].symbol = sym;
+  }
+
+  ctx->image.slots = ctx->image_slots;
+  ctx->image.nslots = nslots;
+  ctx->image.count = SYMBOLS;
+}
+
+static uint64_t now(void)
+{
+  return rtems_clock_get_uptime_nanoseconds();
+}
+
+static void check_lookups(test_context *ctx)
+{
+  int i;
+
+  rtems_rtl_lock();
+
+  for (i = 0; i < SYMBOLS; ++i) {
+    rtems_rtl_obj_sym_t *sym;
+
+    sym = rtems_rtl_symbol_global_find(ctx->esym_names[i]);
+    rtems_test_assert(sym != NULL);
+    rtems_test_assert(sym->value == sym_value(i));
+
+    sym = rtems_rtl_symbol_global_find(ctx->image_names[i]);
+    rtems_test_assert(sym == &ctx->image_syms[i]);
+  }
+
+  rtems_test_assert(rtems_rtl_symbol_global_find("no_such_symbol") == NULL);
+  rtems_test_assert(
+    rtems_rtl_symbol_global_find("rtems_rtl_base_sym_global_add") != NULL
+  );
+
+  rtems_rtl_unlock();
+}
+
+static void measure_lookups(
+  test_context *ctx,
+  const char *label,
+  char (*names)[NAME_SIZE]
+)
+{
+  uint64_t t0;
+  uint64_t t1;
+  int i;
+
+  rtems_rtl_lock();
+
+  t0 = now();
+
+  for (i = 0; i < SYMBOLS; ++i) {
+    (void) rtems_rtl_symbol_global_find(names[i]);
+  }
+
+  t1 = now();
+
+  rtems_rtl_unlock();
+
+  if (t1 == t0) {
+    t1 = t0 + 1;
+  }
+
+  printf(
+    "  <%s unit=\"lookups/s\">%" PRIu64 "</%s>\n",
+    label,
+    ((uint64_t) SYMBOLS * 1000000000) / (t1 - t0),
+    label
+  );
+}
+
+static void test(void)
+{
+  test_context *ctx = &test_instance;
+  uint64_t add_time;
+  uint64_t image_time;
+  uint64_t t0;
+
+  build_esyms(ctx);
+  build_image(ctx);
+
+  /* Create the run-time linker */
+  rtems_test_assert(rtems_rtl_lock() != NULL);
+  rtems_rtl_unlock();
+
+  printf("add exported symbol table\n");
+
+  t0 = now();
+  rtems_rtl_base_sym_global_add(ctx->esyms, ctx->esyms_size);
+  add_time = now() - t0;
+
+  printf("add prebuilt symbol table\n");
+
+  t0 = now();
+  rtems_rtl_base_sym_global_image(&ctx->image);
+  image_time = now() - t0;
+
+  printf("check lookups\n");
+
+  check_lookups(ctx);
+
+  printf(
+    "<SymbolTable symbols=\"%d\">\n"
+    "  <ExportedTableAdd unit=\"us\">%" PRIu64 "</ExportedTableAdd>\n"
+    "  <PrebuiltTableAdd unit=\"us\">%" PRIu64 "</PrebuiltTableAdd>\n",
+    SYMBOLS,
+    add_time / 1000,
+    image_time / 1000
+  );
+  measure_lookups(ctx, "ExportedLookup", ctx->esym_names);
+  measure_lookups(ctx, "PrebuiltLookup", ctx->image_names);
+  printf("</SymbolTable>\n");
+}
+
+static void Init(rtems_task_argument arg)
+{
+  TEST_BEGIN();
+
+  test();
+
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS 4
+
+#define CONFIGURE_MAXIMUM_TASKS 1
+#define CONFIGURE_MAXIMUM_SEMAPHORES 1
+
+#define CONFIGURE_UNIFIED_WORK_AREAS
+
+#define CONFIGURE_MINIMUM_TASK_STACK_SIZE (8U * 1024U)
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#define CONFIGURE_INIT
+
+#include <rtems/confdefs.h>
@@ -0,0 +1,193 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <dlfcn.h>
+
+#include <rtems.h>
+
+#include "dl-load.h"
+#include "dl-mod.h"
+
+#define REFERENCES (2 * DL_FUNCS * (DL_MODS - 1))
+
+static void* handles[DL_MODS];
+
+static int unresolved(int mod)
+{
+  int unresolved;
+  if (dlinfo(handles[mod], RTLD_DI_UNRESOLVED, &unresolved) < 0)
+  {
+    printf("dlinfo failed: %s\n", dlerror());
+    return -1;
+  }
+  return unresolved;
+}
+
+static int load(int mod, uint64_t* time)
+{
+  char     name[16];
+  uint64_t t0;
+
+  snprintf(name, sizeof(name), "/dl-m%d.o", mod);
+
+  t0 = rtems_clock_get_uptime_nanoseconds();
+  handles[mod] = dlopen(name, RTLD_NOW | RTLD_GLOBAL);
+  *time += rtems_clock_get_uptime_nanoseconds() - t0;
+
+  if (!handles[mod])
+  {
+    printf("dlopen failed: %s: %s\n", name, dlerror());
+    return 1;
+  }
+
+  return 0;
+}
+
+static int unload(int mod)
+{
+  if (dlclose(handles[mod]) < 0)
+  {
+    printf("dlclose failed: %s\n", dlerror());
+    return 1;
+  }
+  handles[mod] = NULL;
+  return 0;
+}
+
+static int check_modules(void)
+{
+  dl_entry_t entry;
+  int        mod;
+  int        result;
+
+  for (mod = 0; mod < DL_MODS; ++mod)
+  {
+    if (unresolved(mod) != 0)
+    {
+      printf("module %d has unresolved externals\n", mod);
+      return 1;
+    }
+  }
+
+  entry = dlsym(handles[0], "dl_m0_entry");
+  if (entry == NULL)
+  {
+    printf("dlsym failed: symbol not found\n");
+    return 1;
+  }
+
+  result = entry();
+  if (result != DL_ENTRY_RESULT)
+  {
+    printf("entry result bad: %d\n", result);
+    return 1;
+  }
+
+  for (mod = 0; mod < DL_MODS; ++mod)
+  {
+    if (unload(mod))
+      return 1;
+  }
+
+  return 0;
+}
+
+/*
+ * Load each module before the module it references. Every module other than
+ * the last has unresolved externals until the next module is loaded.
+ */
+static int dependents_first(uint64_t* time)
+{
+  int mod;
+
+  for (mod = 0; mod < DL_MODS; ++mod)
+  {
+    if (load(mod, time))
+      return 1;
+    if (mod > 0 && unresolved(mod - 1) != 0)
+    {
+      printf("module %d not resolved by module %d\n", mod - 1, mod);
+      return 1;
+    }
+    if (mod < (DL_MODS - 1) && unresolved(mod) != 1)
+    {
+      printf("module %d has no unresolved externals\n", mod);
+      return 1;
+    }
+  }
+
+  return check_modules();
+}
+
+/*
+ * Load each module after the module it references. There are no unresolved
+ * externals.
+ */
+static int dependencies_first(uint64_t* time)
+{
+  int mod;
+
+  for (mod = DL_MODS - 1; mod >= 0; --mod)
+  {
+    if (load(mod, time))
+      return 1;
+    if (unresolved(mod) != 0)
+    {
+      printf("module %d has unresolved externals\n", mod);
+      return 1;
+    }
+  }
+
+  return check_modules();
+}
+
+int dl_load_test(void)
+{
+  uint64_t dependents_time = 0;
+  uint64_t dependencies_time = 0;
+  uint64_t time = 0;
+
+  /*
+   * Unloading a module with unresolved externals removes its references from
+   * the unresolved table.
+   */
+  printf("load and unload a module with unresolved externals\n");
+
+  if (load(0, &time))
+    return 1;
+  if (unresolved(0) != 1)
+  {
+    printf("module 0 has no unresolved externals\n");
+    return 1;
+  }
+  if (unload(0))
+    return 1;
+
+  printf("load dependents first\n");
+
+  if (dependents_first(&dependents_time))
+    return 1;
+
+  printf("load dependencies first\n");
+
+  if (dependencies_first(&dependencies_time))
+    return 1;
+
+  printf("<DlUnresolved modules=\"%d\" references=\"%d\">\n"
+         "  <DependentsFirst unit=\"us\">%" PRIu64 "</DependentsFirst>\n"
+         "  <DependenciesFirst unit=\"us\">%" PRIu64 "</DependenciesFirst>\n"
+         "</DlUnresolved>\n",
+         DL_MODS, REFERENCES,
+         dependents_time / 1000, dependencies_time / 1000);
+
+  return 0;
+}
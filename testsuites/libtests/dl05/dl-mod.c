@@ -0,0 +1,57 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+/*
+ * Built once per module with DL_MOD set to the module number and DL_MOD_NEXT
+ * set to the next module's number. The last module has no next module.
+ */
+
+#include "dl-mod.h"
+
+#if defined(DL_MOD_NEXT)
+
+#define DL_DECLARE(f) int DL_FUNC_NAME(DL_MOD_NEXT, f)(int v);
+DL_FUNC_LIST(DL_DECLARE)
+
+#define DL_DEFINE(f) \
+  int DL_FUNC_NAME(DL_MOD, f)(int v) \
+  { \
+    return DL_FUNC_NAME(DL_MOD_NEXT, f)(v) + 1; \
+  }
+DL_FUNC_LIST(DL_DEFINE)
+
+#define DL_ENTRY(f) DL_FUNC_NAME(DL_MOD_NEXT, f),
+const dl_func_t DL_NAME(DL_MOD, table)[DL_FUNCS] =
+{
+  DL_FUNC_LIST(DL_ENTRY)
+};
+
+#else
+
+#define DL_DEFINE(f) \
+  int DL_FUNC_NAME(DL_MOD, f)(int v) \
+  { \
+    return v; \
+  }
+DL_FUNC_LIST(DL_DEFINE)
+
+#endif
+
+int DL_NAME(DL_MOD, entry)(void)
+{
+  int total = 0;
+#if defined(DL_MOD_NEXT)
+  int f;
+#define DL_CALL(f) total += DL_FUNC_NAME(DL_MOD, f)(0);
+  DL_FUNC_LIST(DL_CALL)
+  for (f = 0; f < DL_FUNCS; ++f)
+    total += DL_NAME(DL_MOD, table)[f](1);
+#endif
+  return total;
+}
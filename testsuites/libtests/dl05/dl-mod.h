@@ -0,0 +1,46 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#if !defined(_DL_MOD_H_)
+#define _DL_MOD_H_
+
+/*
+ * The modules form a chain. Each function in a module calls the function of
+ * the same number in the next module and each module has a table of pointers
+ * to the next module's functions. Every call and table entry is a reference to
+ * a symbol in another module.
+ */
+#define DL_MODS  8
+#define DL_FUNCS 64
+
+#define DL_FUNC_LIST(X) \
+  X(0)  X(1)  X(2)  X(3)  X(4)  X(5)  X(6)  X(7)  \
+  X(8)  X(9)  X(10) X(11) X(12) X(13) X(14) X(15) \
+  X(16) X(17) X(18) X(19) X(20) X(21) X(22) X(23) \
+  X(24) X(25) X(26) X(27) X(28) X(29) X(30) X(31) \
+  X(32) X(33) X(34) X(35) X(36) X(37) X(38) X(39) \
+  X(40) X(41) X(42) X(43) X(44) X(45) X(46) X(47) \
+  X(48) X(49) X(50) X(51) X(52) X(53) X(54) X(55) \
+  X(56) X(57) X(58) X(59) X(60) X(61) X(62) X(63)
+
+#define DL_NAME_(m, n) dl_m ## m ## _ ## n
+#define DL_NAME(m, n) DL_NAME_(m, n)
+
+#define DL_FUNC_NAME_(m, f) dl_m ## m ## _f ## f
+#define DL_FUNC_NAME(m, f) DL_FUNC_NAME_(m, f)
+
+typedef int (*dl_func_t)(int v);
+typedef int (*dl_entry_t)(void);
+
+/*
+ * The value the entry point of the first module returns.
+ */
+#define DL_ENTRY_RESULT (2 * DL_FUNCS * (DL_MODS - 1))
+
+#endif
@@ -0,0 +1,355 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "tmacros.h"
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtems/rtl/rtl.h>
+#include <rtems/rtl/rtl-obj-cache.h>
+#include <rtems/rtl/rtl-obj-comp.h>
+
+const char rtems_test_name[] = "libdl (RTL) 6";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+/*
+ * The FastLZ compressor is part of libdl.
+ */
+int fastlz_compress(const void* input, int length, void* output);
+
+/*
+ * The size of the decompressed data, a typical large module.
+ */
+#define DATA_SIZE (256 * 1024)
+
+/*
+ * The compressed stream block size matches the linker's decompressor output
+ * buffer.
+ */
+#define BLOCK_SIZE 2048
+
+#define CACHE_SIZE (2 * BLOCK_SIZE)
+
+#define LZ4_HASH_LOG 12
+
+typedef struct {
+  const char *name;
+  const char *file;
+  int compression;
+} codec;
+
+static const codec codecs[] = {
+  { "None", "/comp-none", RTEMS_RTL_COMP_NONE },
+  { "LZ77", "/comp-lz77", RTEMS_RTL_COMP_LZ77 },
+  { "LZ4", "/comp-lz4", RTEMS_RTL_COMP_LZ4 }
+};
+
+typedef struct {
+  uint8_t *data;
+  uint8_t *out;
+  uint8_t block[2 * BLOCK_SIZE];
+  uint16_t lz4_table[1 << LZ4_HASH_LOG];
+  rtems_rtl_obj_cache_t cache;
+  rtems_rtl_obj_comp_t comp;
+} test_context;
+
+static test_context test_instance;
+
+/*
+ * Fill the data with words that look like machine code, a small set of
+ * opcodes with varying operands.
+ */
+static void build_data(test_context *ctx)
+{
+  static const uint32_t opcodes[] = {
+    0xe5900000, 0xe5800000, 0xe2800000, 0xe1a00000,
+    0xeb000000, 0xe3500000, 0x1a000000, 0xe12fff1e
+  };
+  uint32_t seed = 12345;
+  size_t i;
+
+  ctx->data = malloc(DATA_SIZE);
+  ctx->out = malloc(DATA_SIZE);
+  rtems_test_assert(ctx->data != NULL && ctx->out != NULL);
+
+  for (i = 0; i < DATA_SIZE; i += sizeof(uint32_t)) {
+    uint32_t word;
+
+    seed = seed * 1103515245 + 12345;
+    word = opcodes[(seed >> 16) & 7] | ((seed >> 8) & 0x3f);
+    memcpy(&ctx->data[i], &word, sizeof(word));
+  }
+}
+
+static uint32_t read32(const uint8_t *p)
+{
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static uint8_t *lz4_length(uint8_t *op, size_t length)
+{
+  length -= 15;
+  while (length >= 255) {
+    *op++ = 255;
+    length -= 255;
+  }
+  *op++ = (uint8_t) length;
+  return op;
+}
+
+static uint8_t *lz4_sequence(
+  uint8_t *op,
+  const uint8_t *literals,
+  size_t nliterals,
+  size_t offset,
+  size_t match
+)
+{
+  uint8_t *token = op++;
+
+  *token = (uint8_t) ((nliterals < 15 ? nliterals : 15) << 4);
+  if (nliterals >= 15) {
+    op = lz4_length(op, nliterals);
+  }
+  memcpy(op, literals, nliterals);
+  op += nliterals;
+
+  if (match != 0) {
+    match -= 4;
+    *op++ = (uint8_t) offset;
+    *op++ = (uint8_t) (offset >> 8);
+    *token |= match < 15 ? match : 15;
+    if (match >= 15) {
+      op = lz4_length(op, match);
+    }
+  }
+
+  return op;
+}
+
+/*
+ * A greedy LZ4 block compressor as a host tool uses. The last 5 bytes are
+ * always literals and a match does not start in the last 12 bytes.
+ */
+static size_t lz4_compress(
+  test_context *ctx,
+  const uint8_t *in,
+  size_t length,
+  uint8_t *out
+)
+{
+  uint8_t *op = out;
+  size_t anchor = 0;
+  size_t i = 0;
+
+  memset(ctx->lz4_table, 0, sizeof(ctx->lz4_table));
+
+  while (i + 12 <= length) {
+    uint32_t seq = read32(&in[i]);
+    uint32_t h = (seq * 2654435761U) >> (32 - LZ4_HASH_LOG);
+    size_t ref = ctx->lz4_table[h];
+
+    ctx->lz4_table[h] = (uint16_t) (i + 1);
+
+    if (ref != 0 && read32(&in[ref - 1]) == seq) {
+      size_t match = 4;
+
+      --ref;
+      while (i + match < length - 5 && in[ref + match] == in[i + match]) {
+        ++match;
+      }
+
+      op = lz4_sequence(op, &in[anchor], i - anchor, i - ref, match);
+      i += match;
+      anchor = i;
+    } else {
+      ++i;
+    }
+  }
+
+  op = lz4_sequence(op, &in[anchor], length - anchor, 0, 0);
+
+  return (size_t) (op - out);
+}
+
+static size_t write_stream(test_context *ctx, const codec *c)
+{
+  size_t total = 0;
+  size_t i;
+  int fd;
+
+  fd = open(c->file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  rtems_test_assert(fd >= 0);
+
+  for (i = 0; i < DATA_SIZE; i += BLOCK_SIZE) {
+    uint8_t header[2];
+    size_t size;
+
+    switch (c->compression) {
+      case RTEMS_RTL_COMP_LZ77:
+        size = fastlz_compress(&ctx->data[i], BLOCK_SIZE, ctx->block);
+        break;
+      case RTEMS_RTL_COMP_LZ4:
+        size = lz4_compress(ctx, &ctx->data[i], BLOCK_SIZE, ctx->block);
+        break;
+      default:
+        memcpy(ctx->block, &ctx->data[i], BLOCK_SIZE);
+        size = BLOCK_SIZE;
+        break;
+    }
+
+    rtems_test_assert(size > 0 && size <= sizeof(ctx->block));
+
+    header[0] = (uint8_t) (size >> 8);
+    header[1] = (uint8_t) size;
+
+    rtems_test_assert(write(fd, header, sizeof(header)) == sizeof(header));
+    rtems_test_assert(write(fd, ctx->block, size) == (ssize_t) size);
+
+    total += sizeof(header) + size;
+  }
+
+  rtems_test_assert(close(fd) == 0);
+
+  return total;
+}
+
+static uint64_t read_stream(test_context *ctx, const codec *c, size_t chunk)
+{
+  uint64_t t0;
+  uint64_t t1;
+  size_t i;
+  bool ok;
+  int fd;
+
+  memset(ctx->out, 0, DATA_SIZE);
+
+  fd = open(c->file, O_RDONLY);
+  rtems_test_assert(fd >= 0);
+
+  rtems_rtl_obj_comp_set(&ctx->comp, &ctx->cache, fd, c->compression, 0);
+
+  t0 = rtems_clock_get_uptime_nanoseconds();
+
+  for (i = 0; i < DATA_SIZE; i += chunk) {
+    ok = rtems_rtl_obj_comp_read(&ctx->comp, &ctx->out[i], chunk);
+    rtems_test_assert(ok);
+  }
+
+  t1 = rtems_clock_get_uptime_nanoseconds();
+
+  rtems_rtl_obj_cache_flush(&ctx->cache);
+  rtems_test_assert(close(fd) == 0);
+
+  rtems_test_assert(memcmp(ctx->data, ctx->out, DATA_SIZE) == 0);
+
+  if (t1 == t0) {
+    t1 = t0 + 1;
+  }
+
+  /* MB/s */
+  return ((uint64_t) DATA_SIZE * 1000) / (t1 - t0);
+}
+
+static void test(void)
+{
+  test_context *ctx = &test_instance;
+  size_t i;
+
+  build_data(ctx);
+
+  /* Create the run-time linker */
+  rtems_test_assert(rtems_rtl_lock() != NULL);
+  rtems_rtl_unlock();
+
+  rtems_test_assert(rtems_rtl_obj_cache_open(&ctx->cache, CACHE_SIZE));
+  rtems_test_assert(rtems_rtl_obj_comp_open(&ctx->comp, BLOCK_SIZE));
+
+  printf("<DlDecompress size=\"%d\">\n", DATA_SIZE);
+
+  for (i = 0; i < RTEMS_ARRAY_SIZE(codecs); ++i) {
+    const codec *c = &codecs[i];
+    size_t compressed;
+    uint64_t word_rate;
+    uint64_t section_rate;
+
+    compressed = write_stream(ctx, c);
+
+    /*
+     * Word reads are how the loader reads headers and relocation records. A
+     * section read is a single read of the section size and decompresses
+     * straight into the section's memory.
+     */
+    word_rate = read_stream(ctx, c, sizeof(uint32_t));
+    section_rate = read_stream(ctx, c, DATA_SIZE);
+
+    printf(
+      "  <%s compressed=\"%zu\">\n"
+      "    <WordRead unit=\"MB/s\">%" PRIu64 "</WordRead>\n"
+      "    <SectionRead unit=\"MB/s\">%" PRIu64 "</SectionRead>\n"
+      "  </%s>\n",
+      c->name,
+      compressed,
+      word_rate,
+      section_rate,
+      c->name
+    );
+
+    rtems_test_assert(unlink(c->file) == 0);
+  }
+
+  printf("</DlDecompress>\n");
+
+  rtems_rtl_obj_comp_close(&ctx->comp);
+  rtems_rtl_obj_cache_close(&ctx->cache);
+}
+
+static void Init(rtems_task_argument arg)
+{
+  TEST_BEGIN();
+
+  test();
+
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS 4
+
+#define CONFIGURE_MAXIMUM_TASKS 1
+#define CONFIGURE_MAXIMUM_SEMAPHORES 1
+
+#define CONFIGURE_UNIFIED_WORK_AREAS
+
+#define CONFIGURE_MINIMUM_TASK_STACK_SIZE (8U * 1024U)
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#define CONFIGURE_INIT
+
+#include <rtems/confdefs.h>
@@ -0,0 +1,340 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "tmacros.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <rtems/libio_.h>
+
+const char rtems_test_name[] = "FDTABLE 1";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+#define CPU_COUNT 32
+
+#define FD_COUNT 64
+
+#define FILE_NAME "/file"
+
+typedef struct {
+  rtems_id done;
+  volatile bool stop;
+  uint32_t counts[CPU_COUNT];
+  int fds[FD_COUNT];
+} test_context;
+
+static test_context test_instance;
+
+static int open_file(void)
+{
+  int fd = open(FILE_NAME, O_RDWR);
+
+  rtems_test_assert(fd >= 0);
+
+  return fd;
+}
+
+static void close_file(int fd)
+{
+  int rv = close(fd);
+
+  rtems_test_assert(rv == 0);
+}
+
+static void check_lowest(void)
+{
+  int a;
+  int b;
+  int c;
+  int fd;
+
+  printf("check lowest free file descriptor\n");
+
+  a = open_file();
+  b = open_file();
+  c = open_file();
+  rtems_test_assert(a < b && b < c);
+
+  close_file(b);
+  fd = open_file();
+  rtems_test_assert(fd == b);
+
+  close_file(a);
+  close_file(b);
+  close_file(c);
+}
+
+static void check_held_close(void)
+{
+  rtems_libio_t *iop;
+  char buf[1];
+  ssize_t n;
+  int fd;
+  int other;
+
+  printf("check close of a held file descriptor\n");
+
+  fd = open_file();
+  iop = rtems_libio_iop(fd);
+  rtems_test_assert(rtems_libio_iop_hold(iop));
+
+  close_file(fd);
+
+  errno = 0;
+  n = read(fd, buf, sizeof(buf));
+  rtems_test_assert(n == -1);
+  rtems_test_assert(errno == EBADF);
+
+  errno = 0;
+  rtems_test_assert(close(fd) == -1);
+  rtems_test_assert(errno == EBADF);
+
+  /* The descriptor is still held and must not be reused */
+  other = open_file();
+  rtems_test_assert(other != fd);
+
+  rtems_libio_iop_drop(iop);
+
+  rtems_test_assert(open_file() == fd);
+
+  close_file(fd);
+  close_file(other);
+}
+
+static void check_held_pipe_close(void)
+{
+  rtems_libio_t *iop;
+  char buf[1];
+  ssize_t n;
+  int fds[2];
+  int rv;
+
+  printf("check deferred close of a held pipe\n");
+
+  rv = pipe(fds);
+  rtems_test_assert(rv == 0);
+
+  rv = fcntl(fds[0], F_SETFL, O_NONBLOCK);
+  rtems_test_assert(rv == 0);
+
+  iop = rtems_libio_iop(fds[1]);
+  rtems_test_assert(rtems_libio_iop_hold(iop));
+
+  close_file(fds[1]);
+
+  /* The write end stays open until the last reference is dropped */
+  errno = 0;
+  n = read(fds[0], buf, sizeof(buf));
+  rtems_test_assert(n == -1);
+  rtems_test_assert(errno == EAGAIN);
+
+  rtems_libio_iop_drop(iop);
+
+  n = read(fds[0], buf, sizeof(buf));
+  rtems_test_assert(n == 0);
+
+  close_file(fds[0]);
+}
+
+static void check_exhaustion(test_context *ctx)
+{
+  size_t n = 0;
+  size_t i;
+  int fd;
+
+  printf("check file descriptor exhaustion\n");
+
+  while (true) {
+    fd = open(FILE_NAME, O_RDWR);
+    if (fd < 0) {
+      break;
+    }
+
+    rtems_test_assert(n < FD_COUNT);
+    ctx->fds[n] = fd;
+    ++n;
+  }
+
+  rtems_test_assert(errno == ENFILE);
+  rtems_test_assert(n > 0);
+
+  for (i = 0; i < n; ++i) {
+    close_file(ctx->fds[i]);
+  }
+
+  for (i = 0; i < n; ++i) {
+    rtems_test_assert(open_file() == ctx->fds[i]);
+  }
+
+  for (i = 0; i < n; ++i) {
+    close_file(ctx->fds[i]);
+  }
+}
+
+static void worker(rtems_task_argument arg)
+{
+  test_context *ctx = &test_instance;
+
+  while (true) {
+    rtems_event_set events;
+    rtems_status_code sc;
+    uint32_t count = 0;
+
+    sc = rtems_event_receive(
+      RTEMS_EVENT_0,
+      RTEMS_EVENT_ALL | RTEMS_WAIT,
+      RTEMS_NO_TIMEOUT,
+      &events
+    );
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+    while (!ctx->stop) {
+      close_file(open_file());
+      ++count;
+    }
+
+    ctx->counts[arg] = count;
+
+    sc = rtems_semaphore_release(ctx->done);
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  }
+}
+
+static void measure(test_context *ctx, rtems_id *ids, uint32_t task_count)
+{
+  rtems_status_code sc;
+  uint64_t total = 0;
+  uint32_t i;
+
+  ctx->stop = false;
+
+  for (i = 0; i < task_count; ++i) {
+    sc = rtems_event_send(ids[i], RTEMS_EVENT_0);
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  }
+
+  sc = rtems_task_wake_after(rtems_clock_get_ticks_per_second());
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  ctx->stop = true;
+
+  for (i = 0; i < task_count; ++i) {
+    sc = rtems_semaphore_obtain(ctx->done, RTEMS_WAIT, RTEMS_NO_TIMEOUT);
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+    total += ctx->counts[i];
+  }
+
+  printf(
+    "  <OpenClose tasks=\"%" PRIu32 "\" unit=\"1/s\">%" PRIu64 "</OpenClose>\n",
+    task_count,
+    total
+  );
+}
+
+static void test(void)
+{
+  test_context *ctx = &test_instance;
+  rtems_id ids[CPU_COUNT];
+  rtems_status_code sc;
+  uint32_t cpu_count;
+  uint32_t i;
+  int fd;
+
+  fd = open(FILE_NAME, O_RDWR | O_CREAT, S_IRWXU);
+  rtems_test_assert(fd >= 0);
+  close_file(fd);
+
+  check_lowest();
+  check_held_close();
+  check_held_pipe_close();
+  check_exhaustion(ctx);
+
+  sc = rtems_semaphore_create(
+    rtems_build_name('D', 'O', 'N', 'E'),
+    0,
+    RTEMS_COUNTING_SEMAPHORE,
+    0,
+    &ctx->done
+  );
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  cpu_count = rtems_get_processor_count();
+  if (cpu_count > CPU_COUNT) {
+    cpu_count = CPU_COUNT;
+  }
+
+  for (i = 0; i < cpu_count; ++i) {
+    sc = rtems_task_create(
+      rtems_build_name('W', 'O', 'R', 'K'),
+      2,
+      RTEMS_MINIMUM_STACK_SIZE,
+      RTEMS_DEFAULT_MODES | RTEMS_TIMESLICE,
+      RTEMS_DEFAULT_ATTRIBUTES,
+      &ids[i]
+    );
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+    sc = rtems_task_start(ids[i], worker, i);
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  }
+
+  printf("<FileDescriptorTable>\n");
+
+  for (i = 1; i <= cpu_count; ++i) {
+    measure(ctx, ids, i);
+  }
+
+  printf("</FileDescriptorTable>\n");
+}
+
+static void Init(rtems_task_argument arg)
+{
+  TEST_BEGIN();
+
+  test();
+
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS FD_COUNT
+
+#define CONFIGURE_MAXIMUM_TASKS (1 + CPU_COUNT)
+#define CONFIGURE_MAXIMUM_SEMAPHORES 1
+
+#define CONFIGURE_MAXIMUM_PIPES 1
+
+#define CONFIGURE_SMP_APPLICATION
+
+#define CONFIGURE_SMP_MAXIMUM_PROCESSORS CPU_COUNT
+
+#define CONFIGURE_UNIFIED_WORK_AREAS
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#define CONFIGURE_INIT
+
+#include <rtems/confdefs.h>
@@ -0,0 +1,294 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rtems.h>
+#include <rtems/rtems_bsdnet.h>
+#include <tmacros.h>
+
+/*
+ * Include the kernel network headers last, they redefine malloc() and free().
+ */
+#define _KERNEL
+#include <sys/mbuf.h>
+#include <net/route.h>
+#include <netinet/in_var.h>
+
+const char rtems_test_name[] = "FIB 1";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+struct rtems_bsdnet_config rtems_bsdnet_config;
+
+/* The synthetic table has NET16_COUNT /16 and NET24_COUNT /24 routes */
+#define NET16_COUNT 80
+
+#define NET24_COUNT 20000
+
+/* Every NET24_DELETE /24 route is deleted by the update test */
+#define NET24_DELETE 7
+
+#define DESTINATIONS 4096
+
+#define ITERATIONS 64
+
+typedef struct {
+  struct sockaddr_in dst[DESTINATIONS];
+  struct radix_node_head *rnh;
+} test_context;
+
+static test_context test_instance;
+
+typedef struct radix_node *(*lookup_method)(void *, struct radix_node_head *);
+
+static void set_sin(struct sockaddr_in *sin, uint32_t addr)
+{
+  memset(sin, 0, sizeof(*sin));
+  sin->sin_len = sizeof(*sin);
+  sin->sin_family = AF_INET;
+  sin->sin_addr.s_addr = htonl(addr);
+}
+
+static uint32_t net24(int i)
+{
+  return (UINT32_C(10) << 24) + ((uint32_t) i << 8);
+}
+
+static void route_request(int req, uint32_t net, int len)
+{
+  struct sockaddr_in dst;
+  struct sockaddr_in gw;
+  struct sockaddr_in mask;
+  int rv;
+
+  set_sin(&dst, net);
+  set_sin(&gw, INADDR_LOOPBACK);
+  set_sin(&mask, ~UINT32_C(0) << (32 - len));
+
+  rv = rtems_bsdnet_rtrequest(
+    req,
+    (struct sockaddr *) &dst,
+    (struct sockaddr *) &gw,
+    (struct sockaddr *) &mask,
+    RTF_UP | RTF_GATEWAY | RTF_STATIC,
+    NULL
+  );
+  rtems_test_assert(rv == 0);
+}
+
+static void wait_for_rebuild(void)
+{
+  rtems_status_code sc;
+
+  /* The table is rebuilt by the network daemon one tick after a change */
+  sc = rtems_task_wake_after(2);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  /* Wait until the network daemon is done */
+  rtems_bsdnet_semaphore_obtain();
+  rtems_bsdnet_semaphore_release();
+}
+
+static struct radix_node *radix_lookup(test_context *ctx, void *dst)
+{
+  struct radix_node *rn = rn_match(dst, ctx->rnh);
+
+  if (rn != NULL && (rn->rn_flags & RNF_ROOT) != 0) {
+    rn = NULL;
+  }
+
+  return rn;
+}
+
+static void check_lookups(test_context *ctx)
+{
+  u_long fallbacks;
+  int i;
+
+  rtems_bsdnet_semaphore_obtain();
+
+  fallbacks = in_fibstat.fs_fallbacks;
+
+  for (i = 0; i < DESTINATIONS; ++i) {
+    rtems_test_assert(
+      in_fib_match(&ctx->dst[i], ctx->rnh) == radix_lookup(ctx, &ctx->dst[i])
+    );
+  }
+
+  rtems_test_assert(in_fibstat.fs_fallbacks == fallbacks);
+
+  rtems_bsdnet_semaphore_release();
+}
+
+static void add_routes(void)
+{
+  int i;
+
+  puts("add routes");
+
+  for (i = 0; i < NET16_COUNT; ++i) {
+    route_request(RTM_ADD, (UINT32_C(10) << 24) + ((uint32_t) i << 16), 16);
+  }
+
+  for (i = 0; i < NET24_COUNT; ++i) {
+    route_request(RTM_ADD, net24(i), 24);
+  }
+
+  wait_for_rebuild();
+
+  rtems_test_assert(
+    in_fibstat.fs_prefixes >= NET16_COUNT + NET24_COUNT
+  );
+}
+
+static void delete_routes(void)
+{
+  u_long rebuilds = in_fibstat.fs_rebuilds;
+  int i;
+
+  puts("delete routes");
+
+  for (i = 0; i < NET24_COUNT; i += NET24_DELETE) {
+    route_request(RTM_DELETE, net24(i), 24);
+  }
+
+  wait_for_rebuild();
+
+  /* The whole batch of changes needs one rebuild */
+  rtems_test_assert(in_fibstat.fs_rebuilds == rebuilds + 1);
+}
+
+static void init_destinations(test_context *ctx)
+{
+  int i;
+
+  srand(1);
+
+  for (i = 0; i < DESTINATIONS; ++i) {
+    uint32_t addr;
+
+    if (i % 8 == 0) {
+      /* Outside of the synthetic table */
+      addr = (UINT32_C(11) << 24) + (uint32_t) rand();
+    } else {
+      addr = net24(rand() % (NET16_COUNT << 8)) + (uint32_t) (rand() % 256);
+    }
+
+    set_sin(&ctx->dst[i], addr);
+  }
+}
+
+static void measure(
+  test_context *ctx,
+  const char *name,
+  lookup_method lookup
+)
+{
+  uint64_t t0;
+  uint64_t t1;
+  uint64_t lookups = (uint64_t) ITERATIONS * DESTINATIONS;
+  int i;
+  int j;
+
+  rtems_bsdnet_semaphore_obtain();
+
+  t0 = rtems_clock_get_uptime_nanoseconds();
+
+  for (i = 0; i < ITERATIONS; ++i) {
+    for (j = 0; j < DESTINATIONS; ++j) {
+      (void) (*lookup)(&ctx->dst[j], ctx->rnh);
+    }
+  }
+
+  t1 = rtems_clock_get_uptime_nanoseconds();
+
+  rtems_bsdnet_semaphore_release();
+
+  if (t1 == t0) {
+    t1 = t0 + 1;
+  }
+
+  printf(
+    "  <%s unit=\"lookups/s\">%" PRIu64 "</%s>\n",
+    name,
+    (lookups * 1000000000) / (t1 - t0),
+    name
+  );
+}
+
+static void test(void)
+{
+  test_context *ctx = &test_instance;
+  int rv;
+
+  rv = rtems_bsdnet_initialize_network();
+  rtems_test_assert(rv == 0);
+
+  ctx->rnh = rt_tables[AF_INET];
+  init_destinations(ctx);
+
+  add_routes();
+  check_lookups(ctx);
+  delete_routes();
+  check_lookups(ctx);
+
+  printf(
+    "<RouteLookup>\n"
+    "  <Routes>%lu</Routes>\n"
+    "  <Ranges>%lu</Ranges>\n",
+    in_fibstat.fs_prefixes,
+    in_fibstat.fs_ranges
+  );
+  measure(ctx, "Radix", rn_match);
+  measure(ctx, "Fib", in_fib_match);
+  puts("</RouteLookup>");
+}
+
+static rtems_task Init(rtems_task_argument argument)
+{
+  TEST_BEGIN();
+  test();
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_INIT
+
+#define CONFIGURE_MICROSECONDS_PER_TICK 10000
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS 8
+
+#define CONFIGURE_UNLIMITED_OBJECTS
+
+#define CONFIGURE_UNIFIED_WORK_AREAS
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_INIT_TASK_STACK_SIZE (16 * 1024)
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#include <rtems/confdefs.h>
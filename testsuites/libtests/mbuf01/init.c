@@ -0,0 +1,257 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rtems.h>
+#include <rtems/rtems_bsdnet.h>
+#include <tmacros.h>
+
+/*
+ * Include the kernel mbuf header last, the network stack headers redefine
+ * malloc() and free().
+ */
+#define _KERNEL
+#include <sys/mbuf.h>
+
+const char rtems_test_name[] = "MBUF 1";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+#define JUMBO_COUNT 4
+
+struct rtems_bsdnet_config rtems_bsdnet_config = {
+  .mbuf_bytecount = 64 * 1024,
+  .mbuf_cluster_bytecount = 128 * 1024,
+  .mbuf_jumbo_cluster_bytecount = JUMBO_COUNT * MJUM9BYTES
+};
+
+static union mcluster *clusters;
+
+/*
+ * The caller owns the network semaphore in the following functions, so the
+ * network tasks cannot change the pools.
+ */
+
+static void test_mbuf_pool(void)
+{
+  struct mbuf *chain = NULL;
+  struct mbuf *m;
+  u_long drops = mbstat.m_drops;
+  u_short free_count = mbstat.m_mtypes[MT_FREE];
+  u_short count = 0;
+
+  puts("mbuf pool");
+
+  rtems_test_assert(free_count > 0);
+  rtems_test_assert(free_count <= mbstat.m_mbufs);
+
+  while (true) {
+    MGET(m, M_DONTWAIT, MT_DATA);
+    if (m == NULL) {
+      break;
+    }
+
+    m->m_next = chain;
+    chain = m;
+    ++count;
+  }
+
+  rtems_test_assert(count == free_count);
+  rtems_test_assert(mbstat.m_mtypes[MT_FREE] == 0);
+  rtems_test_assert(mbstat.m_drops == drops + 1);
+  rtems_test_assert(mbstat.m_mbhiwat == mbstat.m_mbufs);
+
+  m_freem(chain);
+  rtems_test_assert(mbstat.m_mtypes[MT_FREE] == free_count);
+
+  MGET(m, M_DONTWAIT, MT_DATA);
+  rtems_test_assert(m != NULL);
+  m_freem(m);
+}
+
+static void test_cluster_pool(void)
+{
+  caddr_t p;
+  u_long drops = mbstat.m_drops;
+  u_long free_count = mbstat.m_clfree;
+  u_long count = 0;
+
+  puts("cluster pool");
+
+  rtems_test_assert(free_count > 0);
+  rtems_test_assert(free_count <= mbstat.m_clusters);
+
+  while (true) {
+    MCLALLOC(p, M_DONTWAIT);
+    if (p == NULL) {
+      break;
+    }
+
+    rtems_test_assert(mclrefcnt[mtocl(p)] == 1);
+    memset(p, 0xa5, MCLBYTES);
+    ((union mcluster *) p)->mcl_next = clusters;
+    clusters = (union mcluster *) p;
+    ++count;
+  }
+
+  rtems_test_assert(count == free_count);
+  rtems_test_assert(mbstat.m_clfree == 0);
+  rtems_test_assert(mbstat.m_drops == drops);
+  rtems_test_assert(mbstat.m_clhiwat == mbstat.m_clusters);
+
+  while (clusters != NULL) {
+    p = (caddr_t) clusters;
+    clusters = clusters->mcl_next;
+    MCLFREE(p);
+  }
+
+  rtems_test_assert(mbstat.m_clfree == free_count);
+}
+
+static void test_jumbo_cluster_pool(void)
+{
+  struct mbuf *jumbo[JUMBO_COUNT];
+  struct mbuf *m;
+  struct mbuf *copy;
+  u_long drops = mbstat.m_drops;
+  size_t i;
+
+  puts("jumbo cluster pool");
+
+  rtems_test_assert(nmbjumbo9 == JUMBO_COUNT);
+  rtems_test_assert(mbstat.m_jclusters == JUMBO_COUNT);
+  rtems_test_assert(mbstat.m_jclfree == JUMBO_COUNT);
+  rtems_test_assert(mbstat.m_jclhiwat == 0);
+
+  for (i = 0; i < JUMBO_COUNT; ++i) {
+    m = m_getjcl(M_DONTWAIT, MT_DATA, M_PKTHDR, MJUM9BYTES);
+    rtems_test_assert(m != NULL);
+    rtems_test_assert((m->m_flags & (M_PKTHDR | M_EXT)) == (M_PKTHDR | M_EXT));
+    rtems_test_assert(m->m_ext.ext_size == MJUM9BYTES);
+    rtems_test_assert(m->m_data == m->m_ext.ext_buf);
+
+    /* The clusters must not overlap */
+    memset(mtod(m, char *), (int) i, MJUM9BYTES);
+    m->m_len = MJUM9BYTES;
+    m->m_pkthdr.len = MJUM9BYTES;
+    jumbo[i] = m;
+  }
+
+  rtems_test_assert(mbstat.m_jclfree == 0);
+  rtems_test_assert(mbstat.m_jclhiwat == JUMBO_COUNT);
+
+  m = m_getjcl(M_DONTWAIT, MT_DATA, M_PKTHDR, MJUM9BYTES);
+  rtems_test_assert(m == NULL);
+  rtems_test_assert(mbstat.m_drops == drops + 1);
+
+  for (i = 0; i < JUMBO_COUNT; ++i) {
+    const char *p = mtod(jumbo[i], const char *);
+    size_t j;
+
+    for (j = 0; j < MJUM9BYTES; ++j) {
+      rtems_test_assert(p[j] == (char) i);
+    }
+  }
+
+  /* A copy references the jumbo cluster of the original */
+  copy = m_copym(jumbo[0], 0, M_COPYALL, M_DONTWAIT);
+  rtems_test_assert(copy != NULL);
+  rtems_test_assert(copy->m_data == jumbo[0]->m_data);
+
+  m_freem(jumbo[0]);
+  rtems_test_assert(mbstat.m_jclfree == 0);
+
+  m_freem(copy);
+  rtems_test_assert(mbstat.m_jclfree == 1);
+
+  for (i = 1; i < JUMBO_COUNT; ++i) {
+    m_freem(jumbo[i]);
+  }
+
+  rtems_test_assert(mbstat.m_jclfree == JUMBO_COUNT);
+  rtems_test_assert(mbstat.m_jclhiwat == JUMBO_COUNT);
+
+  /* The pool is usable again */
+  m = m_getjcl(M_DONTWAIT, MT_DATA, 0, MJUM9BYTES);
+  rtems_test_assert(m != NULL);
+  rtems_test_assert((m->m_flags & (M_PKTHDR | M_EXT)) == M_EXT);
+  m_freem(m);
+  rtems_test_assert(mbstat.m_jclfree == JUMBO_COUNT);
+}
+
+static void test_jumbo_cluster_sizes(void)
+{
+  struct mbuf *m;
+  u_long cl_free = mbstat.m_clfree;
+
+  puts("jumbo cluster sizes");
+
+  m = m_getjcl(M_DONTWAIT, MT_DATA, M_PKTHDR, MCLBYTES);
+  rtems_test_assert(m != NULL);
+  rtems_test_assert((m->m_flags & M_EXT) != 0);
+  rtems_test_assert(m->m_ext.ext_size == MCLBYTES);
+  rtems_test_assert(mbstat.m_clfree == cl_free - 1);
+  rtems_test_assert(mbstat.m_jclfree == JUMBO_COUNT);
+  m_freem(m);
+  rtems_test_assert(mbstat.m_clfree == cl_free);
+
+  m = m_getjcl(M_DONTWAIT, MT_DATA, M_PKTHDR, 4096);
+  rtems_test_assert(m == NULL);
+  rtems_test_assert(mbstat.m_clfree == cl_free);
+  rtems_test_assert(mbstat.m_jclfree == JUMBO_COUNT);
+}
+
+static void test(void)
+{
+  int rv;
+
+  rv = rtems_bsdnet_initialize_network();
+  rtems_test_assert(rv == 0);
+
+  rtems_bsdnet_semaphore_obtain();
+  test_mbuf_pool();
+  test_cluster_pool();
+  test_jumbo_cluster_pool();
+  test_jumbo_cluster_sizes();
+  rtems_bsdnet_semaphore_release();
+}
+
+static rtems_task Init(rtems_task_argument argument)
+{
+  TEST_BEGIN();
+  test();
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_INIT
+
+#define CONFIGURE_MICROSECONDS_PER_TICK 10000
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS 4
+
+#define CONFIGURE_MAXIMUM_TASKS 3
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#include <rtems/confdefs.h>
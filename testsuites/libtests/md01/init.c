@@ -0,0 +1,314 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "tmacros.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <md5.h>
+#include <sha256.h>
+#include <sha512.h>
+
+#include <rtems/counter.h>
+
+const char rtems_test_name[] = "MD 1";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+#define DATA_SIZE (16 * 1024)
+
+#define ITERATIONS 8
+
+#define LANES 2
+
+typedef struct {
+  unsigned char data[LANES][DATA_SIZE + 1];
+} test_context;
+
+static test_context test_instance;
+
+static void build_data(test_context *ctx)
+{
+  size_t i;
+  size_t j;
+
+  for (i = 0; i < LANES; ++i) {
+    for (j = 0; j < sizeof(ctx->data[i]); ++j) {
+      ctx->data[i][j] = (unsigned char) (j * 7 + (j >> 8) + i);
+    }
+  }
+}
+
+static void check_md5(void)
+{
+  static const unsigned char abc[MD5_DIGEST_LENGTH] = {
+    0x90, 0x01, 0x50, 0x98, 0x3c, 0xd2, 0x4f, 0xb0,
+    0xd6, 0x96, 0x3f, 0x7d, 0x28, 0xe1, 0x7f, 0x72
+  };
+  static const unsigned char million_a[MD5_DIGEST_LENGTH] = {
+    0x77, 0x07, 0xd6, 0xae, 0x4e, 0x02, 0x7c, 0x70,
+    0xee, 0xa2, 0xa9, 0x35, 0xc2, 0x29, 0x6f, 0x21
+  };
+  unsigned char a[1000];
+  unsigned char r[MD5_DIGEST_LENGTH];
+  MD5_CTX ctx;
+  int i;
+
+  MD5Init(&ctx);
+  MD5Update(&ctx, "abc", 3);
+  MD5Final(r, &ctx);
+  rtems_test_assert(memcmp(r, abc, sizeof(r)) == 0);
+
+  /* Unaligned pieces which straddle the block boundaries */
+  memset(a, 'a', sizeof(a));
+  MD5Init(&ctx);
+  for (i = 0; i < 1000; ++i) {
+    MD5Update(&ctx, &a[i % 3], 997);
+    MD5Update(&ctx, &a[i % 3], 3);
+  }
+  MD5Final(r, &ctx);
+  rtems_test_assert(memcmp(r, million_a, sizeof(r)) == 0);
+}
+
+/*
+ * Hashing several messages at once must give the same digests as hashing
+ * them one at a time, also if the lanes get out of step.
+ */
+static void check_multi(test_context *ctx)
+{
+  static const size_t lens[] = { 0, 1, 55, 64, 111, 128, 129, 1000 };
+  size_t i;
+
+  for (i = 0; i < RTEMS_ARRAY_SIZE(lens); ++i) {
+    SHA256_CTX sha256[LANES + 1];
+    SHA256_CTX *sha256p[LANES + 1];
+    SHA512_CTX sha512[LANES + 1];
+    SHA512_CTX *sha512p[LANES + 1];
+    const void *in[LANES + 1];
+    unsigned char r[64];
+    unsigned char e[64];
+    size_t len = lens[i];
+    size_t j;
+
+    for (j = 0; j < LANES + 1; ++j) {
+      sha256p[j] = &sha256[j];
+      sha512p[j] = &sha512[j];
+      SHA256_Init(sha256p[j]);
+      SHA512_Init(sha512p[j]);
+      in[j] = &ctx->data[j % LANES][j];
+    }
+
+    /* Put the last lane out of step with the others */
+    SHA256_Update(sha256p[LANES], "x", 1);
+    SHA512_Update(sha512p[LANES], "x", 1);
+
+    SHA256_UpdateMulti(sha256p, in, LANES + 1, len);
+    SHA512_UpdateMulti(sha512p, in, LANES + 1, len);
+
+    for (j = 0; j < LANES + 1; ++j) {
+      SHA256_CTX c256;
+      SHA512_CTX c512;
+
+      SHA256_Init(&c256);
+      SHA512_Init(&c512);
+
+      if (j == LANES) {
+        SHA256_Update(&c256, "x", 1);
+        SHA512_Update(&c512, "x", 1);
+      }
+
+      SHA256_Update(&c256, in[j], len);
+      SHA512_Update(&c512, in[j], len);
+
+      SHA256_Final(e, &c256);
+      SHA256_Final(r, sha256p[j]);
+      rtems_test_assert(memcmp(r, e, 32) == 0);
+
+      SHA512_Final(e, &c512);
+      SHA512_Final(r, sha512p[j]);
+      rtems_test_assert(memcmp(r, e, 64) == 0);
+    }
+  }
+}
+
+typedef void (*hash_func)(test_context *ctx, size_t offset);
+
+static void hash_md5(test_context *ctx, size_t offset)
+{
+  unsigned char r[MD5_DIGEST_LENGTH];
+  size_t i;
+
+  for (i = 0; i < LANES; ++i) {
+    MD5_CTX c;
+
+    MD5Init(&c);
+    MD5Update(&c, &ctx->data[i][offset], DATA_SIZE);
+    MD5Final(r, &c);
+  }
+}
+
+static void hash_sha256(test_context *ctx, size_t offset)
+{
+  unsigned char r[32];
+  size_t i;
+
+  for (i = 0; i < LANES; ++i) {
+    SHA256_CTX c;
+
+    SHA256_Init(&c);
+    SHA256_Update(&c, &ctx->data[i][offset], DATA_SIZE);
+    SHA256_Final(r, &c);
+  }
+}
+
+static void hash_sha256_multi(test_context *ctx, size_t offset)
+{
+  SHA256_CTX c[LANES];
+  SHA256_CTX *cp[LANES];
+  const void *in[LANES];
+  unsigned char r[32];
+  size_t i;
+
+  for (i = 0; i < LANES; ++i) {
+    cp[i] = &c[i];
+    in[i] = &ctx->data[i][offset];
+    SHA256_Init(cp[i]);
+  }
+
+  SHA256_UpdateMulti(cp, in, LANES, DATA_SIZE);
+
+  for (i = 0; i < LANES; ++i) {
+    SHA256_Final(r, cp[i]);
+  }
+}
+
+static void hash_sha512(test_context *ctx, size_t offset)
+{
+  unsigned char r[64];
+  size_t i;
+
+  for (i = 0; i < LANES; ++i) {
+    SHA512_CTX c;
+
+    SHA512_Init(&c);
+    SHA512_Update(&c, &ctx->data[i][offset], DATA_SIZE);
+    SHA512_Final(r, &c);
+  }
+}
+
+static void hash_sha512_multi(test_context *ctx, size_t offset)
+{
+  SHA512_CTX c[LANES];
+  SHA512_CTX *cp[LANES];
+  const void *in[LANES];
+  unsigned char r[64];
+  size_t i;
+
+  for (i = 0; i < LANES; ++i) {
+    cp[i] = &c[i];
+    in[i] = &ctx->data[i][offset];
+    SHA512_Init(cp[i]);
+  }
+
+  SHA512_UpdateMulti(cp, in, LANES, DATA_SIZE);
+
+  for (i = 0; i < LANES; ++i) {
+    SHA512_Final(r, cp[i]);
+  }
+}
+
+/*
+ * Report the CPU counter ticks per byte with two decimal places.  On most
+ * targets the CPU counter runs at the processor clock.
+ */
+static void measure(
+  test_context *ctx,
+  const char *label,
+  hash_func hash,
+  size_t offset
+)
+{
+  uint64_t ticks = 0;
+  uint64_t bytes = (uint64_t) ITERATIONS * LANES * DATA_SIZE;
+  uint64_t per_byte;
+  int i;
+
+  for (i = 0; i < ITERATIONS; ++i) {
+    rtems_counter_ticks t0;
+    rtems_counter_ticks t1;
+
+    t0 = rtems_counter_read();
+    (*hash)(ctx, offset);
+    t1 = rtems_counter_read();
+
+    ticks += rtems_counter_difference(t1, t0);
+  }
+
+  per_byte = (ticks * 100 + bytes / 2) / bytes;
+
+  printf(
+    "  <%s unit=\"cycles/byte\">%" PRIu64 ".%02" PRIu64 "</%s>\n",
+    label,
+    per_byte / 100,
+    per_byte % 100,
+    label
+  );
+}
+
+static void test(void)
+{
+  test_context *ctx = &test_instance;
+
+  build_data(ctx);
+
+  check_md5();
+  check_multi(ctx);
+
+  printf("<LibMD size=\"%d\" messages=\"%d\">\n", DATA_SIZE, LANES);
+  measure(ctx, "MD5", hash_md5, 0);
+  measure(ctx, "MD5Unaligned", hash_md5, 1);
+  measure(ctx, "SHA256", hash_sha256, 0);
+  measure(ctx, "SHA256Multi", hash_sha256_multi, 0);
+  measure(ctx, "SHA512", hash_sha512, 0);
+  measure(ctx, "SHA512Multi", hash_sha512_multi, 0);
+  printf("</LibMD>\n");
+}
+
+static void Init(rtems_task_argument arg)
+{
+  TEST_BEGIN();
+
+  test();
+
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_APPLICATION_DOES_NOT_NEED_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_MAXIMUM_TASKS 1
+
+#define CONFIGURE_MINIMUM_TASK_STACK_SIZE (8U * 1024U)
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#define CONFIGURE_INIT
+
+#include <rtems/confdefs.h>
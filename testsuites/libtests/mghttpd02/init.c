@@ -0,0 +1,399 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtems.h>
+#include <rtems/rtems_bsdnet.h>
+#include <mghttpd/mongoose.h>
+#include <tmacros.h>
+
+const char rtems_test_name[] = "MGHTTPD 2";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+struct rtems_bsdnet_config rtems_bsdnet_config = {
+  .mbuf_bytecount = 128 * 1024,
+  .mbuf_cluster_bytecount = 256 * 1024
+};
+
+#define PORT 8080
+
+#define FILE_PATH "/www/index.html"
+
+#define FILE_SIZE 1024
+
+#define LOAD_CLIENTS 4
+
+#define IDLE_CLIENTS 32
+
+#define SAMPLES_MAX 4096
+
+/* Below the network daemon priority */
+#define TASK_PRIORITY 110
+
+#define EVENT_START RTEMS_EVENT_0
+
+/* One event per load client, events are not counted */
+#define EVENT_DONE(i) (RTEMS_EVENT_1 << (i))
+
+#define REQUEST \
+  "GET /index.html HTTP/1.1\r\n" \
+  "Host: 127.0.0.1\r\n" \
+  "Connection: keep-alive\r\n" \
+  "\r\n"
+
+typedef struct {
+  const char *name;
+  const char *keep_alive_connections;
+  const char *static_file_cache_size;
+  int idle_clients;
+} test_scenario;
+
+typedef struct {
+  rtems_id task;
+  uint32_t requests;
+  uint32_t samples;
+  uint32_t latency_us[SAMPLES_MAX];
+  char buf[FILE_SIZE + 512];
+} test_client;
+
+typedef struct {
+  rtems_id init_task;
+  volatile bool stop;
+  int idle_sd[IDLE_CLIENTS];
+  test_client clients[LOAD_CLIENTS];
+  uint32_t all_samples[LOAD_CLIENTS * SAMPLES_MAX];
+} test_context;
+
+static test_context test_instance;
+
+static const test_scenario test_scenarios[] = {
+  { "Blocking", "0", "0", 0 },
+  { "KeepAlivePool", "64", "0", IDLE_CLIENTS },
+  { "KeepAlivePoolCache", "64", "65536", IDLE_CLIENTS }
+};
+
+static void wait_for_events(rtems_event_set events)
+{
+  rtems_status_code sc;
+  rtems_event_set out;
+
+  sc = rtems_event_receive(
+    events,
+    RTEMS_EVENT_ALL | RTEMS_WAIT,
+    RTEMS_NO_TIMEOUT,
+    &out
+  );
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+}
+
+static void send_events(rtems_id task, rtems_event_set events)
+{
+  rtems_status_code sc;
+
+  sc = rtems_event_send(task, events);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+}
+
+static int open_connection(void)
+{
+  struct sockaddr_in addr;
+  int sd;
+  int rv;
+
+  sd = socket(PF_INET, SOCK_STREAM, 0);
+  rtems_test_assert(sd >= 0);
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  rv = connect(sd, (struct sockaddr *) &addr, sizeof(addr));
+  rtems_test_assert(rv == 0);
+
+  return sd;
+}
+
+/* Send one request and receive the complete response */
+static void do_request(int sd, char *buf, size_t size)
+{
+  const char *body;
+  const char *cl;
+  size_t received = 0;
+  size_t total = 0;
+  ssize_t n;
+
+  n = write(sd, REQUEST, sizeof(REQUEST) - 1);
+  rtems_test_assert(n == (ssize_t) (sizeof(REQUEST) - 1));
+
+  while (total == 0 || received < total) {
+    n = read(sd, &buf[received], size - 1 - received);
+    rtems_test_assert(n > 0);
+
+    received += (size_t) n;
+    buf[received] = '\0';
+
+    if (total == 0 && (body = strstr(buf, "\r\n\r\n")) != NULL) {
+      rtems_test_assert(strncmp(buf, "HTTP/1.1 200 OK\r\n", 17) == 0);
+
+      cl = strstr(buf, "Content-Length: ");
+      rtems_test_assert(cl != NULL);
+
+      total = (size_t) (body + 4 - buf) + (size_t) atoi(cl + 16);
+      rtems_test_assert(total < size);
+    }
+  }
+
+  rtems_test_assert(received == total);
+  rtems_test_assert(buf[total - 1] == 'x');
+}
+
+static rtems_task load_task(rtems_task_argument arg)
+{
+  test_context *ctx = &test_instance;
+  test_client *client = &ctx->clients[arg];
+
+  while (true) {
+    int sd;
+    int rv;
+
+    wait_for_events(EVENT_START);
+
+    client->requests = 0;
+    client->samples = 0;
+
+    sd = open_connection();
+
+    while (!ctx->stop) {
+      uint64_t t0 = rtems_clock_get_uptime_nanoseconds();
+      uint64_t t1;
+
+      do_request(sd, &client->buf[0], sizeof(client->buf));
+
+      t1 = rtems_clock_get_uptime_nanoseconds();
+
+      if (client->samples < SAMPLES_MAX) {
+        client->latency_us[client->samples] = (uint32_t) ((t1 - t0) / 1000);
+        ++client->samples;
+      }
+
+      ++client->requests;
+    }
+
+    rv = close(sd);
+    rtems_test_assert(rv == 0);
+
+    send_events(ctx->init_task, EVENT_DONE(arg));
+  }
+}
+
+static void create_file(void)
+{
+  char buf[FILE_SIZE];
+  int fd;
+  int rv;
+  ssize_t n;
+
+  rv = mkdir("/www", 0777);
+  rtems_test_assert(rv == 0);
+
+  memset(buf, 'x', sizeof(buf));
+
+  fd = open(FILE_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  rtems_test_assert(fd >= 0);
+
+  n = write(fd, buf, sizeof(buf));
+  rtems_test_assert(n == (ssize_t) sizeof(buf));
+
+  rv = close(fd);
+  rtems_test_assert(rv == 0);
+}
+
+static int cmp_latency(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *) a;
+  uint32_t y = *(const uint32_t *) b;
+
+  return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static void run_scenario(test_context *ctx, const test_scenario *scenario)
+{
+  const struct mg_callbacks callbacks = {
+    NULL
+  };
+  const char *options[] = {
+    "listening_ports", "8080",
+    "document_root", "/www",
+    "num_threads", "4",
+    "enable_keep_alive", "yes",
+    "request_timeout_ms", "10000",
+    "keep_alive_connections", scenario->keep_alive_connections,
+    "static_file_cache_size", scenario->static_file_cache_size,
+    NULL
+  };
+  struct mg_context *mg;
+  rtems_interval duration = rtems_clock_get_ticks_per_second();
+  uint64_t requests = 0;
+  size_t samples = 0;
+  uint32_t p99 = 0;
+  rtems_event_set done = 0;
+  char buf[FILE_SIZE + 512];
+  size_t i;
+  int rv;
+
+  mg = mg_start(&callbacks, NULL, options);
+  rtems_test_assert(mg != NULL);
+
+  /* Browsers which keep their connection open after the first request */
+  for (i = 0; i < (size_t) scenario->idle_clients; ++i) {
+    ctx->idle_sd[i] = open_connection();
+    do_request(ctx->idle_sd[i], buf, sizeof(buf));
+  }
+
+  ctx->stop = false;
+
+  for (i = 0; i < LOAD_CLIENTS; ++i) {
+    send_events(ctx->clients[i].task, EVENT_START);
+    done |= EVENT_DONE(i);
+  }
+
+  rtems_task_wake_after(duration);
+  ctx->stop = true;
+
+  wait_for_events(done);
+
+  for (i = 0; i < LOAD_CLIENTS; ++i) {
+    test_client *client = &ctx->clients[i];
+
+    requests += client->requests;
+    memcpy(
+      &ctx->all_samples[samples],
+      &client->latency_us[0],
+      client->samples * sizeof(client->latency_us[0])
+    );
+    samples += client->samples;
+  }
+
+  for (i = 0; i < (size_t) scenario->idle_clients; ++i) {
+    rv = close(ctx->idle_sd[i]);
+    rtems_test_assert(rv == 0);
+  }
+
+  mg_stop(mg);
+
+  if (samples > 0) {
+    qsort(&ctx->all_samples[0], samples, sizeof(ctx->all_samples[0]),
+      cmp_latency);
+    p99 = ctx->all_samples[(samples * 99) / 100];
+  }
+
+  printf(
+    "  <%s idleConnections=\"%i\">\n"
+    "    <RequestsPerSecond>%" PRIu64 "</RequestsPerSecond>\n"
+    "    <P99Latency unit=\"us\">%" PRIu32 "</P99Latency>\n"
+    "  </%s>\n",
+    scenario->name,
+    scenario->idle_clients,
+    requests * rtems_clock_get_ticks_per_second() / duration,
+    p99,
+    scenario->name
+  );
+}
+
+static void test(void)
+{
+  test_context *ctx = &test_instance;
+  rtems_status_code sc;
+  size_t i;
+  int rv;
+
+  ctx->init_task = rtems_task_self();
+
+  rv = rtems_bsdnet_initialize_network();
+  rtems_test_assert(rv == 0);
+
+  create_file();
+
+  for (i = 0; i < LOAD_CLIENTS; ++i) {
+    sc = rtems_task_create(
+      rtems_build_name('L', 'O', 'A', 'D'),
+      TASK_PRIORITY,
+      RTEMS_MINIMUM_STACK_SIZE,
+      RTEMS_DEFAULT_MODES,
+      RTEMS_DEFAULT_ATTRIBUTES,
+      &ctx->clients[i].task
+    );
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+    sc = rtems_task_start(ctx->clients[i].task, load_task, i);
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  }
+
+  puts("<MghttpdLoad>");
+
+  for (i = 0; i < RTEMS_ARRAY_SIZE(test_scenarios); ++i) {
+    run_scenario(ctx, &test_scenarios[i]);
+  }
+
+  puts("</MghttpdLoad>");
+}
+
+static rtems_task Init(rtems_task_argument argument)
+{
+  TEST_BEGIN();
+  test();
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_INIT
+
+#define CONFIGURE_MICROSECONDS_PER_TICK 10000
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_FILESYSTEM_IMFS
+
+/* Client and server side of each connection */
+#define CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS \
+  (2 * (LOAD_CLIENTS + IDLE_CLIENTS) + 16)
+
+#define CONFIGURE_UNLIMITED_OBJECTS
+
+#define CONFIGURE_UNIFIED_WORK_AREAS
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_INIT_TASK_PRIORITY TASK_PRIORITY
+
+#define CONFIGURE_INIT_TASK_STACK_SIZE (16 * 1024)
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#include <rtems/confdefs.h>
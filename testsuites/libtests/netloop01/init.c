@@ -0,0 +1,465 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtems.h>
+#include <rtems/rtems_bsdnet.h>
+#include <tmacros.h>
+
+const char rtems_test_name[] = "NETLOOP 1";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+struct rtems_bsdnet_config rtems_bsdnet_config = {
+  .mbuf_bytecount = 256 * 1024,
+  .mbuf_cluster_bytecount = 1024 * 1024
+};
+
+#define CPU_COUNT 32
+
+#define PAIR_COUNT_MAX 8
+
+#define WORKER_COUNT (2 * PAIR_COUNT_MAX)
+
+#define TCP_PORT 1234
+
+#define UDP_PORT 2345
+
+#define TCP_TRANSFER_SIZE (256 * 1024)
+
+#define UDP_ROUND_TRIPS 256
+
+#define UDP_DATAGRAM_SIZE 512
+
+/* A lost datagram fails the test instead of blocking it forever */
+#define UDP_TIMEOUT_SECONDS 5
+
+/* Below the network daemon priority */
+#define TASK_PRIORITY 110
+
+typedef enum {
+  TEST_TCP,
+  TEST_UDP
+} test_kind;
+
+typedef struct test_context test_context;
+
+/*
+ * The workers 2 * i and 2 * i + 1 form the pair i.  The first one sends the
+ * data, the second one receives it.
+ */
+typedef struct {
+  test_context *ctx;
+  size_t pair;
+  bool sender;
+  rtems_id task;
+  int sd;
+  char buf[4096];
+} test_worker;
+
+struct test_context {
+  rtems_id done;
+  test_kind kind;
+  int listen_sd;
+  test_worker workers[WORKER_COUNT];
+};
+
+static test_context test_instance;
+
+static const size_t pair_counts[] = { 1, 2, 4, PAIR_COUNT_MAX };
+
+/* Each pair uses its own pattern, so mixed up data is detected */
+static uint8_t pattern(size_t pair, size_t pos)
+{
+  return (uint8_t) (pos * 7 + (pos >> 8) + pair * 31);
+}
+
+static void fill(char *buf, size_t n, size_t pair, size_t pos)
+{
+  size_t i;
+
+  for (i = 0; i < n; ++i) {
+    buf[i] = (char) pattern(pair, pos + i);
+  }
+}
+
+static void check(const char *buf, size_t n, size_t pair, size_t pos)
+{
+  size_t i;
+
+  for (i = 0; i < n; ++i) {
+    rtems_test_assert((uint8_t) buf[i] == pattern(pair, pos + i));
+  }
+}
+
+static void tcp_send(test_worker *w)
+{
+  size_t sent = 0;
+
+  while (sent < TCP_TRANSFER_SIZE) {
+    ssize_t n;
+
+    fill(&w->buf[0], sizeof(w->buf), w->pair, sent);
+    n = send(w->sd, &w->buf[0], sizeof(w->buf), 0);
+    rtems_test_assert(n == (ssize_t) sizeof(w->buf));
+    sent += (size_t) n;
+  }
+}
+
+static void tcp_receive(test_worker *w)
+{
+  size_t received = 0;
+  ssize_t n;
+
+  while ((n = read(w->sd, &w->buf[0], sizeof(w->buf))) > 0) {
+    check(&w->buf[0], (size_t) n, w->pair, received);
+    received += (size_t) n;
+  }
+
+  rtems_test_assert(n == 0);
+  rtems_test_assert(received == TCP_TRANSFER_SIZE);
+}
+
+static void udp_client(test_worker *w)
+{
+  size_t i;
+
+  for (i = 0; i < UDP_ROUND_TRIPS; ++i) {
+    size_t pos = i * UDP_DATAGRAM_SIZE;
+    ssize_t n;
+
+    fill(&w->buf[0], UDP_DATAGRAM_SIZE, w->pair, pos);
+    n = send(w->sd, &w->buf[0], UDP_DATAGRAM_SIZE, 0);
+    rtems_test_assert(n == UDP_DATAGRAM_SIZE);
+
+    memset(&w->buf[0], 0, UDP_DATAGRAM_SIZE);
+    n = recv(w->sd, &w->buf[0], sizeof(w->buf), 0);
+    rtems_test_assert(n == UDP_DATAGRAM_SIZE);
+    check(&w->buf[0], UDP_DATAGRAM_SIZE, w->pair, pos);
+  }
+}
+
+static void udp_server(test_worker *w)
+{
+  size_t i;
+
+  for (i = 0; i < UDP_ROUND_TRIPS; ++i) {
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    ssize_t n;
+
+    n = recvfrom(
+      w->sd,
+      &w->buf[0],
+      sizeof(w->buf),
+      0,
+      (struct sockaddr *) &addr,
+      &addr_len
+    );
+    rtems_test_assert(n == UDP_DATAGRAM_SIZE);
+    check(&w->buf[0], UDP_DATAGRAM_SIZE, w->pair, i * UDP_DATAGRAM_SIZE);
+
+    n = sendto(
+      w->sd,
+      &w->buf[0],
+      UDP_DATAGRAM_SIZE,
+      0,
+      (struct sockaddr *) &addr,
+      addr_len
+    );
+    rtems_test_assert(n == UDP_DATAGRAM_SIZE);
+  }
+}
+
+static rtems_task worker_task(rtems_task_argument arg)
+{
+  test_worker *w = (test_worker *) arg;
+  test_context *ctx = w->ctx;
+
+  while (true) {
+    rtems_status_code sc;
+    int rv;
+
+    sc = rtems_event_transient_receive(RTEMS_WAIT, RTEMS_NO_TIMEOUT);
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+    if (ctx->kind == TEST_TCP) {
+      if (w->sender) {
+        tcp_send(w);
+      } else {
+        tcp_receive(w);
+      }
+    } else {
+      if (w->sender) {
+        udp_client(w);
+      } else {
+        udp_server(w);
+      }
+    }
+
+    /* For TCP this is the end of file for the receiver */
+    rv = close(w->sd);
+    rtems_test_assert(rv == 0);
+
+    sc = rtems_semaphore_release(ctx->done);
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  }
+}
+
+static void init_addr(struct sockaddr_in *addr, int port)
+{
+  memset(addr, 0, sizeof(*addr));
+  addr->sin_family = AF_INET;
+  addr->sin_port = htons(port);
+  addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+}
+
+static void create_listen_socket(test_context *ctx)
+{
+  struct sockaddr_in addr;
+  int rv;
+
+  ctx->listen_sd = socket(PF_INET, SOCK_STREAM, 0);
+  rtems_test_assert(ctx->listen_sd >= 0);
+
+  init_addr(&addr, TCP_PORT);
+  rv = bind(ctx->listen_sd, (struct sockaddr *) &addr, sizeof(addr));
+  rtems_test_assert(rv == 0);
+
+  rv = listen(ctx->listen_sd, PAIR_COUNT_MAX);
+  rtems_test_assert(rv == 0);
+}
+
+static void tcp_connect(test_context *ctx, size_t pair)
+{
+  struct sockaddr_in addr;
+  int sd;
+  int rv;
+
+  sd = socket(PF_INET, SOCK_STREAM, 0);
+  rtems_test_assert(sd >= 0);
+
+  init_addr(&addr, TCP_PORT);
+  rv = connect(sd, (struct sockaddr *) &addr, sizeof(addr));
+  rtems_test_assert(rv == 0);
+
+  ctx->workers[2 * pair].sd = sd;
+
+  /* The connections are accepted in the order of their establishment */
+  sd = accept(ctx->listen_sd, NULL, NULL);
+  rtems_test_assert(sd >= 0);
+
+  ctx->workers[2 * pair + 1].sd = sd;
+}
+
+static int udp_socket(int port)
+{
+  struct sockaddr_in addr;
+  struct timeval timeout;
+  int sd;
+  int rv;
+
+  sd = socket(PF_INET, SOCK_DGRAM, 0);
+  rtems_test_assert(sd >= 0);
+
+  memset(&timeout, 0, sizeof(timeout));
+  timeout.tv_sec = UDP_TIMEOUT_SECONDS;
+  rv = setsockopt(sd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  rtems_test_assert(rv == 0);
+
+  if (port != 0) {
+    init_addr(&addr, port);
+    rv = bind(sd, (struct sockaddr *) &addr, sizeof(addr));
+    rtems_test_assert(rv == 0);
+  }
+
+  return sd;
+}
+
+static void udp_connect(test_context *ctx, size_t pair)
+{
+  struct sockaddr_in addr;
+  int port = UDP_PORT + (int) pair;
+  int sd;
+  int rv;
+
+  ctx->workers[2 * pair + 1].sd = udp_socket(port);
+
+  sd = udp_socket(0);
+  init_addr(&addr, port);
+  rv = connect(sd, (struct sockaddr *) &addr, sizeof(addr));
+  rtems_test_assert(rv == 0);
+
+  ctx->workers[2 * pair].sd = sd;
+}
+
+static uint64_t run(test_context *ctx, test_kind kind, size_t pair_count)
+{
+  rtems_status_code sc;
+  uint64_t t0;
+  uint64_t t1;
+  size_t i;
+
+  ctx->kind = kind;
+
+  for (i = 0; i < pair_count; ++i) {
+    if (kind == TEST_TCP) {
+      tcp_connect(ctx, i);
+    } else {
+      udp_connect(ctx, i);
+    }
+  }
+
+  t0 = rtems_clock_get_uptime_nanoseconds();
+
+  for (i = 0; i < 2 * pair_count; ++i) {
+    sc = rtems_event_transient_send(ctx->workers[i].task);
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  }
+
+  for (i = 0; i < 2 * pair_count; ++i) {
+    sc = rtems_semaphore_obtain(ctx->done, RTEMS_WAIT, RTEMS_NO_TIMEOUT);
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  }
+
+  t1 = rtems_clock_get_uptime_nanoseconds();
+
+  return t1 - t0 + 1;
+}
+
+static void test_integrity(test_context *ctx)
+{
+  puts("concurrent TCP transfers");
+  run(ctx, TEST_TCP, PAIR_COUNT_MAX);
+
+  puts("concurrent UDP round trips");
+  run(ctx, TEST_UDP, PAIR_COUNT_MAX);
+}
+
+static void test_throughput(test_context *ctx)
+{
+  size_t i;
+
+  puts("<NetLoop>");
+
+  for (i = 0; i < RTEMS_ARRAY_SIZE(pair_counts); ++i) {
+    size_t pair_count = pair_counts[i];
+    uint64_t ns;
+
+    ns = run(ctx, TEST_TCP, pair_count);
+    printf(
+      "  <TCP sockets=\"%zu\" unit=\"KiB/s\">%" PRIu64 "</TCP>\n",
+      pair_count,
+      ((uint64_t) pair_count * TCP_TRANSFER_SIZE * UINT64_C(1000000000))
+        / (1024 * ns)
+    );
+
+    ns = run(ctx, TEST_UDP, pair_count);
+    printf(
+      "  <UDP sockets=\"%zu\" unit=\"1/s\">%" PRIu64 "</UDP>\n",
+      pair_count,
+      ((uint64_t) pair_count * UDP_ROUND_TRIPS * UINT64_C(1000000000)) / ns
+    );
+  }
+
+  puts("</NetLoop>");
+}
+
+static void test(void)
+{
+  test_context *ctx = &test_instance;
+  rtems_status_code sc;
+  size_t i;
+  int rv;
+
+  rv = rtems_bsdnet_initialize_network();
+  rtems_test_assert(rv == 0);
+
+  sc = rtems_semaphore_create(
+    rtems_build_name('D', 'O', 'N', 'E'),
+    0,
+    RTEMS_COUNTING_SEMAPHORE,
+    0,
+    &ctx->done
+  );
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  create_listen_socket(ctx);
+
+  for (i = 0; i < WORKER_COUNT; ++i) {
+    test_worker *w = &ctx->workers[i];
+
+    w->ctx = ctx;
+    w->pair = i / 2;
+    w->sender = (i % 2) == 0;
+
+    sc = rtems_task_create(
+      rtems_build_name('W', 'O', 'R', 'K'),
+      TASK_PRIORITY,
+      RTEMS_MINIMUM_STACK_SIZE,
+      RTEMS_DEFAULT_MODES,
+      RTEMS_DEFAULT_ATTRIBUTES,
+      &w->task
+    );
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+    sc = rtems_task_start(w->task, worker_task, (rtems_task_argument) w);
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  }
+
+  test_integrity(ctx);
+  test_throughput(ctx);
+}
+
+static rtems_task Init(rtems_task_argument argument)
+{
+  TEST_BEGIN();
+  test();
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_INIT
+
+#define CONFIGURE_MICROSECONDS_PER_TICK 10000
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS (4 + WORKER_COUNT + 4)
+
+#define CONFIGURE_MAXIMUM_TASKS (1 + WORKER_COUNT + 2)
+#define CONFIGURE_MAXIMUM_SEMAPHORES 3
+
+#define CONFIGURE_SMP_APPLICATION
+
+#define CONFIGURE_SMP_MAXIMUM_PROCESSORS CPU_COUNT
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_INIT_TASK_PRIORITY TASK_PRIORITY
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#include <rtems/confdefs.h>
@@ -0,0 +1,454 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/sockio.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtems.h>
+#include <rtems/rtems_bsdnet.h>
+#include <tmacros.h>
+
+/*
+ * Include the kernel network headers last, they redefine malloc() and free().
+ */
+#define _KERNEL
+#include <sys/param.h>
+#include <sys/mbuf.h>
+#include <net/if.h>
+#include <net/if_arp.h>
+#include <net/ethernet.h>
+#include <netinet/in_systm.h>
+#include <netinet/if_ether.h>
+#include <netinet/ip.h>
+#include <netinet/udp.h>
+#include <netinet/udp_var.h>
+#include <rtems/rtems_bsdnet_internal.h>
+
+const char rtems_test_name[] = "NETPOLL 1";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+static int gen_attach(struct rtems_bsdnet_ifconfig *config, int attaching);
+
+static uint8_t gen_mac[ETHER_ADDR_LEN] = { 0x0e, 0xb0, 0xba, 0x5e, 0xba, 0x11 };
+
+static struct rtems_bsdnet_ifconfig gen_ifconfig = {
+  .name = "gen1",
+  .attach = gen_attach,
+  .ip_address = "192.168.100.1",
+  .ip_netmask = "255.255.255.0",
+  .hardware_address = gen_mac
+};
+
+struct rtems_bsdnet_config rtems_bsdnet_config = {
+  .ifconfig = &gen_ifconfig,
+  .mbuf_bytecount = 256 * 1024,
+  .mbuf_cluster_bytecount = 256 * 1024
+};
+
+#define PORT 1234
+
+/* An Ethernet frame of minimum size */
+#define PAYLOAD_SIZE \
+  (ETHER_MIN_LEN - ETHER_CRC_LEN - ETHER_HDR_LEN \
+    - sizeof(struct ip) - sizeof(struct udphdr))
+
+#define FRAME_COUNT 100000
+
+/* Size of the receive ring of the interrupt driven mode */
+#define RING_SIZE 32
+
+#define INTERRUPT_EVENT RTEMS_EVENT_1
+
+#define EVENT_DONE RTEMS_EVENT_0
+
+typedef enum {
+  MODE_INTERRUPT_PER_FRAME,
+  MODE_INTERRUPT_PER_BURST,
+  MODE_POLLING
+} test_mode;
+
+typedef struct {
+  struct arpcom arpcom;
+  rtems_id rx_task;
+  rtems_id init_task;
+  test_mode mode;
+  uint32_t frames_left;
+  uint32_t intren;
+  struct {
+    struct ether_header eh;
+    struct ip ip;
+    struct udphdr uh;
+    uint8_t payload[PAYLOAD_SIZE];
+  } __attribute__((packed)) frame;
+} gen_softc;
+
+static gen_softc gen_instance;
+
+static uint16_t ip_header_cksum(const void *hdr)
+{
+  const uint8_t *p = hdr;
+  uint32_t sum = 0;
+  size_t i;
+
+  for (i = 0; i < sizeof(struct ip); i += 2) {
+    sum += (uint32_t) ((p[i] << 8) | p[i + 1]);
+  }
+
+  while (sum > 0xffff) {
+    sum = (sum & 0xffff) + (sum >> 16);
+  }
+
+  return htons((uint16_t) ~sum);
+}
+
+static void gen_init_frame(gen_softc *sc)
+{
+  struct ip *ip = &sc->frame.ip;
+  struct udphdr *uh = &sc->frame.uh;
+
+  memcpy(sc->frame.eh.ether_dhost, gen_mac, ETHER_ADDR_LEN);
+  memcpy(sc->frame.eh.ether_shost, gen_mac, ETHER_ADDR_LEN);
+  sc->frame.eh.ether_shost[5] ^= 1;
+  sc->frame.eh.ether_type = htons(ETHERTYPE_IP);
+
+  ip->ip_v = IPVERSION;
+  ip->ip_hl = sizeof(*ip) >> 2;
+  ip->ip_len = htons(sizeof(*ip) + sizeof(*uh) + PAYLOAD_SIZE);
+  ip->ip_ttl = 64;
+  ip->ip_p = IPPROTO_UDP;
+  ip->ip_src.s_addr = inet_addr("192.168.100.2");
+  ip->ip_dst.s_addr = inet_addr("192.168.100.1");
+  ip->ip_sum = ip_header_cksum(ip);
+
+  uh->uh_sport = htons(PORT);
+  uh->uh_dport = htons(PORT);
+  uh->uh_ulen = htons(sizeof(*uh) + PAYLOAD_SIZE);
+  uh->uh_sum = 0;
+}
+
+/* Receive one frame from the imaginary hardware */
+static void gen_receive(gen_softc *sc)
+{
+  struct ifnet *ifp = &sc->arpcom.ac_if;
+  struct ether_header *eh;
+  struct mbuf *m;
+
+  MGETHDR(m, M_WAIT, MT_DATA);
+  m->m_pkthdr.rcvif = ifp;
+  m->m_len = m->m_pkthdr.len = sizeof(sc->frame) - sizeof(*eh);
+  memcpy(mtod(m, void *), &sc->frame, sizeof(sc->frame));
+  eh = mtod(m, struct ether_header *);
+  m->m_data += sizeof(*eh);
+
+  --sc->frames_left;
+  ether_input(ifp, eh, m);
+}
+
+static int gen_poll_recv(struct ifnet *ifp, int *quota)
+{
+  gen_softc *sc = ifp->if_softc;
+
+  while (*quota > 0 && sc->frames_left > 0) {
+    gen_receive(sc);
+    --*quota;
+  }
+
+  return sc->frames_left > 0;
+}
+
+static void gen_poll_intren(struct ifnet *ifp)
+{
+  gen_softc *sc = ifp->if_softc;
+  ++sc->intren;
+  rtems_event_send(sc->init_task, EVENT_DONE);
+}
+
+/*
+ * The receive task of the interrupt driven mode.  It empties the receive ring
+ * and waits for the next interrupt.  The imaginary hardware fills the ring
+ * while the network daemon processes the frames.
+ */
+static void gen_rx_task(void *arg)
+{
+  gen_softc *sc = arg;
+
+  while (true) {
+    rtems_event_set events;
+    uint32_t burst;
+
+    rtems_bsdnet_event_receive(
+      INTERRUPT_EVENT,
+      RTEMS_WAIT | RTEMS_EVENT_ANY,
+      RTEMS_NO_TIMEOUT,
+      &events
+    );
+
+    burst = sc->mode == MODE_INTERRUPT_PER_FRAME ? 1 : RING_SIZE;
+
+    while (sc->frames_left > 0) {
+      uint32_t i;
+
+      for (i = 0; i < burst && sc->frames_left > 0; ++i) {
+        gen_receive(sc);
+      }
+
+      /* Let the network daemon process the frames until the next interrupt */
+      rtems_bsdnet_semaphore_release();
+      rtems_task_wake_after(RTEMS_YIELD_PROCESSOR);
+      rtems_bsdnet_semaphore_obtain();
+    }
+
+    rtems_event_send(sc->init_task, EVENT_DONE);
+  }
+}
+
+static void gen_start(struct ifnet *ifp)
+{
+  struct mbuf *m;
+
+  /* Discard everything, the imaginary link has no peer */
+  while (true) {
+    IF_DEQUEUE(&ifp->if_snd, m);
+
+    if (m == NULL) {
+      break;
+    }
+
+    m_freem(m);
+  }
+}
+
+static void gen_init(void *arg)
+{
+  gen_softc *sc = arg;
+  struct ifnet *ifp = &sc->arpcom.ac_if;
+
+  if (sc->rx_task == 0) {
+    sc->rx_task = rtems_bsdnet_newproc("genr", 4096, gen_rx_task, sc);
+  }
+
+  ifp->if_flags |= IFF_RUNNING;
+}
+
+static int gen_ioctl(struct ifnet *ifp, ioctl_command_t cmd, caddr_t data)
+{
+  gen_softc *sc = ifp->if_softc;
+  int error = 0;
+
+  switch (cmd) {
+    case SIOCGIFADDR:
+    case SIOCSIFADDR:
+      ether_ioctl(ifp, cmd, data);
+      break;
+    case SIOCSIFFLAGS:
+      if ((ifp->if_flags & IFF_UP) != 0) {
+        gen_init(sc);
+      } else {
+        ifp->if_flags &= ~IFF_RUNNING;
+      }
+      break;
+    default:
+      error = EINVAL;
+      break;
+  }
+
+  return error;
+}
+
+static int gen_attach(struct rtems_bsdnet_ifconfig *config, int attaching)
+{
+  gen_softc *sc = &gen_instance;
+  struct ifnet *ifp = &sc->arpcom.ac_if;
+
+  rtems_test_assert(attaching);
+
+  memcpy(sc->arpcom.ac_enaddr, config->hardware_address, ETHER_ADDR_LEN);
+  gen_init_frame(sc);
+
+  ifp->if_softc = sc;
+  ifp->if_name = "gen";
+  ifp->if_unit = 1;
+  ifp->if_mtu = ETHERMTU;
+  ifp->if_init = gen_init;
+  ifp->if_ioctl = gen_ioctl;
+  ifp->if_start = gen_start;
+  ifp->if_output = ether_output;
+  ifp->if_poll_recv = gen_poll_recv;
+  ifp->if_poll_intren = gen_poll_intren;
+  ifp->if_flags = IFF_BROADCAST | IFF_SIMPLEX;
+  ifp->if_snd.ifq_maxlen = ifqmaxlen;
+
+  if_attach(ifp);
+  ether_ifattach(ifp);
+
+  return 1;
+}
+
+static int create_sink(void)
+{
+  struct sockaddr_in addr;
+  int sd;
+  int rv;
+
+  /* Nobody reads from the socket, the received datagrams are dropped */
+  sd = socket(PF_INET, SOCK_DGRAM, 0);
+  rtems_test_assert(sd >= 0);
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+  rv = bind(sd, (struct sockaddr *) &addr, sizeof(addr));
+  rtems_test_assert(rv == 0);
+
+  return sd;
+}
+
+static void run(gen_softc *sc, test_mode mode, uint32_t frames)
+{
+  rtems_status_code sc_;
+  rtems_event_set events;
+  u_long received;
+
+  received = udpstat.udps_ipackets;
+  sc->mode = mode;
+  sc->frames_left = frames;
+
+  if (mode == MODE_POLLING) {
+    /* This is what the receive interrupt handler does */
+    rtems_bsdnet_schedpoll(&sc->arpcom.ac_if);
+  } else {
+    sc_ = rtems_event_send(sc->rx_task, INTERRUPT_EVENT);
+    rtems_test_assert(sc_ == RTEMS_SUCCESSFUL);
+  }
+
+  sc_ = rtems_event_receive(
+    EVENT_DONE,
+    RTEMS_EVENT_ALL | RTEMS_WAIT,
+    RTEMS_NO_TIMEOUT,
+    &events
+  );
+  rtems_test_assert(sc_ == RTEMS_SUCCESSFUL);
+
+  /* Wait until the network daemon is done */
+  rtems_bsdnet_semaphore_obtain();
+  rtems_test_assert(sc->frames_left == 0);
+  rtems_test_assert(udpstat.udps_ipackets - received == frames);
+  rtems_bsdnet_semaphore_release();
+}
+
+static void test_polling(gen_softc *sc)
+{
+  struct ifnet *ifp = &sc->arpcom.ac_if;
+
+  puts("polling: quota");
+
+  ifp->if_recvquota = 8;
+  sc->intren = 0;
+  run(sc, MODE_POLLING, 100);
+  rtems_test_assert(sc->intren == 1);
+  rtems_test_assert((ifp->if_flags & IFF_POLLING) == 0);
+  ifp->if_recvquota = 0;
+
+  puts("polling: no frames");
+
+  run(sc, MODE_POLLING, 0);
+  rtems_test_assert(sc->intren == 2);
+}
+
+static void measure(gen_softc *sc, const char *name, test_mode mode)
+{
+  uint64_t t0;
+  uint64_t t1;
+
+  t0 = rtems_clock_get_uptime_nanoseconds();
+  run(sc, mode, FRAME_COUNT);
+  t1 = rtems_clock_get_uptime_nanoseconds();
+
+  if (t1 == t0) {
+    t1 = t0 + 1;
+  }
+
+  printf(
+    "  <%s>\n"
+    "    <PacketsPerSecond>%" PRIu64 "</PacketsPerSecond>\n"
+    "    <NanosecondsPerPacket>%" PRIu64 "</NanosecondsPerPacket>\n"
+    "  </%s>\n",
+    name,
+    ((uint64_t) FRAME_COUNT * 1000000000) / (t1 - t0),
+    (t1 - t0) / FRAME_COUNT,
+    name
+  );
+}
+
+static void test(void)
+{
+  gen_softc *sc = &gen_instance;
+  int rv;
+
+  sc->init_task = rtems_task_self();
+
+  rv = rtems_bsdnet_initialize_network();
+  rtems_test_assert(rv == 0);
+
+  create_sink();
+
+  test_polling(sc);
+
+  puts("<NetPoll>");
+  measure(sc, "InterruptPerFrame", MODE_INTERRUPT_PER_FRAME);
+  measure(sc, "InterruptPerBurst", MODE_INTERRUPT_PER_BURST);
+  measure(sc, "Polling", MODE_POLLING);
+  puts("</NetPoll>");
+}
+
+static rtems_task Init(rtems_task_argument argument)
+{
+  TEST_BEGIN();
+  test();
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_INIT
+
+#define CONFIGURE_MICROSECONDS_PER_TICK 10000
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS 8
+
+#define CONFIGURE_UNLIMITED_OBJECTS
+
+#define CONFIGURE_UNIFIED_WORK_AREAS
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+/* Below the network tasks */
+#define CONFIGURE_INIT_TASK_PRIORITY 110
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#include <rtems/confdefs.h>
@@ -0,0 +1,801 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtems.h>
+#include <rtems/libio.h>
+#include <rtems/rtems_bsdnet.h>
+#include <librtemsNfs.h>
+#include <tmacros.h>
+
+const char rtems_test_name[] = "NFS 1";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+struct rtems_bsdnet_config rtems_bsdnet_config = {
+  .mbuf_bytecount = 128 * 1024,
+  .mbuf_cluster_bytecount = 256 * 1024
+};
+
+/*
+ * A minimal NFSv2 server stand-in.  It serves the portmapper, the mount
+ * protocol and the NFS protocol on the portmapper port of the loopback
+ * interface and keeps the files in memory.
+ */
+
+#define PMAP_PORT 111
+
+#define PMAP_PROG 100000
+#define PMAP_PROC_GETPORT 3
+
+#define MOUNT_PROG 100005
+#define MOUNT_PROC_MNT 1
+#define MOUNT_PROC_UMNT 3
+
+#define NFS_PROG 100003
+#define NFS_PROC_NULL 0
+#define NFS_PROC_GETATTR 1
+#define NFS_PROC_LOOKUP 4
+#define NFS_PROC_READ 6
+#define NFS_PROC_WRITE 8
+#define NFS_PROC_COUNT 18
+
+#define NFS_ERR_NOENT 2
+#define NFS_ERR_ACCES 13
+#define NFS_ERR_STALE 70
+
+#define NF_REG 1
+#define NF_DIR 2
+
+#define FH_SIZE 32
+
+#define MAX_DATA 8192
+
+#define MSG_SIZE 8800
+
+/* The client may have this many requests in flight */
+#define BATCH_MAX 16
+
+#define FILE_SIZE (64 * 1024)
+
+/* Below the client, so that the requests of a burst queue up */
+#define SERVER_PRIORITY 120
+
+#define CLIENT_PRIORITY 110
+
+#define MOUNT_POINT "/nfs"
+
+typedef enum {
+  FILE_ROOT,
+  FILE_DATA,
+  FILE_OUT,
+  FILE_LOCKED,
+  FILE_COUNT
+} file_id;
+
+typedef struct {
+  const char *name;
+  uint32_t type;
+  uint32_t mode;
+  uint32_t size;
+  bool locked;
+  uint8_t data[FILE_SIZE];
+} test_file;
+
+typedef struct {
+  uint8_t buf[MSG_SIZE];
+  size_t len;
+  struct sockaddr_in from;
+} test_msg;
+
+typedef struct {
+  const uint8_t *pos;
+  const uint8_t *end;
+} test_decoder;
+
+typedef struct {
+  uint8_t *pos;
+} test_encoder;
+
+typedef struct {
+  int sd;
+  rtems_id server_task;
+  test_file files[FILE_COUNT];
+  uint32_t calls[NFS_PROC_COUNT];
+  uint32_t max_batch[NFS_PROC_COUNT];
+  test_msg rx[BATCH_MAX];
+  uint8_t tx[MSG_SIZE];
+  char rx_buf[2 * FILE_SIZE];
+} test_context;
+
+static test_context test_instance;
+
+static uint8_t pattern(uint32_t pos)
+{
+  return (uint8_t) ((pos * 7) ^ (pos >> 9));
+}
+
+static uint32_t get_u32(test_decoder *dec)
+{
+  uint32_t v;
+
+  rtems_test_assert(dec->end - dec->pos >= 4);
+  memcpy(&v, dec->pos, 4);
+  dec->pos += 4;
+
+  return ntohl(v);
+}
+
+static const uint8_t *get_opaque(test_decoder *dec, uint32_t len)
+{
+  const uint8_t *p = dec->pos;
+
+  rtems_test_assert((uint32_t) (dec->end - dec->pos) >= len);
+  dec->pos += (len + 3) & ~UINT32_C(3);
+
+  return p;
+}
+
+static file_id get_fh(test_decoder *dec)
+{
+  const uint8_t *fh = get_opaque(dec, FH_SIZE);
+
+  return fh[0] < FILE_COUNT ? (file_id) fh[0] : FILE_COUNT;
+}
+
+static void put_u32(test_encoder *enc, uint32_t v)
+{
+  v = htonl(v);
+  memcpy(enc->pos, &v, 4);
+  enc->pos += 4;
+}
+
+static void put_opaque(test_encoder *enc, const void *p, uint32_t len)
+{
+  memset(enc->pos, 0, (len + 3) & ~UINT32_C(3));
+  memcpy(enc->pos, p, len);
+  enc->pos += (len + 3) & ~UINT32_C(3);
+}
+
+static void put_fh(test_encoder *enc, file_id id)
+{
+  uint8_t fh[FH_SIZE];
+
+  memset(fh, 0, sizeof(fh));
+  fh[0] = (uint8_t) id;
+  put_opaque(enc, fh, sizeof(fh));
+}
+
+static void put_fattr(test_context *ctx, test_encoder *enc, file_id id)
+{
+  const test_file *f = &ctx->files[id];
+  int i;
+
+  put_u32(enc, f->type);
+  put_u32(enc, f->mode);
+  put_u32(enc, 1);
+  put_u32(enc, 0);
+  put_u32(enc, 0);
+  put_u32(enc, f->size);
+  put_u32(enc, MAX_DATA);
+  put_u32(enc, 0);
+  put_u32(enc, (f->size + 511) / 512);
+  put_u32(enc, 1);
+  put_u32(enc, (uint32_t) id + 2);
+
+  /* atime, mtime and ctime */
+  for (i = 0; i < 6; ++i) {
+    put_u32(enc, 0);
+  }
+}
+
+static void do_nfs(
+  test_context *ctx,
+  uint32_t proc,
+  test_decoder *dec,
+  test_encoder *enc
+)
+{
+  file_id id;
+  test_file *f;
+
+  if (proc < NFS_PROC_COUNT) {
+    ++ctx->calls[proc];
+  }
+
+  switch (proc) {
+    case NFS_PROC_NULL:
+      break;
+    case NFS_PROC_GETATTR:
+      id = get_fh(dec);
+      if (id < FILE_COUNT) {
+        put_u32(enc, 0);
+        put_fattr(ctx, enc, id);
+      } else {
+        put_u32(enc, NFS_ERR_STALE);
+      }
+      break;
+    case NFS_PROC_LOOKUP: {
+      uint32_t len;
+      const char *name;
+
+      get_fh(dec);
+      len = get_u32(dec);
+      name = (const char *) get_opaque(dec, len);
+
+      for (id = FILE_DATA; id < FILE_COUNT; ++id) {
+        f = &ctx->files[id];
+
+        if (strlen(f->name) == len && memcmp(f->name, name, len) == 0) {
+          break;
+        }
+      }
+
+      if (id < FILE_COUNT) {
+        put_u32(enc, 0);
+        put_fh(enc, id);
+        put_fattr(ctx, enc, id);
+      } else {
+        put_u32(enc, NFS_ERR_NOENT);
+      }
+      break;
+    }
+    case NFS_PROC_READ: {
+      uint32_t offset;
+      uint32_t count;
+
+      id = get_fh(dec);
+      offset = get_u32(dec);
+      count = get_u32(dec);
+      rtems_test_assert(id < FILE_COUNT);
+      rtems_test_assert(count <= MAX_DATA);
+
+      f = &ctx->files[id];
+
+      if (offset >= f->size) {
+        count = 0;
+      } else if (count > f->size - offset) {
+        count = f->size - offset;
+      }
+
+      put_u32(enc, 0);
+      put_fattr(ctx, enc, id);
+      put_u32(enc, count);
+      put_opaque(enc, &f->data[offset], count);
+      break;
+    }
+    case NFS_PROC_WRITE: {
+      uint32_t offset;
+      uint32_t count;
+      const uint8_t *data;
+
+      id = get_fh(dec);
+      get_u32(dec);
+      offset = get_u32(dec);
+      get_u32(dec);
+      count = get_u32(dec);
+      data = get_opaque(dec, count);
+      rtems_test_assert(id < FILE_COUNT);
+      rtems_test_assert(offset + count <= FILE_SIZE);
+
+      f = &ctx->files[id];
+
+      if (f->locked) {
+        put_u32(enc, NFS_ERR_ACCES);
+      } else {
+        memcpy(&f->data[offset], data, count);
+
+        if (offset + count > f->size) {
+          f->size = offset + count;
+        }
+
+        put_u32(enc, 0);
+        put_fattr(ctx, enc, id);
+      }
+      break;
+    }
+    default:
+      rtems_test_assert(0);
+      break;
+  }
+}
+
+static void serve(test_context *ctx, test_msg *msg)
+{
+  test_decoder dec = { &msg->buf[0], &msg->buf[msg->len] };
+  test_encoder enc = { &ctx->tx[0] };
+  uint32_t xid;
+  uint32_t prog;
+  uint32_t proc;
+  ssize_t n;
+
+  xid = get_u32(&dec);
+  rtems_test_assert(get_u32(&dec) == 0);
+  rtems_test_assert(get_u32(&dec) == 2);
+  prog = get_u32(&dec);
+  get_u32(&dec);
+  proc = get_u32(&dec);
+
+  /* credentials and verifier */
+  get_u32(&dec);
+  get_opaque(&dec, get_u32(&dec));
+  get_u32(&dec);
+  get_opaque(&dec, get_u32(&dec));
+
+  /* accepted reply with a null verifier */
+  put_u32(&enc, xid);
+  put_u32(&enc, 1);
+  put_u32(&enc, 0);
+  put_u32(&enc, 0);
+  put_u32(&enc, 0);
+  put_u32(&enc, 0);
+
+  switch (prog) {
+    case PMAP_PROG:
+      rtems_test_assert(proc == PMAP_PROC_GETPORT);
+      put_u32(&enc, PMAP_PORT);
+      break;
+    case MOUNT_PROG:
+      if (proc == MOUNT_PROC_MNT) {
+        put_u32(&enc, 0);
+        put_fh(&enc, FILE_ROOT);
+      } else {
+        rtems_test_assert(proc == MOUNT_PROC_UMNT);
+      }
+      break;
+    case NFS_PROG:
+      do_nfs(ctx, proc, &dec, &enc);
+      break;
+    default:
+      rtems_test_assert(0);
+      break;
+  }
+
+  n = sendto(
+    ctx->sd,
+    &ctx->tx[0],
+    (size_t) (enc.pos - &ctx->tx[0]),
+    0,
+    (struct sockaddr *) &msg->from,
+    sizeof(msg->from)
+  );
+  rtems_test_assert(n == enc.pos - &ctx->tx[0]);
+}
+
+static ssize_t receive(test_context *ctx, test_msg *msg, int flags)
+{
+  socklen_t len = sizeof(msg->from);
+  ssize_t n;
+
+  n = recvfrom(
+    ctx->sd,
+    &msg->buf[0],
+    sizeof(msg->buf),
+    flags,
+    (struct sockaddr *) &msg->from,
+    &len
+  );
+
+  if (n > 0) {
+    msg->len = (size_t) n;
+  }
+
+  return n;
+}
+
+static uint32_t nfs_proc_of(const test_msg *msg)
+{
+  uint32_t v[6];
+
+  memcpy(v, &msg->buf[0], sizeof(v));
+
+  return ntohl(v[3]) == NFS_PROG ? ntohl(v[5]) : NFS_PROC_COUNT;
+}
+
+static rtems_task server_task(rtems_task_argument arg)
+{
+  test_context *ctx = (test_context *) arg;
+
+  while (true) {
+    uint32_t batch[NFS_PROC_COUNT];
+    size_t count;
+    size_t i;
+    ssize_t n;
+
+    n = receive(ctx, &ctx->rx[0], 0);
+    rtems_test_assert(n > 0);
+    count = 1;
+
+    /* The requests the client sent while we did not run */
+    while (
+      count < BATCH_MAX
+        && receive(ctx, &ctx->rx[count], MSG_DONTWAIT) > 0
+    ) {
+      ++count;
+    }
+
+    memset(batch, 0, sizeof(batch));
+
+    for (i = 0; i < count; ++i) {
+      uint32_t proc = nfs_proc_of(&ctx->rx[i]);
+
+      if (proc < NFS_PROC_COUNT) {
+        ++batch[proc];
+
+        if (batch[proc] > ctx->max_batch[proc]) {
+          ctx->max_batch[proc] = batch[proc];
+        }
+      }
+
+      serve(ctx, &ctx->rx[i]);
+    }
+  }
+}
+
+static void start_server(test_context *ctx)
+{
+  struct sockaddr_in addr;
+  rtems_status_code sc;
+  test_file *f;
+  uint32_t i;
+  int rv;
+
+  f = &ctx->files[FILE_ROOT];
+  f->name = "";
+  f->type = NF_DIR;
+  f->mode = S_IFDIR | 0777;
+
+  f = &ctx->files[FILE_DATA];
+  f->name = "data";
+  f->type = NF_REG;
+  f->mode = S_IFREG | 0666;
+  f->size = FILE_SIZE;
+
+  for (i = 0; i < FILE_SIZE; ++i) {
+    f->data[i] = pattern(i);
+  }
+
+  f = &ctx->files[FILE_OUT];
+  f->name = "out";
+  f->type = NF_REG;
+  f->mode = S_IFREG | 0666;
+
+  /* The server denies writes despite the mode */
+  f = &ctx->files[FILE_LOCKED];
+  f->name = "locked";
+  f->type = NF_REG;
+  f->mode = S_IFREG | 0666;
+  f->locked = true;
+
+  ctx->sd = socket(PF_INET, SOCK_DGRAM, 0);
+  rtems_test_assert(ctx->sd >= 0);
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(PMAP_PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  rv = bind(ctx->sd, (struct sockaddr *) &addr, sizeof(addr));
+  rtems_test_assert(rv == 0);
+
+  sc = rtems_task_create(
+    rtems_build_name('N', 'F', 'S', 'D'),
+    SERVER_PRIORITY,
+    RTEMS_MINIMUM_STACK_SIZE,
+    RTEMS_DEFAULT_MODES,
+    RTEMS_DEFAULT_ATTRIBUTES,
+    &ctx->server_task
+  );
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  sc = rtems_task_start(ctx->server_task, server_task, (rtems_task_argument) ctx);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+}
+
+static void reset_counters(test_context *ctx)
+{
+  memset(ctx->calls, 0, sizeof(ctx->calls));
+  memset(ctx->max_batch, 0, sizeof(ctx->max_batch));
+}
+
+static void test_attribute_cache(test_context *ctx)
+{
+  struct stat st;
+  uint32_t lookups;
+  uint32_t getattrs;
+  int rv;
+
+  puts("nfs: attribute and lookup cache");
+
+  rv = stat(MOUNT_POINT "/data", &st);
+  rtems_test_assert(rv == 0);
+  rtems_test_assert(st.st_size == FILE_SIZE);
+
+  lookups = ctx->calls[NFS_PROC_LOOKUP];
+  getattrs = ctx->calls[NFS_PROC_GETATTR];
+  rtems_test_assert(lookups == 1);
+
+  /* Served from the caches */
+  rv = stat(MOUNT_POINT "/data", &st);
+  rtems_test_assert(rv == 0);
+  rtems_test_assert(st.st_size == FILE_SIZE);
+  rtems_test_assert(ctx->calls[NFS_PROC_LOOKUP] == lookups);
+  rtems_test_assert(ctx->calls[NFS_PROC_GETATTR] == getattrs);
+
+  rv = stat(MOUNT_POINT "/nix", &st);
+  rtems_test_assert(rv == -1);
+  rtems_test_assert(errno == ENOENT);
+
+  /* Without caches each stat() goes to the server */
+  nfsLookupLifetime = 0;
+  nfsAttrLifetime = 0;
+
+  lookups = ctx->calls[NFS_PROC_LOOKUP];
+  getattrs = ctx->calls[NFS_PROC_GETATTR];
+
+  rv = stat(MOUNT_POINT "/data", &st);
+  rtems_test_assert(rv == 0);
+  rtems_test_assert(ctx->calls[NFS_PROC_LOOKUP] == lookups + 1);
+  rtems_test_assert(ctx->calls[NFS_PROC_GETATTR] > getattrs);
+
+  nfsLookupLifetime = 3;
+  nfsAttrLifetime = 10;
+}
+
+static void read_file(test_context *ctx, size_t chunk)
+{
+  size_t done = 0;
+  uint32_t i;
+  int fd;
+  int rv;
+
+  fd = open(MOUNT_POINT "/data", O_RDONLY);
+  rtems_test_assert(fd >= 0);
+
+  while (true) {
+    ssize_t n = read(fd, &ctx->rx_buf[done], chunk);
+
+    rtems_test_assert(n >= 0);
+
+    if (n == 0) {
+      break;
+    }
+
+    done += (size_t) n;
+    rtems_test_assert(done <= FILE_SIZE);
+  }
+
+  rtems_test_assert(done == FILE_SIZE);
+
+  for (i = 0; i < FILE_SIZE; ++i) {
+    rtems_test_assert((uint8_t) ctx->rx_buf[i] == pattern(i));
+  }
+
+  /* Random access after the window */
+  rv = (int) lseek(fd, 1000, SEEK_SET);
+  rtems_test_assert(rv == 1000);
+  rv = (int) read(fd, &ctx->rx_buf[0], 10);
+  rtems_test_assert(rv == 10);
+
+  for (i = 0; i < 10; ++i) {
+    rtems_test_assert((uint8_t) ctx->rx_buf[i] == pattern(1000 + i));
+  }
+
+  rv = close(fd);
+  rtems_test_assert(rv == 0);
+}
+
+static void test_read_ahead(test_context *ctx)
+{
+  uint32_t reads;
+
+  puts("nfs: read-ahead");
+
+  nfsReadAheadDepth = 1;
+  reset_counters(ctx);
+  read_file(ctx, 1024);
+  rtems_test_assert(ctx->max_batch[NFS_PROC_READ] == 1);
+
+  nfsReadAheadDepth = 4;
+  reset_counters(ctx);
+  read_file(ctx, 1024);
+  rtems_test_assert(ctx->max_batch[NFS_PROC_READ] > 1);
+
+  /* Bigger than the window */
+  reset_counters(ctx);
+  read_file(ctx, FILE_SIZE);
+  rtems_test_assert(ctx->max_batch[NFS_PROC_READ] > 1);
+
+  /* The window expires even if the attributes are cached forever */
+  nfsAttrLifetime = -1;
+  reset_counters(ctx);
+  read_file(ctx, 1024);
+  reads = ctx->calls[NFS_PROC_READ];
+
+  nfsReadAheadLifetime = 0;
+  reset_counters(ctx);
+  read_file(ctx, 1024);
+  rtems_test_assert(ctx->calls[NFS_PROC_READ] > reads);
+
+  nfsReadAheadLifetime = 1;
+  nfsAttrLifetime = 10;
+}
+
+static void write_file(test_context *ctx)
+{
+  const test_file *f = &ctx->files[FILE_OUT];
+  char buf[MAX_DATA];
+  uint32_t offset;
+  uint32_t i;
+  int fd;
+  int rv;
+
+  fd = open(MOUNT_POINT "/out", O_WRONLY);
+  rtems_test_assert(fd >= 0);
+
+  for (offset = 0; offset < FILE_SIZE; offset += sizeof(buf)) {
+    ssize_t n;
+
+    for (i = 0; i < sizeof(buf); ++i) {
+      buf[i] = (char) pattern(offset + i);
+    }
+
+    n = write(fd, buf, sizeof(buf));
+    rtems_test_assert(n == (ssize_t) sizeof(buf));
+  }
+
+  rv = close(fd);
+  rtems_test_assert(rv == 0);
+
+  rtems_test_assert(f->size == FILE_SIZE);
+
+  for (i = 0; i < FILE_SIZE; ++i) {
+    rtems_test_assert(f->data[i] == pattern(i));
+  }
+}
+
+static void test_write_behind(test_context *ctx)
+{
+  char buf[16];
+  ssize_t n;
+  int fd;
+  int rv;
+
+  puts("nfs: write-behind");
+
+  nfsWriteBehindDepth = 0;
+  reset_counters(ctx);
+  write_file(ctx);
+  rtems_test_assert(ctx->max_batch[NFS_PROC_WRITE] == 1);
+
+  memset(ctx->files[FILE_OUT].data, 0, FILE_SIZE);
+  ctx->files[FILE_OUT].size = 0;
+
+  nfsWriteBehindDepth = 4;
+  reset_counters(ctx);
+  write_file(ctx);
+  rtems_test_assert(ctx->max_batch[NFS_PROC_WRITE] > 1);
+
+  /* Errors are reported later */
+  memset(buf, 0, sizeof(buf));
+
+  fd = open(MOUNT_POINT "/locked", O_WRONLY);
+  rtems_test_assert(fd >= 0);
+
+  n = write(fd, buf, sizeof(buf));
+  rtems_test_assert(n == (ssize_t) sizeof(buf));
+
+  errno = 0;
+  rv = fsync(fd);
+  rtems_test_assert(rv == -1);
+  rtems_test_assert(errno == EACCES);
+
+  rv = fsync(fd);
+  rtems_test_assert(rv == 0);
+
+  rv = close(fd);
+  rtems_test_assert(rv == 0);
+
+  /* Synchronous writes report them immediately */
+  nfsWriteBehindDepth = 0;
+
+  fd = open(MOUNT_POINT "/locked", O_WRONLY);
+  rtems_test_assert(fd >= 0);
+
+  errno = 0;
+  n = write(fd, buf, sizeof(buf));
+  rtems_test_assert(n == -1);
+  rtems_test_assert(errno == EACCES);
+
+  rv = close(fd);
+  rtems_test_assert(rv == 0);
+
+  nfsWriteBehindDepth = 4;
+}
+
+static void test(void)
+{
+  test_context *ctx = &test_instance;
+  int rv;
+
+  rv = rtems_bsdnet_initialize_network();
+  rtems_test_assert(rv == 0);
+
+  start_server(ctx);
+
+  rv = mkdir(MOUNT_POINT, 0777);
+  rtems_test_assert(rv == 0);
+
+  rv = mount(
+    "127.0.0.1:/export",
+    MOUNT_POINT,
+    RTEMS_FILESYSTEM_TYPE_NFS,
+    RTEMS_FILESYSTEM_READ_WRITE,
+    NULL
+  );
+  rtems_test_assert(rv == 0);
+
+  reset_counters(ctx);
+  test_attribute_cache(ctx);
+  test_read_ahead(ctx);
+  test_write_behind(ctx);
+
+  rv = unmount(MOUNT_POINT);
+  rtems_test_assert(rv == 0);
+}
+
+static rtems_task Init(rtems_task_argument argument)
+{
+  TEST_BEGIN();
+  test();
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_INIT
+
+#define CONFIGURE_MICROSECONDS_PER_TICK 10000
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_FILESYSTEM_IMFS
+#define CONFIGURE_FILESYSTEM_NFS
+
+#define CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS 16
+
+#define CONFIGURE_UNLIMITED_OBJECTS
+
+#define CONFIGURE_UNIFIED_WORK_AREAS
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_INIT_TASK_PRIORITY CLIENT_PRIORITY
+
+#define CONFIGURE_INIT_TASK_STACK_SIZE (16 * 1024)
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#include <rtems/confdefs.h>
@@ -0,0 +1,316 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rtems.h>
+#include <rtems/rtems_bsdnet.h>
+#include <librtemsNfs.h>
+#include <tmacros.h>
+
+/*
+ * Include the kernel mbuf header last, the network stack headers redefine
+ * malloc() and free().
+ */
+#define _KERNEL
+#include <sys/mbuf.h>
+
+const char rtems_test_name[] = "NFS 2";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+struct rtems_bsdnet_config rtems_bsdnet_config = {
+  .mbuf_bytecount = 128 * 1024,
+  .mbuf_cluster_bytecount = 256 * 1024
+};
+
+/* The size of NFS READ and WRITE data */
+#define DATA_SIZE 8192
+
+/* Pieces small enough to be copied by the mbuf XDR encoder */
+#define PIECE_SIZE 256
+
+#define ITERATIONS 4096
+
+typedef struct {
+  char data[DATA_SIZE];
+  char buf[DATA_SIZE + 64];
+  struct mbuf *reply;
+} test_context;
+
+static test_context test_instance;
+
+typedef void (*test_body)(test_context *ctx);
+
+static struct mbuf *get_header(void)
+{
+  struct mbuf *m;
+
+  rtems_bsdnet_semaphore_obtain();
+  MGETHDR(m, M_WAIT, MT_DATA);
+  rtems_bsdnet_semaphore_release();
+  rtems_test_assert(m != NULL);
+
+  m->m_len = 0;
+  m->m_pkthdr.len = 0;
+
+  return m;
+}
+
+static void free_chain(struct mbuf *m)
+{
+  rtems_bsdnet_semaphore_obtain();
+  m_freem(m);
+  rtems_bsdnet_semaphore_release();
+}
+
+/* Encode an opaque into a linear buffer like the RPC transactions do */
+static void encode_copy(test_context *ctx)
+{
+  XDR xdrs;
+  char *p = &ctx->data[0];
+  u_int len = DATA_SIZE;
+  bool_t ok;
+
+  xdrmem_create(&xdrs, &ctx->buf[0], sizeof(ctx->buf), XDR_ENCODE);
+  ok = xdr_bytes(&xdrs, &p, &len, DATA_SIZE);
+  rtems_test_assert(ok);
+  XDR_DESTROY(&xdrs);
+}
+
+/* Encode an opaque into an mbuf chain which references the data */
+static void encode_reference(test_context *ctx)
+{
+  XDR xdrs;
+  char *p = &ctx->data[0];
+  u_int len = DATA_SIZE;
+  struct mbuf *m = get_header();
+  bool_t ok;
+
+  xdrmbuf_create(&xdrs, m, XDR_ENCODE);
+  ok = xdr_bytes(&xdrs, &p, &len, DATA_SIZE);
+  rtems_test_assert(ok);
+  rtems_test_assert(XDR_GETPOS(&xdrs) == sizeof(uint32_t) + DATA_SIZE);
+  XDR_DESTROY(&xdrs);
+
+  free_chain(m);
+}
+
+/* Decode an opaque out of the reply chain into a buffer */
+static void decode_copy(test_context *ctx)
+{
+  XDR xdrs;
+  char *p = &ctx->buf[0];
+  u_int len;
+  bool_t ok;
+
+  xdrmbuf_create(&xdrs, ctx->reply, XDR_DECODE);
+  ok = xdr_bytes(&xdrs, &p, &len, DATA_SIZE);
+  rtems_test_assert(ok && len == DATA_SIZE);
+  XDR_DESTROY(&xdrs);
+}
+
+/* Decode an opaque out of the reply chain by reference */
+static void decode_iov(test_context *ctx)
+{
+  XDR xdrs;
+  struct iovec iov[32];
+  int iovcnt = RTEMS_ARRAY_SIZE(iov);
+  u_int len;
+  bool_t ok;
+
+  xdrmbuf_create(&xdrs, ctx->reply, XDR_DECODE);
+  ok = xdr_u_int(&xdrs, &len) && xdrmbuf_getiov(&xdrs, iov, &iovcnt, len);
+  rtems_test_assert(ok && len == DATA_SIZE && iovcnt > 0);
+  XDR_DESTROY(&xdrs);
+}
+
+static void build_reply(test_context *ctx)
+{
+  XDR xdrs;
+  u_int len = DATA_SIZE;
+  size_t i;
+  bool_t ok;
+
+  ctx->reply = get_header();
+
+  /* Copy the data in pieces to obtain a chain of clusters like a received
+   * datagram */
+  xdrmbuf_create(&xdrs, ctx->reply, XDR_ENCODE);
+  ok = xdr_u_int(&xdrs, &len);
+  rtems_test_assert(ok);
+
+  for (i = 0; i < DATA_SIZE; i += PIECE_SIZE) {
+    ok = XDR_PUTBYTES(&xdrs, &ctx->data[i], PIECE_SIZE);
+    rtems_test_assert(ok);
+  }
+
+  rtems_test_assert(XDR_GETPOS(&xdrs) == sizeof(uint32_t) + DATA_SIZE);
+  ctx->reply->m_pkthdr.len = (int) XDR_GETPOS(&xdrs);
+  XDR_DESTROY(&xdrs);
+  rtems_test_assert(ctx->reply->m_next != NULL);
+}
+
+static void test_encode_reference(test_context *ctx)
+{
+  XDR xdrs;
+  char *p = &ctx->data[0];
+  u_int len = DATA_SIZE;
+  u_int small = 0x12345678;
+  struct mbuf *m = get_header();
+  struct mbuf *ref;
+  bool_t ok;
+
+  xdrmbuf_create(&xdrs, m, XDR_ENCODE);
+  ok = xdr_u_int(&xdrs, &small) && xdr_bytes(&xdrs, &p, &len, DATA_SIZE)
+    && xdr_u_int(&xdrs, &small);
+  rtems_test_assert(ok);
+  rtems_test_assert(XDR_GETPOS(&xdrs) == 3 * sizeof(uint32_t) + DATA_SIZE);
+  XDR_DESTROY(&xdrs);
+
+  /* The data follows the two header words and is not copied */
+  rtems_test_assert(m->m_len == 2 * sizeof(uint32_t));
+  ref = m->m_next;
+  rtems_test_assert(ref != NULL);
+  rtems_test_assert(mtod(ref, char *) == &ctx->data[0]);
+  rtems_test_assert(ref->m_len == DATA_SIZE);
+  rtems_test_assert(ref->m_next != NULL);
+  rtems_test_assert(ref->m_next->m_len == sizeof(uint32_t));
+
+  free_chain(m);
+}
+
+static void test_decode_iov(test_context *ctx)
+{
+  XDR xdrs;
+  struct iovec iov[32];
+  int iovcnt = RTEMS_ARRAY_SIZE(iov);
+  size_t off = 0;
+  u_int len;
+  int i;
+  bool_t ok;
+
+  xdrmbuf_create(&xdrs, ctx->reply, XDR_DECODE);
+  ok = xdr_u_int(&xdrs, &len);
+  rtems_test_assert(ok && len == DATA_SIZE);
+
+  /* Too few iovecs leave the stream unchanged */
+  iovcnt = 1;
+  ok = xdrmbuf_getiov(&xdrs, iov, &iovcnt, len);
+  rtems_test_assert(!ok);
+  rtems_test_assert(XDR_GETPOS(&xdrs) == sizeof(uint32_t));
+
+  iovcnt = RTEMS_ARRAY_SIZE(iov);
+  ok = xdrmbuf_getiov(&xdrs, iov, &iovcnt, len);
+  rtems_test_assert(ok && iovcnt > 1);
+  rtems_test_assert(XDR_GETPOS(&xdrs) == sizeof(uint32_t) + DATA_SIZE);
+  XDR_DESTROY(&xdrs);
+
+  for (i = 0; i < iovcnt; ++i) {
+    rtems_test_assert(
+      memcmp(iov[i].iov_base, &ctx->data[off], iov[i].iov_len) == 0
+    );
+    off += iov[i].iov_len;
+  }
+
+  rtems_test_assert(off == DATA_SIZE);
+}
+
+static void measure(test_context *ctx, const char *name, test_body body)
+{
+  uint64_t t0;
+  uint64_t t1;
+  uint64_t bytes = (uint64_t) ITERATIONS * DATA_SIZE;
+  int i;
+
+  t0 = rtems_clock_get_uptime_nanoseconds();
+
+  for (i = 0; i < ITERATIONS; ++i) {
+    (*body)(ctx);
+  }
+
+  t1 = rtems_clock_get_uptime_nanoseconds();
+
+  if (t1 == t0) {
+    t1 = t0 + 1;
+  }
+
+  printf(
+    "  <%s>\n"
+    "    <Throughput unit=\"MiB/s\">%" PRIu64 "</Throughput>\n"
+    "  </%s>\n",
+    name,
+    (bytes * 1000000000) / ((t1 - t0) * 1024 * 1024),
+    name
+  );
+}
+
+static void test(void)
+{
+  test_context *ctx = &test_instance;
+  size_t i;
+  int rv;
+
+  rv = rtems_bsdnet_initialize_network();
+  rtems_test_assert(rv == 0);
+
+  for (i = 0; i < DATA_SIZE; ++i) {
+    ctx->data[i] = (char) i;
+  }
+
+  build_reply(ctx);
+  test_encode_reference(ctx);
+  test_decode_iov(ctx);
+
+  puts("<XdrMbuf>");
+  measure(ctx, "EncodeCopy", encode_copy);
+  measure(ctx, "EncodeReference", encode_reference);
+  measure(ctx, "DecodeCopy", decode_copy);
+  measure(ctx, "DecodeIov", decode_iov);
+  puts("</XdrMbuf>");
+
+  free_chain(ctx->reply);
+}
+
+static rtems_task Init(rtems_task_argument argument)
+{
+  TEST_BEGIN();
+  test();
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_INIT
+
+#define CONFIGURE_MICROSECONDS_PER_TICK 10000
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS 8
+
+#define CONFIGURE_UNLIMITED_OBJECTS
+
+#define CONFIGURE_UNIFIED_WORK_AREAS
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_INIT_TASK_STACK_SIZE (16 * 1024)
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#include <rtems/confdefs.h>
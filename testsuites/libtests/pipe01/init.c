@@ -0,0 +1,287 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "tmacros.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtems/libio.h>
+
+const char rtems_test_name[] = "PIPE 1";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+#define TRANSFER_SIZE (1024 * 1024)
+
+#define BLOCK_SIZE_MAX 4096
+
+#define PIPE_SIZE_MAX (64 * 1024)
+
+typedef struct {
+  int fds[2];
+  rtems_id writer;
+  size_t block;
+  char tx[BLOCK_SIZE_MAX];
+  char rx[BLOCK_SIZE_MAX];
+} test_context;
+
+static test_context test_instance;
+
+static void fill(char *buf, size_t n, size_t offset)
+{
+  size_t i;
+
+  for (i = 0; i < n; ++i) {
+    buf[i] = (char) ((offset + i) % 251);
+  }
+}
+
+static void set_size(test_context *ctx, int size, int expected)
+{
+  int rv;
+
+  rv = fcntl(ctx->fds[1], F_SETPIPE_SZ, size);
+  rtems_test_assert(rv == expected);
+
+  rv = fcntl(ctx->fds[0], F_GETPIPE_SZ);
+  rtems_test_assert(rv == expected);
+}
+
+static void check_size(test_context *ctx)
+{
+  ssize_t n;
+  int rv;
+
+  printf("check pipe buffer size\n");
+
+  rv = fcntl(ctx->fds[0], F_GETPIPE_SZ);
+  rtems_test_assert(rv == PIPE_BUF);
+
+  /* The size is rounded up to a power of two */
+  set_size(ctx, 3000, 4096);
+
+  rv = fcntl(ctx->fds[1], F_SETFL, O_NONBLOCK);
+  rtems_test_assert(rv == 0);
+
+  fill(ctx->tx, 4000, 0);
+  n = write(ctx->fds[1], ctx->tx, 4000);
+  rtems_test_assert(n == 4000);
+
+  errno = 0;
+  rv = fcntl(ctx->fds[1], F_SETPIPE_SZ, 1024);
+  rtems_test_assert(rv == -1);
+  rtems_test_assert(errno == EBUSY);
+
+  errno = 0;
+  rv = fcntl(ctx->fds[1], F_SETPIPE_SZ, -1);
+  rtems_test_assert(rv == -1);
+  rtems_test_assert(errno == EINVAL);
+
+  errno = 0;
+  rv = fcntl(ctx->fds[1], F_SETPIPE_SZ, 2 * 1024 * 1024);
+  rtems_test_assert(rv == -1);
+  rtems_test_assert(errno == EPERM);
+
+  /* The data in the pipe must survive a change of the size */
+  n = read(ctx->fds[0], ctx->rx, 1000);
+  rtems_test_assert(n == 1000);
+  set_size(ctx, PIPE_SIZE_MAX, PIPE_SIZE_MAX);
+  n = read(ctx->fds[0], ctx->rx + 1000, 3000);
+  rtems_test_assert(n == 3000);
+  rtems_test_assert(memcmp(ctx->tx, ctx->rx, 4000) == 0);
+
+  /* A full pipe accepts no more data */
+  set_size(ctx, BLOCK_SIZE_MAX, BLOCK_SIZE_MAX);
+  n = write(ctx->fds[1], ctx->tx, BLOCK_SIZE_MAX);
+  rtems_test_assert(n == BLOCK_SIZE_MAX);
+
+  errno = 0;
+  n = write(ctx->fds[1], ctx->tx, 1);
+  rtems_test_assert(n == -1);
+  rtems_test_assert(errno == EAGAIN);
+
+  n = read(ctx->fds[0], ctx->rx, BLOCK_SIZE_MAX);
+  rtems_test_assert(n == BLOCK_SIZE_MAX);
+  rtems_test_assert(memcmp(ctx->tx, ctx->rx, BLOCK_SIZE_MAX) == 0);
+
+  rv = fcntl(ctx->fds[1], F_SETFL, 0);
+  rtems_test_assert(rv == 0);
+
+  set_size(ctx, 0, PIPE_BUF);
+}
+
+static void writer(rtems_task_argument arg)
+{
+  test_context *ctx = (test_context *) arg;
+
+  while (true) {
+    rtems_status_code sc;
+    size_t offset = 0;
+
+    sc = rtems_event_transient_receive(RTEMS_WAIT, RTEMS_NO_TIMEOUT);
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+    while (offset < TRANSFER_SIZE) {
+      ssize_t n;
+
+      fill(ctx->tx, ctx->block, offset);
+      n = write(ctx->fds[1], ctx->tx, ctx->block);
+      rtems_test_assert(n == (ssize_t) ctx->block);
+      offset += ctx->block;
+    }
+  }
+}
+
+static uint64_t transfer(test_context *ctx, bool check)
+{
+  rtems_status_code sc;
+  uint64_t t0;
+  uint64_t t1;
+  size_t offset = 0;
+
+  t0 = rtems_clock_get_uptime_nanoseconds();
+
+  sc = rtems_event_transient_send(ctx->writer);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  while (offset < TRANSFER_SIZE) {
+    char expected[BLOCK_SIZE_MAX];
+    ssize_t n;
+
+    n = read(ctx->fds[0], ctx->rx, ctx->block);
+    rtems_test_assert(n > 0);
+
+    if (check) {
+      fill(expected, (size_t) n, offset);
+      rtems_test_assert(memcmp(ctx->rx, expected, (size_t) n) == 0);
+    }
+
+    offset += (size_t) n;
+  }
+
+  t1 = rtems_clock_get_uptime_nanoseconds();
+
+  rtems_test_assert(offset == TRANSFER_SIZE);
+
+  if (t1 == t0) {
+    t1 = t0 + 1;
+  }
+
+  return t1 - t0;
+}
+
+static void check_transfer(test_context *ctx)
+{
+  printf("check data transfer\n");
+
+  ctx->block = 100;
+  transfer(ctx, true);
+}
+
+static void measure(test_context *ctx, int size, size_t block)
+{
+  uint64_t ns;
+
+  set_size(ctx, size, size);
+  ctx->block = block;
+
+  ns = transfer(ctx, false);
+
+  printf(
+    "  <Throughput size=\"%i\" block=\"%zu\" unit=\"KB/s\">"
+      "%" PRIu64 "</Throughput>\n",
+    size,
+    block,
+    ((uint64_t) TRANSFER_SIZE * 1000000) / ns
+  );
+}
+
+static void test(void)
+{
+  static const int sizes[] = { PIPE_BUF, 4096, PIPE_SIZE_MAX };
+  static const size_t blocks[] = { 64, 512, BLOCK_SIZE_MAX };
+  test_context *ctx = &test_instance;
+  rtems_status_code sc;
+  size_t i;
+  size_t j;
+  int rv;
+
+  rv = pipe(ctx->fds);
+  rtems_test_assert(rv == 0);
+
+  check_size(ctx);
+
+  sc = rtems_task_create(
+    rtems_build_name('W', 'R', 'I', 'T'),
+    1,
+    RTEMS_MINIMUM_STACK_SIZE,
+    RTEMS_DEFAULT_MODES,
+    RTEMS_DEFAULT_ATTRIBUTES,
+    &ctx->writer
+  );
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  sc = rtems_task_start(ctx->writer, writer, (rtems_task_argument) ctx);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  check_transfer(ctx);
+
+  printf("<Pipe transfer=\"%d\">\n", TRANSFER_SIZE);
+
+  for (i = 0; i < RTEMS_ARRAY_SIZE(sizes); ++i) {
+    for (j = 0; j < RTEMS_ARRAY_SIZE(blocks); ++j) {
+      measure(ctx, sizes[i], blocks[j]);
+    }
+  }
+
+  printf("</Pipe>\n");
+}
+
+static void Init(rtems_task_argument arg)
+{
+  TEST_BEGIN();
+
+  test();
+
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS 5
+
+#define CONFIGURE_MAXIMUM_PIPES 1
+
+#define CONFIGURE_MAXIMUM_TASKS 2
+
+#define CONFIGURE_UNIFIED_WORK_AREAS
+
+#define CONFIGURE_MINIMUM_TASK_STACK_SIZE (8U * 1024U)
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#define CONFIGURE_INIT
+
+#include <rtems/confdefs.h>
@@ -0,0 +1,513 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtems.h>
+#include <rtems/rtems_bsdnet.h>
+#include <tmacros.h>
+
+const char rtems_test_name[] = "SENDFILE 1";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+struct rtems_bsdnet_config rtems_bsdnet_config = {
+  .mbuf_bytecount = 128 * 1024,
+  .mbuf_cluster_bytecount = 256 * 1024
+};
+
+#define PORT 1234
+
+#define FILE_PATH "/file"
+
+#define FILE_SIZE (256 * 1024)
+
+#define THROUGHPUT_ROUNDS 16
+
+/* Below the network daemon priority */
+#define TASK_PRIORITY 110
+
+#define EVENT_START RTEMS_EVENT_0
+
+#define EVENT_DONE RTEMS_EVENT_1
+
+typedef enum {
+  MODE_READ_SEND,
+  MODE_SENDFILE
+} test_mode;
+
+typedef struct {
+  rtems_id init_task;
+  rtems_id rx_task;
+  int listen_sd;
+  bool verify;
+  const char *hdr;
+  size_t hdr_len;
+  off_t offset;
+  size_t count;
+  const char *trl;
+  size_t trl_len;
+  size_t received;
+  bool ok;
+  char rx_buf[4096];
+  char tx_buf[4096];
+} test_context;
+
+static test_context test_instance;
+
+static uint8_t pattern(off_t pos)
+{
+  return (uint8_t) (pos * 7 + (pos >> 8));
+}
+
+static int expected(const test_context *ctx, size_t pos)
+{
+  if (pos < ctx->hdr_len) {
+    return (uint8_t) ctx->hdr[pos];
+  }
+
+  pos -= ctx->hdr_len;
+
+  if (pos < ctx->count) {
+    return pattern(ctx->offset + (off_t) pos);
+  }
+
+  pos -= ctx->count;
+
+  if (pos < ctx->trl_len) {
+    return (uint8_t) ctx->trl[pos];
+  }
+
+  return -1;
+}
+
+static void wait_for_events(rtems_event_set events)
+{
+  rtems_status_code sc;
+  rtems_event_set out;
+
+  sc = rtems_event_receive(
+    events,
+    RTEMS_EVENT_ALL | RTEMS_WAIT,
+    RTEMS_NO_TIMEOUT,
+    &out
+  );
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+}
+
+static void send_events(rtems_id task, rtems_event_set events)
+{
+  rtems_status_code sc;
+
+  sc = rtems_event_send(task, events);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+}
+
+static rtems_task rx_task(rtems_task_argument arg)
+{
+  test_context *ctx = (test_context *) arg;
+
+  while (true) {
+    struct sockaddr_in addr;
+    ssize_t n;
+    int sd;
+    int rv;
+
+    wait_for_events(EVENT_START);
+
+    sd = socket(PF_INET, SOCK_STREAM, 0);
+    rtems_test_assert(sd >= 0);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    rv = connect(sd, (struct sockaddr *) &addr, sizeof(addr));
+    rtems_test_assert(rv == 0);
+
+    ctx->received = 0;
+    ctx->ok = true;
+
+    while ((n = read(sd, &ctx->rx_buf[0], sizeof(ctx->rx_buf))) > 0) {
+      if (ctx->verify) {
+        ssize_t i;
+
+        for (i = 0; i < n; ++i) {
+          if (expected(ctx, ctx->received + (size_t) i)
+              != (uint8_t) ctx->rx_buf[i]) {
+            ctx->ok = false;
+          }
+        }
+      }
+
+      ctx->received += (size_t) n;
+    }
+
+    rtems_test_assert(n == 0);
+
+    rv = close(sd);
+    rtems_test_assert(rv == 0);
+
+    send_events(ctx->init_task, EVENT_DONE);
+  }
+}
+
+static void create_file(test_context *ctx)
+{
+  off_t pos = 0;
+  int fd;
+  int rv;
+
+  fd = open(FILE_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  rtems_test_assert(fd >= 0);
+
+  while (pos < FILE_SIZE) {
+    size_t i;
+    ssize_t n;
+
+    for (i = 0; i < sizeof(ctx->tx_buf); ++i) {
+      ctx->tx_buf[i] = (char) pattern(pos + (off_t) i);
+    }
+
+    n = write(fd, &ctx->tx_buf[0], sizeof(ctx->tx_buf));
+    rtems_test_assert(n == (ssize_t) sizeof(ctx->tx_buf));
+
+    pos += n;
+  }
+
+  rv = close(fd);
+  rtems_test_assert(rv == 0);
+}
+
+static void create_listen_socket(test_context *ctx)
+{
+  struct sockaddr_in addr;
+  int rv;
+
+  ctx->listen_sd = socket(PF_INET, SOCK_STREAM, 0);
+  rtems_test_assert(ctx->listen_sd >= 0);
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  rv = bind(ctx->listen_sd, (struct sockaddr *) &addr, sizeof(addr));
+  rtems_test_assert(rv == 0);
+
+  rv = listen(ctx->listen_sd, 1);
+  rtems_test_assert(rv == 0);
+}
+
+static off_t transfer(
+  test_context *ctx,
+  test_mode mode,
+  off_t offset,
+  size_t nbytes,
+  struct sf_hdtr *hdtr
+)
+{
+  off_t sbytes = 0;
+  int sd;
+  int fd;
+  int rv;
+
+  send_events(ctx->rx_task, EVENT_START);
+
+  sd = accept(ctx->listen_sd, NULL, NULL);
+  rtems_test_assert(sd >= 0);
+
+  fd = open(FILE_PATH, O_RDONLY);
+  rtems_test_assert(fd >= 0);
+
+  if (mode == MODE_SENDFILE) {
+    rv = sendfile(fd, sd, offset, nbytes, hdtr, &sbytes, 0);
+    rtems_test_assert(rv == 0);
+  } else {
+    ssize_t n;
+
+    rtems_test_assert(hdtr == NULL);
+
+    if (nbytes == 0) {
+      nbytes = FILE_SIZE;
+    }
+
+    rv = (int) lseek(fd, offset, SEEK_SET);
+    rtems_test_assert(rv == (int) offset);
+
+    while (
+      (off_t) nbytes > sbytes
+        && (n = read(fd, &ctx->tx_buf[0], sizeof(ctx->tx_buf))) > 0
+    ) {
+      ssize_t m = send(sd, &ctx->tx_buf[0], (size_t) n, 0);
+
+      rtems_test_assert(m == n);
+      sbytes += m;
+    }
+  }
+
+  rv = close(fd);
+  rtems_test_assert(rv == 0);
+
+  rv = close(sd);
+  rtems_test_assert(rv == 0);
+
+  wait_for_events(EVENT_DONE);
+
+  rtems_test_assert(ctx->received == (size_t) sbytes);
+
+  return sbytes;
+}
+
+static void set_expected(
+  test_context *ctx,
+  const char *hdr,
+  off_t offset,
+  size_t count,
+  const char *trl
+)
+{
+  ctx->verify = true;
+  ctx->hdr = hdr;
+  ctx->hdr_len = hdr != NULL ? strlen(hdr) : 0;
+  ctx->offset = offset;
+  ctx->count = count;
+  ctx->trl = trl;
+  ctx->trl_len = trl != NULL ? strlen(trl) : 0;
+}
+
+/*
+ * The receiver does not read until sendfile() would block, so the socket
+ * buffers fill up.
+ */
+static void test_nonblocking(test_context *ctx)
+{
+  struct sockaddr_in addr;
+  off_t total = 0;
+  off_t received = 0;
+  off_t sbytes;
+  int client_sd;
+  int sd;
+  int fd;
+  int rv;
+
+  puts("sendfile: non-blocking socket");
+
+  client_sd = socket(PF_INET, SOCK_STREAM, 0);
+  rtems_test_assert(client_sd >= 0);
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  rv = connect(client_sd, (struct sockaddr *) &addr, sizeof(addr));
+  rtems_test_assert(rv == 0);
+
+  sd = accept(ctx->listen_sd, NULL, NULL);
+  rtems_test_assert(sd >= 0);
+
+  rv = fcntl(sd, F_SETFL, O_NONBLOCK);
+  rtems_test_assert(rv == 0);
+
+  fd = open(FILE_PATH, O_RDONLY);
+  rtems_test_assert(fd >= 0);
+
+  /* Partial transfers report the count and succeed */
+  do {
+    sbytes = -1;
+    rv = sendfile(fd, sd, total, 0, NULL, &sbytes, 0);
+    if (rv == 0) {
+      rtems_test_assert(sbytes > 0);
+      total += sbytes;
+    }
+  } while (rv == 0);
+
+  /* Nothing could be sent */
+  rtems_test_assert(rv == -1);
+  rtems_test_assert(errno == EAGAIN);
+  rtems_test_assert(sbytes == 0);
+  rtems_test_assert(total > 0);
+  rtems_test_assert(total < FILE_SIZE);
+
+  while (received < total) {
+    ssize_t n;
+    ssize_t i;
+
+    n = read(client_sd, &ctx->rx_buf[0], sizeof(ctx->rx_buf));
+    rtems_test_assert(n > 0);
+
+    for (i = 0; i < n; ++i) {
+      rtems_test_assert((uint8_t) ctx->rx_buf[i] == pattern(received + i));
+    }
+
+    received += n;
+  }
+
+  rtems_test_assert(received == total);
+
+  rv = close(fd);
+  rtems_test_assert(rv == 0);
+
+  rv = close(sd);
+  rtems_test_assert(rv == 0);
+
+  rv = close(client_sd);
+  rtems_test_assert(rv == 0);
+}
+
+static void test_sendfile(test_context *ctx)
+{
+  static char hdr[] = "HEADER";
+  static char trl[] = "TRAILER";
+  struct iovec hdr_iov = { hdr, sizeof(hdr) - 1 };
+  struct iovec trl_iov = { trl, sizeof(trl) - 1 };
+  struct sf_hdtr hdtr = { &hdr_iov, 1, &trl_iov, 1 };
+  off_t sbytes;
+  int fd;
+  int rv;
+
+  puts("sendfile: whole file");
+  set_expected(ctx, NULL, 0, FILE_SIZE, NULL);
+  sbytes = transfer(ctx, MODE_SENDFILE, 0, 0, NULL);
+  rtems_test_assert(sbytes == FILE_SIZE);
+  rtems_test_assert(ctx->ok);
+
+  puts("sendfile: range with header and trailer");
+  set_expected(ctx, hdr, 1000, 5000, trl);
+  sbytes = transfer(ctx, MODE_SENDFILE, 1000, 5000, &hdtr);
+  rtems_test_assert(sbytes == (off_t) (5000 + strlen(hdr) + strlen(trl)));
+  rtems_test_assert(ctx->ok);
+
+  puts("sendfile: range beyond end of file");
+  set_expected(ctx, NULL, FILE_SIZE - 100, 100, NULL);
+  sbytes = transfer(ctx, MODE_SENDFILE, FILE_SIZE - 100, 1000, NULL);
+  rtems_test_assert(sbytes == 100);
+  rtems_test_assert(ctx->ok);
+
+  puts("sendfile: no socket");
+  fd = open(FILE_PATH, O_RDONLY);
+  rtems_test_assert(fd >= 0);
+  errno = 0;
+  rv = sendfile(fd, fd, 0, 0, NULL, &sbytes, 0);
+  rtems_test_assert(rv == -1);
+  rtems_test_assert(errno == ENOTSOCK);
+  rtems_test_assert(sbytes == 0);
+  rv = close(fd);
+  rtems_test_assert(rv == 0);
+
+  test_nonblocking(ctx);
+}
+
+static void test_throughput(test_context *ctx, test_mode mode, const char *name)
+{
+  uint64_t t0;
+  uint64_t t1;
+  uint64_t bytes;
+  int i;
+
+  ctx->verify = false;
+  bytes = 0;
+  t0 = rtems_clock_get_uptime_nanoseconds();
+
+  for (i = 0; i < THROUGHPUT_ROUNDS; ++i) {
+    bytes += (uint64_t) transfer(ctx, mode, 0, 0, NULL);
+  }
+
+  t1 = rtems_clock_get_uptime_nanoseconds();
+
+  printf(
+    "  <%s unit=\"KiB/s\">%" PRIu64 "</%s>\n",
+    name,
+    (bytes * UINT64_C(1000000000)) / (1024 * (t1 - t0 + 1)),
+    name
+  );
+}
+
+static void test(void)
+{
+  test_context *ctx = &test_instance;
+  rtems_status_code sc;
+  int rv;
+
+  ctx->init_task = rtems_task_self();
+
+  rv = rtems_bsdnet_initialize_network();
+  rtems_test_assert(rv == 0);
+
+  create_file(ctx);
+  create_listen_socket(ctx);
+
+  sc = rtems_task_create(
+    rtems_build_name('R', 'X', ' ', ' '),
+    TASK_PRIORITY,
+    RTEMS_MINIMUM_STACK_SIZE,
+    RTEMS_DEFAULT_MODES,
+    RTEMS_DEFAULT_ATTRIBUTES,
+    &ctx->rx_task
+  );
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  sc = rtems_task_start(ctx->rx_task, rx_task, (rtems_task_argument) ctx);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  test_sendfile(ctx);
+
+  puts("<LoopbackDownload>");
+  test_throughput(ctx, MODE_READ_SEND, "ReadSend");
+  test_throughput(ctx, MODE_SENDFILE, "Sendfile");
+  puts("</LoopbackDownload>");
+}
+
+static rtems_task Init(rtems_task_argument argument)
+{
+  TEST_BEGIN();
+  test();
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_INIT
+
+#define CONFIGURE_MICROSECONDS_PER_TICK 10000
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS 10
+
+#define CONFIGURE_IMFS_MEMFILE_BYTES_PER_BLOCK 512
+
+#define CONFIGURE_MAXIMUM_TASKS 4
+#define CONFIGURE_MAXIMUM_SEMAPHORES 2
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_INIT_TASK_PRIORITY TASK_PRIORITY
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#include <rtems/confdefs.h>
@@ -0,0 +1,543 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <sys/sockio.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtems.h>
+#include <rtems/rtems_bsdnet.h>
+#include <tmacros.h>
+
+/*
+ * Include the kernel mbuf header last, the network stack headers redefine
+ * malloc() and free().
+ */
+#define _KERNEL
+#include <sys/mbuf.h>
+
+const char rtems_test_name[] = "TCPOFFLOAD 1";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+/* Declared in <netinet/in.h> for the kernel only */
+int in_cksum(struct mbuf *m, int len);
+
+struct rtems_bsdnet_config rtems_bsdnet_config = {
+  .mbuf_bytecount = 256 * 1024,
+  .mbuf_cluster_bytecount = 1024 * 1024,
+  .tcp_tx_buf_size = 64 * 1024,
+  .tcp_rx_buf_size = 64 * 1024
+};
+
+#define PORT 1234
+
+/* Segment size of an Ethernet link */
+#define MSS 1448
+
+#define TRANSFER_SIZE (1024 * 1024)
+
+#define THROUGHPUT_ROUNDS 8
+
+#define CKSUM_SIZE 2048
+
+#define CKSUM_ROUNDS 4096
+
+/* Below the network daemon priority */
+#define TASK_PRIORITY 110
+
+#define EVENT_START RTEMS_EVENT_0
+
+#define EVENT_DONE RTEMS_EVENT_1
+
+typedef struct {
+  const char *name;
+  int capenable;
+  bool link0;
+} test_mode;
+
+/*
+ * With link0 set the loopback interface leaves the segmentation of TSO
+ * packets to the software fallback of ip_output().
+ */
+static const test_mode test_modes[] = {
+  { "NoOffload", 0, false },
+  { "ChecksumOffload", IFCAP_HWCSUM, false },
+  { "SoftwareSegmentation", IFCAP_TSO4, true },
+  { "SegmentationOffload", IFCAP_HWCSUM | IFCAP_TSO4, false }
+};
+
+typedef struct {
+  rtems_id init_task;
+  rtems_id rx_task;
+  int listen_sd;
+  size_t received;
+  bool ok;
+  char rx_buf[4096];
+  char tx_buf[16 * 1024];
+  uint8_t cksum_buf[CKSUM_SIZE + 4];
+} test_context;
+
+static test_context test_instance;
+
+static uint8_t pattern(size_t pos)
+{
+  return (uint8_t) (pos * 7 + (pos >> 8));
+}
+
+static void wait_for_events(rtems_event_set events)
+{
+  rtems_status_code sc;
+  rtems_event_set out;
+
+  sc = rtems_event_receive(
+    events,
+    RTEMS_EVENT_ALL | RTEMS_WAIT,
+    RTEMS_NO_TIMEOUT,
+    &out
+  );
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+}
+
+static void send_events(rtems_id task, rtems_event_set events)
+{
+  rtems_status_code sc;
+
+  sc = rtems_event_send(task, events);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+}
+
+static rtems_task rx_task(rtems_task_argument arg)
+{
+  test_context *ctx = (test_context *) arg;
+
+  while (true) {
+    struct sockaddr_in addr;
+    ssize_t n;
+    int sd;
+    int rv;
+
+    wait_for_events(EVENT_START);
+
+    sd = socket(PF_INET, SOCK_STREAM, 0);
+    rtems_test_assert(sd >= 0);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    rv = connect(sd, (struct sockaddr *) &addr, sizeof(addr));
+    rtems_test_assert(rv == 0);
+
+    ctx->received = 0;
+    ctx->ok = true;
+
+    while ((n = read(sd, &ctx->rx_buf[0], sizeof(ctx->rx_buf))) > 0) {
+      ssize_t i;
+
+      for (i = 0; i < n; ++i) {
+        if (pattern(ctx->received + (size_t) i) != (uint8_t) ctx->rx_buf[i]) {
+          ctx->ok = false;
+        }
+      }
+
+      ctx->received += (size_t) n;
+    }
+
+    rtems_test_assert(n == 0);
+
+    rv = close(sd);
+    rtems_test_assert(rv == 0);
+
+    send_events(ctx->init_task, EVENT_DONE);
+  }
+}
+
+static void create_listen_socket(test_context *ctx)
+{
+  struct sockaddr_in addr;
+  int rv;
+
+  ctx->listen_sd = socket(PF_INET, SOCK_STREAM, 0);
+  rtems_test_assert(ctx->listen_sd >= 0);
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  rv = bind(ctx->listen_sd, (struct sockaddr *) &addr, sizeof(addr));
+  rtems_test_assert(rv == 0);
+
+  rv = listen(ctx->listen_sd, 1);
+  rtems_test_assert(rv == 0);
+}
+
+static void set_mode(test_context *ctx, const test_mode *mode)
+{
+  struct ifreq ifr;
+  int rv;
+
+  memset(&ifr, 0, sizeof(ifr));
+  strncpy(&ifr.ifr_name[0], "lo0", sizeof(ifr.ifr_name));
+
+  rv = ioctl(ctx->listen_sd, SIOCGIFCAP, &ifr);
+  rtems_test_assert(rv == 0);
+  rtems_test_assert((ifr.ifr_reqcap & mode->capenable) == mode->capenable);
+
+  ifr.ifr_reqcap = mode->capenable;
+  rv = ioctl(ctx->listen_sd, SIOCSIFCAP, &ifr);
+  rtems_test_assert(rv == 0);
+
+  rv = ioctl(ctx->listen_sd, SIOCGIFCAP, &ifr);
+  rtems_test_assert(rv == 0);
+  rtems_test_assert(ifr.ifr_curcap == mode->capenable);
+
+  rv = ioctl(ctx->listen_sd, SIOCGIFFLAGS, &ifr);
+  rtems_test_assert(rv == 0);
+
+  if (mode->link0) {
+    ifr.ifr_flags |= IFF_LINK0;
+  } else {
+    ifr.ifr_flags &= ~IFF_LINK0;
+  }
+
+  rv = ioctl(ctx->listen_sd, SIOCSIFFLAGS, &ifr);
+  rtems_test_assert(rv == 0);
+}
+
+static void test_capabilities(test_context *ctx)
+{
+  struct ifreq ifr;
+  int rv;
+
+  puts("loopback capabilities");
+
+  memset(&ifr, 0, sizeof(ifr));
+  strncpy(&ifr.ifr_name[0], "lo0", sizeof(ifr.ifr_name));
+
+  rv = ioctl(ctx->listen_sd, SIOCGIFCAP, &ifr);
+  rtems_test_assert(rv == 0);
+  rtems_test_assert(ifr.ifr_reqcap == (IFCAP_HWCSUM | IFCAP_TSO4));
+  rtems_test_assert(ifr.ifr_curcap == ifr.ifr_reqcap);
+
+  ifr.ifr_reqcap = 0x8000;
+  errno = 0;
+  rv = ioctl(ctx->listen_sd, SIOCSIFCAP, &ifr);
+  rtems_test_assert(rv == -1);
+  rtems_test_assert(errno == EINVAL);
+}
+
+static void transfer(test_context *ctx)
+{
+  size_t sent = 0;
+  int mss = MSS;
+  int sd;
+  int rv;
+
+  send_events(ctx->rx_task, EVENT_START);
+
+  sd = accept(ctx->listen_sd, NULL, NULL);
+  rtems_test_assert(sd >= 0);
+
+  /* Limit the segment size of the loopback connection to Ethernet */
+  rv = setsockopt(sd, IPPROTO_TCP, TCP_MAXSEG, &mss, sizeof(mss));
+  rtems_test_assert(rv == 0);
+
+  while (sent < TRANSFER_SIZE) {
+    size_t i;
+    ssize_t n;
+
+    for (i = 0; i < sizeof(ctx->tx_buf); ++i) {
+      ctx->tx_buf[i] = (char) pattern(sent + i);
+    }
+
+    n = send(sd, &ctx->tx_buf[0], sizeof(ctx->tx_buf), 0);
+    rtems_test_assert(n == (ssize_t) sizeof(ctx->tx_buf));
+
+    sent += (size_t) n;
+  }
+
+  rv = close(sd);
+  rtems_test_assert(rv == 0);
+
+  wait_for_events(EVENT_DONE);
+
+  rtems_test_assert(ctx->received == TRANSFER_SIZE);
+  rtems_test_assert(ctx->ok);
+}
+
+static void test_transfer(test_context *ctx)
+{
+  size_t i;
+
+  for (i = 0; i < RTEMS_ARRAY_SIZE(test_modes); ++i) {
+    printf("transfer: %s\n", test_modes[i].name);
+    set_mode(ctx, &test_modes[i]);
+    transfer(ctx);
+  }
+}
+
+static void test_throughput(test_context *ctx, const test_mode *mode)
+{
+  uint64_t t0;
+  uint64_t t1;
+  uint64_t bytes;
+  int i;
+
+  set_mode(ctx, mode);
+  bytes = 0;
+  t0 = rtems_clock_get_uptime_nanoseconds();
+
+  for (i = 0; i < THROUGHPUT_ROUNDS; ++i) {
+    transfer(ctx);
+    bytes += TRANSFER_SIZE;
+  }
+
+  t1 = rtems_clock_get_uptime_nanoseconds();
+
+  printf(
+    "  <%s unit=\"KiB/s\">%" PRIu64 "</%s>\n",
+    mode->name,
+    (bytes * UINT64_C(1000000000)) / (1024 * (t1 - t0 + 1)),
+    mode->name
+  );
+}
+
+/* The checksum of RFC 1071, one 16-bit word at a time */
+static uint16_t reference_cksum(const uint8_t *p, size_t len)
+{
+  uint32_t sum = 0;
+  size_t i;
+
+  for (i = 0; i + 1 < len; i += 2) {
+    sum += (uint32_t) ((p[i] << 8) | p[i + 1]);
+  }
+
+  if (i < len) {
+    sum += (uint32_t) (p[i] << 8);
+  }
+
+  while (sum > 0xffff) {
+    sum = (sum & 0xffff) + (sum >> 16);
+  }
+
+  return htons((uint16_t) ~sum);
+}
+
+static struct mbuf *get_mbuf(void)
+{
+  struct mbuf *m;
+
+  rtems_bsdnet_semaphore_obtain();
+  MGET(m, M_WAIT, MT_DATA);
+  rtems_bsdnet_semaphore_release();
+  rtems_test_assert(m != NULL);
+
+  return m;
+}
+
+static void free_chain(struct mbuf *m)
+{
+  rtems_bsdnet_semaphore_obtain();
+  m_freem(m);
+  rtems_bsdnet_semaphore_release();
+}
+
+static int cksum(struct mbuf *m, int len)
+{
+  int sum;
+
+  rtems_bsdnet_semaphore_obtain();
+  sum = in_cksum(m, len);
+  rtems_bsdnet_semaphore_release();
+
+  return sum;
+}
+
+/*
+ * Split the data at random positions and alignments into mbufs, the sum must
+ * not depend on it.
+ */
+static void test_cksum(test_context *ctx)
+{
+  int i;
+
+  puts("in_cksum: unaligned chains");
+  srand(1);
+
+  for (i = 0; i < 1000; ++i) {
+    uint8_t data[512];
+    size_t len = 1 + (size_t) rand() % sizeof(data);
+    struct mbuf *head = NULL;
+    struct mbuf **next = &head;
+    size_t off = 0;
+    uint16_t sum;
+    size_t j;
+
+    for (j = 0; j < len; ++j) {
+      data[j] = (uint8_t) rand();
+    }
+
+    while (off < len) {
+      struct mbuf *m = get_mbuf();
+      size_t shift = (size_t) rand() % 4;
+      size_t n = 1 + (size_t) rand() % (MLEN - shift);
+
+      if (n > len - off) {
+        n = len - off;
+      }
+
+      m->m_data += shift;
+      m->m_len = (int) n;
+      memcpy(mtod(m, void *), &data[off], n);
+      off += n;
+      *next = m;
+      next = &m->m_next;
+    }
+
+    sum = (uint16_t) cksum(head, (int) len);
+    rtems_test_assert(sum == reference_cksum(&data[0], len));
+    free_chain(head);
+  }
+
+  (void) ctx;
+}
+
+static void measure_cksum(test_context *ctx, const char *name, size_t shift)
+{
+  struct mbuf m;
+  uint64_t t0;
+  uint64_t t1;
+  uint64_t bytes = (uint64_t) CKSUM_ROUNDS * CKSUM_SIZE;
+  int sum = 0;
+  int i;
+
+  /* A stand-alone mbuf describing the buffer is enough for in_cksum() */
+  memset(&m, 0, sizeof(m));
+  m.m_data = (caddr_t) &ctx->cksum_buf[shift];
+  m.m_len = CKSUM_SIZE;
+
+  t0 = rtems_clock_get_uptime_nanoseconds();
+
+  for (i = 0; i < CKSUM_ROUNDS; ++i) {
+    sum += in_cksum(&m, CKSUM_SIZE);
+  }
+
+  t1 = rtems_clock_get_uptime_nanoseconds();
+
+  rtems_test_assert(
+    (uint16_t) in_cksum(&m, CKSUM_SIZE)
+      == reference_cksum(&ctx->cksum_buf[shift], CKSUM_SIZE)
+  );
+
+  printf(
+    "  <%s unit=\"MiB/s\">%" PRIu64 "</%s>\n",
+    name,
+    (bytes * UINT64_C(1000000000)) / ((t1 - t0 + 1) * 1024 * 1024),
+    name
+  );
+
+  (void) sum;
+}
+
+static void test(void)
+{
+  test_context *ctx = &test_instance;
+  rtems_status_code sc;
+  size_t i;
+  int rv;
+
+  ctx->init_task = rtems_task_self();
+
+  rv = rtems_bsdnet_initialize_network();
+  rtems_test_assert(rv == 0);
+
+  create_listen_socket(ctx);
+
+  sc = rtems_task_create(
+    rtems_build_name('R', 'X', ' ', ' '),
+    TASK_PRIORITY,
+    RTEMS_MINIMUM_STACK_SIZE,
+    RTEMS_DEFAULT_MODES,
+    RTEMS_DEFAULT_ATTRIBUTES,
+    &ctx->rx_task
+  );
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  sc = rtems_task_start(ctx->rx_task, rx_task, (rtems_task_argument) ctx);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  test_capabilities(ctx);
+  test_cksum(ctx);
+  test_transfer(ctx);
+
+  for (i = 0; i < sizeof(ctx->cksum_buf); ++i) {
+    ctx->cksum_buf[i] = pattern(i);
+  }
+
+  puts("<InCksum>");
+  measure_cksum(ctx, "Aligned", 0);
+  measure_cksum(ctx, "Unaligned", 1);
+  puts("</InCksum>");
+
+  puts("<LoopbackTransfer>");
+
+  for (i = 0; i < RTEMS_ARRAY_SIZE(test_modes); ++i) {
+    test_throughput(ctx, &test_modes[i]);
+  }
+
+  puts("</LoopbackTransfer>");
+}
+
+static rtems_task Init(rtems_task_argument argument)
+{
+  TEST_BEGIN();
+  test();
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_INIT
+
+#define CONFIGURE_MICROSECONDS_PER_TICK 10000
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS 8
+
+#define CONFIGURE_MAXIMUM_TASKS 4
+#define CONFIGURE_MAXIMUM_SEMAPHORES 2
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_INIT_TASK_PRIORITY TASK_PRIORITY
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#include <rtems/confdefs.h>
@@ -0,0 +1,354 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "tmacros.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+
+#include <sys/ioctl.h>
+
+#include <rtems/libio.h>
+#include <rtems/termiostypes.h>
+
+const char rtems_test_name[] = "TERMIOS 9";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+#define MAJOR 123456789
+
+#define MINOR 0xdeadbeef
+
+#define RAW_INPUT_SIZE 4096
+
+#define BLOCK_SIZE 1024
+
+#define TRANSFER_SIZE (256 * 1024)
+
+/*
+ * A loopback device.  The test task plays the role of a DMA receive
+ * interrupt and hands blocks to Termios which are read back.
+ */
+typedef struct {
+  rtems_termios_device_context base;
+  rtems_termios_tty *tty;
+  rtems_libio_t iop;
+  char tx[BLOCK_SIZE];
+  char rx[BLOCK_SIZE];
+} test_context;
+
+static test_context test_instance;
+
+static bool loop_first_open(
+  rtems_termios_tty *tty,
+  rtems_termios_device_context *base,
+  struct termios *term,
+  rtems_libio_open_close_args_t *args
+)
+{
+  test_context *ctx = (test_context *) base;
+
+  (void) term;
+  (void) args;
+
+  ctx->tty = tty;
+
+  return true;
+}
+
+static void loop_write(
+  rtems_termios_device_context *base,
+  const char *buf,
+  size_t len
+)
+{
+  (void) base;
+  (void) buf;
+  (void) len;
+}
+
+static const rtems_termios_device_handler loop_handler = {
+  .first_open = loop_first_open,
+  .write = loop_write,
+  .mode = TERMIOS_IRQ_DRIVEN
+};
+
+static void open_loop(test_context *ctx)
+{
+  rtems_libio_open_close_args_t args;
+  rtems_status_code sc;
+
+  rtems_termios_device_context_initialize(&ctx->base, "loop");
+
+  sc = rtems_termios_bufsize(256, RAW_INPUT_SIZE, 64);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  sc = rtems_termios_device_install(
+    NULL,
+    MAJOR,
+    MINOR,
+    &loop_handler,
+    NULL,
+    &ctx->base
+  );
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  memset(&args, 0, sizeof(args));
+  args.iop = &ctx->iop;
+
+  sc = rtems_termios_device_open(MAJOR, MINOR, &args);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  rtems_test_assert(ctx->tty != NULL);
+}
+
+static void close_loop(test_context *ctx)
+{
+  rtems_libio_open_close_args_t args;
+  rtems_status_code sc;
+
+  memset(&args, 0, sizeof(args));
+  args.iop = &ctx->iop;
+
+  sc = rtems_termios_device_close(&args);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  sc = rtems_termios_device_remove(NULL, MAJOR, MINOR);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+}
+
+static void set_attributes(
+  test_context *ctx,
+  tcflag_t iflag,
+  tcflag_t lflag
+)
+{
+  rtems_libio_ioctl_args_t args;
+  struct termios term;
+  rtems_status_code sc;
+
+  memset(&term, 0, sizeof(term));
+  cfmakeraw(&term);
+  term.c_iflag |= iflag;
+  term.c_lflag |= lflag;
+  term.c_cflag |= CREAD | CLOCAL;
+  term.c_cc[VMIN] = 1;
+  term.c_cc[VTIME] = 0;
+
+  memset(&args, 0, sizeof(args));
+  args.iop = &ctx->iop;
+  args.command = RTEMS_IO_SET_ATTRIBUTES;
+  args.buffer = &term;
+
+  sc = rtems_termios_ioctl(&args);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+}
+
+static int enqueue(test_context *ctx, const char *buf, size_t n, bool bulk)
+{
+  int dropped = 0;
+
+  if (bulk) {
+    dropped = rtems_termios_enqueue_raw_characters(ctx->tty, buf, (int) n);
+  } else {
+    size_t i;
+
+    for (i = 0; i < n; ++i) {
+      dropped += rtems_termios_enqueue_raw_characters(ctx->tty, &buf[i], 1);
+    }
+  }
+
+  return dropped;
+}
+
+static size_t read_loop(test_context *ctx, char *buf, size_t n)
+{
+  rtems_libio_rw_args_t args;
+  rtems_status_code sc;
+
+  memset(&args, 0, sizeof(args));
+  args.iop = &ctx->iop;
+  args.buffer = buf;
+  args.count = n;
+
+  sc = rtems_termios_read(&args);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  return args.bytes_moved;
+}
+
+/*
+ * Receive exactly n characters.  The cooked buffer limits the characters
+ * returned per read in case the input is processed.
+ */
+static void receive(test_context *ctx, char *buf, size_t n)
+{
+  while (n > 0) {
+    size_t m = read_loop(ctx, buf, n);
+
+    rtems_test_assert(m > 0);
+    buf += m;
+    n -= m;
+  }
+}
+
+static void fill_block(test_context *ctx, unsigned int seed)
+{
+  size_t i;
+
+  for (i = 0; i < BLOCK_SIZE; ++i) {
+    ctx->tx[i] = (char) ('a' + (i + seed) % 26);
+  }
+}
+
+static void check_raw(test_context *ctx)
+{
+  static const size_t sizes[] = { 1, 7, 100, 1000, BLOCK_SIZE };
+  unsigned int seed = 0;
+  size_t i;
+  size_t j;
+  int dropped;
+
+  printf("check raw mode transfers\n");
+
+  set_attributes(ctx, 0, 0);
+
+  /* Enough transfers to wrap around the raw input buffer several times */
+  for (i = 0; i < 4 * RAW_INPUT_SIZE / BLOCK_SIZE; ++i) {
+    for (j = 0; j < RTEMS_ARRAY_SIZE(sizes); ++j) {
+      size_t n = sizes[j];
+
+      fill_block(ctx, seed++);
+      dropped = enqueue(ctx, ctx->tx, n, true);
+      rtems_test_assert(dropped == 0);
+      receive(ctx, ctx->rx, n);
+      rtems_test_assert(memcmp(ctx->tx, ctx->rx, n) == 0);
+    }
+  }
+
+  printf("check raw input buffer overflow\n");
+
+  fill_block(ctx, seed);
+
+  for (i = 0; i < RAW_INPUT_SIZE / BLOCK_SIZE - 1; ++i) {
+    dropped = enqueue(ctx, ctx->tx, BLOCK_SIZE, true);
+    rtems_test_assert(dropped == 0);
+  }
+
+  dropped = enqueue(ctx, ctx->tx, BLOCK_SIZE, true);
+  rtems_test_assert(dropped == 1);
+
+  for (i = 0; i < RAW_INPUT_SIZE / BLOCK_SIZE; ++i) {
+    size_t n = i + 1 < RAW_INPUT_SIZE / BLOCK_SIZE ?
+      BLOCK_SIZE : BLOCK_SIZE - 1;
+
+    receive(ctx, ctx->rx, n);
+    rtems_test_assert(memcmp(ctx->tx, ctx->rx, n) == 0);
+  }
+
+  printf("check processed input\n");
+
+  set_attributes(ctx, ICRNL, 0);
+  dropped = enqueue(ctx, "a\rb", 3, true);
+  rtems_test_assert(dropped == 0);
+  receive(ctx, ctx->rx, 3);
+  rtems_test_assert(memcmp(ctx->rx, "a\nb", 3) == 0);
+}
+
+static void measure(
+  test_context *ctx,
+  const char *label,
+  tcflag_t iflag,
+  bool bulk
+)
+{
+  uint64_t t0;
+  uint64_t t1;
+  size_t i;
+
+  set_attributes(ctx, iflag, 0);
+  fill_block(ctx, 0);
+
+  t0 = rtems_clock_get_uptime_nanoseconds();
+
+  for (i = 0; i < TRANSFER_SIZE / BLOCK_SIZE; ++i) {
+    int dropped = enqueue(ctx, ctx->tx, BLOCK_SIZE, bulk);
+
+    rtems_test_assert(dropped == 0);
+    receive(ctx, ctx->rx, BLOCK_SIZE);
+  }
+
+  t1 = rtems_clock_get_uptime_nanoseconds();
+
+  rtems_test_assert(memcmp(ctx->tx, ctx->rx, BLOCK_SIZE) == 0);
+
+  if (t1 == t0) {
+    t1 = t0 + 1;
+  }
+
+  printf(
+    "  <%s unit=\"KB/s\">%" PRIu64 "</%s>\n",
+    label,
+    ((uint64_t) TRANSFER_SIZE * 1000000) / (t1 - t0),
+    label
+  );
+}
+
+static void test(void)
+{
+  test_context *ctx = &test_instance;
+
+  open_loop(ctx);
+
+  check_raw(ctx);
+
+  printf("<TermiosLoopback block=\"%d\">\n", BLOCK_SIZE);
+  measure(ctx, "Raw", 0, true);
+  measure(ctx, "RawCharByChar", 0, false);
+  measure(ctx, "Processed", ICRNL, true);
+  measure(ctx, "FlowControl", IXOFF, true);
+  printf("</TermiosLoopback>\n");
+
+  close_loop(ctx);
+}
+
+static void Init(rtems_task_argument arg)
+{
+  TEST_BEGIN();
+
+  test();
+
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+/* one for the console and one for the loopback device */
+#define CONFIGURE_NUMBER_OF_TERMIOS_PORTS 2
+
+#define CONFIGURE_MAXIMUM_TASKS 1
+
+#define CONFIGURE_UNIFIED_WORK_AREAS
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#define CONFIGURE_INIT
+
+#include <rtems/confdefs.h>
@@ -0,0 +1,233 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "tmacros.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zlib.h>
+
+const char rtems_test_name[] = "ZLIB 1";
+
+/* forward declarations to avoid warnings */
+static rtems_task Init(rtems_task_argument argument);
+
+#define DATA_SIZE (64 * 1024)
+
+#define ITERATIONS 16
+
+typedef struct {
+  unsigned char data[DATA_SIZE];
+  unsigned char compressed[DATA_SIZE + DATA_SIZE / 8];
+  unsigned char out[DATA_SIZE];
+  uLongf compressed_size;
+} test_context;
+
+static test_context test_instance;
+
+/*
+ * Fill the data with words from a small vocabulary so it compresses about as
+ * well as text and code, with runs to exercise overlapped match copies.
+ */
+static void build_data(test_context *ctx)
+{
+  static const char * const words[] = {
+    "rtems ", "task ", "semaphore ", "the ", "of ", "interrupt ", "0000",
+    "\n\t", "if (", ") {\n", "return ", "------"
+  };
+  uint32_t seed = 123;
+  size_t i = 0;
+
+  while (i < DATA_SIZE) {
+    const char *w;
+    size_t n;
+
+    seed = seed * 1103515245 + 12345;
+    w = words[(seed >> 16) % RTEMS_ARRAY_SIZE(words)];
+    n = strlen(w);
+
+    if (n > DATA_SIZE - i) {
+      n = DATA_SIZE - i;
+    }
+
+    memcpy(&ctx->data[i], w, n);
+    i += n;
+  }
+}
+
+static uint64_t now(void)
+{
+  return rtems_clock_get_uptime_nanoseconds();
+}
+
+/* MB/s */
+static uint64_t rate(uint64_t t0, uint64_t t1)
+{
+  if (t1 == t0) {
+    t1 = t0 + 1;
+  }
+
+  return ((uint64_t) ITERATIONS * DATA_SIZE * 1000) / (t1 - t0);
+}
+
+static void measure_crc32(test_context *ctx, const char *label, size_t offset)
+{
+  uLong crc = 0;
+  uint64_t t0;
+  uint64_t t1;
+  int i;
+
+  t0 = now();
+
+  for (i = 0; i < ITERATIONS; ++i) {
+    crc = crc32(0, &ctx->data[offset], DATA_SIZE - offset);
+  }
+
+  t1 = now();
+
+  rtems_test_assert(crc != 0);
+
+  printf(
+    "  <%s unit=\"MB/s\">%" PRIu64 "</%s>\n",
+    label,
+    rate(t0, t1),
+    label
+  );
+}
+
+static void measure_adler32(test_context *ctx)
+{
+  uLong adler = 0;
+  uint64_t t0;
+  uint64_t t1;
+  int i;
+
+  t0 = now();
+
+  for (i = 0; i < ITERATIONS; ++i) {
+    adler = adler32(1, ctx->data, DATA_SIZE);
+  }
+
+  t1 = now();
+
+  rtems_test_assert(adler != 1);
+
+  printf("  <Adler32 unit=\"MB/s\">%" PRIu64 "</Adler32>\n", rate(t0, t1));
+}
+
+static void measure_inflate(test_context *ctx)
+{
+  uint64_t t0;
+  uint64_t t1;
+  int i;
+
+  t0 = now();
+
+  for (i = 0; i < ITERATIONS; ++i) {
+    uLongf size = sizeof(ctx->out);
+    int rv;
+
+    rv = uncompress(ctx->out, &size, ctx->compressed, ctx->compressed_size);
+    rtems_test_assert(rv == Z_OK);
+    rtems_test_assert(size == DATA_SIZE);
+  }
+
+  t1 = now();
+
+  rtems_test_assert(memcmp(ctx->data, ctx->out, DATA_SIZE) == 0);
+
+  printf("  <Inflate unit=\"MB/s\">%" PRIu64 "</Inflate>\n", rate(t0, t1));
+}
+
+/*
+ * Check values from a reference implementation.
+ */
+static void check_values(void)
+{
+  static const unsigned char check[] = "123456789";
+  static unsigned char bytes[1000];
+  size_t i;
+
+  rtems_test_assert(crc32(0, check, 9) == 0xcbf43926);
+  rtems_test_assert(adler32(1, check, 9) == 0x091e01de);
+
+  for (i = 0; i < sizeof(bytes); ++i) {
+    bytes[i] = (unsigned char) (i * 7 + (i >> 3));
+  }
+
+  /* All alignments and tail lengths of the word at a time loops */
+  for (i = 0; i < 16; ++i) {
+    uLong crc = crc32(0, bytes, (uInt) i);
+    uLong adler = adler32(1, bytes, (uInt) i);
+
+    crc = crc32(crc, &bytes[i], (uInt) (sizeof(bytes) - i));
+    adler = adler32(adler, &bytes[i], (uInt) (sizeof(bytes) - i));
+
+    rtems_test_assert(crc == crc32(0, bytes, sizeof(bytes)));
+    rtems_test_assert(adler == adler32(1, bytes, sizeof(bytes)));
+  }
+}
+
+static void test(void)
+{
+  test_context *ctx = &test_instance;
+  int rv;
+
+  check_values();
+
+  build_data(ctx);
+
+  ctx->compressed_size = sizeof(ctx->compressed);
+  rv = compress(ctx->compressed, &ctx->compressed_size, ctx->data, DATA_SIZE);
+  rtems_test_assert(rv == Z_OK);
+
+  printf(
+    "<ZLib size=\"%d\" compressed=\"%lu\">\n",
+    DATA_SIZE,
+    (unsigned long) ctx->compressed_size
+  );
+  measure_crc32(ctx, "Crc32", 0);
+  measure_crc32(ctx, "Crc32Unaligned", 1);
+  measure_adler32(ctx);
+  measure_inflate(ctx);
+  printf("</ZLib>\n");
+}
+
+static void Init(rtems_task_argument arg)
+{
+  TEST_BEGIN();
+
+  test();
+
+  TEST_END();
+
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_MAXIMUM_TASKS 1
+
+#define CONFIGURE_UNIFIED_WORK_AREAS
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#define CONFIGURE_INIT
+
+#include <rtems/confdefs.h>
@@ -0,0 +1,741 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "tmacros.h"
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtems/captureimpl.h>
+#include <rtems/test.h>
+
+const char rtems_test_name[] = "SMPCAPTURE 3";
+
+#define CPU_COUNT 32
+
+/* Large enough for a record which does not fit into a CTF packet */
+#define BUFFER_SIZE 8192
+
+#define CTF_RECORDS 16
+
+/*
+ * Layout of the CTF packet header and event records, see capture_ctf.c.
+ */
+#define CTF_PACKET_HEADER_SIZE 48
+
+#define CTF_EVENT_SIZE 32
+
+typedef struct {
+  uint32_t a;
+  uint32_t b;
+} __attribute__ ((aligned (8))) test_record;
+
+#define RECORD_SIZE (sizeof(rtems_capture_record_t) + sizeof(test_record))
+
+typedef struct {
+  uint32_t first;
+  uint32_t count;
+  uint32_t reads;
+} test_read_result;
+
+typedef struct {
+  rtems_test_parallel_context base;
+  int fd;
+  uint8_t ctf[CTF_PACKET_HEADER_SIZE + CTF_RECORDS * CTF_EVENT_SIZE];
+  uint32_t record_ops[CPU_COUNT][CPU_COUNT];
+  uint32_t record_drop_ops[CPU_COUNT][CPU_COUNT];
+  uint32_t record_stream_ops[CPU_COUNT][CPU_COUNT];
+} test_context;
+
+static test_context test_instance;
+
+static rtems_interval test_duration(void)
+{
+  return rtems_clock_get_ticks_per_second();
+}
+
+static void test_prepare(bool overwrite)
+{
+  rtems_status_code sc;
+
+  sc = rtems_capture_control(false);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  sc = rtems_capture_flush(true);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  sc = rtems_capture_overwrite(overwrite);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  sc = rtems_capture_control(true);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+}
+
+static void test_fini(
+  const char *name,
+  uint32_t *counters,
+  size_t active_workers
+)
+{
+  size_t i;
+
+  printf("  <%s activeWorker=\"%zu\">\n", name, active_workers);
+
+  for (i = 0; i < active_workers; ++i) {
+    printf(
+      "    <Counter worker=\"%zu\">%" PRIu32 "</Counter>\n",
+      i,
+      counters[i]
+    );
+  }
+
+  printf("  </%s>\n", name);
+}
+
+static void add_record(uint32_t counter)
+{
+  test_record rec;
+  void *ptr;
+
+  rec.a = counter;
+  rec.b = ~counter;
+
+  rtems_capture_begin_add_record(
+    _Thread_Get_executing(),
+    RTEMS_CAPTURE_TIMESTAMP,
+    RECORD_SIZE,
+    &ptr
+  );
+
+  /* The record is dropped if the buffer is full */
+  if (ptr != NULL) {
+    ptr = rtems_capture_append_to_record(ptr, &rec, sizeof(rec));
+  }
+
+  rtems_capture_end_add_record(ptr);
+}
+
+static uint32_t test_add_records(test_context *ctx)
+{
+  uint32_t counter = 0;
+
+  while (!rtems_test_parallel_stop_job(&ctx->base)) {
+    add_record(counter);
+    ++counter;
+  }
+
+  return counter;
+}
+
+static const test_record *get_test_record(const rtems_capture_record_t *rec)
+{
+  if (
+    rec->size == RECORD_SIZE
+      && (rec->events & RTEMS_CAPTURE_TIMESTAMP) != 0
+  ) {
+    return (const test_record *) (rec + 1);
+  }
+
+  return NULL;
+}
+
+static void read_all(uint32_t cpu, test_read_result *result)
+{
+  result->first = 0;
+  result->count = 0;
+  result->reads = 0;
+
+  while (true) {
+    rtems_status_code sc;
+    rtems_capture_record_t *rec;
+    uint32_t read;
+    uint32_t i;
+
+    sc = rtems_capture_read(cpu, &read, &rec);
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+    for (i = 0; i < read; ++i) {
+      const test_record *data = get_test_record(rec);
+
+      rtems_test_assert(data != NULL);
+      rtems_test_assert(data->b == ~data->a);
+
+      if (result->count == 0) {
+        result->first = data->a;
+      } else {
+        rtems_test_assert(data->a == result->first + result->count);
+      }
+
+      ++result->count;
+      rec = (rtems_capture_record_t *) ((uint8_t *) rec + rec->size);
+    }
+
+    sc = rtems_capture_release(cpu, read);
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+    if (read == 0) {
+      break;
+    }
+
+    ++result->reads;
+  }
+
+  /* The records are released */
+  rtems_test_assert(rtems_capture_release(cpu, 0) == RTEMS_UNSATISFIED);
+}
+
+static void check_wrap_around(void)
+{
+  uint32_t cpu = rtems_get_current_processor();
+  uint32_t n = (BUFFER_SIZE * 3 / 4) / RECORD_SIZE;
+  uint32_t counter = 0;
+  uint32_t reads = 0;
+  int pass;
+
+  puts("check wrap-around");
+
+  test_prepare(false);
+
+  /*
+   * The second pass crosses the end of the buffer, so its records are
+   * returned by two reads.
+   */
+  for (pass = 0; pass < 2; ++pass) {
+    test_read_result result;
+    uint32_t i;
+
+    for (i = 0; i < n; ++i) {
+      add_record(counter + i);
+    }
+
+    read_all(cpu, &result);
+    rtems_test_assert(result.first == counter);
+    rtems_test_assert(result.count == n);
+
+    reads += result.reads;
+    counter += n;
+  }
+
+  rtems_test_assert(reads == 3);
+  rtems_test_assert(rtems_capture_dropped(cpu) == 0);
+  rtems_test_assert(rtems_get_current_processor() == cpu);
+}
+
+static void check_drop(void)
+{
+  uint32_t cpu = rtems_get_current_processor();
+  uint32_t n = 2 * BUFFER_SIZE / RECORD_SIZE;
+  test_read_result result;
+  uint32_t i;
+
+  puts("check drop of new records");
+
+  test_prepare(false);
+
+  for (i = 0; i < n; ++i) {
+    add_record(i);
+  }
+
+  /* The oldest records are kept */
+  read_all(cpu, &result);
+  rtems_test_assert(result.first == 0);
+  rtems_test_assert(result.count > 0);
+  rtems_test_assert(result.count < n);
+  rtems_test_assert(result.count + rtems_capture_dropped(cpu) == n);
+  rtems_test_assert(rtems_get_current_processor() == cpu);
+}
+
+static void check_overwrite(void)
+{
+  uint32_t cpu = rtems_get_current_processor();
+  uint32_t n = 2 * BUFFER_SIZE / RECORD_SIZE;
+  test_read_result result;
+  uint32_t i;
+
+  puts("check overwrite of old records");
+
+  test_prepare(true);
+
+  for (i = 0; i < n; ++i) {
+    add_record(i);
+  }
+
+  /* The newest records are kept */
+  read_all(cpu, &result);
+  rtems_test_assert(result.count > 0);
+  rtems_test_assert(result.first > 0);
+  rtems_test_assert(result.first + result.count == n);
+  rtems_test_assert(result.count + rtems_capture_dropped(cpu) == n);
+  rtems_test_assert(rtems_get_current_processor() == cpu);
+}
+
+static void check_flush(void)
+{
+  uint32_t cpu = rtems_get_current_processor();
+  rtems_capture_record_t *rec;
+  test_read_result result;
+  rtems_status_code sc;
+  uint32_t read;
+
+  puts("check flush");
+
+  test_prepare(false);
+  add_record(0);
+
+  sc = rtems_capture_control(false);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  /* A flush must not discard records held by a reader */
+  sc = rtems_capture_read(cpu, &read, &rec);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  rtems_test_assert(read == 1);
+
+  sc = rtems_capture_flush(false);
+  rtems_test_assert(sc == RTEMS_RESOURCE_IN_USE);
+
+  sc = rtems_capture_release(cpu, read);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  /* A release without a read fails */
+  sc = rtems_capture_release(cpu, 1);
+  rtems_test_assert(sc == RTEMS_UNSATISFIED);
+
+  add_record(1);
+
+  sc = rtems_capture_flush(false);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  read_all(cpu, &result);
+  rtems_test_assert(result.count == 0);
+  rtems_test_assert(rtems_get_current_processor() == cpu);
+}
+
+static uint32_t get_uint32(const uint8_t *data, size_t offset)
+{
+  uint32_t value;
+
+  memcpy(&value, &data[offset], sizeof(value));
+
+  return value;
+}
+
+static uint64_t get_uint64(const uint8_t *data, size_t offset)
+{
+  uint64_t value;
+
+  memcpy(&value, &data[offset], sizeof(value));
+
+  return value;
+}
+
+static void check_ctf(test_context *ctx)
+{
+  static const char metadata_begin[] = "/* CTF 1.8 */";
+  uint32_t cpu = rtems_get_current_processor();
+  const uint8_t *packet = ctx->ctf;
+  size_t packet_size = sizeof(ctx->ctf);
+  char metadata[sizeof(metadata_begin) - 1];
+  rtems_status_code sc;
+  uint32_t written;
+  uint32_t dropped;
+  uint64_t time;
+  off_t metadata_size;
+  off_t size;
+  ssize_t n;
+  uint32_t i;
+  int fd;
+  int rv;
+
+  puts("check CTF output");
+
+  test_prepare(false);
+
+  for (i = 0; i < CTF_RECORDS; ++i) {
+    add_record(i);
+  }
+
+  fd = open("/ctf", O_RDWR | O_CREAT | O_TRUNC, S_IRWXU);
+  rtems_test_assert(fd >= 0);
+
+  sc = rtems_capture_ctf_write_metadata(fd);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  metadata_size = lseek(fd, 0, SEEK_CUR);
+  rtems_test_assert(metadata_size > 0);
+
+  sc = rtems_capture_ctf_write_packets(fd, cpu, &written, &dropped);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  rtems_test_assert(written == CTF_RECORDS);
+  rtems_test_assert(dropped == 0);
+
+  /* The records are consumed */
+  sc = rtems_capture_ctf_write_packets(fd, cpu, &written, &dropped);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  rtems_test_assert(written == 0);
+  rtems_test_assert(dropped == 0);
+
+  size = lseek(fd, 0, SEEK_CUR);
+  rtems_test_assert(size == metadata_size + (off_t) packet_size);
+
+  rv = lseek(fd, 0, SEEK_SET);
+  rtems_test_assert(rv == 0);
+
+  n = read(fd, metadata, sizeof(metadata));
+  rtems_test_assert(n == (ssize_t) sizeof(metadata));
+  rtems_test_assert(memcmp(metadata, metadata_begin, sizeof(metadata)) == 0);
+
+  rv = lseek(fd, metadata_size, SEEK_SET);
+  rtems_test_assert(rv == metadata_size);
+
+  n = read(fd, ctx->ctf, packet_size);
+  rtems_test_assert(n == (ssize_t) packet_size);
+
+  /* Packet header and context */
+  rtems_test_assert(get_uint32(packet, 0) == 0xc1fc1fc1);
+  rtems_test_assert(get_uint32(packet, 4) == 0);
+  rtems_test_assert(get_uint64(packet, 24) == packet_size * 8);
+  rtems_test_assert(get_uint64(packet, 32) == packet_size * 8);
+  rtems_test_assert(get_uint32(packet, 40) == 0);
+  rtems_test_assert(get_uint32(packet, 44) == cpu);
+
+  /* Events */
+  time = get_uint64(packet, 8);
+
+  for (i = 0; i < CTF_RECORDS; ++i) {
+    size_t offset = CTF_PACKET_HEADER_SIZE + i * CTF_EVENT_SIZE;
+    uint64_t event_time = get_uint64(packet, offset + 4);
+
+    rtems_test_assert(get_uint32(packet, offset) == 0);
+    rtems_test_assert(event_time >= time);
+    rtems_test_assert(get_uint32(packet, offset + 12) == rtems_task_self());
+    rtems_test_assert(
+      (get_uint32(packet, offset + 16) & RTEMS_CAPTURE_TIMESTAMP) != 0
+    );
+    rtems_test_assert(get_uint32(packet, offset + 20) == sizeof(test_record));
+    rtems_test_assert(get_uint32(packet, offset + 24) == i);
+    rtems_test_assert(get_uint32(packet, offset + 28) == ~i);
+
+    time = event_time;
+  }
+
+  rtems_test_assert(get_uint64(packet, 16) == time);
+
+  rv = close(fd);
+  rtems_test_assert(rv == 0);
+
+  rv = unlink("/ctf");
+  rtems_test_assert(rv == 0);
+
+  rtems_test_assert(rtems_get_current_processor() == cpu);
+}
+
+static void check_ctf_errors(void)
+{
+  static uint8_t large[4096];
+  uint32_t cpu = rtems_get_current_processor();
+  rtems_status_code sc;
+  uint32_t written;
+  uint32_t dropped;
+  uint32_t i;
+  void *ptr;
+  int fd;
+  int rv;
+
+  puts("check CTF write error and dropped records");
+
+  test_prepare(false);
+
+  for (i = 0; i < CTF_RECORDS; ++i) {
+    add_record(i);
+  }
+
+  fd = open("/ctf", O_WRONLY | O_CREAT | O_TRUNC, S_IRWXU);
+  rtems_test_assert(fd >= 0);
+
+  rv = close(fd);
+  rtems_test_assert(rv == 0);
+
+  /* A write to a read-only file descriptor fails */
+  fd = open("/ctf", O_RDONLY);
+  rtems_test_assert(fd >= 0);
+
+  sc = rtems_capture_ctf_write_packets(fd, cpu, &written, &dropped);
+  rtems_test_assert(sc == RTEMS_IO_ERROR);
+  rtems_test_assert(written == 0);
+  rtems_test_assert(dropped == 0);
+
+  rv = close(fd);
+  rtems_test_assert(rv == 0);
+
+  /* The records are still available after the write error */
+  fd = open("/ctf", O_WRONLY);
+  rtems_test_assert(fd >= 0);
+
+  sc = rtems_capture_ctf_write_packets(fd, cpu, &written, &dropped);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  rtems_test_assert(written == CTF_RECORDS);
+  rtems_test_assert(dropped == 0);
+
+  /* A record too large for a packet is dropped and counted separately */
+  rtems_capture_begin_add_record(
+    _Thread_Get_executing(),
+    RTEMS_CAPTURE_TIMESTAMP,
+    sizeof(rtems_capture_record_t) + sizeof(large),
+    &ptr
+  );
+  rtems_test_assert(ptr != NULL);
+  ptr = rtems_capture_append_to_record(ptr, large, sizeof(large));
+  rtems_capture_end_add_record(ptr);
+
+  add_record(0);
+
+  sc = rtems_capture_ctf_write_packets(fd, cpu, &written, &dropped);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  rtems_test_assert(written == 1);
+  rtems_test_assert(dropped == 1);
+
+  /* The dropped record is released as well */
+  sc = rtems_capture_ctf_write_packets(fd, cpu, &written, &dropped);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  rtems_test_assert(written == 0);
+  rtems_test_assert(dropped == 0);
+
+  rv = close(fd);
+  rtems_test_assert(rv == 0);
+
+  rv = unlink("/ctf");
+  rtems_test_assert(rv == 0);
+
+  rtems_test_assert(rtems_get_current_processor() == cpu);
+}
+
+static rtems_interval test_record_init(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers
+)
+{
+  test_prepare(true);
+
+  return test_duration();
+}
+
+static void test_record_body(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers,
+  size_t worker_index
+)
+{
+  test_context *ctx = (test_context *) base;
+
+  ctx->record_ops[active_workers - 1][worker_index] = test_add_records(ctx);
+}
+
+static void test_record_fini(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers
+)
+{
+  test_context *ctx = (test_context *) base;
+
+  test_fini(
+    "Record",
+    &ctx->record_ops[active_workers - 1][0],
+    active_workers
+  );
+}
+
+static rtems_interval test_record_drop_init(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers
+)
+{
+  test_prepare(false);
+
+  return test_duration();
+}
+
+static void test_record_drop_body(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers,
+  size_t worker_index
+)
+{
+  test_context *ctx = (test_context *) base;
+
+  ctx->record_drop_ops[active_workers - 1][worker_index] =
+    test_add_records(ctx);
+}
+
+static void test_record_drop_fini(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers
+)
+{
+  test_context *ctx = (test_context *) base;
+
+  test_fini(
+    "RecordDrop",
+    &ctx->record_drop_ops[active_workers - 1][0],
+    active_workers
+  );
+}
+
+static void test_record_stream_body(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers,
+  size_t worker_index
+)
+{
+  test_context *ctx = (test_context *) base;
+  uint32_t counter;
+
+  if (rtems_test_parallel_is_master_worker(worker_index)) {
+    uint32_t cpu_count = rtems_get_processor_count();
+
+    counter = 0;
+
+    while (!rtems_test_parallel_stop_job(&ctx->base)) {
+      uint32_t cpu;
+
+      for (cpu = 0; cpu < cpu_count; ++cpu) {
+        rtems_status_code sc;
+        uint32_t written;
+
+        sc = rtems_capture_ctf_write_packets(ctx->fd, cpu, &written, NULL);
+        rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+        counter += written;
+      }
+    }
+  } else {
+    counter = test_add_records(ctx);
+  }
+
+  ctx->record_stream_ops[active_workers - 1][worker_index] = counter;
+}
+
+static void test_record_stream_fini(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers
+)
+{
+  test_context *ctx = (test_context *) base;
+
+  test_fini(
+    "RecordStream",
+    &ctx->record_stream_ops[active_workers - 1][0],
+    active_workers
+  );
+}
+
+static const rtems_test_parallel_job test_jobs[] = {
+  {
+    .init = test_record_init,
+    .body = test_record_body,
+    .fini = test_record_fini,
+    .cascade = true
+  }, {
+    .init = test_record_drop_init,
+    .body = test_record_drop_body,
+    .fini = test_record_drop_fini,
+    .cascade = true
+  }, {
+    .init = test_record_drop_init,
+    .body = test_record_stream_body,
+    .fini = test_record_stream_fini,
+    .cascade = true
+  }
+};
+
+static void Init(rtems_task_argument arg)
+{
+  test_context *ctx = &test_instance;
+  const char *test = "SMPCapture03";
+  rtems_status_code sc;
+
+  TEST_BEGIN();
+
+  ctx->fd = open("/dev/null", O_WRONLY);
+  rtems_test_assert(ctx->fd >= 0);
+
+  sc = rtems_capture_open(BUFFER_SIZE, NULL);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  sc = rtems_capture_ctf_write_metadata(ctx->fd);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  check_wrap_around();
+  check_drop();
+  check_overwrite();
+  check_flush();
+  check_ctf(ctx);
+  check_ctf_errors();
+
+  printf("<%s>\n", test);
+
+  rtems_test_parallel(
+    &ctx->base,
+    NULL,
+    &test_jobs[0],
+    RTEMS_ARRAY_SIZE(test_jobs)
+  );
+
+  printf("</%s>\n", test);
+
+  sc = rtems_capture_control(false);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  sc = rtems_capture_close();
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  close(ctx->fd);
+
+  TEST_END();
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_NULL_DRIVER
+
+#define CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS 5
+
+#define CONFIGURE_MAXIMUM_TASKS CPU_COUNT
+
+#define CONFIGURE_MAXIMUM_TIMERS 1
+
+#define CONFIGURE_MAXIMUM_USER_EXTENSIONS 1
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#define CONFIGURE_SMP_APPLICATION
+
+#define CONFIGURE_SMP_MAXIMUM_PROCESSORS CPU_COUNT
+
+#define CONFIGURE_INIT
+
+#include <rtems/confdefs.h>
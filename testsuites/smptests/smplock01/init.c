@@ -29,7 +29,7 @@ const char rtems_test_name[] = "SMPLOCK 1";
 
 #define CPU_COUNT 32
 
-#define TEST_COUNT 5
+#define TEST_COUNT 9
 
 typedef enum {
   INITIAL,
@@ -42,15 +42,27 @@ typedef struct {
   SMP_barrier_Control barrier;
   rtems_id timer_id;
   rtems_interval timeout;
-  unsigned long counter[TEST_COUNT];
-  unsigned long test_counter[TEST_COUNT][CPU_COUNT];
+  unsigned long counter[CPU_COUNT][TEST_COUNT];
+  unsigned long test_counter[CPU_COUNT][TEST_COUNT][CPU_COUNT];
   SMP_lock_Control lock;
+  SMP_ticket_lock_Control ticket_lock;
+  SMP_MCS_lock_Control mcs_lock;
+#if defined(RTEMS_PROFILING)
+  SMP_lock_Stats ticket_stats;
+  SMP_lock_Stats mcs_stats;
+#endif
 } global_context;
 
 static global_context context = {
   .state = ATOMIC_INITIALIZER_UINT(INITIAL),
   .barrier = SMP_BARRIER_CONTROL_INITIALIZER,
-  .lock = SMP_LOCK_INITIALIZER("global")
+  .lock = SMP_LOCK_INITIALIZER("global"),
+  .ticket_lock = SMP_TICKET_LOCK_INITIALIZER,
+  .mcs_lock = SMP_MCS_LOCK_INITIALIZER,
+#if defined(RTEMS_PROFILING)
+  .ticket_stats = SMP_LOCK_STATS_INITIALIZER("ticket"),
+  .mcs_stats = SMP_LOCK_STATS_INITIALIZER("MCS")
+#endif
 };
 
 static const char *test_names[TEST_COUNT] = {
@@ -58,7 +70,11 @@ static const char *test_names[TEST_COUNT] = {
   "aquire global lock with global counter",
   "aquire local lock with local counter",
   "aquire local lock with global counter",
-  "aquire global lock with busy section"
+  "aquire global lock with busy section",
+  "aquire global ticket lock with local counter",
+  "aquire global MCS lock with local counter",
+  "aquire global ticket lock with busy section",
+  "aquire global MCS lock with busy section"
 };
 
 static void stop_test_timer(rtems_id timer_id, void *arg)
@@ -86,7 +102,7 @@ typedef void (*test_body)(
   int test,
   global_context *ctx,
   SMP_barrier_State *bs,
-  unsigned int cpu_count,
+  unsigned int active,
   unsigned int cpu_self
 );
 
@@ -94,7 +110,7 @@ static void test_0_body(
   int test,
   global_context *ctx,
   SMP_barrier_State *bs,
-  unsigned int cpu_count,
+  unsigned int active,
   unsigned int cpu_self
 )
 {
@@ -107,14 +123,14 @@ static void test_0_body(
     ++counter;
   }
 
-  ctx->test_counter[test][cpu_self] = counter;
+  ctx->test_counter[active - 1][test][cpu_self] = counter;
 }
 
 static void test_1_body(
   int test,
   global_context *ctx,
   SMP_barrier_State *bs,
-  unsigned int cpu_count,
+  unsigned int active,
   unsigned int cpu_self
 )
 {
@@ -123,19 +139,19 @@ static void test_1_body(
 
   while (assert_state(ctx, START_TEST)) {
     _SMP_lock_Acquire(&ctx->lock, &lock_context);
-    ++ctx->counter[test];
+    ++ctx->counter[active - 1][test];
     _SMP_lock_Release(&ctx->lock, &lock_context);
     ++counter;
   }
 
-  ctx->test_counter[test][cpu_self] = counter;
+  ctx->test_counter[active - 1][test][cpu_self] = counter;
 }
 
 static void test_2_body(
   int test,
   global_context *ctx,
   SMP_barrier_State *bs,
-  unsigned int cpu_count,
+  unsigned int active,
   unsigned int cpu_self
 )
 {
@@ -153,14 +169,14 @@ static void test_2_body(
 
   _SMP_lock_Destroy(&lock);
 
-  ctx->test_counter[test][cpu_self] = counter;
+  ctx->test_counter[active - 1][test][cpu_self] = counter;
 }
 
 static void test_3_body(
   int test,
   global_context *ctx,
   SMP_barrier_State *bs,
-  unsigned int cpu_count,
+  unsigned int active,
   unsigned int cpu_self
 )
 {
@@ -174,7 +190,7 @@ static void test_3_body(
     _SMP_lock_Acquire(&lock, &lock_context);
 
     /* The counter value is not interesting, only the access to it */
-    ++ctx->counter[test];
+    ++ctx->counter[active - 1][test];
 
     _SMP_lock_Release(&lock, &lock_context);
     ++counter;
@@ -182,7 +198,7 @@ static void test_3_body(
 
   _SMP_lock_Destroy(&lock);
 
-  ctx->test_counter[test][cpu_self] = counter;
+  ctx->test_counter[active - 1][test][cpu_self] = counter;
 }
 
 static void busy_section(void)
@@ -198,7 +214,7 @@ static void test_4_body(
   int test,
   global_context *ctx,
   SMP_barrier_State *bs,
-  unsigned int cpu_count,
+  unsigned int active,
   unsigned int cpu_self
 )
 {
@@ -212,7 +228,125 @@ static void test_4_body(
     ++counter;
   }
 
-  ctx->test_counter[test][cpu_self] = counter;
+  ctx->test_counter[active - 1][test][cpu_self] = counter;
+}
+
+static void test_5_body(
+  int test,
+  global_context *ctx,
+  SMP_barrier_State *bs,
+  unsigned int active,
+  unsigned int cpu_self
+)
+{
+  unsigned long counter = 0;
+  SMP_lock_Context lock_context;
+
+  (void) lock_context;
+
+  while (assert_state(ctx, START_TEST)) {
+    _SMP_ticket_lock_Acquire(
+      &ctx->ticket_lock,
+      &ctx->ticket_stats,
+      &lock_context.Stats_context
+    );
+    _SMP_ticket_lock_Release(&ctx->ticket_lock, &lock_context.Stats_context);
+    ++counter;
+  }
+
+  ctx->test_counter[active - 1][test][cpu_self] = counter;
+}
+
+static void test_6_body(
+  int test,
+  global_context *ctx,
+  SMP_barrier_State *bs,
+  unsigned int active,
+  unsigned int cpu_self
+)
+{
+  unsigned long counter = 0;
+  SMP_lock_Context lock_context;
+  SMP_MCS_lock_Context mcs_context;
+
+  (void) lock_context;
+
+  while (assert_state(ctx, START_TEST)) {
+    _SMP_MCS_lock_Acquire(
+      &ctx->mcs_lock,
+      &mcs_context,
+      &ctx->mcs_stats,
+      &lock_context.Stats_context
+    );
+    _SMP_MCS_lock_Release(
+      &ctx->mcs_lock,
+      &mcs_context,
+      &lock_context.Stats_context
+    );
+    ++counter;
+  }
+
+  ctx->test_counter[active - 1][test][cpu_self] = counter;
+}
+
+static void test_7_body(
+  int test,
+  global_context *ctx,
+  SMP_barrier_State *bs,
+  unsigned int active,
+  unsigned int cpu_self
+)
+{
+  unsigned long counter = 0;
+  SMP_lock_Context lock_context;
+
+  (void) lock_context;
+
+  while (assert_state(ctx, START_TEST)) {
+    _SMP_ticket_lock_Acquire(
+      &ctx->ticket_lock,
+      &ctx->ticket_stats,
+      &lock_context.Stats_context
+    );
+    busy_section();
+    _SMP_ticket_lock_Release(&ctx->ticket_lock, &lock_context.Stats_context);
+    ++counter;
+  }
+
+  ctx->test_counter[active - 1][test][cpu_self] = counter;
+}
+
+static void test_8_body(
+  int test,
+  global_context *ctx,
+  SMP_barrier_State *bs,
+  unsigned int active,
+  unsigned int cpu_self
+)
+{
+  unsigned long counter = 0;
+  SMP_lock_Context lock_context;
+  SMP_MCS_lock_Context mcs_context;
+
+  (void) lock_context;
+
+  while (assert_state(ctx, START_TEST)) {
+    _SMP_MCS_lock_Acquire(
+      &ctx->mcs_lock,
+      &mcs_context,
+      &ctx->mcs_stats,
+      &lock_context.Stats_context
+    );
+    busy_section();
+    _SMP_MCS_lock_Release(
+      &ctx->mcs_lock,
+      &mcs_context,
+      &lock_context.Stats_context
+    );
+    ++counter;
+  }
+
+  ctx->test_counter[active - 1][test][cpu_self] = counter;
 }
 
 static const test_body test_bodies[TEST_COUNT] = {
@@ -220,7 +354,11 @@ static const test_body test_bodies[TEST_COUNT] = {
   test_1_body,
   test_2_body,
   test_3_body,
-  test_4_body
+  test_4_body,
+  test_5_body,
+  test_6_body,
+  test_7_body,
+  test_8_body
 };
 
 static void run_tests(
@@ -231,26 +369,31 @@ static void run_tests(
   bool master
 )
 {
+  unsigned int active;
   int test;
 
-  for (test = 0; test < TEST_COUNT; ++test) {
-    _SMP_barrier_Wait(&ctx->barrier, bs, cpu_count);
+  for (active = 1; active <= cpu_count; ++active) {
+    for (test = 0; test < TEST_COUNT; ++test) {
+      _SMP_barrier_Wait(&ctx->barrier, bs, cpu_count);
 
-    if (master) {
-      rtems_status_code sc = rtems_timer_fire_after(
-        ctx->timer_id,
-        ctx->timeout,
-        stop_test_timer,
-        ctx
-      );
-      rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+      if (master) {
+        rtems_status_code sc = rtems_timer_fire_after(
+          ctx->timer_id,
+          ctx->timeout,
+          stop_test_timer,
+          ctx
+        );
+        rtems_test_assert(sc == RTEMS_SUCCESSFUL);
 
-      _Atomic_Store_uint(&ctx->state, START_TEST, ATOMIC_ORDER_RELEASE);
-    }
+        _Atomic_Store_uint(&ctx->state, START_TEST, ATOMIC_ORDER_RELEASE);
+      }
 
-    wait_for_state(ctx, START_TEST);
+      wait_for_state(ctx, START_TEST);
 
-    (*test_bodies[test])(test, ctx, bs, cpu_count, cpu_self);
+      if (cpu_self < active) {
+        (*test_bodies[test])(test, ctx, bs, active, cpu_self);
+      }
+    }
   }
 
   _SMP_barrier_Wait(&ctx->barrier, bs, cpu_count);
@@ -276,6 +419,7 @@ static void test(void)
   uint32_t cpu_count = rtems_get_processor_count();
   uint32_t cpu_self = rtems_get_current_processor();
   uint32_t cpu;
+  uint32_t active;
   int test;
   rtems_status_code sc;
   SMP_barrier_State bs = SMP_BARRIER_STATE_INITIALIZER;
@@ -299,35 +443,39 @@ static void test(void)
     }
   }
 
-  ctx->timeout = 10 * rtems_clock_get_ticks_per_second();
+  ctx->timeout = rtems_clock_get_ticks_per_second();
 
   sc = rtems_timer_create(rtems_build_name('T', 'I', 'M', 'R'), &ctx->timer_id);
   rtems_test_assert(sc == RTEMS_SUCCESSFUL);
 
   run_tests(ctx, &bs, cpu_count, cpu_self, true);
 
-  for (test = 0; test < TEST_COUNT; ++test) {
-    unsigned long sum = 0;
+  for (active = 1; active <= cpu_count; ++active) {
+    printf("active processors %" PRIu32 "\n", active);
+
+    for (test = 0; test < TEST_COUNT; ++test) {
+      unsigned long sum = 0;
+
+      printf("%s\n", test_names[test]);
 
-    printf("%s\n", test_names[test]);
+      for (cpu = 0; cpu < active; ++cpu) {
+        unsigned long local_counter = ctx->test_counter[active - 1][test][cpu];
 
-    for (cpu = 0; cpu < cpu_count; ++cpu) {
-      unsigned long local_counter = ctx->test_counter[test][cpu];
+        sum += local_counter;
 
-      sum += local_counter;
+        printf(
+          "\tprocessor %" PRIu32 ", local counter %lu\n",
+          cpu,
+          local_counter
+        );
+      }
 
       printf(
-        "\tprocessor %" PRIu32 ", local counter %lu\n",
-        cpu,
-        local_counter
+        "\tglobal counter %lu, sum of local counter %lu\n",
+        ctx->counter[active - 1][test],
+        sum
       );
     }
-
-    printf(
-      "\tglobal counter %lu, sum of local counter %lu\n",
-      ctx->counter[test],
-      sum
-    );
   }
 }
 
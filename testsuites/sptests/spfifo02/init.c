@@ -25,9 +25,7 @@ const char rtems_test_name[] = "SPFIFO 2";
 
 /* forward declarations to avoid warnings */
 rtems_task Init(rtems_task_argument argument);
-void create_all_barriers(void);
 void create_all_semaphores(void);
-void delete_barrier(void);
 void delete_semaphore(void);
 void create_fifo(void);
 void open_fifo(int expected, int flags);
@@ -35,37 +33,9 @@ void open_fifo(int expected, int flags);
 #define MAXIMUM 10
 #define NUM_OPEN_REQ 26
 
-rtems_id Barriers[MAXIMUM];
-int BarrierCount;
-
 rtems_id Semaphores[MAXIMUM];
 int SemaphoreCount;
 
-void create_all_barriers(void)
-{
-  rtems_status_code status;
-  int               i;
-
-  BarrierCount = 0;
-
-  memset( Barriers, 0, sizeof(Barriers) );
-  for ( i=0 ; i<MAXIMUM ; i++ ) {
-    status = rtems_barrier_create(
-      rtems_build_name( 'B', 'A', 'R', 0x30+i ),
-      RTEMS_BARRIER_MANUAL_RELEASE,
-      0,
-      &Barriers[i]
-    );
-    if ( status == RTEMS_TOO_MANY ) {
-      printf( "%d Barriers created\n", BarrierCount+1 );
-      return;
-    } 
-
-    directive_failed( status, "barrier create" );
-    BarrierCount++;
-  }
-}
-
 void create_all_semaphores(void)
 {
   rtems_status_code status;
@@ -91,17 +61,6 @@ void create_all_semaphores(void)
   }
 }
 
-void delete_barrier(void)
-{
-  rtems_status_code status;
-  
-  BarrierCount--;
-  printf( "Deleting barrier id=0x%08x\n",
-    (unsigned int)Barriers[BarrierCount] );
-  status = rtems_barrier_delete( Barriers[BarrierCount] );
-  directive_failed( status, "barrier delete" );
-}
-
 void delete_semaphore(void)
 {
   rtems_status_code status;
@@ -146,9 +105,6 @@ rtems_task Init(
 
   TEST_BEGIN();
 
-  puts( "Creating all barriers" );
-  create_all_barriers();
-
   puts( "Creating all semaphores" );
   create_all_semaphores();
 
@@ -165,14 +121,14 @@ rtems_task Init(
   open_fifo(ENOMEM, O_RDWR);
 
   free(alloc_ptr);
-  puts( "Opening FIFO.. expect ENOMEM (barrier-1 for pipe could not be created)" );
+  puts( "Opening FIFO.. expect ENOMEM (read semaphore for pipe could not be created)" );
   open_fifo(ENOMEM, O_RDWR);
 
-  delete_barrier();
-  puts( "Opening FIFO.. expect ENOMEM (barrier-2 for pipe could not be created" );
+  delete_semaphore();
+  puts( "Opening FIFO.. expect ENOMEM (write semaphore for pipe could not be created)" );
   open_fifo(ENOMEM, O_RDWR);
 
-  delete_barrier();
+  delete_semaphore();
   puts( "Opening FIFO.. expect ENOMEM (semaphore-1 for pipe could not be created" );
   open_fifo(ENOMEM, O_RDWR);
 
@@ -0,0 +1,168 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "tmacros.h"
+
+#include <string.h>
+
+const char rtems_test_name[] = "SPPARTITION 1";
+
+#define BUFFER_COUNT 8
+
+#define BUFFER_SIZE 64
+
+#define INVALID_COUNT 0xffffffff
+
+static char area[BUFFER_COUNT * BUFFER_SIZE]
+  __attribute__((aligned(CPU_PARTITION_ALIGNMENT)));
+
+static void *buffers[BUFFER_COUNT + 1];
+
+static rtems_id create_partition(void)
+{
+  rtems_status_code sc;
+  rtems_id id;
+
+  sc = rtems_partition_create(
+    rtems_build_name('P', 'A', 'R', 'T'),
+    area,
+    sizeof(area),
+    BUFFER_SIZE,
+    RTEMS_DEFAULT_ATTRIBUTES,
+    &id
+  );
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  return id;
+}
+
+static void return_buffers(rtems_id id, uint32_t count)
+{
+  uint32_t i;
+
+  for (i = 0; i < count; ++i) {
+    rtems_status_code sc;
+
+    sc = rtems_partition_return_buffer(id, buffers[i]);
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  }
+}
+
+static void check_buffers(uint32_t count)
+{
+  uint32_t i;
+
+  for (i = 0; i < count; ++i) {
+    uintptr_t offset = (uintptr_t) buffers[i] - (uintptr_t) &area[0];
+    uint32_t j;
+
+    rtems_test_assert(offset < sizeof(area));
+    rtems_test_assert(offset % BUFFER_SIZE == 0);
+
+    for (j = 0; j < i; ++j) {
+      rtems_test_assert(buffers[i] != buffers[j]);
+    }
+  }
+}
+
+static void test_errors(rtems_id id)
+{
+  rtems_status_code sc;
+  uint32_t obtained;
+
+  sc = rtems_partition_get_buffers(id, buffers, 1, NULL);
+  rtems_test_assert(sc == RTEMS_INVALID_ADDRESS);
+
+  obtained = INVALID_COUNT;
+  sc = rtems_partition_get_buffers(id, NULL, 1, &obtained);
+  rtems_test_assert(sc == RTEMS_INVALID_ADDRESS);
+  rtems_test_assert(obtained == 0);
+
+  obtained = INVALID_COUNT;
+  sc = rtems_partition_get_buffers(id, buffers, 0, &obtained);
+  rtems_test_assert(sc == RTEMS_INVALID_NUMBER);
+  rtems_test_assert(obtained == 0);
+
+  obtained = INVALID_COUNT;
+  sc = rtems_partition_get_buffers(0, buffers, 1, &obtained);
+  rtems_test_assert(sc == RTEMS_INVALID_ID);
+  rtems_test_assert(obtained == 0);
+}
+
+static void test_get_buffers(rtems_id id)
+{
+  rtems_status_code sc;
+  uint32_t obtained;
+
+  obtained = INVALID_COUNT;
+  sc = rtems_partition_get_buffers(id, buffers, 5, &obtained);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  rtems_test_assert(obtained == 5);
+
+  /* Only the remaining buffers are handed out */
+  obtained = INVALID_COUNT;
+  sc = rtems_partition_get_buffers(id, &buffers[5], 4, &obtained);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  rtems_test_assert(obtained == BUFFER_COUNT - 5);
+  check_buffers(BUFFER_COUNT);
+
+  obtained = INVALID_COUNT;
+  sc = rtems_partition_get_buffers(id, &buffers[BUFFER_COUNT], 1, &obtained);
+  rtems_test_assert(sc == RTEMS_UNSATISFIED);
+  rtems_test_assert(obtained == 0);
+
+  return_buffers(id, BUFFER_COUNT);
+
+  /* All buffers at once, the count may exceed the partition size */
+  memset(buffers, 0, sizeof(buffers));
+  obtained = INVALID_COUNT;
+  sc = rtems_partition_get_buffers(id, buffers, BUFFER_COUNT + 1, &obtained);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  rtems_test_assert(obtained == BUFFER_COUNT);
+  rtems_test_assert(buffers[BUFFER_COUNT] == NULL);
+  check_buffers(BUFFER_COUNT);
+
+  return_buffers(id, BUFFER_COUNT);
+}
+
+static void Init(rtems_task_argument arg)
+{
+  rtems_status_code sc;
+  rtems_id id;
+
+  TEST_BEGIN();
+
+  id = create_partition();
+  test_errors(id);
+  test_get_buffers(id);
+
+  sc = rtems_partition_delete(id);
+  rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+  TEST_END();
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_MAXIMUM_TASKS 1
+#define CONFIGURE_MAXIMUM_PARTITIONS 1
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#define CONFIGURE_INIT
+
+#include <rtems/confdefs.h>
@@ -29,6 +29,12 @@ const char rtems_test_name[] = "TMFINE 1";
 
 #define MSG_COUNT 3
 
+#define PART_BUFFER_COUNT 8
+
+#define PART_BUFFER_SIZE 64
+
+#define PART_BATCH 4
+
 typedef struct {
   uint32_t value;
 } test_msg;
@@ -38,14 +44,21 @@ typedef struct {
   rtems_id master;
   rtems_id sema[CPU_COUNT];
   rtems_id mq[CPU_COUNT];
+  rtems_id part[CPU_COUNT];
   uint32_t self_event_ops[CPU_COUNT][CPU_COUNT];
   uint32_t all_to_one_event_ops[CPU_COUNT][CPU_COUNT];
   uint32_t one_mutex_ops[CPU_COUNT][CPU_COUNT];
   uint32_t many_mutex_ops[CPU_COUNT][CPU_COUNT];
   uint32_t self_msg_ops[CPU_COUNT][CPU_COUNT];
   uint32_t many_to_one_msg_ops[CPU_COUNT][CPU_COUNT];
+  uint32_t one_part_ops[CPU_COUNT][CPU_COUNT];
+  uint32_t many_part_ops[CPU_COUNT][CPU_COUNT];
+  uint32_t one_part_batch_ops[CPU_COUNT][CPU_COUNT];
 } test_context;
 
+static uint8_t part_area[CPU_COUNT][PART_BUFFER_COUNT * PART_BUFFER_SIZE]
+  CPU_STRUCTURE_ALIGNMENT;
+
 static test_context test_instance;
 
 static rtems_interval test_duration(void)
@@ -368,6 +381,151 @@ static void test_many_to_one_msg_fini(
   );
 }
 
+static void test_part_body(
+  rtems_id id,
+  rtems_test_parallel_context *base,
+  uint32_t *counter_result
+)
+{
+  uint32_t counter = 0;
+
+  while (!rtems_test_parallel_stop_job(base)) {
+    rtems_status_code sc;
+    void *buffer;
+
+    sc = rtems_partition_get_buffer(id, &buffer);
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL || sc == RTEMS_UNSATISFIED);
+
+    if (sc != RTEMS_SUCCESSFUL) {
+      continue;
+    }
+
+    ++counter;
+
+    sc = rtems_partition_return_buffer(id, buffer);
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+  }
+
+  *counter_result = counter;
+}
+
+static void test_one_part_body(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers,
+  size_t worker_index
+)
+{
+  test_context *ctx = (test_context *) base;
+
+  test_part_body(
+    ctx->part[0],
+    &ctx->base,
+    &ctx->one_part_ops[active_workers - 1][worker_index]
+  );
+}
+
+static void test_one_part_fini(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers
+)
+{
+  test_context *ctx = (test_context *) base;
+
+  test_fini(
+    "OnePartition",
+    &ctx->one_part_ops[active_workers - 1][0],
+    active_workers
+  );
+}
+
+static void test_many_part_body(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers,
+  size_t worker_index
+)
+{
+  test_context *ctx = (test_context *) base;
+
+  test_part_body(
+    ctx->part[worker_index],
+    &ctx->base,
+    &ctx->many_part_ops[active_workers - 1][worker_index]
+  );
+}
+
+static void test_many_part_fini(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers
+)
+{
+  test_context *ctx = (test_context *) base;
+
+  test_fini(
+    "ManyPartition",
+    &ctx->many_part_ops[active_workers - 1][0],
+    active_workers
+  );
+}
+
+static void test_one_part_batch_body(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers,
+  size_t worker_index
+)
+{
+  test_context *ctx = (test_context *) base;
+  rtems_id id = ctx->part[0];
+  uint32_t counter = 0;
+
+  while (!rtems_test_parallel_stop_job(&ctx->base)) {
+    rtems_status_code sc;
+    void *buffers[PART_BATCH];
+    uint32_t obtained;
+    uint32_t i;
+
+    sc = rtems_partition_get_buffers(
+      id,
+      &buffers[0],
+      RTEMS_ARRAY_SIZE(buffers),
+      &obtained
+    );
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL || sc == RTEMS_UNSATISFIED);
+
+    if (sc != RTEMS_SUCCESSFUL) {
+      continue;
+    }
+
+    counter += obtained;
+
+    for (i = 0; i < obtained; ++i) {
+      sc = rtems_partition_return_buffer(id, buffers[i]);
+      rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+    }
+  }
+
+  ctx->one_part_batch_ops[active_workers - 1][worker_index] = counter;
+}
+
+static void test_one_part_batch_fini(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers
+)
+{
+  test_context *ctx = (test_context *) base;
+
+  test_fini(
+    "OnePartitionBatch",
+    &ctx->one_part_batch_ops[active_workers - 1][0],
+    active_workers
+  );
+}
+
 static const rtems_test_parallel_job test_jobs[] = {
   {
     .init = test_init,
@@ -399,6 +557,21 @@ static const rtems_test_parallel_job test_jobs[] = {
     .body = test_many_to_one_msg_body,
     .fini = test_many_to_one_msg_fini,
     .cascade = true
+  }, {
+    .init = test_init,
+    .body = test_one_part_body,
+    .fini = test_one_part_fini,
+    .cascade = true
+  }, {
+    .init = test_init,
+    .body = test_many_part_body,
+    .fini = test_many_part_fini,
+    .cascade = true
+  }, {
+    .init = test_init,
+    .body = test_one_part_batch_body,
+    .fini = test_one_part_batch_fini,
+    .cascade = true
   }
 };
 
@@ -432,6 +605,16 @@ static void Init(rtems_task_argument arg)
       &ctx->mq[i]
     );
     rtems_test_assert(sc == RTEMS_SUCCESSFUL);
+
+    sc = rtems_partition_create(
+      rtems_build_name('T', 'E', 'S', 'T'),
+      &part_area[i][0],
+      sizeof(part_area[i]),
+      PART_BUFFER_SIZE,
+      RTEMS_DEFAULT_ATTRIBUTES,
+      &ctx->part[i]
+    );
+    rtems_test_assert(sc == RTEMS_SUCCESSFUL);
   }
 
   printf("<%s>\n", test);
@@ -462,6 +645,8 @@ static void Init(rtems_task_argument arg)
 
 #define CONFIGURE_MAXIMUM_MESSAGE_QUEUES CPU_COUNT
 
+#define CONFIGURE_MAXIMUM_PARTITIONS CPU_COUNT
+
 #define CONFIGURE_MESSAGE_BUFFER_MEMORY \
   CONFIGURE_MESSAGE_BUFFERS_FOR_QUEUE(MSG_COUNT, sizeof(test_msg))
 
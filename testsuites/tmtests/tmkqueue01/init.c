@@ -0,0 +1,325 @@
+/*
+ * COPYRIGHT (c) 2015.
+ * On-Line Applications Research Corporation (OAR).
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rtems.org/license/LICENSE.
+ */
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "tmacros.h"
+
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+#include <rtems/rtems_bsdnet.h>
+#include <rtems/test.h>
+
+const char rtems_test_name[] = "TMKQUEUE 1";
+
+struct rtems_bsdnet_config rtems_bsdnet_config = {
+  .mbuf_bytecount = 256 * 1024,
+  .mbuf_cluster_bytecount = 256 * 1024
+};
+
+#define TCP_PORT 1234
+
+#define ACTIVE_CONNECTIONS 4
+
+#define IDLE_CONNECTIONS_MAX 256
+
+#define CONNECTIONS_MAX (ACTIVE_CONNECTIONS + IDLE_CONNECTIONS_MAX)
+
+/*
+ * The client end of a connection sends, the server end is registered with
+ * the kernel event queue.
+ */
+typedef struct {
+  int client;
+  int server;
+} test_connection;
+
+typedef struct {
+  rtems_test_parallel_context base;
+  int listen_sd;
+  int kq;
+  test_connection connections[CONNECTIONS_MAX];
+  size_t connection_count;
+  uint32_t kevent_ops;
+} test_context;
+
+static test_context test_instance;
+
+static const size_t test_idle_connections[] = {
+  0,
+  16,
+  64,
+  IDLE_CONNECTIONS_MAX
+};
+
+static rtems_interval test_duration(void)
+{
+  return rtems_clock_get_ticks_per_second();
+}
+
+static void init_addr(struct sockaddr_in *addr)
+{
+  memset(addr, 0, sizeof(*addr));
+  addr->sin_family = AF_INET;
+  addr->sin_port = htons(TCP_PORT);
+  addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+}
+
+static void create_listen_socket(test_context *ctx)
+{
+  struct sockaddr_in addr;
+  int rv;
+
+  ctx->listen_sd = socket(PF_INET, SOCK_STREAM, 0);
+  rtems_test_assert(ctx->listen_sd >= 0);
+
+  init_addr(&addr);
+  rv = bind(ctx->listen_sd, (struct sockaddr *) &addr, sizeof(addr));
+  rtems_test_assert(rv == 0);
+
+  rv = listen(ctx->listen_sd, 1);
+  rtems_test_assert(rv == 0);
+}
+
+static void tcp_connect(test_context *ctx, test_connection *c)
+{
+  struct sockaddr_in addr;
+  struct linger linger;
+  int on = 1;
+  int rv;
+
+  c->client = socket(PF_INET, SOCK_STREAM, 0);
+  rtems_test_assert(c->client >= 0);
+
+  /* Each write carries one byte which must not wait for an acknowledge */
+  rv = setsockopt(c->client, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+  rtems_test_assert(rv == 0);
+
+  /* Reset the connection on close, so no TIME_WAIT states pile up */
+  linger.l_onoff = 1;
+  linger.l_linger = 0;
+  rv = setsockopt(c->client, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+  rtems_test_assert(rv == 0);
+
+  init_addr(&addr);
+  rv = connect(c->client, (struct sockaddr *) &addr, sizeof(addr));
+  rtems_test_assert(rv == 0);
+
+  c->server = accept(ctx->listen_sd, NULL, NULL);
+  rtems_test_assert(c->server >= 0);
+}
+
+static rtems_interval test_kevent_init(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers
+)
+{
+  test_context *ctx = (test_context *) base;
+  const size_t *idle_connections = arg;
+  size_t i;
+
+  ctx->kq = kqueue();
+  rtems_test_assert(ctx->kq >= 0);
+
+  ctx->connection_count = ACTIVE_CONNECTIONS + *idle_connections;
+
+  for (i = 0; i < ctx->connection_count; ++i) {
+    test_connection *c = &ctx->connections[i];
+    struct kevent change;
+    int rv;
+
+    tcp_connect(ctx, c);
+
+    EV_SET(&change, c->server, EVFILT_READ, EV_ADD, 0, 0, NULL);
+    rv = kevent(ctx->kq, &change, 1, NULL, 0, NULL);
+    rtems_test_assert(rv == 0);
+  }
+
+  return test_duration();
+}
+
+static void test_kevent_body(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers,
+  size_t worker_index
+)
+{
+  test_context *ctx = (test_context *) base;
+  uint32_t counter = 0;
+
+  if (!rtems_test_parallel_is_master_worker(worker_index)) {
+    return;
+  }
+
+  while (!rtems_test_parallel_stop_job(&ctx->base)) {
+    struct kevent events[ACTIVE_CONNECTIONS];
+    char c = 'x';
+    ssize_t n;
+    int received = 0;
+    int i;
+
+    /* The active connections are the last ones, they are registered last */
+    for (i = 0; i < ACTIVE_CONNECTIONS; ++i) {
+      size_t j = ctx->connection_count - 1 - i;
+
+      n = write(ctx->connections[j].client, &c, sizeof(c));
+      rtems_test_assert(n == 1);
+    }
+
+    /* The loopback interface may deliver the segments one by one */
+    while (received < ACTIVE_CONNECTIONS) {
+      int rv;
+
+      rv = kevent(
+        ctx->kq,
+        NULL,
+        0,
+        &events[0],
+        ACTIVE_CONNECTIONS - received,
+        NULL
+      );
+      rtems_test_assert(rv > 0);
+
+      for (i = 0; i < rv; ++i) {
+        rtems_test_assert(events[i].filter == EVFILT_READ);
+        rtems_test_assert(events[i].data == 1);
+
+        n = read((int) events[i].ident, &c, sizeof(c));
+        rtems_test_assert(n == 1);
+        rtems_test_assert(c == 'x');
+      }
+
+      received += rv;
+    }
+
+    ++counter;
+  }
+
+  ctx->kevent_ops = counter;
+}
+
+static void test_kevent_fini(
+  rtems_test_parallel_context *base,
+  void *arg,
+  size_t active_workers
+)
+{
+  test_context *ctx = (test_context *) base;
+  const size_t *idle_connections = arg;
+  size_t i;
+  int rv;
+
+  printf("  <Kevent idleConnections=\"%zu\">\n", *idle_connections);
+  printf("    <Counter worker=\"0\">%" PRIu32 "</Counter>\n", ctx->kevent_ops);
+  printf("  </Kevent>\n");
+
+  for (i = 0; i < ctx->connection_count; ++i) {
+    rv = close(ctx->connections[i].server);
+    rtems_test_assert(rv == 0);
+
+    rv = close(ctx->connections[i].client);
+    rtems_test_assert(rv == 0);
+  }
+
+  rv = close(ctx->kq);
+  rtems_test_assert(rv == 0);
+}
+
+static const rtems_test_parallel_job test_jobs[] = {
+  {
+    .init = test_kevent_init,
+    .body = test_kevent_body,
+    .fini = test_kevent_fini,
+    .arg = RTEMS_DECONST(size_t *, &test_idle_connections[0])
+  }, {
+    .init = test_kevent_init,
+    .body = test_kevent_body,
+    .fini = test_kevent_fini,
+    .arg = RTEMS_DECONST(size_t *, &test_idle_connections[1])
+  }, {
+    .init = test_kevent_init,
+    .body = test_kevent_body,
+    .fini = test_kevent_fini,
+    .arg = RTEMS_DECONST(size_t *, &test_idle_connections[2])
+  }, {
+    .init = test_kevent_init,
+    .body = test_kevent_body,
+    .fini = test_kevent_fini,
+    .arg = RTEMS_DECONST(size_t *, &test_idle_connections[3])
+  }
+};
+
+static void Init(rtems_task_argument arg)
+{
+  test_context *ctx = &test_instance;
+  const char *test = "TestTimeKqueue01";
+  int rv;
+
+  TEST_BEGIN();
+
+  rv = rtems_bsdnet_initialize_network();
+  rtems_test_assert(rv == 0);
+
+  create_listen_socket(ctx);
+
+  printf("<%s>\n", test);
+
+  rtems_test_parallel(
+    &ctx->base,
+    NULL,
+    &test_jobs[0],
+    RTEMS_ARRAY_SIZE(test_jobs)
+  );
+
+  printf("</%s>\n", test);
+
+  TEST_END();
+  rtems_test_exit(0);
+}
+
+#define CONFIGURE_MICROSECONDS_PER_TICK 10000
+
+#define CONFIGURE_APPLICATION_NEEDS_CLOCK_DRIVER
+#define CONFIGURE_APPLICATION_NEEDS_CONSOLE_DRIVER
+
+#define CONFIGURE_LIBIO_MAXIMUM_FILE_DESCRIPTORS (5 + 2 * CONNECTIONS_MAX)
+
+/*
+ * Two for the network stack, one for the kqueue registration mutex and one
+ * for the kqueue wait
+ */
+#define CONFIGURE_MAXIMUM_SEMAPHORES 4
+
+/* The Init task and the network daemon */
+#define CONFIGURE_MAXIMUM_TASKS 2
+
+#define CONFIGURE_MAXIMUM_TIMERS 1
+
+#define CONFIGURE_MAXIMUM_USER_EXTENSIONS 1
+
+#define CONFIGURE_INITIAL_EXTENSIONS RTEMS_TEST_INITIAL_EXTENSION
+
+#define CONFIGURE_RTEMS_INIT_TASKS_TABLE
+
+#define CONFIGURE_INIT
+
+#include <rtems/confdefs.h>